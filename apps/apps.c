@@ -2879,6 +2879,95 @@ void store_setup_crl_download(X509_STORE *st)
     X509_STORE_set_lookup_crls_cb(st, crls_http_cb);
 }
 
+#if defined(OPENSSL_THREADS) && defined(OPENSSL_SYS_UNIX)
+# include <pthread.h>
+
+static pthread_mutex_t *app_locks = NULL;
+static void (*app_prev_lock_cb) (int mode, int type, const char *file,
+                                 int line) = NULL;
+
+static void app_lock_cb(int mode, int type, const char *file, int line)
+{
+    if (mode & CRYPTO_LOCK)
+        pthread_mutex_lock(&app_locks[type]);
+    else
+        pthread_mutex_unlock(&app_locks[type]);
+}
+
+/*
+ * Replace the debugging lock callback set up by openssl.c, which only works
+ * in a single thread, with real locks.
+ */
+static int setup_thread_locks(void)
+{
+    int i, n = CRYPTO_num_locks();
+
+    if (app_locks != NULL)
+        return 1;
+    app_locks = OPENSSL_malloc(n * sizeof(*app_locks));
+    if (app_locks == NULL)
+        return 0;
+    for (i = 0; i < n; i++)
+        pthread_mutex_init(&app_locks[i], NULL);
+    app_prev_lock_cb = CRYPTO_get_locking_callback();
+    CRYPTO_set_locking_callback(app_lock_cb);
+    return 1;
+}
+#endif
+
+/*
+ * Undo setup_threads() once all threads have finished, restoring the lock
+ * callback it replaced.
+ */
+void cleanup_threads(void)
+{
+#if defined(OPENSSL_THREADS) && defined(OPENSSL_SYS_UNIX)
+    int i, n = CRYPTO_num_locks();
+
+    if (app_locks == NULL)
+        return;
+    CRYPTO_set_locking_callback(app_prev_lock_cb);
+    for (i = 0; i < n; i++)
+        pthread_mutex_destroy(&app_locks[i]);
+    OPENSSL_free(app_locks);
+    app_locks = NULL;
+#endif
+}
+
+/*
+ * Prepare the library for use from |threads| threads. Returns 0 with an
+ * error message if that is not possible.
+ */
+int setup_threads(BIO *err, int threads)
+{
+    if (threads <= 1)
+        return 1;
+#if defined(OPENSSL_THREADS) && defined(OPENSSL_SYS_UNIX)
+    if (!setup_thread_locks()) {
+        BIO_printf(err, "Cannot set up locks for %d threads\n", threads);
+        return 0;
+    }
+    return 1;
+#else
+    BIO_printf(err, "Threads are not supported on this platform\n");
+    return 0;
+#endif
+}
+
+/*
+ * Search for primes on |threads| threads. Returns 0 with an error message
+ * if that is not possible.
+ */
+int set_prime_search_threads(BIO *err, int threads)
+{
+    if (threads <= 1)
+        return 1;
+    if (!setup_threads(err, threads))
+        return 0;
+    BN_set_prime_search_threads(threads);
+    return 1;
+}
+
 /*
  * Platform-specific sections
  */
@@ -348,6 +348,10 @@ void print_cert_checks(BIO *bio, X509 *x,
 
 void store_setup_crl_download(X509_STORE *st);
 
+int setup_threads(BIO *err, int threads);
+void cleanup_threads(void);
+int set_prime_search_threads(BIO *err, int threads);
+
 # define FORMAT_UNDEF    0
 # define FORMAT_ASN1     1
 # define FORMAT_TEXT     2
@@ -71,6 +71,19 @@
 #undef BUFSIZE
 #define BUFSIZE 1024*8
 
+#ifdef OPENSSL_SYS_UNIX
+# define DGST_JOBS
+# include <errno.h>
+# include <fcntl.h>
+# include <unistd.h>
+# include <sys/types.h>
+# include <sys/stat.h>
+# include <sys/mman.h>
+# ifdef OPENSSL_THREADS
+#  include <pthread.h>
+# endif
+#endif
+
 #undef PROG
 #define PROG    dgst_main
 
@@ -78,6 +91,14 @@ int do_fp(BIO *out, unsigned char *buf, BIO *bp, int sep, int binout,
           EVP_PKEY *key, unsigned char *sigin, int siglen,
           const char *sig_name, const char *md_name,
           const char *file, BIO *bmd);
+static void print_md(BIO *out, const unsigned char *md, size_t len, int sep,
+                     int binout, const char *sig_name, const char *md_name,
+                     const char *file);
+#ifdef DGST_JOBS
+static int do_files(BIO *out, char **files, int num, int jobs, int sep,
+                    int binout, const char *md_name, const EVP_MD *md,
+                    ENGINE *impl);
+#endif
 
 static void list_md_fn(const EVP_MD *m,
                        const char *from, const char *to, void *arg)
@@ -129,6 +150,7 @@ int MAIN(int argc, char **argv)
     char *hmac_key = NULL;
     char *mac_name = NULL;
     int non_fips_allow = 0;
+    int jobs = 0;
     STACK_OF(OPENSSL_STRING) *sigopts = NULL, *macopts = NULL;
 
     apps_startup();
@@ -235,6 +257,12 @@ int MAIN(int argc, char **argv)
                 macopts = sk_OPENSSL_STRING_new_null();
             if (!macopts || !sk_OPENSSL_STRING_push(macopts, *(++argv)))
                 break;
+        } else if (strcmp(*argv, "-jobs") == 0) {
+            if (--argc < 1)
+                break;
+            jobs = atoi(*(++argv));
+            if (jobs < 1)
+                break;
         } else if ((m = EVP_get_digestbyname(&((*argv)[1]))) != NULL)
             md = m;
         else
@@ -273,6 +301,8 @@ int MAIN(int argc, char **argv)
                    "-out filename   output to filename rather than stdout\n");
         BIO_printf(bio_err, "-signature file signature to verify\n");
         BIO_printf(bio_err, "-sigopt nm:v    signature parameter\n");
+        BIO_printf(bio_err,
+                   "-jobs n         digest the files on n threads\n");
         BIO_printf(bio_err, "-hmac key       create hashed MAC with key\n");
         BIO_printf(bio_err,
                    "-mac algorithm  create MAC (not neccessarily HMAC)\n");
@@ -291,6 +321,16 @@ int MAIN(int argc, char **argv)
         impl = e;
 #endif
 
+#ifdef DGST_JOBS
+    if (jobs > 0 && !setup_threads(bio_err, jobs))
+        goto end;
+#else
+    if (jobs > 0) {
+        BIO_printf(bio_err, "-jobs is not supported on this platform\n");
+        goto end;
+    }
+#endif
+
     in = BIO_new(BIO_s_file());
     bmd = BIO_new(BIO_f_md());
     if ((in == NULL) || (bmd == NULL)) {
@@ -498,10 +538,19 @@ int MAIN(int argc, char **argv)
                 md_name = EVP_MD_name(md);
         }
         err = 0;
+#ifdef DGST_JOBS
+        if (jobs > 0 && sigkey == NULL) {
+            err = do_files(out, argv, argc, jobs, separator, out_bin, md_name,
+                           md, impl);
+            goto end;
+        }
+#endif
         for (i = 0; i < argc; i++) {
             int r;
             if (BIO_read_filename(in, argv[i]) <= 0) {
                 perror(argv[i]);
+                /* Don't let the fopen() errors show up for the next file */
+                ERR_clear_error();
                 err++;
                 continue;
             } else
@@ -584,11 +633,21 @@ int do_fp(BIO *out, unsigned char *buf, BIO *bp, int sep, int binout,
         }
     }
 
+    print_md(out, buf, len, sep, binout, sig_name, md_name, file);
+    return 0;
+}
+
+static void print_md(BIO *out, const unsigned char *md, size_t len, int sep,
+                     int binout, const char *sig_name, const char *md_name,
+                     const char *file)
+{
+    int i;
+
     if (binout)
-        BIO_write(out, buf, len);
+        BIO_write(out, md, len);
     else if (sep == 2) {
         for (i = 0; i < (int)len; i++)
-            BIO_printf(out, "%02x", buf[i]);
+            BIO_printf(out, "%02x", md[i]);
         BIO_printf(out, " *%s\n", file);
     } else {
         if (sig_name) {
@@ -603,9 +662,293 @@ int do_fp(BIO *out, unsigned char *buf, BIO *bp, int sep, int binout,
         for (i = 0; i < (int)len; i++) {
             if (sep && (i != 0))
                 BIO_printf(out, ":");
-            BIO_printf(out, "%02x", buf[i]);
+            BIO_printf(out, "%02x", md[i]);
         }
         BIO_printf(out, "\n");
     }
-    return 0;
 }
+
+#ifdef DGST_JOBS
+
+/*
+ * Regular files up to DGST_SMALL bytes are read whole and hashed
+ * DGST_BATCH at a time with EVP_Digest_batch(), larger ones are mapped.
+ */
+# define DGST_SMALL      (32 * 1024)
+# define DGST_BATCH      16
+
+# define DGST_OK         0
+# define DGST_EOPEN      1
+# define DGST_EREAD      2
+# define DGST_EDIGEST    3
+
+typedef struct {
+    const char *name;
+    int status;
+    int sys_err;                /* errno if the file could not be read */
+    unsigned int len;
+    unsigned char md[EVP_MAX_MD_SIZE];
+} DGST_FILE;
+
+typedef struct {
+    const EVP_MD *md;
+    ENGINE *impl;
+    DGST_FILE *files;
+    int num;
+    int next;                   /* first file not yet taken by a worker */
+# ifdef OPENSSL_THREADS
+    pthread_mutex_t lock;
+# endif
+} DGST_WORK;
+
+/* Take the next DGST_BATCH files, returns the first or -1 when done */
+static int dgst_take(DGST_WORK *w)
+{
+    int first;
+
+# ifdef OPENSSL_THREADS
+    pthread_mutex_lock(&w->lock);
+# endif
+    first = w->next < w->num ? w->next : -1;
+    if (first >= 0)
+        w->next += DGST_BATCH;
+# ifdef OPENSSL_THREADS
+    pthread_mutex_unlock(&w->lock);
+# endif
+    return first;
+}
+
+/* Read up to |len| bytes, stopping short only at end of file */
+static ssize_t dgst_read(int fd, unsigned char *buf, size_t len)
+{
+    size_t done = 0;
+    ssize_t n;
+
+    while (done < len) {
+        n = read(fd, buf + done, len - done);
+        if (n == 0)
+            break;
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        done += n;
+    }
+    return done;
+}
+
+/*
+ * Hash |head| followed by whatever is left to read from |fd|, using |buf|
+ * (BUFSIZE bytes) for the reads.
+ */
+static void dgst_stream(DGST_WORK *w, DGST_FILE *f, int fd,
+                        const unsigned char *head, size_t headlen,
+                        unsigned char *buf)
+{
+    EVP_MD_CTX ctx;
+    ssize_t n;
+
+    EVP_MD_CTX_init(&ctx);
+    f->status = DGST_EDIGEST;
+    if (!EVP_DigestInit_ex(&ctx, w->md, w->impl)
+        || !EVP_DigestUpdate(&ctx, head, headlen))
+        goto end;
+    while ((n = dgst_read(fd, buf, BUFSIZE)) != 0) {
+        if (n < 0) {
+            f->status = DGST_EREAD;
+            f->sys_err = errno;
+            goto end;
+        }
+        if (!EVP_DigestUpdate(&ctx, buf, n))
+            goto end;
+    }
+    if (EVP_DigestFinal_ex(&ctx, f->md, &f->len))
+        f->status = DGST_OK;
+ end:
+    EVP_MD_CTX_cleanup(&ctx);
+}
+
+/*
+ * Hash the files from |first| on. |buf| holds DGST_BATCH small files of up
+ * to DGST_SMALL + 1 bytes, followed by BUFSIZE bytes for reading others.
+ */
+static void dgst_batch(DGST_WORK *w, int first, unsigned char *buf)
+{
+    const unsigned char *data[DGST_BATCH];
+    size_t count[DGST_BATCH];
+    unsigned char *mds[DGST_BATCH];
+    DGST_FILE *small[DGST_BATCH];
+    unsigned char *rbuf = buf + DGST_BATCH * (DGST_SMALL + 1), *p;
+    int i, num = 0, last = first + DGST_BATCH, fd, ok;
+    struct stat st;
+    ssize_t n;
+    void *map;
+
+    if (last > w->num)
+        last = w->num;
+    for (i = first; i < last; i++) {
+        DGST_FILE *f = &w->files[i];
+
+        if ((fd = open(f->name, O_RDONLY)) < 0) {
+            f->status = DGST_EOPEN;
+            f->sys_err = errno;
+            continue;
+        }
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+            dgst_stream(w, f, fd, NULL, 0, rbuf);
+        } else if (st.st_size <= DGST_SMALL) {
+            /* Read one byte more to notice files that have grown */
+            p = buf + num * (DGST_SMALL + 1);
+            if ((n = dgst_read(fd, p, DGST_SMALL + 1)) < 0) {
+                f->status = DGST_EREAD;
+                f->sys_err = errno;
+            } else if (n > DGST_SMALL) {
+                dgst_stream(w, f, fd, p, n, rbuf);
+            } else {
+                data[num] = p;
+                count[num] = n;
+                mds[num] = f->md;
+                small[num++] = f;
+            }
+        } else if ((off_t)(size_t)st.st_size != st.st_size
+                   || (map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE,
+                                  fd, 0)) == MAP_FAILED) {
+            dgst_stream(w, f, fd, NULL, 0, rbuf);
+        } else {
+# ifdef MADV_SEQUENTIAL
+            madvise(map, st.st_size, MADV_SEQUENTIAL);
+# endif
+            /* Carry on from the end of the mapping if the file has grown */
+            if (lseek(fd, st.st_size, SEEK_SET) == (off_t)-1) {
+                f->status = DGST_EREAD;
+                f->sys_err = errno;
+            } else {
+                dgst_stream(w, f, fd, map, st.st_size, rbuf);
+            }
+            munmap(map, st.st_size);
+        }
+        close(fd);
+    }
+
+    if (num == 0)
+        return;
+    ok = EVP_Digest_batch(data, count, mds, num, w->md, w->impl);
+    for (i = 0; i < num; i++) {
+        small[i]->status = ok ? DGST_OK : DGST_EDIGEST;
+        small[i]->len = EVP_MD_size(w->md);
+    }
+}
+
+/* Returns 0 if out of memory, in which case no files were taken */
+static int dgst_worker(DGST_WORK *w)
+{
+    size_t len = DGST_BATCH * (DGST_SMALL + 1) + BUFSIZE;
+    unsigned char *buf;
+    int first;
+
+    if ((buf = OPENSSL_malloc(len)) == NULL)
+        return 0;
+    while ((first = dgst_take(w)) >= 0)
+        dgst_batch(w, first, buf);
+    OPENSSL_cleanse(buf, len);
+    OPENSSL_free(buf);
+    return 1;
+}
+
+# ifdef OPENSSL_THREADS
+static void *dgst_thread(void *arg)
+{
+    int ok = dgst_worker(arg);
+
+    ERR_remove_thread_state(NULL);
+    return ok ? arg : NULL;
+}
+# endif
+
+/*
+ * Digest |num| files on |jobs| threads and print the results in the order
+ * the files were given, in the same format as do_fp().
+ */
+static int do_files(BIO *out, char **files, int num, int jobs, int sep,
+                    int binout, const char *md_name, const EVP_MD *md,
+                    ENGINE *impl)
+{
+    DGST_WORK w;
+    int i, err = 0, ok;
+# ifdef OPENSSL_THREADS
+    pthread_t *threads = NULL;
+    int started = 0;
+# endif
+
+    memset(&w, 0, sizeof(w));
+    w.md = md;
+    w.impl = impl;
+    w.num = num;
+    w.files = OPENSSL_malloc(num * sizeof(*w.files));
+    if (w.files == NULL) {
+        BIO_printf(bio_err, "Out of memory\n");
+        return 1;
+    }
+    memset(w.files, 0, num * sizeof(*w.files));
+    for (i = 0; i < num; i++)
+        w.files[i].name = files[i];
+
+# ifdef OPENSSL_THREADS
+    pthread_mutex_init(&w.lock, NULL);
+    /* This thread is the last worker */
+    if (jobs > 1
+        && (threads = OPENSSL_malloc((jobs - 1) * sizeof(*threads))) != NULL)
+        for (; started < jobs - 1; started++)
+            if (pthread_create(&threads[started], NULL, dgst_thread, &w) != 0)
+                break;
+# endif
+    ok = dgst_worker(&w);
+# ifdef OPENSSL_THREADS
+    for (i = 0; i < started; i++) {
+        void *r;
+
+        pthread_join(threads[i], &r);
+        ok |= r != NULL;
+    }
+    if (threads != NULL)
+        OPENSSL_free(threads);
+    pthread_mutex_destroy(&w.lock);
+# endif
+    if (!ok) {
+        BIO_printf(bio_err, "Out of memory\n");
+        OPENSSL_free(w.files);
+        return 1;
+    }
+
+    for (i = 0; i < num; i++) {
+        DGST_FILE *f = &w.files[i];
+
+        switch (f->status) {
+        case DGST_OK:
+            print_md(out, f->md, f->len, sep, binout, NULL, md_name, f->name);
+            break;
+        case DGST_EOPEN:
+            errno = f->sys_err;
+            perror(f->name);
+            err++;
+            break;
+        case DGST_EREAD:
+            /* Report it the way a BIO_s_file() read in the serial path does */
+            BIO_printf(bio_err, "Read Error in %s\n", f->name);
+            SYSerr(SYS_F_FREAD, f->sys_err);
+            BIOerr(BIO_F_FILE_READ, ERR_R_SYS_LIB);
+            ERR_print_errors(bio_err);
+            err = 1;
+            break;
+        default:
+            BIO_printf(bio_err, "Error computing digest of %s\n", f->name);
+            ERR_print_errors(bio_err);
+            err = 1;
+            break;
+        }
+    }
+    OPENSSL_free(w.files);
+    return err;
+}
+#endif
@@ -162,7 +162,7 @@ int MAIN(int argc, char **argv)
 # ifndef OPENSSL_NO_ENGINE
     char *engine = NULL;
 # endif
-    int num = 0, g = 0;
+    int num = 0, g = 0, threads = 1;
 
     apps_startup();
 
@@ -222,6 +222,11 @@ int MAIN(int argc, char **argv)
             g = 2;
         else if (strcmp(*argv, "-5") == 0)
             g = 5;
+        else if (strcmp(*argv, "-threads") == 0) {
+            if (--argc < 1)
+                goto bad;
+            threads = atoi(*(++argv));
+        }
         else if (strcmp(*argv, "-rand") == 0) {
             if (--argc < 1)
                 goto bad;
@@ -253,6 +258,8 @@ int MAIN(int argc, char **argv)
                    " -2            generate parameters using  2 as the generator value\n");
         BIO_printf(bio_err,
                    " -5            generate parameters using  5 as the generator value\n");
+        BIO_printf(bio_err,
+                   " -threads n    search for primes on n threads\n");
         BIO_printf(bio_err,
                    " numbits       number of bits in to generate (default 2048)\n");
 # ifndef OPENSSL_NO_ENGINE
@@ -274,6 +281,9 @@ int MAIN(int argc, char **argv)
     setup_engine(bio_err, engine, 0);
 # endif
 
+    if (!set_prime_search_threads(bio_err, threads))
+        goto end;
+
     if (g && !num)
         num = DEFBITS;
 
@@ -112,7 +112,7 @@ int MAIN(int argc, char **argv)
     BIO *in = NULL, *out = NULL;
     int informat, outformat, noout = 0, C = 0, ret = 1;
     char *infile, *outfile, *prog, *inrand = NULL;
-    int numbits = -1, num, genkey = 0;
+    int numbits = -1, num, genkey = 0, threads = 1;
     int need_rand = 0;
     int non_fips_allow = 0;
     BN_GENCB *cb = NULL;
@@ -184,6 +184,10 @@ int MAIN(int argc, char **argv)
                 goto bad;
             inrand = *(++argv);
             need_rand = 1;
+        } else if (strcmp(*argv, "-threads") == 0) {
+            if (--argc < 1)
+                goto bad;
+            threads = atoi(*(++argv));
         } else if (strcmp(*argv, "-noout") == 0)
             noout = 1;
         else if (strcmp(*argv, "-non-fips-allow") == 0)
@@ -215,6 +219,8 @@ int MAIN(int argc, char **argv)
         BIO_printf(bio_err, " -genkey       generate a DSA key\n");
         BIO_printf(bio_err,
                    " -rand         files to use for random number input\n");
+        BIO_printf(bio_err,
+                   " -threads n    search for primes on n threads\n");
 # ifndef OPENSSL_NO_ENGINE
         BIO_printf(bio_err,
                    " -engine e     use engine e, possibly a hardware device.\n");
@@ -264,6 +270,9 @@ int MAIN(int argc, char **argv)
     setup_engine(bio_err, engine, 0);
 # endif
 
+    if (!set_prime_search_threads(bio_err, threads))
+        goto end;
+
     if (need_rand) {
         app_RAND_load_file(NULL, bio_err, (inrand != NULL));
         if (inrand != NULL)
@@ -108,6 +108,7 @@
  *                                     explicit
  * -no_seed         - if 'explicit' parameters are chosen do not use the seed
  * -genkey          - generate ec key
+ * -precompute file - write the generator precomputation table to file
  * -rand file       - files to use for random number input
  * -engine e        - use engine e, possibly a hardware device
  */
@@ -130,7 +131,7 @@ int MAIN(int argc, char **argv)
     char *infile = NULL, *outfile = NULL, *prog;
     BIO *in = NULL, *out = NULL;
     int informat, outformat, noout = 0, C = 0, ret = 1;
-    char *engine = NULL;
+    char *engine = NULL, *precompfile = NULL;
 
     BIGNUM *ec_p = NULL, *ec_a = NULL, *ec_b = NULL,
         *ec_gen = NULL, *ec_order = NULL, *ec_cofactor = NULL;
@@ -211,6 +212,10 @@ int MAIN(int argc, char **argv)
         else if (strcmp(*argv, "-genkey") == 0) {
             genkey = 1;
             need_rand = 1;
+        } else if (strcmp(*argv, "-precompute") == 0) {
+            if (--argc < 1)
+                goto bad;
+            precompfile = *(++argv);
         } else if (strcmp(*argv, "-rand") == 0) {
             if (--argc < 1)
                 goto bad;
@@ -272,6 +277,8 @@ int MAIN(int argc, char **argv)
         BIO_printf(bio_err, " -no_seed          if 'explicit'"
                    " parameters are chosen do not" " use the seed\n");
         BIO_printf(bio_err, " -genkey           generate ec" " key\n");
+        BIO_printf(bio_err, " -precompute file  write the generator"
+                   " precomputation table to file\n");
         BIO_printf(bio_err, " -rand file        files to use for"
                    " random number input\n");
         BIO_printf(bio_err, " -engine e         use engine e, "
@@ -566,6 +573,29 @@ int MAIN(int argc, char **argv)
         }
     }
 
+    if (precompfile != NULL) {
+        BIO *pre = NULL;
+        unsigned char *tab = NULL;
+        size_t tablen = 0;
+
+        i = (EC_GROUP_have_precompute_mult(group)
+             || EC_GROUP_precompute_mult(group, NULL))
+            && (tablen = EC_GROUP_get_precompute_mult_data(group, NULL, 0,
+                                                           NULL)) != 0
+            && (tab = OPENSSL_malloc(tablen)) != NULL
+            && EC_GROUP_get_precompute_mult_data(group, tab, tablen,
+                                                 NULL) == tablen
+            && (pre = BIO_new_file(precompfile, "wb")) != NULL
+            && BIO_write(pre, tab, tablen) == (int)tablen;
+        BIO_free(pre);
+        OPENSSL_free(tab);
+        if (!i) {
+            BIO_printf(bio_err, "unable to write precomputation table\n");
+            ERR_print_errors(bio_err);
+            goto end;
+        }
+    }
+
     if (need_rand) {
         app_RAND_load_file(NULL, bio_err, (inrand != NULL));
         if (inrand != NULL)
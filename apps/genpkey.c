@@ -155,6 +155,11 @@ int MAIN(int argc, char **argv)
             if (ctx)
                 goto bad;
             do_param = 1;
+        } else if (strcmp(*args, "-threads") == 0) {
+            if (!args[1])
+                goto bad;
+            if (!set_prime_search_threads(bio_err, atoi(*(++args))))
+                goto end;
         } else if (strcmp(*args, "-text") == 0)
             text = 1;
         else {
@@ -194,6 +199,8 @@ int MAIN(int argc, char **argv)
                    "                   to value <value>\n");
         BIO_printf(bio_err,
                    "-genparam          generate parameters, not key\n");
+        BIO_printf(bio_err,
+                   "-threads n         search for primes on n threads\n");
         BIO_printf(bio_err, "-text              print the in text\n");
         BIO_printf(bio_err,
                    "NB: options order may be important!  See the manual page.\n");
@@ -89,7 +89,7 @@ int MAIN(int argc, char **argv)
 # endif
     int ret = 1;
     int non_fips_allow = 0;
-    int num = DEFBITS;
+    int num = DEFBITS, primes = RSA_DEFAULT_PRIME_NUM, threads = 1;
     const EVP_CIPHER *enc = NULL;
     unsigned long f4 = RSA_F4;
     char *outfile = NULL;
@@ -137,6 +137,16 @@ int MAIN(int argc, char **argv)
             f4 = 3;
         else if (strcmp(*argv, "-F4") == 0 || strcmp(*argv, "-f4") == 0)
             f4 = RSA_F4;
+        else if (strcmp(*argv, "-primes") == 0) {
+            if (--argc < 1)
+                goto bad;
+            primes = atoi(*(++argv));
+        }
+        else if (strcmp(*argv, "-threads") == 0) {
+            if (--argc < 1)
+                goto bad;
+            threads = atoi(*(++argv));
+        }
 # ifndef OPENSSL_NO_ENGINE
         else if (strcmp(*argv, "-engine") == 0) {
             if (--argc < 1)
@@ -222,6 +232,10 @@ int MAIN(int argc, char **argv)
         BIO_printf(bio_err,
                    " -f4             use F4 (0x10001) for the E value\n");
         BIO_printf(bio_err, " -3              use 3 for the E value\n");
+        BIO_printf(bio_err,
+                   " -primes n       generate a key with n primes (default 2)\n");
+        BIO_printf(bio_err,
+                   " -threads n      search for primes on n threads\n");
 # ifndef OPENSSL_NO_ENGINE
         BIO_printf(bio_err,
                    " -engine e       use engine e, possibly a hardware device.\n");
@@ -244,6 +258,9 @@ int MAIN(int argc, char **argv)
     e = setup_engine(bio_err, engine, 0);
 # endif
 
+    if (!set_prime_search_threads(bio_err, threads))
+        goto err;
+
     if (outfile == NULL) {
         BIO_set_fp(out, stdout, BIO_NOCLOSE);
 # ifdef OPENSSL_SYS_VMS
@@ -281,7 +298,8 @@ int MAIN(int argc, char **argv)
     if (non_fips_allow)
         rsa->flags |= RSA_FLAG_NON_FIPS_ALLOW;
 
-    if (!BN_set_word(bn, f4) || !RSA_generate_key_ex(rsa, num, bn, cb))
+    if (!BN_set_word(bn, f4)
+        || !RSA_generate_multi_prime_key(rsa, num, primes, bn, cb))
         goto err;
 
     app_RAND_write_file(NULL, bio_err);
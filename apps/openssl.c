@@ -429,6 +429,7 @@ int main(int Argc, char *ARGV[])
         OPENSSL_free(Argv);
     }
 #endif
+    cleanup_threads();
     apps_shutdown();
     CRYPTO_mem_leaks(bio_err);
     BIO_free(bio_err);
@@ -534,6 +534,11 @@ int ssl_print_tmp_key(BIO *out, SSL *s)
                 cname = OBJ_nid2sn(nid);
             BIO_printf(out, "ECDH, %s, %d bits\n", cname, EVP_PKEY_bits(key));
         }
+        break;
+
+    case EVP_PKEY_X25519:
+        BIO_printf(out, "X25519, %d bits\n", EVP_PKEY_bits(key));
+        break;
 #endif
     }
     EVP_PKEY_free(key);
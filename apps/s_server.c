@@ -202,6 +202,7 @@ static void close_accept_socket(void);
 static void sv_usage(void);
 static int init_ssl_connection(SSL *s);
 static void print_stats(BIO *bp, SSL_CTX *ctx);
+static void print_record_stats(BIO *bp, SSL *s);
 static int generate_session_id(const SSL *ssl, unsigned char *id,
                                unsigned int *id_len);
 static void init_session_cache_ctx(SSL_CTX *sctx);
@@ -258,6 +259,7 @@ static int s_tlsextstatus = 0;
 static int cert_status_cb(SSL *s, void *arg);
 #endif
 static int no_resume_ephemeral = 0;
+static int dynamic_records = 0;
 static int s_msg = 0;
 static int s_quiet = 0;
 static int s_ign_eof = 0;
@@ -550,6 +552,8 @@ static void sv_usage(void)
 #endif
     BIO_printf(bio_err,
                "-no_resume_ephemeral - Disable caching and tickets if ephemeral (EC)DH is used\n");
+    BIO_printf(bio_err,
+               " -dynamic_records - Start with small records, grow them as data is sent\n");
     BIO_printf(bio_err, " -bugs         - Turn on SSL bug compatibility\n");
     BIO_printf(bio_err,
                " -www          - Respond to a 'GET /' with a status page\n");
@@ -1351,6 +1355,8 @@ int MAIN(int argc, char *argv[])
             no_ecdhe = 1;
         } else if (strcmp(*argv, "-no_resume_ephemeral") == 0) {
             no_resume_ephemeral = 1;
+        } else if (strcmp(*argv, "-dynamic_records") == 0) {
+            dynamic_records = 1;
         }
 #ifndef OPENSSL_NO_PSK
         else if (strcmp(*argv, "-psk_hint") == 0) {
@@ -1895,6 +1901,14 @@ int MAIN(int argc, char *argv[])
     }
 #endif
 
+    if (dynamic_records) {
+        SSL_CTX_set_mode(ctx, SSL_MODE_DYNAMIC_RECORD_SIZE);
+#ifndef OPENSSL_NO_TLSEXT
+        if (ctx2)
+            SSL_CTX_set_mode(ctx2, SSL_MODE_DYNAMIC_RECORD_SIZE);
+#endif
+    }
+
     if (no_resume_ephemeral) {
         SSL_CTX_set_not_resumable_session_callback(ctx,
                                                    not_resumable_sess_cb);
@@ -2086,6 +2100,17 @@ static void print_stats(BIO *bio, SSL_CTX *ssl_ctx)
                SSL_CTX_sess_get_cache_size(ssl_ctx));
 }
 
+static void print_record_stats(BIO *bio, SSL *s)
+{
+    unsigned long counts[SSL_RECORD_SIZE_BUCKETS];
+    int i, n;
+
+    n = SSL_get_record_size_stats(s, counts, SSL_RECORD_SIZE_BUCKETS);
+    for (i = 0; i < n; i++)
+        BIO_printf(bio, "%4lu records of up to %d bytes sent\n", counts[i],
+                   512 << i);
+}
+
 static int sv_body(char *hostname, int s, int stype, unsigned char *context)
 {
     char *buf = NULL;
@@ -2360,6 +2385,7 @@ static int sv_body(char *hostname, int s, int stype, unsigned char *context)
                 }
                 if (buf[0] == 'S') {
                     print_stats(bio_s_out, SSL_get_SSL_CTX(con));
+                    print_record_stats(bio_s_out, con);
                 }
             }
 #ifdef CHARSET_EBCDIC
@@ -2858,6 +2884,7 @@ static int www_body(char *hostname, int s, int stype, unsigned char *context)
             SSL_SESSION_print(io, SSL_get_session(con));
             BIO_printf(io, "---\n");
             print_stats(io, SSL_get_SSL_CTX(con));
+            print_record_stats(io, con);
             BIO_printf(io, "---\n");
             peer = SSL_get_peer_certificate(con);
             if (peer != NULL) {
@@ -218,7 +218,8 @@ static int do_multi(int multi);
 #define RSA_NUM         7
 #define DSA_NUM         3
 
-#define EC_NUM       16
+#define ECDSA_NUM    16
+#define EC_NUM       18
 #define MAX_ECDH_SIZE 256
 
 static const char *names[ALGOR_NUM] = {
@@ -339,6 +340,66 @@ static void *KDF1_SHA1(const void *in, size_t inlen, void *out,
 #endif                         /* OPENSSL_NO_EC */
 
 static void multiblock_speed(const EVP_CIPHER *evp_cipher);
+/* Largest data unit size for -xts, which times buffers of this size */
+#define XTS_SPEED_LEN   (1024 * 1024)
+static void xts_units_speed(const EVP_CIPHER *evp_cipher, int unit_len,
+                            int threads, int decrypt);
+#ifndef OPENSSL_NO_AES
+static void aead_speed(const EVP_CIPHER *evp_cipher, const EVP_AEAD *aead);
+#endif
+
+#ifndef OPENSSL_NO_RSA
+/* State for signing with EVP_PKEY_sign_batch() */
+typedef struct {
+    int num;
+    EVP_PKEY_CTX **ctx;
+    unsigned char **sig;
+    size_t *siglen;
+    const unsigned char **tbs;
+    size_t *tbslen;
+} RSA_BATCH;
+
+static RSA_BATCH *rsa_batch_new(RSA *rsa, int num, const unsigned char *tbs,
+                                size_t tbslen);
+static int rsa_batch_sign(RSA_BATCH *b);
+static void rsa_batch_free(RSA_BATCH *b);
+#endif
+#ifndef OPENSSL_NO_ECDSA
+/* Arguments of ECDSA_do_verify_batch() */
+typedef struct {
+    int num;
+    const unsigned char **dgst;
+    int *dgst_len;
+    const ECDSA_SIG **sig;
+    EC_KEY **eckey;
+    int *ret;
+    ECDSA_SIG *s;
+} ECDSA_BATCH;
+
+static ECDSA_BATCH *ecdsa_batch_new(EC_KEY *eckey, int num,
+                                    const unsigned char *dgst, int dgst_len,
+                                    const unsigned char *sig, int sig_len);
+static void ecdsa_batch_free(ECDSA_BATCH *b);
+#endif
+#ifndef OPENSSL_NO_EC
+/* Arguments of EVP_PKEY_verify_batch() */
+typedef struct {
+    int num;
+    EVP_PKEY_CTX **ctx;
+    const unsigned char **sig;
+    size_t *siglen;
+    const unsigned char **tbs;
+    size_t *tbslen;
+    int *ret;
+} ED25519_BATCH;
+
+static ED25519_BATCH *ed25519_batch_new(EVP_PKEY_CTX *ctx, int num,
+                                        const unsigned char *tbs,
+                                        size_t tbslen,
+                                        const unsigned char *sig,
+                                        size_t siglen);
+static void ed25519_batch_free(ED25519_BATCH *b);
+#endif
 
 int MAIN(int, char **);
 
@@ -515,6 +576,8 @@ int MAIN(int argc, char **argv)
 #define R_EC_B283    13
 #define R_EC_B409    14
 #define R_EC_B571    15
+#define R_EC_X25519  16
+#define R_EC_ED25519 17
 
 #ifndef OPENSSL_NO_RSA
     RSA *rsa_key[RSA_NUM];
@@ -561,7 +624,10 @@ int MAIN(int argc, char **argv)
         NID_sect233r1,
         NID_sect283r1,
         NID_sect409r1,
-        NID_sect571r1
+        NID_sect571r1,
+        /* Other */
+        NID_X25519,
+        NID_ED25519
     };
     static const char *test_curves_names[EC_NUM] = {
         /* Prime Curves */
@@ -581,12 +647,16 @@ int MAIN(int argc, char **argv)
         "nistb233",
         "nistb283",
         "nistb409",
-        "nistb571"
+        "nistb571",
+        /* Other */
+        "X25519",
+        "Ed25519"
     };
     static int test_curves_bits[EC_NUM] = {
         160, 192, 224, 256, 384, 521,
         163, 233, 283, 409, 571,
-        163, 233, 283, 409, 571
+        163, 233, 283, 409, 571,
+        253, 253
     };
 
 #endif
@@ -594,7 +664,7 @@ int MAIN(int argc, char **argv)
 #ifndef OPENSSL_NO_EC
     unsigned char ecdsasig[256];
     unsigned int ecdsasiglen;
-    EC_KEY *ecdsa[EC_NUM];
+    EC_KEY *ecdsa[ECDSA_NUM];
     long ecdsa_c[EC_NUM][2];
     EC_KEY *ecdh_a[EC_NUM], *ecdh_b[EC_NUM];
     unsigned char secret_a[MAX_ECDH_SIZE], secret_b[MAX_ECDH_SIZE];
@@ -617,7 +687,20 @@ int MAIN(int argc, char **argv)
     int multi = 0;
 #endif
     int multiblock = 0;
+    int xts_unit = 0, xts_threads = 1;
+    int aead = 0;
     int misalign = MAX_MISALIGNMENT + 1;
+    int batch_num = 1;
+#ifndef OPENSSL_NO_RSA
+    int primes = RSA_DEFAULT_PRIME_NUM;
+    RSA_BATCH *batch = NULL;
+#endif
+#ifndef OPENSSL_NO_ECDSA
+    ECDSA_BATCH *ecdsa_batch = NULL;
+#endif
+#ifndef OPENSSL_NO_EC
+    ED25519_BATCH *ed25519_batch = NULL;
+#endif
 
 #ifndef TIMES
     usertime = -1;
@@ -629,7 +712,7 @@ int MAIN(int argc, char **argv)
     memset(dsa_key, 0, sizeof(dsa_key));
 #endif
 #ifndef OPENSSL_NO_EC
-    for (i = 0; i < EC_NUM; i++)
+    for (i = 0; i < ECDSA_NUM; i++)
         ecdsa[i] = NULL;
     for (i = 0; i < EC_NUM; i++) {
         ecdh_a[i] = NULL;
@@ -746,6 +829,36 @@ int MAIN(int argc, char **argv)
             j--;                /* Otherwise, -mr gets confused with an
                                  * algorithm. */
         }
+#endif
+        else if ((argc > 0) && (strcmp(*argv, "-batch") == 0)) {
+            argc--;
+            argv++;
+            if (argc == 0) {
+                BIO_printf(bio_err, "no batch size given\n");
+                goto end;
+            }
+            batch_num = atoi(argv[0]);
+            if (batch_num <= 0) {
+                BIO_printf(bio_err, "bad batch size\n");
+                goto end;
+            }
+            j--;
+        }
+#ifndef OPENSSL_NO_RSA
+        else if ((argc > 0) && (strcmp(*argv, "-primes") == 0)) {
+            argc--;
+            argv++;
+            if (argc == 0) {
+                BIO_printf(bio_err, "no number of primes given\n");
+                goto end;
+            }
+            primes = atoi(argv[0]);
+            if (primes < RSA_DEFAULT_PRIME_NUM || primes > RSA_MAX_PRIME_NUM) {
+                BIO_printf(bio_err, "bad number of primes\n");
+                goto end;
+            }
+            j--;
+        }
 #endif
         else if (argc > 0 && !strcmp(*argv, "-mr")) {
             mr = 1;
@@ -754,6 +867,36 @@ int MAIN(int argc, char **argv)
         } else if (argc > 0 && !strcmp(*argv, "-mb")) {
             multiblock = 1;
             j--;
+        } else if (argc > 0 && !strcmp(*argv, "-xts")) {
+            argc--;
+            argv++;
+            if (argc == 0) {
+                BIO_printf(bio_err, "no XTS data unit length given\n");
+                goto end;
+            }
+            xts_unit = atoi(argv[0]);
+            if (xts_unit < 16 || xts_unit % 16 != 0
+                || xts_unit > XTS_SPEED_LEN) {
+                BIO_printf(bio_err, "bad XTS data unit length\n");
+                goto end;
+            }
+            j--;
+        } else if (argc > 0 && !strcmp(*argv, "-xts_threads")) {
+            argc--;
+            argv++;
+            if (argc == 0) {
+                BIO_printf(bio_err, "no number of threads given\n");
+                goto end;
+            }
+            xts_threads = atoi(argv[0]);
+            if (xts_threads <= 0) {
+                BIO_printf(bio_err, "bad number of threads\n");
+                goto end;
+            }
+            j--;
+        } else if (argc > 0 && !strcmp(*argv, "-aead")) {
+            aead = 1;
+            j--;
         } else if (argc > 0 && !strcmp(*argv, "-misalign")) {
             argc--;
             argv++;
@@ -1005,9 +1148,11 @@ int MAIN(int argc, char **argv)
         else if (strcmp(*argv, "ecdsab571") == 0)
             ecdsa_doit[R_EC_B571] = 2;
         else if (strcmp(*argv, "ecdsa") == 0) {
-            for (i = 0; i < EC_NUM; i++)
+            for (i = 0; i < ECDSA_NUM; i++)
                 ecdsa_doit[i] = 1;
-        } else if (strcmp(*argv, "ecdhp160") == 0)
+        } else if (strcmp(*argv, "ed25519") == 0)
+            ecdsa_doit[R_EC_ED25519] = 2;
+        else if (strcmp(*argv, "ecdhp160") == 0)
             ecdh_doit[R_EC_P160] = 2;
         else if (strcmp(*argv, "ecdhp192") == 0)
             ecdh_doit[R_EC_P192] = 2;
@@ -1039,8 +1184,10 @@ int MAIN(int argc, char **argv)
             ecdh_doit[R_EC_B409] = 2;
         else if (strcmp(*argv, "ecdhb571") == 0)
             ecdh_doit[R_EC_B571] = 2;
+        else if (strcmp(*argv, "ecdhx25519") == 0)
+            ecdh_doit[R_EC_X25519] = 2;
         else if (strcmp(*argv, "ecdh") == 0) {
-            for (i = 0; i < EC_NUM; i++)
+            for (i = 0; i <= R_EC_X25519; i++)
                 ecdh_doit[i] = 1;
         } else
 #endif
@@ -1125,12 +1272,14 @@ int MAIN(int argc, char **argv)
             BIO_printf(bio_err,
                        "ecdsab163 ecdsab233 ecdsab283 ecdsab409 ecdsab571\n");
             BIO_printf(bio_err, "ecdsa\n");
+            BIO_printf(bio_err, "ed25519\n");
             BIO_printf(bio_err, "ecdhp160  ecdhp192  ecdhp224 "
                        "ecdhp256  ecdhp384  ecdhp521\n");
             BIO_printf(bio_err,
                        "ecdhk163  ecdhk233  ecdhk283  ecdhk409  ecdhk571\n");
             BIO_printf(bio_err,
                        "ecdhb163  ecdhb233  ecdhb283  ecdhb409  ecdhb571\n");
+            BIO_printf(bio_err, "ecdhx25519\n");
             BIO_printf(bio_err, "ecdh\n");
 #endif
 
@@ -1186,12 +1335,32 @@ int MAIN(int argc, char **argv)
             BIO_printf(bio_err,
                        "-mb             "
                        "perform multi-block benchmark (for specific ciphers)\n");
+            BIO_printf(bio_err,
+                       "-xts n          "
+                       "compare one EVP call per n byte XTS data unit with\n"
+                       "                one call per buffer (with -evp).\n");
+            BIO_printf(bio_err,
+                       "-xts_threads n  "
+                       "also time the -xts buffers spread over n threads.\n");
+            BIO_printf(bio_err,
+                       "-aead           "
+                       "compare EVP_CIPHER and EVP_AEAD sealing of short\n"
+                       "                messages (with -evp, GCM and CCM).\n");
             BIO_printf(bio_err,
                        "-misalign n     "
                        "perform benchmark with misaligned data\n");
 #ifndef NO_FORK
             BIO_printf(bio_err,
                        "-multi n        " "run n benchmarks in parallel.\n");
+#endif
+            BIO_printf(bio_err,
+                       "-batch n        "
+                       "perform n RSA signatures or ECDSA/Ed25519 verifications\n"
+                       "                per call.\n");
+#ifndef OPENSSL_NO_RSA
+            BIO_printf(bio_err,
+                       "-primes n       "
+                       "use newly generated RSA keys with n primes.\n");
 #endif
             goto end;
         }
@@ -1215,9 +1384,10 @@ int MAIN(int argc, char **argv)
         for (i = 0; i < DSA_NUM; i++)
             dsa_doit[i] = 1;
 #ifndef OPENSSL_NO_EC
-        for (i = 0; i < EC_NUM; i++)
+        for (i = 0; i < ECDSA_NUM; i++)
             ecdsa_doit[i] = 1;
-        for (i = 0; i < EC_NUM; i++)
+        ecdsa_doit[R_EC_ED25519] = 1;
+        for (i = 0; i <= R_EC_X25519; i++)
             ecdh_doit[i] = 1;
 #endif
     }
@@ -1241,6 +1411,25 @@ int MAIN(int argc, char **argv)
                        i);
             goto end;
         }
+        if (rsa_doit[i] && primes != RSA_DEFAULT_PRIME_NUM) {
+            BIGNUM *e = BN_new();
+
+            if (primes > RSA_multi_prime_cap(rsa_bits[i])) {
+                BIO_printf(bio_err, "skipping rsa%d, too small for %d primes\n",
+                           rsa_bits[i], primes);
+                rsa_doit[i] = 0;
+            } else if (e == NULL || !BN_set_word(e, RSA_F4)
+                       || !RSA_generate_multi_prime_key(rsa_key[i],
+                                                        rsa_bits[i], primes,
+                                                        e, NULL)) {
+                BIO_printf(bio_err, "error generating RSA key number %d\n",
+                           i);
+                ERR_print_errors(bio_err);
+                BN_free(e);
+                goto end;
+            }
+            BN_free(e);
+        }
     }
 #endif
 
@@ -1491,6 +1680,10 @@ int MAIN(int argc, char **argv)
             }
         }
     }
+    ecdh_c[R_EC_X25519][0] = count / 1000;
+    ecdh_c[R_EC_X25519][1] = count / 1000;
+    ecdsa_c[R_EC_ED25519][0] = count / 1000;
+    ecdsa_c[R_EC_ED25519][1] = count / 1000 / 2;
 #  endif
 
 #  define COND(d) (count < (d))
@@ -1914,6 +2107,52 @@ int MAIN(int argc, char **argv)
             goto end;
         }
 #endif
+        if (xts_unit && evp_cipher) {
+            if (EVP_CIPHER_mode(evp_cipher) != EVP_CIPH_XTS_MODE) {
+                fprintf(stderr, "%s is not an XTS mode cipher\n",
+                        OBJ_nid2ln(evp_cipher->nid));
+                goto end;
+            }
+            xts_units_speed(evp_cipher, xts_unit, xts_threads, decrypt);
+            mret = 0;
+            goto end;
+        }
+        if (aead && evp_cipher) {
+            const EVP_AEAD *evp_aead = NULL;
+
+#ifndef OPENSSL_NO_AES
+            switch (EVP_CIPHER_nid(evp_cipher)) {
+            case NID_aes_128_gcm:
+                evp_aead = EVP_aead_aes_128_gcm();
+                break;
+            case NID_aes_192_gcm:
+                evp_aead = EVP_aead_aes_192_gcm();
+                break;
+            case NID_aes_256_gcm:
+                evp_aead = EVP_aead_aes_256_gcm();
+                break;
+            case NID_aes_128_ccm:
+                evp_aead = EVP_aead_aes_128_ccm();
+                break;
+            case NID_aes_192_ccm:
+                evp_aead = EVP_aead_aes_192_ccm();
+                break;
+            case NID_aes_256_ccm:
+                evp_aead = EVP_aead_aes_256_ccm();
+                break;
+            }
+#endif
+            if (evp_aead == NULL) {
+                fprintf(stderr, "%s has no EVP_AEAD counterpart\n",
+                        OBJ_nid2ln(evp_cipher->nid));
+                goto end;
+            }
+#ifndef OPENSSL_NO_AES
+            aead_speed(evp_cipher, evp_aead);
+#endif
+            mret = 0;
+            goto end;
+        }
         for (j = 0; j < SIZE_NUM; j++) {
             if (evp_cipher) {
                 EVP_CIPHER_CTX ctx;
@@ -1983,11 +2222,21 @@ int MAIN(int argc, char **argv)
             pkey_print_message("private", "rsa",
                                rsa_c[j][0], rsa_bits[j], RSA_SECONDS);
             /* RSA_blinding_on(rsa_key[j],NULL); */
+            if (batch_num > 1
+                && (batch = rsa_batch_new(rsa_key[j], batch_num, buf,
+                                          36)) == NULL) {
+                BIO_printf(bio_err, "RSA batch setup failure\n");
+                ERR_print_errors(bio_err);
+                goto end;
+            }
             Time_F(START);
-            for (count = 0, run = 1; COND(rsa_c[j][0]); count++) {
-                ret = RSA_sign(NID_md5_sha1, buf, 36, buf2,
-                               &rsa_num, rsa_key[j]);
-                if (ret == 0) {
+            for (count = 0, run = 1; COND(rsa_c[j][0]); count += batch_num) {
+                if (batch != NULL)
+                    ret = rsa_batch_sign(batch);
+                else
+                    ret = RSA_sign(NID_md5_sha1, buf, 36, buf2,
+                                   &rsa_num, rsa_key[j]);
+                if (ret <= 0) {
                     BIO_printf(bio_err, "RSA sign failure\n");
                     ERR_print_errors(bio_err);
                     count = 1;
@@ -1995,6 +2244,8 @@ int MAIN(int argc, char **argv)
                 }
             }
             d = Time_F(STOP);
+            rsa_batch_free(batch);
+            batch = NULL;
             BIO_printf(bio_err,
                        mr ? "+R1:%ld:%d:%.2f\n"
                        : "%ld %d bit private RSA's in %.2fs\n",
@@ -2124,7 +2375,7 @@ int MAIN(int argc, char **argv)
         RAND_seed(rnd_seed, sizeof rnd_seed);
         rnd_fake = 1;
     }
-    for (j = 0; j < EC_NUM; j++) {
+    for (j = 0; j < ECDSA_NUM; j++) {
         int ret;
 
         if (!ecdsa_doit[j])
@@ -2182,11 +2433,27 @@ int MAIN(int argc, char **argv)
                 pkey_print_message("verify", "ecdsa",
                                    ecdsa_c[j][1],
                                    test_curves_bits[j], ECDSA_SECONDS);
+                if (batch_num > 1
+                    && (ecdsa_batch = ecdsa_batch_new(ecdsa[j], batch_num,
+                                                      buf, 20, ecdsasig,
+                                                      ecdsasiglen)) == NULL) {
+                    BIO_printf(bio_err, "ECDSA batch setup failure\n");
+                    ERR_print_errors(bio_err);
+                    goto end;
+                }
                 Time_F(START);
-                for (count = 0, run = 1; COND(ecdsa_c[j][1]); count++) {
-                    ret =
-                        ECDSA_verify(0, buf, 20, ecdsasig, ecdsasiglen,
-                                     ecdsa[j]);
+                for (count = 0, run = 1; COND(ecdsa_c[j][1]);
+                     count += batch_num) {
+                    if (ecdsa_batch != NULL)
+                        ret = ECDSA_do_verify_batch(ecdsa_batch->num,
+                                                    ecdsa_batch->dgst,
+                                                    ecdsa_batch->dgst_len,
+                                                    ecdsa_batch->sig,
+                                                    ecdsa_batch->eckey,
+                                                    ecdsa_batch->ret);
+                    else
+                        ret = ECDSA_verify(0, buf, 20, ecdsasig, ecdsasiglen,
+                                           ecdsa[j]);
                     if (ret != 1) {
                         BIO_printf(bio_err, "ECDSA verify failure\n");
                         ERR_print_errors(bio_err);
@@ -2195,6 +2462,8 @@ int MAIN(int argc, char **argv)
                     }
                 }
                 d = Time_F(STOP);
+                ecdsa_batch_free(ecdsa_batch);
+                ecdsa_batch = NULL;
                 BIO_printf(bio_err,
                            mr ? "+R6:%ld:%d:%.2f\n"
                            : "%ld %d bit ECDSA verify in %.2fs\n",
@@ -2204,18 +2473,104 @@ int MAIN(int argc, char **argv)
 
             if (rsa_count <= 1) {
                 /* if longer than 10s, don't do any more */
-                for (j++; j < EC_NUM; j++)
+                for (j++; j < ECDSA_NUM; j++)
                     ecdsa_doit[j] = 0;
             }
         }
     }
+    if (ecdsa_doit[R_EC_ED25519]) {
+        /* Ed25519 signs the message itself: time EVP_DigestSign() */
+        EVP_PKEY_CTX *kctx = NULL, *vctx = NULL;
+        EVP_PKEY *ed_key = NULL;
+        EVP_MD_CTX *mctx = NULL;
+        size_t edsiglen = sizeof(ecdsasig);
+        int ret;
+
+        j = R_EC_ED25519;
+        if ((kctx = EVP_PKEY_CTX_new_id(NID_ED25519, NULL)) == NULL
+            || EVP_PKEY_keygen_init(kctx) <= 0
+            || EVP_PKEY_keygen(kctx, &ed_key) <= 0
+            || (mctx = EVP_MD_CTX_create()) == NULL
+            || EVP_DigestSignInit(mctx, NULL, NULL, NULL, ed_key) <= 0
+            || EVP_DigestSign(mctx, ecdsasig, &edsiglen, buf, 20) <= 0
+            || (vctx = EVP_PKEY_CTX_new(ed_key, NULL)) == NULL
+            || EVP_PKEY_verify_init(vctx) <= 0) {
+            BIO_printf(bio_err, "Ed25519 failure.\n");
+            ERR_print_errors(bio_err);
+            ecdsa_doit[j] = 0;
+        } else {
+            pkey_print_message("sign", "ed25519",
+                               ecdsa_c[j][0],
+                               test_curves_bits[j], ECDSA_SECONDS);
+            Time_F(START);
+            for (count = 0, run = 1; COND(ecdsa_c[j][0]); count++) {
+                edsiglen = sizeof(ecdsasig);
+                if (EVP_DigestSign(mctx, ecdsasig, &edsiglen, buf, 20) <= 0) {
+                    BIO_printf(bio_err, "Ed25519 sign failure\n");
+                    ERR_print_errors(bio_err);
+                    count = 1;
+                    break;
+                }
+            }
+            d = Time_F(STOP);
+            BIO_printf(bio_err,
+                       mr ? "+R5:%ld:%d:%.2f\n" :
+                       "%ld %d bit Ed25519 signs in %.2fs \n",
+                       count, test_curves_bits[j], d);
+            ecdsa_results[j][0] = d / (double)count;
+
+            pkey_print_message("verify", "ed25519",
+                               ecdsa_c[j][1],
+                               test_curves_bits[j], ECDSA_SECONDS);
+            if (batch_num > 1
+                && (ed25519_batch = ed25519_batch_new(vctx, batch_num,
+                                                      buf, 20, ecdsasig,
+                                                      edsiglen)) == NULL) {
+                BIO_printf(bio_err, "Ed25519 batch setup failure\n");
+                ERR_print_errors(bio_err);
+                goto end;
+            }
+            Time_F(START);
+            for (count = 0, run = 1; COND(ecdsa_c[j][1]);
+                 count += batch_num) {
+                if (ed25519_batch != NULL)
+                    ret = EVP_PKEY_verify_batch(ed25519_batch->ctx,
+                                                ed25519_batch->sig,
+                                                ed25519_batch->siglen,
+                                                ed25519_batch->tbs,
+                                                ed25519_batch->tbslen,
+                                                ed25519_batch->num,
+                                                ed25519_batch->ret);
+                else
+                    ret = EVP_PKEY_verify(vctx, ecdsasig, edsiglen, buf, 20);
+                if (ret != 1) {
+                    BIO_printf(bio_err, "Ed25519 verify failure\n");
+                    ERR_print_errors(bio_err);
+                    count = 1;
+                    break;
+                }
+            }
+            d = Time_F(STOP);
+            ed25519_batch_free(ed25519_batch);
+            ed25519_batch = NULL;
+            BIO_printf(bio_err,
+                       mr ? "+R6:%ld:%d:%.2f\n"
+                       : "%ld %d bit Ed25519 verify in %.2fs\n",
+                       count, test_curves_bits[j], d);
+            ecdsa_results[j][1] = d / (double)count;
+        }
+        EVP_MD_CTX_destroy(mctx);
+        EVP_PKEY_CTX_free(kctx);
+        EVP_PKEY_CTX_free(vctx);
+        EVP_PKEY_free(ed_key);
+    }
     if (rnd_fake)
         RAND_cleanup();
     if (RAND_status() != 1) {
         RAND_seed(rnd_seed, sizeof rnd_seed);
         rnd_fake = 1;
     }
-    for (j = 0; j < EC_NUM; j++) {
+    for (j = 0; j < R_EC_X25519; j++) {
         if (!ecdh_doit[j])
             continue;
         ecdh_a[j] = EC_KEY_new_by_curve_name(test_curves[j]);
@@ -2299,6 +2654,54 @@ int MAIN(int argc, char **argv)
                 ecdh_doit[j] = 0;
         }
     }
+    if (ecdh_doit[R_EC_X25519]) {
+        /* X25519 has no EC_GROUP: time EVP_PKEY_derive() instead */
+        EVP_PKEY_CTX *kctx = NULL, *dctx_a = NULL, *dctx_b = NULL;
+        EVP_PKEY *key_a = NULL, *key_b = NULL;
+        size_t outlen_a = MAX_ECDH_SIZE, outlen_b = MAX_ECDH_SIZE;
+
+        j = R_EC_X25519;
+        if ((kctx = EVP_PKEY_CTX_new_id(NID_X25519, NULL)) == NULL
+            || EVP_PKEY_keygen_init(kctx) <= 0
+            || EVP_PKEY_keygen(kctx, &key_a) <= 0
+            || EVP_PKEY_keygen(kctx, &key_b) <= 0
+            || (dctx_a = EVP_PKEY_CTX_new(key_a, NULL)) == NULL
+            || (dctx_b = EVP_PKEY_CTX_new(key_b, NULL)) == NULL
+            || EVP_PKEY_derive_init(dctx_a) <= 0
+            || EVP_PKEY_derive_init(dctx_b) <= 0
+            || EVP_PKEY_derive_set_peer(dctx_a, key_b) <= 0
+            || EVP_PKEY_derive_set_peer(dctx_b, key_a) <= 0
+            || EVP_PKEY_derive(dctx_a, secret_a, &outlen_a) <= 0
+            || EVP_PKEY_derive(dctx_b, secret_b, &outlen_b) <= 0) {
+            BIO_printf(bio_err, "ECDH failure.\n");
+            ERR_print_errors(bio_err);
+            ecdh_doit[j] = 0;
+        } else {
+            if (outlen_a != outlen_b
+                || memcmp(secret_a, secret_b, outlen_a) != 0)
+                BIO_printf(bio_err, "ECDH computations don't match.\n");
+
+            pkey_print_message("", "ecdh",
+                               ecdh_c[j][0],
+                               test_curves_bits[j], ECDH_SECONDS);
+            Time_F(START);
+            for (count = 0, run = 1; COND(ecdh_c[j][0]); count++) {
+                outlen_a = MAX_ECDH_SIZE;
+                EVP_PKEY_derive(dctx_a, secret_a, &outlen_a);
+            }
+            d = Time_F(STOP);
+            BIO_printf(bio_err,
+                       mr ? "+R7:%ld:%d:%.2f\n" :
+                       "%ld %d-bit ECDH ops in %.2fs\n", count,
+                       test_curves_bits[j], d);
+            ecdh_results[j][0] = d / (double)count;
+        }
+        EVP_PKEY_CTX_free(kctx);
+        EVP_PKEY_CTX_free(dctx_a);
+        EVP_PKEY_CTX_free(dctx_b);
+        EVP_PKEY_free(key_a);
+        EVP_PKEY_free(key_b);
+    }
     if (rnd_fake)
         RAND_cleanup();
 #endif
@@ -2411,8 +2814,9 @@ int MAIN(int argc, char **argv)
                     ecdsa_results[k][0], ecdsa_results[k][1]);
         else
             fprintf(stdout,
-                    "%4u bit ecdsa (%s) %8.4fs %8.4fs %8.1f %8.1f\n",
+                    "%4u bit %s (%s) %8.4fs %8.4fs %8.1f %8.1f\n",
                     test_curves_bits[k],
+                    k == R_EC_ED25519 ? "eddsa" : "ecdsa",
                     test_curves_names[k],
                     ecdsa_results[k][0], ecdsa_results[k][1],
                     1.0 / ecdsa_results[k][0], 1.0 / ecdsa_results[k][1]);
@@ -2456,7 +2860,7 @@ int MAIN(int argc, char **argv)
 #endif
 
 #ifndef OPENSSL_NO_EC
-    for (i = 0; i < EC_NUM; i++)
+    for (i = 0; i < ECDSA_NUM; i++)
         EC_KEY_free(ecdsa[i]);
     for (i = 0; i < EC_NUM; i++) {
         EC_KEY_free(ecdh_a[i]);
@@ -2818,3 +3222,396 @@ end:
     if (out)
         OPENSSL_free(out);
 }
+
+/*
+ * Time a buffer of |unit_len| byte XTS data units, numbered from 0,
+ * processed with one EVP call per unit, with a single call using
+ * EVP_CTRL_XTS_SET_UNIT_LEN and, if |threads| is more than one, with that
+ * call spread over |threads| threads. All of them must agree.
+ */
+static void xts_units_speed(const EVP_CIPHER *evp_cipher, int unit_len,
+                            int threads, int decrypt)
+{
+    int units = XTS_SPEED_LEN / unit_len, len = units * unit_len;
+    int num = threads > 1 ? 3 : 2, count, i, j;
+    const char *alg_name = OBJ_nid2ln(evp_cipher->nid);
+    unsigned char *inp = NULL, *out[3] = { NULL, NULL, NULL };
+    unsigned char key[64], iv[16];
+    char label[3][64];
+    EVP_CIPHER_CTX ctx[3];
+    double d, rate[3];
+
+    for (j = 0; j < num; j++)
+        EVP_CIPHER_CTX_init(&ctx[j]);
+    inp = OPENSSL_malloc(len);
+    for (j = 0; j < num; j++)
+        out[j] = OPENSSL_malloc(len);
+    if (!inp || !out[0] || !out[1] || (num > 2 && !out[2])) {
+        BIO_printf(bio_err, "Out of memory\n");
+        goto end;
+    }
+    RAND_bytes(inp, len);
+    RAND_bytes(key, EVP_CIPHER_key_length(evp_cipher));
+    memset(iv, 0, sizeof(iv));
+
+    BIO_snprintf(label[0], sizeof(label[0]), "%s %d unit calls",
+                 alg_name, units);
+    BIO_snprintf(label[1], sizeof(label[1]), "%s 1 call", alg_name);
+    BIO_snprintf(label[2], sizeof(label[2]), "%s 1 call, %d threads",
+                 alg_name, threads);
+    for (j = 0; j < num; j++)
+        EVP_CipherInit_ex(&ctx[j], evp_cipher, NULL, key, iv, !decrypt);
+    for (j = 1; j < num; j++)
+        EVP_CIPHER_CTX_ctrl(&ctx[j], EVP_CTRL_XTS_SET_UNIT_LEN, unit_len,
+                            NULL);
+    if (num > 2)
+        EVP_CIPHER_CTX_ctrl(&ctx[2], EVP_CTRL_XTS_SET_THREADS, threads,
+                            NULL);
+
+    for (j = 0; j < num; j++) {
+        print_message(label[j], 0, len);
+        Time_F(START);
+        for (count = 0, run = 1; run && count < 0x7fffffff; count++) {
+            if (j == 0) {
+                for (i = 0; i < units; i++) {
+                    iv[0] = (unsigned char)i;
+                    iv[1] = (unsigned char)(i >> 8);
+                    iv[2] = (unsigned char)(i >> 16);
+                    EVP_CipherInit_ex(&ctx[0], NULL, NULL, NULL, iv, -1);
+                    EVP_Cipher(&ctx[0], out[0] + i * unit_len,
+                               inp + i * unit_len, unit_len);
+                }
+            } else {
+                memset(iv, 0, sizeof(iv));
+                EVP_CipherInit_ex(&ctx[j], NULL, NULL, NULL, iv, -1);
+                EVP_Cipher(&ctx[j], out[j], inp, len);
+            }
+        }
+        d = Time_F(STOP);
+        BIO_printf(bio_err, "%d %s's in %.2fs\n", count, "evp", d);
+        rate[j] = ((double)count) / d * len;
+    }
+
+    for (j = 1; j < num; j++)
+        if (memcmp(out[0], out[j], len) != 0)
+            BIO_printf(bio_err, "%s: output differs from %s\n", label[j],
+                       label[0]);
+
+    fprintf(stdout,
+            "The 'numbers' are in 1000s of bytes per second processed.\n");
+    fprintf(stdout, "type                            %7d bytes\n", len);
+    for (j = 0; j < num; j++)
+        fprintf(stdout, "%-32s %11.2fk\n", label[j], rate[j] / 1e3);
+
+ end:
+    for (j = 0; j < num; j++) {
+        EVP_CIPHER_CTX_cleanup(&ctx[j]);
+        if (out[j])
+            OPENSSL_free(out[j]);
+    }
+    if (inp)
+        OPENSSL_free(inp);
+}
+
+#ifndef OPENSSL_NO_AES
+/* Message sizes for -aead, which are typical of TLS records and packets */
+static const int aead_lengths[] = { 16, 64, 256, 1024, 1500 };
+
+# define AEAD_SIZES      (sizeof(aead_lengths) / sizeof(aead_lengths[0]))
+# define AEAD_AAD_LEN    13
+
+/*
+ * Time sealing messages of each of |aead_lengths| with a fresh nonce and
+ * 13 bytes of additional data, as a TLS record is sealed: first through
+ * |evp_cipher| with the usual EVP_CIPHER_CTX call sequence, then with one
+ * EVP_AEAD_CTX_seal() call per message. Both must produce the same output.
+ */
+static void aead_speed(const EVP_CIPHER *evp_cipher, const EVP_AEAD *aead)
+{
+    int ccm = EVP_CIPHER_mode(evp_cipher) == EVP_CIPH_CCM_MODE;
+    int len, outl, count, i, j;
+    size_t tag_len = EVP_AEAD_max_overhead(aead), out_len;
+    size_t nonce_len = EVP_AEAD_nonce_length(aead);
+    const char *alg_name = OBJ_nid2ln(evp_cipher->nid);
+    unsigned char *inp = NULL, *out[2] = { NULL, NULL };
+    unsigned char key[32], nonce[16], aad[AEAD_AAD_LEN];
+    char label[2][64];
+    EVP_CIPHER_CTX ctx;
+    EVP_AEAD_CTX actx;
+    double d, rate[2][AEAD_SIZES];
+    int max = aead_lengths[AEAD_SIZES - 1] + (int)tag_len;
+
+    EVP_CIPHER_CTX_init(&ctx);
+    actx.aead = NULL;
+    inp = OPENSSL_malloc(max);
+    out[0] = OPENSSL_malloc(max);
+    out[1] = OPENSSL_malloc(max);
+    if (!inp || !out[0] || !out[1]) {
+        BIO_printf(bio_err, "Out of memory\n");
+        goto end;
+    }
+    RAND_bytes(inp, max);
+    RAND_bytes(key, sizeof(key));
+    RAND_bytes(aad, sizeof(aad));
+    memset(nonce, 0, sizeof(nonce));
+
+    EVP_EncryptInit_ex(&ctx, evp_cipher, NULL, NULL, NULL);
+    EVP_CIPHER_CTX_ctrl(&ctx, EVP_CTRL_AEAD_SET_IVLEN, (int)nonce_len, NULL);
+    if (ccm)
+        EVP_CIPHER_CTX_ctrl(&ctx, EVP_CTRL_AEAD_SET_TAG, (int)tag_len, NULL);
+    EVP_EncryptInit_ex(&ctx, NULL, NULL, key, NULL);
+    if (!EVP_AEAD_CTX_init(&actx, aead, key, EVP_AEAD_key_length(aead),
+                           tag_len)) {
+        ERR_print_errors(bio_err);
+        goto end;
+    }
+
+    BIO_snprintf(label[0], sizeof(label[0]), "%s EVP_CIPHER", alg_name);
+    BIO_snprintf(label[1], sizeof(label[1]), "%s EVP_AEAD", alg_name);
+    for (i = 0; i < (int)AEAD_SIZES; i++) {
+        len = aead_lengths[i];
+        for (j = 0; j < 2; j++) {
+            print_message(label[j], 0, len);
+            Time_F(START);
+            for (count = 0, run = 1; run && count < 0x7fffffff; count++) {
+                nonce[0] = (unsigned char)count;
+                nonce[1] = (unsigned char)(count >> 8);
+                if (j == 0) {
+                    EVP_EncryptInit_ex(&ctx, NULL, NULL, NULL, nonce);
+                    if (ccm)
+                        EVP_EncryptUpdate(&ctx, NULL, &outl, NULL, len);
+                    EVP_EncryptUpdate(&ctx, NULL, &outl, aad, sizeof(aad));
+                    EVP_EncryptUpdate(&ctx, out[0], &outl, inp, len);
+                    EVP_EncryptFinal_ex(&ctx, out[0] + outl, &outl);
+                    EVP_CIPHER_CTX_ctrl(&ctx, EVP_CTRL_AEAD_GET_TAG,
+                                        (int)tag_len, out[0] + len);
+                } else {
+                    EVP_AEAD_CTX_seal(&actx, out[1], &out_len, max,
+                                      nonce, nonce_len, inp, len,
+                                      aad, sizeof(aad));
+                }
+            }
+            d = Time_F(STOP);
+            BIO_printf(bio_err, "%d %s's in %.2fs\n", count, "evp", d);
+            rate[j][i] = ((double)count) / d * len;
+        }
+
+        /* Seal one more message both ways with the same nonce and compare */
+        memset(nonce, 0, sizeof(nonce));
+        EVP_EncryptInit_ex(&ctx, NULL, NULL, NULL, nonce);
+        if (ccm)
+            EVP_EncryptUpdate(&ctx, NULL, &outl, NULL, len);
+        EVP_EncryptUpdate(&ctx, NULL, &outl, aad, sizeof(aad));
+        EVP_EncryptUpdate(&ctx, out[0], &outl, inp, len);
+        EVP_EncryptFinal_ex(&ctx, out[0] + outl, &outl);
+        EVP_CIPHER_CTX_ctrl(&ctx, EVP_CTRL_AEAD_GET_TAG, (int)tag_len,
+                            out[0] + len);
+        if (!EVP_AEAD_CTX_seal(&actx, out[1], &out_len, max, nonce,
+                               nonce_len, inp, len, aad, sizeof(aad))
+            || out_len != len + tag_len
+            || memcmp(out[0], out[1], out_len) != 0)
+            BIO_printf(bio_err, "%s: output differs from %s at %d bytes\n",
+                       label[1], label[0], len);
+    }
+
+    fprintf(stdout,
+            "The 'numbers' are in 1000s of bytes per second processed.\n");
+    fprintf(stdout, "type                    ");
+    for (i = 0; i < (int)AEAD_SIZES; i++)
+        fprintf(stdout, "%7d bytes", aead_lengths[i]);
+    fprintf(stdout, "\n");
+    for (j = 0; j < 2; j++) {
+        fprintf(stdout, "%-24s", label[j]);
+        for (i = 0; i < (int)AEAD_SIZES; i++)
+            fprintf(stdout, " %11.2fk", rate[j][i] / 1e3);
+        fprintf(stdout, "\n");
+    }
+
+ end:
+    EVP_CIPHER_CTX_cleanup(&ctx);
+    EVP_AEAD_CTX_cleanup(&actx);
+    if (inp)
+        OPENSSL_free(inp);
+    if (out[0])
+        OPENSSL_free(out[0]);
+    if (out[1])
+        OPENSSL_free(out[1]);
+}
+#endif
+
+#ifndef OPENSSL_NO_RSA
+/*
+ * Set up |num| signing contexts for |rsa| that sign |tbs|, which is raw
+ * data as RSA_sign() with NID_md5_sha1 would sign it.
+ */
+static RSA_BATCH *rsa_batch_new(RSA *rsa, int num, const unsigned char *tbs,
+                                size_t tbslen)
+{
+    RSA_BATCH *b;
+    EVP_PKEY *pkey;
+    int i;
+
+    if ((pkey = EVP_PKEY_new()) == NULL)
+        return NULL;
+    if (!EVP_PKEY_set1_RSA(pkey, rsa)
+        || (b = OPENSSL_malloc(sizeof(*b))) == NULL) {
+        EVP_PKEY_free(pkey);
+        return NULL;
+    }
+    b->num = num;
+    b->ctx = OPENSSL_malloc(sizeof(*b->ctx) * num);
+    b->sig = OPENSSL_malloc(sizeof(*b->sig) * num);
+    b->siglen = OPENSSL_malloc(sizeof(*b->siglen) * num);
+    b->tbs = OPENSSL_malloc(sizeof(*b->tbs) * num);
+    b->tbslen = OPENSSL_malloc(sizeof(*b->tbslen) * num);
+    if (b->ctx != NULL)
+        memset(b->ctx, 0, sizeof(*b->ctx) * num);
+    if (b->sig != NULL)
+        memset(b->sig, 0, sizeof(*b->sig) * num);
+    if (b->ctx == NULL || b->sig == NULL || b->siglen == NULL
+        || b->tbs == NULL || b->tbslen == NULL)
+        goto err;
+
+    for (i = 0; i < num; i++) {
+        b->ctx[i] = EVP_PKEY_CTX_new(pkey, NULL);
+        b->sig[i] = OPENSSL_malloc(RSA_size(rsa));
+        if (b->ctx[i] == NULL || b->sig[i] == NULL
+            || EVP_PKEY_sign_init(b->ctx[i]) <= 0)
+            goto err;
+        b->tbs[i] = tbs;
+        b->tbslen[i] = tbslen;
+    }
+    EVP_PKEY_free(pkey);
+    return b;
+
+ err:
+    EVP_PKEY_free(pkey);
+    rsa_batch_free(b);
+    return NULL;
+}
+
+static int rsa_batch_sign(RSA_BATCH *b)
+{
+    int i;
+
+    for (i = 0; i < b->num; i++)
+        b->siglen[i] = EVP_PKEY_size(EVP_PKEY_CTX_get0_pkey(b->ctx[i]));
+    return EVP_PKEY_sign_batch(b->ctx, b->sig, b->siglen, b->tbs, b->tbslen,
+                               b->num);
+}
+
+static void rsa_batch_free(RSA_BATCH *b)
+{
+    int i;
+
+    if (b == NULL)
+        return;
+    for (i = 0; i < b->num; i++) {
+        if (b->ctx != NULL)
+            EVP_PKEY_CTX_free(b->ctx[i]);
+        if (b->sig != NULL && b->sig[i] != NULL)
+            OPENSSL_free(b->sig[i]);
+    }
+    OPENSSL_free(b->ctx);
+    OPENSSL_free(b->sig);
+    OPENSSL_free(b->siglen);
+    OPENSSL_free(b->tbs);
+    OPENSSL_free(b->tbslen);
+    OPENSSL_free(b);
+}
+#endif
+#ifndef OPENSSL_NO_ECDSA
+/*
+ * Set up |num| copies of the arguments of an ECDSA_verify() of the DER
+ * signature |sig| over |dgst| with |eckey|, for ECDSA_do_verify_batch().
+ */
+static ECDSA_BATCH *ecdsa_batch_new(EC_KEY *eckey, int num,
+                                    const unsigned char *dgst, int dgst_len,
+                                    const unsigned char *sig, int sig_len)
+{
+    ECDSA_BATCH *b;
+    int i;
+
+    if ((b = OPENSSL_malloc(sizeof(*b))) == NULL)
+        return NULL;
+    b->num = num;
+    b->dgst = OPENSSL_malloc(sizeof(*b->dgst) * num);
+    b->dgst_len = OPENSSL_malloc(sizeof(*b->dgst_len) * num);
+    b->sig = OPENSSL_malloc(sizeof(*b->sig) * num);
+    b->eckey = OPENSSL_malloc(sizeof(*b->eckey) * num);
+    b->ret = OPENSSL_malloc(sizeof(*b->ret) * num);
+    b->s = d2i_ECDSA_SIG(NULL, &sig, sig_len);
+    if (b->dgst == NULL || b->dgst_len == NULL || b->sig == NULL
+        || b->eckey == NULL || b->ret == NULL || b->s == NULL) {
+        ecdsa_batch_free(b);
+        return NULL;
+    }
+    for (i = 0; i < num; i++) {
+        b->dgst[i] = dgst;
+        b->dgst_len[i] = dgst_len;
+        b->sig[i] = b->s;
+        b->eckey[i] = eckey;
+    }
+    return b;
+}
+
+static void ecdsa_batch_free(ECDSA_BATCH *b)
+{
+    if (b == NULL)
+        return;
+    OPENSSL_free(b->dgst);
+    OPENSSL_free(b->dgst_len);
+    OPENSSL_free(b->sig);
+    OPENSSL_free(b->eckey);
+    OPENSSL_free(b->ret);
+    ECDSA_SIG_free(b->s);
+    OPENSSL_free(b);
+}
+#endif
+#ifndef OPENSSL_NO_EC
+static ED25519_BATCH *ed25519_batch_new(EVP_PKEY_CTX *ctx, int num,
+                                        const unsigned char *tbs,
+                                        size_t tbslen,
+                                        const unsigned char *sig,
+                                        size_t siglen)
+{
+    ED25519_BATCH *b;
+    int i;
+
+    if ((b = OPENSSL_malloc(sizeof(*b))) == NULL)
+        return NULL;
+    b->num = num;
+    b->ctx = OPENSSL_malloc(sizeof(*b->ctx) * num);
+    b->sig = OPENSSL_malloc(sizeof(*b->sig) * num);
+    b->siglen = OPENSSL_malloc(sizeof(*b->siglen) * num);
+    b->tbs = OPENSSL_malloc(sizeof(*b->tbs) * num);
+    b->tbslen = OPENSSL_malloc(sizeof(*b->tbslen) * num);
+    b->ret = OPENSSL_malloc(sizeof(*b->ret) * num);
+    if (b->ctx == NULL || b->sig == NULL || b->siglen == NULL
+        || b->tbs == NULL || b->tbslen == NULL || b->ret == NULL) {
+        ed25519_batch_free(b);
+        return NULL;
+    }
+    for (i = 0; i < num; i++) {
+        b->ctx[i] = ctx;
+        b->sig[i] = sig;
+        b->siglen[i] = siglen;
+        b->tbs[i] = tbs;
+        b->tbslen[i] = tbslen;
+    }
+    return b;
+}
+
+static void ed25519_batch_free(ED25519_BATCH *b)
+{
+    if (b == NULL)
+        return;
+    OPENSSL_free(b->ctx);
+    OPENSSL_free(b->sig);
+    OPENSSL_free(b->siglen);
+    OPENSSL_free(b->tbs);
+    OPENSSL_free(b->tbslen);
+    OPENSSL_free(b->ret);
+    OPENSSL_free(b);
+}
+#endif
@@ -0,0 +1,210 @@
+/* crypto/async/arch/async_posix.c */
+/* ====================================================================
+ * Copyright (c) 2015 The OpenSSL Project.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. All advertising materials mentioning features or use of this
+ *    software must display the following acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit. (http://www.openssl.org/)"
+ *
+ * 4. The names "OpenSSL Toolkit" and "OpenSSL Project" must not be used to
+ *    endorse or promote products derived from this software without
+ *    prior written permission. For written permission, please contact
+ *    openssl-core@openssl.org.
+ *
+ * 5. Products derived from this software may not be called "OpenSSL"
+ *    nor may "OpenSSL" appear in their names without prior written
+ *    permission of the OpenSSL Project.
+ *
+ * 6. Redistributions of any form whatsoever must retain the following
+ *    acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit (http://www.openssl.org/)"
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE OpenSSL PROJECT ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE OpenSSL PROJECT OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ====================================================================
+ */
+
+#include "../async_locl.h"
+
+#ifdef ASYNC_POSIX
+
+# include <pthread.h>
+# include <fcntl.h>
+# include <unistd.h>
+# include <errno.h>
+
+/*
+ * eventfd(2) is cheaper than a pipe: one descriptor per job, and a wake up
+ * is a single counter update in the kernel.
+ */
+# if defined(__linux__) && defined(__GLIBC__) \
+     && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 8))
+#  define ASYNC_EVENTFD
+#  include <stdint.h>
+#  include <sys/eventfd.h>
+# endif
+
+/* Size of the stack each job runs on */
+# define STACKSIZE       65536
+
+static pthread_once_t async_once = PTHREAD_ONCE_INIT;
+static pthread_key_t posixctx;
+static pthread_key_t posixpool;
+static int async_keys_ok = 0;
+
+static void async_create_keys(void)
+{
+    if (pthread_key_create(&posixctx, NULL) != 0)
+        return;
+    if (pthread_key_create(&posixpool, NULL) != 0) {
+        pthread_key_delete(posixctx);
+        return;
+    }
+    async_keys_ok = 1;
+}
+
+int async_global_init(void)
+{
+    if (pthread_once(&async_once, async_create_keys) != 0)
+        return 0;
+    return async_keys_ok;
+}
+
+async_ctx *async_get_ctx(void)
+{
+    if (!async_global_init())
+        return NULL;
+    return (async_ctx *)pthread_getspecific(posixctx);
+}
+
+int async_set_ctx(async_ctx *ctx)
+{
+    return async_global_init() && pthread_setspecific(posixctx, ctx) == 0;
+}
+
+async_pool *async_get_pool(void)
+{
+    if (!async_global_init())
+        return NULL;
+    return (async_pool *)pthread_getspecific(posixpool);
+}
+
+int async_set_pool(async_pool *pool)
+{
+    return async_global_init() && pthread_setspecific(posixpool, pool) == 0;
+}
+
+int async_fibre_makecontext(async_fibre *fibre)
+{
+    if (getcontext(&fibre->fibre) != 0)
+        return 0;
+    fibre->fibre.uc_stack.ss_sp = OPENSSL_malloc(STACKSIZE);
+    if (fibre->fibre.uc_stack.ss_sp == NULL)
+        return 0;
+    fibre->fibre.uc_stack.ss_size = STACKSIZE;
+    fibre->fibre.uc_link = NULL;
+    makecontext(&fibre->fibre, async_start_func, 0);
+    return 1;
+}
+
+void async_fibre_free(async_fibre *fibre)
+{
+    OPENSSL_free(fibre->fibre.uc_stack.ss_sp);
+    fibre->fibre.uc_stack.ss_sp = NULL;
+}
+
+static int async_set_fd_flags(int fd)
+{
+    int flags;
+
+    if ((flags = fcntl(fd, F_GETFL)) == -1
+        || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1)
+        return 0;
+    if ((flags = fcntl(fd, F_GETFD)) == -1
+        || fcntl(fd, F_SETFD, flags | FD_CLOEXEC) == -1)
+        return 0;
+    return 1;
+}
+
+int async_wait_pipe(int *wait_fd, int *wake_fd)
+{
+    int fds[2];
+
+# ifdef ASYNC_EVENTFD
+    fds[0] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fds[0] != -1) {
+        *wait_fd = *wake_fd = fds[0];
+        return 1;
+    }
+    /* Kernel too old for the flags, fall back to a pipe */
+# endif
+    if (pipe(fds) != 0)
+        return 0;
+    if (!async_set_fd_flags(fds[0]) || !async_set_fd_flags(fds[1])) {
+        close(fds[0]);
+        close(fds[1]);
+        return 0;
+    }
+    *wait_fd = fds[0];
+    *wake_fd = fds[1];
+    return 1;
+}
+
+void async_close_pipe(int wait_fd, int wake_fd)
+{
+    close(wait_fd);
+    if (wake_fd != wait_fd)
+        close(wake_fd);
+}
+
+/*
+ * Make the wait fd readable. This is safe to call from any thread: a full
+ * pipe or eventfd counter means that a wake up is pending anyway.
+ */
+int async_write_wake(int wake_fd)
+{
+# ifdef ASYNC_EVENTFD
+    /* Also fine for a pipe, should eventfd() not have been available */
+    static const uint64_t one = 1;
+# else
+    static const char one = 1;
+# endif
+
+    if (write(wake_fd, &one, sizeof(one)) == -1)
+        return errno == EAGAIN;
+    return 1;
+}
+
+void async_drain_wake(int wait_fd)
+{
+    char buf[64];
+
+    while (read(wait_fd, buf, sizeof(buf)) > 0)
+        continue;
+}
+
+#endif
@@ -0,0 +1,533 @@
+/* crypto/async/async.c */
+/* ====================================================================
+ * Copyright (c) 2015 The OpenSSL Project.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. All advertising materials mentioning features or use of this
+ *    software must display the following acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit. (http://www.openssl.org/)"
+ *
+ * 4. The names "OpenSSL Toolkit" and "OpenSSL Project" must not be used to
+ *    endorse or promote products derived from this software without
+ *    prior written permission. For written permission, please contact
+ *    openssl-core@openssl.org.
+ *
+ * 5. Products derived from this software may not be called "OpenSSL"
+ *    nor may "OpenSSL" appear in their names without prior written
+ *    permission of the OpenSSL Project.
+ *
+ * 6. Redistributions of any form whatsoever must retain the following
+ *    acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit (http://www.openssl.org/)"
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE OpenSSL PROJECT ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE OpenSSL PROJECT OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ====================================================================
+ */
+
+#include <string.h>
+#include <openssl/err.h>
+#include "async_locl.h"
+
+#define ASYNC_JOB_RUNNING   0
+#define ASYNC_JOB_PAUSING   1
+#define ASYNC_JOB_PAUSED    2
+#define ASYNC_JOB_STOPPING  3
+
+/* Default upper limit on the number of jobs in a thread's pool */
+#define ASYNC_DEFAULT_POOL_SIZE 0
+
+static async_ctx *async_ctx_new(void)
+{
+    async_ctx *nctx;
+
+    nctx = OPENSSL_malloc(sizeof(*nctx));
+    if (nctx == NULL) {
+        ASYNCerr(ASYNC_F_ASYNC_CTX_NEW, ERR_R_MALLOC_FAILURE);
+        return NULL;
+    }
+
+    async_fibre_init_dispatcher(&nctx->dispatcher);
+    nctx->currjob = NULL;
+    nctx->blocked = 0;
+    if (!async_set_ctx(nctx)) {
+        ASYNCerr(ASYNC_F_ASYNC_CTX_NEW, ASYNC_R_UNSUPPORTED);
+        OPENSSL_free(nctx);
+        return NULL;
+    }
+
+    return nctx;
+}
+
+static int async_ctx_free(void)
+{
+    async_ctx *ctx = async_get_ctx();
+
+    if (!async_set_ctx(NULL))
+        return 0;
+    OPENSSL_free(ctx);
+    return 1;
+}
+
+static ASYNC_JOB *async_job_new(void)
+{
+    ASYNC_JOB *job;
+
+    job = OPENSSL_malloc(sizeof(*job));
+    if (job == NULL) {
+        ASYNCerr(ASYNC_F_ASYNC_JOB_NEW, ERR_R_MALLOC_FAILURE);
+        return NULL;
+    }
+    memset(job, 0, sizeof(*job));
+
+    if (!async_wait_pipe(&job->wait_fd, &job->wake_fd)) {
+        ASYNCerr(ASYNC_F_ASYNC_JOB_NEW, ASYNC_R_CANNOT_CREATE_WAIT_PIPE);
+        OPENSSL_free(job);
+        return NULL;
+    }
+    if (!async_fibre_makecontext(&job->fibrectx)) {
+        ASYNCerr(ASYNC_F_ASYNC_JOB_NEW, ASYNC_R_FAILED_TO_MAKE_FIBRE);
+        async_close_pipe(job->wait_fd, job->wake_fd);
+        OPENSSL_free(job);
+        return NULL;
+    }
+    job->status = ASYNC_JOB_RUNNING;
+
+    return job;
+}
+
+static void async_job_free(ASYNC_JOB *job)
+{
+    if (job == NULL)
+        return;
+    OPENSSL_free(job->funcargs);
+    async_fibre_free(&job->fibrectx);
+    async_close_pipe(job->wait_fd, job->wake_fd);
+    OPENSSL_free(job);
+}
+
+static async_pool *async_pool_new(size_t max_size)
+{
+    async_pool *pool;
+
+    pool = OPENSSL_malloc(sizeof(*pool));
+    if (pool == NULL) {
+        ASYNCerr(ASYNC_F_ASYNC_POOL_NEW, ERR_R_MALLOC_FAILURE);
+        return NULL;
+    }
+    pool->free_jobs = NULL;
+    pool->curr_size = 0;
+    pool->max_size = max_size;
+    if (!async_set_pool(pool)) {
+        OPENSSL_free(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+static ASYNC_JOB *async_get_pool_job(void)
+{
+    ASYNC_JOB *job;
+    async_pool *pool;
+
+    pool = async_get_pool();
+    if (pool == NULL) {
+        /*
+         * Pool has not been initialised, so init with the defaults, i.e.
+         * no max size and no pre-created jobs
+         */
+        if (ASYNC_init_pool(ASYNC_DEFAULT_POOL_SIZE, 0) == 0)
+            return NULL;
+        pool = async_get_pool();
+    }
+
+    job = pool->free_jobs;
+    if (job != NULL) {
+        pool->free_jobs = job->next;
+        job->next = NULL;
+        return job;
+    }
+
+    /* Pool is empty */
+    if (pool->max_size != 0 && pool->curr_size >= pool->max_size)
+        return NULL;
+
+    job = async_job_new();
+    if (job != NULL)
+        pool->curr_size++;
+    return job;
+}
+
+static void async_release_job(ASYNC_JOB *job)
+{
+    async_pool *pool = async_get_pool();
+
+    OPENSSL_free(job->funcargs);
+    job->funcargs = NULL;
+    job->status = ASYNC_JOB_RUNNING;
+    job->abandoned = 0;
+    async_drain_wake(job->wait_fd);
+    /* Release job back into pool */
+    job->next = pool->free_jobs;
+    pool->free_jobs = job;
+}
+
+/*
+ * Entry point of every job fibre. A fibre is reused for many jobs, so this
+ * never returns: once a job function is done we switch back to the
+ * dispatcher and wait to be given the next one.
+ */
+void async_start_func(void)
+{
+    ASYNC_JOB *job;
+    async_ctx *ctx;
+
+    for (;;) {
+        /* Run the job */
+        ctx = async_get_ctx();
+        job = ctx->currjob;
+        job->ret = job->func(job->funcargs);
+
+        /* Stop the job */
+        job->status = ASYNC_JOB_STOPPING;
+        if (!async_fibre_swapcontext(&job->fibrectx, &ctx->dispatcher)) {
+            /*
+             * Should not happen. Getting here will close the thread...can't
+             * do much about it
+             */
+            ASYNCerr(ASYNC_F_ASYNC_START_FUNC, ASYNC_R_FAILED_TO_SWAP_CONTEXT);
+        }
+    }
+}
+
+/*
+ * Start a new job running |func| with a private copy of the |size| bytes at
+ * |args|, or resume the paused job *|job|. Returns ASYNC_PAUSE if the job
+ * paused, in which case the caller has to call again with the same *|job|
+ * once the job's wait fd becomes readable, or ASYNC_FINISH with the return
+ * value of |func| in *|ret|.
+ */
+int ASYNC_start_job(ASYNC_JOB **job, int *ret, int (*func) (void *),
+                    void *args, size_t size)
+{
+    async_ctx *ctx;
+
+    ctx = async_get_ctx();
+    if (ctx == NULL)
+        ctx = async_ctx_new();
+    if (ctx == NULL)
+        return ASYNC_ERR;
+
+    if (ctx->currjob != NULL) {
+        /* Jobs cannot be nested */
+        ASYNCerr(ASYNC_F_ASYNC_START_JOB, ASYNC_R_ALREADY_IN_A_JOB);
+        return ASYNC_ERR;
+    }
+
+    if (*job != NULL)
+        ctx->currjob = *job;
+
+    for (;;) {
+        if (ctx->currjob != NULL) {
+            if (ctx->currjob->status == ASYNC_JOB_STOPPING) {
+                *ret = ctx->currjob->ret;
+                async_release_job(ctx->currjob);
+                ctx->currjob = NULL;
+                *job = NULL;
+                return ASYNC_FINISH;
+            }
+
+            if (ctx->currjob->status == ASYNC_JOB_PAUSING) {
+                *job = ctx->currjob;
+                ctx->currjob->status = ASYNC_JOB_PAUSED;
+                ctx->currjob = NULL;
+                return ASYNC_PAUSE;
+            }
+
+            if (ctx->currjob->status == ASYNC_JOB_PAUSED) {
+                /* Resume previous job */
+                ctx->currjob->status = ASYNC_JOB_RUNNING;
+                if (!async_fibre_swapcontext(&ctx->dispatcher,
+                                             &ctx->currjob->fibrectx)) {
+                    ASYNCerr(ASYNC_F_ASYNC_START_JOB,
+                             ASYNC_R_FAILED_TO_SWAP_CONTEXT);
+                    goto err;
+                }
+                continue;
+            }
+
+            /* Should not happen */
+            ASYNCerr(ASYNC_F_ASYNC_START_JOB, ERR_R_INTERNAL_ERROR);
+            goto err;
+        }
+
+        /* Start a new job */
+        if ((ctx->currjob = async_get_pool_job()) == NULL)
+            return ASYNC_NO_JOBS;
+
+        if (args != NULL) {
+            ctx->currjob->funcargs = OPENSSL_malloc(size);
+            if (ctx->currjob->funcargs == NULL) {
+                ASYNCerr(ASYNC_F_ASYNC_START_JOB, ERR_R_MALLOC_FAILURE);
+                async_release_job(ctx->currjob);
+                ctx->currjob = NULL;
+                return ASYNC_ERR;
+            }
+            memcpy(ctx->currjob->funcargs, args, size);
+        } else {
+            ctx->currjob->funcargs = NULL;
+        }
+
+        ctx->currjob->func = func;
+        if (!async_fibre_swapcontext(&ctx->dispatcher,
+                                     &ctx->currjob->fibrectx)) {
+            ASYNCerr(ASYNC_F_ASYNC_START_JOB, ASYNC_R_FAILED_TO_SWAP_CONTEXT);
+            goto err;
+        }
+    }
+
+ err:
+    async_release_job(ctx->currjob);
+    ctx->currjob = NULL;
+    *job = NULL;
+    return ASYNC_ERR;
+}
+
+/*
+ * Suspend the current job and return to the caller of ASYNC_start_job().
+ * Outside of a job, or while pausing is blocked, this is a no-op. Returns 0
+ * when the job is being abandoned by ASYNC_free_job(), which then also
+ * makes any further pause fail straight away.
+ */
+int ASYNC_pause_job(void)
+{
+    ASYNC_JOB *job;
+    async_ctx *ctx = async_get_ctx();
+
+    if (ctx == NULL || ctx->currjob == NULL || ctx->blocked) {
+        /*
+         * Could be we've deliberately not been started within a job so this
+         * is counted as success.
+         */
+        return 1;
+    }
+
+    job = ctx->currjob;
+    if (job->abandoned)
+        return 0;
+    job->status = ASYNC_JOB_PAUSING;
+
+    if (!async_fibre_swapcontext(&job->fibrectx, &ctx->dispatcher)) {
+        ASYNCerr(ASYNC_F_ASYNC_PAUSE_JOB, ASYNC_R_FAILED_TO_SWAP_CONTEXT);
+        return 0;
+    }
+
+    /* Resumed by ASYNC_free_job() rather than ASYNC_start_job() */
+    if (job->abandoned)
+        return 0;
+    return 1;
+}
+
+/*
+ * Abandon the paused |job|. It is resumed one last time, with every further
+ * ASYNC_pause_job() failing, so that whatever it is waiting for gives up
+ * and its function runs to the end. The job then goes back to the calling
+ * thread's pool, which should be the one that started it, or is freed if
+ * the thread has none.
+ */
+void ASYNC_free_job(ASYNC_JOB *job)
+{
+    async_ctx *ctx;
+
+    if (job == NULL || job->status != ASYNC_JOB_PAUSED)
+        return;
+
+    ctx = async_get_ctx();
+    if (ctx == NULL)
+        ctx = async_ctx_new();
+    if (ctx == NULL)
+        return;
+    if (ctx->currjob != NULL) {
+        /* Jobs cannot be nested */
+        ASYNCerr(ASYNC_F_ASYNC_FREE_JOB, ASYNC_R_ALREADY_IN_A_JOB);
+        return;
+    }
+
+    job->abandoned = 1;
+    job->status = ASYNC_JOB_RUNNING;
+    ctx->currjob = job;
+    if (!async_fibre_swapcontext(&ctx->dispatcher, &job->fibrectx))
+        ASYNCerr(ASYNC_F_ASYNC_FREE_JOB, ASYNC_R_FAILED_TO_SWAP_CONTEXT);
+    if (async_get_pool() != NULL)
+        async_release_job(job);
+    else
+        async_job_free(job);
+    ctx->currjob = NULL;
+}
+
+static void async_empty_pool(async_pool *pool)
+{
+    ASYNC_JOB *job;
+
+    while ((job = pool->free_jobs) != NULL) {
+        pool->free_jobs = job->next;
+        async_job_free(job);
+    }
+    pool->curr_size = 0;
+}
+
+/*
+ * Set up the calling thread's job pool with at most |max_size| jobs (0 for
+ * no limit), |init_size| of which are created straight away.
+ */
+int ASYNC_init_pool(size_t max_size, size_t init_size)
+{
+    async_pool *pool;
+    ASYNC_JOB *job;
+    size_t curr_size = 0;
+
+    if (init_size > max_size && max_size != 0) {
+        ASYNCerr(ASYNC_F_ASYNC_INIT_POOL, ASYNC_R_INVALID_POOL_SIZE);
+        return 0;
+    }
+
+    if (!async_global_init()) {
+        ASYNCerr(ASYNC_F_ASYNC_INIT_POOL, ASYNC_R_UNSUPPORTED);
+        return 0;
+    }
+
+    if (async_get_pool() != NULL) {
+        ASYNCerr(ASYNC_F_ASYNC_INIT_POOL, ASYNC_R_POOL_ALREADY_INITED);
+        return 0;
+    }
+
+    if ((pool = async_pool_new(max_size)) == NULL)
+        return 0;
+
+    /* Pre-create jobs as required */
+    while (init_size--) {
+        job = async_job_new();
+        if (job == NULL) {
+            /*
+             * Not actually fatal because we already created the pool, just
+             * skip creation of any more jobs
+             */
+            break;
+        }
+        job->next = pool->free_jobs;
+        pool->free_jobs = job;
+        curr_size++;
+    }
+    pool->curr_size = curr_size;
+
+    return 1;
+}
+
+/*
+ * Free the calling thread's job pool. Any job that is still paused is not
+ * part of the pool and has to be completed first.
+ */
+void ASYNC_free_pool(void)
+{
+    async_pool *pool = async_get_pool();
+
+    if (pool == NULL)
+        return;
+
+    async_empty_pool(pool);
+    async_set_pool(NULL);
+    OPENSSL_free(pool);
+    async_ctx_free();
+}
+
+ASYNC_JOB *ASYNC_get_current_job(void)
+{
+    async_ctx *ctx;
+
+    ctx = async_get_ctx();
+    if (ctx == NULL)
+        return NULL;
+
+    return ctx->currjob;
+}
+
+int ASYNC_get_wait_fd(ASYNC_JOB *job)
+{
+    return job->wait_fd;
+}
+
+/*
+ * Signal that whatever |job| is waiting for has happened. Unlike the other
+ * functions this may be called from a different thread to the one running
+ * the job.
+ */
+void ASYNC_wake(ASYNC_JOB *job)
+{
+    async_write_wake(job->wake_fd);
+}
+
+void ASYNC_clear_wake(ASYNC_JOB *job)
+{
+    async_drain_wake(job->wait_fd);
+}
+
+/*
+ * Returns 1 if ASYNC_pause_job() would really pause, i.e. we are running in
+ * a job that is not being abandoned and pausing is not blocked.
+ */
+int ASYNC_can_pause(void)
+{
+    async_ctx *ctx = async_get_ctx();
+
+    return ctx != NULL && ctx->currjob != NULL && ctx->blocked == 0
+        && !ctx->currjob->abandoned;
+}
+
+void ASYNC_block_pause(void)
+{
+    async_ctx *ctx = async_get_ctx();
+
+    if (ctx == NULL || ctx->currjob == NULL) {
+        /*
+         * We're not in a job anyway so ignore this
+         */
+        return;
+    }
+    ctx->blocked++;
+}
+
+void ASYNC_unblock_pause(void)
+{
+    async_ctx *ctx = async_get_ctx();
+
+    if (ctx == NULL || ctx->currjob == NULL || ctx->blocked == 0) {
+        /*
+         * We're not in a job anyway so ignore this
+         */
+        return;
+    }
+    ctx->blocked--;
+}
@@ -0,0 +1,231 @@
+#!/usr/bin/env perl
+
+# ====================================================================
+# This module is part of the OpenSSL project. It is licensed under the
+# OpenSSL license; see the LICENSE file in the top-level directory.
+# ====================================================================
+
+# October 2015.
+#
+# Single-operation Montgomery multiplication for 1536- and 2048-bit
+# moduli, the CRT halves of RSA3072 and RSA4096, which are too large
+# for rsaz-avx2.pl. Unlike rsaz-avx512.pl the vector lanes hold
+# consecutive digits of one number rather than the same digit of
+# several numbers, so a single exponentiation is accelerated.
+#
+# Numbers are kept in radix 2^52 with the IFMA instructions, N = 30 or
+# 40 digits stored in arrays of 32 or 40 qwords, the padding digits
+# being zero. Operands and accumulator are kept in zmm registers.
+#
+# rsaz_amm52x30_avx512 and rsaz_amm52x40_avx512 are "almost"
+# Montgomery multiplications: with R = 2^(52*N) > 4*m, inputs smaller
+# than 2*m give an output smaller than 2*m, without a final
+# subtraction. Inputs and outputs are normalised, i.e. every digit is
+# smaller than 2^52.
+#
+# An AVX2 version in radix 2^28 was tried as well, but even with
+# MULX/ADCX disabled it was no faster than x86_64-mont5.pl.
+#
+#			sign/s	rsa3072		rsa4096
+# Xeon with IFMA	mont5		493		228
+#		this module	781		492
+
+$flavour = shift;
+$output  = shift;
+if ($flavour =~ /\./) { $output = $flavour; undef $flavour; }
+
+$win64=0; $win64=1 if ($flavour =~ /[nm]asm|mingw64/ || $output =~ /\.asm$/);
+
+$0 =~ m/(.*[\/\\])[^\/\\]+$/; $dir=$1;
+( $xlate="${dir}x86_64-xlate.pl" and -f $xlate ) or
+( $xlate="${dir}../../perlasm/x86_64-xlate.pl" and -f $xlate) or
+die "can't locate x86_64-xlate.pl";
+
+if (`$ENV{CC} -Wa,-v -c -o /dev/null -x assembler /dev/null 2>&1`
+		=~ /GNU assembler version ([2-9]\.[0-9]+)/) {
+	$ifma = ($1>=2.26);
+}
+
+if (!$ifma && `$ENV{CC} -v 2>&1` =~ /(^clang version|based on LLVM) ([3-9])\.([0-9]+)/) {
+	my $ver = $2 + $3/100.0;	# 3.1->3.01, 3.10->3.10
+	$ifma = ($ver>=3.09);
+}
+
+open OUT,"| \"$^X\" $xlate $flavour $output";
+*STDOUT = *OUT;
+
+$code.=<<___;
+.text
+___
+
+# void rsaz_amm52xN_avx512(BN_ULONG *res, const BN_ULONG *a,
+#                          const BN_ULONG *b, const BN_ULONG *m,
+#                          BN_ULONG k0);
+sub amm52_avx512 {
+my $N = shift;
+my $K = ($N+7)>>3;		# number of zmm registers per number
+my ($rp,$ap,$np,$k0) = ("%rdi","%rsi","%rcx","%r8");
+my ($mask,$cnt,$bp,$acc,$hi,$a0,$m0,$t) =
+	("%r9","%r10","%r11","%rbx","%r12","%r13","%r14","%r15");
+my @A = map("%zmm$_",(0..$K-1));
+my @M = map("%zmm$_",(5..5+$K-1));
+my @R = map("%zmm$_",(10..10+$K-1));
+my @H = map("%zmm$_",(19..19+$K-1));
+my ($B,$Y,$ZERO) = map("%zmm$_",(15,16,18));
+
+$code.=<<___;
+.globl	rsaz_amm52x${N}_avx512
+.type	rsaz_amm52x${N}_avx512,\@function,5
+.align	32
+rsaz_amm52x${N}_avx512:
+	push		%rbx
+	push		%r12
+	push		%r13
+	push		%r14
+	push		%r15
+	mov		%rdx,$bp
+	mov		\$0xfffffffffffff,$mask
+	mov		($ap),$a0
+	mov		($np),$m0
+	xor		$acc,$acc
+	vpxorq		$ZERO,$ZERO,$ZERO
+___
+for (my $k=0; $k<$K; $k++) {
+$code.=<<___;
+	vmovdqu64	`64*$k`($ap),$A[$k]
+	vmovdqu64	`64*$k`($np),$M[$k]
+	vpxorq		$R[$k],$R[$k],$R[$k]
+___
+}
+# The lowest digit of the accumulator is tracked exactly in $acc, with
+# full 128-bit products, which keeps the vector unit out of the
+# computation of y. Lane 0 of the vector accumulator is never read.
+# The high halves of the products go to a separate accumulator, so
+# that they need not wait for the shift.
+$code.=<<___;
+	mov		\$$N,$cnt
+	jmp		.Loop_amm52x${N}
+
+.align	32
+.Loop_amm52x${N}:
+	mov		($bp),%rdx
+	vpbroadcastq	%rdx,$B
+	lea		8($bp),$bp
+	mulx		$a0,%rax,$t
+	add		%rax,$acc
+	adc		\$0,$t			# acc + a[0]*b[i]
+___
+for (my $k=0; $k<$K; $k++) {
+$code.=<<___;
+	vpmadd52luq	$A[$k],$B,$R[$k]
+	vpxorq		$H[$k],$H[$k],$H[$k]
+	vpmadd52huq	$A[$k],$B,$H[$k]
+___
+}
+$code.=<<___;
+	mov		$acc,%rdx
+	imul		$k0,%rdx
+	and		$mask,%rdx		# y = acc*k0 mod 2^52
+	vpbroadcastq	%rdx,$Y
+	mulx		$m0,%rax,$hi
+	add		%rax,$acc
+	adc		$t,$hi
+	shrd		\$52,$hi,$acc		# (acc + m[0]*y) / 2^52
+___
+for (my $k=0; $k<$K; $k++) {
+$code.=<<___;
+	vpmadd52luq	$M[$k],$Y,$R[$k]
+	vpmadd52huq	$M[$k],$Y,$H[$k]
+___
+}
+# shift the accumulator down by one digit, digit 1 becomes the new
+# scalar digit 0
+$code.=<<___;
+	vpextrq		\$1,%xmm10,%rax		# R[0] is zmm10
+	add		%rax,$acc
+___
+for (my $k=0; $k<$K; $k++) {
+my $next = $k<$K-1 ? $R[$k+1] : $ZERO;
+$code.=<<___;
+	valignq		\$1,$R[$k],$next,$R[$k]
+	vpaddq		$H[$k],$R[$k],$R[$k]
+___
+}
+$code.=<<___;
+	dec		$cnt
+	jnz		.Loop_amm52x${N}
+___
+# a and b have been consumed, so res is free to use for normalising
+# to 52-bit digits; the result is smaller than 2*m
+for (my $k=0; $k<$K; $k++) {
+$code.=<<___;
+	vmovdqu64	$R[$k],`64*$k`($rp)
+___
+}
+$code.=<<___;
+	mov		$acc,($rp)
+	xor		$t,$t
+	xor		$cnt,$cnt
+.Lnorm_amm52x${N}:
+	mov		($rp,$cnt,8),%rax
+	add		$t,%rax
+	mov		%rax,$t
+	and		$mask,%rax
+	shr		\$52,$t
+	mov		%rax,($rp,$cnt,8)
+	inc		$cnt
+	cmp		\$`8*$K`,$cnt
+	jb		.Lnorm_amm52x${N}
+
+	vzeroupper
+	pop		%r15
+	pop		%r14
+	pop		%r13
+	pop		%r12
+	pop		%rbx
+	ret
+.size	rsaz_amm52x${N}_avx512,.-rsaz_amm52x${N}_avx512
+___
+}
+
+if ($ifma && !$win64) {
+	amm52_avx512(30);
+	amm52_avx512(40);
+
+$code.=<<___;
+.extern	OPENSSL_ia32cap_P
+.globl	rsaz_3k4k_eligible
+.type	rsaz_3k4k_eligible,\@abi-omnipotent
+.align	32
+rsaz_3k4k_eligible:
+	mov	OPENSSL_ia32cap_P+8(%rip),%ecx
+	xor	%eax,%eax
+	and	\$`1<<8|1<<16|1<<21`,%ecx
+	cmp	\$`1<<8|1<<16|1<<21`,%ecx	# check for BMI2+AVX512F+AVX512IFMA
+	sete	%al
+	ret
+.size	rsaz_3k4k_eligible,.-rsaz_3k4k_eligible
+___
+} else {
+$code.=<<___;	# assembler is too old, or Win64 which isn't supported
+.globl	rsaz_3k4k_eligible
+.type	rsaz_3k4k_eligible,\@abi-omnipotent
+rsaz_3k4k_eligible:
+	xor	%eax,%eax
+	ret
+.size	rsaz_3k4k_eligible,.-rsaz_3k4k_eligible
+
+.globl	rsaz_amm52x30_avx512
+.globl	rsaz_amm52x40_avx512
+.type	rsaz_amm52x30_avx512,\@abi-omnipotent
+rsaz_amm52x30_avx512:
+rsaz_amm52x40_avx512:
+	.byte	0x0f,0x0b	# ud2
+	ret
+.size	rsaz_amm52x30_avx512,.-rsaz_amm52x30_avx512
+___
+}
+
+$code =~ s/\`([^\`]*)\`/eval $1/gem;
+print $code;
+close STDOUT;
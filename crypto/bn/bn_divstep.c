@@ -0,0 +1,368 @@
+/* crypto/bn/bn_divstep.c */
+/* ====================================================================
+ * Copyright (c) 2015 The OpenSSL Project.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. All advertising materials mentioning features or use of this
+ *    software must display the following acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit. (http://www.openssl.org/)"
+ *
+ * 4. The names "OpenSSL Toolkit" and "OpenSSL Project" must not be used to
+ *    endorse or promote products derived from this software without
+ *    prior written permission. For written permission, please contact
+ *    openssl-core@openssl.org.
+ *
+ * 5. Products derived from this software may not be called "OpenSSL"
+ *    nor may "OpenSSL" appear in their names without prior written
+ *    permission of the OpenSSL Project.
+ *
+ * 6. Redistributions of any form whatsoever must retain the following
+ *    acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit (http://www.openssl.org/)"
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE OpenSSL PROJECT ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE OpenSSL PROJECT OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ====================================================================
+ */
+
+#include "cryptlib.h"
+#include "bn_lcl.h"
+
+/*
+ * Constant-time modular inversion by the "safegcd" divsteps of Bernstein
+ * and Yang, "Fast constant-time gcd computation and modular inversion",
+ * https://eprint.iacr.org/2019/266.
+ *
+ * Numbers are held as signed limbs of DIVSTEP_BITS bits, all but the top
+ * one in [0, 2^DIVSTEP_BITS). Divsteps are done DIVSTEP_BITS at a time on
+ * the low limbs only, collecting a transition matrix that is then applied
+ * to the full numbers; the batching and the way d and e are kept reduced
+ * follow libsecp256k1's modinv64. The number of divsteps depends only on
+ * the size of the modulus, and no step branches on or indexes by secret
+ * data.
+ */
+
+#if defined(__SIZEOF_INT128__) && __SIZEOF_INT128__ == 16
+# define DIVSTEP_BITS    62
+typedef long long limb_t;
+typedef unsigned long long ulimb_t;
+typedef __int128_t dlimb_t;
+#else
+# define DIVSTEP_BITS    30
+typedef int limb_t;
+typedef unsigned int ulimb_t;
+# if defined(_MSC_VER)
+typedef __int64 dlimb_t;
+# else
+typedef long long dlimb_t;
+# endif
+#endif
+
+#define LIMB_BITS       (int)(sizeof(limb_t) * 8)
+#define LIMB_MASK       ((((ulimb_t)1) << DIVSTEP_BITS) - 1)
+/* two bits of headroom and a sign bit for d and e, see update_de() */
+#define DIVSTEP_LIMBS(bits) (((bits) + 2) / DIVSTEP_BITS + 1)
+#define DIVSTEP_MAX_LIMBS DIVSTEP_LIMBS(BN_MOD_INVERSE_FIXED_MAX_BITS)
+#define MAX_WORDS       (BN_MOD_INVERSE_FIXED_MAX_BITS / BN_BITS2)
+
+/*
+ * Do DIVSTEP_BITS divsteps on the low bits |f0| and |g0| of f and g and
+ * return the new delta. On return t = [u v; q r] satisfies
+ * 2^DIVSTEP_BITS * (f', g') = (u*f + v*g, q*f + r*g), with
+ * |u| + |v| and |q| + |r| at most 2^DIVSTEP_BITS.
+ */
+static limb_t divsteps(limb_t delta, ulimb_t f0, ulimb_t g0, limb_t t[4])
+{
+    ulimb_t u = 1, v = 0, q = 0, r = 1;
+    ulimb_t f = f0, g = g0, x, y, z, c1, c2;
+    int i;
+
+    for (i = 0; i < DIVSTEP_BITS; i++) {
+        /* c1: delta > 0, c2: g is odd */
+        c1 = 0 - (((ulimb_t)0 - (ulimb_t)delta) >> (LIMB_BITS - 1));
+        c2 = 0 - (g & 1);
+        /*
+         * If g is odd, add f to g, or subtract it if delta > 0; in the
+         * latter case also replace f by the old g and negate delta.
+         */
+        x = (f ^ c1) - c1;
+        y = (u ^ c1) - c1;
+        z = (v ^ c1) - c1;
+        g += x & c2;
+        q += y & c2;
+        r += z & c2;
+        c1 &= c2;
+        delta = (limb_t)(((ulimb_t)delta ^ c1) - c1) + 1;
+        f += g & c1;
+        u += q & c1;
+        v += r & c1;
+        /* g is even now */
+        g >>= 1;
+        u <<= 1;
+        v <<= 1;
+    }
+    t[0] = (limb_t)u;
+    t[1] = (limb_t)v;
+    t[2] = (limb_t)q;
+    t[3] = (limb_t)r;
+    return delta;
+}
+
+/*
+ * (d, e) = t * (d, e) / 2^DIVSTEP_BITS mod m. Multiples of m are added so
+ * that the division is exact; with d and e in (-2m, m) on input they stay
+ * in that range.
+ */
+static void update_de(limb_t *d, limb_t *e, const limb_t t[4],
+                      const limb_t *m, ulimb_t minv, int n)
+{
+    const limb_t u = t[0], v = t[1], q = t[2], r = t[3];
+    limb_t sd, se, md, me;
+    dlimb_t cd, ce;
+    int i;
+
+    sd = (limb_t)(0 - ((ulimb_t)d[n - 1] >> (LIMB_BITS - 1)));
+    se = (limb_t)(0 - ((ulimb_t)e[n - 1] >> (LIMB_BITS - 1)));
+    md = (u & sd) + (v & se);
+    me = (q & sd) + (r & se);
+    cd = (dlimb_t)u * d[0] + (dlimb_t)v * e[0];
+    ce = (dlimb_t)q * d[0] + (dlimb_t)r * e[0];
+    /* choose md and me so that the low limb becomes zero */
+    md -= (limb_t)((minv * (ulimb_t)cd + (ulimb_t)md) & LIMB_MASK);
+    me -= (limb_t)((minv * (ulimb_t)ce + (ulimb_t)me) & LIMB_MASK);
+    cd += (dlimb_t)m[0] * md;
+    ce += (dlimb_t)m[0] * me;
+    cd >>= DIVSTEP_BITS;
+    ce >>= DIVSTEP_BITS;
+    for (i = 1; i < n; i++) {
+        cd += (dlimb_t)u * d[i] + (dlimb_t)v * e[i] + (dlimb_t)m[i] * md;
+        ce += (dlimb_t)q * d[i] + (dlimb_t)r * e[i] + (dlimb_t)m[i] * me;
+        d[i - 1] = (limb_t)((ulimb_t)cd & LIMB_MASK);
+        e[i - 1] = (limb_t)((ulimb_t)ce & LIMB_MASK);
+        cd >>= DIVSTEP_BITS;
+        ce >>= DIVSTEP_BITS;
+    }
+    d[n - 1] = (limb_t)cd;
+    e[n - 1] = (limb_t)ce;
+}
+
+/* (f, g) = t * (f, g) / 2^DIVSTEP_BITS, the division being exact */
+static void update_fg(limb_t *f, limb_t *g, const limb_t t[4], int n)
+{
+    const limb_t u = t[0], v = t[1], q = t[2], r = t[3];
+    dlimb_t cf, cg;
+    int i;
+
+    cf = (dlimb_t)u * f[0] + (dlimb_t)v * g[0];
+    cg = (dlimb_t)q * f[0] + (dlimb_t)r * g[0];
+    cf >>= DIVSTEP_BITS;
+    cg >>= DIVSTEP_BITS;
+    for (i = 1; i < n; i++) {
+        cf += (dlimb_t)u * f[i] + (dlimb_t)v * g[i];
+        cg += (dlimb_t)q * f[i] + (dlimb_t)r * g[i];
+        f[i - 1] = (limb_t)((ulimb_t)cf & LIMB_MASK);
+        g[i - 1] = (limb_t)((ulimb_t)cg & LIMB_MASK);
+        cf >>= DIVSTEP_BITS;
+        cg >>= DIVSTEP_BITS;
+    }
+    f[n - 1] = (limb_t)cf;
+    g[n - 1] = (limb_t)cg;
+}
+
+/* Bring the limbs of a back to [0, 2^DIVSTEP_BITS), but for the top one. */
+static void carry(limb_t *a, int n)
+{
+    int i;
+
+    for (i = 0; i < n - 1; i++) {
+        /* arithmetic shift */
+        a[i + 1] += (limb_t)(((dlimb_t)a[i]) >> DIVSTEP_BITS);
+        a[i] = (limb_t)((ulimb_t)a[i] & LIMB_MASK);
+    }
+}
+
+/* Add m to a if a is negative. */
+static void add_if_negative(limb_t *a, const limb_t *m, int n)
+{
+    limb_t mask = (limb_t)(0 - ((ulimb_t)a[n - 1] >> (LIMB_BITS - 1)));
+    int i;
+
+    for (i = 0; i < n; i++)
+        a[i] += m[i] & mask;
+    carry(a, n);
+}
+
+static void words_to_limbs(limb_t *out, int n, const BN_ULONG *in, int num)
+{
+    int i, got, w, s;
+    ulimb_t acc;
+
+    for (i = 0; i < n; i++) {
+        w = (i * DIVSTEP_BITS) / BN_BITS2;
+        s = (i * DIVSTEP_BITS) % BN_BITS2;
+        for (acc = 0, got = 0; got < DIVSTEP_BITS && w < num; w++) {
+            acc |= (ulimb_t)(in[w] >> s) << got;
+            got += BN_BITS2 - s;
+            s = 0;
+        }
+        out[i] = (limb_t)(acc & LIMB_MASK);
+    }
+}
+
+/* |in| must be non-negative and fit in |num| words */
+static void limbs_to_words(BN_ULONG *out, int num, const limb_t *in, int n)
+{
+    int i, put, w, s;
+    ulimb_t v;
+
+    for (w = 0; w < num; w++)
+        out[w] = 0;
+    for (i = 0; i < n; i++) {
+        v = (ulimb_t)in[i];
+        w = (i * DIVSTEP_BITS) / BN_BITS2;
+        s = (i * DIVSTEP_BITS) % BN_BITS2;
+        for (put = 0; put < DIVSTEP_BITS && w < num; w++) {
+            out[w] |= (BN_ULONG)(v >> put) << s;
+            put += BN_BITS2 - s;
+            s = 0;
+        }
+    }
+}
+
+/*
+ * Set r to the inverse of a modulo the odd m, all |num| words long and
+ * |num| at most BN_MOD_INVERSE_FIXED_MAX_BITS / BN_BITS2. a need not be
+ * reduced. The running time depends on |num| only. Returns 0, with r
+ * set to garbage, if a has no inverse.
+ */
+int bn_mod_inverse_words(BN_ULONG *r, const BN_ULONG *a, const BN_ULONG *m,
+                         int num)
+{
+    limb_t f[DIVSTEP_MAX_LIMBS], g[DIVSTEP_MAX_LIMBS];
+    limb_t d[DIVSTEP_MAX_LIMBS], e[DIVSTEP_MAX_LIMBS], ml[DIVSTEP_MAX_LIMBS];
+    limb_t t[4], delta = 1, fsign, acc;
+    ulimb_t minv;
+    int i, n, bits, steps, ok;
+
+    if (num <= 0 || num > MAX_WORDS || (m[0] & 1) == 0)
+        return 0;
+
+    /*
+     * Bernstein and Yang, theorem 11.2: for odd f and 0 <= g < 2^bits with
+     * f < 2^bits, this many divsteps bring g to zero.
+     */
+    bits = num * BN_BITS2;
+    steps = (bits < 46 ? (49 * bits + 80) / 17 : (49 * bits + 57) / 17) + 1;
+    n = DIVSTEP_LIMBS(bits);
+
+    words_to_limbs(ml, n, m, num);
+    memcpy(f, ml, n * sizeof(*f));
+    words_to_limbs(g, n, a, num);
+    memset(d, 0, n * sizeof(*d));
+    memset(e, 0, n * sizeof(*e));
+    e[0] = 1;
+
+    /* m^-1 mod 2^DIVSTEP_BITS by Newton iteration: 3, 6, 12, ... bits */
+    minv = (ulimb_t)ml[0];
+    for (i = 0; i < 5; i++)
+        minv *= 2 - (ulimb_t)ml[0] * minv;
+    minv &= LIMB_MASK;
+
+    for (i = 0; i < steps; i += DIVSTEP_BITS) {
+        delta = divsteps(delta, (ulimb_t)f[0], (ulimb_t)g[0], t);
+        update_de(d, e, t, ml, minv, n);
+        update_fg(f, g, t, n);
+    }
+
+    /* f is now +/- gcd(a, m), and d * a = f mod m */
+    fsign = (limb_t)(0 - ((ulimb_t)f[n - 1] >> (LIMB_BITS - 1)));
+    for (i = 0; i < n; i++)
+        f[i] = (f[i] ^ fsign) - fsign;
+    carry(f, n);
+    acc = f[0] ^ 1;
+    for (i = 1; i < n; i++)
+        acc |= f[i];
+    ok = acc == 0;
+
+    /* d is in (-2m, m): bring it to [0, m) and apply the sign of f */
+    add_if_negative(d, ml, n);
+    for (i = 0; i < n; i++)
+        d[i] = (d[i] ^ fsign) - fsign;
+    carry(d, n);
+    add_if_negative(d, ml, n);
+    limbs_to_words(r, num, d, n);
+
+    OPENSSL_cleanse(f, sizeof(f));
+    OPENSSL_cleanse(g, sizeof(g));
+    OPENSSL_cleanse(d, sizeof(d));
+    OPENSSL_cleanse(e, sizeof(e));
+    OPENSSL_cleanse(t, sizeof(t));
+    return ok;
+}
+
+/*
+ * Constant-time BN_mod_inverse() for odd m of up to
+ * BN_MOD_INVERSE_FIXED_MAX_BITS bits; a must not be negative or longer
+ * than m. Works on the stack only. Returns 1 on success and 0 on error.
+ */
+int bn_mod_inverse_fixed(BIGNUM *r, const BIGNUM *a, const BIGNUM *m)
+{
+    BN_ULONG aw[MAX_WORDS];
+    int i, num = m->top;
+
+    bn_check_top(a);
+    bn_check_top(m);
+
+    if (!BN_is_odd(m)) {
+        BNerr(BN_F_BN_MOD_INVERSE_FIXED, BN_R_CALLED_WITH_EVEN_MODULUS);
+        return 0;
+    }
+    if (num > MAX_WORDS) {
+        BNerr(BN_F_BN_MOD_INVERSE_FIXED, BN_R_BIGNUM_TOO_LONG);
+        return 0;
+    }
+    if (a->neg || a->top > num) {
+        BNerr(BN_F_BN_MOD_INVERSE_FIXED, BN_R_INPUT_NOT_REDUCED);
+        return 0;
+    }
+    for (i = 0; i < a->top; i++)
+        aw[i] = a->d[i];
+    for (; i < num; i++)
+        aw[i] = 0;
+
+    if (bn_wexpand(r, num) == NULL)
+        return 0;
+    if (!bn_mod_inverse_words(r->d, aw, m->d, num)) {
+        OPENSSL_cleanse(aw, sizeof(aw));
+        BNerr(BN_F_BN_MOD_INVERSE_FIXED, BN_R_NO_INVERSE);
+        return 0;
+    }
+    OPENSSL_cleanse(aw, sizeof(aw));
+    r->top = num;
+    r->neg = 0;
+    bn_correct_top(r);
+    return 1;
+}
@@ -721,6 +721,32 @@ int BN_mod_exp_mont_consttime(BIGNUM *rr, const BIGNUM *a, const BIGNUM *p,
         bn_correct_top(rr);
         ret = 1;
         goto err;
+    } else if ((24 == top || 32 == top) && !a->neg && a->top <= top
+               && BN_ucmp(a, m) < 0 && p->top <= top && mont->RR.top <= top
+               && RSAZ_3k4k_usable(BN_num_bits(m))) {
+        /* 1536 and 2048-bit moduli, i.e. RSA3072 and RSA4096 CRT */
+        BN_ULONG base[32], exponent[32], RR[32];
+
+        if (NULL == bn_wexpand(rr, top))
+            goto err;
+        memset(base, 0, sizeof(base));
+        memset(exponent, 0, sizeof(exponent));
+        memset(RR, 0, sizeof(RR));
+        memcpy(base, a->d, a->top * sizeof(BN_ULONG));
+        memcpy(exponent, p->d, p->top * sizeof(BN_ULONG));
+        memcpy(RR, mont->RR.d, mont->RR.top * sizeof(BN_ULONG));
+        ret = RSAZ_mod_exp_3k4k(rr->d, base, exponent, m->d, RR,
+                                mont->n0[0], BN_num_bits(m));
+        OPENSSL_cleanse(base, sizeof(base));
+        OPENSSL_cleanse(exponent, sizeof(exponent));
+        if (!ret) {
+            BNerr(BN_F_BN_MOD_EXP_MONT_CONSTTIME, ERR_R_MALLOC_FAILURE);
+            goto err;
+        }
+        rr->top = top;
+        rr->neg = 0;
+        bn_correct_top(rr);
+        goto err;
     }
 #endif
 
@@ -1139,6 +1165,129 @@ int BN_mod_exp_mont_consttime(BIGNUM *rr, const BIGNUM *a, const BIGNUM *p,
     return (ret);
 }
 
+#ifdef RSAZ_ENABLED
+/*
+ * Below this number of operands a group is cheaper to do one by one than
+ * with all eight lanes of RSAZ_1024_mod_exp_avx512_x8().
+ */
+# define RSAZ_X8_MIN_LANES      3
+
+static int rsaz_x8_eligible(const BIGNUM *a, const BIGNUM *p,
+                            const BIGNUM *m, const BN_MONT_CTX *mont)
+{
+    return mont != NULL && BN_num_bits(m) == 1024 && mont->RR.top <= 16
+        && !a->neg && a->top <= 16 && BN_ucmp(a, m) < 0
+        && !p->neg && p->top <= 16;
+}
+
+/* Copy |a| into the 16-word array |out|, zero-padded */
+static void rsaz_x8_copy(BN_ULONG out[16], const BIGNUM *a)
+{
+    int i;
+
+    for (i = 0; i < a->top; i++)
+        out[i] = a->d[i];
+    for (; i < 16; i++)
+        out[i] = 0;
+}
+
+/* Do the operations listed in |idx| with RSAZ_1024_mod_exp_avx512_x8() */
+static int rsaz_x8_mod_exp(BIGNUM *rr[], const BIGNUM *a[], const BIGNUM *p[],
+                           const BIGNUM *m[], BN_MONT_CTX *mont[],
+                           const int idx[8], int n)
+{
+    BN_ULONG base[8][16], exponent[8][16], mod[8][16], RR[8][16], k0[8];
+    BN_ULONG res[8][16];
+    BN_ULONG *res_p[8];
+    const BN_ULONG *base_p[8], *exponent_p[8], *mod_p[8], *RR_p[8];
+    int i, j, ret = 0;
+
+    for (i = 0; i < 8; i++) {
+        /* Unused lanes repeat the first operation */
+        j = idx[i < n ? i : 0];
+        rsaz_x8_copy(base[i], a[j]);
+        rsaz_x8_copy(exponent[i], p[j]);
+        rsaz_x8_copy(mod[i], m[j]);
+        rsaz_x8_copy(RR[i], &mont[j]->RR);
+        k0[i] = mont[j]->n0[0];
+        res_p[i] = res[i];
+        base_p[i] = base[i];
+        exponent_p[i] = exponent[i];
+        mod_p[i] = mod[i];
+        RR_p[i] = RR[i];
+    }
+
+    if (!RSAZ_1024_mod_exp_avx512_x8(res_p, base_p, exponent_p, mod_p, RR_p,
+                                     k0)) {
+        BNerr(BN_F_BN_MOD_EXP_MONT_CONSTTIME_BATCH, ERR_R_MALLOC_FAILURE);
+        goto err;
+    }
+
+    for (i = 0; i < n; i++) {
+        BIGNUM *r = rr[idx[i]];
+
+        if (bn_wexpand(r, 16) == NULL)
+            goto err;
+        memcpy(r->d, res[i], sizeof(res[i]));
+        r->top = 16;
+        r->neg = 0;
+        bn_correct_top(r);
+    }
+    ret = 1;
+ err:
+    OPENSSL_cleanse(base, sizeof(base));
+    OPENSSL_cleanse(exponent, sizeof(exponent));
+    OPENSSL_cleanse(res, sizeof(res));
+    return ret;
+}
+#endif
+
+/*
+ * Compute rr[i] = a[i]^p[i] mod m[i] for i = 0..num-1, as
+ * BN_mod_exp_mont_consttime() would, but with independent operations
+ * running side by side where the platform has multi-lane kernels for the
+ * operand size. Entries of |mont| may be NULL. The results must not alias
+ * any of the inputs.
+ */
+int bn_mod_exp_mont_consttime_batch(BIGNUM *rr[], const BIGNUM *a[],
+                                    const BIGNUM *p[], const BIGNUM *m[],
+                                    BN_MONT_CTX *mont[], int num, BN_CTX *ctx)
+{
+    int i;
+#ifdef RSAZ_ENABLED
+    int idx[8], n = 0;
+
+    if (num >= RSAZ_X8_MIN_LANES && rsaz_avx512ifma_eligible()) {
+        for (i = 0; i < num; i++) {
+            if (!rsaz_x8_eligible(a[i], p[i], m[i], mont[i])) {
+                if (!BN_mod_exp_mont_consttime(rr[i], a[i], p[i], m[i], ctx,
+                                               mont[i]))
+                    return 0;
+                continue;
+            }
+            idx[n++] = i;
+            if (n == 8) {
+                if (!rsaz_x8_mod_exp(rr, a, p, m, mont, idx, n))
+                    return 0;
+                n = 0;
+            }
+        }
+        if (n >= RSAZ_X8_MIN_LANES)
+            return rsaz_x8_mod_exp(rr, a, p, m, mont, idx, n);
+        for (i = 0; i < n; i++)
+            if (!BN_mod_exp_mont_consttime(rr[idx[i]], a[idx[i]], p[idx[i]],
+                                           m[idx[i]], ctx, mont[idx[i]]))
+                return 0;
+        return 1;
+    }
+#endif
+
+    for (i = 0; i < num; i++)
+        if (!BN_mod_exp_mont_consttime(rr[i], a[i], p[i], m[i], ctx, mont[i]))
+            return 0;
+    return 1;
+}
+
 int BN_mod_exp_mont_word(BIGNUM *rr, BN_ULONG a, const BIGNUM *p,
                          const BIGNUM *m, BN_CTX *ctx, BN_MONT_CTX *in_mont)
 {
@@ -183,6 +183,8 @@ static const int prime_multiplier_bits = 11; /* 2^|prime_multiplier_bits| <=
                                               * |prime_multiplier| */
 static const int first_prime_index = 5;
 
+#define PRIME_SEARCH_MIN_BITS   512
+
 int BN_GENCB_call(BN_GENCB *cb, int a, int b)
 {
     /* No callback means continue */
@@ -205,8 +207,8 @@ int BN_GENCB_call(BN_GENCB *cb, int a, int b)
     return 0;
 }
 
-int BN_generate_prime_ex(BIGNUM *ret, int bits, int safe,
-                         const BIGNUM *add, const BIGNUM *rem, BN_GENCB *cb)
+static int generate_prime(BIGNUM *ret, int bits, int safe,
+                          const BIGNUM *add, const BIGNUM *rem, BN_GENCB *cb)
 {
     BIGNUM *t;
     int found = 0;
@@ -214,16 +216,6 @@ int BN_generate_prime_ex(BIGNUM *ret, int bits, int safe,
     BN_CTX *ctx;
     int checks = BN_prime_checks_for_size(bits);
 
-    if (bits < 2) {
-        /* There are no prime numbers this small. */
-        BNerr(BN_F_BN_GENERATE_PRIME_EX, BN_R_BITS_TOO_SMALL);
-        return 0;
-    } else if (bits == 2 && safe) {
-        /* The smallest safe prime (7) is three bits. */
-        BNerr(BN_F_BN_GENERATE_PRIME_EX, BN_R_BITS_TOO_SMALL);
-        return 0;
-    }
-
     ctx = BN_CTX_new();
     if (ctx == NULL)
         goto err;
@@ -293,6 +285,68 @@ int BN_generate_prime_ex(BIGNUM *ret, int bits, int safe,
     return found;
 }
 
+typedef struct {
+    int bits, safe;
+    const BIGNUM *add, *rem;
+    BIGNUM *result;             /* set by the winning worker */
+} PRIME_SEARCH;
+
+/*
+ * Each worker runs a search of its own from a random starting point; the
+ * first one to find a prime stops the others.
+ */
+static int prime_search_worker(BN_SEARCH *s, int worker, BN_GENCB *cb,
+                               void *arg)
+{
+    PRIME_SEARCH *ps = arg;
+    BIGNUM *p;
+    long idx;
+    int ret;
+
+    if (!bn_search_next(s, worker, &idx))
+        return 1;
+    if ((p = BN_new()) == NULL)
+        return 0;
+    ret = generate_prime(p, ps->bits, ps->safe, ps->add, ps->rem, cb);
+    if (ret && bn_search_found(s, worker, 0)) {
+        ps->result = p;
+        return 1;
+    }
+    BN_free(p);
+    return ret;
+}
+
+int BN_generate_prime_ex(BIGNUM *ret, int bits, int safe,
+                         const BIGNUM *add, const BIGNUM *rem, BN_GENCB *cb)
+{
+    PRIME_SEARCH ps;
+    int threads = BN_get_prime_search_threads(), found;
+
+    if (bits < 2) {
+        /* There are no prime numbers this small. */
+        BNerr(BN_F_BN_GENERATE_PRIME_EX, BN_R_BITS_TOO_SMALL);
+        return 0;
+    } else if (bits == 2 && safe) {
+        /* The smallest safe prime (7) is three bits. */
+        BNerr(BN_F_BN_GENERATE_PRIME_EX, BN_R_BITS_TOO_SMALL);
+        return 0;
+    }
+
+    /* Smaller primes are found faster than threads can be started */
+    if (threads <= 1 || bits < PRIME_SEARCH_MIN_BITS)
+        return generate_prime(ret, bits, safe, add, rem, cb);
+
+    ps.bits = bits;
+    ps.safe = safe;
+    ps.add = add;
+    ps.rem = rem;
+    ps.result = NULL;
+    found = bn_search_run(threads, prime_search_worker, &ps, cb, NULL) >= 0
+        && BN_copy(ret, ps.result) != NULL;
+    BN_free(ps.result);
+    return found;
+}
+
 int BN_is_prime_ex(const BIGNUM *a, int checks, BN_CTX *ctx_passed,
                    BN_GENCB *cb)
 {
@@ -0,0 +1,263 @@
+/* crypto/bn/bn_search.c */
+/* ====================================================================
+ * Copyright (c) 2015 The OpenSSL Project.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. All advertising materials mentioning features or use of this
+ *    software must display the following acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit. (http://www.openssl.org/)"
+ *
+ * 4. The names "OpenSSL Toolkit" and "OpenSSL Project" must not be used to
+ *    endorse or promote products derived from this software without
+ *    prior written permission. For written permission, please contact
+ *    openssl-core@openssl.org.
+ *
+ * 5. Products derived from this software may not be called "OpenSSL"
+ *    nor may "OpenSSL" appear in their names without prior written
+ *    permission of the OpenSSL Project.
+ *
+ * 6. Redistributions of any form whatsoever must retain the following
+ *    acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit (http://www.openssl.org/)"
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE OpenSSL PROJECT ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE OpenSSL PROJECT OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ====================================================================
+ */
+
+/*
+ * Parallel search for primes. A search is split into candidates numbered
+ * 0, 1, 2, ... which worker threads take in turn; the lowest numbered
+ * candidate that turns out to be a hit is the result, so that searches
+ * which are deterministic when run on one thread (DSA parameter generation)
+ * give the same result on several. Random searches simply report every hit
+ * as candidate 0, which stops all the other workers.
+ *
+ * Workers are stopped through the BN_GENCB they are given, which fails as
+ * soon as their candidate can no longer win: BN_generate_prime_ex() and
+ * BN_is_prime_fasttest_ex() call it once per candidate and once per
+ * Miller-Rabin round. Only the calling thread, which is always worker 0,
+ * passes calls on to the caller's callback.
+ */
+
+#include <limits.h>
+#include "cryptlib.h"
+#include "bn_lcl.h"
+
+#if defined(OPENSSL_THREADS) && defined(OPENSSL_SYS_UNIX)
+# define SEARCH_THREADS
+# include <pthread.h>
+#endif
+
+#define SEARCH_MAX_THREADS      64
+
+typedef struct {
+    BN_SEARCH *s;
+    int worker;
+    long current;               /* candidate being tested */
+    int stopped;                /* the callback told the worker to stop */
+    BN_GENCB cb;
+#ifdef SEARCH_THREADS
+    pthread_t thread;
+#endif
+} SEARCH_WORKER;
+
+struct bn_search_st {
+#ifdef SEARCH_THREADS
+    pthread_mutex_t lock;
+#endif
+    long next;                  /* next candidate to hand out */
+    long best;                  /* lowest hit so far, LONG_MAX if none */
+    int winner;                 /* worker that found it */
+    int failed;
+    int workers;
+    bn_search_fn fn;
+    void *arg;
+    BN_GENCB *cb;               /* caller's callback */
+    SEARCH_WORKER w[SEARCH_MAX_THREADS];
+};
+
+static int prime_search_threads = 1;
+
+void BN_set_prime_search_threads(int n)
+{
+    if (n < 1)
+        n = 1;
+    if (n > SEARCH_MAX_THREADS)
+        n = SEARCH_MAX_THREADS;
+    prime_search_threads = n;
+}
+
+int BN_get_prime_search_threads(void)
+{
+    return prime_search_threads;
+}
+
+#ifdef SEARCH_THREADS
+# define search_lock(s)         pthread_mutex_lock(&(s)->lock)
+# define search_unlock(s)       pthread_mutex_unlock(&(s)->lock)
+#else
+# define search_lock(s)
+# define search_unlock(s)
+#endif
+
+static int search_cb(int a, int b, BN_GENCB *cb)
+{
+    SEARCH_WORKER *w = BN_GENCB_get_arg(cb);
+    BN_SEARCH *s = w->s;
+    int stop;
+
+    search_lock(s);
+    stop = s->failed || w->current >= s->best;
+    search_unlock(s);
+    if (stop) {
+        w->stopped = 1;
+        return 0;
+    }
+    if (w->worker == 0 && !BN_GENCB_call(s->cb, a, b)) {
+        search_lock(s);
+        s->failed = 1;
+        search_unlock(s);
+        return 0;
+    }
+    return 1;
+}
+
+int bn_search_next(BN_SEARCH *s, int worker, long *idx)
+{
+    SEARCH_WORKER *w = &s->w[worker];
+    int ret;
+
+    search_lock(s);
+    w->current = s->next;
+    ret = !s->failed && w->current < s->best;
+    if (ret)
+        s->next++;
+    search_unlock(s);
+    *idx = w->current;
+    return ret;
+}
+
+int bn_search_found(BN_SEARCH *s, int worker, long idx)
+{
+    int ret = 0;
+
+    search_lock(s);
+    if (idx < s->best) {
+        s->best = idx;
+        s->winner = worker;
+        ret = 1;
+    }
+    search_unlock(s);
+    return ret;
+}
+
+static void search_work(SEARCH_WORKER *w)
+{
+    BN_SEARCH *s = w->s;
+
+    if (!s->fn(s, w->worker, &w->cb, s->arg) && !w->stopped) {
+        search_lock(s);
+        s->failed = 1;
+        search_unlock(s);
+    }
+}
+
+#ifdef SEARCH_THREADS
+static void *search_thread(void *arg)
+{
+    search_work(arg);
+    ERR_remove_thread_state(NULL);
+    return NULL;
+}
+#endif
+
+long bn_search_run(int threads, bn_search_fn fn, void *arg, BN_GENCB *cb,
+                   int *winner)
+{
+    BN_SEARCH *s;
+    long ret;
+    int i;
+
+    if ((s = OPENSSL_malloc(sizeof(*s))) == NULL) {
+        BNerr(BN_F_BN_SEARCH_RUN, ERR_R_MALLOC_FAILURE);
+        return -2;
+    }
+    memset(s, 0, sizeof(*s));
+    s->best = LONG_MAX;
+    s->fn = fn;
+    s->arg = arg;
+    s->cb = cb;
+
+#ifdef SEARCH_THREADS
+    if (pthread_mutex_init(&s->lock, NULL) != 0) {
+        OPENSSL_free(s);
+        return -2;
+    }
+#else
+    threads = 1;
+#endif
+    /* Without locking callbacks RAND_bytes() is not thread safe */
+    if (CRYPTO_get_locking_callback() == NULL)
+        threads = 1;
+    if (threads > SEARCH_MAX_THREADS)
+        threads = SEARCH_MAX_THREADS;
+    s->workers = threads < 1 ? 1 : threads;
+
+    for (i = 0; i < s->workers; i++) {
+        s->w[i].s = s;
+        s->w[i].worker = i;
+        BN_GENCB_set(&s->w[i].cb, search_cb, &s->w[i]);
+    }
+#ifdef SEARCH_THREADS
+    /*
+     * Candidates are handed out on demand, so a thread that could not be
+     * started just leaves its share to the others.
+     */
+    for (i = 1; i < s->workers; i++)
+        if (pthread_create(&s->w[i].thread, NULL, search_thread,
+                           &s->w[i]) != 0)
+            break;
+    search_work(&s->w[0]);
+    while (--i > 0)
+        pthread_join(s->w[i].thread, NULL);
+    pthread_mutex_destroy(&s->lock);
+#else
+    search_work(&s->w[0]);
+#endif
+
+    if (s->failed)
+        ret = -2;
+    else if (s->best == LONG_MAX)
+        ret = -1;
+    else {
+        ret = s->best;
+        if (winner != NULL)
+            *winner = s->winner;
+    }
+    OPENSSL_free(s);
+    return ret;
+}
@@ -0,0 +1,257 @@
+/* crypto/bn/rsaz_3k4k.c */
+/* ====================================================================
+ * Copyright (c) 2015 The OpenSSL Project.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. All advertising materials mentioning features or use of this
+ *    software must display the following acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit. (http://www.openssl.org/)"
+ *
+ * 4. The names "OpenSSL Toolkit" and "OpenSSL Project" must not be used to
+ *    endorse or promote products derived from this software without
+ *    prior written permission. For written permission, please contact
+ *    openssl-core@openssl.org.
+ *
+ * 5. Products derived from this software may not be called "OpenSSL"
+ *    nor may "OpenSSL" appear in their names without prior written
+ *    permission of the OpenSSL Project.
+ *
+ * 6. Redistributions of any form whatsoever must retain the following
+ *    acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit (http://www.openssl.org/)"
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE OpenSSL PROJECT ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE OpenSSL PROJECT OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ====================================================================
+ */
+
+/*
+ * Modular exponentiation for 1536- and 2048-bit moduli, the CRT halves of
+ * RSA3072 and RSA4096, using the AVX512 IFMA kernels in asm/rsaz-3k4k.pl.
+ * See that file for the representation of numbers.
+ */
+
+#include <string.h>
+#include "cryptlib.h"
+#include "bn_lcl.h"
+#include "rsaz_exp.h"
+
+#define DIGIT_BITS      52
+#define MAX_WORDS       (2048 / BN_BITS2)   /* longest modulus */
+
+typedef void (*rsaz_amm_f) (BN_ULONG *res, const BN_ULONG *a,
+                            const BN_ULONG *b, const BN_ULONG *m,
+                            BN_ULONG k0);
+
+void rsaz_amm52x30_avx512(BN_ULONG *res, const BN_ULONG *a,
+                          const BN_ULONG *b, const BN_ULONG *m, BN_ULONG k0);
+void rsaz_amm52x40_avx512(BN_ULONG *res, const BN_ULONG *a,
+                          const BN_ULONG *b, const BN_ULONG *m, BN_ULONG k0);
+
+typedef struct {
+    int bits;                   /* modulus length */
+    int digits;                 /* N, with R = 2^(52 * N) */
+    int words;                  /* length of the arrays, with padding */
+    rsaz_amm_f amm;
+} RSAZ_KERNEL;
+
+static const RSAZ_KERNEL kernels[] = {
+    {1536, 30, 32, rsaz_amm52x30_avx512},
+    {2048, 40, 40, rsaz_amm52x40_avx512},
+};
+
+static const RSAZ_KERNEL *rsaz_3k4k_kernel(int bits)
+{
+    size_t i;
+
+    if (!rsaz_3k4k_eligible())
+        return NULL;
+    for (i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++)
+        if (kernels[i].bits == bits)
+            return &kernels[i];
+    return NULL;
+}
+
+/*
+ * Returns 1 if RSAZ_mod_exp_3k4k() supports |bits|-bit moduli on this
+ * processor.
+ */
+int RSAZ_3k4k_usable(int bits)
+{
+    return rsaz_3k4k_kernel(bits) != NULL;
+}
+
+/* Convert the |n|-word |in| to |k->words| 52-bit digits */
+static void to_radix(BN_ULONG *out, const RSAZ_KERNEL *k,
+                     const BN_ULONG *in, int n)
+{
+    BN_ULONG mask = ((BN_ULONG)1 << DIGIT_BITS) - 1, d;
+    int j, bit, w, s;
+
+    for (j = 0, bit = 0; j < k->words; j++, bit += DIGIT_BITS) {
+        w = bit / BN_BITS2;
+        s = bit % BN_BITS2;
+        d = w < n ? in[w] >> s : 0;
+        if (s > BN_BITS2 - DIGIT_BITS && w + 1 < n)
+            d |= in[w + 1] << (BN_BITS2 - s);
+        out[j] = d & mask;
+    }
+}
+
+/* The inverse of to_radix(). |in| must be smaller than 2^(64*n) */
+static void from_radix(BN_ULONG *out, int n, const RSAZ_KERNEL *k,
+                       const BN_ULONG *in)
+{
+    int j, bit, w, s;
+
+    memset(out, 0, n * sizeof(out[0]));
+    for (j = 0, bit = 0; j < k->digits; j++, bit += DIGIT_BITS) {
+        w = bit / BN_BITS2;
+        s = bit % BN_BITS2;
+        if (w >= n)
+            break;
+        out[w] |= in[j] << s;
+        if (s > BN_BITS2 - DIGIT_BITS && w + 1 < n)
+            out[w + 1] |= in[j] >> (BN_BITS2 - s);
+    }
+}
+
+/* |out| = 2^|bit| in the representation of |k| */
+static void set_bit(BN_ULONG *out, const RSAZ_KERNEL *k, int bit)
+{
+    memset(out, 0, k->words * sizeof(out[0]));
+    out[bit / DIGIT_BITS] = (BN_ULONG)1 << (bit % DIGIT_BITS);
+}
+
+/* The 5-bit window of the |n|-word |e| starting at bit |bit| */
+static BN_ULONG window5(const BN_ULONG *e, int n, int bit)
+{
+    int w = bit / BN_BITS2, s = bit % BN_BITS2;
+    BN_ULONG v = e[w] >> s;
+
+    if (s > BN_BITS2 - 5 && w + 1 < n)
+        v |= e[w + 1] << (BN_BITS2 - s);
+    return v & 31;
+}
+
+/*
+ * Copy entry |idx| of the 32-entry |table| to |out|, reading every entry
+ * so that the memory access pattern does not depend on |idx|.
+ */
+static void gather5(BN_ULONG *out, const BN_ULONG *table, int words,
+                    BN_ULONG idx)
+{
+    BN_ULONG mask;
+    int i, j;
+
+    memset(out, 0, words * sizeof(out[0]));
+    for (i = 0; i < 32; i++, table += words) {
+        mask = (BN_ULONG)i ^ idx;
+        mask = 0 - ((mask - 1) >> (BN_BITS2 - 1));
+        for (j = 0; j < words; j++)
+            out[j] |= table[j] & mask;
+    }
+}
+
+/*
+ * res = base^exponent mod m, where m is |bits| long, base < m, RR = 2^(2 *
+ * bits) mod m and k0 = -m^-1 mod 2^64, i.e. the values a BN_MONT_CTX holds.
+ * All numbers are |bits| / 64 words. |bits| must be one for which
+ * RSAZ_3k4k_usable() returns 1. The exponentiation uses a fixed 5-bit
+ * window and a gather that reads the whole table, so its timing and memory
+ * access pattern do not depend on the exponent. Returns 0 if memory could
+ * not be allocated.
+ */
+int RSAZ_mod_exp_3k4k(BN_ULONG *res, const BN_ULONG *base,
+                      const BN_ULONG *exponent, const BN_ULONG *m,
+                      const BN_ULONG *RR, BN_ULONG k0, int bits)
+{
+    const RSAZ_KERNEL *k = rsaz_3k4k_kernel(bits);
+    int n = bits / BN_BITS2, words, i, bit, len;
+    unsigned char *storage;
+    BN_ULONG *table, *mr, *a, *acc, *R2, *tmp;
+    BN_ULONG out[MAX_WORDS], sub[MAX_WORDS], mask;
+
+    OPENSSL_assert(k != NULL && n <= MAX_WORDS);
+    words = k->words;
+    k0 &= ((BN_ULONG)1 << DIGIT_BITS) - 1;
+
+    len = sizeof(BN_ULONG) * words * (32 + 5) + 64;
+    storage = OPENSSL_malloc(len);
+    if (storage == NULL)
+        return 0;
+    table = (BN_ULONG *)(storage + (64 - ((size_t)storage % 64)));
+    mr = table + 32 * words;
+    a = mr + words;
+    acc = a + words;
+    R2 = acc + words;
+    tmp = R2 + words;
+
+    to_radix(mr, k, m, n);
+    to_radix(a, k, base, n);
+    to_radix(R2, k, RR, n);
+
+    /*
+     * With R = 2^(52 * digits), R2 = RR^2 / R * 2^bit / R = R^2, for bit =
+     * 4 * log2(R) - 4 * bits.
+     */
+    k->amm(R2, R2, R2, mr, k0);
+    set_bit(tmp, k, 4 * DIGIT_BITS * k->digits - 4 * bits);
+    k->amm(R2, R2, tmp, mr, k0);
+
+    /* table[0] = 1, table[1] = a, table[i] = a^i, all in Montgomery form */
+    set_bit(tmp, k, 0);
+    k->amm(table, R2, tmp, mr, k0);
+    k->amm(table + words, a, R2, mr, k0);
+    for (i = 2; i < 32; i++)
+        k->amm(table + i * words, table + (i - 1) * words, table + words,
+               mr, k0);
+
+    bit = (bits - 1) / 5 * 5;
+    gather5(acc, table, words, window5(exponent, n, bit));
+    for (bit -= 5; bit >= 0; bit -= 5) {
+        for (i = 0; i < 5; i++)
+            k->amm(acc, acc, acc, mr, k0);
+        gather5(tmp, table, words, window5(exponent, n, bit));
+        k->amm(acc, acc, tmp, mr, k0);
+    }
+
+    /* Convert out of Montgomery form, which leaves acc <= m */
+    set_bit(tmp, k, 0);
+    k->amm(acc, acc, tmp, mr, k0);
+
+    from_radix(out, n, k, acc);
+    /* acc == m is only possible if the result is 0 */
+    mask = bn_sub_words(sub, out, m, n) - 1;
+    for (i = 0; i < n; i++)
+        res[i] = (sub[i] & mask) | (out[i] & ~mask);
+
+    OPENSSL_cleanse(storage, len);
+    OPENSSL_cleanse(out, sizeof(out));
+    OPENSSL_cleanse(sub, sizeof(sub));
+    OPENSSL_free(storage);
+    return 1;
+}
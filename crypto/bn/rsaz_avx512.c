@@ -0,0 +1,202 @@
+/* crypto/bn/rsaz_avx512.c */
+/* ====================================================================
+ * Copyright (c) 2015 The OpenSSL Project.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. All advertising materials mentioning features or use of this
+ *    software must display the following acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit. (http://www.openssl.org/)"
+ *
+ * 4. The names "OpenSSL Toolkit" and "OpenSSL Project" must not be used to
+ *    endorse or promote products derived from this software without
+ *    prior written permission. For written permission, please contact
+ *    openssl-core@openssl.org.
+ *
+ * 5. Products derived from this software may not be called "OpenSSL"
+ *    nor may "OpenSSL" appear in their names without prior written
+ *    permission of the OpenSSL Project.
+ *
+ * 6. Redistributions of any form whatsoever must retain the following
+ *    acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit (http://www.openssl.org/)"
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE OpenSSL PROJECT ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE OpenSSL PROJECT OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ====================================================================
+ */
+
+/*
+ * Eight-lane 1024-bit modular exponentiation using the AVX512 IFMA
+ * kernels in asm/rsaz-avx512.pl. See that file for the representation of
+ * numbers.
+ */
+
+#include <string.h>
+#include "cryptlib.h"
+#include "bn_lcl.h"
+#include "rsaz_exp.h"
+
+#define DIGITS          20      /* 52-bit digits per 1024-bit number */
+#define LANES           8
+#define DIGIT_MASK      (((BN_ULONG)1 << 52) - 1)
+#define NUM_WORDS       (DIGITS * LANES)
+
+void rsaz_amm52x20_x8(BN_ULONG *res, const BN_ULONG *a, const BN_ULONG *b,
+                      const BN_ULONG *m, const BN_ULONG k0[LANES]);
+void rsaz_gather52x20_x8(BN_ULONG *res, const BN_ULONG *tbl,
+                         const BN_ULONG idx[LANES]);
+
+/* Store the 1024-bit |in| as lane |lane| of |out| in radix 2^52 */
+static void to_radix52(BN_ULONG *out, const BN_ULONG in[16], int lane)
+{
+    int j, bit, w, s;
+    BN_ULONG d;
+
+    for (j = 0, bit = 0; j < DIGITS; j++, bit += 52) {
+        w = bit / 64;
+        s = bit % 64;
+        d = in[w] >> s;
+        if (s > 64 - 52 && w + 1 < 16)
+            d |= in[w + 1] << (64 - s);
+        out[LANES * j + lane] = d & DIGIT_MASK;
+    }
+}
+
+/* The inverse of to_radix52(). |in| must be normalised and below 2^1024 */
+static void from_radix52(BN_ULONG out[16], const BN_ULONG *in, int lane)
+{
+    int j, bit, w, s;
+    BN_ULONG d;
+
+    memset(out, 0, 16 * sizeof(out[0]));
+    for (j = 0, bit = 0; j < DIGITS; j++, bit += 52) {
+        w = bit / 64;
+        s = bit % 64;
+        d = in[LANES * j + lane];
+        out[w] |= d << s;
+        if (s > 64 - 52 && w + 1 < 16)
+            out[w + 1] |= d >> (64 - s);
+    }
+}
+
+/* The 5-bit window of |e| starting at bit |bit| */
+static BN_ULONG window5(const BN_ULONG e[16], int bit)
+{
+    int w = bit / 64, s = bit % 64;
+    BN_ULONG v = e[w] >> s;
+
+    if (s > 64 - 5 && w + 1 < 16)
+        v |= e[w + 1] << (64 - s);
+    return v & 31;
+}
+
+/*
+ * res[i] = base[i]^exponent[i] mod m[i] for i = 0..7, where every m[i] is
+ * 1024 bits long, base[i] < m[i], RR[i] = 2^2048 mod m[i] and k0[i] =
+ * -m[i]^-1 mod 2^64, i.e. the values a BN_MONT_CTX holds. All numbers are
+ * 16 words. The exponentiation uses a fixed 5-bit window and a gather that
+ * reads the whole table, so its timing and memory access pattern do not
+ * depend on the exponents. Returns 0 if memory could not be allocated.
+ */
+int RSAZ_1024_mod_exp_avx512_x8(BN_ULONG *res[8], const BN_ULONG *base[8],
+                                const BN_ULONG *exponent[8],
+                                const BN_ULONG *m[8], const BN_ULONG *RR[8],
+                                const BN_ULONG k0[8])
+{
+    unsigned char *storage;
+    BN_ULONG *table, *m52, *a, *acc, *R2, *tmp;
+    BN_ULONG k0_52[LANES], idx[LANES], out[16], sub[16], mask;
+    int i, j, bit;
+
+    storage = OPENSSL_malloc(sizeof(BN_ULONG) * NUM_WORDS * (32 + 5) + 64);
+    if (storage == NULL)
+        return 0;
+    table = (BN_ULONG *)(storage + (64 - ((size_t)storage % 64)));
+    m52 = table + 32 * NUM_WORDS;
+    a = m52 + NUM_WORDS;
+    acc = a + NUM_WORDS;
+    R2 = acc + NUM_WORDS;
+    tmp = R2 + NUM_WORDS;
+
+    for (i = 0; i < LANES; i++) {
+        to_radix52(m52, m[i], i);
+        to_radix52(a, base[i], i);
+        to_radix52(R2, RR[i], i);
+        k0_52[i] = k0[i] & DIGIT_MASK;
+    }
+
+    /* R2 = (2^2048)^2 / 2^1040 * 2^64 / 2^1040 = 2^2080 = (2^1040)^2 */
+    rsaz_amm52x20_x8(R2, R2, R2, m52, k0_52);
+    memset(tmp, 0, sizeof(BN_ULONG) * NUM_WORDS);
+    for (i = 0; i < LANES; i++)
+        tmp[LANES + i] = (BN_ULONG)1 << (64 - 52);
+    rsaz_amm52x20_x8(R2, R2, tmp, m52, k0_52);
+
+    /* table[0] = 1, table[1] = a, table[i] = a^i, all in Montgomery form */
+    memset(tmp, 0, sizeof(BN_ULONG) * NUM_WORDS);
+    for (i = 0; i < LANES; i++)
+        tmp[i] = 1;
+    rsaz_amm52x20_x8(table, R2, tmp, m52, k0_52);
+    rsaz_amm52x20_x8(table + NUM_WORDS, a, R2, m52, k0_52);
+    for (j = 2; j < 32; j++)
+        rsaz_amm52x20_x8(table + j * NUM_WORDS, table + (j - 1) * NUM_WORDS,
+                         table + NUM_WORDS, m52, k0_52);
+
+    /* 1020 is the highest multiple of 5 below 1024 */
+    for (bit = 1020; bit >= 0; bit -= 5) {
+        for (i = 0; i < LANES; i++)
+            idx[i] = window5(exponent[i], bit);
+        if (bit == 1020) {
+            rsaz_gather52x20_x8(acc, table, idx);
+            continue;
+        }
+        for (j = 0; j < 5; j++)
+            rsaz_amm52x20_x8(acc, acc, acc, m52, k0_52);
+        rsaz_gather52x20_x8(tmp, table, idx);
+        rsaz_amm52x20_x8(acc, acc, tmp, m52, k0_52);
+    }
+
+    /* Convert out of Montgomery form, which leaves acc <= m */
+    memset(tmp, 0, sizeof(BN_ULONG) * NUM_WORDS);
+    for (i = 0; i < LANES; i++)
+        tmp[i] = 1;
+    rsaz_amm52x20_x8(acc, acc, tmp, m52, k0_52);
+
+    for (i = 0; i < LANES; i++) {
+        from_radix52(out, acc, i);
+        /* acc == m is only possible if the result is 0 */
+        mask = bn_sub_words(sub, out, m[i], 16) - 1;
+        for (j = 0; j < 16; j++)
+            res[i][j] = (sub[j] & mask) | (out[j] & ~mask);
+    }
+
+    OPENSSL_cleanse(storage, sizeof(BN_ULONG) * NUM_WORDS * (32 + 5) + 64);
+    OPENSSL_cleanse(idx, sizeof(idx));
+    OPENSSL_cleanse(out, sizeof(out));
+    OPENSSL_cleanse(sub, sizeof(sub));
+    OPENSSL_free(storage);
+    return 1;
+}
@@ -44,4 +44,16 @@ void RSAZ_512_mod_exp(BN_ULONG result[8],
                       const BN_ULONG base_norm[8], const BN_ULONG exponent[8],
                       const BN_ULONG m_norm[8], BN_ULONG k0,
                       const BN_ULONG RR[8]);
+
+int RSAZ_1024_mod_exp_avx512_x8(BN_ULONG *res[8], const BN_ULONG *base[8],
+                                const BN_ULONG *exponent[8],
+                                const BN_ULONG *m[8], const BN_ULONG *RR[8],
+                                const BN_ULONG k0[8]);
+int rsaz_avx512ifma_eligible();
+
+int RSAZ_mod_exp_3k4k(BN_ULONG *res, const BN_ULONG *base,
+                      const BN_ULONG *exponent, const BN_ULONG *m,
+                      const BN_ULONG *RR, BN_ULONG k0, int bits);
+int RSAZ_3k4k_usable(int bits);
+int rsaz_3k4k_eligible(void);
 #endif
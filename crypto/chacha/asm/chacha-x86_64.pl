@@ -0,0 +1,447 @@
+#!/usr/bin/env perl
+
+# ====================================================================
+# This module is part of the OpenSSL project. It is licensed under the
+# OpenSSL license; see the LICENSE file in the top-level directory.
+# ====================================================================
+
+# November 2015.
+#
+# ChaCha20 for x86_64, with three code paths selected at run time:
+#
+# - SSE2, available on every x86_64 processor, processes one block at
+#   a time with the four rows of the state in xmm registers; the
+#   rotations are performed with shifts, except for the rotation by 16
+#   which is a pair of word shuffles;
+# - SSSE3 is the same, but rotates by 16 and 8 with pshufb;
+# - AVX2 processes four blocks at a time, two per set of ymm
+#   registers, one block in each 128-bit lane; inputs shorter than
+#   four blocks, and the tail of longer ones, are left to SSSE3.
+#
+# The "columns" and "diagonals" of ChaCha are computed with the same
+# code by rotating rows b, c and d with pshufd between the halves of a
+# double round.
+#
+# Performance in cycles per byte, for 8KB input:
+#
+#			C(*)	SSE2	SSSE3	AVX2
+# Skylake		6.0	3.1	2.3	1.2
+#
+# (*)	gcc 4.9 -O3
+
+$flavour = shift;
+$output  = shift;
+if ($flavour =~ /\./) { $output = $flavour; undef $flavour; }
+
+$win64=0; $win64=1 if ($flavour =~ /[nm]asm|mingw64/ || $output =~ /\.asm$/);
+
+$0 =~ m/(.*[\/\\])[^\/\\]+$/; $dir=$1;
+( $xlate="${dir}x86_64-xlate.pl" and -f $xlate ) or
+( $xlate="${dir}../../perlasm/x86_64-xlate.pl" and -f $xlate) or
+die "can't locate x86_64-xlate.pl";
+
+if (`$ENV{CC} -Wa,-v -c -o /dev/null -x assembler /dev/null 2>&1`
+		=~ /GNU assembler version ([2-9]\.[0-9]+)/) {
+	$avx = ($1>=2.19) + ($1>=2.22);
+}
+
+if (!$avx && $win64 && ($flavour =~ /nasm/ || $ENV{ASM} =~ /nasm/) &&
+	    `nasm -v 2>&1` =~ /NASM version ([2-9]\.[0-9]+)/) {
+	$avx = ($1>=2.09) + ($1>=2.10);
+}
+
+if (!$avx && $win64 && ($flavour =~ /masm/ || $ENV{ASM} =~ /ml64/) &&
+	    `ml64 2>&1` =~ /Version ([0-9]+)\./) {
+	$avx = ($1>=10) + ($1>=11);
+}
+
+if (!$avx && `$ENV{CC} -v 2>&1` =~ /(^clang version|based on LLVM) ([3-9]\.[0-9]+)/) {
+	$avx = ($2>=3.0) + ($2>3.0);
+}
+
+open OUT,"| \"$^X\" $xlate $flavour $output";
+*STDOUT=*OUT;
+
+# void ChaCha20_ctr32(unsigned char *out, const unsigned char *inp,
+#                     size_t len, const unsigned int key[8],
+#                     const unsigned int counter[4]);
+my ($out,$inp,$len,$key,$counter)=("%rdi","%rsi","%rdx","%rcx","%r8");
+
+# Frame: 64 bytes for the last partial block or the counter passed on
+# to the SSSE3 code, then, on Win64, the non-volatile xmm6-xmm15.
+my $frame = 64+8+($win64?160:0);
+
+sub prologue {
+my $code = "\tsub\t\$$frame,%rsp\n";
+    if ($win64) {
+	for (my $i=6; $i<16; $i++) {
+	    $code .= "\tmovaps\t%xmm$i,`64+16*($i-6)`(%rsp)\n";
+	}
+    }
+    $code;
+}
+
+sub epilogue {
+my $code = "";
+    if ($win64) {
+	for (my $i=6; $i<16; $i++) {
+	    $code .= "\tmovaps\t`64+16*($i-6)`(%rsp),%xmm$i\n";
+	}
+    }
+    $code . "\tadd\t\$$frame,%rsp\n";
+}
+
+$code.=<<___;
+.text
+
+.extern	OPENSSL_ia32cap_P
+
+.align	64
+.Lrot16:
+.byte	0x2,0x3,0x0,0x1, 0x6,0x7,0x4,0x5, 0xa,0xb,0x8,0x9, 0xe,0xf,0xc,0xd
+.byte	0x2,0x3,0x0,0x1, 0x6,0x7,0x4,0x5, 0xa,0xb,0x8,0x9, 0xe,0xf,0xc,0xd
+.Lrot24:
+.byte	0x3,0x0,0x1,0x2, 0x7,0x4,0x5,0x6, 0xb,0x8,0x9,0xa, 0xf,0xc,0xd,0xe
+.byte	0x3,0x0,0x1,0x2, 0x7,0x4,0x5,0x6, 0xb,0x8,0x9,0xa, 0xf,0xc,0xd,0xe
+.Lone:
+.long	1,0,0,0
+.Linc:
+.long	0,0,0,0, 1,0,0,0
+.Ltwo:
+.long	2,0,0,0, 2,0,0,0
+.Lfour:
+.long	4,0,0,0, 4,0,0,0
+.Lsigma:
+.asciz	"expand 32-byte k"
+.asciz	"ChaCha20 for x86_64, CRYPTOGAMS by <appro\@openssl.org>"
+
+.globl	ChaCha20_ctr32
+.type	ChaCha20_ctr32,\@function,5
+.align	64
+ChaCha20_ctr32:
+	test	$len,$len
+	jz	.Lno_data
+	mov	OPENSSL_ia32cap_P+4(%rip),%r10
+___
+$code.=<<___	if ($avx>1);
+	bt	\$`32+5`,%r10			# AVX2?
+	jnc	.Lno_avx2
+	cmp	\$256,$len
+	jae	.LChaCha20_avx2
+.Lno_avx2:
+___
+$code.=<<___;
+	test	\$`1<<9`,%r10d			# SSSE3?
+	jnz	.LChaCha20_ssse3
+	jmp	.LChaCha20_sse2
+.Lno_data:
+	ret
+.size	ChaCha20_ctr32,.-ChaCha20_ctr32
+___
+
+########################################################################
+# One block at a time, rows a, b, c and d of the state in xmm0-xmm3.
+
+{
+my ($a,$b,$c,$d,$t)=map("%xmm$_",(0..4));
+my ($kb,$kc,$kd)=map("%xmm$_",(5..7));
+my ($r16,$r24)=map("%xmm$_",(8..9));
+
+sub ROUND {		# a quarter round on each of the four columns
+my $ssse3 = shift;
+my $code = <<___;
+	paddd	$b,$a
+	pxor	$a,$d
+___
+$code.= $ssse3 ? <<___ : <<___;
+	pshufb	$r16,$d
+___
+	pshuflw	\$0xb1,$d,$d
+	pshufhw	\$0xb1,$d,$d
+___
+$code.= <<___;
+	paddd	$d,$c
+	pxor	$c,$b
+	movdqa	$b,$t
+	psrld	\$20,$t
+	pslld	\$12,$b
+	por	$t,$b
+	paddd	$b,$a
+	pxor	$a,$d
+___
+$code.= $ssse3 ? <<___ : <<___;
+	pshufb	$r24,$d
+___
+	movdqa	$d,$t
+	psrld	\$24,$t
+	pslld	\$8,$d
+	por	$t,$d
+___
+$code.= <<___;
+	paddd	$d,$c
+	pxor	$c,$b
+	movdqa	$b,$t
+	psrld	\$25,$t
+	pslld	\$7,$b
+	por	$t,$b
+___
+}
+
+foreach my $ssse3 (1, 0) {
+my $sfx = $ssse3 ? "ssse3" : "sse2";
+
+$code.=<<___;
+.type	ChaCha20_$sfx,\@function,5
+.align	32
+ChaCha20_$sfx:
+.LChaCha20_$sfx:
+___
+$code.=&prologue();
+$code.=<<___;
+	movdqu	($key),$kb
+	movdqu	16($key),$kc
+	movdqu	($counter),$kd
+___
+$code.=<<___	if ($ssse3);
+	movdqa	.Lrot16(%rip),$r16
+	movdqa	.Lrot24(%rip),$r24
+___
+$code.=<<___;
+	jmp	.Loop_outer_$sfx
+
+.align	32
+.Loop_outer_$sfx:
+	movdqa	.Lsigma(%rip),$a
+	movdqa	$kb,$b
+	movdqa	$kc,$c
+	movdqa	$kd,$d
+	mov	\$10,%r9
+	jmp	.Loop_$sfx
+
+.align	32
+.Loop_$sfx:
+___
+$code.=&ROUND($ssse3);
+$code.=<<___;
+	pshufd	\$0x39,$b,$b		# move to the diagonals
+	pshufd	\$0x4e,$c,$c
+	pshufd	\$0x93,$d,$d
+___
+$code.=&ROUND($ssse3);
+$code.=<<___;
+	pshufd	\$0x93,$b,$b		# and back to the columns
+	pshufd	\$0x4e,$c,$c
+	pshufd	\$0x39,$d,$d
+	dec	%r9
+	jnz	.Loop_$sfx
+
+	paddd	.Lsigma(%rip),$a
+	paddd	$kb,$b
+	paddd	$kc,$c
+	paddd	$kd,$d
+
+	cmp	\$64,$len
+	jb	.Ltail_$sfx
+
+	movdqu	0x00($inp),$t
+	pxor	$t,$a
+	movdqu	0x10($inp),$t
+	pxor	$t,$b
+	movdqu	0x20($inp),$t
+	pxor	$t,$c
+	movdqu	0x30($inp),$t
+	pxor	$t,$d
+	lea	0x40($inp),$inp
+	movdqu	$a,0x00($out)
+	movdqu	$b,0x10($out)
+	movdqu	$c,0x20($out)
+	movdqu	$d,0x30($out)
+	lea	0x40($out),$out
+
+	paddd	.Lone(%rip),$kd
+	sub	\$64,$len
+	jnz	.Loop_outer_$sfx
+	jmp	.Ldone_$sfx
+
+.align	16
+.Ltail_$sfx:
+	movdqa	$a,0x00(%rsp)
+	movdqa	$b,0x10(%rsp)
+	movdqa	$c,0x20(%rsp)
+	movdqa	$d,0x30(%rsp)
+	xor	%r9,%r9
+
+.Loop_tail_$sfx:
+	movzb	($inp,%r9),%eax
+	movzb	(%rsp,%r9),%r10d
+	lea	1(%r9),%r9
+	xor	%r10d,%eax
+	mov	%al,-1($out,%r9)
+	dec	$len
+	jnz	.Loop_tail_$sfx
+
+.Ldone_$sfx:
+___
+$code.=&epilogue();
+$code.=<<___;
+	ret
+.size	ChaCha20_$sfx,.-ChaCha20_$sfx
+___
+}
+}
+
+########################################################################
+# Four blocks at a time: two sets of rows, a0-d0 and a1-d1, each with
+# one block in the low and one in the high 128-bit lane.
+
+if ($avx>1) {
+my @x0=map("%ymm$_",(0..3));
+my @x1=map("%ymm$_",(4..7));
+my ($t0,$t1)=map("%ymm$_",(8..9));
+my ($kb,$kc,$kd0,$kd1)=map("%ymm$_",(10..13));
+my ($r16,$r24)=map("%ymm$_",(14..15));
+my $kd0x="%xmm12";
+
+sub AVX2_ROUND {	# returns the instructions of a column quarter round
+my ($a,$b,$c,$d,$t)=@_;
+(
+	"vpaddd	$b,$a,$a",
+	"vpxor	$a,$d,$d",
+	"vpshufb	$r16,$d,$d",
+	"vpaddd	$d,$c,$c",
+	"vpxor	$c,$b,$b",
+	"vpsrld	\$20,$b,$t",
+	"vpslld	\$12,$b,$b",
+	"vpor	$t,$b,$b",
+	"vpaddd	$b,$a,$a",
+	"vpxor	$a,$d,$d",
+	"vpshufb	$r24,$d,$d",
+	"vpaddd	$d,$c,$c",
+	"vpxor	$c,$b,$b",
+	"vpsrld	\$25,$b,$t",
+	"vpslld	\$7,$b,$b",
+	"vpor	$t,$b,$b"
+)
+}
+
+sub AVX2_SHUFFLE {
+my ($b,$c,$d,$ib,$id)=@_;
+(
+	"vpshufd	\$$ib,$b,$b",
+	"vpshufd	\$0x4e,$c,$c",
+	"vpshufd	\$$id,$d,$d"
+)
+}
+
+# interleave the instructions of the two sets
+sub zip {
+my ($p,$q)=@_;
+my $code="";
+    while (@$p || @$q) {
+	$code.="\t".shift(@$p)."\n" if (@$p);
+	$code.="\t".shift(@$q)."\n" if (@$q);
+    }
+    $code;
+}
+
+$code.=<<___;
+.type	ChaCha20_avx2,\@function,5
+.align	32
+ChaCha20_avx2:
+.LChaCha20_avx2:
+___
+$code.=&prologue();
+$code.=<<___;
+	vbroadcasti128	($key),$kb
+	vbroadcasti128	16($key),$kc
+	vbroadcasti128	($counter),$kd0
+	vpaddd		.Linc(%rip),$kd0,$kd0	# blocks n and n+1
+	vpaddd		.Ltwo(%rip),$kd0,$kd1	# blocks n+2 and n+3
+	vmovdqa		.Lrot16(%rip),$r16
+	vmovdqa		.Lrot24(%rip),$r24
+	jmp		.Loop_outer_avx2
+
+.align	32
+.Loop_outer_avx2:
+	vbroadcasti128	.Lsigma(%rip),$x0[0]
+	vmovdqa		$kb,$x0[1]
+	vmovdqa		$kc,$x0[2]
+	vmovdqa		$kd0,$x0[3]
+	vmovdqa		$x0[0],$x1[0]
+	vmovdqa		$kb,$x1[1]
+	vmovdqa		$kc,$x1[2]
+	vmovdqa		$kd1,$x1[3]
+	mov		\$10,%r9
+	jmp		.Loop_avx2
+
+.align	32
+.Loop_avx2:
+___
+$code.=&zip([&AVX2_ROUND(@x0,$t0)],[&AVX2_ROUND(@x1,$t1)]);
+$code.=&zip([&AVX2_SHUFFLE(@x0[1..3],"0x39","0x93")],
+	    [&AVX2_SHUFFLE(@x1[1..3],"0x39","0x93")]);
+$code.=&zip([&AVX2_ROUND(@x0,$t0)],[&AVX2_ROUND(@x1,$t1)]);
+$code.=&zip([&AVX2_SHUFFLE(@x0[1..3],"0x93","0x39")],
+	    [&AVX2_SHUFFLE(@x1[1..3],"0x93","0x39")]);
+$code.=<<___;
+	dec		%r9
+	jnz		.Loop_avx2
+
+	vbroadcasti128	.Lsigma(%rip),$t0
+	vpaddd		$t0,$x0[0],$x0[0]
+	vpaddd		$kb,$x0[1],$x0[1]
+	vpaddd		$kc,$x0[2],$x0[2]
+	vpaddd		$kd0,$x0[3],$x0[3]
+	vpaddd		$t0,$x1[0],$x1[0]
+	vpaddd		$kb,$x1[1],$x1[1]
+	vpaddd		$kc,$x1[2],$x1[2]
+	vpaddd		$kd1,$x1[3],$x1[3]
+___
+# gather the rows of each block from the lanes
+for (my $i=0; $i<2; $i++) {
+my @x = $i ? @x1 : @x0;
+my $o = 128*$i;
+$code.=<<___;
+	vperm2i128	\$0x20,$x[1],$x[0],$t0
+	vperm2i128	\$0x20,$x[3],$x[2],$t1
+	vpxor		`$o+0x00`($inp),$t0,$t0
+	vpxor		`$o+0x20`($inp),$t1,$t1
+	vmovdqu		$t0,`$o+0x00`($out)
+	vmovdqu		$t1,`$o+0x20`($out)
+	vperm2i128	\$0x31,$x[1],$x[0],$t0
+	vperm2i128	\$0x31,$x[3],$x[2],$t1
+	vpxor		`$o+0x40`($inp),$t0,$t0
+	vpxor		`$o+0x60`($inp),$t1,$t1
+	vmovdqu		$t0,`$o+0x40`($out)
+	vmovdqu		$t1,`$o+0x60`($out)
+___
+}
+$code.=<<___;
+	lea		0x100($inp),$inp
+	lea		0x100($out),$out
+	vpaddd		.Lfour(%rip),$kd0,$kd0
+	vpaddd		.Lfour(%rip),$kd1,$kd1
+	sub		\$256,$len
+	cmp		\$256,$len
+	jae		.Loop_outer_avx2
+
+	vzeroupper
+	test		$len,$len
+	jz		.Ldone_avx2
+
+	movdqa		$kd0x,(%rsp)	# counter of the next block
+	mov		%rsp,$counter
+	call		.LChaCha20_ssse3
+
+.Ldone_avx2:
+___
+$code.=&epilogue();
+$code.=<<___;
+	ret
+.size	ChaCha20_avx2,.-ChaCha20_avx2
+___
+}
+
+$code =~ s/\`([^\`]*)\`/eval $1/gem;
+print $code;
+close STDOUT;
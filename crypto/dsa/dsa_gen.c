@@ -73,6 +73,7 @@
 #include <openssl/sha.h>
 
 #include "dsa_locl.h"
+#include "internal/bn_int.h"
 
 int DSA_generate_parameters_ex(DSA *ret, int bits,
                                const unsigned char *seed_in, int seed_len,
@@ -100,6 +101,174 @@ int DSA_generate_parameters_ex(DSA *ret, int bits,
     }
 }
 
+/*
+ * Steps 7 to 14 of the FIPS 186 search for p, for a given q. Candidates are
+ * numbered by the counter, and as the lowest counter that gives a prime is
+ * the result, running the search on several threads does not change it.
+ */
+typedef struct {
+    const EVP_MD *evpmd;
+    const unsigned char *seed;  /* "SEED + offset - 1" for counter 0 */
+    size_t seed_len;
+    int n;                      /* hashes per candidate, less one */
+    int blen;                   /* bytes used of each hash */
+    size_t L;
+    const BIGNUM *q, *test;     /* test = 2^(L - 1) */
+    int limit;                  /* number of counters to try */
+} DSA_P_SEARCH;
+
+/*
+ * Compute the candidate p for |counter| using |buf|, which is seed_len bytes
+ * long. Returns 1 if p passes step 10, 0 if not and -1 on error.
+ */
+static int dsa_p_candidate(BIGNUM *p, unsigned char *buf,
+                           const DSA_P_SEARCH *ps, long counter, BN_CTX *ctx)
+{
+    unsigned char md[EVP_MAX_MD_SIZE];
+    BIGNUM *r0, *W, *X, *c;
+    unsigned long add;
+    int i, k, ret = -1;
+
+    BN_CTX_start(ctx);
+    r0 = BN_CTX_get(ctx);
+    W = BN_CTX_get(ctx);
+    X = BN_CTX_get(ctx);
+    c = BN_CTX_get(ctx);
+    if (c == NULL)
+        goto err;
+
+    /* "offset = offset + counter * (n + 1)" */
+    memcpy(buf, ps->seed, ps->seed_len);
+    add = (unsigned long)counter * (ps->n + 1);
+    for (i = ps->seed_len - 1; i >= 0 && add != 0; i--) {
+        add += buf[i];
+        buf[i] = (unsigned char)add;
+        add >>= 8;
+    }
+
+    /* step 7 */
+    BN_zero(W);
+    for (k = 0; k <= ps->n; k++) {
+        /*
+         * obtain "SEED + offset + k" by incrementing:
+         */
+        for (i = ps->seed_len - 1; i >= 0; i--) {
+            buf[i]++;
+            if (buf[i] != 0)
+                break;
+        }
+
+        if (!EVP_Digest(buf, ps->seed_len, md, NULL, ps->evpmd, NULL))
+            goto err;
+
+        /* step 8 */
+        if (!BN_bin2bn(md, ps->blen, r0))
+            goto err;
+        if (!BN_lshift(r0, r0, (ps->blen << 3) * k))
+            goto err;
+        if (!BN_add(W, W, r0))
+            goto err;
+    }
+
+    /* more of step 8 */
+    if (!BN_mask_bits(W, ps->L - 1))
+        goto err;
+    if (!BN_copy(X, W))
+        goto err;
+    if (!BN_add(X, X, ps->test))
+        goto err;
+
+    /* step 9 */
+    if (!BN_lshift1(r0, ps->q))
+        goto err;
+    if (!BN_mod(c, X, r0, ctx))
+        goto err;
+    if (!BN_sub(r0, c, BN_value_one()))
+        goto err;
+    if (!BN_sub(p, X, r0))
+        goto err;
+
+    /* step 10 */
+    ret = BN_cmp(p, ps->test) >= 0;
+ err:
+    BN_CTX_end(ctx);
+    return ret;
+}
+
+static int dsa_p_worker(BN_SEARCH *s, int worker, BN_GENCB *cb, void *arg)
+{
+    const DSA_P_SEARCH *ps = arg;
+    unsigned char *buf;
+    BN_CTX *ctx;
+    BIGNUM *p;
+    long counter;
+    int r, ok = 0;
+
+    buf = OPENSSL_malloc(ps->seed_len);
+    ctx = BN_CTX_new();
+    if (buf == NULL || ctx == NULL)
+        goto err;
+    BN_CTX_start(ctx);
+    if ((p = BN_CTX_get(ctx)) == NULL)
+        goto err;
+
+    while (bn_search_next(s, worker, &counter) && counter < ps->limit) {
+        if ((counter != 0) && !BN_GENCB_call(cb, 0, counter))
+            goto err;
+
+        r = dsa_p_candidate(p, buf, ps, counter, ctx);
+        if (r < 0)
+            goto err;
+        if (r > 0) {
+            /* step 11 */
+            r = BN_is_prime_fasttest_ex(p, DSS_prime_checks, ctx, 1, cb);
+            if (r < 0)
+                goto err;
+            if (r > 0)
+                bn_search_found(s, worker, counter);
+        }
+        /* steps 13 and 14 */
+    }
+    ok = 1;
+ err:
+    if (ctx != NULL) {
+        BN_CTX_end(ctx);
+        BN_CTX_free(ctx);
+    }
+    OPENSSL_free(buf);
+    return ok;
+}
+
+/*
+ * Search for p on BN_get_prime_search_threads() threads. Returns 1 and sets
+ * |p| and |*counter| if one was found, 0 if the counter limit was reached
+ * and -1 on error.
+ */
+static int dsa_p_search(BIGNUM *p, int *counter, const DSA_P_SEARCH *ps,
+                        BN_GENCB *cb, BN_CTX *ctx)
+{
+    unsigned char *buf;
+    long c;
+    int ret = -1;
+
+    c = bn_search_run(BN_get_prime_search_threads(), dsa_p_worker,
+                      (void *)ps, cb, NULL);
+    if (c == -1)
+        return 0;
+    if (c < 0)
+        return -1;
+
+    /* Recompute the winning candidate, it is only a few hashes */
+    if ((buf = OPENSSL_malloc(ps->seed_len)) == NULL)
+        return -1;
+    if (dsa_p_candidate(p, buf, ps, c, ctx) > 0) {
+        *counter = (int)c;
+        ret = 1;
+    }
+    OPENSSL_free(buf);
+    return ret;
+}
+
 int dsa_builtin_paramgen(DSA *ret, size_t bits, size_t qbits,
                          const EVP_MD *evpmd, const unsigned char *seed_in,
                          size_t seed_len, unsigned char *seed_out,
@@ -109,10 +278,11 @@ int dsa_builtin_paramgen(DSA *ret, size_t bits, size_t qbits,
     unsigned char seed[SHA256_DIGEST_LENGTH];
     unsigned char md[SHA256_DIGEST_LENGTH];
     unsigned char buf[SHA256_DIGEST_LENGTH], buf2[SHA256_DIGEST_LENGTH];
-    BIGNUM *r0, *W, *X, *c, *test;
+    BIGNUM *r0, *test;
     BIGNUM *g = NULL, *q = NULL, *p = NULL;
     BN_MONT_CTX *mont = NULL;
-    int i, k, n = 0, m = 0, qsize = qbits >> 3;
+    DSA_P_SEARCH ps;
+    int i, m = 0, qsize = qbits >> 3;
     int counter = 0;
     int r = 0;
     BN_CTX *ctx = NULL;
@@ -154,12 +324,11 @@ int dsa_builtin_paramgen(DSA *ret, size_t bits, size_t qbits,
     BN_CTX_start(ctx);
     r0 = BN_CTX_get(ctx);
     g = BN_CTX_get(ctx);
-    W = BN_CTX_get(ctx);
     q = BN_CTX_get(ctx);
-    X = BN_CTX_get(ctx);
-    c = BN_CTX_get(ctx);
     p = BN_CTX_get(ctx);
     test = BN_CTX_get(ctx);
+    if (test == NULL)
+        goto err;
 
     if (!BN_lshift(test, BN_value_one(), bits - 1))
         goto err;
@@ -223,77 +392,23 @@ int dsa_builtin_paramgen(DSA *ret, size_t bits, size_t qbits,
 
         /* step 6 */
         counter = 0;
-        /* "offset = 2" */
-
-        n = (bits - 1) / 160;
-
-        for (;;) {
-            if ((counter != 0) && !BN_GENCB_call(cb, 0, counter))
-                goto err;
-
-            /* step 7 */
-            BN_zero(W);
-            /* now 'buf' contains "SEED + offset - 1" */
-            for (k = 0; k <= n; k++) {
-                /*
-                 * obtain "SEED + offset + k" by incrementing:
-                 */
-                for (i = qsize - 1; i >= 0; i--) {
-                    buf[i]++;
-                    if (buf[i] != 0)
-                        break;
-                }
-
-                if (!EVP_Digest(buf, qsize, md, NULL, evpmd, NULL))
-                    goto err;
-
-                /* step 8 */
-                if (!BN_bin2bn(md, qsize, r0))
-                    goto err;
-                if (!BN_lshift(r0, r0, (qsize << 3) * k))
-                    goto err;
-                if (!BN_add(W, W, r0))
-                    goto err;
-            }
-
-            /* more of step 8 */
-            if (!BN_mask_bits(W, bits - 1))
-                goto err;
-            if (!BN_copy(X, W))
-                goto err;
-            if (!BN_add(X, X, test))
-                goto err;
-
-            /* step 9 */
-            if (!BN_lshift1(r0, q))
-                goto err;
-            if (!BN_mod(c, X, r0, ctx))
-                goto err;
-            if (!BN_sub(r0, c, BN_value_one()))
-                goto err;
-            if (!BN_sub(p, X, r0))
-                goto err;
-
-            /* step 10 */
-            if (BN_cmp(p, test) >= 0) {
-                /* step 11 */
-                r = BN_is_prime_fasttest_ex(p, DSS_prime_checks, ctx, 1, cb);
-                if (r > 0)
-                    goto end;   /* found it */
-                if (r != 0)
-                    goto err;
-            }
-
-            /* step 13 */
-            counter++;
-            /* "offset = offset + n + 1" */
-
-            /* step 14 */
-            if (counter >= 4096)
-                break;
-        }
+        /* "offset = 2", buf contains "SEED + 1" */
+        ps.evpmd = evpmd;
+        ps.seed = buf;
+        ps.seed_len = qsize;
+        ps.n = (bits - 1) / 160;
+        ps.blen = qsize;
+        ps.L = bits;
+        ps.q = q;
+        ps.test = test;
+        ps.limit = 4096;
+
+        r = dsa_p_search(p, &counter, &ps, cb, ctx);
+        if (r > 0)
+            break;
+        if (r < 0)
+            goto err;
     }
- end:
     if (!BN_GENCB_call(cb, 2, 1))
         goto err;
 
@@ -370,10 +485,11 @@ int dsa_builtin_paramgen2(DSA *ret, size_t L, size_t N,
     unsigned char *seed = NULL, *seed_tmp = NULL;
     unsigned char md[EVP_MAX_MD_SIZE];
     int mdsize;
-    BIGNUM *r0, *W, *X, *c, *test;
+    BIGNUM *r0, *test;
     BIGNUM *g = NULL, *q = NULL, *p = NULL;
     BN_MONT_CTX *mont = NULL;
-    int i, k, n = 0, m = 0, qsize = N >> 3;
+    DSA_P_SEARCH ps;
+    int m = 0, qsize = N >> 3;
     int counter = 0;
     int r = 0;
     BN_CTX *ctx = NULL;
@@ -421,9 +537,6 @@ int dsa_builtin_paramgen2(DSA *ret, size_t L, size_t N,
     BN_CTX_start(ctx);
     r0 = BN_CTX_get(ctx);
     g = BN_CTX_get(ctx);
-    W = BN_CTX_get(ctx);
-    X = BN_CTX_get(ctx);
-    c = BN_CTX_get(ctx);
     test = BN_CTX_get(ctx);
 
     /* if p, q already supplied generate g only */
@@ -486,7 +599,7 @@ int dsa_builtin_paramgen2(DSA *ret, size_t L, size_t N,
             /* do a callback call */
             /* step 5 */
         }
-        /* Copy seed to seed_out before we mess with it */
+        /* Copy seed to seed_out */
         if (seed_out)
             memcpy(seed_out, seed, seed_len);
 
@@ -497,82 +610,28 @@ int dsa_builtin_paramgen2(DSA *ret, size_t L, size_t N,
 
         /* step 6 */
         counter = 0;
-        /* "offset = 1" */
-
-        n = (L - 1) / (mdsize << 3);
-
-        for (;;) {
-            if ((counter != 0) && !BN_GENCB_call(cb, 0, counter))
-                goto err;
-
-            /* step 7 */
-            BN_zero(W);
-            /* now 'buf' contains "SEED + offset - 1" */
-            for (k = 0; k <= n; k++) {
-                /*
-                 * obtain "SEED + offset + k" by incrementing:
-                 */
-                for (i = seed_len - 1; i >= 0; i--) {
-                    seed[i]++;
-                    if (seed[i] != 0)
-                        break;
-                }
-
-                if (!EVP_Digest(seed, seed_len, md, NULL, evpmd, NULL))
-                    goto err;
-
-                /* step 8 */
-                if (!BN_bin2bn(md, mdsize, r0))
-                    goto err;
-                if (!BN_lshift(r0, r0, (mdsize << 3) * k))
-                    goto err;
-                if (!BN_add(W, W, r0))
-                    goto err;
-            }
-
-            /* more of step 8 */
-            if (!BN_mask_bits(W, L - 1))
-                goto err;
-            if (!BN_copy(X, W))
-                goto err;
-            if (!BN_add(X, X, test))
-                goto err;
-
-            /* step 9 */
-            if (!BN_lshift1(r0, q))
-                goto err;
-            if (!BN_mod(c, X, r0, ctx))
-                goto err;
-            if (!BN_sub(r0, c, BN_value_one()))
-                goto err;
-            if (!BN_sub(p, X, r0))
-                goto err;
-
-            /* step 10 */
-            if (BN_cmp(p, test) >= 0) {
-                /* step 11 */
-                r = BN_is_prime_fasttest_ex(p, DSS_prime_checks, ctx, 1, cb);
-                if (r > 0)
-                    goto end;   /* found it */
-                if (r != 0)
-                    goto err;
-            }
-
-            /* step 13 */
-            counter++;
-            /* "offset = offset + n + 1" */
-
-            /* step 14 */
-            if (counter >= (int)(4 * L))
-                break;
-        }
+        /* "offset = 1", seed contains "SEED" */
+        ps.evpmd = evpmd;
+        ps.seed = seed;
+        ps.seed_len = seed_len;
+        ps.n = (L - 1) / (mdsize << 3);
+        ps.blen = mdsize;
+        ps.L = L;
+        ps.q = q;
+        ps.test = test;
+        ps.limit = 4 * L;
+
+        r = dsa_p_search(p, &counter, &ps, cb, ctx);
+        if (r > 0)
+            break;
+        if (r < 0)
+            goto err;
         if (seed_in) {
             ok = 0;
             DSAerr(DSA_F_DSA_BUILTIN_PARAMGEN2, DSA_R_INVALID_PARAMETERS);
             goto err;
         }
     }
- end:
     if (!BN_GENCB_call(cb, 2, 1))
         goto err;
 
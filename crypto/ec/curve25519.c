@@ -0,0 +1,1461 @@
+/* crypto/ec/curve25519.c */
+/* ====================================================================
+ * Copyright (c) 2015 The OpenSSL Project.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. All advertising materials mentioning features or use of this
+ *    software must display the following acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit. (http://www.openssl.org/)"
+ *
+ * 4. The names "OpenSSL Toolkit" and "OpenSSL Project" must not be used to
+ *    endorse or promote products derived from this software without
+ *    prior written permission. For written permission, please contact
+ *    openssl-core@openssl.org.
+ *
+ * 5. Products derived from this software may not be called "OpenSSL"
+ *    nor may "OpenSSL" appear in their names without prior written
+ *    permission of the OpenSSL Project.
+ *
+ * 6. Redistributions of any form whatsoever must retain the following
+ *    acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit (http://www.openssl.org/)"
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE OpenSSL PROJECT ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE OpenSSL PROJECT OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ====================================================================
+ */
+
+/*
+ * X25519 Diffie-Hellman over the Montgomery form of Curve25519 (RFC 7748)
+ * and Ed25519 signatures over the birationally equivalent twisted Edwards
+ * curve (RFC 8032).
+ *
+ * Field elements are kept in one of two representations. Where the
+ * compiler provides a 128-bit integer type an element is five 64-bit limbs
+ * of 51 bits each, so that a limb product fits in 128 bits and a full
+ * multiplication is 25 such products. Otherwise sixteen 16-bit limbs held
+ * in 64-bit signed integers are used; this is slower but needs nothing
+ * beyond C89 arithmetic on 64-bit types.
+ *
+ * The X25519 scalar multiplication is the constant-time Montgomery ladder
+ * with a conditional swap: the sequence of operations and memory accesses
+ * does not depend on the secret scalar.
+ */
+
+#include <string.h>
+#include <openssl/crypto.h>
+#include <openssl/rand.h>
+#include <openssl/sha.h>
+
+#include "ec_lcl.h"
+
+typedef long long i64;
+
+#if defined(__SIZEOF_INT128__) && __SIZEOF_INT128__==16
+
+typedef unsigned long long u64;
+typedef unsigned __int128 u128;
+
+typedef u64 fe[5];
+
+# define MASK51 (((u64)1 << 51) - 1)
+
+static u64 load_8(const unsigned char *in)
+{
+    return (u64)in[0] | ((u64)in[1] << 8) | ((u64)in[2] << 16)
+        | ((u64)in[3] << 24) | ((u64)in[4] << 32) | ((u64)in[5] << 40)
+        | ((u64)in[6] << 48) | ((u64)in[7] << 56);
+}
+
+static void fe_frombytes(fe h, const unsigned char *s)
+{
+    h[0] = load_8(s) & MASK51;
+    h[1] = (load_8(s + 6) >> 3) & MASK51;
+    h[2] = (load_8(s + 12) >> 6) & MASK51;
+    h[3] = (load_8(s + 19) >> 1) & MASK51;
+    h[4] = (load_8(s + 24) >> 12) & MASK51;
+}
+
+/* Fully reduce |f| modulo p = 2^255 - 19 and store it little-endian */
+static void fe_tobytes(unsigned char *s, const fe f)
+{
+    u64 h0 = f[0], h1 = f[1], h2 = f[2], h3 = f[3], h4 = f[4];
+    u64 q;
+    int i;
+
+    /* bring all limbs below 2^51, so that the value is below 2p */
+    h1 += h0 >> 51; h0 &= MASK51;
+    h2 += h1 >> 51; h1 &= MASK51;
+    h3 += h2 >> 51; h2 &= MASK51;
+    h4 += h3 >> 51; h3 &= MASK51;
+    h0 += 19 * (h4 >> 51); h4 &= MASK51;
+    h1 += h0 >> 51; h0 &= MASK51;
+
+    /* q is 1 if h >= p and 0 otherwise */
+    q = (h0 + 19) >> 51;
+    q = (h1 + q) >> 51;
+    q = (h2 + q) >> 51;
+    q = (h3 + q) >> 51;
+    q = (h4 + q) >> 51;
+
+    /* h - q*p = h + 19*q - q*2^255 */
+    h0 += 19 * q;
+    h1 += h0 >> 51; h0 &= MASK51;
+    h2 += h1 >> 51; h1 &= MASK51;
+    h3 += h2 >> 51; h2 &= MASK51;
+    h4 += h3 >> 51; h3 &= MASK51;
+    h4 &= MASK51;
+
+    h0 |= h1 << 51;
+    h1 = (h1 >> 13) | (h2 << 38);
+    h2 = (h2 >> 26) | (h3 << 25);
+    h3 = (h3 >> 39) | (h4 << 12);
+    for (i = 0; i < 8; i++) {
+        s[i] = (unsigned char)(h0 >> (8 * i));
+        s[i + 8] = (unsigned char)(h1 >> (8 * i));
+        s[i + 16] = (unsigned char)(h2 >> (8 * i));
+        s[i + 24] = (unsigned char)(h3 >> (8 * i));
+    }
+}
+
+static void fe_0(fe h)
+{
+    memset(h, 0, sizeof(fe));
+}
+
+static void fe_1(fe h)
+{
+    memset(h, 0, sizeof(fe));
+    h[0] = 1;
+}
+
+static void fe_copy(fe h, const fe f)
+{
+    memcpy(h, f, sizeof(fe));
+}
+
+/* Limbs of inputs below 2^52, limbs of the result below 2^53 */
+static void fe_add(fe h, const fe f, const fe g)
+{
+    h[0] = f[0] + g[0];
+    h[1] = f[1] + g[1];
+    h[2] = f[2] + g[2];
+    h[3] = f[3] + g[3];
+    h[4] = f[4] + g[4];
+}
+
+/* As fe_add; 2*p is added to keep the limbs from going negative */
+static void fe_sub(fe h, const fe f, const fe g)
+{
+    h[0] = (f[0] + 0xfffffffffffdaULL) - g[0];
+    h[1] = (f[1] + 0xffffffffffffeULL) - g[1];
+    h[2] = (f[2] + 0xffffffffffffeULL) - g[2];
+    h[3] = (f[3] + 0xffffffffffffeULL) - g[3];
+    h[4] = (f[4] + 0xffffffffffffeULL) - g[4];
+}
+
+/* Carry the 128-bit column sums into limbs below 2^51 + 2^13 */
+static void fe_carry(fe h, u128 r0, u128 r1, u128 r2, u128 r3, u128 r4)
+{
+    u64 c;
+
+    r1 += (u64)(r0 >> 51);
+    r2 += (u64)(r1 >> 51);
+    r3 += (u64)(r2 >> 51);
+    r4 += (u64)(r3 >> 51);
+    c = (u64)(r4 >> 51);
+    h[0] = ((u64)r0 & MASK51) + 19 * c;
+    h[1] = ((u64)r1 & MASK51) + (h[0] >> 51);
+    h[0] &= MASK51;
+    h[2] = (u64)r2 & MASK51;
+    h[3] = (u64)r3 & MASK51;
+    h[4] = (u64)r4 & MASK51;
+}
+
+/* Input limbs below 2^54 */
+static void fe_mul(fe h, const fe f, const fe g)
+{
+    u64 f0 = f[0], f1 = f[1], f2 = f[2], f3 = f[3], f4 = f[4];
+    u64 g0 = g[0], g1 = g[1], g2 = g[2], g3 = g[3], g4 = g[4];
+    u64 g1_19 = 19 * g1, g2_19 = 19 * g2, g3_19 = 19 * g3, g4_19 = 19 * g4;
+    u128 r0, r1, r2, r3, r4;
+
+    r0 = (u128)f0 * g0 + (u128)f1 * g4_19 + (u128)f2 * g3_19
+        + (u128)f3 * g2_19 + (u128)f4 * g1_19;
+    r1 = (u128)f0 * g1 + (u128)f1 * g0 + (u128)f2 * g4_19
+        + (u128)f3 * g3_19 + (u128)f4 * g2_19;
+    r2 = (u128)f0 * g2 + (u128)f1 * g1 + (u128)f2 * g0
+        + (u128)f3 * g4_19 + (u128)f4 * g3_19;
+    r3 = (u128)f0 * g3 + (u128)f1 * g2 + (u128)f2 * g1
+        + (u128)f3 * g0 + (u128)f4 * g4_19;
+    r4 = (u128)f0 * g4 + (u128)f1 * g3 + (u128)f2 * g2
+        + (u128)f3 * g1 + (u128)f4 * g0;
+
+    fe_carry(h, r0, r1, r2, r3, r4);
+}
+
+static void fe_sq(fe h, const fe f)
+{
+    u64 f0 = f[0], f1 = f[1], f2 = f[2], f3 = f[3], f4 = f[4];
+    u64 f0_2 = 2 * f0, f1_2 = 2 * f1;
+    u64 f3_19 = 19 * f3, f4_19 = 19 * f4;
+    u128 r0, r1, r2, r3, r4;
+
+    r0 = (u128)f0 * f0 + (u128)(2 * f1) * f4_19 + (u128)(2 * f2) * f3_19;
+    r1 = (u128)f0_2 * f1 + (u128)(2 * f2) * f4_19 + (u128)f3 * f3_19;
+    r2 = (u128)f0_2 * f2 + (u128)f1 * f1 + (u128)(2 * f3) * f4_19;
+    r3 = (u128)f0_2 * f3 + (u128)f1_2 * f2 + (u128)f4 * f4_19;
+    r4 = (u128)f0_2 * f4 + (u128)f1_2 * f3 + (u128)f2 * f2;
+
+    fe_carry(h, r0, r1, r2, r3, r4);
+}
+
+/* h = f * 121665, (A - 2) / 4 for Curve25519 */
+static void fe_mul121665(fe h, const fe f)
+{
+    fe_carry(h, (u128)f[0] * 121665, (u128)f[1] * 121665,
+             (u128)f[2] * 121665, (u128)f[3] * 121665, (u128)f[4] * 121665);
+}
+
+/* Swap f and g if b is 1, leave them alone if it is 0 */
+static void fe_cswap(fe f, fe g, unsigned int b)
+{
+    u64 mask = 0 - (u64)b, x;
+    int i;
+
+    for (i = 0; i < 5; i++) {
+        x = (f[i] ^ g[i]) & mask;
+        f[i] ^= x;
+        g[i] ^= x;
+    }
+}
+
+/* Bring the limbs of a sum or difference back below 2^51 + 2^13 */
+static void fe_weak_reduce(fe h)
+{
+    h[1] += h[0] >> 51;
+    h[0] &= MASK51;
+    h[2] += h[1] >> 51;
+    h[1] &= MASK51;
+    h[3] += h[2] >> 51;
+    h[2] &= MASK51;
+    h[4] += h[3] >> 51;
+    h[3] &= MASK51;
+    h[0] += 19 * (h[4] >> 51);
+    h[4] &= MASK51;
+}
+
+#else
+
+typedef i64 fe[16];
+
+static void fe_frombytes(fe h, const unsigned char *s)
+{
+    int i;
+
+    for (i = 0; i < 16; i++)
+        h[i] = s[2 * i] | ((i64)s[2 * i + 1] << 8);
+    h[15] &= 0x7fff;
+}
+
+/*
+ * Propagate carries so that every limb is below 2^16; the carry out of
+ * the top limb is worth 2^256 = 38 mod p.
+ */
+static void fe_carry(fe h)
+{
+    i64 c;
+    int i;
+
+    for (i = 0; i < 16; i++) {
+        h[i] += (i64)1 << 16;
+        c = h[i] >> 16;
+        if (i < 15)
+            h[i + 1] += c - 1;
+        else
+            h[0] += 38 * (c - 1);
+        h[i] -= c * ((i64)1 << 16);
+    }
+}
+
+static void fe_cswap(fe f, fe g, unsigned int b)
+{
+    i64 mask = ~((i64)b - 1), x;
+    int i;
+
+    for (i = 0; i < 16; i++) {
+        x = mask & (f[i] ^ g[i]);
+        f[i] ^= x;
+        g[i] ^= x;
+    }
+}
+
+static void fe_tobytes(unsigned char *s, const fe f)
+{
+    fe t, m;
+    i64 b;
+    int i, j;
+
+    memcpy(t, f, sizeof(fe));
+    fe_carry(t);
+    fe_carry(t);
+    fe_carry(t);
+    /* subtract p twice, keeping the result only where it did not borrow */
+    for (j = 0; j < 2; j++) {
+        m[0] = t[0] - 0xffed;
+        for (i = 1; i < 15; i++) {
+            m[i] = t[i] - 0xffff - ((m[i - 1] >> 16) & 1);
+            m[i - 1] &= 0xffff;
+        }
+        m[15] = t[15] - 0x7fff - ((m[14] >> 16) & 1);
+        b = (m[15] >> 16) & 1;
+        m[14] &= 0xffff;
+        fe_cswap(t, m, (unsigned int)(1 - b));
+    }
+    for (i = 0; i < 16; i++) {
+        s[2 * i] = (unsigned char)(t[i] & 0xff);
+        s[2 * i + 1] = (unsigned char)(t[i] >> 8);
+    }
+}
+
+static void fe_0(fe h)
+{
+    memset(h, 0, sizeof(fe));
+}
+
+static void fe_1(fe h)
+{
+    memset(h, 0, sizeof(fe));
+    h[0] = 1;
+}
+
+static void fe_copy(fe h, const fe f)
+{
+    memcpy(h, f, sizeof(fe));
+}
+
+static void fe_add(fe h, const fe f, const fe g)
+{
+    int i;
+
+    for (i = 0; i < 16; i++)
+        h[i] = f[i] + g[i];
+}
+
+static void fe_sub(fe h, const fe f, const fe g)
+{
+    int i;
+
+    for (i = 0; i < 16; i++)
+        h[i] = f[i] - g[i];
+}
+
+static void fe_mul(fe h, const fe f, const fe g)
+{
+    i64 t[31];
+    int i, j;
+
+    for (i = 0; i < 31; i++)
+        t[i] = 0;
+    for (i = 0; i < 16; i++)
+        for (j = 0; j < 16; j++)
+            t[i + j] += f[i] * g[j];
+    for (i = 0; i < 15; i++)
+        t[i] += 38 * t[i + 16];
+    for (i = 0; i < 16; i++)
+        h[i] = t[i];
+    fe_carry(h);
+    fe_carry(h);
+}
+
+static void fe_sq(fe h, const fe f)
+{
+    fe_mul(h, f, f);
+}
+
+static void fe_mul121665(fe h, const fe f)
+{
+    int i;
+
+    for (i = 0; i < 16; i++)
+        h[i] = f[i] * 121665;
+    fe_carry(h);
+    fe_carry(h);
+}
+
+static void fe_weak_reduce(fe h)
+{
+    fe_carry(h);
+}
+
+#endif
+
+/*
+ * t = f^(2^250 - 1) and z11 = f^11, the common part of the addition chains
+ * for inversion and square roots.
+ */
+static void fe_pow_2_250_1(fe t, fe z11, const fe f)
+{
+    fe z2, z9, z2_5_0, z2_10_0, z2_20_0, z2_50_0, z2_100_0;
+    int i;
+
+    fe_sq(z2, f);                                   /* 2 */
+    fe_sq(t, z2);                                   /* 4 */
+    fe_sq(t, t);                                    /* 8 */
+    fe_mul(z9, t, f);                               /* 9 */
+    fe_mul(z11, z9, z2);                            /* 11 */
+    fe_sq(t, z11);                                  /* 22 */
+    fe_mul(z2_5_0, t, z9);                          /* 2^5 - 1 */
+
+    fe_sq(t, z2_5_0);
+    for (i = 1; i < 5; i++)
+        fe_sq(t, t);
+    fe_mul(z2_10_0, t, z2_5_0);                     /* 2^10 - 1 */
+
+    fe_sq(t, z2_10_0);
+    for (i = 1; i < 10; i++)
+        fe_sq(t, t);
+    fe_mul(z2_20_0, t, z2_10_0);                    /* 2^20 - 1 */
+
+    fe_sq(t, z2_20_0);
+    for (i = 1; i < 20; i++)
+        fe_sq(t, t);
+    fe_mul(t, t, z2_20_0);                          /* 2^40 - 1 */
+
+    for (i = 0; i < 10; i++)
+        fe_sq(t, t);
+    fe_mul(z2_50_0, t, z2_10_0);                    /* 2^50 - 1 */
+
+    fe_sq(t, z2_50_0);
+    for (i = 1; i < 50; i++)
+        fe_sq(t, t);
+    fe_mul(z2_100_0, t, z2_50_0);                   /* 2^100 - 1 */
+
+    fe_sq(t, z2_100_0);
+    for (i = 1; i < 100; i++)
+        fe_sq(t, t);
+    fe_mul(t, t, z2_100_0);                         /* 2^200 - 1 */
+
+    for (i = 0; i < 50; i++)
+        fe_sq(t, t);
+    fe_mul(t, t, z2_50_0);                          /* 2^250 - 1 */
+}
+
+/* h = f^(p-2) = f^(2^255 - 21) = 1/f */
+static void fe_invert(fe h, const fe f)
+{
+    fe t, z11;
+    int i;
+
+    fe_pow_2_250_1(t, z11, f);
+    for (i = 0; i < 5; i++)
+        fe_sq(t, t);
+    fe_mul(h, t, z11);                              /* 2^255 - 21 */
+}
+
+/*
+ * Montgomery ladder of RFC 7748, section 5: |out| = u(|scalar| * |point|).
+ * |scalar| is clamped here.
+ */
+static void x25519_scalar_mult(unsigned char out[32],
+                               const unsigned char scalar[32],
+                               const unsigned char point[32])
+{
+    fe x1, x2, z2, x3, z3, a, aa, b, bb, e, c, d, da, cb;
+    unsigned char e_[32];
+    unsigned int swap = 0, bit;
+    int pos;
+
+    memcpy(e_, scalar, 32);
+    e_[0] &= 248;
+    e_[31] &= 127;
+    e_[31] |= 64;
+
+    fe_frombytes(x1, point);
+    fe_1(x2);
+    fe_0(z2);
+    fe_copy(x3, x1);
+    fe_1(z3);
+
+    for (pos = 254; pos >= 0; pos--) {
+        bit = (e_[pos / 8] >> (pos & 7)) & 1;
+        swap ^= bit;
+        fe_cswap(x2, x3, swap);
+        fe_cswap(z2, z3, swap);
+        swap = bit;
+
+        fe_add(a, x2, z2);
+        fe_sq(aa, a);
+        fe_sub(b, x2, z2);
+        fe_sq(bb, b);
+        fe_sub(e, aa, bb);
+        fe_add(c, x3, z3);
+        fe_sub(d, x3, z3);
+        fe_mul(da, d, a);
+        fe_mul(cb, c, b);
+
+        fe_add(x3, da, cb);
+        fe_sq(x3, x3);
+        fe_sub(z3, da, cb);
+        fe_sq(z3, z3);
+        fe_mul(z3, z3, x1);
+
+        fe_mul(x2, aa, bb);
+        fe_mul121665(z2, e);
+        fe_add(z2, z2, aa);
+        fe_mul(z2, z2, e);
+    }
+    fe_cswap(x2, x3, swap);
+    fe_cswap(z2, z3, swap);
+
+    fe_invert(z2, z2);
+    fe_mul(x2, x2, z2);
+    fe_tobytes(out, x2);
+
+    OPENSSL_cleanse(e_, sizeof(e_));
+}
+
+int X25519(unsigned char out_shared_key[32],
+           const unsigned char private_key[32],
+           const unsigned char peer_public_value[32])
+{
+    static const unsigned char zeros[32] = { 0 };
+
+    x25519_scalar_mult(out_shared_key, private_key, peer_public_value);
+    /*
+     * An all-zero result means the peer sent a point of small order; the
+     * check is the one RFC 7748 section 6.1 suggests and need not be
+     * constant time since the shared key is discarded in that case.
+     */
+    return CRYPTO_memcmp(zeros, out_shared_key, 32) != 0;
+}
+
+void X25519_public_from_private(unsigned char out_public_value[32],
+                                const unsigned char private_key[32])
+{
+    static const unsigned char basepoint[32] = { 9 };
+
+    x25519_scalar_mult(out_public_value, private_key, basepoint);
+}
+
+/*
+ * Ed25519.
+ *
+ * Points of the twisted Edwards curve -x^2 + y^2 = 1 + d x^2 y^2 are kept
+ * in the coordinate systems of "Twisted Edwards Curves Revisited" by
+ * Hisil, Wong, Carter and Dawson:
+ *
+ *   ge_p2:     (X:Y:Z), x = X/Z, y = Y/Z
+ *   ge_p3:     (X:Y:Z:T), extended, XY = ZT
+ *   ge_p1p1:   ((X:Z),(Y:T)), the "completed" output of a doubling or sum
+ *   ge_precomp: (y+x, y-x, 2dxy), an affine point ready for addition
+ *   ge_cached: (Y+X, Y-X, Z, 2dT), a projective point ready for addition
+ *
+ * The addition formulas are complete, so no special cases arise.
+ */
+
+typedef struct {
+    fe X;
+    fe Y;
+    fe Z;
+} ge_p2;
+
+typedef struct {
+    fe X;
+    fe Y;
+    fe Z;
+    fe T;
+} ge_p3;
+
+typedef struct {
+    fe X;
+    fe Y;
+    fe Z;
+    fe T;
+} ge_p1p1;
+
+typedef struct {
+    fe yplusx;
+    fe yminusx;
+    fe xy2d;
+} ge_precomp;
+
+typedef struct {
+    fe YplusX;
+    fe YminusX;
+    fe Z;
+    fe T2d;
+} ge_cached;
+
+#include "curve25519_table.h"
+
+/* d = -121665/121666 */
+static const unsigned char k25519d[32] = {
+    0xa3, 0x78, 0x59, 0x13, 0xca, 0x4d, 0xeb, 0x75, 0xab, 0xd8,
+    0x41, 0x41, 0x4d, 0x0a, 0x70, 0x00, 0x98, 0xe8, 0x79, 0x77,
+    0x79, 0x40, 0xc7, 0x8c, 0x73, 0xfe, 0x6f, 0x2b, 0xee, 0x6c,
+    0x03, 0x52
+};
+
+/* 2 * d */
+static const unsigned char k25519d2[32] = {
+    0x59, 0xf1, 0xb2, 0x26, 0x94, 0x9b, 0xd6, 0xeb, 0x56, 0xb1,
+    0x83, 0x82, 0x9a, 0x14, 0xe0, 0x00, 0x30, 0xd1, 0xf3, 0xee,
+    0xf2, 0x80, 0x8e, 0x19, 0xe7, 0xfc, 0xdf, 0x56, 0xdc, 0xd9,
+    0x06, 0x24
+};
+
+/* sqrt(-1) = 2^((p - 1) / 4) */
+static const unsigned char k25519sqrtm1[32] = {
+    0xb0, 0xa0, 0x0e, 0x4a, 0x27, 0x1b, 0xee, 0xc4, 0x78, 0xe4,
+    0x2f, 0xad, 0x06, 0x18, 0x43, 0x2f, 0xa7, 0xd7, 0xfb, 0x3d,
+    0x99, 0x00, 0x4d, 0x2b, 0x0b, 0xdf, 0xc1, 0x4f, 0x80, 0x24,
+    0x83, 0x2b
+};
+
+/* The group order l = 2^252 + 27742317777372353535851937790883648493 */
+static const unsigned char k25519l[32] = {
+    0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58, 0xd6, 0x9c,
+    0xf7, 0xa2, 0xde, 0xf9, 0xde, 0x14, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x10
+};
+
+/* h = -f; limbs of f below 2^52 */
+static void fe_neg(fe h, const fe f)
+{
+    fe zero;
+
+    fe_0(zero);
+    fe_sub(h, zero, f);
+}
+
+static int fe_isnegative(const fe f)
+{
+    unsigned char s[32];
+
+    fe_tobytes(s, f);
+    return s[0] & 1;
+}
+
+static int fe_iszero(const fe f)
+{
+    static const unsigned char zero[32] = { 0 };
+    unsigned char s[32];
+
+    fe_tobytes(s, f);
+    return CRYPTO_memcmp(s, zero, 32) == 0;
+}
+
+static int fe_equal(const fe f, const fe g)
+{
+    unsigned char s[32], t[32];
+
+    fe_tobytes(s, f);
+    fe_tobytes(t, g);
+    return CRYPTO_memcmp(s, t, 32) == 0;
+}
+
+/* h = f^((p-5)/8) = f^(2^252 - 3), the square root exponent */
+static void fe_pow22523(fe h, const fe f)
+{
+    fe t, z11;
+
+    fe_pow_2_250_1(t, z11, f);
+    fe_sq(t, t);
+    fe_sq(t, t);
+    fe_mul(h, t, f);                                /* 2^252 - 3 */
+}
+
+static void ge_p2_0(ge_p2 *h)
+{
+    fe_0(h->X);
+    fe_1(h->Y);
+    fe_1(h->Z);
+}
+
+static void ge_p3_0(ge_p3 *h)
+{
+    fe_0(h->X);
+    fe_1(h->Y);
+    fe_1(h->Z);
+    fe_0(h->T);
+}
+
+static void ge_p3_tobytes(unsigned char s[32], const ge_p3 *h)
+{
+    fe recip, x, y;
+
+    fe_invert(recip, h->Z);
+    fe_mul(x, h->X, recip);
+    fe_mul(y, h->Y, recip);
+    fe_tobytes(s, y);
+    s[31] ^= fe_isnegative(x) << 7;
+}
+
+/*
+ * Decode the point encoded in |s| (RFC 8032, section 5.1.3). Returns 0 for
+ * a non-canonical y, for x^2 with no square root and for the encoding of
+ * -0. Only used on public data, so need not be constant time.
+ */
+static int ge_frombytes_vartime(ge_p3 *h, const unsigned char s[32])
+{
+    fe u, v, v3, vxx, d;
+    unsigned char y[32];
+
+    fe_frombytes(h->Y, s);
+    fe_tobytes(y, h->Y);
+    y[31] |= s[31] & 0x80;
+    if (memcmp(y, s, 32) != 0)
+        return 0;
+
+    fe_1(h->Z);
+    fe_frombytes(d, k25519d);
+    fe_sq(u, h->Y);
+    fe_mul(v, u, d);
+    fe_sub(u, u, h->Z);                             /* u = y^2 - 1 */
+    fe_weak_reduce(u);
+    fe_add(v, v, h->Z);                             /* v = dy^2 + 1 */
+
+    fe_sq(v3, v);
+    fe_mul(v3, v3, v);                              /* v^3 */
+    fe_sq(h->X, v3);
+    fe_mul(h->X, h->X, v);
+    fe_mul(h->X, h->X, u);                          /* uv^7 */
+    fe_pow22523(h->X, h->X);
+    fe_mul(h->X, h->X, v3);
+    fe_mul(h->X, h->X, u);                          /* uv^3 (uv^7)^((p-5)/8) */
+
+    fe_sq(vxx, h->X);
+    fe_mul(vxx, vxx, v);
+    if (!fe_equal(vxx, u)) {
+        fe_neg(u, u);
+        if (!fe_equal(vxx, u))
+            return 0;
+        fe_frombytes(d, k25519sqrtm1);
+        fe_mul(h->X, h->X, d);
+    }
+
+    if (fe_isnegative(h->X) != (s[31] >> 7)) {
+        if (fe_iszero(h->X))
+            return 0;
+        fe_neg(h->X, h->X);
+    }
+    fe_mul(h->T, h->X, h->Y);
+    return 1;
+}
+
+static void ge_p3_neg(ge_p3 *h)
+{
+    fe_neg(h->X, h->X);
+    fe_neg(h->T, h->T);
+}
+
+static void ge_p3_to_cached(ge_cached *r, const ge_p3 *p)
+{
+    fe d2;
+
+    fe_frombytes(d2, k25519d2);
+    fe_add(r->YplusX, p->Y, p->X);
+    fe_sub(r->YminusX, p->Y, p->X);
+    fe_copy(r->Z, p->Z);
+    fe_mul(r->T2d, p->T, d2);
+}
+
+static void ge_p1p1_to_p2(ge_p2 *r, const ge_p1p1 *p)
+{
+    fe_mul(r->X, p->X, p->T);
+    fe_mul(r->Y, p->Y, p->Z);
+    fe_mul(r->Z, p->Z, p->T);
+}
+
+static void ge_p1p1_to_p3(ge_p3 *r, const ge_p1p1 *p)
+{
+    fe_mul(r->X, p->X, p->T);
+    fe_mul(r->Y, p->Y, p->Z);
+    fe_mul(r->Z, p->Z, p->T);
+    fe_mul(r->T, p->X, p->Y);
+}
+
+/* r = 2 * p */
+static void ge_p2_dbl(ge_p1p1 *r, const ge_p2 *p)
+{
+    fe t0;
+
+    fe_sq(r->X, p->X);
+    fe_sq(r->Z, p->Y);
+    fe_sq(r->T, p->Z);
+    fe_add(r->T, r->T, r->T);
+    fe_add(r->Y, p->X, p->Y);
+    fe_sq(t0, r->Y);
+    fe_add(r->Y, r->Z, r->X);
+    fe_weak_reduce(r->Y);
+    fe_sub(r->Z, r->Z, r->X);
+    fe_weak_reduce(r->Z);
+    fe_sub(r->X, t0, r->Y);
+    fe_sub(r->T, r->T, r->Z);
+}
+
+static void ge_p3_dbl(ge_p1p1 *r, const ge_p3 *p)
+{
+    ge_p2 q;
+
+    fe_copy(q.X, p->X);
+    fe_copy(q.Y, p->Y);
+    fe_copy(q.Z, p->Z);
+    ge_p2_dbl(r, &q);
+}
+
+/* r = p + q */
+static void ge_add(ge_p1p1 *r, const ge_p3 *p, const ge_cached *q)
+{
+    fe t0;
+
+    fe_add(r->X, p->Y, p->X);
+    fe_sub(r->Y, p->Y, p->X);
+    fe_mul(r->Z, r->X, q->YplusX);
+    fe_mul(r->Y, r->Y, q->YminusX);
+    fe_mul(r->T, q->T2d, p->T);
+    fe_mul(r->X, p->Z, q->Z);
+    fe_add(t0, r->X, r->X);
+    fe_sub(r->X, r->Z, r->Y);
+    fe_add(r->Y, r->Z, r->Y);
+    fe_add(r->Z, t0, r->T);
+    fe_sub(r->T, t0, r->T);
+}
+
+/* r = p - q */
+static void ge_sub(ge_p1p1 *r, const ge_p3 *p, const ge_cached *q)
+{
+    fe t0;
+
+    fe_add(r->X, p->Y, p->X);
+    fe_sub(r->Y, p->Y, p->X);
+    fe_mul(r->Z, r->X, q->YminusX);
+    fe_mul(r->Y, r->Y, q->YplusX);
+    fe_mul(r->T, q->T2d, p->T);
+    fe_mul(r->X, p->Z, q->Z);
+    fe_add(t0, r->X, r->X);
+    fe_sub(r->X, r->Z, r->Y);
+    fe_add(r->Y, r->Z, r->Y);
+    fe_sub(r->Z, t0, r->T);
+    fe_add(r->T, t0, r->T);
+}
+
+/* r = p + q, q affine */
+static void ge_madd(ge_p1p1 *r, const ge_p3 *p, const ge_precomp *q)
+{
+    fe t0;
+
+    fe_add(r->X, p->Y, p->X);
+    fe_sub(r->Y, p->Y, p->X);
+    fe_mul(r->Z, r->X, q->yplusx);
+    fe_mul(r->Y, r->Y, q->yminusx);
+    fe_mul(r->T, q->xy2d, p->T);
+    fe_add(t0, p->Z, p->Z);
+    fe_sub(r->X, r->Z, r->Y);
+    fe_add(r->Y, r->Z, r->Y);
+    fe_add(r->Z, t0, r->T);
+    fe_sub(r->T, t0, r->T);
+}
+
+/* r = p - q, q affine */
+static void ge_msub(ge_p1p1 *r, const ge_p3 *p, const ge_precomp *q)
+{
+    fe t0;
+
+    fe_add(r->X, p->Y, p->X);
+    fe_sub(r->Y, p->Y, p->X);
+    fe_mul(r->Z, r->X, q->yminusx);
+    fe_mul(r->Y, r->Y, q->yplusx);
+    fe_mul(r->T, q->xy2d, p->T);
+    fe_add(t0, p->Z, p->Z);
+    fe_sub(r->X, r->Z, r->Y);
+    fe_add(r->Y, r->Z, r->Y);
+    fe_sub(r->Z, t0, r->T);
+    fe_add(r->T, t0, r->T);
+}
+
+static void ge_precomp_frombytes(ge_precomp *t,
+                                 const unsigned char s[3][32])
+{
+    fe_frombytes(t->yplusx, s[0]);
+    fe_frombytes(t->yminusx, s[1]);
+    fe_frombytes(t->xy2d, s[2]);
+}
+
+/*
+ * t = b * 256^pos * B for b in [-8, 8], read from the table without
+ * secret-dependent memory accesses or branches.
+ */
+static void ge_select(ge_precomp *t, int pos, signed char b)
+{
+    union {
+        unsigned char c[3][32];
+        size_t w[96 / sizeof(size_t)];
+    } buf;
+    unsigned int neg = (unsigned int)(unsigned char)b >> 7;
+    unsigned int babs = b - (((0 - neg) & b) << 1);
+    size_t mask, q[96 / sizeof(size_t)];
+    fe minus;
+    int i, j;
+
+    /* the neutral element (1, 1, 0) */
+    memset(&buf, 0, sizeof(buf));
+    buf.c[0][0] = 1;
+    buf.c[1][0] = 1;
+
+    /* a whole word at a time: byte order does not matter for a copy */
+    for (i = 0; i < 8; i++) {
+        /* mask is all ones if babs == i + 1 */
+        mask = 0 - (size_t)((((babs ^ (i + 1)) & 0xff) - 1) >> 8 & 1);
+        memcpy(q, k25519Precomp[pos][i], sizeof(q));
+        for (j = 0; j < (int)(sizeof(q) / sizeof(q[0])); j++)
+            buf.w[j] ^= (buf.w[j] ^ q[j]) & mask;
+    }
+    ge_precomp_frombytes(t, (const unsigned char (*)[32])buf.c);
+    OPENSSL_cleanse(&buf, sizeof(buf));
+
+    /* -(x, y) = (-x, y): swap y+x and y-x and negate xy2d */
+    fe_cswap(t->yplusx, t->yminusx, neg);
+    fe_neg(minus, t->xy2d);
+    fe_cswap(t->xy2d, minus, neg);
+}
+
+/*
+ * h = a * B where a = a[0] + 256 * a[1] + ... + 256^31 * a[31] and
+ * a[31] <= 127, in constant time.
+ */
+static void ge_scalarmult_base(ge_p3 *h, const unsigned char a[32])
+{
+    signed char e[64];
+    int carry, i;
+    ge_p1p1 r;
+    ge_p2 s;
+    ge_precomp t;
+
+    for (i = 0; i < 32; i++) {
+        e[2 * i] = a[i] & 15;
+        e[2 * i + 1] = (a[i] >> 4) & 15;
+    }
+    /* each e[i] is between 0 and 15, e[63] between 0 and 7 */
+
+    carry = 0;
+    for (i = 0; i < 63; i++) {
+        e[i] += carry;
+        carry = (e[i] + 8) >> 4;
+        e[i] -= carry * 16;
+    }
+    e[63] += carry;
+    /* each e[i] is between -8 and 8 */
+
+    ge_p3_0(h);
+    for (i = 1; i < 64; i += 2) {
+        ge_select(&t, i / 2, e[i]);
+        ge_madd(&r, h, &t);
+        ge_p1p1_to_p3(h, &r);
+    }
+
+    ge_p3_dbl(&r, h);
+    ge_p1p1_to_p2(&s, &r);
+    ge_p2_dbl(&r, &s);
+    ge_p1p1_to_p2(&s, &r);
+    ge_p2_dbl(&r, &s);
+    ge_p1p1_to_p2(&s, &r);
+    ge_p2_dbl(&r, &s);
+    ge_p1p1_to_p3(h, &r);
+
+    for (i = 0; i < 64; i += 2) {
+        ge_select(&t, i / 2, e[i]);
+        ge_madd(&r, h, &t);
+        ge_p1p1_to_p3(h, &r);
+    }
+
+    OPENSSL_cleanse(e, sizeof(e));
+}
+
+/*
+ * Write the scalar a < 2^255 in width-w non-adjacent form: r[i] is zero or
+ * odd with |r[i]| <= max, where max is 7 or 15.
+ */
+static void slide(signed char r[256], const unsigned char a[32], int max)
+{
+    int i, b, k;
+
+    for (i = 0; i < 256; i++)
+        r[i] = 1 & (a[i >> 3] >> (i & 7));
+
+    for (i = 0; i < 256; i++) {
+        if (r[i] == 0)
+            continue;
+        for (b = 1; b <= 6 && i + b < 256; b++) {
+            if (r[i + b] == 0)
+                continue;
+            if (r[i] + (r[i + b] << b) <= max) {
+                r[i] += r[i + b] << b;
+                r[i + b] = 0;
+            } else if (r[i] - (r[i + b] << b) >= -max) {
+                r[i] -= r[i + b] << b;
+                for (k = i + b; k < 256; k++) {
+                    if (r[k] == 0) {
+                        r[k] = 1;
+                        break;
+                    }
+                    r[k] = 0;
+                }
+            } else {
+                break;
+            }
+        }
+    }
+}
+
+/* A point with its odd multiples P, 3P, ..., 15P and a scalar to apply */
+typedef struct {
+    ge_cached odd[8];
+    signed char naf[256];
+} ge_term;
+
+static void ge_term_init(ge_term *term, const ge_p3 *p,
+                         const unsigned char scalar[32])
+{
+    ge_p1p1 t;
+    ge_p3 p2, u;
+    int i;
+
+    ge_p3_to_cached(&term->odd[0], p);
+    ge_p3_dbl(&t, p);
+    ge_p1p1_to_p3(&p2, &t);
+    for (i = 0; i < 7; i++) {
+        ge_add(&t, &p2, &term->odd[i]);
+        ge_p1p1_to_p3(&u, &t);
+        ge_p3_to_cached(&term->odd[i + 1], &u);
+    }
+    slide(term->naf, scalar, 15);
+}
+
+/*
+ * h = b * B + sum of the |num| terms, with one chain of doublings shared
+ * between all of them (Straus' method). Variable time: for verification.
+ */
+static void ge_multi_scalarmult_vartime(ge_p3 *h, const unsigned char b[32],
+                                        const ge_term *terms, size_t num)
+{
+    signed char bnaf[256];
+    ge_precomp bi[4];
+    ge_p1p1 t;
+    ge_p2 r;
+    size_t j;
+    int i, top, d;
+
+    /* B, 3B, 5B and 7B are in the first row of the fixed-base table */
+    for (i = 0; i < 4; i++)
+        ge_precomp_frombytes(&bi[i], k25519Precomp[0][2 * i]);
+    slide(bnaf, b, 7);
+
+    for (top = 255; top >= 0; top--) {
+        if (bnaf[top] != 0)
+            break;
+        for (j = 0; j < num; j++)
+            if (terms[j].naf[top] != 0)
+                break;
+        if (j < num)
+            break;
+    }
+
+    ge_p2_0(&r);
+    ge_p3_0(h);
+    for (i = top; i >= 0; i--) {
+        ge_p2_dbl(&t, &r);
+        ge_p1p1_to_p3(h, &t);
+        for (j = 0; j < num; j++) {
+            d = terms[j].naf[i];
+            if (d > 0)
+                ge_add(&t, h, &terms[j].odd[d / 2]);
+            else if (d < 0)
+                ge_sub(&t, h, &terms[j].odd[-d / 2]);
+            else
+                continue;
+            ge_p1p1_to_p3(h, &t);
+        }
+        d = bnaf[i];
+        if (d > 0) {
+            ge_madd(&t, h, &bi[d / 2]);
+            ge_p1p1_to_p3(h, &t);
+        } else if (d < 0) {
+            ge_msub(&t, h, &bi[-d / 2]);
+            ge_p1p1_to_p3(h, &t);
+        }
+        fe_copy(r.X, h->X);
+        fe_copy(r.Y, h->Y);
+        fe_copy(r.Z, h->Z);
+    }
+}
+
+/* Returns 1 if 8 * p is the neutral element */
+static int ge_is_small_order_multiple(const ge_p3 *p)
+{
+    ge_p1p1 t;
+    ge_p2 r;
+
+    ge_p3_dbl(&t, p);
+    ge_p1p1_to_p2(&r, &t);
+    ge_p2_dbl(&t, &r);
+    ge_p1p1_to_p2(&r, &t);
+    ge_p2_dbl(&t, &r);
+    ge_p1p1_to_p2(&r, &t);
+    return fe_iszero(r.X) && fe_equal(r.Y, r.Z);
+}
+
+/*
+ * Arithmetic modulo the group order l, on numbers split into 21-bit limbs
+ * held in 64-bit signed integers. 2^252 = -l0 (mod l), where the limbs of
+ * l0 = l - 2^252 are below.
+ */
+static const i64 k25519l0[6] = {
+    1430509, 1626855, 1442968, 997804, 1960495, 683900
+};
+
+static void sc_load(i64 *s, int n, const unsigned char *in, int len)
+{
+    i64 acc = 0;
+    int i, bits = 0, j = 0;
+
+    for (i = 0; i < len; i++) {
+        acc |= (i64)in[i] << bits;
+        bits += 8;
+        if (bits >= 21) {
+            s[j++] = acc & 0x1fffff;
+            acc >>= 21;
+            bits -= 21;
+        }
+    }
+    s[j++] = acc;
+    while (j < n)
+        s[j++] = 0;
+}
+
+/*
+ * Reduce the number in the 25 limbs |s|, each below 2^42 in absolute value,
+ * modulo l and store it, fully reduced, in |out|. Constant time.
+ */
+static void sc_reduce_limbs(unsigned char out[32], i64 s[25])
+{
+    i64 carry, mask;
+    unsigned long long acc;
+    int i, j, bits, k;
+
+    /* fold everything above 2^252 down, keeping the limbs small */
+    for (i = 24; i >= 12; i--) {
+        for (j = 0; j < 6; j++)
+            s[i - 12 + j] -= s[i] * k25519l0[j];
+        s[i] = 0;
+        for (j = i - 12; j < i - 1; j++) {
+            carry = (s[j] + (1 << 20)) >> 21;
+            s[j + 1] += carry;
+            s[j] -= carry * (1 << 21);
+        }
+    }
+    /* |s| < 2^252 < l now: make the limbs non-negative */
+    for (j = 0; j < 11; j++) {
+        carry = s[j] >> 21;
+        s[j + 1] += carry;
+        s[j] -= carry * (1 << 21);
+    }
+    /* add l if the result is negative */
+    mask = s[11] >> 63;
+    for (j = 0; j < 6; j++)
+        s[j] += k25519l0[j] & mask;
+    s[12] = 1 & mask;
+    for (j = 0; j < 12; j++) {
+        carry = s[j] >> 21;
+        s[j + 1] += carry;
+        s[j] -= carry * (1 << 21);
+    }
+
+    /* 13 limbs hold 273 bits, more than the 32 bytes to fill */
+    acc = 0;
+    bits = 0;
+    k = 0;
+    for (j = 0; j < 13; j++) {
+        acc |= (unsigned long long)s[j] << bits;
+        bits += 21;
+        while (bits >= 8 && k < 32) {
+            out[k++] = (unsigned char)acc;
+            acc >>= 8;
+            bits -= 8;
+        }
+    }
+}
+
+/* s = s mod l where s is 64 bytes; the result is in the first 32 bytes */
+static void sc_reduce(unsigned char s[64])
+{
+    i64 t[25];
+
+    sc_load(t, 25, s, 64);
+    sc_reduce_limbs(s, t);
+    OPENSSL_cleanse(t, sizeof(t));
+}
+
+/* s = a * b + c mod l, for a, b and c below 2^256 */
+static void sc_muladd(unsigned char s[32], const unsigned char a[32],
+                      const unsigned char b[32], const unsigned char c[32])
+{
+    i64 al[13], bl[13], t[25], carry;
+    int i, j;
+
+    sc_load(al, 13, a, 32);
+    sc_load(bl, 13, b, 32);
+    sc_load(t, 25, c, 32);
+    for (i = 0; i < 13; i++)
+        for (j = 0; j < 13; j++)
+            t[i + j] += al[i] * bl[j];
+    for (i = 0; i < 24; i++) {
+        carry = t[i] >> 21;
+        t[i + 1] += carry;
+        t[i] -= carry * (1 << 21);
+    }
+    sc_reduce_limbs(s, t);
+    OPENSSL_cleanse(al, sizeof(al));
+    OPENSSL_cleanse(bl, sizeof(bl));
+    OPENSSL_cleanse(t, sizeof(t));
+}
+
+/* Returns 1 if s < l, as RFC 8032 requires of the S half of a signature */
+static int sc_is_canonical(const unsigned char s[32])
+{
+    int i;
+
+    for (i = 31; i >= 0; i--) {
+        if (s[i] < k25519l[i])
+            return 1;
+        if (s[i] > k25519l[i])
+            return 0;
+    }
+    return 0;
+}
+
+static void ed25519_expand(unsigned char az[64],
+                           const unsigned char private_key[32])
+{
+    SHA512(private_key, 32, az);
+    az[0] &= 248;
+    az[31] &= 63;
+    az[31] |= 64;
+}
+
+void ED25519_public_from_private(unsigned char out_public_key[32],
+                                 const unsigned char private_key[32])
+{
+    unsigned char az[SHA512_DIGEST_LENGTH];
+    ge_p3 A;
+
+    ed25519_expand(az, private_key);
+    ge_scalarmult_base(&A, az);
+    ge_p3_tobytes(out_public_key, &A);
+    OPENSSL_cleanse(az, sizeof(az));
+}
+
+int ED25519_sign(unsigned char *out_sig, const unsigned char *message,
+                 size_t message_len, const unsigned char public_key[32],
+                 const unsigned char private_key[32])
+{
+    unsigned char az[SHA512_DIGEST_LENGTH];
+    unsigned char nonce[SHA512_DIGEST_LENGTH];
+    unsigned char hram[SHA512_DIGEST_LENGTH];
+    SHA512_CTX hash_ctx;
+    ge_p3 R;
+
+    ed25519_expand(az, private_key);
+
+    SHA512_Init(&hash_ctx);
+    SHA512_Update(&hash_ctx, az + 32, 32);
+    SHA512_Update(&hash_ctx, message, message_len);
+    SHA512_Final(nonce, &hash_ctx);
+    sc_reduce(nonce);
+
+    ge_scalarmult_base(&R, nonce);
+    ge_p3_tobytes(out_sig, &R);
+
+    SHA512_Init(&hash_ctx);
+    SHA512_Update(&hash_ctx, out_sig, 32);
+    SHA512_Update(&hash_ctx, public_key, 32);
+    SHA512_Update(&hash_ctx, message, message_len);
+    SHA512_Final(hram, &hash_ctx);
+    sc_reduce(hram);
+
+    sc_muladd(out_sig + 32, hram, az, nonce);
+
+    OPENSSL_cleanse(&hash_ctx, sizeof(hash_ctx));
+    OPENSSL_cleanse(az, sizeof(az));
+    OPENSSL_cleanse(nonce, sizeof(nonce));
+    return 1;
+}
+
+/*
+ * Decode the parts of a signature and work out k = H(R || A || M) mod l.
+ * A and R are returned negated, ready to be subtracted.
+ */
+static int ed25519_prepare(ge_p3 *A, ge_p3 *R, unsigned char k[64],
+                           const unsigned char *message, size_t message_len,
+                           const unsigned char signature[64],
+                           const unsigned char public_key[32])
+{
+    SHA512_CTX hash_ctx;
+
+    if (!sc_is_canonical(signature + 32)
+        || !ge_frombytes_vartime(A, public_key)
+        || !ge_frombytes_vartime(R, signature))
+        return 0;
+    ge_p3_neg(A);
+    ge_p3_neg(R);
+
+    SHA512_Init(&hash_ctx);
+    SHA512_Update(&hash_ctx, signature, 32);
+    SHA512_Update(&hash_ctx, public_key, 32);
+    SHA512_Update(&hash_ctx, message, message_len);
+    SHA512_Final(k, &hash_ctx);
+    sc_reduce(k);
+    return 1;
+}
+
+/*
+ * The check is the cofactored equation [8][S]B = [8]R + [8][k]A of RFC 8032,
+ * section 5.1.7, so that it agrees exactly with ED25519_verify_batch().
+ */
+int ED25519_verify(const unsigned char *message, size_t message_len,
+                   const unsigned char signature[64],
+                   const unsigned char public_key[32])
+{
+    unsigned char k[SHA512_DIGEST_LENGTH];
+    ge_term term;
+    ge_cached rc;
+    ge_p3 A, R, h;
+    ge_p1p1 t;
+
+    if (!ed25519_prepare(&A, &R, k, message, message_len, signature,
+                         public_key))
+        return 0;
+
+    /* h = [S]B - [k]A - R */
+    ge_term_init(&term, &A, k);
+    ge_multi_scalarmult_vartime(&h, signature + 32, &term, 1);
+    ge_p3_to_cached(&rc, &R);
+    ge_add(&t, &h, &rc);
+    ge_p1p1_to_p3(&h, &t);
+
+    return ge_is_small_order_multiple(&h);
+}
+
+/* Signatures checked with one multi-scalar multiplication */
+#define ED25519_BATCH_CHUNK 64
+
+/*
+ * Check the signatures in |idx| at once: with random 128-bit z_i, compute
+ * [sum z_i S_i]B - sum [z_i]R_i - sum [z_i k_i]A_i, which is of small
+ * order for valid signatures and, except with probability 2^-128, is not
+ * if any of them is invalid. Returns 1 if all are valid, 0 if at least one
+ * is not and -1 if the check could not be done.
+ */
+static int ed25519_verify_chunk(const size_t *idx, size_t n,
+                                const unsigned char *const *message,
+                                const size_t *message_len,
+                                const unsigned char *const *signature,
+                                const unsigned char *const *public_key)
+{
+    unsigned char z[ED25519_BATCH_CHUNK][32];
+    static const unsigned char zero[32] = { 0 };
+    unsigned char k[SHA512_DIGEST_LENGTH], zk[32], s[32];
+    ge_term *terms;
+    ge_p3 A, R, h;
+    size_t i;
+    int ret = 0;
+
+    terms = OPENSSL_malloc(2 * n * sizeof(*terms));
+    if (terms == NULL)
+        return -1;
+
+    memset(z, 0, sizeof(z));
+    if (RAND_bytes(&z[0][0], sizeof(z)) <= 0) {
+        ret = -1;
+        goto err;
+    }
+
+    memset(s, 0, sizeof(s));
+    for (i = 0; i < n; i++) {
+        memset(z[i] + 16, 0, 16);
+        if (!ed25519_prepare(&A, &R, k, message[idx[i]],
+                             message_len[idx[i]], signature[idx[i]],
+                             public_key[idx[i]]))
+            goto err;
+        sc_muladd(s, z[i], signature[idx[i]] + 32, s);
+        sc_muladd(zk, z[i], k, zero);
+        ge_term_init(&terms[2 * i], &R, z[i]);
+        ge_term_init(&terms[2 * i + 1], &A, zk);
+    }
+
+    ge_multi_scalarmult_vartime(&h, s, terms, 2 * n);
+    ret = ge_is_small_order_multiple(&h);
+
+ err:
+    OPENSSL_free(terms);
+    return ret;
+}
+
+int ED25519_verify_batch(size_t num, const unsigned char *const *message,
+                         const size_t *message_len,
+                         const unsigned char *const *signature,
+                         const unsigned char *const *public_key, int *ret)
+{
+    size_t idx[ED25519_BATCH_CHUNK];
+    size_t i, j, n;
+    int all = 1;
+
+    for (i = 0; i < num; i += n) {
+        n = num - i;
+        if (n > ED25519_BATCH_CHUNK)
+            n = ED25519_BATCH_CHUNK;
+        for (j = 0; j < n; j++)
+            idx[j] = i + j;
+
+        if (n > 1 && ed25519_verify_chunk(idx, n, message, message_len,
+                                          signature, public_key) == 1) {
+            for (j = 0; j < n; j++)
+                ret[i + j] = 1;
+            continue;
+        }
+
+        /* find out which failed, or do without the batch check */
+        for (j = i; j < i + n; j++) {
+            ret[j] = ED25519_verify(message[j], message_len[j], signature[j],
+                                    public_key[j]);
+            if (ret[j] != 1)
+                all = 0;
+        }
+    }
+    return all;
+}
@@ -2850,8 +2850,13 @@ static const ec_list_element curve_list[] = {
     {NID_secp256k1, &_EC_SECG_PRIME_256K1.h, 0,
      "SECG curve over a 256 bit prime field"},
     /* SECG secp256r1 is the same as X9.62 prime256v1 and hence omitted */
+#ifndef OPENSSL_NO_EC_NISTP_64_GCC_128
+    {NID_secp384r1, &_EC_NIST_PRIME_384.h, EC_GFp_nistp384_method,
+     "NIST/SECG curve over a 384 bit prime field"},
+#else
     {NID_secp384r1, &_EC_NIST_PRIME_384.h, 0,
      "NIST/SECG curve over a 384 bit prime field"},
+#endif
 #ifndef OPENSSL_NO_EC_NISTP_64_GCC_128
     {NID_secp521r1, &_EC_NIST_PRIME_521.h, EC_GFp_nistp521_method,
      "NIST/SECG curve over a 521 bit prime field"},
@@ -3132,6 +3137,101 @@ static EC_GROUP *ec_group_new_from_data(const ec_list_element curve)
     return group;
 }
 
+/*
+ * Fully set up groups for the entries of curve_list, built the first time
+ * a curve is asked for. They are never handed out or modified, only
+ * copied: EC_GROUP_dup() shares the generator precomputation by reference
+ * and copies the rest from parameters that are already decoded.
+ */
+static EC_GROUP *curve_cache[curve_list_length];
+
+static EC_GROUP *ec_group_new_cached(size_t i)
+{
+    EC_GROUP *group, *ret;
+
+    CRYPTO_r_lock(CRYPTO_LOCK_EC);
+    group = curve_cache[i];
+    CRYPTO_r_unlock(CRYPTO_LOCK_EC);
+    if (group != NULL)
+        return EC_GROUP_dup(group);
+
+    /* The cached groups live until the process exits: not a leak */
+    MemCheck_off();
+    group = ec_group_new_from_data(curve_list[i]);
+    if (group != NULL) {
+        EC_GROUP_set_curve_name(group, curve_list[i].nid);
+        /*
+         * Methods with a built-in table for the standard generator report
+         * it as precomputed already.
+         */
+        if (!EC_GROUP_have_precompute_mult(group)
+            && !EC_GROUP_precompute_mult(group, NULL))
+            ERR_clear_error();
+    }
+    MemCheck_on();
+    if (group == NULL)
+        return NULL;
+
+    CRYPTO_w_lock(CRYPTO_LOCK_EC);
+    if (curve_cache[i] == NULL) {
+        curve_cache[i] = group;
+        group = NULL;
+    }
+    ret = curve_cache[i];
+    CRYPTO_w_unlock(CRYPTO_LOCK_EC);
+    /* Another thread got there first */
+    EC_GROUP_free(group);
+    return EC_GROUP_dup(ret);
+}
+
+/*
+ * Build the cached group for |nid| now, with the generator precomputation
+ * taken from |buf| instead of being computed. Must be called before the
+ * curve is first used; |buf| must stay valid until the process exits.
+ */
+int EC_curve_set_precompute_mult_data(int nid, const unsigned char *buf,
+                                      size_t len)
+{
+    size_t i;
+    EC_GROUP *group;
+    int ret = 0;
+
+    for (i = 0; i < curve_list_length; i++)
+        if (curve_list[i].nid == nid)
+            break;
+    if (i == curve_list_length) {
+        ECerr(EC_F_EC_CURVE_SET_PRECOMPUTE_MULT_DATA, EC_R_UNKNOWN_GROUP);
+        return 0;
+    }
+
+    /* As in ec_group_new_cached(), the result lives until exit */
+    MemCheck_off();
+    group = ec_group_new_from_data(curve_list[i]);
+    if (group != NULL) {
+        EC_GROUP_set_curve_name(group, nid);
+        ret = EC_GROUP_set_precompute_mult_data(group, buf, len, NULL);
+    }
+    MemCheck_on();
+    if (!ret) {
+        EC_GROUP_free(group);
+        return 0;
+    }
+
+    CRYPTO_w_lock(CRYPTO_LOCK_EC);
+    if (curve_cache[i] == NULL) {
+        curve_cache[i] = group;
+        group = NULL;
+    }
+    CRYPTO_w_unlock(CRYPTO_LOCK_EC);
+    if (group != NULL) {
+        /* Too late: the curve has been used already */
+        ECerr(EC_F_EC_CURVE_SET_PRECOMPUTE_MULT_DATA, EC_R_SLOT_FULL);
+        EC_GROUP_free(group);
+        return 0;
+    }
+    return 1;
+}
+
 EC_GROUP *EC_GROUP_new_by_curve_name(int nid)
 {
     size_t i;
@@ -3142,7 +3242,7 @@ EC_GROUP *EC_GROUP_new_by_curve_name(int nid)
 
     for (i = 0; i < curve_list_length; i++)
         if (curve_list[i].nid == nid) {
-            ret = ec_group_new_from_data(curve_list[i]);
+            ret = ec_group_new_cached(i);
             break;
         }
 
@@ -3151,8 +3251,6 @@ EC_GROUP *EC_GROUP_new_by_curve_name(int nid)
         return NULL;
     }
 
-    EC_GROUP_set_curve_name(ret, nid);
-
     return ret;
 }
 
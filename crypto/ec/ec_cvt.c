@@ -107,6 +107,12 @@ EC_GROUP *EC_GROUP_new_curve_GFp(const BIGNUM *p, const BIGNUM *a,
     else
         meth = EC_GFp_mont_method();
 #endif
+    /*
+     * The fixed-width variant of the Montgomery method does the point
+     * arithmetic without BIGNUM calls for the common field sizes.
+     */
+    if (meth == EC_GFp_mont_method() && ec_GFp_fixed_supported(p))
+        meth = EC_GFp_fixed_method();
 
     ret = EC_GROUP_new(meth);
     if (ret == NULL)
@@ -313,6 +313,10 @@ int ec_wNAF_mul(const EC_GROUP *group, EC_POINT *r, const BIGNUM *scalar,
                 BN_CTX *);
 int ec_wNAF_precompute_mult(EC_GROUP *group, BN_CTX *);
 int ec_wNAF_have_precompute_mult(const EC_GROUP *group);
+size_t ec_wNAF_get_precompute_data(const EC_GROUP *group, unsigned char *buf,
+                                   size_t len, BN_CTX *ctx);
+int ec_wNAF_set_precompute_data(EC_GROUP *group, const unsigned char *buf,
+                                size_t len, BN_CTX *ctx);
 
 /* method functions in ecp_smpl.c */
 int ec_GFp_simple_group_init(EC_GROUP *);
@@ -386,6 +390,17 @@ int ec_GFp_mont_field_decode(const EC_GROUP *, BIGNUM *r, const BIGNUM *a,
                              BN_CTX *);
 int ec_GFp_mont_field_set_to_one(const EC_GROUP *, BIGNUM *r, BN_CTX *);
 
+/* method functions in ecp_fixed.c */
+int ec_GFp_fixed_supported(const BIGNUM *p);
+int ec_GFp_fixed_add(const EC_GROUP *, EC_POINT *r, const EC_POINT *a,
+                     const EC_POINT *b, BN_CTX *);
+int ec_GFp_fixed_dbl(const EC_GROUP *, EC_POINT *r, const EC_POINT *a,
+                     BN_CTX *);
+int ec_GFp_fixed_field_mul(const EC_GROUP *, BIGNUM *r, const BIGNUM *a,
+                           const BIGNUM *b, BN_CTX *);
+int ec_GFp_fixed_field_sqr(const EC_GROUP *, BIGNUM *r, const BIGNUM *a,
+                           BN_CTX *);
+
 /* method functions in ecp_nist.c */
 int ec_GFp_nist_group_copy(EC_GROUP *dest, const EC_GROUP *src);
 int ec_GFp_nist_group_set_curve(EC_GROUP *, const BIGNUM *p, const BIGNUM *a,
@@ -502,6 +517,22 @@ int ec_GFp_nistp256_points_mul(const EC_GROUP *group, EC_POINT *r,
 int ec_GFp_nistp256_precompute_mult(EC_GROUP *group, BN_CTX *ctx);
 int ec_GFp_nistp256_have_precompute_mult(const EC_GROUP *group);
 
+/* method functions in ecp_nistp384.c */
+int ec_GFp_nistp384_group_init(EC_GROUP *group);
+int ec_GFp_nistp384_group_set_curve(EC_GROUP *group, const BIGNUM *p,
+                                    const BIGNUM *a, const BIGNUM *n,
+                                    BN_CTX *);
+int ec_GFp_nistp384_point_get_affine_coordinates(const EC_GROUP *group,
+                                                 const EC_POINT *point,
+                                                 BIGNUM *x, BIGNUM *y,
+                                                 BN_CTX *ctx);
+int ec_GFp_nistp384_points_mul(const EC_GROUP *group, EC_POINT *r,
+                               const BIGNUM *scalar, size_t num,
+                               const EC_POINT *points[],
+                               const BIGNUM *scalars[], BN_CTX *ctx);
+int ec_GFp_nistp384_precompute_mult(EC_GROUP *group, BN_CTX *ctx);
+int ec_GFp_nistp384_have_precompute_mult(const EC_GROUP *group);
+
 /* method functions in ecp_nistp521.c */
 int ec_GFp_nistp521_group_init(EC_GROUP *group);
 int ec_GFp_nistp521_group_set_curve(EC_GROUP *group, const BIGNUM *p,
@@ -550,6 +581,8 @@ void ec_GFp_nistp_points_make_affine_internal(size_t num, void *point_array,
                                                                       *in));
 void ec_GFp_nistp_recode_scalar_bits(unsigned char *sign,
                                      unsigned char *digit, unsigned char in);
+void ec_GFp_nistp_mod_inverse(unsigned char *out, const unsigned char *in,
+                              const unsigned char *p, size_t len);
 #endif
 int ec_precompute_mont_data(EC_GROUP *);
 
@@ -560,3 +593,29 @@ int ec_precompute_mont_data(EC_GROUP *);
  */
 const EC_METHOD *EC_GFp_nistz256_method(void);
 #endif
+
+/* X25519 key agreement, RFC 7748 */
+int X25519(unsigned char out_shared_key[32],
+           const unsigned char private_key[32],
+           const unsigned char peer_public_value[32]);
+void X25519_public_from_private(unsigned char out_public_value[32],
+                                const unsigned char private_key[32]);
+
+/* Ed25519 signatures, RFC 8032 */
+void ED25519_public_from_private(unsigned char out_public_key[32],
+                                 const unsigned char private_key[32]);
+int ED25519_sign(unsigned char *out_sig, const unsigned char *message,
+                 size_t message_len, const unsigned char public_key[32],
+                 const unsigned char private_key[32]);
+int ED25519_verify(const unsigned char *message, size_t message_len,
+                   const unsigned char signature[64],
+                   const unsigned char public_key[32]);
+/*
+ * Check |num| signatures, the i-th being |signature[i]| over the
+ * |message_len[i]| bytes at |message[i]| with |public_key[i]|, and store
+ * the result of each in |ret[i]|. Returns 1 if all are valid.
+ */
+int ED25519_verify_batch(size_t num, const unsigned char *const *message,
+                         const size_t *message_len,
+                         const unsigned char *const *signature,
+                         const unsigned char *const *public_key, int *ret);
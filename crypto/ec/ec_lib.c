@@ -1091,6 +1091,32 @@ int EC_GROUP_have_precompute_mult(const EC_GROUP *group)
                                  * been performed */
 }
 
+size_t EC_GROUP_get_precompute_mult_data(const EC_GROUP *group,
+                                         unsigned char *buf, size_t len,
+                                         BN_CTX *ctx)
+{
+    if (group->meth->mul == 0)
+        /* use default */
+        return ec_wNAF_get_precompute_data(group, buf, len, ctx);
+
+    ECerr(EC_F_EC_GROUP_GET_PRECOMPUTE_MULT_DATA,
+          ERR_R_SHOULD_NOT_HAVE_BEEN_CALLED);
+    return 0;
+}
+
+int EC_GROUP_set_precompute_mult_data(EC_GROUP *group,
+                                      const unsigned char *buf, size_t len,
+                                      BN_CTX *ctx)
+{
+    if (group->meth->mul == 0)
+        /* use default */
+        return ec_wNAF_set_precompute_data(group, buf, len, ctx);
+
+    ECerr(EC_F_EC_GROUP_SET_PRECOMPUTE_MULT_DATA,
+          ERR_R_SHOULD_NOT_HAVE_BEEN_CALLED);
+    return 0;
+}
+
 /*
  * ec_precompute_mont_data sets |group->mont_data| from |group->order| and
  * returns one on success. On error it returns zero.
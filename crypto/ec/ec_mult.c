@@ -85,6 +85,8 @@ typedef struct ec_pre_comp_st {
                                  * generator: 'num' pointers to EC_POINT
                                  * objects followed by a NULL */
     size_t num;                 /* numblocks * 2^(w-1) */
+    const unsigned char *data;  /* external table the point coordinates
+                                 * refer to, or NULL if they are our own */
     int references;
 } EC_PRE_COMP;
 
@@ -111,6 +113,7 @@ static EC_PRE_COMP *ec_pre_comp_new(const EC_GROUP *group)
     ret->w = 4;                 /* default */
     ret->points = NULL;
     ret->num = 0;
+    ret->data = NULL;
     ret->references = 1;
     return ret;
 }
@@ -164,7 +167,15 @@ static void ec_pre_comp_clear_free(void *pre_)
         EC_POINT **p;
 
         for (p = pre->points; *p != NULL; p++) {
-            EC_POINT_clear_free(*p);
+            /*
+             * Points imported from an external table refer to (possibly
+             * read-only) memory we do not own; the table holds nothing
+             * but public multiples of the generator anyway.
+             */
+            if (pre->data != NULL)
+                EC_POINT_free(*p);
+            else
+                EC_POINT_clear_free(*p);
             OPENSSL_cleanse(p, sizeof *p);
         }
         OPENSSL_free(pre->points);
@@ -772,3 +783,278 @@ int ec_wNAF_have_precompute_mult(const EC_GROUP *group)
     else
         return 0;
 }
+
+/*-
+ * Serialised precomputation tables.
+ *
+ * The table produced by ec_wNAF_get_precompute_data() is an array of
+ * native BN_ULONG words, so it can be generated once, stored in a file
+ * and later mapped read-only and shared by any number of processes and
+ * EC_GROUP objects.  With fw the number of words in the field modulus it
+ * consists of:
+ *
+ *   EC_PRE_COMP_HDR words:   magic, BN_BITS2, fw, blocksize, numblocks, w
+ *   EC_PRE_COMP_PARAMS * fw: p, a, b, x(generator), y(generator) and the
+ *                            field encoding of 1, identifying the group
+ *                            and its field representation
+ *   num * 2 * fw words:      the encoded affine x and y coordinates of the
+ *                            precomputed points
+ *
+ * All values are little-endian word arrays zero-padded to fw words.  The
+ * format is therefore specific to the word size, byte order and EC_METHOD
+ * field encoding of the machine that created it; all three are checked on
+ * import.
+ */
+#define EC_PRE_COMP_MAGIC       0x45435731 /* "ECW1" */
+#define EC_PRE_COMP_HDR         6
+#define EC_PRE_COMP_PARAMS      6
+
+static size_t ec_pre_comp_words(size_t fw, size_t num)
+{
+    return EC_PRE_COMP_HDR + (EC_PRE_COMP_PARAMS + 2 * num) * fw;
+}
+
+/* Write the identifying parameters of |group| to |out| (fw words each). */
+static int ec_pre_comp_params(const EC_GROUP *group, BN_ULONG *out, int fw,
+                              BN_CTX *ctx)
+{
+    const EC_POINT *generator;
+    BIGNUM *v[EC_PRE_COMP_PARAMS];
+    int i, ret = 0;
+
+    generator = EC_GROUP_get0_generator(group);
+    if (generator == NULL) {
+        ECerr(EC_F_EC_PRE_COMP_PARAMS, EC_R_UNDEFINED_GENERATOR);
+        return 0;
+    }
+
+    BN_CTX_start(ctx);
+    for (i = 0; i < EC_PRE_COMP_PARAMS; i++)
+        if ((v[i] = BN_CTX_get(ctx)) == NULL)
+            goto err;
+
+    if (!EC_GROUP_get_curve_GFp(group, v[0], v[1], v[2], ctx)
+        || !EC_POINT_get_affine_coordinates_GFp(group, generator, v[3], v[4],
+                                                ctx))
+        goto err;
+    if (group->meth->field_set_to_one != 0) {
+        if (!group->meth->field_set_to_one(group, v[5], ctx))
+            goto err;
+    } else if (!BN_one(v[5]))
+        goto err;
+
+    for (i = 0; i < EC_PRE_COMP_PARAMS; i++) {
+        if (!bn_copy_words(out + i * fw, v[i], fw)) {
+            ECerr(EC_F_EC_PRE_COMP_PARAMS, ERR_R_INTERNAL_ERROR);
+            goto err;
+        }
+    }
+    ret = 1;
+ err:
+    BN_CTX_end(ctx);
+    return ret;
+}
+
+size_t ec_wNAF_get_precompute_data(const EC_GROUP *group, unsigned char *buf,
+                                   size_t len, BN_CTX *ctx)
+{
+    const EC_PRE_COMP *pre_comp;
+    BN_CTX *new_ctx = NULL;
+    BN_ULONG *tmp = NULL;
+    size_t i, fw, total;
+    unsigned char *p;
+    size_t ret = 0;
+
+    pre_comp = EC_EX_DATA_get_data(group->extra_data, ec_pre_comp_dup,
+                                   ec_pre_comp_free, ec_pre_comp_clear_free);
+    if (pre_comp == NULL || pre_comp->numblocks == 0) {
+        ECerr(EC_F_EC_WNAF_GET_PRECOMPUTE_DATA, EC_R_NOT_INITIALIZED);
+        return 0;
+    }
+
+    fw = bn_get_top(group->field);
+    total = ec_pre_comp_words(fw, pre_comp->num) * sizeof(BN_ULONG);
+    if (buf == NULL)
+        return total;
+    if (len < total) {
+        ECerr(EC_F_EC_WNAF_GET_PRECOMPUTE_DATA, EC_R_BUFFER_TOO_SMALL);
+        return 0;
+    }
+
+    if (ctx == NULL) {
+        ctx = new_ctx = BN_CTX_new();
+        if (ctx == NULL)
+            return 0;
+    }
+
+    /*
+     * |buf| need not be word aligned, so everything is assembled in |tmp|
+     * and copied out with memcpy.
+     */
+    tmp = OPENSSL_malloc(EC_PRE_COMP_PARAMS * fw * sizeof(BN_ULONG));
+    if (tmp == NULL) {
+        ECerr(EC_F_EC_WNAF_GET_PRECOMPUTE_DATA, ERR_R_MALLOC_FAILURE);
+        goto err;
+    }
+
+    tmp[0] = EC_PRE_COMP_MAGIC;
+    tmp[1] = BN_BITS2;
+    tmp[2] = fw;
+    tmp[3] = pre_comp->blocksize;
+    tmp[4] = pre_comp->numblocks;
+    tmp[5] = pre_comp->w;
+    p = buf;
+    memcpy(p, tmp, EC_PRE_COMP_HDR * sizeof(BN_ULONG));
+    p += EC_PRE_COMP_HDR * sizeof(BN_ULONG);
+
+    if (!ec_pre_comp_params(group, tmp, fw, ctx))
+        goto err;
+    memcpy(p, tmp, EC_PRE_COMP_PARAMS * fw * sizeof(BN_ULONG));
+    p += EC_PRE_COMP_PARAMS * fw * sizeof(BN_ULONG);
+
+    for (i = 0; i < pre_comp->num; i++) {
+        const EC_POINT *point = pre_comp->points[i];
+
+        if (!point->Z_is_one
+            || !bn_copy_words(tmp, point->X, fw)
+            || !bn_copy_words(tmp + fw, point->Y, fw)) {
+            ECerr(EC_F_EC_WNAF_GET_PRECOMPUTE_DATA, ERR_R_INTERNAL_ERROR);
+            goto err;
+        }
+        memcpy(p, tmp, 2 * fw * sizeof(BN_ULONG));
+        p += 2 * fw * sizeof(BN_ULONG);
+    }
+
+    ret = total;
+ err:
+    OPENSSL_free(tmp);
+    BN_CTX_free(new_ctx);
+    return ret;
+}
+
+/*
+ * Install the table in |buf| (as written by ec_wNAF_get_precompute_data())
+ * as the precomputation for |group|.  The table is used in place: |buf| must
+ * be aligned for BN_ULONG access, and must remain valid and unchanged for as
+ * long as |group| or any EC_GROUP duplicated from it exists.
+ */
+int ec_wNAF_set_precompute_data(EC_GROUP *group, const unsigned char *buf,
+                                size_t len, BN_CTX *ctx)
+{
+    const BN_ULONG *in = (const BN_ULONG *)buf;
+    const BN_ULONG *one;
+    BN_CTX *new_ctx = NULL;
+    BN_ULONG *params = NULL;
+    EC_PRE_COMP *pre_comp = NULL;
+    EC_POINT **points = NULL;
+    size_t i, fw, w, blocksize, numblocks, num;
+    int ret = 0;
+
+    fw = bn_get_top(group->field);
+    if (((size_t)buf & (sizeof(BN_ULONG) - 1)) != 0
+        || len < EC_PRE_COMP_HDR * sizeof(BN_ULONG)
+        || in[0] != EC_PRE_COMP_MAGIC || in[1] != BN_BITS2 || in[2] != fw) {
+        ECerr(EC_F_EC_WNAF_SET_PRECOMPUTE_DATA, EC_R_INVALID_ENCODING);
+        return 0;
+    }
+
+    blocksize = in[3];
+    numblocks = in[4];
+    w = in[5];
+    if (blocksize <= 2 || blocksize > BN_BITS2 || w < 1 || w > 8
+        || numblocks == 0
+        || numblocks > (size_t)BN_num_bits(group->order) + 1) {
+        ECerr(EC_F_EC_WNAF_SET_PRECOMPUTE_DATA, EC_R_INVALID_ENCODING);
+        return 0;
+    }
+    num = numblocks << (w - 1);
+    if (len != ec_pre_comp_words(fw, num) * sizeof(BN_ULONG)) {
+        ECerr(EC_F_EC_WNAF_SET_PRECOMPUTE_DATA, EC_R_INVALID_ENCODING);
+        return 0;
+    }
+
+    if (ctx == NULL) {
+        ctx = new_ctx = BN_CTX_new();
+        if (ctx == NULL)
+            return 0;
+    }
+
+    params = OPENSSL_malloc(EC_PRE_COMP_PARAMS * fw * sizeof(BN_ULONG));
+    if (params == NULL) {
+        ECerr(EC_F_EC_WNAF_SET_PRECOMPUTE_DATA, ERR_R_MALLOC_FAILURE);
+        goto err;
+    }
+    if (!ec_pre_comp_params(group, params, fw, ctx))
+        goto err;
+    in += EC_PRE_COMP_HDR;
+    if (memcmp(in, params, EC_PRE_COMP_PARAMS * fw * sizeof(BN_ULONG)) != 0) {
+        ECerr(EC_F_EC_WNAF_SET_PRECOMPUTE_DATA, EC_R_INCOMPATIBLE_OBJECTS);
+        goto err;
+    }
+    one = in + (EC_PRE_COMP_PARAMS - 1) * fw;
+    in += EC_PRE_COMP_PARAMS * fw;
+
+    if ((pre_comp = ec_pre_comp_new(group)) == NULL)
+        goto err;
+    points = OPENSSL_malloc(sizeof(EC_POINT *) * (num + 1));
+    if (points == NULL) {
+        ECerr(EC_F_EC_WNAF_SET_PRECOMPUTE_DATA, ERR_R_MALLOC_FAILURE);
+        goto err;
+    }
+    for (i = 0; i <= num; i++)
+        points[i] = NULL;
+
+    for (i = 0; i < num; i++, in += 2 * fw) {
+        EC_POINT *point;
+
+        if ((point = points[i] = EC_POINT_new(group)) == NULL)
+            goto err;
+        bn_set_static_words(point->X, (BN_ULONG *)in, fw);
+        bn_correct_top(point->X);
+        bn_set_static_words(point->Y, (BN_ULONG *)(in + fw), fw);
+        bn_correct_top(point->Y);
+        bn_set_static_words(point->Z, (BN_ULONG *)one, fw);
+        bn_correct_top(point->Z);
+        point->Z_is_one = 1;
+
+        /*
+         * The table is not recomputed, but a damaged or foreign file must
+         * not silently produce wrong results: every point has to be on the
+         * curve, and the first one has to be the generator.
+         */
+        if (EC_POINT_is_on_curve(group, point, ctx) <= 0
+            || (i == 0
+                && EC_POINT_cmp(group, point, group->generator, ctx) != 0)) {
+            ECerr(EC_F_EC_WNAF_SET_PRECOMPUTE_DATA, EC_R_INVALID_ENCODING);
+            goto err;
+        }
+    }
+
+    pre_comp->blocksize = blocksize;
+    pre_comp->numblocks = numblocks;
+    pre_comp->w = w;
+    pre_comp->points = points;
+    points = NULL;
+    pre_comp->num = num;
+    pre_comp->data = buf;
+
+    EC_EX_DATA_free_data(&group->extra_data, ec_pre_comp_dup,
+                         ec_pre_comp_free, ec_pre_comp_clear_free);
+    if (!EC_EX_DATA_set_data(&group->extra_data, pre_comp,
+                             ec_pre_comp_dup, ec_pre_comp_free,
+                             ec_pre_comp_clear_free))
+        goto err;
+    pre_comp = NULL;
+
+    ret = 1;
+ err:
+    if (points != NULL) {
+        for (i = 0; i < num; i++)
+            EC_POINT_free(points[i]);
+        OPENSSL_free(points);
+    }
+    ec_pre_comp_free(pre_comp);
+    OPENSSL_free(params);
+    BN_CTX_free(new_ctx);
+    return ret;
+}
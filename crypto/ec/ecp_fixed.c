@@ -0,0 +1,556 @@
+/* crypto/ec/ecp_fixed.c */
+/* ====================================================================
+ * Copyright (c) 2015 The OpenSSL Project.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. All advertising materials mentioning features or use of this
+ *    software must display the following acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit. (http://www.openssl.org/)"
+ *
+ * 4. The names "OpenSSL Toolkit" and "OpenSSL Project" must not be used to
+ *    endorse or promote products derived from this software without
+ *    prior written permission. For written permission, please contact
+ *    openssl-core@openssl.org.
+ *
+ * 5. Products derived from this software may not be called "OpenSSL"
+ *    nor may "OpenSSL" appear in their names without prior written
+ *    permission of the OpenSSL Project.
+ *
+ * 6. Redistributions of any form whatsoever must retain the following
+ *    acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit (http://www.openssl.org/)"
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE OpenSSL PROJECT ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE OpenSSL PROJECT OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ====================================================================
+ */
+
+/*
+ * The Montgomery method with fixed-width field arithmetic.
+ *
+ * EC_GFp_fixed_method() shares the group setup and the representation of
+ * points with EC_GFp_mont_method(): coordinates are BIGNUMs in Montgomery
+ * form with R = 2^(num*BN_BITS2), num being the word count of p. Point
+ * addition and doubling, which is where scalar multiplication spends its
+ * time, load the coordinates into arrays of a size fixed at compile time,
+ * do all the field arithmetic there without BN_CTX or BIGNUM calls and
+ * store the result back. The point functions are instantiated for fields
+ * of 256, 320, 384 and 512 bits (after rounding up to whole words); other
+ * sizes use the ec_GFp_simple_* functions.
+ */
+
+#include <string.h>
+#include <openssl/err.h>
+
+#include "cryptlib.h"
+#include "internal/bn_int.h"
+#include "ec_lcl.h"
+
+#define FIXED_MAX_WORDS BN_MONT_FIXED_MAX_WORDS
+
+typedef BN_ULONG fe[FIXED_MAX_WORDS];
+
+/* fe_load sets |out| to the |num|-word value of |in|, which is less than p */
+static inline void fe_load(BN_ULONG *out, const BIGNUM *in, int num)
+{
+    bn_copy_words(out, in, num);
+}
+
+static inline int fe_store(BIGNUM *out, const BN_ULONG *in, int num)
+{
+    if (bn_wexpand(out, num) == NULL)
+        return 0;
+    memcpy(bn_get_words(out), in, num * sizeof(BN_ULONG));
+    bn_set_top(out, num);
+    bn_correct_top(out);
+    return 1;
+}
+
+static inline int fe_is_zero(const BN_ULONG *in, int num)
+{
+    BN_ULONG acc = 0;
+    int i;
+
+    for (i = 0; i < num; i++)
+        acc |= in[i];
+    return acc == 0;
+}
+
+/*
+ * fe_reduce_once sets |r| to |r| - p if |carry|*2^(num*BN_BITS2) + |r| is
+ * at least p, where that value is less than 2p.
+ */
+static inline void fe_reduce_once(BN_ULONG *r, BN_ULONG carry,
+                                  const BN_ULONG *p, int num)
+{
+    BN_ULONG t[FIXED_MAX_WORDS], borrow = 0, mask;
+    int i;
+
+    for (i = 0; i < num; i++) {
+        t[i] = (r[i] - p[i] - borrow) & BN_MASK2;
+        borrow = (r[i] < p[i]) | ((r[i] == p[i]) & borrow);
+    }
+    /* keep |r| if the subtraction borrowed and there was no carry */
+    mask = 0 - (borrow & (carry ^ 1));
+    for (i = 0; i < num; i++)
+        r[i] = (r[i] & mask) | (t[i] & ~mask);
+}
+
+/* fe_add sets |r| = |a| + |b| mod p */
+static inline void fe_add(BN_ULONG *r, const BN_ULONG *a, const BN_ULONG *b,
+                          const BN_ULONG *p, int num)
+{
+    BN_ULONG carry = 0, s;
+    int i;
+
+    for (i = 0; i < num; i++) {
+        s = (a[i] + carry) & BN_MASK2;
+        carry = s < carry;
+        s = (s + b[i]) & BN_MASK2;
+        carry += s < b[i];
+        r[i] = s;
+    }
+    fe_reduce_once(r, carry, p, num);
+}
+
+/* fe_sub sets |r| = |a| - |b| mod p */
+static inline void fe_sub(BN_ULONG *r, const BN_ULONG *a, const BN_ULONG *b,
+                          const BN_ULONG *p, int num)
+{
+    BN_ULONG borrow = 0, carry = 0, mask, d, s;
+    int i;
+
+    for (i = 0; i < num; i++) {
+        d = (a[i] - b[i] - borrow) & BN_MASK2;
+        borrow = (a[i] < b[i]) | ((a[i] == b[i]) & borrow);
+        r[i] = d;
+    }
+    /* add p back if the subtraction borrowed */
+    mask = 0 - borrow;
+    for (i = 0; i < num; i++) {
+        s = (r[i] + carry) & BN_MASK2;
+        carry = s < carry;
+        s = (s + (p[i] & mask)) & BN_MASK2;
+        carry += s < (p[i] & mask);
+        r[i] = s;
+    }
+}
+
+/* fe_half sets |r| = |a| / 2 mod p, for odd p */
+static inline void fe_half(BN_ULONG *r, const BN_ULONG *a, const BN_ULONG *p,
+                           int num)
+{
+    BN_ULONG carry = 0, mask = 0 - (a[0] & 1), s;
+    int i;
+
+    for (i = 0; i < num; i++) {
+        s = (a[i] + carry) & BN_MASK2;
+        carry = s < carry;
+        s = (s + (p[i] & mask)) & BN_MASK2;
+        carry += s < (p[i] & mask);
+        r[i] = s;
+    }
+    for (i = 0; i < num - 1; i++)
+        r[i] = ((r[i] >> 1) | (r[i + 1] << (BN_BITS2 - 1))) & BN_MASK2;
+    r[num - 1] = (r[num - 1] >> 1) | (carry << (BN_BITS2 - 1));
+}
+
+#define fe_mul(r, a, b) bn_mul_mont_fixed(r, a, b, mont, num)
+#define fe_sqr(r, a) bn_mul_mont_fixed(r, a, a, mont, num)
+
+/*
+ * fixed_point_dbl and fixed_point_add follow ec_GFp_simple_dbl and
+ * ec_GFp_simple_add step by step, including the names of the temporaries,
+ * so that the two can be read side by side.
+ */
+static inline int fixed_point_dbl(const EC_GROUP *group, EC_POINT *r,
+                                  const EC_POINT *a, const int num)
+{
+    const BN_MONT_CTX *mont = group->field_data1;
+    const BN_ULONG *p = bn_get_words(group->field);
+    fe X_a, Y_a, Z_a, n0, n1, n2, n3;
+
+    if (EC_POINT_is_at_infinity(group, a)) {
+        BN_zero(r->Z);
+        r->Z_is_one = 0;
+        return 1;
+    }
+
+    fe_load(X_a, a->X, num);
+    fe_load(Y_a, a->Y, num);
+    fe_load(Z_a, a->Z, num);
+
+    /* n1 */
+    if (a->Z_is_one) {
+        fe_sqr(n0, X_a);
+        fe_add(n1, n0, n0, p, num);
+        fe_add(n0, n0, n1, p, num);
+        fe_load(n1, group->a, num);
+        fe_add(n1, n0, n1, p, num);
+        /* n1 = 3 * X_a^2 + a_curve */
+    } else if (group->a_is_minus3) {
+        fe_sqr(n1, Z_a);
+        fe_add(n0, X_a, n1, p, num);
+        fe_sub(n2, X_a, n1, p, num);
+        fe_mul(n1, n0, n2);
+        fe_add(n0, n1, n1, p, num);
+        fe_add(n1, n0, n1, p, num);
+        /*-
+         * n1 = 3 * (X_a + Z_a^2) * (X_a - Z_a^2)
+         *    = 3 * X_a^2 - 3 * Z_a^4
+         */
+    } else {
+        fe_sqr(n0, X_a);
+        fe_add(n1, n0, n0, p, num);
+        fe_add(n0, n0, n1, p, num);
+        fe_sqr(n1, Z_a);
+        fe_sqr(n1, n1);
+        fe_load(n2, group->a, num);
+        fe_mul(n1, n1, n2);
+        fe_add(n1, n1, n0, p, num);
+        /* n1 = 3 * X_a^2 + a_curve * Z_a^4 */
+    }
+
+    /* Z_r */
+    if (a->Z_is_one)
+        memcpy(n0, Y_a, sizeof(n0));
+    else
+        fe_mul(n0, Y_a, Z_a);
+    fe_add(Z_a, n0, n0, p, num);
+    /* Z_r = 2 * Y_a * Z_a */
+
+    /* n2 */
+    fe_sqr(n3, Y_a);
+    fe_mul(n2, X_a, n3);
+    fe_add(n2, n2, n2, p, num);
+    fe_add(n2, n2, n2, p, num);
+    /* n2 = 4 * X_a * Y_a^2 */
+
+    /* X_r */
+    fe_add(n0, n2, n2, p, num);
+    fe_sqr(X_a, n1);
+    fe_sub(X_a, X_a, n0, p, num);
+    /* X_r = n1^2 - 2 * n2 */
+
+    /* n3 */
+    fe_sqr(n0, n3);
+    fe_add(n3, n0, n0, p, num);
+    fe_add(n3, n3, n3, p, num);
+    fe_add(n3, n3, n3, p, num);
+    /* n3 = 8 * Y_a^4 */
+
+    /* Y_r */
+    fe_sub(n0, n2, X_a, p, num);
+    fe_mul(n0, n1, n0);
+    fe_sub(Y_a, n0, n3, p, num);
+    /* Y_r = n1 * (n2 - X_r) - n3 */
+
+    r->Z_is_one = 0;
+    return fe_store(r->X, X_a, num) && fe_store(r->Y, Y_a, num)
+        && fe_store(r->Z, Z_a, num);
+}
+
+static inline int fixed_point_add(const EC_GROUP *group, EC_POINT *r,
+                                  const EC_POINT *a, const EC_POINT *b,
+                                  const int num)
+{
+    const BN_MONT_CTX *mont = group->field_data1;
+    const BN_ULONG *p = bn_get_words(group->field);
+    fe n0, n1, n2, n3, n4, n5, n6, Z_a, Z_b;
+
+    if (a == b)
+        return fixed_point_dbl(group, r, a, num);
+    if (EC_POINT_is_at_infinity(group, a))
+        return EC_POINT_copy(r, b);
+    if (EC_POINT_is_at_infinity(group, b))
+        return EC_POINT_copy(r, a);
+
+    fe_load(Z_a, a->Z, num);
+    fe_load(Z_b, b->Z, num);
+
+    /* n1, n2 */
+    fe_load(n1, a->X, num);
+    fe_load(n2, a->Y, num);
+    if (!b->Z_is_one) {
+        fe_sqr(n0, Z_b);
+        fe_mul(n1, n1, n0);
+        /* n1 = X_a * Z_b^2 */
+
+        fe_mul(n0, n0, Z_b);
+        fe_mul(n2, n2, n0);
+        /* n2 = Y_a * Z_b^3 */
+    }
+
+    /* n3, n4 */
+    fe_load(n3, b->X, num);
+    fe_load(n4, b->Y, num);
+    if (!a->Z_is_one) {
+        fe_sqr(n0, Z_a);
+        fe_mul(n3, n3, n0);
+        /* n3 = X_b * Z_a^2 */
+
+        fe_mul(n0, n0, Z_a);
+        fe_mul(n4, n4, n0);
+        /* n4 = Y_b * Z_a^3 */
+    }
+
+    /* n5, n6 */
+    fe_sub(n5, n1, n3, p, num);
+    fe_sub(n6, n2, n4, p, num);
+    /* n5 = n1 - n3 */
+    /* n6 = n2 - n4 */
+
+    if (fe_is_zero(n5, num)) {
+        if (fe_is_zero(n6, num)) {
+            /* a is the same point as b */
+            return fixed_point_dbl(group, r, a, num);
+        } else {
+            /* a is the inverse of b */
+            BN_zero(r->Z);
+            r->Z_is_one = 0;
+            return 1;
+        }
+    }
+
+    /* 'n7', 'n8' */
+    fe_add(n1, n1, n3, p, num);
+    fe_add(n2, n2, n4, p, num);
+    /* 'n7' = n1 + n3 */
+    /* 'n8' = n2 + n4 */
+
+    /* Z_r */
+    if (a->Z_is_one && b->Z_is_one) {
+        memcpy(Z_a, n5, sizeof(Z_a));
+    } else {
+        if (a->Z_is_one)
+            memcpy(n0, Z_b, sizeof(n0));
+        else if (b->Z_is_one)
+            memcpy(n0, Z_a, sizeof(n0));
+        else
+            fe_mul(n0, Z_a, Z_b);
+        fe_mul(Z_a, n0, n5);
+    }
+    /* Z_r = Z_a * Z_b * n5 */
+
+    /* X_r */
+    fe_sqr(n0, n6);
+    fe_sqr(n4, n5);
+    fe_mul(n3, n1, n4);
+    fe_sub(Z_b, n0, n3, p, num);
+    /* X_r = n6^2 - n5^2 * 'n7' */
+
+    /* 'n9' */
+    fe_add(n0, Z_b, Z_b, p, num);
+    fe_sub(n0, n3, n0, p, num);
+    /* n9 = n5^2 * 'n7' - 2 * X_r */
+
+    /* Y_r */
+    fe_mul(n0, n0, n6);
+    fe_mul(n5, n4, n5);         /* now n5 is n5^3 */
+    fe_mul(n1, n2, n5);
+    fe_sub(n0, n0, n1, p, num);
+    fe_half(n0, n0, p, num);
+    /* Y_r = (n6 * 'n9' - 'n8' * 'n5^3') / 2 */
+
+    r->Z_is_one = 0;
+    return fe_store(r->X, Z_b, num) && fe_store(r->Y, n0, num)
+        && fe_store(r->Z, Z_a, num);
+}
+
+#undef fe_sqr
+#undef fe_mul
+
+/*
+ * FIXED_IMPL instantiates the point functions for a field of |bits| bits,
+ * with the word count known to the compiler.
+ */
+#define FIXED_IMPL(bits) \
+static int fixed##bits##_dbl(const EC_GROUP *group, EC_POINT *r, \
+                             const EC_POINT *a) \
+{ \
+    return fixed_point_dbl(group, r, a, bits / BN_BITS2); \
+} \
+static int fixed##bits##_add(const EC_GROUP *group, EC_POINT *r, \
+                             const EC_POINT *a, const EC_POINT *b) \
+{ \
+    return fixed_point_add(group, r, a, b, bits / BN_BITS2); \
+}
+
+FIXED_IMPL(256)
+FIXED_IMPL(320)
+FIXED_IMPL(384)
+FIXED_IMPL(512)
+
+/*
+ * fixed_fits returns 1 if the coordinates of |a| fit in |num| words, as they
+ * always do for points created through the EC_POINT functions.
+ */
+static int fixed_fits(const EC_POINT *a, int num)
+{
+    return bn_get_top(a->X) <= num && bn_get_top(a->Y) <= num
+        && bn_get_top(a->Z) <= num;
+}
+
+/* ec_GFp_fixed_supported returns 1 if there is an instantiation for |p| */
+int ec_GFp_fixed_supported(const BIGNUM *p)
+{
+    switch ((BN_num_bits(p) + BN_BITS2 - 1) / BN_BITS2) {
+    case 256 / BN_BITS2:
+    case 320 / BN_BITS2:
+    case 384 / BN_BITS2:
+    case 512 / BN_BITS2:
+        return 1;
+    }
+    return 0;
+}
+
+int ec_GFp_fixed_dbl(const EC_GROUP *group, EC_POINT *r, const EC_POINT *a,
+                     BN_CTX *ctx)
+{
+    if (group->field_data1 == NULL) {
+        ECerr(EC_F_EC_GFP_FIXED_DBL, EC_R_NOT_INITIALIZED);
+        return 0;
+    }
+
+    if (fixed_fits(a, bn_get_top(group->field))) {
+        switch (bn_get_top(group->field)) {
+        case 256 / BN_BITS2:
+            return fixed256_dbl(group, r, a);
+        case 320 / BN_BITS2:
+            return fixed320_dbl(group, r, a);
+        case 384 / BN_BITS2:
+            return fixed384_dbl(group, r, a);
+        case 512 / BN_BITS2:
+            return fixed512_dbl(group, r, a);
+        }
+    }
+    return ec_GFp_simple_dbl(group, r, a, ctx);
+}
+
+int ec_GFp_fixed_add(const EC_GROUP *group, EC_POINT *r, const EC_POINT *a,
+                     const EC_POINT *b, BN_CTX *ctx)
+{
+    if (group->field_data1 == NULL) {
+        ECerr(EC_F_EC_GFP_FIXED_ADD, EC_R_NOT_INITIALIZED);
+        return 0;
+    }
+
+    if (fixed_fits(a, bn_get_top(group->field))
+        && fixed_fits(b, bn_get_top(group->field))) {
+        switch (bn_get_top(group->field)) {
+        case 256 / BN_BITS2:
+            return fixed256_add(group, r, a, b);
+        case 320 / BN_BITS2:
+            return fixed320_add(group, r, a, b);
+        case 384 / BN_BITS2:
+            return fixed384_add(group, r, a, b);
+        case 512 / BN_BITS2:
+            return fixed512_add(group, r, a, b);
+        }
+    }
+    return ec_GFp_simple_add(group, r, a, b, ctx);
+}
+
+/*
+ * The field operations are also used outside point arithmetic, for instance
+ * to make points affine. Operands of the full width skip BN_CTX.
+ */
+int ec_GFp_fixed_field_mul(const EC_GROUP *group, BIGNUM *r, const BIGNUM *a,
+                           const BIGNUM *b, BN_CTX *ctx)
+{
+    int num = bn_get_top(group->field);
+    fe fa, fb;
+
+    if (group->field_data1 != NULL && num <= FIXED_MAX_WORDS
+        && bn_get_top(a) <= num && bn_get_top(b) <= num
+        && !BN_is_negative(a) && !BN_is_negative(b)) {
+        fe_load(fa, a, num);
+        fe_load(fb, b, num);
+        if (bn_mul_mont_fixed(fa, fa, fb, group->field_data1, num))
+            return fe_store(r, fa, num);
+    }
+    return ec_GFp_mont_field_mul(group, r, a, b, ctx);
+}
+
+int ec_GFp_fixed_field_sqr(const EC_GROUP *group, BIGNUM *r, const BIGNUM *a,
+                           BN_CTX *ctx)
+{
+    int num = bn_get_top(group->field);
+    fe fa;
+
+    if (group->field_data1 != NULL && num <= FIXED_MAX_WORDS
+        && bn_get_top(a) <= num && !BN_is_negative(a)) {
+        fe_load(fa, a, num);
+        if (bn_mul_mont_fixed(fa, fa, fa, group->field_data1, num))
+            return fe_store(r, fa, num);
+    }
+    return ec_GFp_mont_field_sqr(group, r, a, ctx);
+}
+
+const EC_METHOD *EC_GFp_fixed_method(void)
+{
+    static const EC_METHOD ret = {
+        EC_FLAGS_DEFAULT_OCT,
+        NID_X9_62_prime_field,
+        ec_GFp_mont_group_init,
+        ec_GFp_mont_group_finish,
+        ec_GFp_mont_group_clear_finish,
+        ec_GFp_mont_group_copy,
+        ec_GFp_mont_group_set_curve,
+        ec_GFp_simple_group_get_curve,
+        ec_GFp_simple_group_get_degree,
+        ec_GFp_simple_group_check_discriminant,
+        ec_GFp_simple_point_init,
+        ec_GFp_simple_point_finish,
+        ec_GFp_simple_point_clear_finish,
+        ec_GFp_simple_point_copy,
+        ec_GFp_simple_point_set_to_infinity,
+        ec_GFp_simple_set_Jprojective_coordinates_GFp,
+        ec_GFp_simple_get_Jprojective_coordinates_GFp,
+        ec_GFp_simple_point_set_affine_coordinates,
+        ec_GFp_simple_point_get_affine_coordinates,
+        0, 0, 0,
+        ec_GFp_fixed_add,
+        ec_GFp_fixed_dbl,
+        ec_GFp_simple_invert,
+        ec_GFp_simple_is_at_infinity,
+        ec_GFp_simple_is_on_curve,
+        ec_GFp_simple_cmp,
+        ec_GFp_simple_make_affine,
+        ec_GFp_simple_points_make_affine,
+        0 /* mul */ ,
+        0 /* precompute_mult */ ,
+        0 /* have_precompute_mult */ ,
+        ec_GFp_fixed_field_mul,
+        ec_GFp_fixed_field_sqr,
+        0 /* field_div */ ,
+        ec_GFp_mont_field_encode,
+        ec_GFp_mont_field_decode,
+        ec_GFp_mont_field_set_to_one
+    };
+
+    return &ret;
+}
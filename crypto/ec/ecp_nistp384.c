@@ -0,0 +1,1593 @@
+/* crypto/ec/ecp_nistp384.c */
+/* ====================================================================
+ * Copyright (c) 2015 The OpenSSL Project.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. All advertising materials mentioning features or use of this
+ *    software must display the following acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit. (http://www.openssl.org/)"
+ *
+ * 4. The names "OpenSSL Toolkit" and "OpenSSL Project" must not be used to
+ *    endorse or promote products derived from this software without
+ *    prior written permission. For written permission, please contact
+ *    openssl-core@openssl.org.
+ *
+ * 5. Products derived from this software may not be called "OpenSSL"
+ *    nor may "OpenSSL" appear in their names without prior written
+ *    permission of the OpenSSL Project.
+ *
+ * 6. Redistributions of any form whatsoever must retain the following
+ *    acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit (http://www.openssl.org/)"
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE OpenSSL PROJECT ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE OpenSSL PROJECT OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ====================================================================
+ */
+
+/*
+ * A 64-bit implementation of the NIST P-384 elliptic curve point
+ * multiplication.
+ *
+ * The group operations, the precomputed tables and the OpenSSL integration
+ * follow ecp_nistp256.c. The field arithmetic is different: elements are
+ * kept in Montgomery form in six 64-bit limbs and are fully reduced after
+ * every operation, which keeps the bounds reasoning trivial at the cost of
+ * a conditional subtraction, done with masks, in each operation.
+ */
+
+#include <openssl/opensslconf.h>
+#ifndef OPENSSL_NO_EC_NISTP_64_GCC_128
+
+# ifndef OPENSSL_SYS_VMS
+#  include <stdint.h>
+# else
+#  include <inttypes.h>
+# endif
+
+# include <string.h>
+# include <openssl/err.h>
+# include "ec_lcl.h"
+
+# if defined(__GNUC__) && (__GNUC__ > 3 || (__GNUC__ == 3 && __GNUC_MINOR__ >= 1))
+  /* even with gcc, the typedef won't work for 32-bit platforms */
+typedef __uint128_t uint128_t;  /* nonstandard; implemented by gcc on 64-bit
+                                 * platforms */
+# else
+#  error "Need GCC 3.1 or later to define type uint128_t"
+# endif
+
+typedef uint8_t u8;
+typedef uint64_t u64;
+
+/*
+ * The underlying field. P384 operates over GF(2^384-2^128-2^96+2^32-1). We
+ * can serialise an element of this field into 48 bytes. We call this an
+ * felem_bytearray.
+ */
+
+typedef u8 felem_bytearray[48];
+
+/*
+ * These are the parameters of P384, taken from FIPS 186-3, section D.1.2.4.
+ * These values are big-endian.
+ */
+static const felem_bytearray nistp384_curve_params[5] = {
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, /* p */
+     0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+     0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+     0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe,
+     0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, /* a = -3 */
+     0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+     0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+     0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe,
+     0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xfc},
+    {0xb3, 0x31, 0x2f, 0xa7, 0xe2, 0x3e, 0xe7, 0xe4, /* b */
+     0x98, 0x8e, 0x05, 0x6b, 0xe3, 0xf8, 0x2d, 0x19,
+     0x18, 0x1d, 0x9c, 0x6e, 0xfe, 0x81, 0x41, 0x12,
+     0x03, 0x14, 0x08, 0x8f, 0x50, 0x13, 0x87, 0x5a,
+     0xc6, 0x56, 0x39, 0x8d, 0x8a, 0x2e, 0xd1, 0x9d,
+     0x2a, 0x85, 0xc8, 0xed, 0xd3, 0xec, 0x2a, 0xef},
+    {0xaa, 0x87, 0xca, 0x22, 0xbe, 0x8b, 0x05, 0x37, /* x */
+     0x8e, 0xb1, 0xc7, 0x1e, 0xf3, 0x20, 0xad, 0x74,
+     0x6e, 0x1d, 0x3b, 0x62, 0x8b, 0xa7, 0x9b, 0x98,
+     0x59, 0xf7, 0x41, 0xe0, 0x82, 0x54, 0x2a, 0x38,
+     0x55, 0x02, 0xf2, 0x5d, 0xbf, 0x55, 0x29, 0x6c,
+     0x3a, 0x54, 0x5e, 0x38, 0x72, 0x76, 0x0a, 0xb7},
+    {0x36, 0x17, 0xde, 0x4a, 0x96, 0x26, 0x2c, 0x6f, /* y */
+     0x5d, 0x9e, 0x98, 0xbf, 0x92, 0x92, 0xdc, 0x29,
+     0xf8, 0xf4, 0x1d, 0xbd, 0x28, 0x9a, 0x14, 0x7c,
+     0xe9, 0xda, 0x31, 0x13, 0xb5, 0xf0, 0xb8, 0xc0,
+     0x0a, 0x60, 0xb1, 0xce, 0x1d, 0x7e, 0x81, 0x9d,
+     0x7a, 0x43, 0x1d, 0x7c, 0x90, 0xea, 0x0e, 0x5f}
+};
+
+/*-
+ * The representation of field elements.
+ * ------------------------------------
+ *
+ * We represent field elements with six 64-bit values, the limbs:
+ *   v[0]*2^0 + v[1]*2^64 + ... + v[5]*2^320
+ * A field element x is stored as x*R mod p, with R = 2^384, that is in
+ * Montgomery form, and the stored value is always less than p. This is
+ * an 'felem'. Products are formed in twelve limbs, a 'widefelem', and
+ * brought back to an felem by Montgomery reduction.
+ */
+
+# define NLIMBS 6
+
+typedef u64 limb;
+typedef limb felem[NLIMBS];
+typedef limb widefelem[NLIMBS * 2];
+
+/* This is the value of the prime as six 64-bit words, little-endian. */
+static const felem kPrime = {
+    0x00000000ffffffff, 0xffffffff00000000, 0xfffffffffffffffe,
+    0xffffffffffffffff, 0xffffffffffffffff, 0xffffffffffffffff
+};
+
+/* -p^-1 mod 2^64 */
+static const limb kPrimeInv = 0x0000000100000001;
+
+/* R^2 mod p, to convert into Montgomery form */
+static const felem kRR = {
+    0xfffffffe00000001, 0x0000000200000000, 0xfffffffe00000000,
+    0x0000000200000000, 0x0000000000000001, 0
+};
+
+/* R mod p, which is 1 in Montgomery form */
+static const felem kOne = {
+    0xffffffff00000001, 0x00000000ffffffff, 1, 0, 0, 0
+};
+
+/* 1, which is R^-1 in Montgomery form, to convert out of it */
+static const felem kMontOne = { 1, 0, 0, 0, 0, 0 };
+
+static const felem kZero = { 0, 0, 0, 0, 0, 0 };
+
+/*-
+ * Field operations
+ * ----------------
+ */
+
+static void felem_one(felem out)
+{
+    unsigned i;
+    for (i = 0; i < NLIMBS; i++)
+        out[i] = kOne[i];
+}
+
+static void felem_assign(felem out, const felem in)
+{
+    unsigned i;
+    for (i = 0; i < NLIMBS; i++)
+        out[i] = in[i];
+}
+
+/*
+ * felem_reduce_once sets |out| to |in| - p if that is not negative and to
+ * |in| otherwise, where |in| + |top|*2^384 < 2p.
+ */
+static void felem_reduce_once(felem out, const limb in[NLIMBS], limb top)
+{
+    felem tmp;
+    uint128_t t;
+    limb borrow = 0, mask;
+    unsigned i;
+
+    for (i = 0; i < NLIMBS; i++) {
+        t = (uint128_t) in[i] - kPrime[i] - borrow;
+        tmp[i] = (limb) t;
+        borrow = (limb) (t >> 64) & 1;
+    }
+    /* keep |in| if the subtraction borrowed and there is no top bit */
+    mask = 0 - (borrow & (top ^ 1));
+    for (i = 0; i < NLIMBS; i++)
+        out[i] = (in[i] & mask) | (tmp[i] & ~mask);
+}
+
+/* felem_add sets |out| = |in1| + |in2| */
+static void felem_add(felem out, const felem in1, const felem in2)
+{
+    limb sum[NLIMBS];
+    uint128_t t = 0;
+    unsigned i;
+
+    for (i = 0; i < NLIMBS; i++) {
+        t += (uint128_t) in1[i] + in2[i];
+        sum[i] = (limb) t;
+        t >>= 64;
+    }
+    felem_reduce_once(out, sum, (limb) t);
+}
+
+/* felem_sub sets |out| = |in1| - |in2| */
+static void felem_sub(felem out, const felem in1, const felem in2)
+{
+    limb diff[NLIMBS], borrow = 0, mask;
+    uint128_t t;
+    unsigned i;
+
+    for (i = 0; i < NLIMBS; i++) {
+        t = (uint128_t) in1[i] - in2[i] - borrow;
+        diff[i] = (limb) t;
+        borrow = (limb) (t >> 64) & 1;
+    }
+    /* add p back if the subtraction borrowed */
+    mask = 0 - borrow;
+    t = 0;
+    for (i = 0; i < NLIMBS; i++) {
+        t += (uint128_t) diff[i] + (kPrime[i] & mask);
+        out[i] = (limb) t;
+        t >>= 64;
+    }
+}
+
+/* felem_neg sets |out| to |-in| */
+static void felem_neg(felem out, const felem in)
+{
+    felem_sub(out, kZero, in);
+}
+
+/*-
+ * felem_reduce sets |out| = |in|/R mod p, clobbering |in|
+ * On entry:
+ *   in < p*R
+ */
+static void felem_reduce(felem out, widefelem in)
+{
+    uint128_t t;
+    limb m, carry, top = 0;
+    unsigned i, j;
+
+    for (i = 0; i < NLIMBS; i++) {
+        /* add the multiple of p that clears limb i */
+        m = in[i] * kPrimeInv;
+        carry = 0;
+        for (j = 0; j < NLIMBS; j++) {
+            t = (uint128_t) m * kPrime[j] + in[i + j] + carry;
+            in[i + j] = (limb) t;
+            carry = (limb) (t >> 64);
+        }
+        t = (uint128_t) in[i + NLIMBS] + carry + top;
+        in[i + NLIMBS] = (limb) t;
+        top = (limb) (t >> 64);
+    }
+    /* the upper half is now less than 2p */
+    felem_reduce_once(out, in + NLIMBS, top);
+}
+
+/* felem_mul sets |out| = |in1| * |in2| */
+static void felem_mul(felem out, const felem in1, const felem in2)
+{
+    widefelem tmp;
+    uint128_t t;
+    limb carry;
+    unsigned i, j;
+
+    memset(tmp, 0, sizeof(tmp));
+    for (i = 0; i < NLIMBS; i++) {
+        carry = 0;
+        for (j = 0; j < NLIMBS; j++) {
+            t = (uint128_t) in1[i] * in2[j] + tmp[i + j] + carry;
+            tmp[i + j] = (limb) t;
+            carry = (limb) (t >> 64);
+        }
+        tmp[i + NLIMBS] = carry;
+    }
+    felem_reduce(out, tmp);
+}
+
+/* felem_square sets |out| = |in|^2 */
+static void felem_square(felem out, const felem in)
+{
+    widefelem tmp;
+    uint128_t t;
+    limb carry;
+    unsigned i, j;
+
+    /* the products in[i]*in[j] with i < j, once */
+    memset(tmp, 0, sizeof(tmp));
+    for (i = 0; i < NLIMBS - 1; i++) {
+        carry = 0;
+        for (j = i + 1; j < NLIMBS; j++) {
+            t = (uint128_t) in[i] * in[j] + tmp[i + j] + carry;
+            tmp[i + j] = (limb) t;
+            carry = (limb) (t >> 64);
+        }
+        tmp[i + NLIMBS] = carry;
+    }
+    /* double them */
+    for (i = 2 * NLIMBS - 1; i > 0; i--)
+        tmp[i] = (tmp[i] << 1) | (tmp[i - 1] >> 63);
+    tmp[0] <<= 1;
+    /* and add the squares */
+    t = 0;
+    for (i = 0; i < NLIMBS; i++) {
+        uint128_t sq = (uint128_t) in[i] * in[i];
+
+        t += (uint128_t) tmp[2 * i] + (limb) sq;
+        tmp[2 * i] = (limb) t;
+        t >>= 64;
+        t += (uint128_t) tmp[2 * i + 1] + (limb) (sq >> 64);
+        tmp[2 * i + 1] = (limb) t;
+        t >>= 64;
+    }
+    felem_reduce(out, tmp);
+}
+
+/*
+ * felem_is_zero returns a limb with all bits set if |in| == 0 (mod p) and 0
+ * otherwise.
+ */
+static limb felem_is_zero(const felem in)
+{
+    limb is_nonzero = in[0] | in[1] | in[2] | in[3] | in[4] | in[5];
+
+    /* in is fully reduced, so 0 is the only representation of zero */
+    is_nonzero = (is_nonzero | (0 - is_nonzero)) >> 63;
+    return is_nonzero - 1;
+}
+
+static int felem_is_zero_int(const felem in)
+{
+    return (int)(felem_is_zero(in) & ((limb) 1));
+}
+
+/*-
+ * Conversions
+ * -----------
+ */
+
+/*
+ * bin48_to_felem takes a little-endian byte array and converts it into the
+ * limbs of |out|, without converting to Montgomery form.
+ */
+static void bin48_to_felem(felem out, const u8 in[48])
+{
+    unsigned i, j;
+
+    for (i = 0; i < NLIMBS; i++) {
+        out[i] = 0;
+        for (j = 0; j < 8; j++)
+            out[i] |= ((limb) in[8 * i + j]) << (8 * j);
+    }
+}
+
+/* felem_to_bin48 is the inverse of bin48_to_felem */
+static void felem_to_bin48(u8 out[48], const felem in)
+{
+    unsigned i, j;
+
+    for (i = 0; i < NLIMBS; i++)
+        for (j = 0; j < 8; j++)
+            out[8 * i + j] = (u8)(in[i] >> (8 * j));
+}
+
+/* To preserve endianness when using BN_bn2bin and BN_bin2bn */
+static void flip_endian(u8 *out, const u8 *in, unsigned len)
+{
+    unsigned i;
+    for (i = 0; i < len; ++i)
+        out[i] = in[len - 1 - i];
+}
+
+/*
+ * felem_inv calculates |out| = |in|^{-1}, in constant time. The inverse of
+ * the Montgomery representation x*R is x^-1*R^-1, so two multiplications by
+ * R^2 bring it back to x^-1*R.
+ */
+static void felem_inv(felem out, const felem in)
+{
+    u8 b[48], p[48];
+
+    felem_to_bin48(b, in);
+    felem_to_bin48(p, kPrime);
+    ec_GFp_nistp_mod_inverse(b, b, p, sizeof(b));
+    bin48_to_felem(out, b);
+    felem_mul(out, out, kRR);
+    felem_mul(out, out, kRR);
+}
+
+/* BN_to_felem converts an OpenSSL BIGNUM into an felem */
+static int BN_to_felem(felem out, const BIGNUM *bn)
+{
+    felem_bytearray b_in;
+    felem_bytearray b_out;
+    unsigned num_bytes;
+
+    /* BN_bn2bin eats leading zeroes */
+    memset(b_out, 0, sizeof b_out);
+    num_bytes = BN_num_bytes(bn);
+    if (num_bytes > sizeof b_out) {
+        ECerr(EC_F_BN_TO_FELEM, EC_R_BIGNUM_OUT_OF_RANGE);
+        return 0;
+    }
+    if (BN_is_negative(bn)) {
+        ECerr(EC_F_BN_TO_FELEM, EC_R_BIGNUM_OUT_OF_RANGE);
+        return 0;
+    }
+    num_bytes = BN_bn2bin(bn, b_in);
+    flip_endian(b_out, b_in, num_bytes);
+    bin48_to_felem(out, b_out);
+    /* this also reduces values between p and 2^384 */
+    felem_mul(out, out, kRR);
+    return 1;
+}
+
+/* felem_to_BN converts an felem into an OpenSSL BIGNUM */
+static BIGNUM *felem_to_BN(BIGNUM *out, const felem in)
+{
+    felem_bytearray b_in, b_out;
+    felem tmp;
+
+    felem_mul(tmp, in, kMontOne);
+    felem_to_bin48(b_in, tmp);
+    flip_endian(b_out, b_in, sizeof b_out);
+    return BN_bin2bn(b_out, sizeof b_out, out);
+}
+
+/*-
+ * Group operations
+ * ----------------
+ *
+ * Building on top of the field operations we have the operations on the
+ * elliptic curve group itself. Points on the curve are represented in Jacobian
+ * coordinates
+ */
+
+/*-
+ * point_double calculates 2*(x_in, y_in, z_in)
+ *
+ * The method is taken from:
+ *   http://hyperelliptic.org/EFD/g1p/auto-shortw-jacobian-3.html#doubling-dbl-2001-b
+ *
+ * Outputs can equal corresponding inputs, i.e., x_out == x_in is allowed.
+ * while x_out == y_in is not (maybe this works, but it's not tested).
+ */
+static void
+point_double(felem x_out, felem y_out, felem z_out,
+             const felem x_in, const felem y_in, const felem z_in)
+{
+    felem delta, gamma, beta, alpha, ftmp, ftmp2;
+
+    /* delta = z^2 */
+    felem_square(delta, z_in);
+
+    /* gamma = y^2 */
+    felem_square(gamma, y_in);
+
+    /* beta = x*gamma */
+    felem_mul(beta, x_in, gamma);
+
+    /* alpha = 3*(x-delta)*(x+delta) */
+    felem_sub(ftmp, x_in, delta);
+    felem_add(ftmp2, x_in, delta);
+    felem_add(alpha, ftmp2, ftmp2);
+    felem_add(ftmp2, alpha, ftmp2);
+    felem_mul(alpha, ftmp, ftmp2);
+
+    /* x' = alpha^2 - 8*beta */
+    felem_add(ftmp, beta, beta);
+    felem_add(ftmp, ftmp, ftmp);
+    /* ftmp = 4*beta */
+    felem_add(ftmp2, ftmp, ftmp);
+    felem_square(x_out, alpha);
+    felem_sub(x_out, x_out, ftmp2);
+
+    /* z' = (y + z)^2 - gamma - delta */
+    felem_add(ftmp2, y_in, z_in);
+    felem_square(z_out, ftmp2);
+    felem_sub(z_out, z_out, gamma);
+    felem_sub(z_out, z_out, delta);
+
+    /* y' = alpha*(4*beta - x') - 8*gamma^2 */
+    felem_sub(ftmp, ftmp, x_out);
+    felem_mul(ftmp, alpha, ftmp);
+    felem_square(gamma, gamma);
+    felem_add(gamma, gamma, gamma);
+    felem_add(gamma, gamma, gamma);
+    felem_add(gamma, gamma, gamma);
+    felem_sub(y_out, ftmp, gamma);
+}
+
+/* copy_conditional copies in to out iff mask is all ones. */
+static void copy_conditional(felem out, const felem in, limb mask)
+{
+    unsigned i;
+    for (i = 0; i < NLIMBS; ++i) {
+        const limb tmp = mask & (in[i] ^ out[i]);
+        out[i] ^= tmp;
+    }
+}
+
+/*-
+ * point_add calcuates (x1, y1, z1) + (x2, y2, z2)
+ *
+ * The method is taken from:
+ *   http://hyperelliptic.org/EFD/g1p/auto-shortw-jacobian-3.html#addition-add-2007-bl,
+ * adapted for mixed addition (z2 = 1, or z2 = 0 for the point at infinity).
+ *
+ * This function includes a branch for checking whether the two input points
+ * are equal, (while not equal to the point at infinity). This case never
+ * happens during single point multiplication, so there is no timing leak for
+ * ECDH or ECDSA signing.
+ */
+static void point_add(felem x3, felem y3, felem z3,
+                      const felem x1, const felem y1, const felem z1,
+                      const int mixed, const felem x2, const felem y2,
+                      const felem z2)
+{
+    felem ftmp, ftmp2, ftmp3, ftmp4, ftmp5, ftmp6, x_out, y_out, z_out;
+    limb x_equal, y_equal, z1_is_zero, z2_is_zero;
+
+    z1_is_zero = felem_is_zero(z1);
+    z2_is_zero = felem_is_zero(z2);
+
+    /* ftmp = z1z1 = z1**2 */
+    felem_square(ftmp, z1);
+
+    if (!mixed) {
+        /* ftmp2 = z2z2 = z2**2 */
+        felem_square(ftmp2, z2);
+
+        /* u1 = ftmp3 = x1*z2z2 */
+        felem_mul(ftmp3, x1, ftmp2);
+
+        /* ftmp5 = (z1 + z2)**2 - (z1z1 + z2z2) = 2z1z2 */
+        felem_add(ftmp5, z1, z2);
+        felem_square(ftmp5, ftmp5);
+        felem_sub(ftmp5, ftmp5, ftmp);
+        felem_sub(ftmp5, ftmp5, ftmp2);
+
+        /* ftmp2 = z2 * z2z2 */
+        felem_mul(ftmp2, ftmp2, z2);
+
+        /* s1 = ftmp6 = y1 * z2**3 */
+        felem_mul(ftmp6, y1, ftmp2);
+    } else {
+        /*
+         * We'll assume z2 = 1 (special case z2 = 0 is handled later)
+         */
+
+        /* u1 = ftmp3 = x1*z2z2 */
+        felem_assign(ftmp3, x1);
+
+        /* ftmp5 = 2z1z2 */
+        felem_add(ftmp5, z1, z1);
+
+        /* s1 = ftmp6 = y1 * z2**3 */
+        felem_assign(ftmp6, y1);
+    }
+
+    /* u2 = x2*z1z1 */
+    felem_mul(ftmp4, x2, ftmp);
+
+    /* h = ftmp4 = u2 - u1 */
+    felem_sub(ftmp4, ftmp4, ftmp3);
+
+    x_equal = felem_is_zero(ftmp4);
+
+    /* z_out = ftmp5 * h */
+    felem_mul(z_out, ftmp5, ftmp4);
+
+    /* ftmp = z1 * z1z1 */
+    felem_mul(ftmp, ftmp, z1);
+
+    /* s2 = ftmp5 = y2 * z1**3 */
+    felem_mul(ftmp5, y2, ftmp);
+
+    /* r = ftmp5 = (s2 - s1)*2 */
+    felem_sub(ftmp5, ftmp5, ftmp6);
+    felem_add(ftmp5, ftmp5, ftmp5);
+
+    y_equal = felem_is_zero(ftmp5);
+
+    if (x_equal && y_equal && !z1_is_zero && !z2_is_zero) {
+        point_double(x3, y3, z3, x1, y1, z1);
+        return;
+    }
+
+    /* I = ftmp = (2h)**2 */
+    felem_add(ftmp, ftmp4, ftmp4);
+    felem_square(ftmp, ftmp);
+
+    /* J = ftmp2 = h * I */
+    felem_mul(ftmp2, ftmp4, ftmp);
+
+    /* V = ftmp4 = U1 * I */
+    felem_mul(ftmp4, ftmp3, ftmp);
+
+    /* x_out = r**2 - J - 2V */
+    felem_square(x_out, ftmp5);
+    felem_sub(x_out, x_out, ftmp2);
+    felem_sub(x_out, x_out, ftmp4);
+    felem_sub(x_out, x_out, ftmp4);
+
+    /* y_out = r(V-x_out) - 2 * s1 * J */
+    felem_sub(ftmp3, ftmp4, x_out);
+    felem_mul(y_out, ftmp5, ftmp3);
+    felem_mul(ftmp6, ftmp6, ftmp2);
+    felem_add(ftmp6, ftmp6, ftmp6);
+    felem_sub(y_out, y_out, ftmp6);
+
+    copy_conditional(x_out, x2, z1_is_zero);
+    copy_conditional(x_out, x1, z2_is_zero);
+    copy_conditional(y_out, y2, z1_is_zero);
+    copy_conditional(y_out, y1, z2_is_zero);
+    copy_conditional(z_out, z2, z1_is_zero);
+    copy_conditional(z_out, z1, z2_is_zero);
+    felem_assign(x3, x_out);
+    felem_assign(y3, y_out);
+    felem_assign(z3, z_out);
+}
+
+/*-
+ * Base point pre computation
+ * --------------------------
+ *
+ * Two different sorts of precomputed tables are used in the following code.
+ * Each contain various points on the curve, where each point is three field
+ * elements (x, y, z).
+ *
+ * For the base point table, z is usually 1 (0 for the point at infinity).
+ * This table has 2 * 16 elements, starting with the following:
+ * index | bits    | point
+ * ------+---------+------------------------------
+ *     0 | 0 0 0 0 | 0G
+ *     1 | 0 0 0 1 | 1G
+ *     2 | 0 0 1 0 | 2^96G
+ *     3 | 0 0 1 1 | (2^96 + 1)G
+ *     4 | 0 1 0 0 | 2^192G
+ *     5 | 0 1 0 1 | (2^192 + 1)G
+ *     6 | 0 1 1 0 | (2^192 + 2^96)G
+ *     7 | 0 1 1 1 | (2^192 + 2^96 + 1)G
+ *     8 | 1 0 0 0 | 2^288G
+ *     9 | 1 0 0 1 | (2^288 + 1)G
+ *    10 | 1 0 1 0 | (2^288 + 2^96)G
+ *    11 | 1 0 1 1 | (2^288 + 2^96 + 1)G
+ *    12 | 1 1 0 0 | (2^288 + 2^192)G
+ *    13 | 1 1 0 1 | (2^288 + 2^192 + 1)G
+ *    14 | 1 1 1 0 | (2^288 + 2^192 + 2^96)G
+ *    15 | 1 1 1 1 | (2^288 + 2^192 + 2^96 + 1)G
+ * followed by a copy of this with each element multiplied by 2^48.
+ *
+ * The reason for this is so that we can clock bits into four different
+ * locations when doing simple scalar multiplies against the base point,
+ * and then another four locations using the second 16 elements.
+ *
+ * Tables for other points have table[i] = iG for i in 0 .. 16.
+ *
+ * All coordinates are in Montgomery form, so "1" is kOne. */
+
+/* gmul is the table of precomputed base points */
+static const felem gmul[2][16][3] = {
+    {{{0, 0, 0, 0, 0, 0},
+      {0, 0, 0, 0, 0, 0},
+      {0, 0, 0, 0, 0, 0}},
+     {{0x3dd0756649c0b528, 0x20e378e2a0d6ce38, 0x879c3afc541b4d6e,
+       0x6454868459a30eff, 0x812ff723614ede2b, 0x4d3aadc2299e1513},
+      {0x23043dad4b03a4fe, 0xa1bfa8bf7bb4a9ac, 0x8bade7562e83b050,
+       0xc6c3521968f4ffd9, 0xdd8002263969a840, 0x2b78abc25a15c5e9},
+      {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+       0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+     {{0x24480c57f26feef9, 0xc31a26943a0e1240, 0x735002c3273e2bc7,
+       0x8c42e9c53ef1ed4c, 0x028babf67f4948e8, 0x6a502f438a978632},
+      {0xf5f13a46b74536fe, 0x1d218babd8a9f0eb, 0x30f36bcc37232768,
+       0xc5317b31576e8c18, 0xef1d57a69bbcb766, 0x917c4930b3e3d4dc},
+      {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+       0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+     {{0x11426e2ee349ddd0, 0x9f117ef99b2fc250, 0xff36b480ec0174a6,
+       0x4f4bde7618458466, 0x2f2edb6d05806049, 0x8adc75d119dfca92},
+      {0xa619d097b7d5a7ce, 0x874275e5a34411e9, 0x5403e0470da4b4ef,
+       0x2ebaafd977901d8f, 0x5e63ebcea747170f, 0x12a369447f9d8036},
+      {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+       0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+     {{0x378205de2f9fbe67, 0xc4afcb837f728e44, 0xdbcec06c682e00f1,
+       0xf2a145c3114d5423, 0xa01d98747a52463e, 0xfc0935b17d717b0a},
+      {0x9653bc4fd4d01f95, 0x9aa83ea89560ad34, 0xf77943dcaf8e3f3f,
+       0x70774a10e86fe16e, 0x6b62e6f1bf9ffdcf, 0x8a72f39e588745c9},
+      {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+       0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+     {{0x73ade4da2341c342, 0xdd326e54ea704422, 0x336c7d983741cef3,
+       0x1eafa00d59e61549, 0xcd3ed892bd9a3efd, 0x03faf26cc5c6c7e4},
+      {0x087e2fcf3045f8ac, 0x14a65532174f1e73, 0x2cf84f28fe0af9a7,
+       0xddfd7a842cdc935b, 0x4c0f117b6929c895, 0x356572d64c8bcfcc},
+      {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+       0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+     {{0xfab086073f3b236f, 0x19e9d41d81e221da, 0xf3f6571e3927b428,
+       0x4348a9337550f1f6, 0x7167b996a85e62f0, 0x62d437597f5452bf},
+      {0xd85feb9ef2955926, 0x440a561f6df78353, 0x389668ec9ca36b59,
+       0x052bf1a1a22da016, 0xbdfbff72f6093254, 0x94e50f28e22209f3},
+      {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+       0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+     {{0x90b2e5b33062e8af, 0xa8572375e8a3d369, 0x3fe1b00b201db7b1,
+       0xe926def0ee651aa2, 0x6542c9beb9b10ad7, 0x098e309ba2fcbe74},
+      {0x779deeb3fff1d63f, 0x23d0e80a20bfd374, 0x8452bb3b8768f797,
+       0xcf75bb4d1f952856, 0x8fe6b40029ea3faa, 0x12bd3e4081373a53},
+      {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+       0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+     {{0x070d34e116973cf4, 0x20aee08b7e4f34f7, 0x269af9b95eb8ad29,
+       0xdde0a036a6a45dda, 0xa18b528e63df41e0, 0x03cc71b2a260df2a},
+      {0x24a6770aa06b1dd7, 0x5bfa9c119d2675d3, 0x73c1e2a196844432,
+       0x3660558d131a6cf0, 0xb0289c832ee79454, 0xa6aefb01c6d8ddcd},
+      {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+       0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+     {{0xba1464b401ab5245, 0x9b8d0b6dc48d93ff, 0x939867dc93ad272c,
+       0xbebe085eae9fdc77, 0x73ae5103894ea8bd, 0x740fc89a39ac22e1},
+      {0x5e28b0a328e23b23, 0x2352722ee13104d0, 0xf4667a18b0a2640d,
+       0xac74a72e49bb37c3, 0x79f734f0e81e183a, 0xbffe5b6c3fd9c0eb},
+      {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+       0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+     {{0x03cf292200623f3b, 0x095c71115f29ebff, 0x42d7224780aa6823,
+       0x044c7ba17458c0b0, 0xca62f7ef0959ec20, 0x40ae2ab7f8ca929f},
+      {0xb8c5377aa927b102, 0x398a86a0dc031771, 0x04908f9dc216a406,
+       0xb423a73a918d3300, 0x634b0ff1e0b94739, 0xe29de7252d69f697},
+      {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+       0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+     {{0x744d14008435af04, 0x5f255b1dfec192da, 0x1f17dc12336dc542,
+       0x5c90c2a7636a68a8, 0x960c9eb77704ca1e, 0x9de8cf1e6fb3d65a},
+      {0xc60fee0d511d3d06, 0x466e2313f9eb52c7, 0x743c0f5f206b0914,
+       0x42f55bac2191aa4d, 0xcefc7c8fffebdbc2, 0xd4fa6081e6e8ed1c},
+      {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+       0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+     {{0x867db63998683186, 0xfb5cf424ddcc4ea9, 0xcc9a7ffed4f0e7bd,
+       0x7c57f71c7a779f7e, 0x90774079d6b25ef2, 0x90eae903b4081680},
+      {0xdf2aae5e0ee1fceb, 0x3ff1da24e86c1a1f, 0x80f587d6ca193edf,
+       0xa5695523dc9b9d6a, 0x7b84090085920303, 0x1efa4dfcba6dbdef},
+      {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+       0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+     {{0xfbd838f9e0540015, 0x2c323946c39077dc, 0x8b1fb9e6ad619124,
+       0x9612440c0ca62ea8, 0x9ad9b52c2dbe00ff, 0xf52abaa1ae197643},
+      {0xd0e898942cac32ad, 0xdfb79e4262a98f91, 0x65452ecf276f55cb,
+       0xdb1ac0d27ad23e12, 0xf68c5f6ade4986f0, 0x389ac37b82ce327d},
+      {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+       0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+     {{0xcd96866db8a9e8c9, 0xa11963b85bb8091e, 0xc7f90d53045b3cd2,
+       0x755a72b580f36504, 0x46f8b39921d3751c, 0x4bffdc9153c193de},
+      {0xcd15c049b89554e7, 0x353c6754f7a26be6, 0x79602370bd41d970,
+       0xde16470b12b176c0, 0x56ba117540c8809d, 0xe2db35c3e435fb1e},
+      {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+       0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+     {{0xd71e4aab6328e33f, 0x5486782baf8136d1, 0x07a4995f86d57231,
+       0xf1f0a5bd1651a968, 0xa5dc5b2476803b6d, 0x5c587cbc42dda935},
+      {0x2b6cdb32bae8b4c0, 0x66d1598bb1331138, 0x4a23b2d25d7e9614,
+       0x93e402a674a8c05d, 0x45ac94e6da7ce82e, 0xeb9f8281e463d465},
+      {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+       0x0000000000000000, 0x0000000000000000, 0x0000000000000000}}},
+    {{{0, 0, 0, 0, 0, 0},
+      {0, 0, 0, 0, 0, 0},
+      {0, 0, 0, 0, 0, 0}},
+     {{0x298647532b0c535b, 0x90dd695370506296, 0x038cd6b4216ab9ac,
+       0x3df9b7b7be12d76a, 0x13f4d9785f347bdb, 0x222c5c9c13e94489},
+      {0x5f8e796f2680dc64, 0x120e7cb758352417, 0x254b5d8ad10740b8,
+       0xc38b8efb5337dee6, 0xf688c2e194f02247, 0x7b5c75f36c25bc4c},
+      {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+       0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+     {{0x5584cbb3893b9a2d, 0x820c660b00850c5d, 0x4126d8267df2d43d,
+       0xdd5bbbf00109e801, 0x85b92ee338172f1c, 0x609d4f93f31430d9},
+      {0x1e059a07eadaf9d6, 0x70e6536c0f125fb0, 0xd6220751560f20e7,
+       0xa59489ae7aaf3a9a, 0x7b70e2f664bae14e, 0x0dd0370176d08249},
+      {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+       0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+     {{0xc07611f4df5bdf53, 0x45d331a758b11a6d, 0x58965daf1c4ee394,
+       0xba8bebe75a5878d1, 0xaecc0a1882dd3025, 0xcf2a3899a923eb8b},
+      {0xf98c9281d24fd048, 0x841bfb598bbb025d, 0xb8ddf8cec9ab9d53,
+       0x538a4cb67fef044e, 0x092ac21f23236662, 0xa919d3850b66f065},
+      {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+       0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+     {{0xc0426b775e3c647b, 0xbfcbd9398cf05348, 0x31d312e3172c0d3d,
+       0x5f49fde6ee754737, 0x895530f06da7ee61, 0xcf281b0ae8b3a5fb},
+      {0xfd14973541b8a543, 0x41a625a73080dd30, 0xe2baae07653908cf,
+       0xc3d01436ba02a278, 0xa0d0222e7b21b8f8, 0xfdc270e9d7ec1297},
+      {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+       0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+     {{0x4e50430efc14ab48, 0x195b7f4f26706a74, 0x2fe8a228cc881ff6,
+       0xb1b968e2d945013d, 0x936aa5794b92162b, 0x4fb766b7364e754a},
+      {0x13f93bca31e1ff7f, 0x696eb5cace4f2691, 0xff754bf8a2b09e02,
+       0x58f13c9ce58e3ff8, 0xb757346f1678c0b0, 0xd54200dba86692b3},
+      {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+       0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+     {{0x5cd9f5a87237cac0, 0x93f0b59d43586794, 0x4384a764e94f6c4e,
+       0x8304ed2bb62782d3, 0x0b8db8b3cde06015, 0x4336dd535dbe190f},
+      {0x5744355392ab473a, 0x031c7275be5ed046, 0x3e78678c21909aa4,
+       0x4ab7e04f99202ddb, 0x2648d2066977e635, 0xd427d184093198be},
+      {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+       0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+     {{0x8e74dc3579efdc58, 0x456bd3694ff68ddb, 0x724e74ccd32096a5,
+       0xe41cff42386783d0, 0xa04c7f217c70d8a4, 0x41199d2fe61a19a2},
+      {0xd389a3e029c05dd2, 0x535f2a6be7e3fda9, 0x26ecf72d7c2b4df8,
+       0x678275f4fe745294, 0x6319c9cc9d23f519, 0x1e05a02d88048fc4},
+      {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+       0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+     {{0x87c7dd7d139b3239, 0x8b57824e4d833bae, 0xbcbc48789fff0015,
+       0x8ffcef8b909eaf1a, 0x9905f4eef1443a78, 0x020dd4a2e15cbfed},
+      {0xca2969eca306d695, 0xdf940cadb93caf60, 0x67f7fab787ea6e39,
+       0x0d0ee10ff98c4fe5, 0xc646879ac19cb91e, 0x4b4ea50c7d1d7ab4},
+      {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+       0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+     {{0xd6d9aec823e4712c, 0x7ca8376cc3c198ee, 0xe6d8318731bebd8a,
+       0xed57aff3d88bfef3, 0x72a645eecf44edc7, 0xd4e63d0b5cbb1517},
+      {0x98ce7a1cceee0ecf, 0x8f0126335383ee8e, 0x3b879078a6b455e8,
+       0xcbcd3d96c7658c06, 0x721d6fe70783336a, 0xf21a72635a677136},
+      {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+       0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+     {{0x18482cec9b3f5034, 0x962d445acd9e68fd, 0x266fb1d695746f23,
+       0xc66ade5a58c94a4b, 0xdbbda826ed68a5b6, 0x05664a4d7ab0d6ae},
+      {0xbcd4fe51025e32fc, 0x61a5aebfa96df252, 0xd88a07e231592a31,
+       0x5d9d94de98905517, 0x96bb40105fd440e7, 0x1b0c47a2e807db4c},
+      {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+       0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+     {{0xc1004cff44b2e045, 0x91b5e1364b1c05d4, 0x53ae409088a48a07,
+       0x73fb2995ea11bb1a, 0x320485703d93a4ea, 0xcce45de83bfc8a5f},
+      {0xaff4a97ec2b3106e, 0x9069c630b6848b4f, 0xeda837a6ed76241c,
+       0x8a0daf136cc3f6cf, 0x199d049d3da018a8, 0xf867c6b1d9093ba3},
+      {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+       0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+     {{0x5285d116141d161c, 0x67cd2e0e93c4ed17, 0x12c62a647c36187e,
+       0xf5329539ed2584ca, 0xc4c777c442fbbd69, 0x107de7761bdfc50a},
+      {0x9976dcc5e96beebd, 0xbe2aff95a865a151, 0x0e0a9da19d8872af,
+       0x5e357a3da63c17cc, 0xd31fdfd8e15cc67c, 0xc44bbefd7970c6d8},
+      {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+       0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+     {{0x1a60d1522ca8f2fe, 0x61640948491bd41f, 0x6dae29a558dfe035,
+       0x9a615bea278e4863, 0xbbdb44779ad7c8e5, 0x1c7066302ceac2fc},
+      {0x5e2b54c699699b4b, 0xb509ca6d239e17e8, 0x728165feea063a82,
+       0x6b5e609db6a22e02, 0x12813905b26ee1df, 0x07b9f722439491fa},
+      {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+       0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+     {{0xaa9da167b8153a9d, 0xa49fe3ac9e83ecf0, 0x14c18f8e1b661384,
+       0x61c24dab38434de1, 0x3d973c3a283dae96, 0xc99baa0182754fc9},
+      {0x477d198f4c26b1e3, 0x12e8e186a7516202, 0x386e52f6362addfa,
+       0x31e8f695c3962853, 0xdec2af136aaedb60, 0xfcfdb4c629cf74ac},
+      {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+       0x0000000000000000, 0x0000000000000000, 0x0000000000000000}},
+     {{0xe361a1987ffa0a5f, 0xf4b26102c63fe109, 0x264acbc56c74e111,
+       0x4af445fa77abebaf, 0x448c4fdd24cddb75, 0x0b13157d44506eea},
+      {0x22a6b15972e9993d, 0x2c3c57e485e5ecbe, 0xa673560bfd83e1a1,
+       0x6be23f82c3b8c83b, 0x40b13a9640bbe38e, 0x66eea033ad17399b},
+      {0xffffffff00000001, 0x00000000ffffffff, 0x0000000000000001,
+       0x0000000000000000, 0x0000000000000000, 0x0000000000000000}}}
+};
+
+/*
+ * select_point selects the |idx|th point from a precomputation table and
+ * copies it to out.
+ */
+static void select_point(const u64 idx, unsigned int size,
+                         const felem pre_comp[][3], felem out[3])
+{
+    unsigned i, j;
+    limb *outlimbs = &out[0][0];
+    memset(outlimbs, 0, 3 * sizeof(felem));
+
+    for (i = 0; i < size; i++) {
+        const limb *inlimbs = &pre_comp[i][0][0];
+        u64 mask = i ^ idx;
+        mask |= mask >> 4;
+        mask |= mask >> 2;
+        mask |= mask >> 1;
+        mask &= 1;
+        mask--;
+        for (j = 0; j < NLIMBS * 3; j++)
+            outlimbs[j] |= inlimbs[j] & mask;
+    }
+}
+
+/* get_bit returns the |i|th bit in |in| */
+static char get_bit(const felem_bytearray in, int i)
+{
+    if ((i < 0) || (i >= 384))
+        return 0;
+    return (in[i >> 3] >> (i & 7)) & 1;
+}
+
+/*
+ * Interleaved point multiplication using precomputed point multiples: The
+ * small point multiples 0*P, 1*P, ..., 16*P are in pre_comp[], the scalars
+ * in scalars[]. If g_scalar is non-NULL, we also add this multiple of the
+ * generator, using certain (large) precomputed multiples in g_pre_comp.
+ * Output point (X, Y, Z) is stored in x_out, y_out, z_out
+ */
+static void batch_mul(felem x_out, felem y_out, felem z_out,
+                      const felem_bytearray scalars[],
+                      const unsigned num_points, const u8 *g_scalar,
+                      const int mixed, const felem pre_comp[][17][3],
+                      const felem g_pre_comp[2][16][3])
+{
+    int i, skip;
+    unsigned num, gen_mul = (g_scalar != NULL);
+    felem nq[3], tmp[3], ftmp;
+    u64 bits;
+    u8 sign, digit;
+
+    /* set nq to the point at infinity */
+    memset(nq, 0, 3 * sizeof(felem));
+
+    /*
+     * Loop over all scalars msb-to-lsb, interleaving additions of multiples
+     * of the generator (two in each of the last 48 rounds) and additions of
+     * other points multiples (every 5th round).
+     */
+    skip = 1;                   /* save two point operations in the first
+                                 * round */
+    for (i = (num_points ? 383 : 47); i >= 0; --i) {
+        /* double */
+        if (!skip)
+            point_double(nq[0], nq[1], nq[2], nq[0], nq[1], nq[2]);
+
+        /* add multiples of the generator */
+        if (gen_mul && (i <= 47)) {
+            /* first, look 48 bits upwards */
+            bits = get_bit(g_scalar, i + 336) << 3;
+            bits |= get_bit(g_scalar, i + 240) << 2;
+            bits |= get_bit(g_scalar, i + 144) << 1;
+            bits |= get_bit(g_scalar, i + 48);
+            /* select the point to add, in constant time */
+            select_point(bits, 16, g_pre_comp[1], tmp);
+
+            if (!skip) {
+                /* Arg 1 below is for "mixed" */
+                point_add(nq[0], nq[1], nq[2],
+                          nq[0], nq[1], nq[2], 1, tmp[0], tmp[1], tmp[2]);
+            } else {
+                memcpy(nq, tmp, 3 * sizeof(felem));
+                skip = 0;
+            }
+
+            /* second, look at the current position */
+            bits = get_bit(g_scalar, i + 288) << 3;
+            bits |= get_bit(g_scalar, i + 192) << 2;
+            bits |= get_bit(g_scalar, i + 96) << 1;
+            bits |= get_bit(g_scalar, i);
+            /* select the point to add, in constant time */
+            select_point(bits, 16, g_pre_comp[0], tmp);
+            /* Arg 1 below is for "mixed" */
+            point_add(nq[0], nq[1], nq[2],
+                      nq[0], nq[1], nq[2], 1, tmp[0], tmp[1], tmp[2]);
+        }
+
+        /* do other additions every 5 doublings */
+        if (num_points && (i % 5 == 0)) {
+            /* loop over all scalars */
+            for (num = 0; num < num_points; ++num) {
+                bits = get_bit(scalars[num], i + 4) << 5;
+                bits |= get_bit(scalars[num], i + 3) << 4;
+                bits |= get_bit(scalars[num], i + 2) << 3;
+                bits |= get_bit(scalars[num], i + 1) << 2;
+                bits |= get_bit(scalars[num], i) << 1;
+                bits |= get_bit(scalars[num], i - 1);
+                ec_GFp_nistp_recode_scalar_bits(&sign, &digit, bits);
+
+                /*
+                 * select the point to add or subtract, in constant time
+                 */
+                select_point(digit, 17, pre_comp[num], tmp);
+                felem_neg(ftmp, tmp[1]); /* (X, -Y, Z) is the negative
+                                          * point */
+                copy_conditional(ftmp, tmp[1], (((limb) sign) - 1));
+                felem_assign(tmp[1], ftmp);
+
+                if (!skip) {
+                    point_add(nq[0], nq[1], nq[2],
+                              nq[0], nq[1], nq[2],
+                              mixed, tmp[0], tmp[1], tmp[2]);
+                } else {
+                    memcpy(nq, tmp, 3 * sizeof(felem));
+                    skip = 0;
+                }
+            }
+        }
+    }
+    felem_assign(x_out, nq[0]);
+    felem_assign(y_out, nq[1]);
+    felem_assign(z_out, nq[2]);
+}
+
+/* Precomputation for the group generator. */
+typedef struct {
+    felem g_pre_comp[2][16][3];
+    int references;
+} NISTP384_PRE_COMP;
+
+const EC_METHOD *EC_GFp_nistp384_method(void)
+{
+    static const EC_METHOD ret = {
+        EC_FLAGS_DEFAULT_OCT,
+        NID_X9_62_prime_field,
+        ec_GFp_nistp384_group_init,
+        ec_GFp_simple_group_finish,
+        ec_GFp_simple_group_clear_finish,
+        ec_GFp_nist_group_copy,
+        ec_GFp_nistp384_group_set_curve,
+        ec_GFp_simple_group_get_curve,
+        ec_GFp_simple_group_get_degree,
+        ec_GFp_simple_group_check_discriminant,
+        ec_GFp_simple_point_init,
+        ec_GFp_simple_point_finish,
+        ec_GFp_simple_point_clear_finish,
+        ec_GFp_simple_point_copy,
+        ec_GFp_simple_point_set_to_infinity,
+        ec_GFp_simple_set_Jprojective_coordinates_GFp,
+        ec_GFp_simple_get_Jprojective_coordinates_GFp,
+        ec_GFp_simple_point_set_affine_coordinates,
+        ec_GFp_nistp384_point_get_affine_coordinates,
+        0 /* point_set_compressed_coordinates */ ,
+        0 /* point2oct */ ,
+        0 /* oct2point */ ,
+        ec_GFp_simple_add,
+        ec_GFp_simple_dbl,
+        ec_GFp_simple_invert,
+        ec_GFp_simple_is_at_infinity,
+        ec_GFp_simple_is_on_curve,
+        ec_GFp_simple_cmp,
+        ec_GFp_simple_make_affine,
+        ec_GFp_simple_points_make_affine,
+        ec_GFp_nistp384_points_mul,
+        ec_GFp_nistp384_precompute_mult,
+        ec_GFp_nistp384_have_precompute_mult,
+        ec_GFp_nist_field_mul,
+        ec_GFp_nist_field_sqr,
+        0 /* field_div */ ,
+        0 /* field_encode */ ,
+        0 /* field_decode */ ,
+        0                       /* field_set_to_one */
+    };
+
+    return &ret;
+}
+
+/******************************************************************************/
+/*
+ * FUNCTIONS TO MANAGE PRECOMPUTATION
+ */
+
+static NISTP384_PRE_COMP *nistp384_pre_comp_new()
+{
+    NISTP384_PRE_COMP *ret = NULL;
+    ret = (NISTP384_PRE_COMP *) OPENSSL_malloc(sizeof *ret);
+    if (!ret) {
+        ECerr(EC_F_NISTP384_PRE_COMP_NEW, ERR_R_MALLOC_FAILURE);
+        return ret;
+    }
+    memset(ret->g_pre_comp, 0, sizeof(ret->g_pre_comp));
+    ret->references = 1;
+    return ret;
+}
+
+static void *nistp384_pre_comp_dup(void *src_)
+{
+    NISTP384_PRE_COMP *src = src_;
+
+    /* no need to actually copy, these objects never change! */
+    CRYPTO_add(&src->references, 1, CRYPTO_LOCK_EC_PRE_COMP);
+
+    return src_;
+}
+
+static void nistp384_pre_comp_free(void *pre_)
+{
+    int i;
+    NISTP384_PRE_COMP *pre = pre_;
+
+    if (!pre)
+        return;
+
+    i = CRYPTO_add(&pre->references, -1, CRYPTO_LOCK_EC_PRE_COMP);
+    if (i > 0)
+        return;
+
+    OPENSSL_free(pre);
+}
+
+static void nistp384_pre_comp_clear_free(void *pre_)
+{
+    int i;
+    NISTP384_PRE_COMP *pre = pre_;
+
+    if (!pre)
+        return;
+
+    i = CRYPTO_add(&pre->references, -1, CRYPTO_LOCK_EC_PRE_COMP);
+    if (i > 0)
+        return;
+
+    OPENSSL_cleanse(pre, sizeof *pre);
+    OPENSSL_free(pre);
+}
+
+/******************************************************************************/
+/*
+ * OPENSSL EC_METHOD FUNCTIONS
+ */
+
+int ec_GFp_nistp384_group_init(EC_GROUP *group)
+{
+    int ret;
+    ret = ec_GFp_simple_group_init(group);
+    group->a_is_minus3 = 1;
+    return ret;
+}
+
+int ec_GFp_nistp384_group_set_curve(EC_GROUP *group, const BIGNUM *p,
+                                    const BIGNUM *a, const BIGNUM *b,
+                                    BN_CTX *ctx)
+{
+    int ret = 0;
+    BN_CTX *new_ctx = NULL;
+    BIGNUM *curve_p, *curve_a, *curve_b;
+
+    if (ctx == NULL)
+        if ((ctx = new_ctx = BN_CTX_new()) == NULL)
+            return 0;
+    BN_CTX_start(ctx);
+    if (((curve_p = BN_CTX_get(ctx)) == NULL) ||
+        ((curve_a = BN_CTX_get(ctx)) == NULL) ||
+        ((curve_b = BN_CTX_get(ctx)) == NULL))
+        goto err;
+    BN_bin2bn(nistp384_curve_params[0], sizeof(felem_bytearray), curve_p);
+    BN_bin2bn(nistp384_curve_params[1], sizeof(felem_bytearray), curve_a);
+    BN_bin2bn(nistp384_curve_params[2], sizeof(felem_bytearray), curve_b);
+    if ((BN_cmp(curve_p, p)) || (BN_cmp(curve_a, a)) || (BN_cmp(curve_b, b))) {
+        ECerr(EC_F_EC_GFP_NISTP384_GROUP_SET_CURVE,
+              EC_R_WRONG_CURVE_PARAMETERS);
+        goto err;
+    }
+    group->field_mod_func = BN_nist_mod_384;
+    ret = ec_GFp_simple_group_set_curve(group, p, a, b, ctx);
+ err:
+    BN_CTX_end(ctx);
+    if (new_ctx != NULL)
+        BN_CTX_free(new_ctx);
+    return ret;
+}
+
+/*
+ * Takes the Jacobian coordinates (X, Y, Z) of a point and returns (X', Y') =
+ * (X/Z^2, Y/Z^3)
+ */
+int ec_GFp_nistp384_point_get_affine_coordinates(const EC_GROUP *group,
+                                                 const EC_POINT *point,
+                                                 BIGNUM *x, BIGNUM *y,
+                                                 BN_CTX *ctx)
+{
+    felem z1, z2, x_in, y_in, x_out, y_out;
+
+    if (EC_POINT_is_at_infinity(group, point)) {
+        ECerr(EC_F_EC_GFP_NISTP384_POINT_GET_AFFINE_COORDINATES,
+              EC_R_POINT_AT_INFINITY);
+        return 0;
+    }
+    if ((!BN_to_felem(x_in, point->X)) || (!BN_to_felem(y_in, point->Y)) ||
+        (!BN_to_felem(z1, point->Z)))
+        return 0;
+    felem_inv(z2, z1);
+    felem_square(z1, z2);
+    felem_mul(x_out, x_in, z1);
+    if (x != NULL) {
+        if (!felem_to_BN(x, x_out)) {
+            ECerr(EC_F_EC_GFP_NISTP384_POINT_GET_AFFINE_COORDINATES,
+                  ERR_R_BN_LIB);
+            return 0;
+        }
+    }
+    felem_mul(z1, z1, z2);
+    felem_mul(y_out, y_in, z1);
+    if (y != NULL) {
+        if (!felem_to_BN(y, y_out)) {
+            ECerr(EC_F_EC_GFP_NISTP384_POINT_GET_AFFINE_COORDINATES,
+                  ERR_R_BN_LIB);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* points below is of size |num|, and tmp_felems is of size |num+1| */
+static void make_points_affine(size_t num, felem points[][3],
+                               felem tmp_felems[])
+{
+    /*
+     * Runs in constant time, unless an input is the point at infinity (which
+     * normally shouldn't happen).
+     */
+    ec_GFp_nistp_points_make_affine_internal(num,
+                                             points,
+                                             sizeof(felem),
+                                             tmp_felems,
+                                             (void (*)(void *))felem_one,
+                                             (int (*)(const void *))
+                                             felem_is_zero_int,
+                                             (void (*)(void *, const void *))
+                                             felem_assign,
+                                             (void (*)(void *, const void *))
+                                             felem_square,
+                                             (void (*)
+                                              (void *, const void *,
+                                               const void *))
+                                             felem_mul,
+                                             (void (*)(void *, const void *))
+                                             felem_inv,
+                                             /* nothing to contract */
+                                             (void (*)(void *, const void *))
+                                             felem_assign);
+}
+
+/*
+ * Computes scalar*generator + \sum scalars[i]*points[i], ignoring NULL
+ * values Result is stored in r (r can equal one of the inputs).
+ */
+int ec_GFp_nistp384_points_mul(const EC_GROUP *group, EC_POINT *r,
+                               const BIGNUM *scalar, size_t num,
+                               const EC_POINT *points[],
+                               const BIGNUM *scalars[], BN_CTX *ctx)
+{
+    int ret = 0;
+    int j;
+    int mixed = 0;
+    BN_CTX *new_ctx = NULL;
+    BIGNUM *x, *y, *z, *tmp_scalar;
+    felem_bytearray g_secret;
+    felem_bytearray *secrets = NULL;
+    felem(*pre_comp)[17][3] = NULL;
+    felem *tmp_felems = NULL;
+    felem_bytearray tmp;
+    unsigned i, num_bytes;
+    int have_pre_comp = 0;
+    size_t num_points = num;
+    felem x_out, y_out, z_out;
+    NISTP384_PRE_COMP *pre = NULL;
+    const felem(*g_pre_comp)[16][3] = NULL;
+    EC_POINT *generator = NULL;
+    const EC_POINT *p = NULL;
+    const BIGNUM *p_scalar = NULL;
+
+    if (ctx == NULL)
+        if ((ctx = new_ctx = BN_CTX_new()) == NULL)
+            return 0;
+    BN_CTX_start(ctx);
+    if (((x = BN_CTX_get(ctx)) == NULL) ||
+        ((y = BN_CTX_get(ctx)) == NULL) ||
+        ((z = BN_CTX_get(ctx)) == NULL) ||
+        ((tmp_scalar = BN_CTX_get(ctx)) == NULL))
+        goto err;
+
+    if (scalar != NULL) {
+        pre = EC_EX_DATA_get_data(group->extra_data,
+                                  nistp384_pre_comp_dup,
+                                  nistp384_pre_comp_free,
+                                  nistp384_pre_comp_clear_free);
+        if (pre)
+            /* we have precomputation, try to use it */
+            g_pre_comp = (const felem(*)[16][3])pre->g_pre_comp;
+        else
+            /* try to use the standard precomputation */
+            g_pre_comp = &gmul[0];
+        generator = EC_POINT_new(group);
+        if (generator == NULL)
+            goto err;
+        /* get the generator from precomputation */
+        if (!felem_to_BN(x, g_pre_comp[0][1][0]) ||
+            !felem_to_BN(y, g_pre_comp[0][1][1]) ||
+            !felem_to_BN(z, g_pre_comp[0][1][2])) {
+            ECerr(EC_F_EC_GFP_NISTP384_POINTS_MUL, ERR_R_BN_LIB);
+            goto err;
+        }
+        if (!EC_POINT_set_Jprojective_coordinates_GFp(group,
+                                                      generator, x, y, z,
+                                                      ctx))
+            goto err;
+        if (0 == EC_POINT_cmp(group, generator, group->generator, ctx))
+            /* precomputation matches generator */
+            have_pre_comp = 1;
+        else
+            /*
+             * we don't have valid precomputation: treat the generator as a
+             * random point
+             */
+            num_points++;
+    }
+    if (num_points > 0) {
+        if (num_points >= 3) {
+            /*
+             * unless we precompute multiples for just one or two points,
+             * converting those into affine form is time well spent
+             */
+            mixed = 1;
+        }
+        secrets = OPENSSL_malloc(num_points * sizeof(felem_bytearray));
+        pre_comp = OPENSSL_malloc(num_points * 17 * 3 * sizeof(felem));
+        if (mixed)
+            tmp_felems =
+                OPENSSL_malloc((num_points * 17 + 1) * sizeof(felem));
+        if ((secrets == NULL) || (pre_comp == NULL)
+            || (mixed && (tmp_felems == NULL))) {
+            ECerr(EC_F_EC_GFP_NISTP384_POINTS_MUL, ERR_R_MALLOC_FAILURE);
+            goto err;
+        }
+
+        /*
+         * we treat NULL scalars as 0, and NULL points as points at infinity,
+         * i.e., they contribute nothing to the linear combination
+         */
+        memset(secrets, 0, num_points * sizeof(felem_bytearray));
+        memset(pre_comp, 0, num_points * 17 * 3 * sizeof(felem));
+        for (i = 0; i < num_points; ++i) {
+            if (i == num)
+                /*
+                 * we didn't have a valid precomputation, so we pick the
+                 * generator
+                 */
+            {
+                p = EC_GROUP_get0_generator(group);
+                p_scalar = scalar;
+            } else
+                /* the i^th point */
+            {
+                p = points[i];
+                p_scalar = scalars[i];
+            }
+            if ((p_scalar != NULL) && (p != NULL)) {
+                /* reduce scalar to 0 <= scalar < 2^384 */
+                if ((BN_num_bits(p_scalar) > 384)
+                    || (BN_is_negative(p_scalar))) {
+                    /*
+                     * this is an unusual input, and we don't guarantee
+                     * constant-timeness
+                     */
+                    if (!BN_nnmod(tmp_scalar, p_scalar, group->order, ctx)) {
+                        ECerr(EC_F_EC_GFP_NISTP384_POINTS_MUL, ERR_R_BN_LIB);
+                        goto err;
+                    }
+                    num_bytes = BN_bn2bin(tmp_scalar, tmp);
+                } else
+                    num_bytes = BN_bn2bin(p_scalar, tmp);
+                flip_endian(secrets[i], tmp, num_bytes);
+                /* precompute multiples */
+                if ((!BN_to_felem(pre_comp[i][1][0], p->X)) ||
+                    (!BN_to_felem(pre_comp[i][1][1], p->Y)) ||
+                    (!BN_to_felem(pre_comp[i][1][2], p->Z)))
+                    goto err;
+                for (j = 2; j <= 16; ++j) {
+                    if (j & 1) {
+                        point_add(pre_comp[i][j][0], pre_comp[i][j][1],
+                                  pre_comp[i][j][2], pre_comp[i][1][0],
+                                  pre_comp[i][1][1], pre_comp[i][1][2], 0,
+                                  pre_comp[i][j - 1][0],
+                                  pre_comp[i][j - 1][1],
+                                  pre_comp[i][j - 1][2]);
+                    } else {
+                        point_double(pre_comp[i][j][0], pre_comp[i][j][1],
+                                     pre_comp[i][j][2], pre_comp[i][j / 2][0],
+                                     pre_comp[i][j / 2][1],
+                                     pre_comp[i][j / 2][2]);
+                    }
+                }
+            }
+        }
+        if (mixed)
+            make_points_affine(num_points * 17, pre_comp[0], tmp_felems);
+    }
+
+    /* the scalar for the generator */
+    if ((scalar != NULL) && (have_pre_comp)) {
+        memset(g_secret, 0, sizeof(g_secret));
+        /* reduce scalar to 0 <= scalar < 2^384 */
+        if ((BN_num_bits(scalar) > 384) || (BN_is_negative(scalar))) {
+            /*
+             * this is an unusual input, and we don't guarantee
+             * constant-timeness
+             */
+            if (!BN_nnmod(tmp_scalar, scalar, group->order, ctx)) {
+                ECerr(EC_F_EC_GFP_NISTP384_POINTS_MUL, ERR_R_BN_LIB);
+                goto err;
+            }
+            num_bytes = BN_bn2bin(tmp_scalar, tmp);
+        } else
+            num_bytes = BN_bn2bin(scalar, tmp);
+        flip_endian(g_secret, tmp, num_bytes);
+        /* do the multiplication with generator precomputation */
+        batch_mul(x_out, y_out, z_out,
+                  (const felem_bytearray(*))secrets, num_points,
+                  g_secret,
+                  mixed, (const felem(*)[17][3])pre_comp, g_pre_comp);
+    } else
+        /* do the multiplication without generator precomputation */
+        batch_mul(x_out, y_out, z_out,
+                  (const felem_bytearray(*))secrets, num_points,
+                  NULL, mixed, (const felem(*)[17][3])pre_comp, NULL);
+    if ((!felem_to_BN(x, x_out)) || (!felem_to_BN(y, y_out)) ||
+        (!felem_to_BN(z, z_out))) {
+        ECerr(EC_F_EC_GFP_NISTP384_POINTS_MUL, ERR_R_BN_LIB);
+        goto err;
+    }
+    ret = EC_POINT_set_Jprojective_coordinates_GFp(group, r, x, y, z, ctx);
+
+ err:
+    BN_CTX_end(ctx);
+    EC_POINT_free(generator);
+    if (new_ctx != NULL)
+        BN_CTX_free(new_ctx);
+    if (secrets != NULL) {
+        OPENSSL_cleanse(secrets, num_points * sizeof(felem_bytearray));
+        OPENSSL_free(secrets);
+    }
+    if (pre_comp != NULL)
+        OPENSSL_free(pre_comp);
+    if (tmp_felems != NULL)
+        OPENSSL_free(tmp_felems);
+    OPENSSL_cleanse(g_secret, sizeof(g_secret));
+    OPENSSL_cleanse(tmp, sizeof(tmp));
+    return ret;
+}
+
+int ec_GFp_nistp384_precompute_mult(EC_GROUP *group, BN_CTX *ctx)
+{
+    int ret = 0;
+    NISTP384_PRE_COMP *pre = NULL;
+    int i, j;
+    BN_CTX *new_ctx = NULL;
+    BIGNUM *x, *y;
+    EC_POINT *generator = NULL;
+    felem tmp_felems[32];
+
+    /* throw away old precomputation */
+    EC_EX_DATA_free_data(&group->extra_data, nistp384_pre_comp_dup,
+                         nistp384_pre_comp_free,
+                         nistp384_pre_comp_clear_free);
+    if (ctx == NULL)
+        if ((ctx = new_ctx = BN_CTX_new()) == NULL)
+            return 0;
+    BN_CTX_start(ctx);
+    if (((x = BN_CTX_get(ctx)) == NULL) || ((y = BN_CTX_get(ctx)) == NULL))
+        goto err;
+    /* get the generator */
+    if (group->generator == NULL)
+        goto err;
+    generator = EC_POINT_new(group);
+    if (generator == NULL)
+        goto err;
+    BN_bin2bn(nistp384_curve_params[3], sizeof(felem_bytearray), x);
+    BN_bin2bn(nistp384_curve_params[4], sizeof(felem_bytearray), y);
+    if (!EC_POINT_set_affine_coordinates_GFp(group, generator, x, y, ctx))
+        goto err;
+    if ((pre = nistp384_pre_comp_new()) == NULL)
+        goto err;
+    /*
+     * if the generator is the standard one, use built-in precomputation
+     */
+    if (0 == EC_POINT_cmp(group, generator, group->generator, ctx)) {
+        memcpy(pre->g_pre_comp, gmul, sizeof(pre->g_pre_comp));
+        goto done;
+    }
+    if ((!BN_to_felem(pre->g_pre_comp[0][1][0], group->generator->X)) ||
+        (!BN_to_felem(pre->g_pre_comp[0][1][1], group->generator->Y)) ||
+        (!BN_to_felem(pre->g_pre_comp[0][1][2], group->generator->Z)))
+        goto err;
+    /*
+     * compute 2^96*G, 2^192*G, 2^288*G for the first table, 2^48*G, 2^144*G,
+     * 2^240*G, 2^336*G for the second one
+     */
+    for (i = 1; i <= 8; i <<= 1) {
+        point_double(pre->g_pre_comp[1][i][0], pre->g_pre_comp[1][i][1],
+                     pre->g_pre_comp[1][i][2], pre->g_pre_comp[0][i][0],
+                     pre->g_pre_comp[0][i][1], pre->g_pre_comp[0][i][2]);
+        for (j = 0; j < 47; ++j) {
+            point_double(pre->g_pre_comp[1][i][0], pre->g_pre_comp[1][i][1],
+                         pre->g_pre_comp[1][i][2], pre->g_pre_comp[1][i][0],
+                         pre->g_pre_comp[1][i][1], pre->g_pre_comp[1][i][2]);
+        }
+        if (i == 8)
+            break;
+        point_double(pre->g_pre_comp[0][2 * i][0],
+                     pre->g_pre_comp[0][2 * i][1],
+                     pre->g_pre_comp[0][2 * i][2], pre->g_pre_comp[1][i][0],
+                     pre->g_pre_comp[1][i][1], pre->g_pre_comp[1][i][2]);
+        for (j = 0; j < 47; ++j) {
+            point_double(pre->g_pre_comp[0][2 * i][0],
+                         pre->g_pre_comp[0][2 * i][1],
+                         pre->g_pre_comp[0][2 * i][2],
+                         pre->g_pre_comp[0][2 * i][0],
+                         pre->g_pre_comp[0][2 * i][1],
+                         pre->g_pre_comp[0][2 * i][2]);
+        }
+    }
+    for (i = 0; i < 2; i++) {
+        /* g_pre_comp[i][0] is the point at infinity */
+        memset(pre->g_pre_comp[i][0], 0, sizeof(pre->g_pre_comp[i][0]));
+        /* the remaining multiples */
+        /* 2^96*G + 2^192*G resp. 2^144*G + 2^240*G */
+        point_add(pre->g_pre_comp[i][6][0], pre->g_pre_comp[i][6][1],
+                  pre->g_pre_comp[i][6][2], pre->g_pre_comp[i][4][0],
+                  pre->g_pre_comp[i][4][1], pre->g_pre_comp[i][4][2], 0,
+                  pre->g_pre_comp[i][2][0], pre->g_pre_comp[i][2][1],
+                  pre->g_pre_comp[i][2][2]);
+        /* 2^96*G + 2^288*G resp. 2^144*G + 2^336*G */
+        point_add(pre->g_pre_comp[i][10][0], pre->g_pre_comp[i][10][1],
+                  pre->g_pre_comp[i][10][2], pre->g_pre_comp[i][8][0],
+                  pre->g_pre_comp[i][8][1], pre->g_pre_comp[i][8][2], 0,
+                  pre->g_pre_comp[i][2][0], pre->g_pre_comp[i][2][1],
+                  pre->g_pre_comp[i][2][2]);
+        /* 2^192*G + 2^288*G resp. 2^240*G + 2^336*G */
+        point_add(pre->g_pre_comp[i][12][0], pre->g_pre_comp[i][12][1],
+                  pre->g_pre_comp[i][12][2], pre->g_pre_comp[i][8][0],
+                  pre->g_pre_comp[i][8][1], pre->g_pre_comp[i][8][2], 0,
+                  pre->g_pre_comp[i][4][0], pre->g_pre_comp[i][4][1],
+                  pre->g_pre_comp[i][4][2]);
+        /*
+         * 2^96*G + 2^192*G + 2^288*G resp. 2^144*G + 2^240*G + 2^336*G
+         */
+        point_add(pre->g_pre_comp[i][14][0], pre->g_pre_comp[i][14][1],
+                  pre->g_pre_comp[i][14][2], pre->g_pre_comp[i][12][0],
+                  pre->g_pre_comp[i][12][1], pre->g_pre_comp[i][12][2], 0,
+                  pre->g_pre_comp[i][2][0], pre->g_pre_comp[i][2][1],
+                  pre->g_pre_comp[i][2][2]);
+        for (j = 1; j < 8; ++j) {
+            /* odd multiples: add G resp. 2^48*G */
+            point_add(pre->g_pre_comp[i][2 * j + 1][0],
+                      pre->g_pre_comp[i][2 * j + 1][1],
+                      pre->g_pre_comp[i][2 * j + 1][2],
+                      pre->g_pre_comp[i][2 * j][0],
+                      pre->g_pre_comp[i][2 * j][1],
+                      pre->g_pre_comp[i][2 * j][2], 0,
+                      pre->g_pre_comp[i][1][0], pre->g_pre_comp[i][1][1],
+                      pre->g_pre_comp[i][1][2]);
+        }
+    }
+    make_points_affine(31, &(pre->g_pre_comp[0][1]), tmp_felems);
+
+ done:
+    if (!EC_EX_DATA_set_data(&group->extra_data, pre, nistp384_pre_comp_dup,
+                             nistp384_pre_comp_free,
+                             nistp384_pre_comp_clear_free))
+        goto err;
+    ret = 1;
+    pre = NULL;
+ err:
+    BN_CTX_end(ctx);
+    EC_POINT_free(generator);
+    if (new_ctx != NULL)
+        BN_CTX_free(new_ctx);
+    nistp384_pre_comp_free(pre);
+    return ret;
+}
+
+int ec_GFp_nistp384_have_precompute_mult(const EC_GROUP *group)
+{
+    if (EC_EX_DATA_get_data(group->extra_data, nistp384_pre_comp_dup,
+                            nistp384_pre_comp_free,
+                            nistp384_pre_comp_clear_free)
+        != NULL)
+        return 1;
+    else
+        return 0;
+}
+#else
+static void *dummy = &dummy;
+#endif
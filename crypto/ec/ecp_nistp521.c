@@ -696,114 +696,6 @@ static void felem_mul_reduce(felem out, const felem in1, const felem in2)
     felem_reduce(out, tmp);
 }
 
-/*-
- * felem_inv calculates |out| = |in|^{-1}
- *
- * Based on Fermat's Little Theorem:
- *   a^p = a (mod p)
- *   a^{p-1} = 1 (mod p)
- *   a^{p-2} = a^{-1} (mod p)
- */
-static void felem_inv(felem out, const felem in)
-{
-    felem ftmp, ftmp2, ftmp3, ftmp4;
-    largefelem tmp;
-    unsigned i;
-
-    felem_square(tmp, in);
-    felem_reduce(ftmp, tmp);    /* 2^1 */
-    felem_mul(tmp, in, ftmp);
-    felem_reduce(ftmp, tmp);    /* 2^2 - 2^0 */
-    felem_assign(ftmp2, ftmp);
-    felem_square(tmp, ftmp);
-    felem_reduce(ftmp, tmp);    /* 2^3 - 2^1 */
-    felem_mul(tmp, in, ftmp);
-    felem_reduce(ftmp, tmp);    /* 2^3 - 2^0 */
-    felem_square(tmp, ftmp);
-    felem_reduce(ftmp, tmp);    /* 2^4 - 2^1 */
-
-    felem_square(tmp, ftmp2);
-    felem_reduce(ftmp3, tmp);   /* 2^3 - 2^1 */
-    felem_square(tmp, ftmp3);
-    felem_reduce(ftmp3, tmp);   /* 2^4 - 2^2 */
-    felem_mul(tmp, ftmp3, ftmp2);
-    felem_reduce(ftmp3, tmp);   /* 2^4 - 2^0 */
-
-    felem_assign(ftmp2, ftmp3);
-    felem_square(tmp, ftmp3);
-    felem_reduce(ftmp3, tmp);   /* 2^5 - 2^1 */
-    felem_square(tmp, ftmp3);
-    felem_reduce(ftmp3, tmp);   /* 2^6 - 2^2 */
-    felem_square(tmp, ftmp3);
-    felem_reduce(ftmp3, tmp);   /* 2^7 - 2^3 */
-    felem_square(tmp, ftmp3);
-    felem_reduce(ftmp3, tmp);   /* 2^8 - 2^4 */
-    felem_assign(ftmp4, ftmp3);
-    felem_mul(tmp, ftmp3, ftmp);
-    felem_reduce(ftmp4, tmp);   /* 2^8 - 2^1 */
-    felem_square(tmp, ftmp4);
-    felem_reduce(ftmp4, tmp);   /* 2^9 - 2^2 */
-    felem_mul(tmp, ftmp3, ftmp2);
-    felem_reduce(ftmp3, tmp);   /* 2^8 - 2^0 */
-    felem_assign(ftmp2, ftmp3);
-
-    for (i = 0; i < 8; i++) {
-        felem_square(tmp, ftmp3);
-        felem_reduce(ftmp3, tmp); /* 2^16 - 2^8 */
-    }
-    felem_mul(tmp, ftmp3, ftmp2);
-    felem_reduce(ftmp3, tmp);   /* 2^16 - 2^0 */
-    felem_assign(ftmp2, ftmp3);
-
-    for (i = 0; i < 16; i++) {
-        felem_square(tmp, ftmp3);
-        felem_reduce(ftmp3, tmp); /* 2^32 - 2^16 */
-    }
-    felem_mul(tmp, ftmp3, ftmp2);
-    felem_reduce(ftmp3, tmp);   /* 2^32 - 2^0 */
-    felem_assign(ftmp2, ftmp3);
-
-    for (i = 0; i < 32; i++) {
-        felem_square(tmp, ftmp3);
-        felem_reduce(ftmp3, tmp); /* 2^64 - 2^32 */
-    }
-    felem_mul(tmp, ftmp3, ftmp2);
-    felem_reduce(ftmp3, tmp);   /* 2^64 - 2^0 */
-    felem_assign(ftmp2, ftmp3);
-
-    for (i = 0; i < 64; i++) {
-        felem_square(tmp, ftmp3);
-        felem_reduce(ftmp3, tmp); /* 2^128 - 2^64 */
-    }
-    felem_mul(tmp, ftmp3, ftmp2);
-    felem_reduce(ftmp3, tmp);   /* 2^128 - 2^0 */
-    felem_assign(ftmp2, ftmp3);
-
-    for (i = 0; i < 128; i++) {
-        felem_square(tmp, ftmp3);
-        felem_reduce(ftmp3, tmp); /* 2^256 - 2^128 */
-    }
-    felem_mul(tmp, ftmp3, ftmp2);
-    felem_reduce(ftmp3, tmp);   /* 2^256 - 2^0 */
-    felem_assign(ftmp2, ftmp3);
-
-    for (i = 0; i < 256; i++) {
-        felem_square(tmp, ftmp3);
-        felem_reduce(ftmp3, tmp); /* 2^512 - 2^256 */
-    }
-    felem_mul(tmp, ftmp3, ftmp2);
-    felem_reduce(ftmp3, tmp);   /* 2^512 - 2^0 */
-
-    for (i = 0; i < 9; i++) {
-        felem_square(tmp, ftmp3);
-        felem_reduce(ftmp3, tmp); /* 2^521 - 2^9 */
-    }
-    felem_mul(tmp, ftmp3, ftmp4);
-    felem_reduce(ftmp3, tmp);   /* 2^512 - 2^2 */
-    felem_mul(tmp, ftmp3, in);
-    felem_reduce(out, tmp);     /* 2^512 - 3 */
-}
-
 /* This is 2^521-1, expressed as an felem */
 static const felem kPrime = {
     0x03ffffffffffffff, 0x03ffffffffffffff, 0x03ffffffffffffff,
@@ -1024,6 +916,22 @@ static void felem_contract(felem out, const felem in)
     out[8] -= (1 & sign);
 }
 
+/*
+ * felem_inv calculates |out| = |in|^{-1}, in constant time. On entry:
+ *   in[i] < 2^59 + 2^14
+ */
+static void felem_inv(felem out, const felem in)
+{
+    felem tmp;
+    felem_bytearray b, p;
+
+    felem_contract(tmp, in);
+    felem_to_bin66(b, tmp);
+    flip_endian(p, nistp521_curve_params[0], sizeof(p));
+    ec_GFp_nistp_mod_inverse(b, b, p, sizeof(b));
+    bin66_to_felem(out, b);
+}
+
 /*-
  * Group operations
  * ----------------
@@ -22,10 +22,13 @@
 #ifndef OPENSSL_NO_EC_NISTP_64_GCC_128
 
 /*
- * Common utility functions for ecp_nistp224.c, ecp_nistp256.c, ecp_nistp521.c.
+ * Common utility functions for ecp_nistp224.c, ecp_nistp256.c, ecp_nistp384.c,
+ * ecp_nistp521.c.
  */
 
 # include <stddef.h>
+# include <string.h>
+# include "internal/bn_int.h"
 # include "ec_lcl.h"
 
 /*
@@ -213,6 +216,36 @@ void ec_GFp_nistp_recode_scalar_bits(unsigned char *sign,
     *sign = s & 1;
     *digit = d;
 }
+
+# define NISTP_MAX_WORDS ((66 + BN_BYTES - 1) / BN_BYTES)
+
+/*
+ * ec_GFp_nistp_mod_inverse sets |out| to the inverse of |in| modulo the prime
+ * |p|, all of them |len|-byte little-endian numbers (at most 66 bytes); |in|
+ * need not be reduced. This is the constant-time bn_mod_inverse_words(), which
+ * is considerably faster than raising to the power p - 2. As with the
+ * exponentiation, the inverse of zero is zero.
+ */
+void ec_GFp_nistp_mod_inverse(unsigned char *out, const unsigned char *in,
+                              const unsigned char *p, size_t len)
+{
+    BN_ULONG a[NISTP_MAX_WORDS], m[NISTP_MAX_WORDS], r[NISTP_MAX_WORDS];
+    BN_ULONG mask;
+    size_t i, num = (len + BN_BYTES - 1) / BN_BYTES;
+
+    memset(a, 0, sizeof(a));
+    memset(m, 0, sizeof(m));
+    for (i = 0; i < len; i++) {
+        a[i / BN_BYTES] |= (BN_ULONG)in[i] << (8 * (i % BN_BYTES));
+        m[i / BN_BYTES] |= (BN_ULONG)p[i] << (8 * (i % BN_BYTES));
+    }
+    mask = 0 - (BN_ULONG)bn_mod_inverse_words(r, a, m, (int)num);
+    for (i = 0; i < len; i++)
+        out[i] = (unsigned char)((r[i / BN_BYTES] & mask)
+                                 >> (8 * (i % BN_BYTES)));
+    OPENSSL_cleanse(a, sizeof(a));
+    OPENSSL_cleanse(r, sizeof(r));
+}
 #else
 static void *dummy = &dummy;
 #endif
@@ -1334,6 +1334,7 @@ static int ecp_nistz256_points_mul(const EC_GROUP *group,
     bn_correct_top(r->X);
     bn_correct_top(r->Y);
     bn_correct_top(r->Z);
+    r->Z_is_one = is_one(p.p.Z) & 1;
 
     ret = 1;
 
@@ -1363,9 +1364,15 @@ static int ecp_nistz256_get_affine(const EC_GROUP *group,
         return 0;
     }
 
-    ecp_nistz256_mod_inverse(z_inv3, point_z);
-    ecp_nistz256_sqr_mont(z_inv2, z_inv3);
-    ecp_nistz256_mul_mont(x_aff, z_inv2, point_x);
+    /* Points converted by EC_POINTs_make_affine() need no inversion */
+    if (point->Z_is_one) {
+        memcpy(x_aff, point_x, sizeof(x_aff));
+        memcpy(y_aff, point_y, sizeof(y_aff));
+    } else {
+        ecp_nistz256_mod_inverse(z_inv3, point_z);
+        ecp_nistz256_sqr_mont(z_inv2, z_inv3);
+        ecp_nistz256_mul_mont(x_aff, z_inv2, point_x);
+    }
 
     if (x != NULL) {
         bn_wexpand(x, P256_LIMBS);
@@ -1375,8 +1382,10 @@ static int ecp_nistz256_get_affine(const EC_GROUP *group,
     }
 
     if (y != NULL) {
-        ecp_nistz256_mul_mont(z_inv3, z_inv3, z_inv2);
-        ecp_nistz256_mul_mont(y_aff, z_inv3, point_y);
+        if (!point->Z_is_one) {
+            ecp_nistz256_mul_mont(z_inv3, z_inv3, z_inv2);
+            ecp_nistz256_mul_mont(y_aff, z_inv3, point_y);
+        }
         bn_wexpand(y, P256_LIMBS);
         bn_set_top(y, P256_LIMBS);
         ecp_nistz256_from_mont(bn_get_words(y), y_aff);
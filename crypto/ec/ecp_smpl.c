@@ -66,6 +66,7 @@
 #include <openssl/err.h>
 #include <openssl/symhacks.h>
 
+#include "internal/bn_int.h"
 #include "ec_lcl.h"
 
 const EC_METHOD *EC_GFp_simple_method(void)
@@ -539,6 +540,18 @@ int ec_GFp_simple_point_set_affine_coordinates(const EC_GROUP *group,
                                                     BN_value_one(), ctx);
 }
 
+/*
+ * Inverts a field element in constant time, unless explicit parameters
+ * make the field too large for bn_mod_inverse_fixed().
+ */
+static int ec_GFp_simple_field_inv(const EC_GROUP *group, BIGNUM *r,
+                                   const BIGNUM *a, BN_CTX *ctx)
+{
+    if (BN_num_bits(group->field) <= BN_MOD_INVERSE_FIXED_MAX_BITS)
+        return bn_mod_inverse_fixed(r, a, group->field);
+    return BN_mod_inverse(r, a, group->field, ctx) != NULL;
+}
+
 int ec_GFp_simple_point_get_affine_coordinates(const EC_GROUP *group,
                                                const EC_POINT *point,
                                                BIGNUM *x, BIGNUM *y,
@@ -600,7 +613,7 @@ int ec_GFp_simple_point_get_affine_coordinates(const EC_GROUP *group,
             }
         }
     } else {
-        if (!BN_mod_inverse(Z_1, Z_, group->field, ctx)) {
+        if (!ec_GFp_simple_field_inv(group, Z_1, Z_, ctx)) {
             ECerr(EC_F_EC_GFP_SIMPLE_POINT_GET_AFFINE_COORDINATES,
                   ERR_R_BN_LIB);
             goto err;
@@ -1319,7 +1332,7 @@ int ec_GFp_simple_points_make_affine(const EC_GROUP *group, size_t num,
      * points[i]->Z by its inverse.
      */
 
-    if (!BN_mod_inverse(tmp, prod_Z[num - 1], group->field, ctx)) {
+    if (!ec_GFp_simple_field_inv(group, tmp, prod_Z[num - 1], ctx)) {
         ECerr(EC_F_EC_GFP_SIMPLE_POINTS_MAKE_AFFINE, ERR_R_BN_LIB);
         goto err;
     }
@@ -267,6 +267,7 @@ ECDSA_METHOD *ECDSA_METHOD_new(ECDSA_METHOD *ecdsa_meth)
         ret->ecdsa_sign_setup = 0;
         ret->ecdsa_do_sign = 0;
         ret->ecdsa_do_verify = 0;
+        ret->ecdsa_do_verify_batch = 0;
         ret->name = NULL;
         ret->flags = 0;
     }
@@ -284,6 +285,16 @@ void ECDSA_METHOD_set_sign(ECDSA_METHOD *ecdsa_method,
     ecdsa_method->ecdsa_do_sign = ecdsa_do_sign;
 }
 
+void ECDSA_METHOD_get_sign(const ECDSA_METHOD *ecdsa_method,
+                           ECDSA_SIG *(**pecdsa_do_sign) (const unsigned char
+                                                          *dgst, int dgst_len,
+                                                          const BIGNUM *inv,
+                                                          const BIGNUM *rp,
+                                                          EC_KEY *eckey))
+{
+    *pecdsa_do_sign = ecdsa_method->ecdsa_do_sign;
+}
+
 void ECDSA_METHOD_set_sign_setup(ECDSA_METHOD *ecdsa_method,
                                  int (*ecdsa_sign_setup) (EC_KEY *eckey,
                                                           BN_CTX *ctx,
@@ -300,6 +311,8 @@ void ECDSA_METHOD_set_verify(ECDSA_METHOD *ecdsa_method,
                                                      EC_KEY *eckey))
 {
     ecdsa_method->ecdsa_do_verify = ecdsa_do_verify;
+    /* The batch function would bypass the new one */
+    ecdsa_method->ecdsa_do_verify_batch = 0;
 }
 
 void ECDSA_METHOD_set_flags(ECDSA_METHOD *ecdsa_method, int flags)
@@ -76,6 +76,14 @@ struct ecdsa_method {
                             const ECDSA_SIG *sig, EC_KEY *eckey);
     int flags;
     void *app_data;
+    /*
+     * Verifies several signatures, see ECDSA_do_verify_batch(). Can be
+     * null, in which case ecdsa_do_verify is called for each in turn.
+     */
+    int (*ecdsa_do_verify_batch) (int num, const unsigned char *const *dgst,
+                                  const int *dgst_len,
+                                  const ECDSA_SIG *const *sig,
+                                  EC_KEY *const *eckey, int *ret);
 };
 
 /* The ECDSA_METHOD was allocated and can be freed */
@@ -57,6 +57,7 @@
  */
 
 #include "ecs_locl.h"
+#include "internal/bn_int.h"
 #include <openssl/err.h>
 #include <openssl/obj_mac.h>
 #include <openssl/bn.h>
@@ -71,6 +72,10 @@ static int ecdsa_sign_setup(EC_KEY *eckey, BN_CTX *ctx_in, BIGNUM **kinvp,
                             BIGNUM **rp, const unsigned char *dgst, int dlen);
 static int ecdsa_do_verify(const unsigned char *dgst, int dgst_len,
                            const ECDSA_SIG *sig, EC_KEY *eckey);
+static int ecdsa_do_verify_batch(int num, const unsigned char *const *dgst,
+                                 const int *dgst_len,
+                                 const ECDSA_SIG *const *sig,
+                                 EC_KEY *const *eckey, int *ret);
 
 static ECDSA_METHOD openssl_ecdsa_meth = {
     "OpenSSL ECDSA method",
@@ -78,7 +83,8 @@ static ECDSA_METHOD openssl_ecdsa_meth = {
     ecdsa_sign_setup_no_digest,
     ecdsa_do_verify,
     ECDSA_FLAG_FIPS_METHOD,     /* flags */
-    NULL                        /* app_data */
+    NULL,                       /* app_data */
+    ecdsa_do_verify_batch
 };
 
 const ECDSA_METHOD *ECDSA_OpenSSL(void)
@@ -158,14 +164,14 @@ static int ecdsa_sign_setup(EC_KEY *eckey, BN_CTX *ctx_in,
          * compute G*k using an equivalent scalar of fixed bit-length.
          */
 
-        if (!BN_add(k, k, order))
+        if (!BN_add(X, k, order))
             goto err;
-        if (BN_num_bits(k) <= BN_num_bits(order))
-            if (!BN_add(k, k, order))
+        if (BN_num_bits(X) <= BN_num_bits(order))
+            if (!BN_add(X, X, order))
                 goto err;
 
         /* compute r the x-coordinate of generator * k */
-        if (!EC_POINT_mul(group, tmp_point, k, NULL, NULL, ctx)) {
+        if (!EC_POINT_mul(group, tmp_point, X, NULL, NULL, ctx)) {
             ECDSAerr(ECDSA_F_ECDSA_SIGN_SETUP, ERR_R_EC_LIB);
             goto err;
         }
@@ -196,7 +202,14 @@ static int ecdsa_sign_setup(EC_KEY *eckey, BN_CTX *ctx_in,
     while (BN_is_zero(r));
 
     /* compute the inverse of k */
-    if (EC_GROUP_get_mont_data(group) != NULL) {
+    if (BN_is_odd(order)
+        && BN_num_bits(order) <= BN_MOD_INVERSE_FIXED_MAX_BITS) {
+        /* constant time, and k < order as required */
+        if (!bn_mod_inverse_fixed(k, k, order)) {
+            ECDSAerr(ECDSA_F_ECDSA_SIGN_SETUP, ERR_R_BN_LIB);
+            goto err;
+        }
+    } else if (EC_GROUP_get_mont_data(group) != NULL) {
         /*
          * We want inverse in constant time, therefore we utilize the fact
          * order must be prime and use Fermats Little Theorem instead.
@@ -364,10 +377,29 @@ static ECDSA_SIG *ecdsa_do_sign(const unsigned char *dgst, int dgst_len,
     return ret;
 }
 
+/* Convert the digest to a number of at most as many bits as |order| */
+static int ecdsa_digest_to_bn(BIGNUM *m, const unsigned char *dgst,
+                              int dgst_len, const BIGNUM *order)
+{
+    int i = BN_num_bits(order);
+
+    /*
+     * Need to truncate digest if it is too long: first truncate whole bytes.
+     */
+    if (8 * dgst_len > i)
+        dgst_len = (i + 7) / 8;
+    if (!BN_bin2bn(dgst, dgst_len, m))
+        return 0;
+    /* If still too long truncate remaining bits with a shift */
+    if ((8 * dgst_len > i) && !BN_rshift(m, m, 8 - (i & 0x7)))
+        return 0;
+    return 1;
+}
+
 static int ecdsa_do_verify(const unsigned char *dgst, int dgst_len,
                            const ECDSA_SIG *sig, EC_KEY *eckey)
 {
-    int ret = -1, i;
+    int ret = -1;
     BN_CTX *ctx;
     BIGNUM *order, *u1, *u2, *m, *X;
     EC_POINT *point = NULL;
@@ -415,18 +447,7 @@ static int ecdsa_do_verify(const unsigned char *dgst, int dgst_len,
         goto err;
     }
     /* digest -> m */
-    i = BN_num_bits(order);
-    /*
-     * Need to truncate digest if it is too long: first truncate whole bytes.
-     */
-    if (8 * dgst_len > i)
-        dgst_len = (i + 7) / 8;
-    if (!BN_bin2bn(dgst, dgst_len, m)) {
-        ECDSAerr(ECDSA_F_ECDSA_DO_VERIFY, ERR_R_BN_LIB);
-        goto err;
-    }
-    /* If still too long truncate remaining bits with a shift */
-    if ((8 * dgst_len > i) && !BN_rshift(m, m, 8 - (i & 0x7))) {
+    if (!ecdsa_digest_to_bn(m, dgst, dgst_len, order)) {
         ECDSAerr(ECDSA_F_ECDSA_DO_VERIFY, ERR_R_BN_LIB);
         goto err;
     }
@@ -477,3 +498,225 @@ static int ecdsa_do_verify(const unsigned char *dgst, int dgst_len,
     EC_POINT_free(point);
     return ret;
 }
+
+/*
+ * Verify the signatures idx[0..n-1] of a batch, which all have the group
+ * of the first. w[] provides a scratch number per signature and pts[]
+ * room for n points. Sets ret[] for each signature, returns 0 if an error
+ * prevented that.
+ */
+static int ecdsa_verify_group(int n, const int *idx,
+                              const unsigned char *const *dgst,
+                              const int *dgst_len,
+                              const ECDSA_SIG *const *sig,
+                              EC_KEY *const *eckey, BIGNUM **w,
+                              EC_POINT **pts, int *ret, BN_CTX *ctx)
+{
+    const EC_GROUP *group = EC_KEY_get0_group(eckey[idx[0]]);
+    BIGNUM *order, *inv, *m, *u1, *u2, *X;
+    int k, field_type, ok = 0;
+
+    BN_CTX_start(ctx);
+    order = BN_CTX_get(ctx);
+    inv = BN_CTX_get(ctx);
+    m = BN_CTX_get(ctx);
+    u1 = BN_CTX_get(ctx);
+    u2 = BN_CTX_get(ctx);
+    X = BN_CTX_get(ctx);
+    if (X == NULL) {
+        ECDSAerr(ECDSA_F_ECDSA_DO_VERIFY_BATCH, ERR_R_BN_LIB);
+        goto err;
+    }
+    if (!EC_GROUP_get_order(group, order, ctx)) {
+        ECDSAerr(ECDSA_F_ECDSA_DO_VERIFY_BATCH, ERR_R_EC_LIB);
+        goto err;
+    }
+
+    /*
+     * Invert all s values with a single BN_mod_inverse(): with w[k] the
+     * product of s[0..k], 1/s[k] = w[k-1]/w[k].
+     */
+    if (!BN_copy(w[0], sig[idx[0]]->s))
+        goto err;
+    for (k = 1; k < n; k++)
+        if (!BN_mod_mul(w[k], w[k - 1], sig[idx[k]]->s, order, ctx))
+            goto err;
+    if (!BN_mod_inverse(inv, w[n - 1], order, ctx)) {
+        ECDSAerr(ECDSA_F_ECDSA_DO_VERIFY_BATCH, ERR_R_BN_LIB);
+        goto err;
+    }
+    for (k = n - 1; k > 0; k--) {
+        if (!BN_mod_mul(w[k], inv, w[k - 1], order, ctx)
+            || !BN_mod_mul(inv, inv, sig[idx[k]]->s, order, ctx))
+            goto err;
+    }
+    if (!BN_copy(w[0], inv))
+        goto err;
+
+    for (k = 0; k < n; k++) {
+        /* u1 = m * w mod order, u2 = r * w mod order */
+        if (!ecdsa_digest_to_bn(m, dgst[idx[k]], dgst_len[idx[k]], order)
+            || !BN_mod_mul(u1, m, w[k], order, ctx)
+            || !BN_mod_mul(u2, sig[idx[k]]->r, w[k], order, ctx)) {
+            ECDSAerr(ECDSA_F_ECDSA_DO_VERIFY_BATCH, ERR_R_BN_LIB);
+            goto err;
+        }
+        if ((pts[k] = EC_POINT_new(group)) == NULL) {
+            ECDSAerr(ECDSA_F_ECDSA_DO_VERIFY_BATCH, ERR_R_MALLOC_FAILURE);
+            goto err;
+        }
+        if (!EC_POINT_mul(group, pts[k], u1,
+                          EC_KEY_get0_public_key(eckey[idx[k]]), u2, ctx)) {
+            ECDSAerr(ECDSA_F_ECDSA_DO_VERIFY_BATCH, ERR_R_EC_LIB);
+            goto err;
+        }
+    }
+
+    /* A single field inversion converts all points to affine coordinates */
+    if (!EC_POINTs_make_affine(group, n, pts, ctx)) {
+        ECDSAerr(ECDSA_F_ECDSA_DO_VERIFY_BATCH, ERR_R_EC_LIB);
+        goto err;
+    }
+
+    field_type = EC_METHOD_get_field_type(EC_GROUP_method_of(group));
+    for (k = 0; k < n; k++) {
+        if (field_type == NID_X9_62_prime_field) {
+            if (!EC_POINT_get_affine_coordinates_GFp(group, pts[k], X, NULL,
+                                                     ctx)) {
+                ECDSAerr(ECDSA_F_ECDSA_DO_VERIFY_BATCH, ERR_R_EC_LIB);
+                ret[idx[k]] = -1;
+                continue;
+            }
+        }
+#ifndef OPENSSL_NO_EC2M
+        else {                  /* NID_X9_62_characteristic_two_field */
+            if (!EC_POINT_get_affine_coordinates_GF2m(group, pts[k], X, NULL,
+                                                      ctx)) {
+                ECDSAerr(ECDSA_F_ECDSA_DO_VERIFY_BATCH, ERR_R_EC_LIB);
+                ret[idx[k]] = -1;
+                continue;
+            }
+        }
+#endif
+        if (!BN_nnmod(u1, X, order, ctx)) {
+            ECDSAerr(ECDSA_F_ECDSA_DO_VERIFY_BATCH, ERR_R_BN_LIB);
+            goto err;
+        }
+        /*  if the signature is correct u1 is equal to sig->r */
+        ret[idx[k]] = (BN_ucmp(u1, sig[idx[k]]->r) == 0);
+    }
+    ok = 1;
+
+ err:
+    for (k = 0; k < n; k++) {
+        EC_POINT_free(pts[k]);
+        pts[k] = NULL;
+    }
+    BN_CTX_end(ctx);
+    return ok;
+}
+
+/*
+ * Verify signatures as ecdsa_do_verify() would, sharing the inversion of
+ * s and the conversion of the result to affine coordinates between all
+ * signatures over the same curve. The scalar multiplications themselves
+ * are still done one signature at a time, so every result is known
+ * without a separate pass to find out which signature was bad.
+ */
+static int ecdsa_do_verify_batch(int num, const unsigned char *const *dgst,
+                                 const int *dgst_len,
+                                 const ECDSA_SIG *const *sig,
+                                 EC_KEY *const *eckey, int *ret)
+{
+    BN_CTX *ctx = NULL;
+    BIGNUM *order, **w = NULL;
+    EC_POINT **pts = NULL;
+    const EC_GROUP *group;
+    int *idx = NULL, *todo = NULL;
+    int i, j, n, ok = 1;
+
+    for (i = 0; i < num; i++)
+        ret[i] = -1;
+    if (num <= 0)
+        return 1;
+
+    ctx = BN_CTX_new();
+    w = OPENSSL_malloc(sizeof(*w) * num);
+    pts = OPENSSL_malloc(sizeof(*pts) * num);
+    idx = OPENSSL_malloc(sizeof(*idx) * num);
+    todo = OPENSSL_malloc(sizeof(*todo) * num);
+    if (ctx == NULL || w == NULL || pts == NULL || idx == NULL
+        || todo == NULL) {
+        ECDSAerr(ECDSA_F_ECDSA_DO_VERIFY_BATCH, ERR_R_MALLOC_FAILURE);
+        ok = 0;
+        goto err;
+    }
+    BN_CTX_start(ctx);
+    order = BN_CTX_get(ctx);
+    for (i = 0; i < num; i++) {
+        pts[i] = NULL;
+        w[i] = BN_CTX_get(ctx);
+    }
+    if (w[num - 1] == NULL) {
+        ECDSAerr(ECDSA_F_ECDSA_DO_VERIFY_BATCH, ERR_R_BN_LIB);
+        ok = 0;
+        goto end;
+    }
+
+    /* check input values */
+    for (i = 0; i < num; i++) {
+        todo[i] = 0;
+        if (eckey[i] == NULL || (group = EC_KEY_get0_group(eckey[i])) == NULL
+            || EC_KEY_get0_public_key(eckey[i]) == NULL || sig[i] == NULL) {
+            ECDSAerr(ECDSA_F_ECDSA_DO_VERIFY_BATCH,
+                     ECDSA_R_MISSING_PARAMETERS);
+            continue;
+        }
+        if (!EC_GROUP_get_order(group, order, ctx)) {
+            ECDSAerr(ECDSA_F_ECDSA_DO_VERIFY_BATCH, ERR_R_EC_LIB);
+            continue;
+        }
+        if (BN_is_zero(sig[i]->r) || BN_is_negative(sig[i]->r) ||
+            BN_ucmp(sig[i]->r, order) >= 0 || BN_is_zero(sig[i]->s) ||
+            BN_is_negative(sig[i]->s) || BN_ucmp(sig[i]->s, order) >= 0) {
+            ECDSAerr(ECDSA_F_ECDSA_DO_VERIFY_BATCH, ECDSA_R_BAD_SIGNATURE);
+            ret[i] = 0;         /* signature is invalid */
+            continue;
+        }
+        todo[i] = 1;
+    }
+
+    /* Verify the signatures in groups of the same curve */
+    for (i = 0; i < num; i++) {
+        if (!todo[i])
+            continue;
+        group = EC_KEY_get0_group(eckey[i]);
+        for (j = i, n = 0; j < num; j++) {
+            if (todo[j]
+                && (EC_KEY_get0_group(eckey[j]) == group
+                    || EC_GROUP_cmp(EC_KEY_get0_group(eckey[j]), group,
+                                    ctx) == 0)) {
+                todo[j] = 0;
+                idx[n++] = j;
+            }
+        }
+        if (!ecdsa_verify_group(n, idx, dgst, dgst_len, sig, eckey, w, pts,
+                                ret, ctx))
+            for (j = 0; j < n; j++)
+                ret[idx[j]] = -1;
+    }
+
+ end:
+    BN_CTX_end(ctx);
+ err:
+    for (i = 0; i < num; i++)
+        if (ret[i] != 1)
+            ok = 0;
+    BN_CTX_free(ctx);
+    OPENSSL_free(w);
+    OPENSSL_free(pts);
+    OPENSSL_free(idx);
+    OPENSSL_free(todo);
+    return ok;
+}
+
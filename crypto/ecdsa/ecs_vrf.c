@@ -77,6 +77,41 @@ int ECDSA_do_verify(const unsigned char *dgst, int dgst_len,
     return ecdsa->meth->ecdsa_do_verify(dgst, dgst_len, sig, eckey);
 }
 
+/*-
+ * returns
+ *      1: all signatures correct
+ *      0: some signature incorrect or an error, see ret
+ */
+int ECDSA_do_verify_batch(int num, const unsigned char *const *dgst,
+                          const int *dgst_len, const ECDSA_SIG *const *sig,
+                          EC_KEY *const *eckey, int *ret)
+{
+    ECDSA_DATA *ecdsa;
+    const ECDSA_METHOD *meth = NULL;
+    int i, ok = 1;
+
+    for (i = 0; i < num; i++) {
+        if ((ecdsa = ecdsa_check(eckey[i])) == NULL) {
+            meth = NULL;
+            break;
+        }
+        if (i == 0)
+            meth = ecdsa->meth;
+        else if (meth != ecdsa->meth)
+            meth = NULL;
+    }
+    if (meth != NULL && meth->ecdsa_do_verify_batch != NULL)
+        return meth->ecdsa_do_verify_batch(num, dgst, dgst_len, sig, eckey,
+                                           ret);
+
+    for (i = 0; i < num; i++) {
+        ret[i] = ECDSA_do_verify(dgst[i], dgst_len[i], sig[i], eckey[i]);
+        if (ret[i] != 1)
+            ok = 0;
+    }
+    return ok;
+}
+
 /*-
  * returns
  *      1: correct signature
@@ -105,6 +105,7 @@
 #ifndef OPENSSL_NO_JPAKE
 # include <openssl/jpake.h>
 #endif
+#include <openssl/async.h>
 
 void ERR_load_crypto_strings(void)
 {
@@ -161,5 +162,6 @@ void ERR_load_crypto_strings(void)
 # ifndef OPENSSL_NO_JPAKE
     ERR_load_JPAKE_strings();
 # endif
+    ERR_load_ASYNC_strings();
 #endif
 }
@@ -166,7 +166,11 @@ int EVP_DigestInit_ex(EVP_MD_CTX *ctx, const EVP_MD *type, ENGINE *impl)
                 EVPerr(EVP_F_EVP_DIGESTINIT_EX, EVP_R_INITIALIZATION_ERROR);
                 return 0;
             }
-        } else
+        } else if (type == ctx->digest
+                   && EVP_MD_CTX_test_flags(ctx, EVP_MD_CTX_FLAG_KEEP_IMPL))
+            /* The caller has pinned the implementation we already have */
+            impl = NULL;
+        else
             /* Ask if an ENGINE is reserved for this job */
             impl = ENGINE_get_digest_engine(type->type);
         if (impl) {
@@ -187,14 +191,15 @@ int EVP_DigestInit_ex(EVP_MD_CTX *ctx, const EVP_MD *type, ENGINE *impl)
             ctx->engine = impl;
         } else
             ctx->engine = NULL;
-    } else {
+    } else
+#endif
+    if (type == NULL) {
         if (!ctx->digest) {
             EVPerr(EVP_F_EVP_DIGESTINIT_EX, EVP_R_NO_DIGEST_SET);
             return 0;
         }
         type = ctx->digest;
     }
-#endif
     if (ctx->digest != type) {
         if (ctx->digest && ctx->digest->ctx_size)
             OPENSSL_free(ctx->md_data);
@@ -329,6 +334,31 @@ int EVP_Digest(const void *data, size_t count,
     return ret;
 }
 
+int EVP_Digest_batch(const unsigned char **data, const size_t *count,
+                     unsigned char **md, size_t num, const EVP_MD *type,
+                     ENGINE *impl)
+{
+    EVP_MD_CTX ctx;
+    size_t i;
+    int ret;
+
+    EVP_MD_CTX_init(&ctx);
+    EVP_MD_CTX_set_flags(&ctx, EVP_MD_CTX_FLAG_ONESHOT);
+    ret = EVP_DigestInit_ex(&ctx, type, impl);
+    /* An ENGINE may have replaced |type|: ask the digest actually used */
+    if (ret && ctx.digest->digest_batch != NULL) {
+        ret = ctx.digest->digest_batch(data, count, md, num);
+    } else {
+        for (i = 0; ret && i < num; i++)
+            ret = (i == 0 || EVP_DigestInit_ex(&ctx, type, impl))
+                && EVP_DigestUpdate(&ctx, data[i], count[i])
+                && EVP_DigestFinal_ex(&ctx, md[i], NULL);
+    }
+    EVP_MD_CTX_cleanup(&ctx);
+
+    return ret;
+}
+
 void EVP_MD_CTX_destroy(EVP_MD_CTX *ctx)
 {
     if (ctx) {
@@ -58,6 +58,11 @@
 # include "evp_locl.h"
 # include "modes_lcl.h"
 # include <openssl/rand.h>
+# if defined(OPENSSL_THREADS) && defined(OPENSSL_SYS_UNIX)
+#  define XTS_THREADS
+#  include <pthread.h>
+#  include <unistd.h>
+# endif
 
 typedef struct {
     union {
@@ -97,6 +102,8 @@ typedef struct {
                     unsigned char *out, size_t length,
                     const AES_KEY *key1, const AES_KEY *key2,
                     const unsigned char iv[16]);
+    size_t unit_len;            /* Data unit size, 0 for a single unit */
+    int threads;                /* Maximum threads to spread units over */
 } EVP_AES_XTS_CTX;
 
 typedef struct {
@@ -459,12 +466,98 @@ static int aesni_ccm_cipher(EVP_CIPHER_CTX *ctx, unsigned char *out,
                             const unsigned char *in, size_t len);
 
 #  ifndef OPENSSL_NO_OCB
+/*
+ * OCB over the interleaved ECB code: offsets for up to AESNI_OCB_BLOCKS
+ * blocks are applied before and after a single aesni_ecb_encrypt() call,
+ * which keeps several blocks in flight instead of one.
+ */
+#   define AESNI_OCB_BLOCKS 16
+
+static void aesni_ocb_blocks(const unsigned char *in, unsigned char *out,
+                             size_t blocks, const void *key,
+                             size_t start_block_num,
+                             unsigned char offset_i[16],
+                             const unsigned char L_[][16],
+                             unsigned char checksum[16], int enc)
+{
+    u64 offsets[AESNI_OCB_BLOCKS][2], offset[2], sum[2], t[2];
+    size_t i, n, num, ntz;
+
+    memcpy(offset, offset_i, 16);
+    memcpy(sum, checksum, 16);
+    while (blocks > 0) {
+        n = blocks < AESNI_OCB_BLOCKS ? blocks : AESNI_OCB_BLOCKS;
+        for (i = 0; i < n; i++) {
+            /* Offset_i = Offset_{i-1} xor L_{ntz(i)} */
+            for (num = start_block_num + i, ntz = 0; !(num & 1); num >>= 1)
+                ntz++;
+            memcpy(t, L_[ntz], 16);
+            offset[0] ^= t[0];
+            offset[1] ^= t[1];
+            offsets[i][0] = offset[0];
+            offsets[i][1] = offset[1];
+
+            memcpy(t, in + 16 * i, 16);
+            if (enc) {
+                sum[0] ^= t[0];
+                sum[1] ^= t[1];
+            }
+            t[0] ^= offset[0];
+            t[1] ^= offset[1];
+            memcpy(out + 16 * i, t, 16);
+        }
+        aesni_ecb_encrypt(out, out, 16 * n, key, enc);
+        for (i = 0; i < n; i++) {
+            memcpy(t, out + 16 * i, 16);
+            t[0] ^= offsets[i][0];
+            t[1] ^= offsets[i][1];
+            memcpy(out + 16 * i, t, 16);
+            if (!enc) {
+                sum[0] ^= t[0];
+                sum[1] ^= t[1];
+            }
+        }
+        in += 16 * n;
+        out += 16 * n;
+        blocks -= n;
+        start_block_num += n;
+    }
+    memcpy(offset_i, offset, 16);
+    memcpy(checksum, sum, 16);
+    OPENSSL_cleanse(offsets, sizeof(offsets));
+}
+
+static void aesni_ocb_encrypt(const unsigned char *in, unsigned char *out,
+                              size_t blocks, const void *key,
+                              size_t start_block_num,
+                              unsigned char offset_i[16],
+                              const unsigned char L_[][16],
+                              unsigned char checksum[16])
+{
+    aesni_ocb_blocks(in, out, blocks, key, start_block_num, offset_i, L_,
+                     checksum, 1);
+}
+
+static void aesni_ocb_decrypt(const unsigned char *in, unsigned char *out,
+                              size_t blocks, const void *key,
+                              size_t start_block_num,
+                              unsigned char offset_i[16],
+                              const unsigned char L_[][16],
+                              unsigned char checksum[16])
+{
+    aesni_ocb_blocks(in, out, blocks, key, start_block_num, offset_i, L_,
+                     checksum, 0);
+}
+
 static int aesni_ocb_init_key(EVP_CIPHER_CTX *ctx, const unsigned char *key,
                               const unsigned char *iv, int enc)
 {
     EVP_AES_OCB_CTX *octx = ctx->cipher_data;
     if (!iv && !key)
         return 1;
+    /* The context may be switched between directions with a new IV only */
+    if (!key && octx->key_set)
+        octx->ocb.stream = enc ? aesni_ocb_encrypt : aesni_ocb_decrypt;
     if (key) {
         do {
             /*
@@ -477,7 +570,9 @@ static int aesni_ocb_init_key(EVP_CIPHER_CTX *ctx, const unsigned char *key,
             if (!CRYPTO_ocb128_init(&octx->ocb,
                                     &octx->ksenc.ks, &octx->ksdec.ks,
                                     (block128_f) aesni_encrypt,
-                                    (block128_f) aesni_decrypt))
+                                    (block128_f) aesni_decrypt,
+                                    enc ? aesni_ocb_encrypt
+                                        : aesni_ocb_decrypt))
                 return 0;
         }
         while (0);
@@ -869,7 +964,8 @@ static int aes_t4_ocb_init_key(EVP_CIPHER_CTX *ctx, const unsigned char *key,
             if (!CRYPTO_ocb128_init(&octx->ocb,
                                     &octx->ksenc.ks, &octx->ksdec.ks,
                                     (block128_f) aes_t4_encrypt,
-                                    (block128_f) aes_t4_decrypt))
+                                    (block128_f) aes_t4_decrypt,
+                                    NULL))
                 return 0;
         }
         while (0);
@@ -1370,56 +1466,80 @@ static int aes_gcm_ctrl(EVP_CIPHER_CTX *c, int type, int arg, void *ptr)
     }
 }
 
-static int aes_gcm_init_key(EVP_CIPHER_CTX *ctx, const unsigned char *key,
-                            const unsigned char *iv, int enc)
+/* Expand |key| into |gctx| for the fastest available AES implementation */
+static void aes_gcm_set_key(EVP_AES_GCM_CTX *gctx, const unsigned char *key,
+                            int bits)
 {
-    EVP_AES_GCM_CTX *gctx = ctx->cipher_data;
-    if (!iv && !key)
-        return 1;
-    if (key) {
-        do {
+# ifdef AESNI_CAPABLE
+    if (AESNI_CAPABLE) {
+        aesni_set_encrypt_key(key, bits, &gctx->ks.ks);
+        CRYPTO_gcm128_init(&gctx->gcm, &gctx->ks, (block128_f) aesni_encrypt);
+        gctx->ctr = (ctr128_f) aesni_ctr32_encrypt_blocks;
+        return;
+    }
+# endif
+# ifdef SPARC_AES_CAPABLE
+    if (SPARC_AES_CAPABLE) {
+        aes_t4_set_encrypt_key(key, bits, &gctx->ks.ks);
+        CRYPTO_gcm128_init(&gctx->gcm, &gctx->ks,
+                           (block128_f) aes_t4_encrypt);
+        gctx->ctr = bits == 128 ? (ctr128_f) aes128_t4_ctr32_encrypt :
+            bits == 192 ? (ctr128_f) aes192_t4_ctr32_encrypt :
+            (ctr128_f) aes256_t4_ctr32_encrypt;
+        return;
+    }
+# endif
 # ifdef HWAES_CAPABLE
-            if (HWAES_CAPABLE) {
-                HWAES_set_encrypt_key(key, ctx->key_len * 8, &gctx->ks.ks);
-                CRYPTO_gcm128_init(&gctx->gcm, &gctx->ks,
-                                   (block128_f) HWAES_encrypt);
+    if (HWAES_CAPABLE) {
+        HWAES_set_encrypt_key(key, bits, &gctx->ks.ks);
+        CRYPTO_gcm128_init(&gctx->gcm, &gctx->ks,
+                           (block128_f) HWAES_encrypt);
 #  ifdef HWAES_ctr32_encrypt_blocks
-                gctx->ctr = (ctr128_f) HWAES_ctr32_encrypt_blocks;
+        gctx->ctr = (ctr128_f) HWAES_ctr32_encrypt_blocks;
 #  else
-                gctx->ctr = NULL;
+        gctx->ctr = NULL;
 #  endif
-                break;
-            } else
+        return;
+    } else
 # endif
 # ifdef BSAES_CAPABLE
-            if (BSAES_CAPABLE) {
-                AES_set_encrypt_key(key, ctx->key_len * 8, &gctx->ks.ks);
-                CRYPTO_gcm128_init(&gctx->gcm, &gctx->ks,
-                                   (block128_f) AES_encrypt);
-                gctx->ctr = (ctr128_f) bsaes_ctr32_encrypt_blocks;
-                break;
-            } else
+    if (BSAES_CAPABLE) {
+        AES_set_encrypt_key(key, bits, &gctx->ks.ks);
+        CRYPTO_gcm128_init(&gctx->gcm, &gctx->ks,
+                           (block128_f) AES_encrypt);
+        gctx->ctr = (ctr128_f) bsaes_ctr32_encrypt_blocks;
+        return;
+    } else
 # endif
 # ifdef VPAES_CAPABLE
-            if (VPAES_CAPABLE) {
-                vpaes_set_encrypt_key(key, ctx->key_len * 8, &gctx->ks.ks);
-                CRYPTO_gcm128_init(&gctx->gcm, &gctx->ks,
-                                   (block128_f) vpaes_encrypt);
-                gctx->ctr = NULL;
-                break;
-            } else
+    if (VPAES_CAPABLE) {
+        vpaes_set_encrypt_key(key, bits, &gctx->ks.ks);
+        CRYPTO_gcm128_init(&gctx->gcm, &gctx->ks,
+                           (block128_f) vpaes_encrypt);
+        gctx->ctr = NULL;
+        return;
+    } else
 # endif
-                (void)0;        /* terminate potentially open 'else' */
+        (void)0;        /* terminate potentially open 'else' */
 
-            AES_set_encrypt_key(key, ctx->key_len * 8, &gctx->ks.ks);
-            CRYPTO_gcm128_init(&gctx->gcm, &gctx->ks,
-                               (block128_f) AES_encrypt);
+    AES_set_encrypt_key(key, bits, &gctx->ks.ks);
+    CRYPTO_gcm128_init(&gctx->gcm, &gctx->ks,
+                       (block128_f) AES_encrypt);
 # ifdef AES_CTR_ASM
-            gctx->ctr = (ctr128_f) AES_ctr32_encrypt;
+    gctx->ctr = (ctr128_f) AES_ctr32_encrypt;
 # else
-            gctx->ctr = NULL;
+    gctx->ctr = NULL;
 # endif
-        } while (0);
+}
+
+static int aes_gcm_init_key(EVP_CIPHER_CTX *ctx, const unsigned char *key,
+                            const unsigned char *iv, int enc)
+{
+    EVP_AES_GCM_CTX *gctx = ctx->cipher_data;
+    if (!iv && !key)
+        return 1;
+    if (key) {
+        aes_gcm_set_key(gctx, key, ctx->key_len * 8);
 
         /*
          * If we have an iv can set it directly, otherwise use saved IV.
@@ -1450,38 +1570,20 @@ static int aes_gcm_init_key(EVP_CIPHER_CTX *ctx, const unsigned char *key,
  * and verify tag.
  */
 
-static int aes_gcm_tls_cipher(EVP_CIPHER_CTX *ctx, unsigned char *out,
-                              const unsigned char *in, size_t len)
+/*
+ * Encrypt or decrypt a whole message once the IV and any AAD are set, with
+ * the stitched AES-GCM code for the bulk of it where available.
+ */
+static int aes_gcm_crypt_msg(EVP_AES_GCM_CTX *gctx, const unsigned char *in,
+                             unsigned char *out, size_t len, int enc)
 {
-    EVP_AES_GCM_CTX *gctx = ctx->cipher_data;
-    int rv = -1;
-    /* Encrypt/decrypt must be performed in place */
-    if (out != in
-        || len < (EVP_GCM_TLS_EXPLICIT_IV_LEN + EVP_GCM_TLS_TAG_LEN))
-        return -1;
-    /*
-     * Set IV from start of buffer or generate IV and write to start of
-     * buffer.
-     */
-    if (EVP_CIPHER_CTX_ctrl(ctx, ctx->encrypt ?
-                            EVP_CTRL_GCM_IV_GEN : EVP_CTRL_GCM_SET_IV_INV,
-                            EVP_GCM_TLS_EXPLICIT_IV_LEN, out) <= 0)
-        goto err;
-    /* Use saved AAD */
-    if (CRYPTO_gcm128_aad(&gctx->gcm, ctx->buf, gctx->tls_aad_len))
-        goto err;
-    /* Fix buffer and length to point to payload */
-    in += EVP_GCM_TLS_EXPLICIT_IV_LEN;
-    out += EVP_GCM_TLS_EXPLICIT_IV_LEN;
-    len -= EVP_GCM_TLS_EXPLICIT_IV_LEN + EVP_GCM_TLS_TAG_LEN;
-    if (ctx->encrypt) {
-        /* Encrypt payload */
+    if (enc) {
         if (gctx->ctr) {
             size_t bulk = 0;
 # if defined(AES_GCM_ASM)
             if (len >= 32 && AES_GCM_ASM(gctx)) {
                 if (CRYPTO_gcm128_encrypt(&gctx->gcm, NULL, NULL, 0))
-                    return -1;
+                    return 0;
 
                 bulk = AES_gcm_encrypt(in, out, len,
                                        gctx->gcm.key,
@@ -1493,13 +1595,13 @@ static int aes_gcm_tls_cipher(EVP_CIPHER_CTX *ctx, unsigned char *out,
                                             in + bulk,
                                             out + bulk,
                                             len - bulk, gctx->ctr))
-                goto err;
+                return 0;
         } else {
             size_t bulk = 0;
 # if defined(AES_GCM_ASM2)
             if (len >= 32 && AES_GCM_ASM2(gctx)) {
                 if (CRYPTO_gcm128_encrypt(&gctx->gcm, NULL, NULL, 0))
-                    return -1;
+                    return 0;
 
                 bulk = AES_gcm_encrypt(in, out, len,
                                        gctx->gcm.key,
@@ -1509,20 +1611,15 @@ static int aes_gcm_tls_cipher(EVP_CIPHER_CTX *ctx, unsigned char *out,
 # endif
             if (CRYPTO_gcm128_encrypt(&gctx->gcm,
                                       in + bulk, out + bulk, len - bulk))
-                goto err;
+                return 0;
         }
-        out += len;
-        /* Finally write tag */
-        CRYPTO_gcm128_tag(&gctx->gcm, out, EVP_GCM_TLS_TAG_LEN);
-        rv = len + EVP_GCM_TLS_EXPLICIT_IV_LEN + EVP_GCM_TLS_TAG_LEN;
     } else {
-        /* Decrypt */
         if (gctx->ctr) {
             size_t bulk = 0;
 # if defined(AES_GCM_ASM)
             if (len >= 16 && AES_GCM_ASM(gctx)) {
                 if (CRYPTO_gcm128_decrypt(&gctx->gcm, NULL, NULL, 0))
-                    return -1;
+                    return 0;
 
                 bulk = AES_gcm_decrypt(in, out, len,
                                        gctx->gcm.key,
@@ -1534,13 +1631,13 @@ static int aes_gcm_tls_cipher(EVP_CIPHER_CTX *ctx, unsigned char *out,
                                             in + bulk,
                                             out + bulk,
                                             len - bulk, gctx->ctr))
-                goto err;
+                return 0;
         } else {
             size_t bulk = 0;
 # if defined(AES_GCM_ASM2)
             if (len >= 16 && AES_GCM_ASM2(gctx)) {
                 if (CRYPTO_gcm128_decrypt(&gctx->gcm, NULL, NULL, 0))
-                    return -1;
+                    return 0;
 
                 bulk = AES_gcm_decrypt(in, out, len,
                                        gctx->gcm.key,
@@ -1550,8 +1647,48 @@ static int aes_gcm_tls_cipher(EVP_CIPHER_CTX *ctx, unsigned char *out,
 # endif
             if (CRYPTO_gcm128_decrypt(&gctx->gcm,
                                       in + bulk, out + bulk, len - bulk))
-                goto err;
+                return 0;
         }
+    }
+    return 1;
+}
+
+static int aes_gcm_tls_cipher(EVP_CIPHER_CTX *ctx, unsigned char *out,
+                              const unsigned char *in, size_t len)
+{
+    EVP_AES_GCM_CTX *gctx = ctx->cipher_data;
+    int rv = -1;
+    /* Encrypt/decrypt must be performed in place */
+    if (out != in
+        || len < (EVP_GCM_TLS_EXPLICIT_IV_LEN + EVP_GCM_TLS_TAG_LEN))
+        return -1;
+    /*
+     * Set IV from start of buffer or generate IV and write to start of
+     * buffer.
+     */
+    if (EVP_CIPHER_CTX_ctrl(ctx, ctx->encrypt ?
+                            EVP_CTRL_GCM_IV_GEN : EVP_CTRL_GCM_SET_IV_INV,
+                            EVP_GCM_TLS_EXPLICIT_IV_LEN, out) <= 0)
+        goto err;
+    /* Use saved AAD */
+    if (CRYPTO_gcm128_aad(&gctx->gcm, ctx->buf, gctx->tls_aad_len))
+        goto err;
+    /* Fix buffer and length to point to payload */
+    in += EVP_GCM_TLS_EXPLICIT_IV_LEN;
+    out += EVP_GCM_TLS_EXPLICIT_IV_LEN;
+    len -= EVP_GCM_TLS_EXPLICIT_IV_LEN + EVP_GCM_TLS_TAG_LEN;
+    if (ctx->encrypt) {
+        /* Encrypt payload */
+        if (!aes_gcm_crypt_msg(gctx, in, out, len, 1))
+            goto err;
+        out += len;
+        /* Finally write tag */
+        CRYPTO_gcm128_tag(&gctx->gcm, out, EVP_GCM_TLS_TAG_LEN);
+        rv = len + EVP_GCM_TLS_EXPLICIT_IV_LEN + EVP_GCM_TLS_TAG_LEN;
+    } else {
+        /* Decrypt */
+        if (!aes_gcm_crypt_msg(gctx, in, out, len, 0))
+            goto err;
         /* Retrieve tag */
         CRYPTO_gcm128_tag(&gctx->gcm, ctx->buf, EVP_GCM_TLS_TAG_LEN);
         /* If tag mismatch wipe buffer */
@@ -1705,6 +1842,10 @@ BLOCK_CIPHER_custom(NID_aes, 128, 1, 12, gcm, GCM,
     BLOCK_CIPHER_custom(NID_aes, 256, 1, 12, gcm, GCM,
                     EVP_CIPH_FLAG_AEAD_CIPHER | CUSTOM_FLAGS)
 
+# define XTS_MAX_THREADS         64
+/* Each additional thread gets at least this much of the input */
+# define XTS_THREAD_MIN_LEN      (64 * 1024)
+
 static int aes_xts_ctrl(EVP_CIPHER_CTX *c, int type, int arg, void *ptr)
 {
     EVP_AES_XTS_CTX *xctx = c->cipher_data;
@@ -1722,11 +1863,24 @@ static int aes_xts_ctrl(EVP_CIPHER_CTX *c, int type, int arg, void *ptr)
             xctx_out->xts.key2 = &xctx_out->ks2;
         }
         return 1;
+    } else if (type == EVP_CTRL_XTS_SET_UNIT_LEN) {
+        if (arg < 0 || (arg != 0 && (arg < AES_BLOCK_SIZE
+                                     || arg % AES_BLOCK_SIZE != 0)))
+            return 0;
+        xctx->unit_len = arg;
+        return 1;
+    } else if (type == EVP_CTRL_XTS_SET_THREADS) {
+        if (arg < 1)
+            return 0;
+        xctx->threads = arg > XTS_MAX_THREADS ? XTS_MAX_THREADS : arg;
+        return 1;
     } else if (type != EVP_CTRL_INIT)
         return -1;
     /* key1 and key2 are used as an indicator both key and IV are set */
     xctx->xts.key1 = NULL;
     xctx->xts.key2 = NULL;
+    xctx->unit_len = 0;
+    xctx->threads = 1;
     return 1;
 }
 
@@ -1815,6 +1969,140 @@ static int aes_xts_init_key(EVP_CIPHER_CTX *ctx, const unsigned char *key,
     return 1;
 }
 
+/* Add |n| to the little endian 128-bit data unit number |unit| */
+static void xts_unit_add(unsigned char unit[16], size_t n)
+{
+    int i;
+
+    for (i = 0; i < 16 && n != 0; i++) {
+        n += unit[i];
+        unit[i] = (unsigned char)n;
+        n >>= 8;
+    }
+}
+
+/* A contiguous run of data units and the thread processing it */
+typedef struct {
+    const EVP_AES_XTS_CTX *xctx;
+    int enc;
+    unsigned char unit[16];     /* number of the first data unit */
+    const unsigned char *in;
+    unsigned char *out;
+    size_t units;
+    int ok;
+# ifdef XTS_THREADS
+    pthread_t thread;
+# endif
+} XTS_RUN;
+
+static void xts_run(XTS_RUN *r)
+{
+    const EVP_AES_XTS_CTX *xctx = r->xctx;
+    const unsigned char *in = r->in;
+    unsigned char *out = r->out;
+    unsigned char iv[16];
+    size_t i;
+
+    memcpy(iv, r->unit, 16);
+    r->ok = 1;
+    for (i = 0; i < r->units; i++) {
+        if (xctx->stream)
+            (*xctx->stream) (in, out, xctx->unit_len,
+                             xctx->xts.key1, xctx->xts.key2, iv);
+        else if (CRYPTO_xts128_encrypt(&xctx->xts, iv, in, out,
+                                       xctx->unit_len, r->enc))
+            r->ok = 0;
+        in += xctx->unit_len;
+        out += xctx->unit_len;
+        xts_unit_add(iv, 1);
+    }
+}
+
+# ifdef XTS_THREADS
+static void *xts_thread(void *arg)
+{
+    xts_run(arg);
+    return NULL;
+}
+# endif
+
+/*
+ * Process |len| bytes as consecutive data units of xctx->unit_len bytes,
+ * the first one numbered by the IV, and leave the number of the next unit
+ * in the IV. The key schedules are only read, so runs of units can be
+ * handed to separate threads.
+ */
+static int aes_xts_cipher_units(EVP_CIPHER_CTX *ctx, unsigned char *out,
+                                const unsigned char *in, size_t len)
+{
+    EVP_AES_XTS_CTX *xctx = ctx->cipher_data;
+    XTS_RUN run[XTS_MAX_THREADS];
+    size_t units, per, done = 0;
+    int n = xctx->threads, i, started, ok = 1;
+# ifdef XTS_THREADS
+    int nthreads;
+# endif
+
+    if (len % xctx->unit_len != 0)
+        return 0;
+    units = len / xctx->unit_len;
+    if ((size_t)n > len / XTS_THREAD_MIN_LEN)
+        n = (int)(len / XTS_THREAD_MIN_LEN);
+    if ((size_t)n > units)
+        n = (int)units;
+    if (n < 1)
+        n = 1;
+# ifdef XTS_THREADS
+    nthreads = n;
+#  ifdef _SC_NPROCESSORS_ONLN
+    /*
+     * More threads than processors only add overhead, the calling thread
+     * does the runs that are left over
+     */
+    if (nthreads > 1) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+        if (cpus > 0 && nthreads > cpus)
+            nthreads = (int)cpus;
+    }
+#  endif
+# endif
+
+    per = units / n;
+    for (i = 0; i < n; i++) {
+        run[i].xctx = xctx;
+        run[i].enc = ctx->encrypt;
+        memcpy(run[i].unit, ctx->iv, 16);
+        xts_unit_add(run[i].unit, done);
+        run[i].in = in + done * xctx->unit_len;
+        run[i].out = out + done * xctx->unit_len;
+        run[i].units = i < n - 1 ? per : units - done;
+        done += run[i].units;
+    }
+
+    started = 1;
+# ifdef XTS_THREADS
+    for (; started < nthreads; started++)
+        if (pthread_create(&run[started].thread, NULL, xts_thread,
+                           &run[started]) != 0)
+            break;
+# endif
+    xts_run(&run[0]);
+    /* Runs whose thread could not be started are done here */
+    for (i = started; i < n; i++)
+        xts_run(&run[i]);
+    for (i = 0; i < n; i++) {
+# ifdef XTS_THREADS
+        if (i > 0 && i < started)
+            pthread_join(run[i].thread, NULL);
+# endif
+        ok &= run[i].ok;
+    }
+
+    xts_unit_add(ctx->iv, units);
+    return ok;
+}
+
 static int aes_xts_cipher(EVP_CIPHER_CTX *ctx, unsigned char *out,
                           const unsigned char *in, size_t len)
 {
@@ -1823,6 +2111,8 @@ static int aes_xts_cipher(EVP_CIPHER_CTX *ctx, unsigned char *out,
         return 0;
     if (!out || !in || len < AES_BLOCK_SIZE)
         return 0;
+    if (xctx->unit_len != 0)
+        return aes_xts_cipher_units(ctx, out, in, len);
     if (xctx->stream)
         (*xctx->stream) (in, out, len,
                          xctx->xts.key1, xctx->xts.key2, ctx->iv);
@@ -1902,41 +2192,66 @@ static int aes_ccm_ctrl(EVP_CIPHER_CTX *c, int type, int arg, void *ptr)
     }
 }
 
+/*
+ * Expand |key| into |cctx| for the fastest available AES implementation and
+ * return its ccm64 stream functions in |enc| and |dec|, NULL if it has none.
+ */
+static void aes_ccm_set_key(EVP_AES_CCM_CTX *cctx, const unsigned char *key,
+                            int bits, ccm128_f *enc, ccm128_f *dec)
+{
+    *enc = *dec = NULL;
+# ifdef AESNI_CAPABLE
+    if (AESNI_CAPABLE) {
+        aesni_set_encrypt_key(key, bits, &cctx->ks.ks);
+        CRYPTO_ccm128_init(&cctx->ccm, cctx->M, cctx->L,
+                           &cctx->ks, (block128_f) aesni_encrypt);
+        *enc = (ccm128_f) aesni_ccm64_encrypt_blocks;
+        *dec = (ccm128_f) aesni_ccm64_decrypt_blocks;
+        return;
+    }
+# endif
+# ifdef SPARC_AES_CAPABLE
+    if (SPARC_AES_CAPABLE) {
+        aes_t4_set_encrypt_key(key, bits, &cctx->ks.ks);
+        CRYPTO_ccm128_init(&cctx->ccm, cctx->M, cctx->L,
+                           &cctx->ks, (block128_f) aes_t4_encrypt);
+        return;
+    }
+# endif
+# ifdef HWAES_CAPABLE
+    if (HWAES_CAPABLE) {
+        HWAES_set_encrypt_key(key, bits, &cctx->ks.ks);
+        CRYPTO_ccm128_init(&cctx->ccm, cctx->M, cctx->L,
+                           &cctx->ks, (block128_f) HWAES_encrypt);
+        return;
+    }
+# endif
+# ifdef VPAES_CAPABLE
+    if (VPAES_CAPABLE) {
+        vpaes_set_encrypt_key(key, bits, &cctx->ks.ks);
+        CRYPTO_ccm128_init(&cctx->ccm, cctx->M, cctx->L,
+                           &cctx->ks, (block128_f) vpaes_encrypt);
+        return;
+    }
+# endif
+    AES_set_encrypt_key(key, bits, &cctx->ks.ks);
+    CRYPTO_ccm128_init(&cctx->ccm, cctx->M, cctx->L,
+                       &cctx->ks, (block128_f) AES_encrypt);
+}
+
 static int aes_ccm_init_key(EVP_CIPHER_CTX *ctx, const unsigned char *key,
                             const unsigned char *iv, int enc)
 {
     EVP_AES_CCM_CTX *cctx = ctx->cipher_data;
     if (!iv && !key)
         return 1;
-    if (key)
-        do {
-# ifdef HWAES_CAPABLE
-            if (HWAES_CAPABLE) {
-                HWAES_set_encrypt_key(key, ctx->key_len * 8, &cctx->ks.ks);
+    if (key) {
+        ccm128_f str_enc, str_dec;
 
-                CRYPTO_ccm128_init(&cctx->ccm, cctx->M, cctx->L,
-                                   &cctx->ks, (block128_f) HWAES_encrypt);
-                cctx->str = NULL;
-                cctx->key_set = 1;
-                break;
-            } else
-# endif
-# ifdef VPAES_CAPABLE
-            if (VPAES_CAPABLE) {
-                vpaes_set_encrypt_key(key, ctx->key_len * 8, &cctx->ks.ks);
-                CRYPTO_ccm128_init(&cctx->ccm, cctx->M, cctx->L,
-                                   &cctx->ks, (block128_f) vpaes_encrypt);
-                cctx->str = NULL;
-                cctx->key_set = 1;
-                break;
-            }
-# endif
-            AES_set_encrypt_key(key, ctx->key_len * 8, &cctx->ks.ks);
-            CRYPTO_ccm128_init(&cctx->ccm, cctx->M, cctx->L,
-                               &cctx->ks, (block128_f) AES_encrypt);
-            cctx->str = NULL;
-            cctx->key_set = 1;
-        } while (0);
+        aes_ccm_set_key(cctx, key, ctx->key_len * 8, &str_enc, &str_dec);
+        cctx->str = enc ? str_enc : str_dec;
+        cctx->key_set = 1;
+    }
     if (iv) {
         memcpy(ctx->iv, iv, 15 - cctx->L);
         cctx->iv_set = 1;
@@ -2010,6 +2325,194 @@ BLOCK_CIPHER_custom(NID_aes, 128, 1, 12, ccm, CCM, CUSTOM_FLAGS)
     BLOCK_CIPHER_custom(NID_aes, 192, 1, 12, ccm, CCM, CUSTOM_FLAGS)
     BLOCK_CIPHER_custom(NID_aes, 256, 1, 12, ccm, CCM, CUSTOM_FLAGS)
 
+/*
+ * EVP_AEAD versions of GCM and CCM: the key is expanded once and every
+ * message is sealed or opened with direct calls into the mode code.
+ */
+
+static int aead_aes_gcm_init(EVP_AEAD_CTX *ctx, const unsigned char *key)
+{
+    EVP_AES_GCM_CTX *gctx;
+
+    /* The tag lengths allowed by NIST SP 800-38D */
+    if (ctx->tag_len < 12 && ctx->tag_len != 8 && ctx->tag_len != 4) {
+        EVPerr(EVP_F_AEAD_AES_GCM_INIT, EVP_R_INVALID_TAG_LENGTH);
+        return 0;
+    }
+    gctx = OPENSSL_malloc(sizeof(*gctx));
+    if (gctx == NULL) {
+        EVPerr(EVP_F_AEAD_AES_GCM_INIT, ERR_R_MALLOC_FAILURE);
+        return 0;
+    }
+    memset(gctx, 0, sizeof(*gctx));
+    aes_gcm_set_key(gctx, key, ctx->aead->key_len * 8);
+    ctx->aead_state = gctx;
+    return 1;
+}
+
+static void aead_aes_gcm_cleanup(EVP_AEAD_CTX *ctx)
+{
+    OPENSSL_cleanse(ctx->aead_state, sizeof(EVP_AES_GCM_CTX));
+    OPENSSL_free(ctx->aead_state);
+}
+
+static int aead_aes_gcm_seal(EVP_AEAD_CTX *ctx, unsigned char *out,
+                             const unsigned char *nonce, size_t nonce_len,
+                             const unsigned char *in, size_t in_len,
+                             const unsigned char *ad, size_t ad_len)
+{
+    EVP_AES_GCM_CTX *gctx = ctx->aead_state;
+
+    if (nonce_len == 0) {
+        EVPerr(EVP_F_AEAD_AES_GCM_SEAL, EVP_R_INVALID_NONCE_LENGTH);
+        return 0;
+    }
+    CRYPTO_gcm128_setiv(&gctx->gcm, nonce, nonce_len);
+    if ((ad_len != 0 && CRYPTO_gcm128_aad(&gctx->gcm, ad, ad_len))
+        || !aes_gcm_crypt_msg(gctx, in, out, in_len, 1)) {
+        EVPerr(EVP_F_AEAD_AES_GCM_SEAL, EVP_R_TOO_LARGE);
+        return 0;
+    }
+    CRYPTO_gcm128_tag(&gctx->gcm, out + in_len, ctx->tag_len);
+    return 1;
+}
+
+static int aead_aes_gcm_open(EVP_AEAD_CTX *ctx, unsigned char *out,
+                             const unsigned char *nonce, size_t nonce_len,
+                             const unsigned char *in, size_t len,
+                             const unsigned char *ad, size_t ad_len)
+{
+    EVP_AES_GCM_CTX *gctx = ctx->aead_state;
+
+    if (nonce_len == 0) {
+        EVPerr(EVP_F_AEAD_AES_GCM_OPEN, EVP_R_INVALID_NONCE_LENGTH);
+        return 0;
+    }
+    CRYPTO_gcm128_setiv(&gctx->gcm, nonce, nonce_len);
+    if ((ad_len != 0 && CRYPTO_gcm128_aad(&gctx->gcm, ad, ad_len))
+        || !aes_gcm_crypt_msg(gctx, in, out, len, 0)
+        || CRYPTO_gcm128_finish(&gctx->gcm, in + len, ctx->tag_len) != 0) {
+        EVPerr(EVP_F_AEAD_AES_GCM_OPEN, EVP_R_BAD_DECRYPT);
+        return 0;
+    }
+    return 1;
+}
+
+typedef struct {
+    EVP_AES_CCM_CTX cctx;
+    ccm128_f enc, dec;          /* ccm64 streams, NULL if there are none */
+} AEAD_AES_CCM_CTX;
+
+static int aead_aes_ccm_init(EVP_AEAD_CTX *ctx, const unsigned char *key)
+{
+    AEAD_AES_CCM_CTX *actx;
+
+    if ((ctx->tag_len & 1) || ctx->tag_len < 4) {
+        EVPerr(EVP_F_AEAD_AES_CCM_INIT, EVP_R_INVALID_TAG_LENGTH);
+        return 0;
+    }
+    actx = OPENSSL_malloc(sizeof(*actx));
+    if (actx == NULL) {
+        EVPerr(EVP_F_AEAD_AES_CCM_INIT, ERR_R_MALLOC_FAILURE);
+        return 0;
+    }
+    memset(actx, 0, sizeof(*actx));
+    actx->cctx.M = ctx->tag_len;
+    /* L follows from the nonce length of each message */
+    actx->cctx.L = 15 - ctx->aead->nonce_len;
+    aes_ccm_set_key(&actx->cctx, key, ctx->aead->key_len * 8,
+                    &actx->enc, &actx->dec);
+    ctx->aead_state = actx;
+    return 1;
+}
+
+static void aead_aes_ccm_cleanup(EVP_AEAD_CTX *ctx)
+{
+    OPENSSL_cleanse(ctx->aead_state, sizeof(AEAD_AES_CCM_CTX));
+    OPENSSL_free(ctx->aead_state);
+}
+
+/* Start a CCM message of |len| bytes, 0 if it does not fit the nonce */
+static int aead_aes_ccm_start(AEAD_AES_CCM_CTX *actx,
+                              const unsigned char *nonce, size_t nonce_len,
+                              size_t len, const unsigned char *ad,
+                              size_t ad_len)
+{
+    CCM128_CONTEXT *ccm = &actx->cctx.ccm;
+    unsigned int L = 15 - nonce_len;
+
+    CRYPTO_ccm128_init(ccm, actx->cctx.M, L, ccm->key, ccm->block);
+    if (L < sizeof(len) && (len >> (8 * L)) != 0)
+        return 0;
+    if (CRYPTO_ccm128_setiv(ccm, nonce, nonce_len, len))
+        return 0;
+    CRYPTO_ccm128_aad(ccm, ad, ad_len);
+    return 1;
+}
+
+static int aead_aes_ccm_seal(EVP_AEAD_CTX *ctx, unsigned char *out,
+                             const unsigned char *nonce, size_t nonce_len,
+                             const unsigned char *in, size_t in_len,
+                             const unsigned char *ad, size_t ad_len)
+{
+    AEAD_AES_CCM_CTX *actx = ctx->aead_state;
+    CCM128_CONTEXT *ccm = &actx->cctx.ccm;
+
+    if (nonce_len < 7 || nonce_len > 13) {
+        EVPerr(EVP_F_AEAD_AES_CCM_SEAL, EVP_R_INVALID_NONCE_LENGTH);
+        return 0;
+    }
+    if (!aead_aes_ccm_start(actx, nonce, nonce_len, in_len, ad, ad_len)
+        || (actx->enc ? CRYPTO_ccm128_encrypt_ccm64(ccm, in, out, in_len,
+                                                    actx->enc) :
+            CRYPTO_ccm128_encrypt(ccm, in, out, in_len))) {
+        EVPerr(EVP_F_AEAD_AES_CCM_SEAL, EVP_R_TOO_LARGE);
+        return 0;
+    }
+    CRYPTO_ccm128_tag(ccm, out + in_len, ctx->tag_len);
+    return 1;
+}
+
+static int aead_aes_ccm_open(EVP_AEAD_CTX *ctx, unsigned char *out,
+                             const unsigned char *nonce, size_t nonce_len,
+                             const unsigned char *in, size_t len,
+                             const unsigned char *ad, size_t ad_len)
+{
+    AEAD_AES_CCM_CTX *actx = ctx->aead_state;
+    CCM128_CONTEXT *ccm = &actx->cctx.ccm;
+    unsigned char tag[16];
+
+    if (nonce_len < 7 || nonce_len > 13) {
+        EVPerr(EVP_F_AEAD_AES_CCM_OPEN, EVP_R_INVALID_NONCE_LENGTH);
+        return 0;
+    }
+    if (!aead_aes_ccm_start(actx, nonce, nonce_len, len, ad, ad_len)
+        || (actx->dec ? CRYPTO_ccm128_decrypt_ccm64(ccm, in, out, len,
+                                                    actx->dec) :
+            CRYPTO_ccm128_decrypt(ccm, in, out, len))
+        || !CRYPTO_ccm128_tag(ccm, tag, ctx->tag_len)
+        || CRYPTO_memcmp(tag, in + len, ctx->tag_len) != 0) {
+        EVPerr(EVP_F_AEAD_AES_CCM_OPEN, EVP_R_BAD_DECRYPT);
+        return 0;
+    }
+    return 1;
+}
+
+# define BLOCK_AEAD(keylen, mode, noncelen) \
+static const EVP_AEAD aead_aes_##keylen##_##mode = { \
+        keylen / 8, noncelen, 16, \
+        aead_aes_##mode##_init, aead_aes_##mode##_cleanup, \
+        aead_aes_##mode##_seal, aead_aes_##mode##_open }; \
+const EVP_AEAD *EVP_aead_aes_##keylen##_##mode(void) \
+{ return &aead_aes_##keylen##_##mode; }
+
+BLOCK_AEAD(128, gcm, 12)
+    BLOCK_AEAD(192, gcm, 12)
+    BLOCK_AEAD(256, gcm, 12)
+    BLOCK_AEAD(128, ccm, 12)
+    BLOCK_AEAD(192, ccm, 12)
+    BLOCK_AEAD(256, ccm, 12)
+
 typedef struct {
     union {
         double align;
@@ -2263,7 +2766,8 @@ static int aes_ocb_init_key(EVP_CIPHER_CTX *ctx, const unsigned char *key,
                 if (!CRYPTO_ocb128_init(&octx->ocb,
                                         &octx->ksenc.ks, &octx->ksdec.ks,
                                         (block128_f) vpaes_encrypt,
-                                        (block128_f) vpaes_decrypt))
+                                        (block128_f) vpaes_decrypt,
+                                        NULL))
                     return 0;
                 break;
             }
@@ -2273,7 +2777,8 @@ static int aes_ocb_init_key(EVP_CIPHER_CTX *ctx, const unsigned char *key,
             if (!CRYPTO_ocb128_init(&octx->ocb,
                                     &octx->ksenc.ks, &octx->ksdec.ks,
                                     (block128_f) AES_encrypt,
-                                    (block128_f) AES_decrypt))
+                                    (block128_f) AES_decrypt,
+                                    NULL))
                 return 0;
         }
         while (0);
@@ -2366,6 +2871,8 @@ static int aes_ocb_cipher(EVP_CIPHER_CTX *ctx, unsigned char *out,
             }
             written_len = 16;
             *buf_len = 0;
+            if (out != NULL)
+                out += 16;
         }
 
         /* Do we have a partial block to handle at the end? */
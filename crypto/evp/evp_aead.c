@@ -0,0 +1,188 @@
+/* crypto/evp/evp_aead.c */
+/* ====================================================================
+ * Copyright (c) 2015 The OpenSSL Project.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. All advertising materials mentioning features or use of this
+ *    software must display the following acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit. (http://www.openssl.org/)"
+ *
+ * 4. The names "OpenSSL Toolkit" and "OpenSSL Project" must not be used to
+ *    endorse or promote products derived from this software without
+ *    prior written permission. For written permission, please contact
+ *    openssl-core@openssl.org.
+ *
+ * 5. Products derived from this software may not be called "OpenSSL"
+ *    nor may "OpenSSL" appear in their names without prior written
+ *    permission of the OpenSSL Project.
+ *
+ * 6. Redistributions of any form whatsoever must retain the following
+ *    acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit (http://www.openssl.org/)"
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE OpenSSL PROJECT ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE OpenSSL PROJECT OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ====================================================================
+ */
+
+/*
+ * The EVP_AEAD interface seals and opens whole messages in one call: a
+ * context holds the expanded key, and each call supplies the nonce, the
+ * additional data and the input, with the tag appended to or taken from
+ * the end of the ciphertext. There is no per-message Init/Update/Final
+ * sequence, which dominates the cost of short messages through
+ * EVP_CIPHER_CTX.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "cryptlib.h"
+#include <openssl/evp.h>
+#include "evp_locl.h"
+
+size_t EVP_AEAD_key_length(const EVP_AEAD *aead)
+{
+    return aead->key_len;
+}
+
+size_t EVP_AEAD_nonce_length(const EVP_AEAD *aead)
+{
+    return aead->nonce_len;
+}
+
+size_t EVP_AEAD_max_overhead(const EVP_AEAD *aead)
+{
+    return aead->overhead;
+}
+
+int EVP_AEAD_CTX_init(EVP_AEAD_CTX *ctx, const EVP_AEAD *aead,
+                      const unsigned char *key, size_t key_len,
+                      size_t tag_len)
+{
+    ctx->aead = NULL;
+    ctx->aead_state = NULL;
+    if (key_len != aead->key_len) {
+        EVPerr(EVP_F_EVP_AEAD_CTX_INIT, EVP_R_INVALID_KEY_LENGTH);
+        return 0;
+    }
+    if (tag_len == EVP_AEAD_DEFAULT_TAG_LENGTH)
+        tag_len = aead->overhead;
+    if (tag_len > aead->overhead) {
+        EVPerr(EVP_F_EVP_AEAD_CTX_INIT, EVP_R_INVALID_TAG_LENGTH);
+        return 0;
+    }
+    ctx->aead = aead;
+    ctx->tag_len = tag_len;
+    if (!aead->init(ctx, key)) {
+        ctx->aead = NULL;
+        return 0;
+    }
+    return 1;
+}
+
+void EVP_AEAD_CTX_cleanup(EVP_AEAD_CTX *ctx)
+{
+    if (ctx->aead == NULL)
+        return;
+    ctx->aead->cleanup(ctx);
+    ctx->aead = NULL;
+    ctx->aead_state = NULL;
+}
+
+/* |out| may be |in| itself but must not otherwise overlap it */
+static int aead_check_alias(const unsigned char *in, size_t in_len,
+                            const unsigned char *out, size_t out_len)
+{
+    if (in == out)
+        return 1;
+    return out + out_len <= in || in + in_len <= out;
+}
+
+int EVP_AEAD_CTX_seal(EVP_AEAD_CTX *ctx, unsigned char *out,
+                      size_t *out_len, size_t max_out_len,
+                      const unsigned char *nonce, size_t nonce_len,
+                      const unsigned char *in, size_t in_len,
+                      const unsigned char *ad, size_t ad_len)
+{
+    size_t len = in_len + ctx->tag_len;
+
+    if (len < in_len) {
+        EVPerr(EVP_F_EVP_AEAD_CTX_SEAL, EVP_R_TOO_LARGE);
+        goto err;
+    }
+    if (max_out_len < len) {
+        EVPerr(EVP_F_EVP_AEAD_CTX_SEAL, EVP_R_BUFFER_TOO_SMALL);
+        goto err;
+    }
+    if (!aead_check_alias(in, in_len, out, len)) {
+        EVPerr(EVP_F_EVP_AEAD_CTX_SEAL, EVP_R_OUTPUT_ALIASES_INPUT);
+        goto err;
+    }
+    if (!ctx->aead->seal(ctx, out, nonce, nonce_len, in, in_len,
+                         ad, ad_len))
+        goto err;
+    *out_len = len;
+    return 1;
+
+ err:
+    /* Make sure nothing is mistaken for a sealed message */
+    memset(out, 0, max_out_len);
+    *out_len = 0;
+    return 0;
+}
+
+int EVP_AEAD_CTX_open(EVP_AEAD_CTX *ctx, unsigned char *out,
+                      size_t *out_len, size_t max_out_len,
+                      const unsigned char *nonce, size_t nonce_len,
+                      const unsigned char *in, size_t in_len,
+                      const unsigned char *ad, size_t ad_len)
+{
+    size_t len;
+
+    if (in_len < ctx->tag_len) {
+        EVPerr(EVP_F_EVP_AEAD_CTX_OPEN, EVP_R_BAD_DECRYPT);
+        goto err;
+    }
+    len = in_len - ctx->tag_len;
+    if (max_out_len < len) {
+        EVPerr(EVP_F_EVP_AEAD_CTX_OPEN, EVP_R_BUFFER_TOO_SMALL);
+        goto err;
+    }
+    if (!aead_check_alias(in, in_len, out, len)) {
+        EVPerr(EVP_F_EVP_AEAD_CTX_OPEN, EVP_R_OUTPUT_ALIASES_INPUT);
+        goto err;
+    }
+    if (!ctx->aead->open(ctx, out, nonce, nonce_len, in, len, ad, ad_len))
+        goto err;
+    *out_len = len;
+    return 1;
+
+ err:
+    /* Never release unauthenticated plaintext */
+    memset(out, 0, max_out_len);
+    *out_len = 0;
+    return 0;
+}
@@ -115,25 +115,17 @@ int EVP_CipherInit_ex(EVP_CIPHER_CTX *ctx, const EVP_CIPHER *cipher,
         goto skip_to_init;
 #endif
     if (cipher) {
-        /*
-         * Ensure a context left lying around from last time is cleared (the
-         * previous check attempted to avoid this if the same ENGINE and
-         * EVP_CIPHER could be used).
-         */
-        if (ctx->cipher) {
-            unsigned long flags = ctx->flags;
-            EVP_CIPHER_CTX_cleanup(ctx);
-            /* Restore encrypt and flags */
-            ctx->encrypt = enc;
-            ctx->flags = flags;
-        }
 #ifndef OPENSSL_NO_ENGINE
         if (impl) {
             if (!ENGINE_init(impl)) {
                 EVPerr(EVP_F_EVP_CIPHERINIT_EX, EVP_R_INITIALIZATION_ERROR);
                 return 0;
             }
-        } else
+        } else if (cipher == ctx->cipher
+                   && (ctx->flags & EVP_CIPHER_CTX_FLAG_KEEP_IMPL))
+            /* The caller has pinned the implementation we already have */
+            impl = NULL;
+        else
             /* Ask if an ENGINE is reserved for this job */
             impl = ENGINE_get_cipher_engine(cipher->nid);
         if (impl) {
@@ -146,32 +138,64 @@ int EVP_CipherInit_ex(EVP_CIPHER_CTX *ctx, const EVP_CIPHER *cipher,
                  * mispellings of "initialisation"?
                  */
                 EVPerr(EVP_F_EVP_CIPHERINIT_EX, EVP_R_INITIALIZATION_ERROR);
+                ENGINE_finish(impl);
                 return 0;
             }
             /* We'll use the ENGINE's private cipher definition */
             cipher = c;
+        }
+#endif
+
+        if (cipher == ctx->cipher && ctx->engine == NULL) {
             /*
-             * Store the ENGINE functional reference so we know 'cipher' came
-             * from an ENGINE and we need to release it when done.
+             * Same implementation as last time: clear out the old state but
+             * keep the context storage rather than freeing and allocating it
+             * again.
              */
-            ctx->engine = impl;
-        } else
-            ctx->engine = NULL;
+            if (cipher->cleanup)
+                cipher->cleanup(ctx);
+            if (ctx->cipher_data)
+                OPENSSL_cleanse(ctx->cipher_data, cipher->ctx_size);
+        } else {
+            /*
+             * Ensure a context left lying around from last time is cleared
+             * (the previous check attempted to avoid this if the same ENGINE
+             * and EVP_CIPHER could be used).
+             */
+            if (ctx->cipher) {
+                unsigned long flags = ctx->flags;
+                EVP_CIPHER_CTX_cleanup(ctx);
+                /* Restore encrypt and flags */
+                ctx->encrypt = enc;
+                ctx->flags = flags;
+            }
+            ctx->cipher = cipher;
+            if (ctx->cipher->ctx_size) {
+                ctx->cipher_data = OPENSSL_malloc(ctx->cipher->ctx_size);
+                if (!ctx->cipher_data) {
+#ifndef OPENSSL_NO_ENGINE
+                    if (impl)
+                        ENGINE_finish(impl);
 #endif
-
-        ctx->cipher = cipher;
-        if (ctx->cipher->ctx_size) {
-            ctx->cipher_data = OPENSSL_malloc(ctx->cipher->ctx_size);
-            if (!ctx->cipher_data) {
-                EVPerr(EVP_F_EVP_CIPHERINIT_EX, ERR_R_MALLOC_FAILURE);
-                return 0;
+                    ctx->cipher = NULL;
+                    EVPerr(EVP_F_EVP_CIPHERINIT_EX, ERR_R_MALLOC_FAILURE);
+                    return 0;
+                }
+            } else {
+                ctx->cipher_data = NULL;
             }
-        } else {
-            ctx->cipher_data = NULL;
         }
+#ifndef OPENSSL_NO_ENGINE
+        /*
+         * Store the ENGINE functional reference so we know 'cipher' came
+         * from an ENGINE and we need to release it when done.
+         */
+        ctx->engine = impl;
+#endif
         ctx->key_len = cipher->key_len;
-        /* Preserve wrap enable flag, zero everything else */
-        ctx->flags &= EVP_CIPHER_CTX_FLAG_WRAP_ALLOW;
+        /* Preserve wrap enable and keep implementation flags */
+        ctx->flags &= EVP_CIPHER_CTX_FLAG_WRAP_ALLOW
+                      | EVP_CIPHER_CTX_FLAG_KEEP_IMPL;
         if (ctx->cipher->flags & EVP_CIPH_CTRL_INIT) {
             if (!EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_INIT, 0, NULL)) {
                 EVPerr(EVP_F_EVP_CIPHERINIT_EX, EVP_R_INITIALIZATION_ERROR);
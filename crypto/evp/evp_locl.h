@@ -265,3 +265,22 @@ int PKCS5_v2_PBKDF2_keyivgen(EVP_CIPHER_CTX *ctx, const char *pass,
                              int passlen, ASN1_TYPE *param,
                              const EVP_CIPHER *c, const EVP_MD *md,
                              int en_de);
+
+struct evp_aead_st {
+    size_t key_len;
+    size_t nonce_len;           /* recommended nonce length */
+    size_t overhead;            /* longest tag */
+    /* Set up ctx->aead_state for |key|, ctx->tag_len is already set */
+    int (*init) (EVP_AEAD_CTX *ctx, const unsigned char *key);
+    void (*cleanup) (EVP_AEAD_CTX *ctx);
+    /* Write |in_len| bytes of ciphertext and then the tag to |out| */
+    int (*seal) (EVP_AEAD_CTX *ctx, unsigned char *out,
+                 const unsigned char *nonce, size_t nonce_len,
+                 const unsigned char *in, size_t in_len,
+                 const unsigned char *ad, size_t ad_len);
+    /* Decrypt |len| bytes of |in| and check the tag that follows them */
+    int (*open) (EVP_AEAD_CTX *ctx, unsigned char *out,
+                 const unsigned char *nonce, size_t nonce_len,
+                 const unsigned char *in, size_t len,
+                 const unsigned char *ad, size_t ad_len);
+} /* EVP_AEAD */ ;
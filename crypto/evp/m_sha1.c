@@ -65,6 +65,17 @@
 #ifndef OPENSSL_NO_RSA
 # include <openssl/rsa.h>
 #endif
+#include "internal/sha_mb.h"
+
+#ifdef SHA_MULTI_BLOCK
+# define SHA1_BATCH     sha1_digest_batch
+# define SHA224_BATCH   sha224_digest_batch
+# define SHA256_BATCH   sha256_digest_batch
+#else
+# define SHA1_BATCH     NULL
+# define SHA224_BATCH   NULL
+# define SHA256_BATCH   NULL
+#endif
 
 static int init(EVP_MD_CTX *ctx)
 {
@@ -94,6 +105,8 @@ static const EVP_MD sha1_md = {
     EVP_PKEY_NULL_method,
     SHA_CBLOCK,
     sizeof(EVP_MD *) + sizeof(SHA_CTX),
+    NULL,
+    SHA1_BATCH
 };
 
 const EVP_MD *EVP_sha1(void)
@@ -139,6 +152,8 @@ static const EVP_MD sha224_md = {
     EVP_PKEY_NULL_method,
     SHA256_CBLOCK,
     sizeof(EVP_MD *) + sizeof(SHA256_CTX),
+    NULL,
+    SHA224_BATCH
 };
 
 const EVP_MD *EVP_sha224(void)
@@ -159,6 +174,8 @@ static const EVP_MD sha256_md = {
     EVP_PKEY_NULL_method,
     SHA256_CBLOCK,
     sizeof(EVP_MD *) + sizeof(SHA256_CTX),
+    NULL,
+    SHA256_BATCH
 };
 
 const EVP_MD *EVP_sha256(void)
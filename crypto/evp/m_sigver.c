@@ -64,15 +64,32 @@
 #include <openssl/x509.h>
 #include "internal/evp_int.h"
 
+/*
+ * Update function of a context set up without a digest, for an algorithm
+ * that signs the message itself in one go.
+ */
+static int update(EVP_MD_CTX *ctx, const void *data, size_t datalen)
+{
+    EVPerr(EVP_F_UPDATE, EVP_R_ONLY_ONESHOT_SUPPORTED);
+    return 0;
+}
+
 static int do_sigver_init(EVP_MD_CTX *ctx, EVP_PKEY_CTX **pctx,
                           const EVP_MD *type, ENGINE *e, EVP_PKEY *pkey,
                           int ver)
 {
+    int oneshot;
+
     if (ctx->pctx == NULL)
         ctx->pctx = EVP_PKEY_CTX_new(pkey, e);
     if (ctx->pctx == NULL)
         return 0;
 
+    if (ver)
+        oneshot = ctx->pctx->pmeth->digestverify != NULL;
+    else
+        oneshot = ctx->pctx->pmeth->digestsign != NULL;
+
     if (!(ctx->pctx->pmeth->flags & EVP_PKEY_FLAG_SIGCTX_CUSTOM)) {
 
         if (type == NULL) {
@@ -81,7 +98,7 @@ static int do_sigver_init(EVP_MD_CTX *ctx, EVP_PKEY_CTX **pctx,
                 type = EVP_get_digestbynid(def_nid);
         }
 
-        if (type == NULL) {
+        if (type == NULL && !oneshot) {
             EVPerr(EVP_F_DO_SIGVER_INIT, EVP_R_NO_DEFAULT_DIGEST);
             return 0;
         }
@@ -108,6 +125,11 @@ static int do_sigver_init(EVP_MD_CTX *ctx, EVP_PKEY_CTX **pctx,
         *pctx = ctx->pctx;
     if (ctx->pctx->pmeth->flags & EVP_PKEY_FLAG_SIGCTX_CUSTOM)
         return 1;
+    if (type == NULL) {
+        /* Only EVP_DigestSign() and EVP_DigestVerify() can be used */
+        ctx->update = update;
+        return 1;
+    }
     if (!EVP_DigestInit_ex(ctx, type, e))
         return 0;
     return 1;
@@ -130,6 +152,10 @@ int EVP_DigestSignFinal(EVP_MD_CTX *ctx, unsigned char *sigret,
 {
     int sctx, r = 0;
     EVP_PKEY_CTX *pctx = ctx->pctx;
+    if (ctx->update == update) {
+        EVPerr(EVP_F_EVP_DIGESTSIGNFINAL, EVP_R_ONLY_ONESHOT_SUPPORTED);
+        return 0;
+    }
     if (pctx->pmeth->flags & EVP_PKEY_FLAG_SIGCTX_CUSTOM) {
         if (!sigret)
             return pctx->pmeth->signctx(pctx, sigret, siglen, ctx);
@@ -193,6 +219,10 @@ int EVP_DigestVerifyFinal(EVP_MD_CTX *ctx, const unsigned char *sig,
     unsigned int mdlen;
     int vctx;
 
+    if (ctx->update == update) {
+        EVPerr(EVP_F_EVP_DIGESTVERIFYFINAL, EVP_R_ONLY_ONESHOT_SUPPORTED);
+        return -1;
+    }
     if (ctx->pctx->pmeth->verifyctx)
         vctx = 1;
     else
@@ -218,3 +248,23 @@ int EVP_DigestVerifyFinal(EVP_MD_CTX *ctx, const unsigned char *sig,
         return r;
     return EVP_PKEY_verify(ctx->pctx, sig, siglen, md, mdlen);
 }
+
+int EVP_DigestSign(EVP_MD_CTX *ctx, unsigned char *sigret, size_t *siglen,
+                   const unsigned char *tbs, size_t tbslen)
+{
+    if (ctx->pctx->pmeth->digestsign != NULL)
+        return ctx->pctx->pmeth->digestsign(ctx, sigret, siglen, tbs, tbslen);
+    if (sigret != NULL && EVP_DigestSignUpdate(ctx, tbs, tbslen) <= 0)
+        return 0;
+    return EVP_DigestSignFinal(ctx, sigret, siglen);
+}
+
+int EVP_DigestVerify(EVP_MD_CTX *ctx, const unsigned char *sig,
+                     size_t siglen, const unsigned char *tbs, size_t tbslen)
+{
+    if (ctx->pctx->pmeth->digestverify != NULL)
+        return ctx->pctx->pmeth->digestverify(ctx, sig, siglen, tbs, tbslen);
+    if (EVP_DigestVerifyUpdate(ctx, tbs, tbslen) <= 0)
+        return -1;
+    return EVP_DigestVerifyFinal(ctx, sig, siglen);
+}
@@ -83,25 +83,29 @@ int PKCS5_PBKDF2_HMAC(const char *pass, int passlen,
                       const EVP_MD *digest, int keylen, unsigned char *out)
 {
     unsigned char digtmp[EVP_MAX_MD_SIZE], *p, itmp[4];
-    int cplen, j, k, tkeylen, mdlen;
+    int cplen, j, k, tkeylen, mdlen, ret = 0;
     unsigned long i = 1;
-    HMAC_CTX hctx_tpl, hctx;
+    HMAC_KEY hkey;
+    HMAC_CTX hctx;
 
     mdlen = EVP_MD_size(digest);
     if (mdlen < 0)
         return 0;
 
-    HMAC_CTX_init(&hctx_tpl);
+    HMAC_KEY_init(&hkey);
+    HMAC_CTX_init(&hctx);
     p = out;
     tkeylen = keylen;
     if (!pass)
         passlen = 0;
     else if (passlen == -1)
         passlen = strlen(pass);
-    if (!HMAC_Init_ex(&hctx_tpl, pass, passlen, digest, NULL)) {
-        HMAC_CTX_cleanup(&hctx_tpl);
-        return 0;
-    }
+    /*
+     * Hash the password pads once: every HMAC below starts from copies of
+     * the resulting states.
+     */
+    if (!HMAC_KEY_set(&hkey, pass, passlen, digest, NULL))
+        goto err;
     while (tkeylen) {
         if (tkeylen > mdlen)
             cplen = mdlen;
@@ -115,31 +119,17 @@ int PKCS5_PBKDF2_HMAC(const char *pass, int passlen,
         itmp[1] = (unsigned char)((i >> 16) & 0xff);
         itmp[2] = (unsigned char)((i >> 8) & 0xff);
         itmp[3] = (unsigned char)(i & 0xff);
-        if (!HMAC_CTX_copy(&hctx, &hctx_tpl)) {
-            HMAC_CTX_cleanup(&hctx_tpl);
-            return 0;
-        }
-        if (!HMAC_Update(&hctx, salt, saltlen)
+        if (!HMAC_Init_key(&hctx, &hkey)
+            || !HMAC_Update(&hctx, salt, saltlen)
             || !HMAC_Update(&hctx, itmp, 4)
-            || !HMAC_Final(&hctx, digtmp, NULL)) {
-            HMAC_CTX_cleanup(&hctx_tpl);
-            HMAC_CTX_cleanup(&hctx);
-            return 0;
-        }
-        HMAC_CTX_cleanup(&hctx);
+            || !HMAC_Final(&hctx, digtmp, NULL))
+            goto err;
         memcpy(p, digtmp, cplen);
         for (j = 1; j < iter; j++) {
-            if (!HMAC_CTX_copy(&hctx, &hctx_tpl)) {
-                HMAC_CTX_cleanup(&hctx_tpl);
-                return 0;
-            }
-            if (!HMAC_Update(&hctx, digtmp, mdlen)
-                || !HMAC_Final(&hctx, digtmp, NULL)) {
-                HMAC_CTX_cleanup(&hctx_tpl);
-                HMAC_CTX_cleanup(&hctx);
-                return 0;
-            }
-            HMAC_CTX_cleanup(&hctx);
+            if (!HMAC_Init_ex(&hctx, NULL, 0, NULL, NULL)
+                || !HMAC_Update(&hctx, digtmp, mdlen)
+                || !HMAC_Final(&hctx, digtmp, NULL))
+                goto err;
             for (k = 0; k < cplen; k++)
                 p[k] ^= digtmp[k];
         }
@@ -147,7 +137,7 @@ int PKCS5_PBKDF2_HMAC(const char *pass, int passlen,
         i++;
         p += cplen;
     }
-    HMAC_CTX_cleanup(&hctx_tpl);
+    ret = 1;
 # ifdef DEBUG_PKCS5V2
     fprintf(stderr, "Password:\n");
     h__dump(pass, passlen);
@@ -157,7 +147,11 @@ int PKCS5_PBKDF2_HMAC(const char *pass, int passlen,
     fprintf(stderr, "Key:\n");
     h__dump(out, keylen);
 # endif
-    return 1;
+ err:
+    HMAC_CTX_cleanup(&hctx);
+    HMAC_KEY_cleanup(&hkey);
+    OPENSSL_cleanse(digtmp, sizeof(digtmp));
+    return ret;
 }
 
 int PKCS5_PBKDF2_HMAC_SHA1(const char *pass, int passlen,
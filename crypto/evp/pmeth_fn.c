@@ -114,6 +114,53 @@ int EVP_PKEY_sign(EVP_PKEY_CTX *ctx,
         return ctx->pmeth->sign(ctx, sig, siglen, tbs, tbslen);
 }
 
+int EVP_PKEY_sign_batch(EVP_PKEY_CTX **ctx,
+                        unsigned char **sig, size_t *siglen,
+                        const unsigned char **tbs, const size_t *tbslen,
+                        size_t num)
+{
+    const EVP_PKEY_METHOD *pmeth = NULL;
+    size_t i;
+    int ret = 1;
+
+    for (i = 0; i < num; i++) {
+        if (!ctx[i] || !ctx[i]->pmeth || !ctx[i]->pmeth->sign) {
+            EVPerr(EVP_F_EVP_PKEY_SIGN_BATCH,
+                   EVP_R_OPERATION_NOT_SUPPORTED_FOR_THIS_KEYTYPE);
+            return -2;
+        }
+        if (ctx[i]->operation != EVP_PKEY_OP_SIGN) {
+            EVPerr(EVP_F_EVP_PKEY_SIGN_BATCH, EVP_R_OPERATON_NOT_INITIALIZED);
+            return -1;
+        }
+        if (sig[i] == NULL) {
+            EVPerr(EVP_F_EVP_PKEY_SIGN_BATCH, ERR_R_PASSED_NULL_PARAMETER);
+            return -1;
+        }
+        if ((ctx[i]->pmeth->flags & EVP_PKEY_FLAG_AUTOARGLEN)
+            && siglen[i] < (size_t)EVP_PKEY_size(ctx[i]->pkey)) {
+            EVPerr(EVP_F_EVP_PKEY_SIGN_BATCH, EVP_R_BUFFER_TOO_SMALL);
+            return 0;
+        }
+        if (i == 0)
+            pmeth = ctx[i]->pmeth;
+        else if (pmeth != ctx[i]->pmeth)
+            pmeth = NULL;
+    }
+
+    if (pmeth != NULL && pmeth->sign_batch != NULL)
+        return pmeth->sign_batch(ctx, sig, siglen, tbs, tbslen, num);
+
+    for (i = 0; i < num; i++) {
+        if (ctx[i]->pmeth->sign(ctx[i], sig[i], &siglen[i], tbs[i],
+                                tbslen[i]) <= 0) {
+            siglen[i] = 0;
+            ret = 0;
+        }
+    }
+    return ret;
+}
+
 int EVP_PKEY_verify_init(EVP_PKEY_CTX *ctx)
 {
     int ret;
@@ -147,6 +194,44 @@ int EVP_PKEY_verify(EVP_PKEY_CTX *ctx,
     return ctx->pmeth->verify(ctx, sig, siglen, tbs, tbslen);
 }
 
+int EVP_PKEY_verify_batch(EVP_PKEY_CTX **ctx,
+                          const unsigned char **sig, const size_t *siglen,
+                          const unsigned char **tbs, const size_t *tbslen,
+                          size_t num, int *ret)
+{
+    const EVP_PKEY_METHOD *pmeth = NULL;
+    size_t i;
+    int all = 1;
+
+    for (i = 0; i < num; i++) {
+        if (!ctx[i] || !ctx[i]->pmeth || !ctx[i]->pmeth->verify) {
+            EVPerr(EVP_F_EVP_PKEY_VERIFY_BATCH,
+                   EVP_R_OPERATION_NOT_SUPPORTED_FOR_THIS_KEYTYPE);
+            return -2;
+        }
+        if (ctx[i]->operation != EVP_PKEY_OP_VERIFY) {
+            EVPerr(EVP_F_EVP_PKEY_VERIFY_BATCH,
+                   EVP_R_OPERATON_NOT_INITIALIZED);
+            return -1;
+        }
+        if (i == 0)
+            pmeth = ctx[i]->pmeth;
+        else if (pmeth != ctx[i]->pmeth)
+            pmeth = NULL;
+    }
+
+    if (pmeth != NULL && pmeth->verify_batch != NULL)
+        return pmeth->verify_batch(ctx, sig, siglen, tbs, tbslen, num, ret);
+
+    for (i = 0; i < num; i++) {
+        ret[i] = ctx[i]->pmeth->verify(ctx[i], sig[i], siglen[i], tbs[i],
+                                       tbslen[i]);
+        if (ret[i] != 1)
+            all = 0;
+    }
+    return all;
+}
+
 int EVP_PKEY_verify_recover_init(EVP_PKEY_CTX *ctx)
 {
     int ret;
@@ -70,6 +70,7 @@ typedef struct {
     const EVP_MD *md;           /* MD for HMAC use */
     ASN1_OCTET_STRING ktmp;     /* Temp storage for key */
     HMAC_CTX ctx;
+    HMAC_KEY hkey;              /* Pad states of the key for md */
 } HMAC_PKEY_CTX;
 
 static int pkey_hmac_init(EVP_PKEY_CTX *ctx)
@@ -84,6 +85,7 @@ static int pkey_hmac_init(EVP_PKEY_CTX *ctx)
     hctx->ktmp.flags = 0;
     hctx->ktmp.type = V_ASN1_OCTET_STRING;
     HMAC_CTX_init(&hctx->ctx);
+    HMAC_KEY_init(&hctx->hkey);
 
     ctx->data = hctx;
     ctx->keygen_info_count = 0;
@@ -114,6 +116,7 @@ static void pkey_hmac_cleanup(EVP_PKEY_CTX *ctx)
 {
     HMAC_PKEY_CTX *hctx = ctx->data;
     HMAC_CTX_cleanup(&hctx->ctx);
+    HMAC_KEY_cleanup(&hctx->hkey);
     if (hctx->ktmp.data) {
         if (hctx->ktmp.length)
             OPENSSL_cleanse(hctx->ktmp.data, hctx->ktmp.length);
@@ -191,9 +194,18 @@ static int pkey_hmac_ctrl(EVP_PKEY_CTX *ctx, int type, int p1, void *p2)
         break;
 
     case EVP_PKEY_CTRL_DIGESTINIT:
-        key = (ASN1_OCTET_STRING *)ctx->pkey->pkey.ptr;
-        if (!HMAC_Init_ex(&hctx->ctx, key->data, key->length, hctx->md,
-                          ctx->engine))
+        /*
+         * The key of a context never changes, so its pad states are only
+         * computed on the first initialisation, or when the digest changes,
+         * and later ones just copy them.
+         */
+        if (hctx->hkey.md == NULL || hctx->hkey.md != hctx->md) {
+            key = (ASN1_OCTET_STRING *)ctx->pkey->pkey.ptr;
+            if (!HMAC_KEY_set(&hctx->hkey, key->data, key->length, hctx->md,
+                              ctx->engine))
+                return 0;
+        }
+        if (!HMAC_Init_key(&hctx->ctx, &hctx->hkey))
             return 0;
         break;
 
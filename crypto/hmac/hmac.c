@@ -62,11 +62,84 @@
 #include "cryptlib.h"
 #include <openssl/hmac.h>
 
+/*
+ * Set |out| to the state of |in|. When |out| already holds a state of the
+ * same digest only the digest state itself is copied, which is all that a
+ * restart from a precomputed pad state needs; otherwise this is a full
+ * EVP_MD_CTX_copy_ex().
+ */
+static int hmac_md_reset(EVP_MD_CTX *out, const EVP_MD_CTX *in)
+{
+    if (out->digest == in->digest && out->engine == in->engine
+        && out->md_data != NULL && in->md_data != NULL
+        && in->digest->copy == NULL
+        && out->pctx == NULL && in->pctx == NULL) {
+        memcpy(out->md_data, in->md_data, in->digest->ctx_size);
+        out->update = in->update;
+        EVP_MD_CTX_clear_flags(out, EVP_MD_CTX_FLAG_CLEANED);
+        return 1;
+    }
+    return EVP_MD_CTX_copy_ex(out, in);
+}
+
+/*
+ * Store |key| in the HMAC_MAX_MD_CBLOCK bytes at |buf| as HMAC uses it:
+ * hashed with |md_ctx| if it is longer than a block, zero padded.
+ */
+static int hmac_set_key(unsigned char *buf, unsigned int *buf_len,
+                        EVP_MD_CTX *md_ctx, const void *key, int len,
+                        const EVP_MD *md, ENGINE *impl)
+{
+    int j = M_EVP_MD_block_size(md);
+
+    OPENSSL_assert(j <= HMAC_MAX_MD_CBLOCK);
+    if (j < len) {
+        if (!EVP_DigestInit_ex(md_ctx, md, impl)
+            || !EVP_DigestUpdate(md_ctx, key, len)
+            || !EVP_DigestFinal_ex(md_ctx, buf, buf_len))
+            return 0;
+    } else {
+        if (len < 0 || len > HMAC_MAX_MD_CBLOCK)
+            return 0;
+        memcpy(buf, key, len);
+        *buf_len = len;
+    }
+    if (*buf_len != HMAC_MAX_MD_CBLOCK)
+        memset(&buf[*buf_len], 0, HMAC_MAX_MD_CBLOCK - *buf_len);
+    return 1;
+}
+
+/* Hash the inner and outer padded |key| into |i_ctx| and |o_ctx| */
+static int hmac_set_pads(EVP_MD_CTX *i_ctx, EVP_MD_CTX *o_ctx,
+                         const unsigned char *key, const EVP_MD *md,
+                         ENGINE *impl)
+{
+    int i, ret = 0;
+    unsigned char pad[HMAC_MAX_MD_CBLOCK];
+
+    for (i = 0; i < HMAC_MAX_MD_CBLOCK; i++)
+        pad[i] = 0x36 ^ key[i];
+    if (!EVP_DigestInit_ex(i_ctx, md, impl))
+        goto err;
+    if (!EVP_DigestUpdate(i_ctx, pad, M_EVP_MD_block_size(md)))
+        goto err;
+
+    for (i = 0; i < HMAC_MAX_MD_CBLOCK; i++)
+        pad[i] = 0x5c ^ key[i];
+    if (!EVP_DigestInit_ex(o_ctx, md, impl))
+        goto err;
+    if (!EVP_DigestUpdate(o_ctx, pad, M_EVP_MD_block_size(md)))
+        goto err;
+    ret = 1;
+ err:
+    OPENSSL_cleanse(pad, sizeof(pad));
+    return ret;
+}
+
 int HMAC_Init_ex(HMAC_CTX *ctx, const void *key, int len,
                  const EVP_MD *md, ENGINE *impl)
 {
-    int i, j, reset = 0;
-    unsigned char pad[HMAC_MAX_MD_CBLOCK];
+    int reset = 0;
 
     if (md != NULL) {
         reset = 1;
@@ -82,44 +155,17 @@ int HMAC_Init_ex(HMAC_CTX *ctx, const void *key, int len,
 
     if (key != NULL) {
         reset = 1;
-        j = M_EVP_MD_block_size(md);
-        OPENSSL_assert(j <= (int)sizeof(ctx->key));
-        if (j < len) {
-            if (!EVP_DigestInit_ex(&ctx->md_ctx, md, impl))
-                goto err;
-            if (!EVP_DigestUpdate(&ctx->md_ctx, key, len))
-                goto err;
-            if (!EVP_DigestFinal_ex(&(ctx->md_ctx), ctx->key,
-                                    &ctx->key_length))
-                goto err;
-        } else {
-            if (len < 0 || len > (int)sizeof(ctx->key))
-                return 0;
-            memcpy(ctx->key, key, len);
-            ctx->key_length = len;
-        }
-        if (ctx->key_length != HMAC_MAX_MD_CBLOCK)
-            memset(&ctx->key[ctx->key_length], 0,
-                   HMAC_MAX_MD_CBLOCK - ctx->key_length);
+        if (!hmac_set_key(ctx->key, &ctx->key_length, &ctx->md_ctx,
+                          key, len, md, impl))
+            goto err;
         ctx->key_init = 1;
     }
 
     if (reset) {
-        for (i = 0; i < HMAC_MAX_MD_CBLOCK; i++)
-            pad[i] = 0x36 ^ ctx->key[i];
-        if (!EVP_DigestInit_ex(&ctx->i_ctx, md, impl))
-            goto err;
-        if (!EVP_DigestUpdate(&ctx->i_ctx, pad, M_EVP_MD_block_size(md)))
-            goto err;
-
-        for (i = 0; i < HMAC_MAX_MD_CBLOCK; i++)
-            pad[i] = 0x5c ^ ctx->key[i];
-        if (!EVP_DigestInit_ex(&ctx->o_ctx, md, impl))
-            goto err;
-        if (!EVP_DigestUpdate(&ctx->o_ctx, pad, M_EVP_MD_block_size(md)))
+        if (!hmac_set_pads(&ctx->i_ctx, &ctx->o_ctx, ctx->key, md, impl))
             goto err;
     }
-    if (!EVP_MD_CTX_copy_ex(&ctx->md_ctx, &ctx->i_ctx))
+    if (!hmac_md_reset(&ctx->md_ctx, &ctx->i_ctx))
         goto err;
     return 1;
  err:
@@ -152,7 +198,7 @@ int HMAC_Final(HMAC_CTX *ctx, unsigned char *md, unsigned int *len)
 
     if (!EVP_DigestFinal_ex(&ctx->md_ctx, buf, &i))
         goto err;
-    if (!EVP_MD_CTX_copy_ex(&ctx->md_ctx, &ctx->o_ctx))
+    if (!hmac_md_reset(&ctx->md_ctx, &ctx->o_ctx))
         goto err;
     if (!EVP_DigestUpdate(&ctx->md_ctx, buf, i))
         goto err;
@@ -168,6 +214,11 @@ void HMAC_CTX_init(HMAC_CTX *ctx)
     EVP_MD_CTX_init(&ctx->i_ctx);
     EVP_MD_CTX_init(&ctx->o_ctx);
     EVP_MD_CTX_init(&ctx->md_ctx);
+    /*
+     * Re-keying with the same digest keeps the implementation found when
+     * the context was first keyed, unless an ENGINE is given.
+     */
+    HMAC_CTX_set_flags(ctx, EVP_MD_CTX_FLAG_KEEP_IMPL);
     ctx->key_init = 0;
     ctx->md = NULL;
 }
@@ -228,3 +279,60 @@ void HMAC_CTX_set_flags(HMAC_CTX *ctx, unsigned long flags)
     M_EVP_MD_CTX_set_flags(&ctx->o_ctx, flags);
     M_EVP_MD_CTX_set_flags(&ctx->md_ctx, flags);
 }
+
+void HMAC_KEY_init(HMAC_KEY *hkey)
+{
+    EVP_MD_CTX_init(&hkey->i_ctx);
+    EVP_MD_CTX_init(&hkey->o_ctx);
+    EVP_MD_CTX_set_flags(&hkey->i_ctx, EVP_MD_CTX_FLAG_KEEP_IMPL);
+    EVP_MD_CTX_set_flags(&hkey->o_ctx, EVP_MD_CTX_FLAG_KEEP_IMPL);
+    hkey->md = NULL;
+    hkey->key_length = 0;
+}
+
+void HMAC_KEY_cleanup(HMAC_KEY *hkey)
+{
+    EVP_MD_CTX_cleanup(&hkey->i_ctx);
+    EVP_MD_CTX_cleanup(&hkey->o_ctx);
+    OPENSSL_cleanse(hkey, sizeof(*hkey));
+}
+
+/*
+ * Precompute the pad states of |key| for |md|. As with HMAC_Init_ex() a
+ * NULL |md| keeps the digest and a NULL |key| the key already set.
+ */
+int HMAC_KEY_set(HMAC_KEY *hkey, const void *key, int len,
+                 const EVP_MD *md, ENGINE *impl)
+{
+    if (md == NULL)
+        md = hkey->md;
+    if (md == NULL || (key == NULL && hkey->md == NULL))
+        return 0;
+    hkey->md = NULL;
+    if (key != NULL && !hmac_set_key(hkey->key, &hkey->key_length,
+                                     &hkey->o_ctx, key, len, md, impl))
+        return 0;
+    if (!hmac_set_pads(&hkey->i_ctx, &hkey->o_ctx, hkey->key, md, impl))
+        return 0;
+    hkey->md = md;
+    return 1;
+}
+
+/*
+ * Start an HMAC computation in |ctx| with the key states in |hkey|. When
+ * |ctx| was last used with the same digest this only copies the states.
+ */
+int HMAC_Init_key(HMAC_CTX *ctx, const HMAC_KEY *hkey)
+{
+    if (hkey->md == NULL)
+        return 0;
+    if (!hmac_md_reset(&ctx->i_ctx, &hkey->i_ctx)
+        || !hmac_md_reset(&ctx->o_ctx, &hkey->o_ctx)
+        || !hmac_md_reset(&ctx->md_ctx, &hkey->i_ctx))
+        return 0;
+    ctx->md = hkey->md;
+    memcpy(ctx->key, hkey->key, HMAC_MAX_MD_CBLOCK);
+    ctx->key_length = hkey->key_length;
+    ctx->key_init = 1;
+    return 1;
+}
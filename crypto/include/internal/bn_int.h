@@ -115,6 +115,49 @@ size_t bn_sizeof_BIGNUM(void);
  */
 BIGNUM *bn_array_el(BIGNUM *base, int el);
 
+/*
+ * Montgomery multiplication of fixed-width word arrays, for moduli of up to
+ * BN_MONT_FIXED_MAX_WORDS words. See bn_mont.c.
+ */
+# define BN_MONT_FIXED_MAX_WORDS (512 / BN_BITS2)
+int bn_mul_mont_fixed(BN_ULONG *r, const BN_ULONG *a, const BN_ULONG *b,
+                      const BN_MONT_CTX *mont, int num);
+
+/*
+ * Constant-time, allocation-free modular inversion for odd moduli of up to
+ * BN_MOD_INVERSE_FIXED_MAX_BITS bits. See bn_divstep.c.
+ */
+# define BN_MOD_INVERSE_FIXED_MAX_BITS 1024
+int bn_mod_inverse_words(BN_ULONG *r, const BN_ULONG *a, const BN_ULONG *m,
+                         int num);
+int bn_mod_inverse_fixed(BIGNUM *r, const BIGNUM *a, const BIGNUM *m);
+
+/*
+ * Compute rr[i] = a[i]^p[i] mod m[i] for i = 0..num-1 in constant time,
+ * running independent operations side by side where possible. Entries of
+ * mont may be NULL.
+ */
+int bn_mod_exp_mont_consttime_batch(BIGNUM *rr[], const BIGNUM *a[],
+                                    const BIGNUM *p[], const BIGNUM *m[],
+                                    BN_MONT_CTX *mont[], int num, BN_CTX *ctx);
+
+/*
+ * Parallel search, see bn_search.c. bn_search_run() calls |fn| on up to
+ * |threads| threads, the calling thread being worker 0. Workers take
+ * candidates with bn_search_next() until it returns 0 and report hits with
+ * bn_search_found(), which returns 1 if the hit is the best so far; |fn|
+ * must pass |cb| to everything that calls a BN_GENCB, and return 0 on error.
+ * bn_search_run() returns the lowest candidate reported and sets |*winner| to
+ * the worker that found it, -1 if there was none and -2 on error or if the
+ * caller's callback |cb| aborted the search.
+ */
+typedef struct bn_search_st BN_SEARCH;
+typedef int (*bn_search_fn) (BN_SEARCH *s, int worker, BN_GENCB *cb,
+                             void *arg);
+long bn_search_run(int threads, bn_search_fn fn, void *arg, BN_GENCB *cb,
+                   int *winner);
+int bn_search_next(BN_SEARCH *s, int worker, long *idx);
+int bn_search_found(BN_SEARCH *s, int worker, long idx);
 
 #ifdef  __cplusplus
 }
@@ -118,6 +118,17 @@ struct evp_pkey_method_st {
     int (*derive) (EVP_PKEY_CTX *ctx, unsigned char *key, size_t *keylen);
     int (*ctrl) (EVP_PKEY_CTX *ctx, int type, int p1, void *p2);
     int (*ctrl_str) (EVP_PKEY_CTX *ctx, const char *type, const char *value);
+    int (*sign_batch) (EVP_PKEY_CTX **ctx, unsigned char **sig,
+                       size_t *siglen, const unsigned char **tbs,
+                       const size_t *tbslen, size_t num);
+    int (*digestsign) (EVP_MD_CTX *ctx, unsigned char *sig, size_t *siglen,
+                       const unsigned char *tbs, size_t tbslen);
+    int (*digestverify) (EVP_MD_CTX *ctx, const unsigned char *sig,
+                         size_t siglen, const unsigned char *tbs,
+                         size_t tbslen);
+    int (*verify_batch) (EVP_PKEY_CTX **ctx, const unsigned char **sig,
+                         const size_t *siglen, const unsigned char **tbs,
+                         const size_t *tbslen, size_t num, int *ret);
 } /* EVP_PKEY_METHOD */ ;
 
 void evp_pkey_set_cb_translate(BN_GENCB *cb, EVP_PKEY_CTX *ctx);
@@ -165,6 +165,8 @@ struct ocb128_context {
     block128_f decrypt;
     void *keyenc;
     void *keydec;
+    /* Optional: encrypts or decrypts many blocks, see ocb128_f */
+    ocb128_f stream;
     /* Key dependent variables. Can be reused if key remains the same */
     size_t l_index;
     size_t max_l_index;
@@ -62,12 +62,12 @@
  * [including the GNU Public Licence.]
  */
 
-#define NUM_NID 973
-#define NUM_SN 967
-#define NUM_LN 967
-#define NUM_OBJ 903
+#define NUM_NID 977
+#define NUM_SN 971
+#define NUM_LN 971
+#define NUM_OBJ 905
 
-static const unsigned char lvalues[6361]={
+static const unsigned char lvalues[6367]={
 0x2A,0x86,0x48,0x86,0xF7,0x0D,               /* [  0] OBJ_rsadsi */
 0x2A,0x86,0x48,0x86,0xF7,0x0D,0x01,          /* [  6] OBJ_pkcs */
 0x2A,0x86,0x48,0x86,0xF7,0x0D,0x02,0x02,     /* [ 13] OBJ_md2 */
@@ -965,6 +965,8 @@ static const unsigned char lvalues[6361]={
 0x03,0xA2,0x31,0x05,0x03,0x01,0x09,0x2F,     /* [6336] OBJ_camellia_256_ccm */
 0x03,0xA2,0x31,0x05,0x03,0x01,0x09,0x31,     /* [6344] OBJ_camellia_256_ctr */
 0x03,0xA2,0x31,0x05,0x03,0x01,0x09,0x32,     /* [6352] OBJ_camellia_256_cmac */
+0x2B,0x65,0x6E,                              /* [6360] OBJ_X25519 */
+0x2B,0x65,0x70,                              /* [6363] OBJ_ED25519 */
 };
 
 static const ASN1_OBJECT nid_objs[NUM_NID]={
@@ -2554,6 +2556,10 @@ static const ASN1_OBJECT nid_objs[NUM_NID]={
 	&(lvalues[6344]),0},
 {"CAMELLIA-256-CMAC","camellia-256-cmac",NID_camellia_256_cmac,8,
 	&(lvalues[6352]),0},
+{"ChaCha20-Poly1305","chacha20-poly1305",NID_chacha20_poly1305,0,NULL,0},
+{"ChaCha20","chacha20",NID_chacha20,0,NULL,0},
+{"X25519","X25519",NID_X25519,3,&(lvalues[6360]),0},
+{"ED25519","ED25519",NID_ED25519,3,&(lvalues[6363]),0},
 };
 
 static const unsigned int sn_objs[NUM_SN]={
@@ -2633,6 +2639,8 @@ static const unsigned int sn_objs[NUM_SN]={
 13,	/* "CN" */
 141,	/* "CRLReason" */
 417,	/* "CSPName" */
+974,	/* "ChaCha20" */
+973,	/* "ChaCha20-Poly1305" */
 367,	/* "CrlID" */
 391,	/* "DC" */
 31,	/* "DES-CBC" */
@@ -2660,6 +2668,7 @@ static const unsigned int sn_objs[NUM_SN]={
 70,	/* "DSA-SHA1-old" */
 67,	/* "DSA-old" */
 297,	/* "DVCS" */
+976,	/* "ED25519" */
 99,	/* "GN" */
 855,	/* "HMAC" */
 780,	/* "HMAC-MD5" */
@@ -2759,6 +2768,7 @@ static const unsigned int sn_objs[NUM_SN]={
 143,	/* "SXNetID" */
 458,	/* "UID" */
  0,	/* "UNDEF" */
+975,	/* "X25519" */
 11,	/* "X500" */
 378,	/* "X500algorithms" */
 12,	/* "X509" */
@@ -3546,6 +3556,7 @@ static const unsigned int ln_objs[NUM_LN]={
 382,	/* "Directory" */
 392,	/* "Domain" */
 132,	/* "E-mail Protection" */
+976,	/* "ED25519" */
 389,	/* "Enterprises" */
 384,	/* "Experimental" */
 372,	/* "Extended OCSP Status" */
@@ -3639,6 +3650,7 @@ static const unsigned int ln_objs[NUM_LN]={
 129,	/* "TLS Web Server Authentication" */
 133,	/* "Time Stamping" */
 375,	/* "Trust Root" */
+975,	/* "X25519" */
 12,	/* "X509" */
 402,	/* "X509v3 AC Targeting" */
 746,	/* "X509v3 Any Policy" */
@@ -3799,6 +3811,8 @@ static const unsigned int ln_objs[NUM_LN]={
 677,	/* "certicom-arc" */
 517,	/* "certificate extensions" */
 883,	/* "certificateRevocationList" */
+974,	/* "chacha20" */
+973,	/* "chacha20-poly1305" */
 54,	/* "challengePassword" */
 407,	/* "characteristic-two-field" */
 395,	/* "clearance" */
@@ -4518,6 +4532,8 @@ static const unsigned int obj_objs[NUM_OBJ]={
 435,	/* OBJ_pss                          0 9 2342 */
 183,	/* OBJ_ISO_US                       1 2 840 */
 381,	/* OBJ_iana                         1 3 6 1 */
+975,	/* OBJ_X25519                       1 3 101 110 */
+976,	/* OBJ_ED25519                      1 3 101 112 */
 677,	/* OBJ_certicom_arc                 1 3 132 */
 394,	/* OBJ_selected_attribute_types     2 5 1 5 */
 13,	/* OBJ_commonName                   2 5 4 3 */
@@ -0,0 +1,447 @@
+/* crypto/poly1305/poly1305.c */
+/* ====================================================================
+ * Copyright (c) 2015 The OpenSSL Project.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. All advertising materials mentioning features or use of this
+ *    software must display the following acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit. (http://www.openssl.org/)"
+ *
+ * 4. The names "OpenSSL Toolkit" and "OpenSSL Project" must not be used to
+ *    endorse or promote products derived from this software without
+ *    prior written permission. For written permission, please contact
+ *    openssl-core@openssl.org.
+ *
+ * 5. Products derived from this software may not be called "OpenSSL"
+ *    nor may "OpenSSL" appear in their names without prior written
+ *    permission of the OpenSSL Project.
+ *
+ * 6. Redistributions of any form whatsoever must retain the following
+ *    acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit (http://www.openssl.org/)"
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE OpenSSL PROJECT ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE OpenSSL PROJECT OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ====================================================================
+ */
+
+/*
+ * Poly1305 in the style of A. Moon's poly1305-donna: h and r are kept in
+ * three 44-bit limbs when the compiler offers a 128-bit type to hold
+ * their products, and in five 26-bit limbs otherwise. The reduction
+ * modulo 2^130 - 5 is only partial between blocks; h is brought into
+ * canonical form once, in Poly1305_Final.
+ */
+
+#include <string.h>
+
+#include <openssl/crypto.h>
+#include "internal/poly1305.h"
+
+typedef unsigned char u8;
+typedef unsigned int u32;
+typedef unsigned long long u64;
+
+static u32 U8TOU32(const u8 *p)
+{
+    return ((u32)p[0] | ((u32)p[1] << 8) |
+            ((u32)p[2] << 16) | ((u32)p[3] << 24));
+}
+
+static void U32TO8(u8 *p, u32 v)
+{
+    p[0] = (u8)(v);
+    p[1] = (u8)(v >> 8);
+    p[2] = (u8)(v >> 16);
+    p[3] = (u8)(v >> 24);
+}
+
+#if defined(__SIZEOF_INT128__) && __SIZEOF_INT128__==16
+
+typedef unsigned __int128 u128;
+
+typedef struct {
+    u64 h[3];
+    u64 r[3];
+} poly1305_internal;
+
+# define MASK44  0xfffffffffffULL
+# define MASK42  0x3ffffffffffULL
+
+static u64 U8TOU64(const u8 *p)
+{
+    return (u64)U8TOU32(p) | ((u64)U8TOU32(p + 4) << 32);
+}
+
+static void U64TO8(u8 *p, u64 v)
+{
+    U32TO8(p, (u32)v);
+    U32TO8(p + 4, (u32)(v >> 32));
+}
+
+static void poly1305_init(poly1305_internal *st, const u8 key[16])
+{
+    u64 t0 = U8TOU64(key), t1 = U8TOU64(key + 8);
+
+    st->h[0] = st->h[1] = st->h[2] = 0;
+
+    /* r &= 0xffffffc0ffffffc0ffffffc0fffffff */
+    st->r[0] = t0 & 0xffc0fffffffULL;
+    st->r[1] = ((t0 >> 44) | (t1 << 20)) & 0xfffffc0ffffULL;
+    st->r[2] = (t1 >> 24) & 0x00ffffffc0fULL;
+}
+
+static void poly1305_blocks(poly1305_internal *st, const u8 *inp, size_t len,
+                            u64 padbit)
+{
+    const u64 hibit = padbit << 40;
+    u64 r0 = st->r[0], r1 = st->r[1], r2 = st->r[2];
+    u64 s1 = r1 * (5 << 2), s2 = r2 * (5 << 2);
+    u64 h0 = st->h[0], h1 = st->h[1], h2 = st->h[2];
+    u64 t0, t1, c;
+    u128 d0, d1, d2;
+
+    while (len >= POLY1305_BLOCK_SIZE) {
+        t0 = U8TOU64(inp);
+        t1 = U8TOU64(inp + 8);
+
+        /* h += m[i] */
+        h0 += t0 & MASK44;
+        h1 += ((t0 >> 44) | (t1 << 20)) & MASK44;
+        h2 += ((t1 >> 24) & MASK42) | hibit;
+
+        /* h *= r, the factor 4 in s1 and s2 accounts for 2^132 vs 2^130 */
+        d0 = (u128)h0 * r0 + (u128)h1 * s2 + (u128)h2 * s1;
+        d1 = (u128)h0 * r1 + (u128)h1 * r0 + (u128)h2 * s2;
+        d2 = (u128)h0 * r2 + (u128)h1 * r1 + (u128)h2 * r0;
+
+        /* (partial) h %= p */
+        c = (u64)(d0 >> 44);
+        h0 = (u64)d0 & MASK44;
+        d1 += c;
+        c = (u64)(d1 >> 44);
+        h1 = (u64)d1 & MASK44;
+        d2 += c;
+        c = (u64)(d2 >> 42);
+        h2 = (u64)d2 & MASK42;
+        h0 += c * 5;
+        c = h0 >> 44;
+        h0 &= MASK44;
+        h1 += c;
+
+        inp += POLY1305_BLOCK_SIZE;
+        len -= POLY1305_BLOCK_SIZE;
+    }
+
+    st->h[0] = h0;
+    st->h[1] = h1;
+    st->h[2] = h2;
+}
+
+static void poly1305_emit(poly1305_internal *st, u8 mac[16],
+                          const u32 nonce[4])
+{
+    u64 h0 = st->h[0], h1 = st->h[1], h2 = st->h[2];
+    u64 g0, g1, g2, c, mask, t0, t1;
+
+    /* fully carry h */
+    c = h1 >> 44;
+    h1 &= MASK44;
+    h2 += c;
+    c = h2 >> 42;
+    h2 &= MASK42;
+    h0 += c * 5;
+    c = h0 >> 44;
+    h0 &= MASK44;
+    h1 += c;
+    c = h1 >> 44;
+    h1 &= MASK44;
+    h2 += c;
+    c = h2 >> 42;
+    h2 &= MASK42;
+    h0 += c * 5;
+    c = h0 >> 44;
+    h0 &= MASK44;
+    h1 += c;
+
+    /* compute h - p = h + 5 - 2^130 */
+    g0 = h0 + 5;
+    c = g0 >> 44;
+    g0 &= MASK44;
+    g1 = h1 + c;
+    c = g1 >> 44;
+    g1 &= MASK44;
+    g2 = h2 + c - ((u64)1 << 42);
+
+    /* select h if h < p, or h - p if h >= p, without branching */
+    mask = (g2 >> 63) - 1;
+    g0 &= mask;
+    g1 &= mask;
+    g2 &= mask;
+    mask = ~mask;
+    h0 = (h0 & mask) | g0;
+    h1 = (h1 & mask) | g1;
+    h2 = (h2 & mask) | g2;
+
+    /* mac = (h + nonce) % 2^128 */
+    t0 = (u64)nonce[0] | ((u64)nonce[1] << 32);
+    t1 = (u64)nonce[2] | ((u64)nonce[3] << 32);
+
+    h0 += t0 & MASK44;
+    c = h0 >> 44;
+    h0 &= MASK44;
+    h1 += (((t0 >> 44) | (t1 << 20)) & MASK44) + c;
+    c = h1 >> 44;
+    h1 &= MASK44;
+    h2 += ((t1 >> 24) & MASK42) + c;
+    h2 &= MASK42;
+
+    U64TO8(mac, h0 | (h1 << 44));
+    U64TO8(mac + 8, (h1 >> 20) | (h2 << 24));
+}
+
+#else
+
+typedef struct {
+    u32 h[5];
+    u32 r[5];
+} poly1305_internal;
+
+# define MASK26  0x3ffffff
+
+static void poly1305_init(poly1305_internal *st, const u8 key[16])
+{
+    st->h[0] = st->h[1] = st->h[2] = st->h[3] = st->h[4] = 0;
+
+    /* r &= 0xffffffc0ffffffc0ffffffc0fffffff */
+    st->r[0] = U8TOU32(key) & 0x3ffffff;
+    st->r[1] = (U8TOU32(key + 3) >> 2) & 0x3ffff03;
+    st->r[2] = (U8TOU32(key + 6) >> 4) & 0x3ffc0ff;
+    st->r[3] = (U8TOU32(key + 9) >> 6) & 0x3f03fff;
+    st->r[4] = (U8TOU32(key + 12) >> 8) & 0x00fffff;
+}
+
+static void poly1305_blocks(poly1305_internal *st, const u8 *inp, size_t len,
+                            u32 padbit)
+{
+    const u32 hibit = padbit << 24;
+    u32 r0 = st->r[0], r1 = st->r[1], r2 = st->r[2], r3 = st->r[3];
+    u32 r4 = st->r[4];
+    u32 s1 = r1 * 5, s2 = r2 * 5, s3 = r3 * 5, s4 = r4 * 5;
+    u32 h0 = st->h[0], h1 = st->h[1], h2 = st->h[2], h3 = st->h[3];
+    u32 h4 = st->h[4];
+    u32 c;
+    u64 d0, d1, d2, d3, d4;
+
+    while (len >= POLY1305_BLOCK_SIZE) {
+        /* h += m[i] */
+        h0 += U8TOU32(inp) & MASK26;
+        h1 += (U8TOU32(inp + 3) >> 2) & MASK26;
+        h2 += (U8TOU32(inp + 6) >> 4) & MASK26;
+        h3 += (U8TOU32(inp + 9) >> 6) & MASK26;
+        h4 += (U8TOU32(inp + 12) >> 8) | hibit;
+
+        /* h *= r */
+        d0 = (u64)h0 * r0 + (u64)h1 * s4 + (u64)h2 * s3 +
+             (u64)h3 * s2 + (u64)h4 * s1;
+        d1 = (u64)h0 * r1 + (u64)h1 * r0 + (u64)h2 * s4 +
+             (u64)h3 * s3 + (u64)h4 * s2;
+        d2 = (u64)h0 * r2 + (u64)h1 * r1 + (u64)h2 * r0 +
+             (u64)h3 * s4 + (u64)h4 * s3;
+        d3 = (u64)h0 * r3 + (u64)h1 * r2 + (u64)h2 * r1 +
+             (u64)h3 * r0 + (u64)h4 * s4;
+        d4 = (u64)h0 * r4 + (u64)h1 * r3 + (u64)h2 * r2 +
+             (u64)h3 * r1 + (u64)h4 * r0;
+
+        /* (partial) h %= p */
+        c = (u32)(d0 >> 26);
+        h0 = (u32)d0 & MASK26;
+        d1 += c;
+        c = (u32)(d1 >> 26);
+        h1 = (u32)d1 & MASK26;
+        d2 += c;
+        c = (u32)(d2 >> 26);
+        h2 = (u32)d2 & MASK26;
+        d3 += c;
+        c = (u32)(d3 >> 26);
+        h3 = (u32)d3 & MASK26;
+        d4 += c;
+        c = (u32)(d4 >> 26);
+        h4 = (u32)d4 & MASK26;
+        h0 += c * 5;
+        c = h0 >> 26;
+        h0 &= MASK26;
+        h1 += c;
+
+        inp += POLY1305_BLOCK_SIZE;
+        len -= POLY1305_BLOCK_SIZE;
+    }
+
+    st->h[0] = h0;
+    st->h[1] = h1;
+    st->h[2] = h2;
+    st->h[3] = h3;
+    st->h[4] = h4;
+}
+
+static void poly1305_emit(poly1305_internal *st, u8 mac[16],
+                          const u32 nonce[4])
+{
+    u32 h0 = st->h[0], h1 = st->h[1], h2 = st->h[2], h3 = st->h[3];
+    u32 h4 = st->h[4];
+    u32 g0, g1, g2, g3, g4, c, mask;
+    u64 f;
+
+    /* fully carry h */
+    c = h1 >> 26;
+    h1 &= MASK26;
+    h2 += c;
+    c = h2 >> 26;
+    h2 &= MASK26;
+    h3 += c;
+    c = h3 >> 26;
+    h3 &= MASK26;
+    h4 += c;
+    c = h4 >> 26;
+    h4 &= MASK26;
+    h0 += c * 5;
+    c = h0 >> 26;
+    h0 &= MASK26;
+    h1 += c;
+
+    /* compute h - p = h + 5 - 2^130 */
+    g0 = h0 + 5;
+    c = g0 >> 26;
+    g0 &= MASK26;
+    g1 = h1 + c;
+    c = g1 >> 26;
+    g1 &= MASK26;
+    g2 = h2 + c;
+    c = g2 >> 26;
+    g2 &= MASK26;
+    g3 = h3 + c;
+    c = g3 >> 26;
+    g3 &= MASK26;
+    g4 = h4 + c - (1 << 26);
+
+    /* select h if h < p, or h - p if h >= p, without branching */
+    mask = (g4 >> 31) - 1;
+    g0 &= mask;
+    g1 &= mask;
+    g2 &= mask;
+    g3 &= mask;
+    g4 &= mask;
+    mask = ~mask;
+    h0 = (h0 & mask) | g0;
+    h1 = (h1 & mask) | g1;
+    h2 = (h2 & mask) | g2;
+    h3 = (h3 & mask) | g3;
+    h4 = (h4 & mask) | g4;
+
+    /* h %= 2^128 */
+    h0 = h0 | (h1 << 26);
+    h1 = (h1 >> 6) | (h2 << 20);
+    h2 = (h2 >> 12) | (h3 << 14);
+    h3 = (h3 >> 18) | (h4 << 8);
+
+    /* mac = (h + nonce) % 2^128 */
+    f = (u64)h0 + nonce[0];
+    U32TO8(mac, (u32)f);
+    f = (u64)h1 + nonce[1] + (f >> 32);
+    U32TO8(mac + 4, (u32)f);
+    f = (u64)h2 + nonce[2] + (f >> 32);
+    U32TO8(mac + 8, (u32)f);
+    f = (u64)h3 + nonce[3] + (f >> 32);
+    U32TO8(mac + 12, (u32)f);
+}
+
+#endif
+
+void Poly1305_Init(POLY1305 *ctx, const unsigned char key[32])
+{
+    /* the opaque area is large enough for either layout */
+    poly1305_init((poly1305_internal *)ctx->opaque, key);
+
+    ctx->nonce[0] = U8TOU32(&key[16]);
+    ctx->nonce[1] = U8TOU32(&key[20]);
+    ctx->nonce[2] = U8TOU32(&key[24]);
+    ctx->nonce[3] = U8TOU32(&key[28]);
+
+    ctx->num = 0;
+}
+
+void Poly1305_Update(POLY1305 *ctx, const unsigned char *inp, size_t len)
+{
+    poly1305_internal *st = (poly1305_internal *)ctx->opaque;
+    size_t rem, num;
+
+    if ((num = ctx->num)) {
+        rem = POLY1305_BLOCK_SIZE - num;
+        if (len >= rem) {
+            memcpy(ctx->data + num, inp, rem);
+            poly1305_blocks(st, ctx->data, POLY1305_BLOCK_SIZE, 1);
+            inp += rem;
+            len -= rem;
+        } else {
+            /* still not enough data to process a block */
+            memcpy(ctx->data + num, inp, len);
+            ctx->num = num + len;
+            return;
+        }
+    }
+
+    rem = len % POLY1305_BLOCK_SIZE;
+    len -= rem;
+
+    if (len >= POLY1305_BLOCK_SIZE) {
+        poly1305_blocks(st, inp, len, 1);
+        inp += len;
+    }
+
+    if (rem)
+        memcpy(ctx->data, inp, rem);
+
+    ctx->num = rem;
+}
+
+void Poly1305_Final(POLY1305 *ctx, unsigned char mac[16])
+{
+    poly1305_internal *st = (poly1305_internal *)ctx->opaque;
+    size_t num;
+
+    if ((num = ctx->num)) {
+        /* the final partial block is padded with 1 and zeros */
+        ctx->data[num++] = 1;
+        while (num < POLY1305_BLOCK_SIZE)
+            ctx->data[num++] = 0;
+        poly1305_blocks(st, ctx->data, POLY1305_BLOCK_SIZE, 0);
+    }
+
+    poly1305_emit(st, mac, ctx->nonce);
+
+    /* zero out the state */
+    OPENSSL_cleanse(ctx, sizeof(*ctx));
+}
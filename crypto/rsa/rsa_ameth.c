@@ -191,7 +191,8 @@ static int do_rsa_print(BIO *bp, const RSA *x, int off, int priv)
     char *str;
     const char *s;
     unsigned char *m = NULL;
-    int ret = 0, mod_len = 0;
+    RSA_PRIME_INFO *pinfo;
+    int ret = 0, mod_len = 0, i, extra = RSA_get_multi_prime_extra_count(x);
     size_t buf_len = 0;
 
     update_buflen(x->n, &buf_len);
@@ -204,6 +205,12 @@ static int do_rsa_print(BIO *bp, const RSA *x, int off, int priv)
         update_buflen(x->dmp1, &buf_len);
         update_buflen(x->dmq1, &buf_len);
         update_buflen(x->iqmp, &buf_len);
+        for (i = 0; i < extra; i++) {
+            pinfo = sk_RSA_PRIME_INFO_value(x->prime_infos, i);
+            update_buflen(pinfo->r, &buf_len);
+            update_buflen(pinfo->d, &buf_len);
+            update_buflen(pinfo->t, &buf_len);
+        }
     }
 
     m = (unsigned char *)OPENSSL_malloc(buf_len + 10);
@@ -248,6 +255,20 @@ static int do_rsa_print(BIO *bp, const RSA *x, int off, int priv)
             goto err;
         if (!ASN1_bn_print(bp, "coefficient:", x->iqmp, m, off))
             goto err;
+        for (i = 0; i < extra; i++) {
+            char name[32];
+
+            pinfo = sk_RSA_PRIME_INFO_value(x->prime_infos, i);
+            BIO_snprintf(name, sizeof(name), "prime%d:", i + 3);
+            if (!ASN1_bn_print(bp, name, pinfo->r, m, off))
+                goto err;
+            BIO_snprintf(name, sizeof(name), "exponent%d:", i + 3);
+            if (!ASN1_bn_print(bp, name, pinfo->d, m, off))
+                goto err;
+            BIO_snprintf(name, sizeof(name), "coefficient%d:", i + 3);
+            if (!ASN1_bn_print(bp, name, pinfo->t, m, off))
+                goto err;
+        }
     }
     ret = 1;
  err:
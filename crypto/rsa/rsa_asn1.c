@@ -77,10 +77,49 @@ static int rsa_cb(int operation, ASN1_VALUE **pval, const ASN1_ITEM *it,
         RSA_free((RSA *)*pval);
         *pval = NULL;
         return 2;
+    } else if (operation == ASN1_OP_D2I_POST) {
+        RSA *rsa = (RSA *)*pval;
+        int extra = RSA_get_multi_prime_extra_count(rsa);
+
+        /* Version 1 keys, and only those, have the otherPrimeInfos */
+        if (rsa->version == RSA_ASN1_VERSION_MULTI) {
+            if (extra <= 0 || extra > RSA_MAX_PRIME_NUM - 2)
+                return 0;
+        } else if (rsa->prime_infos != NULL) {
+            return 0;
+        }
+        /*
+         * Keep the set up out of the first operation with a private key.
+         * Public keys, e.g. of every certificate, are left to set up lazily.
+         */
+        if (rsa->d == NULL)
+            return 1;
+        return RSA_precompute(rsa, NULL);
     }
     return 1;
 }
 
+/* Free the cached montgomery value along with the prime */
+static int rsa_prime_info_cb(int operation, ASN1_VALUE **pval,
+                             const ASN1_ITEM *it, void *exarg)
+{
+    if (operation == ASN1_OP_FREE_PRE) {
+        RSA_PRIME_INFO *pinfo = (RSA_PRIME_INFO *)*pval;
+
+        if (pinfo->m != NULL)
+            BN_MONT_CTX_free(pinfo->m);
+    }
+    return 1;
+}
+
+ASN1_SEQUENCE_cb(RSA_PRIME_INFO, rsa_prime_info_cb) = {
+        ASN1_SIMPLE(RSA_PRIME_INFO, r, CBIGNUM),
+        ASN1_SIMPLE(RSA_PRIME_INFO, d, CBIGNUM),
+        ASN1_SIMPLE(RSA_PRIME_INFO, t, CBIGNUM),
+} ASN1_SEQUENCE_END_cb(RSA_PRIME_INFO, RSA_PRIME_INFO)
+
+IMPLEMENT_ASN1_ALLOC_FUNCTIONS(RSA_PRIME_INFO)
+
 ASN1_SEQUENCE_cb(RSAPrivateKey, rsa_cb) = {
         ASN1_SIMPLE(RSA, version, LONG),
         ASN1_SIMPLE(RSA, n, BIGNUM),
@@ -90,7 +129,8 @@ ASN1_SEQUENCE_cb(RSAPrivateKey, rsa_cb) = {
         ASN1_SIMPLE(RSA, q, BIGNUM),
         ASN1_SIMPLE(RSA, dmp1, BIGNUM),
         ASN1_SIMPLE(RSA, dmq1, BIGNUM),
-        ASN1_SIMPLE(RSA, iqmp, BIGNUM)
+        ASN1_SIMPLE(RSA, iqmp, BIGNUM),
+        ASN1_SEQUENCE_OF_OPT(RSA, prime_infos, RSA_PRIME_INFO)
 } ASN1_SEQUENCE_END_cb(RSA, RSAPrivateKey)
 
 
@@ -61,7 +61,8 @@ int RSA_check_key_ex(const RSA *key, BN_GENCB *cb)
 {
     BIGNUM *i, *j, *k, *l, *m;
     BN_CTX *ctx;
-    int r;
+    RSA_PRIME_INFO *pinfo;
+    int r, idx, extra = RSA_get_multi_prime_extra_count(key);
     int ret = 1;
 
     if (!key->p || !key->q || !key->n || !key->e || !key->d) {
@@ -100,16 +101,37 @@ int RSA_check_key_ex(const RSA *key, BN_GENCB *cb)
         RSAerr(RSA_F_RSA_CHECK_KEY_EX, RSA_R_Q_NOT_PRIME);
     }
 
-    /* n = p*q? */
+    /* r_i prime? */
+    for (idx = 0; idx < extra; idx++) {
+        pinfo = sk_RSA_PRIME_INFO_value(key->prime_infos, idx);
+        r = BN_is_prime_ex(pinfo->r, BN_prime_checks, NULL, cb);
+        if (r != 1) {
+            ret = r;
+            if (r != 0)
+                goto err;
+            RSAerr(RSA_F_RSA_CHECK_KEY_EX, RSA_R_MP_R_NOT_PRIME);
+        }
+    }
+
+    /* n = p*q*r_3*...? */
     r = BN_mul(i, key->p, key->q, ctx);
     if (!r) {
         ret = -1;
         goto err;
     }
+    for (idx = 0; idx < extra; idx++) {
+        pinfo = sk_RSA_PRIME_INFO_value(key->prime_infos, idx);
+        if (!BN_mul(i, i, pinfo->r, ctx)) {
+            ret = -1;
+            goto err;
+        }
+    }
 
     if (BN_cmp(i, key->n) != 0) {
         ret = 0;
-        RSAerr(RSA_F_RSA_CHECK_KEY_EX, RSA_R_N_DOES_NOT_EQUAL_P_Q);
+        RSAerr(RSA_F_RSA_CHECK_KEY_EX,
+               extra > 0 ? RSA_R_N_DOES_NOT_EQUAL_PRODUCT_OF_PRIMES
+               : RSA_R_N_DOES_NOT_EQUAL_P_Q);
     }
 
     /* d*e = 1  mod lcm(p-1,q-1)? */
@@ -142,6 +164,18 @@ int RSA_check_key_ex(const RSA *key, BN_GENCB *cb)
         goto err;
     }
 
+    /* and k = lcm(k, r_i - 1) for the additional primes */
+    for (idx = 0; idx < extra; idx++) {
+        pinfo = sk_RSA_PRIME_INFO_value(key->prime_infos, idx);
+        if (!BN_sub(i, pinfo->r, BN_value_one())
+            || !BN_mul(l, k, i, ctx)
+            || !BN_gcd(m, k, i, ctx)
+            || !BN_div(k, NULL, l, m, ctx)) {
+            ret = -1;
+            goto err;
+        }
+    }
+
     r = BN_mod_mul(i, key->d, key->e, k, ctx);
     if (!r) {
         ret = -1;
@@ -200,6 +234,42 @@ int RSA_check_key_ex(const RSA *key, BN_GENCB *cb)
             ret = 0;
             RSAerr(RSA_F_RSA_CHECK_KEY_EX, RSA_R_IQMP_NOT_INVERSE_OF_Q);
         }
+
+        /* d_i = d mod (r_i-1) and t_i = (p*q*...*r_(i-1))^-1 mod r_i? */
+        if (!BN_mul(l, key->p, key->q, ctx)) {
+            ret = -1;
+            goto err;
+        }
+        for (idx = 0; idx < extra; idx++) {
+            pinfo = sk_RSA_PRIME_INFO_value(key->prime_infos, idx);
+            if (!BN_sub(i, pinfo->r, BN_value_one())
+                || !BN_mod(j, key->d, i, ctx)) {
+                ret = -1;
+                goto err;
+            }
+
+            if (BN_cmp(j, pinfo->d) != 0) {
+                ret = 0;
+                RSAerr(RSA_F_RSA_CHECK_KEY_EX,
+                       RSA_R_MP_EXPONENT_NOT_CONGRUENT_TO_D);
+            }
+
+            if (!BN_mod_inverse(i, l, pinfo->r, ctx)) {
+                ret = -1;
+                goto err;
+            }
+
+            if (BN_cmp(i, pinfo->t) != 0) {
+                ret = 0;
+                RSAerr(RSA_F_RSA_CHECK_KEY_EX,
+                       RSA_R_MP_COEFFICIENT_NOT_INVERSE_OF_R);
+            }
+
+            if (!BN_mul(l, l, pinfo->r, ctx)) {
+                ret = -1;
+                goto err;
+            }
+        }
     }
 
  err:
@@ -63,6 +63,7 @@
 #include "internal/bn_int.h"
 #include <openssl/rsa.h>
 #include <openssl/rand.h>
+#include "rsa_locl.h"
 
 int RSA_size(const RSA *r)
 {
@@ -87,6 +88,62 @@ int RSA_private_decrypt(int flen, const unsigned char *from,
     return (rsa->meth->rsa_priv_dec(flen, from, to, rsa, padding));
 }
 
+/*
+ * Use the batch function of the method if all keys share one that has it,
+ * otherwise perform the operations one by one.
+ */
+static int rsa_private_batch(int num, const int *flen,
+                             const unsigned char *const *from,
+                             unsigned char *const *to, RSA *const *rsa,
+                             const int *padding, int *ret, int enc)
+{
+    const RSA_METHOD *meth;
+    int i, ok = 1;
+
+    if (num <= 0)
+        return 1;
+    meth = rsa[0]->meth;
+    for (i = 1; i < num; i++)
+        if (rsa[i]->meth != meth)
+            break;
+    if (i == num) {
+        if (enc && meth->rsa_priv_enc_batch != NULL)
+            return meth->rsa_priv_enc_batch(num, flen, from, to, rsa,
+                                            padding, ret);
+        if (!enc && meth->rsa_priv_dec_batch != NULL)
+            return meth->rsa_priv_dec_batch(num, flen, from, to, rsa,
+                                            padding, ret);
+    }
+
+    for (i = 0; i < num; i++) {
+        if (enc)
+            ret[i] = RSA_private_encrypt(flen[i], from[i], to[i], rsa[i],
+                                         padding[i]);
+        else
+            ret[i] = RSA_private_decrypt(flen[i], from[i], to[i], rsa[i],
+                                         padding[i]);
+        if (ret[i] < 0)
+            ok = 0;
+    }
+    return ok;
+}
+
+int RSA_private_encrypt_batch(int num, const int *flen,
+                              const unsigned char *const *from,
+                              unsigned char *const *to, RSA *const *rsa,
+                              const int *padding, int *ret)
+{
+    return rsa_private_batch(num, flen, from, to, rsa, padding, ret, 1);
+}
+
+int RSA_private_decrypt_batch(int num, const int *flen,
+                              const unsigned char *const *from,
+                              unsigned char *const *to, RSA *const *rsa,
+                              const int *padding, int *ret)
+{
+    return rsa_private_batch(num, flen, from, to, rsa, padding, ret, 0);
+}
+
 int RSA_public_decrypt(int flen, const unsigned char *from, unsigned char *to,
                        RSA *rsa, int padding)
 {
@@ -222,3 +279,193 @@ BN_BLINDING *RSA_setup_blinding(RSA *rsa, BN_CTX *in_ctx)
 
     return ret;
 }
+
+/*
+ * Set up the Montgomery contexts of |rsa| if it caches them: that of the
+ * modulus, and if |private| is set those of the primes. Nothing needs to be
+ * done, and no lock is taken, once RSA_precompute() has run.
+ */
+int rsa_mont_setup(RSA *rsa, int private, BN_CTX *ctx)
+{
+    BIGNUM *local_p = NULL, *local_q = NULL;
+    BIGNUM *p = NULL, *q = NULL;
+    RSA_PRIME_INFO *pinfo;
+    int i, ret = 0;
+
+    if (rsa->flags & RSA_FLAG_PRECOMPUTED)
+        return 1;
+
+    if (rsa->flags & RSA_FLAG_CACHE_PUBLIC)
+        if (!BN_MONT_CTX_set_locked
+            (&rsa->_method_mod_n, CRYPTO_LOCK_RSA, rsa->n, ctx))
+            return 0;
+
+    if (!private || !(rsa->flags & RSA_FLAG_CACHE_PRIVATE)
+        || rsa->p == NULL || rsa->q == NULL)
+        return 1;
+
+    /*
+     * Make sure BN_mod_inverse in Montgomery intialization uses the
+     * BN_FLG_CONSTTIME flag (unless RSA_FLAG_NO_CONSTTIME is set)
+     */
+    if (!(rsa->flags & RSA_FLAG_NO_CONSTTIME)) {
+        local_p = p = BN_new();
+        if (!p)
+            goto err;
+        BN_with_flags(p, rsa->p, BN_FLG_CONSTTIME);
+
+        local_q = q = BN_new();
+        if (!q)
+            goto err;
+        BN_with_flags(q, rsa->q, BN_FLG_CONSTTIME);
+    } else {
+        p = rsa->p;
+        q = rsa->q;
+    }
+
+    if (!BN_MONT_CTX_set_locked(&rsa->_method_mod_p, CRYPTO_LOCK_RSA, p, ctx)
+        || !BN_MONT_CTX_set_locked(&rsa->_method_mod_q, CRYPTO_LOCK_RSA, q,
+                                   ctx))
+        goto err;
+
+    /* and those of the additional primes of a multi-prime key */
+    for (i = 0; i < RSA_get_multi_prime_extra_count(rsa); i++) {
+        pinfo = sk_RSA_PRIME_INFO_value(rsa->prime_infos, i);
+        if (local_p != NULL)
+            BN_with_flags(p, pinfo->r, BN_FLG_CONSTTIME);
+        else
+            p = pinfo->r;
+        if (!BN_MONT_CTX_set_locked(&pinfo->m, CRYPTO_LOCK_RSA, p, ctx))
+            goto err;
+    }
+
+    ret = 1;
+ err:
+    if (local_p)
+        BN_free(local_p);
+    if (local_q)
+        BN_free(local_q);
+    return ret;
+}
+
+static RSA_THREAD_BLINDING *thread_blindings_new(void)
+{
+    RSA_THREAD_BLINDING *tb;
+
+    tb = OPENSSL_malloc(RSA_THREAD_BLINDINGS * sizeof(*tb));
+    if (tb != NULL)
+        memset(tb, 0, RSA_THREAD_BLINDINGS * sizeof(*tb));
+    return tb;
+}
+
+static BN_BLINDING *thread_blinding_find(RSA_THREAD_BLINDING *tb,
+                                         const CRYPTO_THREADID *cur,
+                                         RSA_THREAD_BLINDING **free_slot)
+{
+    RSA_THREAD_BLINDING *e;
+    unsigned long h;
+    int i;
+
+    if (tb == NULL)
+        return NULL;
+    h = CRYPTO_THREADID_hash(cur);
+    for (i = 0; i < RSA_THREAD_BLINDINGS; i++) {
+        e = &tb[(h + i) % RSA_THREAD_BLINDINGS];
+        if (e->blinding == NULL) {
+            if (free_slot != NULL)
+                *free_slot = e;
+            return NULL;
+        }
+        if (!CRYPTO_THREADID_cmp(&e->tid, cur))
+            return e->blinding;
+    }
+    return NULL;
+}
+
+/*
+ * Return the blinding of the calling thread, creating it on first use, or
+ * NULL if there is no room for another thread. Entries are only added, under
+ * CRYPTO_LOCK_RSA, and a thread can only match the entry it added itself,
+ * so once RSA_precompute() has allocated the table, before the key was
+ * shared, finding the entry takes no lock.
+ */
+BN_BLINDING *rsa_get_thread_blinding(RSA *rsa, BN_CTX *ctx)
+{
+    RSA_THREAD_BLINDING *slot = NULL;
+    BN_BLINDING *ret;
+    CRYPTO_THREADID cur;
+
+    CRYPTO_THREADID_current(&cur);
+    if (rsa->flags & RSA_FLAG_PRECOMPUTED) {
+        ret = thread_blinding_find(rsa->thread_blindings, &cur, NULL);
+    } else {
+        CRYPTO_r_lock(CRYPTO_LOCK_RSA);
+        ret = thread_blinding_find(rsa->thread_blindings, &cur, NULL);
+        CRYPTO_r_unlock(CRYPTO_LOCK_RSA);
+    }
+    if (ret != NULL)
+        return ret;
+
+    CRYPTO_w_lock(CRYPTO_LOCK_RSA);
+    if (rsa->thread_blindings == NULL)
+        rsa->thread_blindings = thread_blindings_new();
+    ret = thread_blinding_find(rsa->thread_blindings, &cur, &slot);
+    if (ret == NULL && slot != NULL) {
+        ret = RSA_setup_blinding(rsa, ctx);
+        if (ret != NULL) {
+            CRYPTO_THREADID_cpy(&slot->tid, &cur);
+            slot->blinding = ret;
+        }
+    }
+    CRYPTO_w_unlock(CRYPTO_LOCK_RSA);
+    return ret;
+}
+
+void rsa_free_thread_blindings(RSA *rsa)
+{
+    int i;
+
+    if (rsa->thread_blindings == NULL)
+        return;
+    for (i = 0; i < RSA_THREAD_BLINDINGS; i++)
+        if (rsa->thread_blindings[i].blinding != NULL)
+            BN_BLINDING_free(rsa->thread_blindings[i].blinding);
+    OPENSSL_free(rsa->thread_blindings);
+    rsa->thread_blindings = NULL;
+}
+
+/*
+ * Do the set up that private key operations would otherwise do on first use,
+ * so that later operations need not take any lock. Must be called before
+ * |rsa| is shared between threads.
+ */
+int RSA_precompute(RSA *rsa, BN_CTX *in_ctx)
+{
+    BN_CTX *ctx = in_ctx;
+    int ret = 0;
+
+    if (rsa->flags & RSA_FLAG_PRECOMPUTED)
+        return 1;
+    if (rsa->n == NULL)
+        return 1;
+
+    if (ctx == NULL && (ctx = BN_CTX_new()) == NULL) {
+        RSAerr(RSA_F_RSA_PRECOMPUTE, ERR_R_MALLOC_FAILURE);
+        return 0;
+    }
+    if (!rsa_mont_setup(rsa, 1, ctx)) {
+        RSAerr(RSA_F_RSA_PRECOMPUTE, ERR_R_BN_LIB);
+        goto err;
+    }
+    if (rsa->thread_blindings == NULL
+        && (rsa->thread_blindings = thread_blindings_new()) == NULL) {
+        RSAerr(RSA_F_RSA_PRECOMPUTE, ERR_R_MALLOC_FAILURE);
+        goto err;
+    }
+    rsa->flags |= RSA_FLAG_PRECOMPUTED;
+    ret = 1;
+ err:
+    if (in_ctx == NULL)
+        BN_CTX_free(ctx);
+    return ret;
+}
@@ -113,6 +113,7 @@
 #include "internal/bn_int.h"
 #include <openssl/rsa.h>
 #include <openssl/rand.h>
+#include "rsa_locl.h"
 
 #ifndef RSA_NULL
 
@@ -126,6 +127,22 @@ static int RSA_eay_private_decrypt(int flen, const unsigned char *from,
                                    unsigned char *to, RSA *rsa, int padding);
 static int RSA_eay_mod_exp(BIGNUM *r0, const BIGNUM *i, RSA *rsa,
                            BN_CTX *ctx);
+static int RSA_eay_private_encrypt_batch(int num, const int *flen,
+                                         const unsigned char *const *from,
+                                         unsigned char *const *to,
+                                         RSA *const *rsa, const int *padding,
+                                         int *ret);
+static int RSA_eay_private_decrypt_batch(int num, const int *flen,
+                                         const unsigned char *const *from,
+                                         unsigned char *const *to,
+                                         RSA *const *rsa, const int *padding,
+                                         int *ret);
+static int rsa_eay_crt_reduce(BIGNUM *r, const BIGNUM *I, const BIGNUM *mod,
+                              RSA *rsa, BN_CTX *ctx);
+static int rsa_eay_crt_combine(BIGNUM *r0, const BIGNUM *m1, const BIGNUM *I,
+                               RSA *rsa, BN_CTX *ctx);
+static int rsa_eay_crt_multi(BIGNUM *r0, const BIGNUM *I, RSA *rsa,
+                             BN_CTX *ctx);
 static int RSA_eay_init(RSA *rsa);
 static int RSA_eay_finish(RSA *rsa);
 static RSA_METHOD rsa_pkcs1_eay_meth = {
@@ -143,7 +160,9 @@ static RSA_METHOD rsa_pkcs1_eay_meth = {
     NULL,
     0,                          /* rsa_sign */
     0,                          /* rsa_verify */
-    NULL                        /* rsa_keygen */
+    NULL,                       /* rsa_keygen */
+    RSA_eay_private_encrypt_batch,
+    RSA_eay_private_decrypt_batch
 };
 
 const RSA_METHOD *RSA_PKCS1_SSLeay(void)
@@ -219,10 +238,8 @@ static int RSA_eay_public_encrypt(int flen, const unsigned char *from,
         goto err;
     }
 
-    if (rsa->flags & RSA_FLAG_CACHE_PUBLIC)
-        if (!BN_MONT_CTX_set_locked
-            (&rsa->_method_mod_n, CRYPTO_LOCK_RSA, rsa->n, ctx))
-            goto err;
+    if (!rsa_mont_setup(rsa, 0, ctx))
+        goto err;
 
     if (!rsa->meth->bn_mod_exp(ret, f, rsa->e, rsa->n, ctx,
                                rsa->_method_mod_n))
@@ -250,60 +267,38 @@ static int RSA_eay_public_encrypt(int flen, const unsigned char *from,
     return (r);
 }
 
+/*
+ * Each thread gets a blinding of its own from the table of the key, which it
+ * can use without locking. Only when the table is full do threads share
+ * rsa->mt_blinding.
+ */
 static BN_BLINDING *rsa_get_blinding(RSA *rsa, int *local, BN_CTX *ctx)
 {
     BN_BLINDING *ret;
-    int got_write_lock = 0;
-    CRYPTO_THREADID cur;
-
-    CRYPTO_r_lock(CRYPTO_LOCK_RSA);
-
-    if (rsa->blinding == NULL) {
-        CRYPTO_r_unlock(CRYPTO_LOCK_RSA);
-        CRYPTO_w_lock(CRYPTO_LOCK_RSA);
-        got_write_lock = 1;
-
-        if (rsa->blinding == NULL)
-            rsa->blinding = RSA_setup_blinding(rsa, ctx);
-    }
-
-    ret = rsa->blinding;
-    if (ret == NULL)
-        goto err;
-
-    CRYPTO_THREADID_current(&cur);
-    if (!CRYPTO_THREADID_cmp(&cur, BN_BLINDING_thread_id(ret))) {
-        /* rsa->blinding is ours! */
 
+    if ((ret = rsa_get_thread_blinding(rsa, ctx)) != NULL) {
         *local = 1;
-    } else {
-        /* resort to rsa->mt_blinding instead */
-
-        /*
-         * instructs rsa_blinding_convert(), rsa_blinding_invert() that the
-         * BN_BLINDING is shared, meaning that accesses require locks, and
-         * that the blinding factor must be stored outside the BN_BLINDING
-         */
-        *local = 0;
+        return ret;
+    }
 
-        if (rsa->mt_blinding == NULL) {
-            if (!got_write_lock) {
-                CRYPTO_r_unlock(CRYPTO_LOCK_RSA);
-                CRYPTO_w_lock(CRYPTO_LOCK_RSA);
-                got_write_lock = 1;
-            }
+    /*
+     * instructs rsa_blinding_convert(), rsa_blinding_invert() that the
+     * BN_BLINDING is shared, meaning that accesses require locks, and
+     * that the blinding factor must be stored outside the BN_BLINDING
+     */
+    *local = 0;
 
-            if (rsa->mt_blinding == NULL)
-                rsa->mt_blinding = RSA_setup_blinding(rsa, ctx);
-        }
-        ret = rsa->mt_blinding;
-    }
+    CRYPTO_r_lock(CRYPTO_LOCK_RSA);
+    ret = rsa->mt_blinding;
+    CRYPTO_r_unlock(CRYPTO_LOCK_RSA);
+    if (ret != NULL)
+        return ret;
 
- err:
-    if (got_write_lock)
-        CRYPTO_w_unlock(CRYPTO_LOCK_RSA);
-    else
-        CRYPTO_r_unlock(CRYPTO_LOCK_RSA);
+    CRYPTO_w_lock(CRYPTO_LOCK_RSA);
+    if (rsa->mt_blinding == NULL)
+        rsa->mt_blinding = RSA_setup_blinding(rsa, ctx);
+    ret = rsa->mt_blinding;
+    CRYPTO_w_unlock(CRYPTO_LOCK_RSA);
     return ret;
 }
 
@@ -341,292 +336,416 @@ static int rsa_blinding_invert(BN_BLINDING *b, BIGNUM *f, BIGNUM *unblind,
     return BN_BLINDING_invert_ex(f, unblind, b, ctx);
 }
 
-/* signing */
-static int RSA_eay_private_encrypt(int flen, const unsigned char *from,
-                                   unsigned char *to, RSA *rsa, int padding)
-{
-    BIGNUM *f, *ret, *res;
-    int i, j, k, num = 0, r = -1;
-    unsigned char *buf = NULL;
-    BN_CTX *ctx = NULL;
-    int local_blinding = 0;
+/* The state of a private key operation, see rsa_eay_private() */
+typedef struct {
+    RSA *rsa;
+    int padding;
+    int num;                    /* size of the modulus in bytes */
+    int r;                      /* return value, 0 while in progress */
+    unsigned char *buf;
+    BIGNUM *f, *ret;
     /*
-     * Used only if the blinding structure is shared. A non-NULL unblind
-     * instructs rsa_blinding_convert() and rsa_blinding_invert() to store
-     * the unblinding factor outside the blinding structure.
+     * Used only if the blinding structure is shared, with other threads or
+     * with other operations of a batch. A non-NULL unblind instructs
+     * rsa_blinding_invert() to use the unblinding factor stored here.
      */
-    BIGNUM *unblind = NULL;
-    BN_BLINDING *blinding = NULL;
-
-    if ((ctx = BN_CTX_new()) == NULL)
-        goto err;
-    BN_CTX_start(ctx);
-    f = BN_CTX_get(ctx);
-    ret = BN_CTX_get(ctx);
-    num = BN_num_bytes(rsa->n);
-    buf = OPENSSL_malloc(num);
-    if (!f || !ret || !buf) {
-        RSAerr(RSA_F_RSA_EAY_PRIVATE_ENCRYPT, ERR_R_MALLOC_FAILURE);
-        goto err;
+    BIGNUM *unblind;
+    BN_BLINDING *blinding;
+} RSA_EAY_PRIV;
+
+/*
+ * Pad or check the input of |op| and blind it, leaving the number to
+ * exponentiate in op->f. |multi| is set if other operations in the same
+ * batch may share the blinding.
+ */
+static int rsa_eay_private_start(RSA_EAY_PRIV *op, int flen,
+                                 const unsigned char *from, int enc,
+                                 int multi, BN_CTX *ctx)
+{
+    RSA *rsa = op->rsa;
+    int i, func, local_blinding = 0;
+
+    func = enc ? RSA_F_RSA_EAY_PRIVATE_ENCRYPT : RSA_F_RSA_EAY_PRIVATE_DECRYPT;
+
+    op->f = BN_CTX_get(ctx);
+    op->ret = BN_CTX_get(ctx);
+    op->num = BN_num_bytes(rsa->n);
+    op->buf = OPENSSL_malloc(op->num);
+    if (!op->f || !op->ret || !op->buf) {
+        RSAerr(func, ERR_R_MALLOC_FAILURE);
+        return 0;
     }
 
-    switch (padding) {
-    case RSA_PKCS1_PADDING:
-        i = RSA_padding_add_PKCS1_type_1(buf, num, from, flen);
-        break;
-    case RSA_X931_PADDING:
-        i = RSA_padding_add_X931(buf, num, from, flen);
-        break;
-    case RSA_NO_PADDING:
-        i = RSA_padding_add_none(buf, num, from, flen);
-        break;
-    case RSA_SSLV23_PADDING:
-    default:
-        RSAerr(RSA_F_RSA_EAY_PRIVATE_ENCRYPT, RSA_R_UNKNOWN_PADDING_TYPE);
-        goto err;
-    }
-    if (i <= 0)
-        goto err;
+    if (enc) {
+        switch (op->padding) {
+        case RSA_PKCS1_PADDING:
+            i = RSA_padding_add_PKCS1_type_1(op->buf, op->num, from, flen);
+            break;
+        case RSA_X931_PADDING:
+            i = RSA_padding_add_X931(op->buf, op->num, from, flen);
+            break;
+        case RSA_NO_PADDING:
+            i = RSA_padding_add_none(op->buf, op->num, from, flen);
+            break;
+        case RSA_SSLV23_PADDING:
+        default:
+            RSAerr(func, RSA_R_UNKNOWN_PADDING_TYPE);
+            return 0;
+        }
+        if (i <= 0)
+            return 0;
 
-    if (BN_bin2bn(buf, num, f) == NULL)
-        goto err;
+        if (BN_bin2bn(op->buf, op->num, op->f) == NULL)
+            return 0;
+    } else {
+        /*
+         * This check was for equality but PGP does evil things and chops off
+         * the top '0' bytes
+         */
+        if (flen > op->num) {
+            RSAerr(func, RSA_R_DATA_GREATER_THAN_MOD_LEN);
+            return 0;
+        }
 
-    if (BN_ucmp(f, rsa->n) >= 0) {
+        /* make data into a big number */
+        if (BN_bin2bn(from, (int)flen, op->f) == NULL)
+            return 0;
+    }
+
+    if (BN_ucmp(op->f, rsa->n) >= 0) {
         /* usually the padding functions would catch this */
-        RSAerr(RSA_F_RSA_EAY_PRIVATE_ENCRYPT,
-               RSA_R_DATA_TOO_LARGE_FOR_MODULUS);
-        goto err;
+        RSAerr(func, RSA_R_DATA_TOO_LARGE_FOR_MODULUS);
+        return 0;
     }
 
     if (!(rsa->flags & RSA_FLAG_NO_BLINDING)) {
-        blinding = rsa_get_blinding(rsa, &local_blinding, ctx);
-        if (blinding == NULL) {
-            RSAerr(RSA_F_RSA_EAY_PRIVATE_ENCRYPT, ERR_R_INTERNAL_ERROR);
-            goto err;
+        op->blinding = rsa_get_blinding(rsa, &local_blinding, ctx);
+        if (op->blinding == NULL) {
+            RSAerr(func, ERR_R_INTERNAL_ERROR);
+            return 0;
         }
     }
 
-    if (blinding != NULL) {
-        if (!local_blinding && ((unblind = BN_CTX_get(ctx)) == NULL)) {
-            RSAerr(RSA_F_RSA_EAY_PRIVATE_ENCRYPT, ERR_R_MALLOC_FAILURE);
-            goto err;
+    if (op->blinding != NULL) {
+        /*
+         * Operations on the same key in one batch use the same local
+         * blinding, so each keeps its own unblinding factor.
+         */
+        if ((!local_blinding || multi)
+            && ((op->unblind = BN_CTX_get(ctx)) == NULL)) {
+            RSAerr(func, ERR_R_MALLOC_FAILURE);
+            return 0;
         }
-        if (!rsa_blinding_convert(blinding, f, unblind, ctx))
-            goto err;
+        if (local_blinding && op->unblind != NULL) {
+            if (!BN_BLINDING_convert_ex(op->f, op->unblind, op->blinding,
+                                        ctx))
+                return 0;
+        } else if (!rsa_blinding_convert(op->blinding, op->f, op->unblind,
+                                         ctx))
+            return 0;
     }
 
+    return 1;
+}
+
+/* op->ret = op->f^d mod n, for a single operation */
+static int rsa_eay_private_exp(RSA_EAY_PRIV *op, int enc, BN_CTX *ctx)
+{
+    RSA *rsa = op->rsa;
+    BIGNUM *d = NULL, *local_d = NULL;
+    int ret;
+
     if ((rsa->flags & RSA_FLAG_EXT_PKEY) ||
         ((rsa->p != NULL) &&
          (rsa->q != NULL) &&
-         (rsa->dmp1 != NULL) && (rsa->dmq1 != NULL) && (rsa->iqmp != NULL))) {
-        if (!rsa->meth->rsa_mod_exp(ret, f, rsa, ctx))
-            goto err;
-    } else {
-        BIGNUM *d = NULL, *local_d = NULL;
+         (rsa->dmp1 != NULL) && (rsa->dmq1 != NULL) && (rsa->iqmp != NULL)))
+        return rsa->meth->rsa_mod_exp(op->ret, op->f, rsa, ctx);
 
-        if (!(rsa->flags & RSA_FLAG_NO_CONSTTIME)) {
-            local_d = d = BN_new();
-            if (!d) {
-                RSAerr(RSA_F_RSA_EAY_PRIVATE_ENCRYPT, ERR_R_MALLOC_FAILURE);
-                goto err;
-            }
-            BN_with_flags(d, rsa->d, BN_FLG_CONSTTIME);
-        } else
-            d = rsa->d;
-
-        if (rsa->flags & RSA_FLAG_CACHE_PUBLIC)
-            if (!BN_MONT_CTX_set_locked
-                (&rsa->_method_mod_n, CRYPTO_LOCK_RSA, rsa->n, ctx)) {
-                if (local_d)
-                    BN_free(local_d);
-                goto err;
-            }
-
-        if (!rsa->meth->bn_mod_exp(ret, f, d, rsa->n, ctx,
-                                   rsa->_method_mod_n)) {
-            if (local_d)
-                BN_free(local_d);
-            goto err;
+    if (!(rsa->flags & RSA_FLAG_NO_CONSTTIME)) {
+        local_d = d = BN_new();
+        if (!d) {
+            RSAerr(enc ? RSA_F_RSA_EAY_PRIVATE_ENCRYPT
+                   : RSA_F_RSA_EAY_PRIVATE_DECRYPT, ERR_R_MALLOC_FAILURE);
+            return 0;
         }
+        BN_with_flags(d, rsa->d, BN_FLG_CONSTTIME);
+    } else
+        d = rsa->d;
+
+    if (!rsa_mont_setup(rsa, 0, ctx)) {
         if (local_d)
             BN_free(local_d);
+        return 0;
     }
 
-    if (blinding)
-        if (!rsa_blinding_invert(blinding, ret, unblind, ctx))
-            goto err;
+    ret = rsa->meth->bn_mod_exp(op->ret, op->f, d, rsa->n, ctx,
+                                rsa->_method_mod_n);
+    if (local_d)
+        BN_free(local_d);
+    return ret;
+}
 
-    if (padding == RSA_X931_PADDING) {
-        BN_sub(f, rsa->n, ret);
-        if (BN_cmp(ret, f) > 0)
-            res = f;
-        else
-            res = ret;
-    } else
-        res = ret;
+/* Unblind op->ret and produce the output of |op| in |to| */
+static int rsa_eay_private_finish(RSA_EAY_PRIV *op, unsigned char *to,
+                                  int enc, BN_CTX *ctx)
+{
+    RSA *rsa = op->rsa;
+    BIGNUM *res;
+    int i, j, k, r = -1;
 
-    /*
-     * put in leading 0 bytes if the number is less than the length of the
-     * modulus
-     */
-    j = BN_num_bytes(res);
-    i = BN_bn2bin(res, &(to[num - j]));
-    for (k = 0; k < (num - i); k++)
-        to[k] = 0;
+    if (op->blinding)
+        if (!rsa_blinding_invert(op->blinding, op->ret, op->unblind, ctx))
+            return -1;
 
-    r = num;
- err:
-    if (ctx != NULL) {
-        BN_CTX_end(ctx);
-        BN_CTX_free(ctx);
-    }
-    if (buf != NULL) {
-        OPENSSL_cleanse(buf, num);
-        OPENSSL_free(buf);
-    }
-    return (r);
-}
+    if (enc) {
+        if (op->padding == RSA_X931_PADDING) {
+            BN_sub(op->f, rsa->n, op->ret);
+            if (BN_cmp(op->ret, op->f) > 0)
+                res = op->f;
+            else
+                res = op->ret;
+        } else
+            res = op->ret;
 
-static int RSA_eay_private_decrypt(int flen, const unsigned char *from,
-                                   unsigned char *to, RSA *rsa, int padding)
-{
-    BIGNUM *f, *ret;
-    int j, num = 0, r = -1;
-    unsigned char *p;
-    unsigned char *buf = NULL;
-    BN_CTX *ctx = NULL;
-    int local_blinding = 0;
-    /*
-     * Used only if the blinding structure is shared. A non-NULL unblind
-     * instructs rsa_blinding_convert() and rsa_blinding_invert() to store
-     * the unblinding factor outside the blinding structure.
-     */
-    BIGNUM *unblind = NULL;
-    BN_BLINDING *blinding = NULL;
+        /*
+         * put in leading 0 bytes if the number is less than the length of
+         * the modulus
+         */
+        j = BN_num_bytes(res);
+        i = BN_bn2bin(res, &(to[op->num - j]));
+        for (k = 0; k < (op->num - i); k++)
+            to[k] = 0;
 
-    if ((ctx = BN_CTX_new()) == NULL)
-        goto err;
-    BN_CTX_start(ctx);
-    f = BN_CTX_get(ctx);
-    ret = BN_CTX_get(ctx);
-    num = BN_num_bytes(rsa->n);
-    buf = OPENSSL_malloc(num);
-    if (!f || !ret || !buf) {
-        RSAerr(RSA_F_RSA_EAY_PRIVATE_DECRYPT, ERR_R_MALLOC_FAILURE);
-        goto err;
+        return op->num;
     }
 
-    /*
-     * This check was for equality but PGP does evil things and chops off the
-     * top '0' bytes
-     */
-    if (flen > num) {
-        RSAerr(RSA_F_RSA_EAY_PRIVATE_DECRYPT,
-               RSA_R_DATA_GREATER_THAN_MOD_LEN);
-        goto err;
+    j = BN_bn2bin(op->ret, op->buf); /* j is only used with no-padding mode */
+
+    switch (op->padding) {
+    case RSA_PKCS1_PADDING:
+        r = RSA_padding_check_PKCS1_type_2(to, op->num, op->buf, j, op->num);
+        break;
+    case RSA_PKCS1_OAEP_PADDING:
+        r = RSA_padding_check_PKCS1_OAEP(to, op->num, op->buf, j, op->num,
+                                         NULL, 0);
+        break;
+    case RSA_SSLV23_PADDING:
+        r = RSA_padding_check_SSLv23(to, op->num, op->buf, j, op->num);
+        break;
+    case RSA_NO_PADDING:
+        r = RSA_padding_check_none(to, op->num, op->buf, j, op->num);
+        break;
+    default:
+        RSAerr(RSA_F_RSA_EAY_PRIVATE_DECRYPT, RSA_R_UNKNOWN_PADDING_TYPE);
+        return -1;
     }
+    if (r < 0)
+        RSAerr(RSA_F_RSA_EAY_PRIVATE_DECRYPT, RSA_R_PADDING_CHECK_FAILED);
+    return r;
+}
 
-    /* make data into a big number */
-    if (BN_bin2bn(from, (int)flen, f) == NULL)
-        goto err;
+/*
+ * Whether |rsa| is a CRT key that RSA_eay_mod_exp() would handle with
+ * constant time Montgomery exponentiations, which rsa_eay_mod_exp_batch()
+ * can then do side by side with those of other keys.
+ */
+static int rsa_eay_can_batch(const RSA *rsa)
+{
+    return rsa->meth->rsa_mod_exp == RSA_eay_mod_exp
+        && rsa->meth->bn_mod_exp == BN_mod_exp_mont
+        && !(rsa->flags & (RSA_FLAG_EXT_PKEY | RSA_FLAG_NO_CONSTTIME))
+        && rsa->p != NULL && rsa->q != NULL && rsa->dmp1 != NULL
+        && rsa->dmq1 != NULL && rsa->iqmp != NULL;
+}
 
-    if (BN_ucmp(f, rsa->n) >= 0) {
-        RSAerr(RSA_F_RSA_EAY_PRIVATE_DECRYPT,
-               RSA_R_DATA_TOO_LARGE_FOR_MODULUS);
+/*
+ * op->ret = op->f^d mod n for the |num| operations in |ops|, all of which
+ * satisfy rsa_eay_can_batch(). The two CRT exponentiations of every
+ * operation are handed to bn_mod_exp_mont_consttime_batch() together.
+ */
+static int rsa_eay_mod_exp_batch(RSA_EAY_PRIV **ops, int num, BN_CTX *ctx)
+{
+    BIGNUM **rr = NULL, **m1;
+    const BIGNUM **a = NULL, **p = NULL, **m = NULL;
+    BN_MONT_CTX **mont = NULL;
+    RSA *rsa;
+    int i, ret = 0;
+
+    BN_CTX_start(ctx);
+    rr = OPENSSL_malloc(sizeof(*rr) * 2 * num);
+    a = OPENSSL_malloc(sizeof(*a) * 2 * num);
+    p = OPENSSL_malloc(sizeof(*p) * 2 * num);
+    m = OPENSSL_malloc(sizeof(*m) * 2 * num);
+    mont = OPENSSL_malloc(sizeof(*mont) * 2 * num);
+    if (rr == NULL || a == NULL || p == NULL || m == NULL || mont == NULL) {
+        RSAerr(RSA_F_RSA_EAY_MOD_EXP_BATCH, ERR_R_MALLOC_FAILURE);
         goto err;
     }
+    m1 = rr + num;
 
-    if (!(rsa->flags & RSA_FLAG_NO_BLINDING)) {
-        blinding = rsa_get_blinding(rsa, &local_blinding, ctx);
-        if (blinding == NULL) {
-            RSAerr(RSA_F_RSA_EAY_PRIVATE_DECRYPT, ERR_R_INTERNAL_ERROR);
-            goto err;
-        }
-    }
+    for (i = 0; i < num; i++) {
+        BIGNUM *r_p, *r_q;
 
-    if (blinding != NULL) {
-        if (!local_blinding && ((unblind = BN_CTX_get(ctx)) == NULL)) {
-            RSAerr(RSA_F_RSA_EAY_PRIVATE_DECRYPT, ERR_R_MALLOC_FAILURE);
+        rsa = ops[i]->rsa;
+        r_p = BN_CTX_get(ctx);
+        r_q = BN_CTX_get(ctx);
+        m1[i] = BN_CTX_get(ctx);
+        if (m1[i] == NULL) {
+            RSAerr(RSA_F_RSA_EAY_MOD_EXP_BATCH, ERR_R_MALLOC_FAILURE);
             goto err;
         }
-        if (!rsa_blinding_convert(blinding, f, unblind, ctx))
+        if (!rsa_mont_setup(rsa, 1, ctx)
+            || !rsa_eay_crt_reduce(r_p, ops[i]->f, rsa->p, rsa, ctx)
+            || !rsa_eay_crt_reduce(r_q, ops[i]->f, rsa->q, rsa, ctx))
             goto err;
-    }
 
-    /* do the decrypt */
-    if ((rsa->flags & RSA_FLAG_EXT_PKEY) ||
-        ((rsa->p != NULL) &&
-         (rsa->q != NULL) &&
-         (rsa->dmp1 != NULL) && (rsa->dmq1 != NULL) && (rsa->iqmp != NULL))) {
-        if (!rsa->meth->rsa_mod_exp(ret, f, rsa, ctx))
-            goto err;
-    } else {
-        BIGNUM *d = NULL, *local_d = NULL;
+        rr[i] = ops[i]->ret;
+        a[i] = r_p;
+        p[i] = rsa->dmp1;
+        m[i] = rsa->p;
+        mont[i] = rsa->_method_mod_p;
+        a[num + i] = r_q;
+        p[num + i] = rsa->dmq1;
+        m[num + i] = rsa->q;
+        mont[num + i] = rsa->_method_mod_q;
+    }
 
-        if (!(rsa->flags & RSA_FLAG_NO_CONSTTIME)) {
-            local_d = d = BN_new();
-            if (!d) {
-                RSAerr(RSA_F_RSA_EAY_PRIVATE_DECRYPT, ERR_R_MALLOC_FAILURE);
-                goto err;
-            }
-            BN_with_flags(d, rsa->d, BN_FLG_CONSTTIME);
-        } else
-            d = rsa->d;
+    if (!bn_mod_exp_mont_consttime_batch(rr, a, p, m, mont, 2 * num, ctx))
+        goto err;
 
-        if (rsa->flags & RSA_FLAG_CACHE_PUBLIC)
-            if (!BN_MONT_CTX_set_locked
-                (&rsa->_method_mod_n, CRYPTO_LOCK_RSA, rsa->n, ctx)) {
-                if (local_d)
-                    BN_free(local_d);
-                goto err;
-            }
-        if (!rsa->meth->bn_mod_exp(ret, f, d, rsa->n, ctx,
-                                   rsa->_method_mod_n)) {
-            if (local_d)
-                BN_free(local_d);
+    for (i = 0; i < num; i++)
+        if (!rsa_eay_crt_combine(ops[i]->ret, m1[i], ops[i]->f, ops[i]->rsa,
+                                 ctx))
             goto err;
+    ret = 1;
+ err:
+    OPENSSL_free(rr);
+    OPENSSL_free(a);
+    OPENSSL_free(p);
+    OPENSSL_free(m);
+    OPENSSL_free(mont);
+    BN_CTX_end(ctx);
+    return ret;
+}
+
+/*
+ * Perform |num| private key operations, encryptions (signing) if |enc| is
+ * set or decryptions otherwise. The result of each operation, as
+ * RSA_private_encrypt() or RSA_private_decrypt() would return it, is
+ * placed in ret[i]. Returns 1 if all operations succeeded.
+ */
+static int rsa_eay_private(int num, const int *flen,
+                           const unsigned char *const *from,
+                           unsigned char *const *to, RSA *const *rsa,
+                           const int *padding, int *ret, int enc)
+{
+    RSA_EAY_PRIV one, *ops = &one, **batch = NULL;
+    BN_CTX *ctx = NULL;
+    int i, nbatch = 0, started = 0, ok = 1;
+
+    if (num > 1) {
+        ops = OPENSSL_malloc(sizeof(*ops) * num);
+        batch = OPENSSL_malloc(sizeof(*batch) * num);
+        if (ops == NULL || batch == NULL) {
+            RSAerr(enc ? RSA_F_RSA_EAY_PRIVATE_ENCRYPT
+                   : RSA_F_RSA_EAY_PRIVATE_DECRYPT, ERR_R_MALLOC_FAILURE);
+            OPENSSL_free(batch);
+            if (ops != NULL)
+                OPENSSL_free(ops);
+            for (i = 0; i < num; i++)
+                ret[i] = -1;
+            return 0;
         }
-        if (local_d)
-            BN_free(local_d);
     }
+    memset(ops, 0, sizeof(*ops) * num);
 
-    if (blinding)
-        if (!rsa_blinding_invert(blinding, ret, unblind, ctx))
-            goto err;
+    if ((ctx = BN_CTX_new()) == NULL)
+        goto err;
+    BN_CTX_start(ctx);
 
-    p = buf;
-    j = BN_bn2bin(ret, p);      /* j is only used with no-padding mode */
+    for (i = 0; i < num; i++) {
+        ops[i].rsa = rsa[i];
+        ops[i].padding = padding[i];
+        if (!rsa_eay_private_start(&ops[i], flen[i], from[i], enc, num > 1,
+                                   ctx))
+            ops[i].r = -1;
+        else if (num > 1 && rsa_eay_can_batch(rsa[i]))
+            batch[nbatch++] = &ops[i];
+    }
 
-    switch (padding) {
-    case RSA_PKCS1_PADDING:
-        r = RSA_padding_check_PKCS1_type_2(to, num, buf, j, num);
-        break;
-    case RSA_PKCS1_OAEP_PADDING:
-        r = RSA_padding_check_PKCS1_OAEP(to, num, buf, j, num, NULL, 0);
-        break;
-    case RSA_SSLV23_PADDING:
-        r = RSA_padding_check_SSLv23(to, num, buf, j, num);
-        break;
-    case RSA_NO_PADDING:
-        r = RSA_padding_check_none(to, num, buf, j, num);
-        break;
-    default:
-        RSAerr(RSA_F_RSA_EAY_PRIVATE_DECRYPT, RSA_R_UNKNOWN_PADDING_TYPE);
-        goto err;
+    if (nbatch > 1) {
+        if (!rsa_eay_mod_exp_batch(batch, nbatch, ctx))
+            for (i = 0; i < nbatch; i++)
+                batch[i]->r = -1;
+    } else {
+        nbatch = 0;
     }
-    if (r < 0)
-        RSAerr(RSA_F_RSA_EAY_PRIVATE_DECRYPT, RSA_R_PADDING_CHECK_FAILED);
+
+    for (i = 0; i < num; i++) {
+        if (ops[i].r == 0 && (nbatch == 0 || !rsa_eay_can_batch(rsa[i]))
+            && !rsa_eay_private_exp(&ops[i], enc, ctx))
+            ops[i].r = -1;
+        if (ops[i].r == 0)
+            ops[i].r = rsa_eay_private_finish(&ops[i], to[i], enc, ctx);
+    }
+    started = 1;
 
  err:
+    for (i = 0; i < num; i++) {
+        ret[i] = started ? ops[i].r : -1;
+        if (ret[i] < 0)
+            ok = 0;
+        if (ops[i].buf != NULL) {
+            OPENSSL_cleanse(ops[i].buf, ops[i].num);
+            OPENSSL_free(ops[i].buf);
+        }
+    }
     if (ctx != NULL) {
         BN_CTX_end(ctx);
         BN_CTX_free(ctx);
     }
-    if (buf != NULL) {
-        OPENSSL_cleanse(buf, num);
-        OPENSSL_free(buf);
+    if (ops != &one) {
+        OPENSSL_free(ops);
+        OPENSSL_free(batch);
     }
-    return (r);
+    return ok;
+}
+
+/* signing */
+static int RSA_eay_private_encrypt(int flen, const unsigned char *from,
+                                   unsigned char *to, RSA *rsa, int padding)
+{
+    int r;
+
+    rsa_eay_private(1, &flen, &from, &to, &rsa, &padding, &r, 1);
+    return r;
+}
+
+static int RSA_eay_private_decrypt(int flen, const unsigned char *from,
+                                   unsigned char *to, RSA *rsa, int padding)
+{
+    int r;
+
+    rsa_eay_private(1, &flen, &from, &to, &rsa, &padding, &r, 0);
+    return r;
+}
+
+static int RSA_eay_private_encrypt_batch(int num, const int *flen,
+                                         const unsigned char *const *from,
+                                         unsigned char *const *to,
+                                         RSA *const *rsa, const int *padding,
+                                         int *ret)
+{
+    return rsa_eay_private(num, flen, from, to, rsa, padding, ret, 1);
+}
+
+static int RSA_eay_private_decrypt_batch(int num, const int *flen,
+                                         const unsigned char *const *from,
+                                         unsigned char *const *to,
+                                         RSA *const *rsa, const int *padding,
+                                         int *ret)
+{
+    return rsa_eay_private(num, flen, from, to, rsa, padding, ret, 0);
 }
 
 /* signature verification */
@@ -687,10 +806,8 @@ static int RSA_eay_public_decrypt(int flen, const unsigned char *from,
         goto err;
     }
 
-    if (rsa->flags & RSA_FLAG_CACHE_PUBLIC)
-        if (!BN_MONT_CTX_set_locked
-            (&rsa->_method_mod_n, CRYPTO_LOCK_RSA, rsa->n, ctx))
-            goto err;
+    if (!rsa_mont_setup(rsa, 0, ctx))
+        goto err;
 
     if (!rsa->meth->bn_mod_exp(ret, f, rsa->e, rsa->n, ctx,
                                rsa->_method_mod_n))
@@ -732,111 +849,44 @@ static int RSA_eay_public_decrypt(int flen, const unsigned char *from,
     return (r);
 }
 
-static int RSA_eay_mod_exp(BIGNUM *r0, const BIGNUM *I, RSA *rsa, BN_CTX *ctx)
+/* r = I mod |mod|, where |mod| is one of the primes of |rsa| */
+static int rsa_eay_crt_reduce(BIGNUM *r, const BIGNUM *I, const BIGNUM *mod,
+                              RSA *rsa, BN_CTX *ctx)
 {
-    BIGNUM *r1, *m1, *vrfy;
-    BIGNUM *local_dmp1, *local_dmq1, *local_c, *local_r1;
-    BIGNUM *dmp1, *dmq1, *c, *pr1;
+    BIGNUM *c;
+    int ret;
+
+    if (rsa->flags & RSA_FLAG_NO_CONSTTIME)
+        return BN_mod(r, I, mod, ctx);
+
+    if ((c = BN_new()) == NULL)
+        return 0;
+    BN_with_flags(c, I, BN_FLG_CONSTTIME);
+    ret = BN_mod(r, c, mod, ctx);
+    BN_free(c);
+    return ret;
+}
+
+/*
+ * Given r0 = I^dmp1 mod p and m1 = I^dmq1 mod q, compute r0 = I^d mod n,
+ * with the help of the additional primes if there are any, and check the
+ * result.
+ */
+static int rsa_eay_crt_combine(BIGNUM *r0, const BIGNUM *m1, const BIGNUM *I,
+                               RSA *rsa, BN_CTX *ctx)
+{
+    BIGNUM *r1, *vrfy;
+    BIGNUM *local_r1, *pr1;
     int ret = 0;
 
-    local_dmp1 = BN_new();
-    local_dmq1 = BN_new();
-    local_c = BN_new();
     local_r1 = BN_new();
-    if (!local_dmp1 || !local_dmq1 || !local_c || !local_r1)
-        goto err;
+    if (!local_r1)
+        return 0;
 
     BN_CTX_start(ctx);
     r1 = BN_CTX_get(ctx);
-    m1 = BN_CTX_get(ctx);
     vrfy = BN_CTX_get(ctx);
-
-    {
-        BIGNUM *local_p = NULL, *local_q = NULL;
-        BIGNUM *p = NULL, *q = NULL;
-
-        /*
-         * Make sure BN_mod_inverse in Montgomery intialization uses the
-         * BN_FLG_CONSTTIME flag (unless RSA_FLAG_NO_CONSTTIME is set)
-         */
-        if (!(rsa->flags & RSA_FLAG_NO_CONSTTIME)) {
-            local_p = p = BN_new();
-            if (!p)
-                goto err;
-            BN_with_flags(p, rsa->p, BN_FLG_CONSTTIME);
-
-            local_q = q = BN_new();
-            if (!q) {
-                BN_free(local_p);
-                goto err;
-            }
-            BN_with_flags(q, rsa->q, BN_FLG_CONSTTIME);
-        } else {
-            p = rsa->p;
-            q = rsa->q;
-        }
-
-        if (rsa->flags & RSA_FLAG_CACHE_PRIVATE) {
-            if (!BN_MONT_CTX_set_locked
-                (&rsa->_method_mod_p, CRYPTO_LOCK_RSA, p, ctx)
-                || !BN_MONT_CTX_set_locked(&rsa->_method_mod_q,
-                                           CRYPTO_LOCK_RSA, q, ctx)) {
-                if (local_p)
-                    BN_free(local_p);
-                if (local_q)
-                    BN_free(local_q);
-                goto err;
-            }
-        }
-        if (local_p)
-            BN_free(local_p);
-        if (local_q)
-            BN_free(local_q);
-    }
-
-    if (rsa->flags & RSA_FLAG_CACHE_PUBLIC)
-        if (!BN_MONT_CTX_set_locked
-            (&rsa->_method_mod_n, CRYPTO_LOCK_RSA, rsa->n, ctx))
-            goto err;
-
-    /* compute I mod q */
-    if (!(rsa->flags & RSA_FLAG_NO_CONSTTIME)) {
-        c = local_c;
-        BN_with_flags(c, I, BN_FLG_CONSTTIME);
-        if (!BN_mod(r1, c, rsa->q, ctx))
-            goto err;
-    } else {
-        if (!BN_mod(r1, I, rsa->q, ctx))
-            goto err;
-    }
-
-    /* compute r1^dmq1 mod q */
-    if (!(rsa->flags & RSA_FLAG_NO_CONSTTIME)) {
-        dmq1 = local_dmq1;
-        BN_with_flags(dmq1, rsa->dmq1, BN_FLG_CONSTTIME);
-    } else
-        dmq1 = rsa->dmq1;
-    if (!rsa->meth->bn_mod_exp(m1, r1, dmq1, rsa->q, ctx, rsa->_method_mod_q))
-        goto err;
-
-    /* compute I mod p */
-    if (!(rsa->flags & RSA_FLAG_NO_CONSTTIME)) {
-        c = local_c;
-        BN_with_flags(c, I, BN_FLG_CONSTTIME);
-        if (!BN_mod(r1, c, rsa->p, ctx))
-            goto err;
-    } else {
-        if (!BN_mod(r1, I, rsa->p, ctx))
-            goto err;
-    }
-
-    /* compute r1^dmp1 mod p */
-    if (!(rsa->flags & RSA_FLAG_NO_CONSTTIME)) {
-        dmp1 = local_dmp1;
-        BN_with_flags(dmp1, rsa->dmp1, BN_FLG_CONSTTIME);
-    } else
-        dmp1 = rsa->dmp1;
-    if (!rsa->meth->bn_mod_exp(r0, r1, dmp1, rsa->p, ctx, rsa->_method_mod_p))
+    if (vrfy == NULL)
         goto err;
 
     if (!BN_sub(r0, r0, m1))
@@ -876,6 +926,9 @@ static int RSA_eay_mod_exp(BIGNUM *r0, const BIGNUM *I, RSA *rsa, BN_CTX *ctx)
     if (!BN_add(r0, r1, m1))
         goto err;
 
+    if (rsa->prime_infos != NULL && !rsa_eay_crt_multi(r0, I, rsa, ctx))
+        goto err;
+
     if (rsa->e && rsa->n) {
         if (!rsa->meth->bn_mod_exp(vrfy, r0, rsa->e, rsa->n, ctx,
                                    rsa->_method_mod_n))
@@ -921,16 +974,137 @@ static int RSA_eay_mod_exp(BIGNUM *r0, const BIGNUM *I, RSA *rsa, BN_CTX *ctx)
                 BN_free(local_d);
         }
     }
+    ret = 1;
+ err:
+    BN_free(local_r1);
+    BN_CTX_end(ctx);
+    return ret;
+}
+
+/*
+ * Given r0 = I^d mod p*q, compute r0 = I^d mod n for a multi-prime key: for
+ * each additional prime r_i, with m_i = I^d_i mod r_i and P the product of
+ * the primes before it, r0 += P * ((m_i - r0) * t_i mod r_i).
+ */
+static int rsa_eay_crt_multi(BIGNUM *r0, const BIGNUM *I, RSA *rsa,
+                             BN_CTX *ctx)
+{
+    BIGNUM *pp, *m, *h, *d, *local_d;
+    RSA_PRIME_INFO *pinfo;
+    int i, ret = 0;
+
+    local_d = BN_new();
+    if (local_d == NULL)
+        return 0;
+
+    BN_CTX_start(ctx);
+    pp = BN_CTX_get(ctx);
+    m = BN_CTX_get(ctx);
+    h = BN_CTX_get(ctx);
+    if (h == NULL)
+        goto err;
+
+    if (!BN_mul(pp, rsa->p, rsa->q, ctx))
+        goto err;
+
+    for (i = 0; i < sk_RSA_PRIME_INFO_num(rsa->prime_infos); i++) {
+        pinfo = sk_RSA_PRIME_INFO_value(rsa->prime_infos, i);
+
+        /* compute m = (I mod r_i)^d_i mod r_i */
+        if (!rsa_eay_crt_reduce(h, I, pinfo->r, rsa, ctx))
+            goto err;
+        if (!(rsa->flags & RSA_FLAG_NO_CONSTTIME)) {
+            d = local_d;
+            BN_with_flags(d, pinfo->d, BN_FLG_CONSTTIME);
+        } else
+            d = pinfo->d;
+        if (!rsa->meth->bn_mod_exp(m, h, d, pinfo->r, ctx, pinfo->m))
+            goto err;
+
+        /* compute h = (m - r0) * t_i mod r_i */
+        if (!rsa_eay_crt_reduce(h, r0, pinfo->r, rsa, ctx))
+            goto err;
+        if (!BN_sub(h, m, h))
+            goto err;
+        if (BN_is_negative(h))
+            if (!BN_add(h, h, pinfo->r))
+                goto err;
+        if (!BN_mul(h, h, pinfo->t, ctx))
+            goto err;
+        if (!rsa_eay_crt_reduce(m, h, pinfo->r, rsa, ctx))
+            goto err;
+
+        /* and r0 += P * h */
+        if (!BN_mul(h, pp, m, ctx))
+            goto err;
+        if (!BN_add(r0, r0, h))
+            goto err;
+        if (!BN_mul(pp, pp, pinfo->r, ctx))
+            goto err;
+    }
+    ret = 1;
+ err:
+    BN_free(local_d);
+    BN_CTX_end(ctx);
+    return ret;
+}
+
+static int RSA_eay_mod_exp(BIGNUM *r0, const BIGNUM *I, RSA *rsa, BN_CTX *ctx)
+{
+    BIGNUM *r1, *m1;
+    BIGNUM *local_dmp1, *local_dmq1;
+    BIGNUM *dmp1, *dmq1;
+    int ret = 0;
+
+    local_dmp1 = BN_new();
+    local_dmq1 = BN_new();
+    if (!local_dmp1 || !local_dmq1)
+        goto err;
+
+    BN_CTX_start(ctx);
+    r1 = BN_CTX_get(ctx);
+    m1 = BN_CTX_get(ctx);
+    if (m1 == NULL)
+        goto err;
+
+    if (!rsa_mont_setup(rsa, 1, ctx))
+        goto err;
+
+    /* compute I mod q */
+    if (!rsa_eay_crt_reduce(r1, I, rsa->q, rsa, ctx))
+        goto err;
+
+    /* compute r1^dmq1 mod q */
+    if (!(rsa->flags & RSA_FLAG_NO_CONSTTIME)) {
+        dmq1 = local_dmq1;
+        BN_with_flags(dmq1, rsa->dmq1, BN_FLG_CONSTTIME);
+    } else
+        dmq1 = rsa->dmq1;
+    if (!rsa->meth->bn_mod_exp(m1, r1, dmq1, rsa->q, ctx, rsa->_method_mod_q))
+        goto err;
+
+    /* compute I mod p */
+    if (!rsa_eay_crt_reduce(r1, I, rsa->p, rsa, ctx))
+        goto err;
+
+    /* compute r1^dmp1 mod p */
+    if (!(rsa->flags & RSA_FLAG_NO_CONSTTIME)) {
+        dmp1 = local_dmp1;
+        BN_with_flags(dmp1, rsa->dmp1, BN_FLG_CONSTTIME);
+    } else
+        dmp1 = rsa->dmp1;
+    if (!rsa->meth->bn_mod_exp(r0, r1, dmp1, rsa->p, ctx, rsa->_method_mod_p))
+        goto err;
+
+    if (!rsa_eay_crt_combine(r0, m1, I, rsa, ctx))
+        goto err;
+
     ret = 1;
  err:
     if (local_dmp1)
         BN_free(local_dmp1);
     if (local_dmq1)
         BN_free(local_dmq1);
-    if (local_c)
-        BN_free(local_c);
-    if (local_r1)
-        BN_free(local_r1);
     BN_CTX_end(ctx);
     return (ret);
 }
@@ -949,6 +1123,8 @@ static int RSA_eay_finish(RSA *rsa)
         BN_MONT_CTX_free(rsa->_method_mod_p);
     if (rsa->_method_mod_q != NULL)
         BN_MONT_CTX_free(rsa->_method_mod_q);
+    rsa->_method_mod_n = rsa->_method_mod_p = rsa->_method_mod_q = NULL;
+    rsa->flags &= ~RSA_FLAG_PRECOMPUTED;
     return (1);
 }
 
@@ -68,8 +68,8 @@
 #include <openssl/bn.h>
 #include <openssl/rsa.h>
 
-static int rsa_builtin_keygen(RSA *rsa, int bits, BIGNUM *e_value,
-                              BN_GENCB *cb);
+static int rsa_builtin_keygen(RSA *rsa, int bits, int primes,
+                              BIGNUM *e_value, BN_GENCB *cb);
 
 /*
  * NB: this wrapper would normally be placed in rsa_lib.c and the static
@@ -82,16 +82,44 @@ int RSA_generate_key_ex(RSA *rsa, int bits, BIGNUM *e_value, BN_GENCB *cb)
 {
     if (rsa->meth->rsa_keygen)
         return rsa->meth->rsa_keygen(rsa, bits, e_value, cb);
-    return rsa_builtin_keygen(rsa, bits, e_value, cb);
+    return rsa_builtin_keygen(rsa, bits, RSA_DEFAULT_PRIME_NUM, e_value, cb);
 }
 
-static int rsa_builtin_keygen(RSA *rsa, int bits, BIGNUM *e_value,
-                              BN_GENCB *cb)
+/*
+ * Generate a key whose modulus is the product of |primes| primes, at most
+ * RSA_multi_prime_cap(bits). A method with its own key generation can only
+ * generate two prime keys.
+ */
+int RSA_generate_multi_prime_key(RSA *rsa, int bits, int primes,
+                                 BIGNUM *e_value, BN_GENCB *cb)
+{
+    if (primes == RSA_DEFAULT_PRIME_NUM)
+        return RSA_generate_key_ex(rsa, bits, e_value, cb);
+    if (primes < RSA_DEFAULT_PRIME_NUM || primes > RSA_multi_prime_cap(bits)) {
+        RSAerr(RSA_F_RSA_GENERATE_MULTI_PRIME_KEY,
+               RSA_R_KEY_PRIME_NUM_INVALID);
+        return 0;
+    }
+    if (rsa->meth->rsa_keygen) {
+        RSAerr(RSA_F_RSA_GENERATE_MULTI_PRIME_KEY,
+               RSA_R_OPERATION_NOT_SUPPORTED_FOR_THIS_KEYTYPE);
+        return 0;
+    }
+    return rsa_builtin_keygen(rsa, bits, primes, e_value, cb);
+}
+
+static int rsa_builtin_keygen(RSA *rsa, int bits, int primes,
+                              BIGNUM *e_value, BN_GENCB *cb)
 {
     BIGNUM *r0 = NULL, *r1 = NULL, *r2 = NULL, *r3 = NULL, *tmp;
     BIGNUM *local_r0, *local_d, *local_p;
     BIGNUM *pr0, *d, *p;
-    int bitsp, bitsq, ok = -1, n = 0;
+    BIGNUM *factors[RSA_MAX_PRIME_NUM];
+    int bitsr[RSA_MAX_PRIME_NUM];
+    STACK_OF(RSA_PRIME_INFO) *prime_infos = NULL;
+    RSA_PRIME_INFO *pinfo;
+    unsigned int degenerate = 0;
+    int i, j, ok = -1, n = 0, retries = 0;
     BN_CTX *ctx = NULL;
 
     local_r0 = BN_new();
@@ -111,8 +139,9 @@ static int rsa_builtin_keygen(RSA *rsa, int bits, BIGNUM *e_value,
     if (r3 == NULL)
         goto err;
 
-    bitsp = (bits + 1) / 2;
-    bitsq = bits - bitsp;
+    /* share the bits out among the primes, p getting any odd one */
+    for (i = 0; i < primes; i++)
+        bitsr[i] = bits / primes + (i < bits % primes);
 
     /* We need the RSA components non-NULL */
     if (!rsa->n && ((rsa->n = BN_new()) == NULL))
@@ -132,50 +161,76 @@ static int rsa_builtin_keygen(RSA *rsa, int bits, BIGNUM *e_value,
     if (!rsa->iqmp && ((rsa->iqmp = BN_new()) == NULL))
         goto err;
 
+    factors[0] = rsa->p;
+    factors[1] = rsa->q;
+    if (primes > RSA_DEFAULT_PRIME_NUM) {
+        if ((prime_infos = sk_RSA_PRIME_INFO_new_null()) == NULL)
+            goto err;
+        for (i = 2; i < primes; i++) {
+            if ((pinfo = RSA_PRIME_INFO_new()) == NULL)
+                goto err;
+            if (!sk_RSA_PRIME_INFO_push(prime_infos, pinfo)) {
+                RSA_PRIME_INFO_free(pinfo);
+                goto err;
+            }
+            factors[i] = pinfo->r;
+        }
+    }
+
     BN_copy(rsa->e, e_value);
 
-    /* generate p and q */
-    for (;;) {
-        if (!BN_generate_prime_ex(rsa->p, bitsp, 0, NULL, NULL, cb))
+    /* generate p, q and the additional primes */
+    for (i = 0; i < primes;) {
+        if (!BN_generate_prime_ex(factors[i], bitsr[i], 0, NULL, NULL, cb))
             goto err;
-        if (!BN_sub(r2, rsa->p, BN_value_one()))
-            goto err;
-        if (!BN_gcd(r1, r2, rsa->e, ctx))
-            goto err;
-        if (BN_is_one(r1))
-            break;
-        if (!BN_GENCB_call(cb, 2, n++))
-            goto err;
-    }
-    if (!BN_GENCB_call(cb, 3, 0))
-        goto err;
-    for (;;) {
         /*
          * When generating ridiculously small keys, we can get stuck
          * continually regenerating the same prime values. Check for this and
          * bail if it happens 3 times.
          */
-        unsigned int degenerate = 0;
-        do {
-            if (!BN_generate_prime_ex(rsa->q, bitsq, 0, NULL, NULL, cb))
+        for (j = 0; j < i && BN_cmp(factors[i], factors[j]) != 0; j++)
+            continue;
+        if (j < i) {
+            if (++degenerate == 3) {
+                ok = 0;         /* we set our own err */
+                RSAerr(RSA_F_RSA_BUILTIN_KEYGEN, RSA_R_KEY_SIZE_TOO_SMALL);
                 goto err;
-        } while ((BN_cmp(rsa->p, rsa->q) == 0) && (++degenerate < 3));
-        if (degenerate == 3) {
-            ok = 0;             /* we set our own err */
-            RSAerr(RSA_F_RSA_BUILTIN_KEYGEN, RSA_R_KEY_SIZE_TOO_SMALL);
-            goto err;
+            }
+            continue;
         }
-        if (!BN_sub(r2, rsa->q, BN_value_one()))
+        degenerate = 0;
+        if (!BN_sub(r2, factors[i], BN_value_one()))
             goto err;
         if (!BN_gcd(r1, r2, rsa->e, ctx))
             goto err;
-        if (BN_is_one(r1))
-            break;
-        if (!BN_GENCB_call(cb, 2, n++))
+        if (!BN_is_one(r1)) {
+            if (!BN_GENCB_call(cb, 2, n++))
+                goto err;
+            continue;
+        }
+        if (i == primes - 1 && primes > RSA_DEFAULT_PRIME_NUM) {
+            /*
+             * The product of more than two primes can fall short of |bits|.
+             * Try again with a new last prime, or if that keeps failing with
+             * all of them but p.
+             */
+            if (!BN_mul(r0, factors[0], factors[1], ctx))
+                goto err;
+            for (j = 2; j < primes; j++)
+                if (!BN_mul(r0, r0, factors[j], ctx))
+                    goto err;
+            if (BN_num_bits(r0) != bits) {
+                if (++retries == 4) {
+                    retries = 0;
+                    i = 1;
+                }
+                continue;
+            }
+        }
+        if (!BN_GENCB_call(cb, 3, i))
             goto err;
+        i++;
     }
-    if (!BN_GENCB_call(cb, 3, 1))
-        goto err;
     if (BN_cmp(rsa->p, rsa->q) < 0) {
         tmp = rsa->p;
         rsa->p = rsa->q;
@@ -185,6 +240,9 @@ static int rsa_builtin_keygen(RSA *rsa, int bits, BIGNUM *e_value,
     /* calculate n */
     if (!BN_mul(rsa->n, rsa->p, rsa->q, ctx))
         goto err;
+    for (i = 2; i < primes; i++)
+        if (!BN_mul(rsa->n, rsa->n, factors[i], ctx))
+            goto err;
 
     /* calculate d */
     if (!BN_sub(r1, rsa->p, BN_value_one()))
@@ -193,6 +251,12 @@ static int rsa_builtin_keygen(RSA *rsa, int bits, BIGNUM *e_value,
         goto err;               /* q-1 */
     if (!BN_mul(r0, r1, r2, ctx))
         goto err;               /* (p-1)(q-1) */
+    for (i = 2; i < primes; i++) {
+        if (!BN_sub(r3, factors[i], BN_value_one()))
+            goto err;
+        if (!BN_mul(r0, r0, r3, ctx))
+            goto err;           /* (p-1)(q-1)...(r_i-1) */
+    }
     if (!(rsa->flags & RSA_FLAG_NO_CONSTTIME)) {
         pr0 = local_r0;
         BN_with_flags(pr0, r0, BN_FLG_CONSTTIME);
@@ -225,6 +289,36 @@ static int rsa_builtin_keygen(RSA *rsa, int bits, BIGNUM *e_value,
     if (!BN_mod_inverse(rsa->iqmp, rsa->q, p, ctx))
         goto err;
 
+    /* calculate d mod (r_i-1) and (p*q*...*r_(i-1))^-1 mod r_i */
+    if (!BN_mul(r0, rsa->p, rsa->q, ctx))
+        goto err;
+    for (i = 2; i < primes; i++) {
+        pinfo = sk_RSA_PRIME_INFO_value(prime_infos, i - 2);
+        if (!BN_sub(r1, pinfo->r, BN_value_one()))
+            goto err;
+        if (!BN_mod(pinfo->d, d, r1, ctx))
+            goto err;
+        if (!(rsa->flags & RSA_FLAG_NO_CONSTTIME)) {
+            p = local_p;
+            BN_with_flags(p, pinfo->r, BN_FLG_CONSTTIME);
+        } else
+            p = pinfo->r;
+        if (!BN_mod_inverse(pinfo->t, r0, p, ctx))
+            goto err;
+        if (!BN_mul(r0, r0, pinfo->r, ctx))
+            goto err;
+    }
+
+    if (rsa->prime_infos != NULL)
+        sk_RSA_PRIME_INFO_pop_free(rsa->prime_infos, RSA_PRIME_INFO_free);
+    rsa->prime_infos = prime_infos;
+    prime_infos = NULL;
+    rsa->version = primes > RSA_DEFAULT_PRIME_NUM ? RSA_ASN1_VERSION_MULTI
+        : RSA_ASN1_VERSION_DEFAULT;
+
+    if (!RSA_precompute(rsa, ctx))
+        goto err;
+
     ok = 1;
  err:
     if (local_r0)
@@ -233,6 +327,8 @@ static int rsa_builtin_keygen(RSA *rsa, int bits, BIGNUM *e_value,
         BN_free(local_d);
     if (local_p)
         BN_free(local_p);
+    if (prime_infos != NULL)
+        sk_RSA_PRIME_INFO_pop_free(prime_infos, RSA_PRIME_INFO_free);
     if (ok == -1) {
         RSAerr(RSA_F_RSA_BUILTIN_KEYGEN, ERR_LIB_BN);
         ok = 0;
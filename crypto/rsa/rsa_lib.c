@@ -63,6 +63,7 @@
 #include "internal/bn_int.h"
 #include <openssl/rsa.h>
 #include <openssl/rand.h>
+#include "rsa_locl.h"
 #ifndef OPENSSL_NO_ENGINE
 # include <openssl/engine.h>
 #endif
@@ -171,6 +172,8 @@ RSA *RSA_new_method(ENGINE *engine)
     ret->_method_mod_q = NULL;
     ret->blinding = NULL;
     ret->mt_blinding = NULL;
+    ret->prime_infos = NULL;
+    ret->thread_blindings = NULL;
     ret->bignum_data = NULL;
     ret->flags = ret->meth->flags & ~RSA_FLAG_NON_FIPS_ALLOW;
     if (!CRYPTO_new_ex_data(CRYPTO_EX_INDEX_RSA, ret, &ret->ex_data)) {
@@ -243,6 +246,9 @@ void RSA_free(RSA *r)
         BN_BLINDING_free(r->blinding);
     if (r->mt_blinding != NULL)
         BN_BLINDING_free(r->mt_blinding);
+    rsa_free_thread_blindings(r);
+    if (r->prime_infos != NULL)
+        sk_RSA_PRIME_INFO_pop_free(r->prime_infos, RSA_PRIME_INFO_free);
     if (r->bignum_data != NULL)
         OPENSSL_free_locked(r->bignum_data);
     OPENSSL_free(r);
@@ -263,6 +269,31 @@ int RSA_up_ref(RSA *r)
     return ((i > 1) ? 1 : 0);
 }
 
+/* The number of primes of |r| beyond p and q */
+int RSA_get_multi_prime_extra_count(const RSA *r)
+{
+    if (r->prime_infos == NULL)
+        return 0;
+    return sk_RSA_PRIME_INFO_num(r->prime_infos);
+}
+
+/*
+ * The largest number of primes recommended for a |bits|-bit modulus: more
+ * primes make the private key operations faster, but each prime has to stay
+ * large enough for the factoring methods that find small factors to remain
+ * harder than the general number field sieve.
+ */
+int RSA_multi_prime_cap(int bits)
+{
+    if (bits < 1024)
+        return 2;
+    if (bits < 4096)
+        return 3;
+    if (bits < 8192)
+        return 4;
+    return RSA_MAX_PRIME_NUM;
+}
+
 int RSA_get_ex_new_index(long argl, void *argp, CRYPTO_EX_new *new_func,
                          CRYPTO_EX_dup *dup_func, CRYPTO_EX_free *free_func)
 {
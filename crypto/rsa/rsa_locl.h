@@ -2,3 +2,21 @@ extern int int_rsa_verify(int dtype, const unsigned char *m,
                           unsigned int m_len, unsigned char *rm,
                           size_t *prm_len, const unsigned char *sigbuf,
                           size_t siglen, RSA *rsa);
+extern int rsa_sign_encode(int type, const unsigned char *m,
+                           unsigned int m_len, unsigned char *out,
+                           const RSA *rsa);
+
+/*
+ * The blinding of one thread, see rsa_get_thread_blinding(). A key has a
+ * table of RSA_THREAD_BLINDINGS of these, indexed by a hash of the thread
+ * id.
+ */
+# define RSA_THREAD_BLINDINGS    64
+typedef struct rsa_thread_blinding_st {
+    CRYPTO_THREADID tid;
+    BN_BLINDING *blinding;
+} RSA_THREAD_BLINDING;
+
+int rsa_mont_setup(RSA *rsa, int private, BN_CTX *ctx);
+BN_BLINDING *rsa_get_thread_blinding(RSA *rsa, BN_CTX *ctx);
+void rsa_free_thread_blindings(RSA *rsa);
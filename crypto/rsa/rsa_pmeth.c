@@ -77,6 +77,7 @@ typedef struct {
     /* Key gen parameters */
     int nbits;
     BIGNUM *pub_exp;
+    int primes;
     /* Keygen callback info */
     int gentmp[2];
     /* RSA padding mode */
@@ -102,6 +103,7 @@ static int pkey_rsa_init(EVP_PKEY_CTX *ctx)
         return 0;
     rctx->nbits = 1024;
     rctx->pub_exp = NULL;
+    rctx->primes = RSA_DEFAULT_PRIME_NUM;
     rctx->pad_mode = RSA_PKCS1_PADDING;
     rctx->md = NULL;
     rctx->mgf1md = NULL;
@@ -127,6 +129,7 @@ static int pkey_rsa_copy(EVP_PKEY_CTX *dst, EVP_PKEY_CTX *src)
     sctx = src->data;
     dctx = dst->data;
     dctx->nbits = sctx->nbits;
+    dctx->primes = sctx->primes;
     if (sctx->pub_exp) {
         dctx->pub_exp = BN_dup(sctx->pub_exp);
         if (!dctx->pub_exp)
@@ -195,6 +198,10 @@ static int pkey_rsa_sign(EVP_PKEY_CTX *ctx, unsigned char *sig,
                 return ret;
             ret = sltmp;
         } else if (rctx->pad_mode == RSA_X931_PADDING) {
+            if ((size_t)RSA_size(rsa) < tbslen + 1) {
+                RSAerr(RSA_F_PKEY_RSA_SIGN, RSA_R_KEY_SIZE_TOO_SMALL);
+                return -1;
+            }
             if (!setup_tbuf(rctx, ctx))
                 return -1;
             memcpy(rctx->tbuf, tbs, tbslen);
@@ -229,6 +236,136 @@ static int pkey_rsa_sign(EVP_PKEY_CTX *ctx, unsigned char *sig,
     return 1;
 }
 
+/*
+ * Prepare the input of the private key operation that pkey_rsa_sign()
+ * would perform for |tbs|, using |buf| of EVP_PKEY_size() bytes if the
+ * input needs to be encoded.
+ */
+static int pkey_rsa_sign_pad(EVP_PKEY_CTX *ctx, unsigned char *buf,
+                             const unsigned char **from, int *flen,
+                             int *padding, const unsigned char *tbs,
+                             size_t tbslen)
+{
+    RSA_PKEY_CTX *rctx = ctx->data;
+    RSA *rsa = ctx->pkey->pkey.rsa;
+
+    if (rctx->md == NULL) {
+        *from = tbs;
+        *flen = tbslen;
+        *padding = rctx->pad_mode;
+        return 1;
+    }
+    if (tbslen != (size_t)EVP_MD_size(rctx->md)) {
+        RSAerr(RSA_F_PKEY_RSA_SIGN_PAD, RSA_R_INVALID_DIGEST_LENGTH);
+        return 0;
+    }
+
+    *from = buf;
+    if (rctx->pad_mode == RSA_X931_PADDING) {
+        if ((size_t)RSA_size(rsa) < tbslen + 1) {
+            RSAerr(RSA_F_PKEY_RSA_SIGN_PAD, RSA_R_KEY_SIZE_TOO_SMALL);
+            return 0;
+        }
+        memcpy(buf, tbs, tbslen);
+        buf[tbslen] = RSA_X931_hash_id(EVP_MD_type(rctx->md));
+        *flen = tbslen + 1;
+        *padding = RSA_X931_PADDING;
+    } else if (rctx->pad_mode == RSA_PKCS1_PADDING) {
+        *flen = rsa_sign_encode(EVP_MD_type(rctx->md), tbs, tbslen, buf, rsa);
+        if (*flen <= 0)
+            return 0;
+        *padding = RSA_PKCS1_PADDING;
+    } else if (rctx->pad_mode == RSA_PKCS1_PSS_PADDING) {
+        if (!RSA_padding_add_PKCS1_PSS_mgf1(rsa, buf, tbs, rctx->md,
+                                            rctx->mgf1md, rctx->saltlen))
+            return 0;
+        *flen = RSA_size(rsa);
+        *padding = RSA_NO_PADDING;
+    } else
+        return 0;
+    return 1;
+}
+
+/*
+ * Sign every input as pkey_rsa_sign() would, performing all the private
+ * key operations with a single RSA_private_encrypt_batch() call.
+ */
+static int pkey_rsa_sign_batch(EVP_PKEY_CTX **ctx, unsigned char **sig,
+                               size_t *siglen, const unsigned char **tbs,
+                               const size_t *tbslen, size_t num)
+{
+    RSA_PKEY_CTX *rctx;
+    RSA *rsa, **keys = NULL;
+    const unsigned char **from = NULL;
+    unsigned char **to = NULL, *buf = NULL, *p;
+    int *flen = NULL, *padding = NULL, *res = NULL;
+    size_t i, n = 0, buflen = 0, *idx = NULL;
+    int r, ret = 0;
+
+    for (i = 0; i < num; i++)
+        buflen += EVP_PKEY_size(ctx[i]->pkey);
+    keys = OPENSSL_malloc(sizeof(*keys) * num);
+    from = OPENSSL_malloc(sizeof(*from) * num);
+    to = OPENSSL_malloc(sizeof(*to) * num);
+    flen = OPENSSL_malloc(sizeof(*flen) * num);
+    padding = OPENSSL_malloc(sizeof(*padding) * num);
+    res = OPENSSL_malloc(sizeof(*res) * num);
+    idx = OPENSSL_malloc(sizeof(*idx) * num);
+    buf = p = OPENSSL_malloc(buflen);
+    if (keys == NULL || from == NULL || to == NULL || flen == NULL
+        || padding == NULL || res == NULL || idx == NULL || buf == NULL) {
+        RSAerr(RSA_F_PKEY_RSA_SIGN_BATCH, ERR_R_MALLOC_FAILURE);
+        goto err;
+    }
+
+    ret = 1;
+    for (i = 0; i < num; p += EVP_PKEY_size(ctx[i]->pkey), i++) {
+        rctx = ctx[i]->data;
+        rsa = ctx[i]->pkey->pkey.rsa;
+        if (rctx->md != NULL
+            && (EVP_MD_type(rctx->md) == NID_mdc2
+                || (rctx->pad_mode == RSA_PKCS1_PADDING
+                    && (rsa->flags & RSA_FLAG_SIGN_VER)
+                    && rsa->meth->rsa_sign != NULL))) {
+            /* Signed with a special encoding or by the method itself */
+            r = pkey_rsa_sign(ctx[i], sig[i], &siglen[i], tbs[i], tbslen[i]);
+        } else {
+            r = pkey_rsa_sign_pad(ctx[i], p, &from[n], &flen[n], &padding[n],
+                                  tbs[i], tbslen[i]);
+            if (r > 0) {
+                keys[n] = rsa;
+                to[n] = sig[i];
+                idx[n++] = i;
+                continue;
+            }
+        }
+        if (r <= 0) {
+            siglen[i] = 0;
+            ret = 0;
+        }
+    }
+
+    if (!RSA_private_encrypt_batch((int)n, flen, from, to, keys, padding,
+                                   res))
+        ret = 0;
+    for (i = 0; i < n; i++)
+        siglen[idx[i]] = res[i] < 0 ? 0 : res[i];
+
+ err:
+    if (buf != NULL) {
+        OPENSSL_cleanse(buf, buflen);
+        OPENSSL_free(buf);
+    }
+    OPENSSL_free(keys);
+    OPENSSL_free(from);
+    OPENSSL_free(to);
+    OPENSSL_free(flen);
+    OPENSSL_free(padding);
+    OPENSSL_free(res);
+    OPENSSL_free(idx);
+    return ret;
+}
+
 static int pkey_rsa_verifyrecover(EVP_PKEY_CTX *ctx,
                                   unsigned char *rout, size_t *routlen,
                                   const unsigned char *sig, size_t siglen)
@@ -466,6 +603,14 @@ static int pkey_rsa_ctrl(EVP_PKEY_CTX *ctx, int type, int p1, void *p2)
         rctx->pub_exp = p2;
         return 1;
 
+    case EVP_PKEY_CTRL_RSA_KEYGEN_PRIMES:
+        if (p1 < RSA_DEFAULT_PRIME_NUM || p1 > RSA_MAX_PRIME_NUM) {
+            RSAerr(RSA_F_PKEY_RSA_CTRL, RSA_R_KEY_PRIME_NUM_INVALID);
+            return -2;
+        }
+        rctx->primes = p1;
+        return 1;
+
     case EVP_PKEY_CTRL_RSA_OAEP_MD:
     case EVP_PKEY_CTRL_GET_RSA_OAEP_MD:
         if (rctx->pad_mode != RSA_PKCS1_OAEP_PADDING) {
@@ -592,6 +737,12 @@ static int pkey_rsa_ctrl_str(EVP_PKEY_CTX *ctx,
         return EVP_PKEY_CTX_set_rsa_keygen_bits(ctx, nbits);
     }
 
+    if (!strcmp(type, "rsa_keygen_primes")) {
+        int primes;
+        primes = atoi(value);
+        return EVP_PKEY_CTX_set_rsa_keygen_primes(ctx, primes);
+    }
+
     if (!strcmp(type, "rsa_keygen_pubexp")) {
         int ret;
         BIGNUM *pubexp = NULL;
@@ -659,7 +810,8 @@ static int pkey_rsa_keygen(EVP_PKEY_CTX *ctx, EVP_PKEY *pkey)
         evp_pkey_set_cb_translate(pcb, ctx);
     } else
         pcb = NULL;
-    ret = RSA_generate_key_ex(rsa, rctx->nbits, rctx->pub_exp, pcb);
+    ret = RSA_generate_multi_prime_key(rsa, rctx->nbits, rctx->primes,
+                                       rctx->pub_exp, pcb);
     BN_GENCB_free(pcb);
     if (ret > 0)
         EVP_PKEY_assign_RSA(pkey, rsa);
@@ -700,5 +852,7 @@ const EVP_PKEY_METHOD rsa_pkey_meth = {
     0, 0,
 
     pkey_rsa_ctrl,
-    pkey_rsa_ctrl_str
+    pkey_rsa_ctrl_str,
+
+    pkey_rsa_sign_batch
 };
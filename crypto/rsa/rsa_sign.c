@@ -67,19 +67,20 @@
 /* Size of an SSL signature: MD5+SHA1 */
 #define SSL_SIG_LENGTH  36
 
-int RSA_sign(int type, const unsigned char *m, unsigned int m_len,
-             unsigned char *sigret, unsigned int *siglen, RSA *rsa)
+/*
+ * Write the DigestInfo for the |m_len| byte digest |m| of type |type| to
+ * |out|, which must have room for RSA_size(rsa) bytes, ready to be padded
+ * and signed with |rsa|. Returns its length or 0 on error.
+ */
+int rsa_sign_encode(int type, const unsigned char *m, unsigned int m_len,
+                    unsigned char *out, const RSA *rsa)
 {
     X509_SIG sig;
     ASN1_TYPE parameter;
-    int i, j, ret = 1;
-    unsigned char *p, *tmps = NULL;
-    const unsigned char *s = NULL;
+    int i;
     X509_ALGOR algor;
     ASN1_OCTET_STRING digest;
-    if ((rsa->flags & RSA_FLAG_SIGN_VER) && rsa->meth->rsa_sign) {
-        return rsa->meth->rsa_sign(type, m, m_len, sigret, siglen, rsa);
-    }
+
     /* Special case: SSL signature, just check the length */
     if (type == NID_md5_sha1) {
         if (m_len != SSL_SIG_LENGTH) {
@@ -87,7 +88,6 @@ int RSA_sign(int type, const unsigned char *m, unsigned int m_len,
             return (0);
         }
         i = SSL_SIG_LENGTH;
-        s = m;
     } else {
         sig.algor = &algor;
         sig.algor->algorithm = OBJ_nid2obj(type);
@@ -110,31 +110,42 @@ int RSA_sign(int type, const unsigned char *m, unsigned int m_len,
 
         i = i2d_X509_SIG(&sig, NULL);
     }
-    j = RSA_size(rsa);
-    if (i > (j - RSA_PKCS1_PADDING_SIZE)) {
+    if (i > (RSA_size(rsa) - RSA_PKCS1_PADDING_SIZE)) {
         RSAerr(RSA_F_RSA_SIGN, RSA_R_DIGEST_TOO_BIG_FOR_RSA_KEY);
         return (0);
     }
-    if (type != NID_md5_sha1) {
-        tmps = (unsigned char *)OPENSSL_malloc((unsigned int)j + 1);
-        if (tmps == NULL) {
-            RSAerr(RSA_F_RSA_SIGN, ERR_R_MALLOC_FAILURE);
-            return (0);
-        }
-        p = tmps;
-        i2d_X509_SIG(&sig, &p);
-        s = tmps;
+    if (type == NID_md5_sha1) {
+        memcpy(out, m, SSL_SIG_LENGTH);
+        return SSL_SIG_LENGTH;
     }
-    i = RSA_private_encrypt(i, s, sigret, rsa, RSA_PKCS1_PADDING);
+    return i2d_X509_SIG(&sig, &out);
+}
+
+int RSA_sign(int type, const unsigned char *m, unsigned int m_len,
+             unsigned char *sigret, unsigned int *siglen, RSA *rsa)
+{
+    int i, j, ret = 1;
+    unsigned char *tmps = NULL;
+
+    if ((rsa->flags & RSA_FLAG_SIGN_VER) && rsa->meth->rsa_sign) {
+        return rsa->meth->rsa_sign(type, m, m_len, sigret, siglen, rsa);
+    }
+    j = RSA_size(rsa);
+    tmps = (unsigned char *)OPENSSL_malloc((unsigned int)j + 1);
+    if (tmps == NULL) {
+        RSAerr(RSA_F_RSA_SIGN, ERR_R_MALLOC_FAILURE);
+        return (0);
+    }
+    i = rsa_sign_encode(type, m, m_len, tmps, rsa);
+    if (i > 0)
+        i = RSA_private_encrypt(i, tmps, sigret, rsa, RSA_PKCS1_PADDING);
     if (i <= 0)
         ret = 0;
     else
         *siglen = i;
 
-    if (type != NID_md5_sha1) {
-        OPENSSL_cleanse(tmps, (unsigned int)j + 1);
-        OPENSSL_free(tmps);
-    }
+    OPENSSL_cleanse(tmps, (unsigned int)j + 1);
+    OPENSSL_free(tmps);
     return (ret);
 }
 
@@ -0,0 +1,278 @@
+/* crypto/sha/sha_mb.c */
+/* ====================================================================
+ * Copyright (c) 2015 The OpenSSL Project.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. All advertising materials mentioning features or use of this
+ *    software must display the following acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit. (http://www.openssl.org/)"
+ *
+ * 4. The names "OpenSSL Toolkit" and "OpenSSL Project" must not be used to
+ *    endorse or promote products derived from this software without
+ *    prior written permission. For written permission, please contact
+ *    openssl-core@openssl.org.
+ *
+ * 5. Products derived from this software may not be called "OpenSSL"
+ *    nor may "OpenSSL" appear in their names without prior written
+ *    permission of the OpenSSL Project.
+ *
+ * 6. Redistributions of any form whatsoever must retain the following
+ *    acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit (http://www.openssl.org/)"
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE OpenSSL PROJECT ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE OpenSSL PROJECT OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ====================================================================
+ */
+
+#include <string.h>
+
+#include <openssl/crypto.h>
+#include <openssl/sha.h>
+#include "internal/sha_mb.h"
+
+#ifdef SHA_MULTI_BLOCK
+
+/*
+ * State of the multi-buffer kernels: word |w| of the hash of stream |i| is
+ * h[w][i]. SHA-1 uses the first five rows only.
+ */
+typedef struct {
+    unsigned int h[8][8];
+} SHA_MB_CTX;
+
+typedef struct {
+    const unsigned char *ptr;
+    int blocks;
+} HASH_DESC;
+
+void sha1_multi_block(SHA_MB_CTX *, const HASH_DESC *, int);
+void sha256_multi_block(SHA_MB_CTX *, const HASH_DESC *, int);
+
+/* Messages are fed to the streams this many blocks at a time */
+# define MB_CHUNK        64
+/* Fewer messages than this are faster hashed one by one */
+# define MB_MIN_NUM      4
+
+typedef struct {
+    void (*block) (SHA_MB_CTX *ctx, const HASH_DESC *desc, int n4x);
+    int md_words;
+    unsigned int iv[8];
+} MB_HASH;
+
+static const MB_HASH mb_sha1 = {
+    sha1_multi_block, 5,
+    {0x67452301U, 0xefcdab89U, 0x98badcfeU, 0x10325476U, 0xc3d2e1f0U}
+};
+
+static const MB_HASH mb_sha224 = {
+    sha256_multi_block, 7,
+    {0xc1059ed8U, 0x367cd507U, 0x3070dd17U, 0xf70e5939U,
+     0xffc00b31U, 0x68581511U, 0x64f98fa7U, 0xbefa4fa4U}
+};
+
+static const MB_HASH mb_sha256 = {
+    sha256_multi_block, 8,
+    {0x6a09e667U, 0xbb67ae85U, 0x3c6ef372U, 0xa54ff53aU,
+     0x510e527fU, 0x9b05688cU, 0x1f83d9abU, 0x5be0cd19U}
+};
+
+/* A stream and the message it is hashing */
+typedef struct {
+    size_t msg;
+    const unsigned char *ptr;
+    size_t blocks;
+    /* Set once |ptr| points at the padded end of the message in |tail| */
+    int last;
+    unsigned char tail[2 * SHA_CBLOCK];
+} MB_LANE;
+
+/* Point |lane| at the last, padded, one or two blocks of its message */
+static void mb_lane_pad(MB_LANE *lane, const unsigned char *data,
+                        size_t count)
+{
+    size_t rem = count % SHA_CBLOCK, n = rem < SHA_CBLOCK - 8 ? 1 : 2;
+    size_t bits = count << 3;
+    unsigned char *p = lane->tail + n * SHA_CBLOCK;
+    int i;
+
+    if (rem != 0)
+        memcpy(lane->tail, data + count - rem, rem);
+    lane->tail[rem] = 0x80;
+    memset(lane->tail + rem + 1, 0, n * SHA_CBLOCK - rem - 1);
+    for (i = 1; i <= 8; i++, bits >>= 8)
+        p[-i] = (unsigned char)bits;
+    lane->ptr = lane->tail;
+    lane->blocks = n;
+    lane->last = 1;
+}
+
+static void mb_lane_start(const MB_HASH *hash, SHA_MB_CTX *ctx,
+                          MB_LANE *lane, int i, size_t msg,
+                          const unsigned char **data, const size_t *count)
+{
+    int w;
+
+    for (w = 0; w < 8; w++)
+        ctx->h[w][i] = hash->iv[w];
+    lane->msg = msg;
+    lane->ptr = data[msg];
+    lane->blocks = count[msg] / SHA_CBLOCK;
+    lane->last = 0;
+    if (lane->blocks == 0)
+        mb_lane_pad(lane, data[msg], count[msg]);
+}
+
+static void mb_digest_batch(const MB_HASH *hash,
+                            const unsigned char **data, const size_t *count,
+                            unsigned char **md, size_t num)
+{
+    unsigned char storage[sizeof(SHA_MB_CTX) + 32];
+    SHA_MB_CTX *ctx;
+    HASH_DESC desc[8];
+    MB_LANE lane[8];
+    size_t next = 0, n;
+    int lanes = num > 4 ? 8 : 4, active, i, j, w;
+
+    ctx = (SHA_MB_CTX *)(storage + 32 - ((size_t)storage % 32)); /* align */
+
+    for (i = 0; i < lanes; i++) {
+        if (next < num)
+            mb_lane_start(hash, ctx, &lane[i], i, next++, data, count);
+        else
+            lane[i].blocks = 0;
+    }
+
+    /*
+     * Every pass hashes up to MB_CHUNK blocks of each stream. A stream that
+     * finishes its message moves on to the next one, so that streams are
+     * not left idle while a long message is hashed in another.
+     */
+    for (;;) {
+        active = 0;
+        for (i = 0; i < lanes; i++) {
+            n = lane[i].blocks < MB_CHUNK ? lane[i].blocks : MB_CHUNK;
+            desc[i].ptr = lane[i].ptr;
+            desc[i].blocks = (int)n;
+            active |= n != 0;
+        }
+        if (!active)
+            break;
+
+        hash->block(ctx, desc, lanes / 4);
+
+        for (i = 0; i < lanes; i++) {
+            if ((n = desc[i].blocks) == 0)
+                continue;
+            lane[i].ptr += n * SHA_CBLOCK;
+            if ((lane[i].blocks -= n) != 0)
+                continue;
+            if (!lane[i].last) {
+                mb_lane_pad(&lane[i], data[lane[i].msg], count[lane[i].msg]);
+                continue;
+            }
+            for (w = 0; w < hash->md_words; w++) {
+                unsigned char *out = md[lane[i].msg] + 4 * w;
+                unsigned int h = ctx->h[w][i];
+
+                out[0] = (unsigned char)(h >> 24);
+                out[1] = (unsigned char)(h >> 16);
+                out[2] = (unsigned char)(h >> 8);
+                out[3] = (unsigned char)h;
+            }
+            if (next < num)
+                mb_lane_start(hash, ctx, &lane[i], i, next++, data, count);
+        }
+
+        /*
+         * Once there is nothing left to start, keep the busy streams at the
+         * front: the SHA extension code path stops at the first idle pair
+         * of streams.
+         */
+        if (next == num) {
+            for (i = 0, j = lanes - 1; i < j; i++) {
+                if (lane[i].blocks != 0)
+                    continue;
+                while (j > i && lane[j].blocks == 0)
+                    j--;
+                if (j == i)
+                    break;
+                for (w = 0; w < 8; w++)
+                    ctx->h[w][i] = ctx->h[w][j];
+                lane[i] = lane[j];
+                if (lane[i].last)
+                    lane[i].ptr = lane[i].tail + (lane[j].ptr - lane[j].tail);
+                lane[j].blocks = 0;
+            }
+        }
+    }
+
+    OPENSSL_cleanse(storage, sizeof(storage));
+    OPENSSL_cleanse(lane, sizeof(lane));
+}
+
+int sha1_digest_batch(const unsigned char **data, const size_t *count,
+                      unsigned char **md, size_t num)
+{
+    size_t i;
+
+    if (num >= MB_MIN_NUM)
+        mb_digest_batch(&mb_sha1, data, count, md, num);
+    else
+        for (i = 0; i < num; i++)
+            SHA1(data[i], count[i], md[i]);
+    return 1;
+}
+
+int sha224_digest_batch(const unsigned char **data, const size_t *count,
+                        unsigned char **md, size_t num)
+{
+    size_t i;
+
+    if (num >= MB_MIN_NUM)
+        mb_digest_batch(&mb_sha224, data, count, md, num);
+    else
+        for (i = 0; i < num; i++)
+            SHA224(data[i], count[i], md[i]);
+    return 1;
+}
+
+int sha256_digest_batch(const unsigned char **data, const size_t *count,
+                        unsigned char **md, size_t num)
+{
+    size_t i;
+
+    if (num >= MB_MIN_NUM)
+        mb_digest_batch(&mb_sha256, data, count, md, num);
+    else
+        for (i = 0; i < num; i++)
+            SHA256(data[i], count[i], md[i]);
+    return 1;
+}
+
+#else
+static void *dummy = &dummy;
+#endif
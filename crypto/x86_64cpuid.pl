@@ -168,13 +168,17 @@ OPENSSL_ia32_cpuid:
 	jnc	.Lclear_avx
 	xor	%ecx,%ecx		# XCR0
 	.byte	0x0f,0x01,0xd0		# xgetbv
+	and	\$0xe6,%eax		# isolate XMM, YMM and ZMM state support
+	cmp	\$0xe6,%eax
+	je	.Ldone
+	andl	\$0x23dcffff,8(%rdi)	# clear AVX512F, DQ, IFMA, PF, ER, CD, BW, VL
 	and	\$6,%eax		# isolate XMM and YMM state support
 	cmp	\$6,%eax
 	je	.Ldone
 .Lclear_avx:
 	mov	\$0xefffe7ff,%eax	# ~(1<<28|1<<12|1<<11)
 	and	%eax,%r9d		# clear AVX, FMA and AMD XOP bits
-	andl	\$0xffffffdf,8(%rdi)	# cleax AVX2, ~(1<<5)
+	andl	\$0x23dcffdf,8(%rdi)	# clear AVX2 and AVX512, ~(1<<5|...)
 .Ldone:
 	shl	\$32,%r9
 	mov	%r10d,%eax
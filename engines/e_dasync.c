@@ -0,0 +1,326 @@
+/* engines/e_dasync.c */
+/* ====================================================================
+ * Copyright (c) 2015 The OpenSSL Project.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. All advertising materials mentioning features or use of this
+ *    software must display the following acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit. (http://www.openssl.org/)"
+ *
+ * 4. The names "OpenSSL Toolkit" and "OpenSSL Project" must not be used to
+ *    endorse or promote products derived from this software without
+ *    prior written permission. For written permission, please contact
+ *    openssl-core@openssl.org.
+ *
+ * 5. Products derived from this software may not be called "OpenSSL"
+ *    nor may "OpenSSL" appear in their names without prior written
+ *    permission of the OpenSSL Project.
+ *
+ * 6. Redistributions of any form whatsoever must retain the following
+ *    acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit (http://www.openssl.org/)"
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE OpenSSL PROJECT ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE OpenSSL PROJECT OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ====================================================================
+ */
+
+/*
+ * This is a test ENGINE for the ASYNC job framework. It does not implement
+ * any cryptography itself: its RSA methods call the builtin software ones,
+ * but before doing so they simulate a slow device by pausing the current
+ * job (see ASYNC_start_job(3)) until a configurable delay has expired. When
+ * called outside of a job the delay is simply slept through, which is how
+ * the same ENGINE would behave for a blocking application.
+ *
+ * Use the "DELAY" control command to set the latency in milliseconds. With
+ * the default of 0 each operation still pauses once, which is enough to run
+ * every code path of an asynchronous handshake without slowing it down.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <openssl/crypto.h>
+#include <openssl/engine.h>
+#include <openssl/async.h>
+#include <openssl/bn.h>
+#ifndef OPENSSL_NO_RSA
+# include <openssl/rsa.h>
+#endif
+
+#ifdef OPENSSL_SYS_UNIX
+# include <sys/time.h>
+# include <unistd.h>
+#endif
+
+#define DASYNC_LIB_NAME "dasync engine"
+#include "e_dasync_err.c"
+
+static int dasync_destroy(ENGINE *e);
+static int dasync_init(ENGINE *e);
+static int dasync_finish(ENGINE *e);
+static int dasync_ctrl(ENGINE *e, int cmd, long i, void *p, void (*f) (void));
+
+#ifndef OPENSSL_NO_RSA
+static int dasync_pub_enc(int flen, const unsigned char *from,
+                          unsigned char *to, RSA *rsa, int padding);
+static int dasync_pub_dec(int flen, const unsigned char *from,
+                          unsigned char *to, RSA *rsa, int padding);
+static int dasync_rsa_priv_enc(int flen, const unsigned char *from,
+                               unsigned char *to, RSA *rsa, int padding);
+static int dasync_rsa_priv_dec(int flen, const unsigned char *from,
+                               unsigned char *to, RSA *rsa, int padding);
+static int dasync_rsa_mod_exp(BIGNUM *r0, const BIGNUM *I, RSA *rsa,
+                              BN_CTX *ctx);
+static int dasync_rsa_init(RSA *rsa);
+static int dasync_rsa_finish(RSA *rsa);
+#endif
+
+/* The definitions for control commands specific to this engine */
+#define DASYNC_CMD_DELAY                ENGINE_CMD_BASE
+static const ENGINE_CMD_DEFN dasync_cmd_defns[] = {
+    {DASYNC_CMD_DELAY,
+     "DELAY",
+     "Simulated latency of each operation in milliseconds",
+     ENGINE_CMD_FLAG_NUMERIC},
+    {0, NULL, NULL, 0}
+};
+
+/* Simulated latency in milliseconds */
+static long dasync_delay = 0;
+
+#ifndef OPENSSL_NO_RSA
+static RSA_METHOD dasync_rsa = {
+    "Dummy Async RSA method",
+    dasync_pub_enc,             /* pub_enc */
+    dasync_pub_dec,             /* pub_dec */
+    dasync_rsa_priv_enc,        /* priv_enc */
+    dasync_rsa_priv_dec,        /* priv_dec */
+    dasync_rsa_mod_exp,         /* rsa_mod_exp */
+    BN_mod_exp_mont,            /* bn_mod_exp */
+    dasync_rsa_init,            /* init */
+    dasync_rsa_finish,          /* finish */
+    RSA_FLAG_CACHE_PUBLIC | RSA_FLAG_CACHE_PRIVATE, /* flags */
+    NULL,                       /* app_data */
+    0,                          /* rsa_sign */
+    0,                          /* rsa_verify */
+    NULL                        /* rsa_keygen */
+};
+#endif
+
+/* Constants used when creating the ENGINE */
+static const char *engine_dasync_id = "dasync";
+static const char *engine_dasync_name = "Dummy Async engine support";
+
+static int bind_dasync(ENGINE *e)
+{
+    if (!ENGINE_set_id(e, engine_dasync_id)
+        || !ENGINE_set_name(e, engine_dasync_name)
+#ifndef OPENSSL_NO_RSA
+        || !ENGINE_set_RSA(e, &dasync_rsa)
+#endif
+        || !ENGINE_set_destroy_function(e, dasync_destroy)
+        || !ENGINE_set_init_function(e, dasync_init)
+        || !ENGINE_set_finish_function(e, dasync_finish)
+        || !ENGINE_set_ctrl_function(e, dasync_ctrl)
+        || !ENGINE_set_cmd_defns(e, dasync_cmd_defns)
+        /* Only ever used when asked for explicitly */
+        || !ENGINE_set_flags(e, ENGINE_FLAGS_NO_REGISTER_ALL)) {
+        DASYNCerr(DASYNC_F_BIND_DASYNC, DASYNC_R_INIT_FAILED);
+        return 0;
+    }
+
+    /* Ensure the dasync error handling is set up */
+    ERR_load_DASYNC_strings();
+    return 1;
+}
+
+#ifndef OPENSSL_NO_DYNAMIC_ENGINE
+static int bind_helper(ENGINE *e, const char *id)
+{
+    if (id && (strcmp(id, engine_dasync_id) != 0))
+        return 0;
+    if (!bind_dasync(e))
+        return 0;
+    return 1;
+}
+
+IMPLEMENT_DYNAMIC_CHECK_FN()
+    IMPLEMENT_DYNAMIC_BIND_FN(bind_helper)
+#endif
+
+static ENGINE *engine_dasync(void)
+{
+    ENGINE *ret = ENGINE_new();
+    if (!ret)
+        return NULL;
+    if (!bind_dasync(ret)) {
+        ENGINE_free(ret);
+        return NULL;
+    }
+    return ret;
+}
+
+void ENGINE_load_dasync(void)
+{
+    ENGINE *toadd = engine_dasync();
+    if (!toadd)
+        return;
+    ENGINE_add(toadd);
+    ENGINE_free(toadd);
+    ERR_clear_error();
+}
+
+static int dasync_init(ENGINE *e)
+{
+    return 1;
+}
+
+static int dasync_finish(ENGINE *e)
+{
+    return 1;
+}
+
+static int dasync_destroy(ENGINE *e)
+{
+    ERR_unload_DASYNC_strings();
+    return 1;
+}
+
+static int dasync_ctrl(ENGINE *e, int cmd, long i, void *p, void (*f) (void))
+{
+    switch (cmd) {
+    case DASYNC_CMD_DELAY:
+        if (i < 0) {
+            DASYNCerr(DASYNC_F_DASYNC_CTRL, DASYNC_R_INVALID_DELAY);
+            return 0;
+        }
+        dasync_delay = i;
+        return 1;
+    default:
+        break;
+    }
+    DASYNCerr(DASYNC_F_DASYNC_CTRL, DASYNC_R_CTRL_COMMAND_NOT_IMPLEMENTED);
+    return 0;
+}
+
+#ifdef OPENSSL_SYS_UNIX
+/* Milliseconds elapsed since |start| */
+static long dasync_elapsed(const struct timeval *start)
+{
+    struct timeval now;
+
+    gettimeofday(&now, NULL);
+    return (long)(now.tv_sec - start->tv_sec) * 1000
+        + (now.tv_usec - start->tv_usec) / 1000;
+}
+#endif
+
+/*
+ * Wait for the simulated device. Inside a job the wait fd is signalled and
+ * the job paused, so the application gets SSL_ERROR_WANT_ASYNC (or
+ * ASYNC_PAUSE) and the operation carries on when it calls us again. A real
+ * device would signal the fd from its completion handler instead.
+ */
+static void dasync_wait(void)
+{
+    ASYNC_JOB *job = ASYNC_get_current_job();
+#ifdef OPENSSL_SYS_UNIX
+    struct timeval start;
+
+    gettimeofday(&start, NULL);
+#endif
+
+    if (job == NULL) {
+#ifdef OPENSSL_SYS_UNIX
+        if (dasync_delay > 0)
+            usleep(dasync_delay * 1000);
+#endif
+        return;
+    }
+
+    do {
+        ASYNC_wake(job);
+        if (!ASYNC_pause_job()) {
+            /* The job is being abandoned, there is no point in waiting */
+            ASYNC_clear_wake(job);
+            return;
+        }
+        ASYNC_clear_wake(job);
+#ifdef OPENSSL_SYS_UNIX
+    } while (dasync_elapsed(&start) < dasync_delay);
+#else
+    } while (0);
+#endif
+}
+
+#ifndef OPENSSL_NO_RSA
+
+static int dasync_pub_enc(int flen, const unsigned char *from,
+                          unsigned char *to, RSA *rsa, int padding)
+{
+    dasync_wait();
+    return RSA_PKCS1_SSLeay()->rsa_pub_enc(flen, from, to, rsa, padding);
+}
+
+static int dasync_pub_dec(int flen, const unsigned char *from,
+                          unsigned char *to, RSA *rsa, int padding)
+{
+    dasync_wait();
+    return RSA_PKCS1_SSLeay()->rsa_pub_dec(flen, from, to, rsa, padding);
+}
+
+static int dasync_rsa_priv_enc(int flen, const unsigned char *from,
+                               unsigned char *to, RSA *rsa, int padding)
+{
+    dasync_wait();
+    return RSA_PKCS1_SSLeay()->rsa_priv_enc(flen, from, to, rsa, padding);
+}
+
+static int dasync_rsa_priv_dec(int flen, const unsigned char *from,
+                               unsigned char *to, RSA *rsa, int padding)
+{
+    dasync_wait();
+    return RSA_PKCS1_SSLeay()->rsa_priv_dec(flen, from, to, rsa, padding);
+}
+
+static int dasync_rsa_mod_exp(BIGNUM *r0, const BIGNUM *I, RSA *rsa,
+                              BN_CTX *ctx)
+{
+    return RSA_PKCS1_SSLeay()->rsa_mod_exp(r0, I, rsa, ctx);
+}
+
+static int dasync_rsa_init(RSA *rsa)
+{
+    return RSA_PKCS1_SSLeay()->init(rsa);
+}
+
+static int dasync_rsa_finish(RSA *rsa)
+{
+    return RSA_PKCS1_SSLeay()->finish(rsa);
+}
+
+#endif
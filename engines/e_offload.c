@@ -0,0 +1,833 @@
+/* engines/e_offload.c */
+/* ====================================================================
+ * Copyright (c) 2015 The OpenSSL Project.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. All advertising materials mentioning features or use of this
+ *    software must display the following acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit. (http://www.openssl.org/)"
+ *
+ * 4. The names "OpenSSL Toolkit" and "OpenSSL Project" must not be used to
+ *    endorse or promote products derived from this software without
+ *    prior written permission. For written permission, please contact
+ *    openssl-core@openssl.org.
+ *
+ * 5. Products derived from this software may not be called "OpenSSL"
+ *    nor may "OpenSSL" appear in their names without prior written
+ *    permission of the OpenSSL Project.
+ *
+ * 6. Redistributions of any form whatsoever must retain the following
+ *    acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit (http://www.openssl.org/)"
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE OpenSSL PROJECT ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE OpenSSL PROJECT OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ====================================================================
+ */
+
+/*
+ * This ENGINE moves RSA and ECDSA private key operations off the calling
+ * thread. Operations started inside an ASYNC_JOB (for example by an SSL
+ * object in SSL_MODE_ASYNC) are queued to a pool of worker threads and the
+ * job is paused; the worker wakes the job through its wait fd once the
+ * result is ready. An event driven server can thus keep its I/O threads
+ * busy with other connections while the key operations keep the remaining
+ * cores saturated. Outside of a job, or while the job cannot pause, there is
+ * nothing to gain from another thread, so operations are simply run by the
+ * caller.
+ *
+ * Workers take queued operations in batches of up to BATCH_SIZE. With a
+ * non-zero BATCH_WINDOW a worker that finds fewer operations waits up to
+ * that many microseconds for more to arrive, trading latency for the
+ * throughput of implementations that process several operations at once:
+ * the RSA private key operations of a batch are handed to the builtin
+ * implementation together, see RSA_private_encrypt_batch(3).
+ *
+ * The worker threads use the keys concurrently with the rest of the
+ * application, so locking callbacks must have been set up with
+ * CRYPTO_set_locking_callback() before the ENGINE is initialised.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <openssl/crypto.h>
+#include <openssl/engine.h>
+#include <openssl/async.h>
+#include <openssl/err.h>
+#include <openssl/bn.h>
+#ifndef OPENSSL_NO_RSA
+# include <openssl/rsa.h>
+#endif
+#ifndef OPENSSL_NO_ECDSA
+# include <openssl/ecdsa.h>
+#endif
+
+#if defined(OPENSSL_THREADS) && defined(OPENSSL_SYS_UNIX) \
+    && !defined(OPENSSL_NO_ASYNC)
+# define COMPILE_OFFLOAD
+#endif
+
+#ifdef COMPILE_OFFLOAD
+
+# include <pthread.h>
+# include <errno.h>
+# include <sys/time.h>
+# include <unistd.h>
+
+# define OFFLOAD_LIB_NAME "offload engine"
+# include "e_offload_err.c"
+
+static int offload_destroy(ENGINE *e);
+static int offload_init(ENGINE *e);
+static int offload_finish(ENGINE *e);
+static int offload_ctrl(ENGINE *e, int cmd, long i, void *p,
+                        void (*f) (void));
+
+# ifndef OPENSSL_NO_RSA
+static int offload_rsa_priv_enc(int flen, const unsigned char *from,
+                                unsigned char *to, RSA *rsa, int padding);
+static int offload_rsa_priv_dec(int flen, const unsigned char *from,
+                                unsigned char *to, RSA *rsa, int padding);
+# endif
+# ifndef OPENSSL_NO_ECDSA
+static ECDSA_SIG *offload_ecdsa_do_sign(const unsigned char *dgst, int dlen,
+                                        const BIGNUM *inv, const BIGNUM *rp,
+                                        EC_KEY *eckey);
+# endif
+
+/* The definitions for control commands specific to this engine */
+# define OFFLOAD_CMD_THREADS             ENGINE_CMD_BASE
+# define OFFLOAD_CMD_BATCH_SIZE          (ENGINE_CMD_BASE + 1)
+# define OFFLOAD_CMD_BATCH_WINDOW        (ENGINE_CMD_BASE + 2)
+static const ENGINE_CMD_DEFN offload_cmd_defns[] = {
+    {OFFLOAD_CMD_THREADS,
+     "THREADS",
+     "Number of worker threads (default: number of online CPUs)",
+     ENGINE_CMD_FLAG_NUMERIC},
+    {OFFLOAD_CMD_BATCH_SIZE,
+     "BATCH_SIZE",
+     "Maximum number of operations a worker takes at once",
+     ENGINE_CMD_FLAG_NUMERIC},
+    {OFFLOAD_CMD_BATCH_WINDOW,
+     "BATCH_WINDOW",
+     "Microseconds a worker waits for a batch to fill up",
+     ENGINE_CMD_FLAG_NUMERIC},
+    {0, NULL, NULL, 0}
+};
+
+# define OFFLOAD_MAX_THREADS     256
+# define OFFLOAD_MAX_BATCH       64
+# define OFFLOAD_DEFAULT_BATCH   8
+
+# define OFFLOAD_OP_RSA_PRIV_ENC 1
+# define OFFLOAD_OP_RSA_PRIV_DEC 2
+# define OFFLOAD_OP_ECDSA_SIGN   3
+
+/*
+ * A queued operation. It owns copies of its input, its output buffer and
+ * references to its key rather than pointing into the job that submitted
+ * it, which may be abandoned with ASYNC_free_job(). The submitter and,
+ * while it is queued or running, a worker each hold a reference.
+ */
+typedef struct offload_op_st {
+    int type;
+    int references;
+    /* RSA */
+    int flen;
+    unsigned char *from;
+    unsigned char *to;
+    int tlen;
+    RSA *rsa;
+    int padding;
+    /* ECDSA */
+    unsigned char *dgst;
+    int dlen;
+    BIGNUM *inv, *rp;
+    EC_KEY *eckey;
+    ECDSA_SIG *sig;
+    /* Results */
+    int ret;
+    unsigned long err;
+    ASYNC_JOB *job;
+    int queued;
+    int done;
+    struct offload_op_st *next;
+} OFFLOAD_OP;
+
+/* The queue and everything else shared with the workers */
+static pthread_mutex_t offload_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t offload_cond = PTHREAD_COND_INITIALIZER;
+/* Signalled when an operation of an abandoned job is done */
+static pthread_cond_t offload_done_cond = PTHREAD_COND_INITIALIZER;
+static OFFLOAD_OP *offload_head = NULL, *offload_tail = NULL;
+static int offload_queued = 0;
+static int offload_stop = 0;
+static pthread_t offload_workers[OFFLOAD_MAX_THREADS];
+static int offload_nworkers = 0;
+
+/* Settings */
+static long offload_threads = 0;
+static long offload_batch_size = OFFLOAD_DEFAULT_BATCH;
+static long offload_batch_window = 0;
+
+# ifndef OPENSSL_NO_RSA
+static RSA_METHOD offload_rsa = {
+    "Worker thread offload RSA method",
+    NULL,                       /* pub_enc */
+    NULL,                       /* pub_dec */
+    offload_rsa_priv_enc,       /* priv_enc */
+    offload_rsa_priv_dec,       /* priv_dec */
+    NULL,                       /* rsa_mod_exp */
+    NULL,                       /* bn_mod_exp */
+    NULL,                       /* init */
+    NULL,                       /* finish */
+    0,                          /* flags */
+    NULL,                       /* app_data */
+    0,                          /* rsa_sign */
+    0,                          /* rsa_verify */
+    NULL                        /* rsa_keygen */
+};
+# endif
+
+# ifndef OPENSSL_NO_ECDSA
+static ECDSA_METHOD *offload_ecdsa = NULL;
+static ECDSA_SIG *(*soft_ecdsa_do_sign) (const unsigned char *dgst,
+                                         int dlen, const BIGNUM *inv,
+                                         const BIGNUM *rp,
+                                         EC_KEY *eckey) = NULL;
+# endif
+
+/* Constants used when creating the ENGINE */
+static const char *engine_offload_id = "offload";
+static const char *engine_offload_name = "Worker thread offload engine";
+
+static int bind_offload(ENGINE *e)
+{
+# ifndef OPENSSL_NO_RSA
+    const RSA_METHOD *meth1;
+# endif
+
+# ifndef OPENSSL_NO_ECDSA
+    if (offload_ecdsa == NULL) {
+        offload_ecdsa = ECDSA_METHOD_new((ECDSA_METHOD *)ECDSA_OpenSSL());
+        if (offload_ecdsa == NULL) {
+            OFFLOADerr(OFFLOAD_F_BIND_OFFLOAD, OFFLOAD_R_INIT_FAILED);
+            return 0;
+        }
+        ECDSA_METHOD_set_name(offload_ecdsa,
+                              "Worker thread offload ECDSA method");
+        ECDSA_METHOD_get_sign(ECDSA_OpenSSL(), &soft_ecdsa_do_sign);
+        ECDSA_METHOD_set_sign(offload_ecdsa, offload_ecdsa_do_sign);
+    }
+# endif
+
+    if (!ENGINE_set_id(e, engine_offload_id)
+        || !ENGINE_set_name(e, engine_offload_name)
+# ifndef OPENSSL_NO_RSA
+        || !ENGINE_set_RSA(e, &offload_rsa)
+# endif
+# ifndef OPENSSL_NO_ECDSA
+        || !ENGINE_set_ECDSA(e, offload_ecdsa)
+# endif
+        || !ENGINE_set_destroy_function(e, offload_destroy)
+        || !ENGINE_set_init_function(e, offload_init)
+        || !ENGINE_set_finish_function(e, offload_finish)
+        || !ENGINE_set_ctrl_function(e, offload_ctrl)
+        || !ENGINE_set_cmd_defns(e, offload_cmd_defns)
+        /* Starts threads, so only when asked for explicitly */
+        || !ENGINE_set_flags(e, ENGINE_FLAGS_NO_REGISTER_ALL)) {
+        OFFLOADerr(OFFLOAD_F_BIND_OFFLOAD, OFFLOAD_R_INIT_FAILED);
+        return 0;
+    }
+
+# ifndef OPENSSL_NO_RSA
+    /* Public key operations are cheap, keep them in the caller */
+    meth1 = RSA_PKCS1_SSLeay();
+    offload_rsa.rsa_pub_enc = meth1->rsa_pub_enc;
+    offload_rsa.rsa_pub_dec = meth1->rsa_pub_dec;
+    offload_rsa.rsa_mod_exp = meth1->rsa_mod_exp;
+    offload_rsa.bn_mod_exp = meth1->bn_mod_exp;
+    offload_rsa.init = meth1->init;
+    offload_rsa.finish = meth1->finish;
+    offload_rsa.flags = meth1->flags;
+# endif
+
+    /* Ensure the offload error handling is set up */
+    ERR_load_OFFLOAD_strings();
+    return 1;
+}
+
+# ifndef OPENSSL_NO_DYNAMIC_ENGINE
+static int bind_helper(ENGINE *e, const char *id)
+{
+    if (id && (strcmp(id, engine_offload_id) != 0))
+        return 0;
+    if (!bind_offload(e))
+        return 0;
+    return 1;
+}
+
+IMPLEMENT_DYNAMIC_CHECK_FN()
+    IMPLEMENT_DYNAMIC_BIND_FN(bind_helper)
+# endif
+
+static ENGINE *engine_offload(void)
+{
+    ENGINE *ret = ENGINE_new();
+    if (!ret)
+        return NULL;
+    if (!bind_offload(ret)) {
+        ENGINE_free(ret);
+        return NULL;
+    }
+    return ret;
+}
+
+void ENGINE_load_offload(void)
+{
+    ENGINE *toadd = engine_offload();
+    if (!toadd)
+        return;
+    ENGINE_add(toadd);
+    ENGINE_free(toadd);
+    ERR_clear_error();
+}
+
+static int offload_destroy(ENGINE *e)
+{
+# ifndef OPENSSL_NO_ECDSA
+    ECDSA_METHOD_free(offload_ecdsa);
+    offload_ecdsa = NULL;
+# endif
+    ERR_unload_OFFLOAD_strings();
+    return 1;
+}
+
+static OFFLOAD_OP *offload_op_new(int type)
+{
+    OFFLOAD_OP *op;
+
+    op = OPENSSL_malloc(sizeof(*op));
+    if (op == NULL) {
+        OFFLOADerr(OFFLOAD_F_OFFLOAD_OP_NEW, ERR_R_MALLOC_FAILURE);
+        return NULL;
+    }
+    memset(op, 0, sizeof(*op));
+    op->type = type;
+    op->references = 1;
+    op->ret = -1;
+    return op;
+}
+
+static void offload_op_free(OFFLOAD_OP *op)
+{
+    OPENSSL_free(op->from);
+    if (op->to != NULL) {
+        OPENSSL_cleanse(op->to, op->tlen);
+        OPENSSL_free(op->to);
+    }
+    OPENSSL_free(op->dgst);
+# ifndef OPENSSL_NO_RSA
+    RSA_free(op->rsa);
+# endif
+# ifndef OPENSSL_NO_ECDSA
+    BN_clear_free(op->inv);
+    BN_clear_free(op->rp);
+    EC_KEY_free(op->eckey);
+    ECDSA_SIG_free(op->sig);
+# endif
+    OPENSSL_free(op);
+}
+
+/*
+ * Drop a reference to |op|, freeing it with the last one. Freeing drops the
+ * key, which may hold the last functional reference to the ENGINE, so only
+ * the submitter may do that: offload_finish() joins the workers.
+ */
+static void offload_op_unref(OFFLOAD_OP *op)
+{
+    int i;
+
+    pthread_mutex_lock(&offload_lock);
+    i = --op->references;
+    pthread_mutex_unlock(&offload_lock);
+    if (i == 0)
+        offload_op_free(op);
+}
+
+/* Run a single operation with the builtin implementation */
+static void offload_run(OFFLOAD_OP *op)
+{
+    switch (op->type) {
+# ifndef OPENSSL_NO_RSA
+    case OFFLOAD_OP_RSA_PRIV_ENC:
+        op->ret = RSA_PKCS1_SSLeay()->rsa_priv_enc(op->flen, op->from, op->to,
+                                                   op->rsa, op->padding);
+        break;
+    case OFFLOAD_OP_RSA_PRIV_DEC:
+        op->ret = RSA_PKCS1_SSLeay()->rsa_priv_dec(op->flen, op->from, op->to,
+                                                   op->rsa, op->padding);
+        break;
+# endif
+# ifndef OPENSSL_NO_ECDSA
+    case OFFLOAD_OP_ECDSA_SIGN:
+        op->sig = soft_ecdsa_do_sign(op->dgst, op->dlen, op->inv, op->rp,
+                                     op->eckey);
+        break;
+# endif
+    }
+}
+
+# ifndef OPENSSL_NO_RSA
+/*
+ * Run the RSA operations of type |type| in |ops| with a single call to the
+ * batch function of the builtin implementation, marking them in |done|.
+ * The error queue of such a call cannot be split up, so each failed
+ * operation is given the last error.
+ */
+static void offload_run_rsa_batch(OFFLOAD_OP **ops, int n, int type,
+                                  int *done)
+{
+    const RSA_METHOD *meth = RSA_PKCS1_SSLeay();
+    const unsigned char *from[OFFLOAD_MAX_BATCH];
+    unsigned char *to[OFFLOAD_MAX_BATCH];
+    RSA *rsa[OFFLOAD_MAX_BATCH];
+    int flen[OFFLOAD_MAX_BATCH], padding[OFFLOAD_MAX_BATCH];
+    int ret[OFFLOAD_MAX_BATCH], idx[OFFLOAD_MAX_BATCH];
+    int i, k = 0;
+
+    for (i = 0; i < n; i++) {
+        if (ops[i]->type != type)
+            continue;
+        flen[k] = ops[i]->flen;
+        from[k] = ops[i]->from;
+        to[k] = ops[i]->to;
+        rsa[k] = ops[i]->rsa;
+        padding[k] = ops[i]->padding;
+        idx[k++] = i;
+    }
+    if (k < 2)
+        return;
+
+    if (type == OFFLOAD_OP_RSA_PRIV_ENC)
+        meth->rsa_priv_enc_batch(k, flen, from, to, rsa, padding, ret);
+    else
+        meth->rsa_priv_dec_batch(k, flen, from, to, rsa, padding, ret);
+    for (i = 0; i < k; i++) {
+        ops[idx[i]]->ret = ret[i];
+        ops[idx[i]]->err = ret[i] < 0 ? ERR_peek_last_error() : 0;
+        done[idx[i]] = 1;
+    }
+    ERR_clear_error();
+}
+# endif
+
+/*
+ * Run a batch of operations taken from the queue. Errors are recorded so
+ * that they can be raised again in the thread that asked for the operation.
+ */
+static void offload_run_batch(OFFLOAD_OP **ops, int n)
+{
+    int i, done[OFFLOAD_MAX_BATCH];
+
+    memset(done, 0, sizeof(done));
+# ifndef OPENSSL_NO_RSA
+    offload_run_rsa_batch(ops, n, OFFLOAD_OP_RSA_PRIV_ENC, done);
+    offload_run_rsa_batch(ops, n, OFFLOAD_OP_RSA_PRIV_DEC, done);
+# endif
+
+    for (i = 0; i < n; i++) {
+        if (done[i])
+            continue;
+        offload_run(ops[i]);
+        ops[i]->err = ERR_peek_last_error();
+        ERR_clear_error();
+    }
+}
+
+static void offload_deadline(struct timespec *ts, long usec)
+{
+    struct timeval now;
+
+    gettimeofday(&now, NULL);
+    usec += now.tv_usec;
+    ts->tv_sec = now.tv_sec + usec / 1000000;
+    ts->tv_nsec = (usec % 1000000) * 1000;
+}
+
+static void *offload_worker(void *arg)
+{
+    OFFLOAD_OP *batch[OFFLOAD_MAX_BATCH];
+    struct timespec deadline;
+    int i, n, max;
+
+    pthread_mutex_lock(&offload_lock);
+    for (;;) {
+        while (offload_head == NULL && !offload_stop)
+            pthread_cond_wait(&offload_cond, &offload_lock);
+        if (offload_head == NULL)
+            break;
+
+        max = (int)offload_batch_size;
+        if (offload_batch_window > 0 && offload_queued < max) {
+            offload_deadline(&deadline, offload_batch_window);
+            while (offload_queued < max && !offload_stop
+                   && pthread_cond_timedwait(&offload_cond, &offload_lock,
+                                             &deadline) != ETIMEDOUT)
+                continue;
+            /* Another worker may have emptied the queue meanwhile */
+            if (offload_head == NULL)
+                continue;
+        }
+
+        for (n = 0; n < max && offload_head != NULL; n++) {
+            batch[n] = offload_head;
+            batch[n]->queued = 0;
+            offload_head = offload_head->next;
+        }
+        if (offload_head == NULL)
+            offload_tail = NULL;
+        offload_queued -= n;
+        pthread_mutex_unlock(&offload_lock);
+
+        offload_run_batch(batch, n);
+
+        pthread_mutex_lock(&offload_lock);
+        for (i = 0; i < n; i++) {
+            /*
+             * The submitter only lets go of the operation once it has seen
+             * |done|, so this is never the last reference
+             */
+            batch[i]->done = 1;
+            batch[i]->references--;
+            if (batch[i]->job != NULL)
+                ASYNC_wake(batch[i]->job);
+            else
+                pthread_cond_broadcast(&offload_done_cond);
+        }
+    }
+    pthread_mutex_unlock(&offload_lock);
+
+    ERR_remove_thread_state(NULL);
+    return NULL;
+}
+
+static void offload_stop_workers(void)
+{
+    int i;
+
+    pthread_mutex_lock(&offload_lock);
+    offload_stop = 1;
+    pthread_cond_broadcast(&offload_cond);
+    pthread_mutex_unlock(&offload_lock);
+
+    for (i = 0; i < offload_nworkers; i++)
+        pthread_join(offload_workers[i], NULL);
+    offload_nworkers = 0;
+    offload_stop = 0;
+}
+
+static int offload_init(ENGINE *e)
+{
+    long n = offload_threads;
+
+    if (CRYPTO_get_locking_callback() == NULL) {
+        OFFLOADerr(OFFLOAD_F_OFFLOAD_INIT, OFFLOAD_R_NO_LOCKING_CALLBACK);
+        return 0;
+    }
+
+    if (n == 0) {
+# ifdef _SC_NPROCESSORS_ONLN
+        n = sysconf(_SC_NPROCESSORS_ONLN);
+# endif
+        if (n < 1)
+            n = 1;
+        if (n > OFFLOAD_MAX_THREADS)
+            n = OFFLOAD_MAX_THREADS;
+    }
+
+    while (offload_nworkers < n) {
+        if (pthread_create(&offload_workers[offload_nworkers], NULL,
+                           offload_worker, NULL) != 0) {
+            OFFLOADerr(OFFLOAD_F_OFFLOAD_INIT,
+                       OFFLOAD_R_CANNOT_CREATE_THREAD);
+            offload_stop_workers();
+            return 0;
+        }
+        offload_nworkers++;
+    }
+    return 1;
+}
+
+static int offload_finish(ENGINE *e)
+{
+    offload_stop_workers();
+    return 1;
+}
+
+static int offload_ctrl(ENGINE *e, int cmd, long i, void *p,
+                        void (*f) (void))
+{
+    switch (cmd) {
+    case OFFLOAD_CMD_THREADS:
+        if (i < 0 || i > OFFLOAD_MAX_THREADS) {
+            OFFLOADerr(OFFLOAD_F_OFFLOAD_CTRL, OFFLOAD_R_INVALID_ARGUMENT);
+            return 0;
+        }
+        if (offload_nworkers != 0) {
+            OFFLOADerr(OFFLOAD_F_OFFLOAD_CTRL, OFFLOAD_R_ALREADY_INITIALISED);
+            return 0;
+        }
+        offload_threads = i;
+        return 1;
+    case OFFLOAD_CMD_BATCH_SIZE:
+        if (i < 1 || i > OFFLOAD_MAX_BATCH) {
+            OFFLOADerr(OFFLOAD_F_OFFLOAD_CTRL, OFFLOAD_R_INVALID_ARGUMENT);
+            return 0;
+        }
+        pthread_mutex_lock(&offload_lock);
+        offload_batch_size = i;
+        pthread_mutex_unlock(&offload_lock);
+        return 1;
+    case OFFLOAD_CMD_BATCH_WINDOW:
+        if (i < 0 || i > 1000000) {
+            OFFLOADerr(OFFLOAD_F_OFFLOAD_CTRL, OFFLOAD_R_INVALID_ARGUMENT);
+            return 0;
+        }
+        pthread_mutex_lock(&offload_lock);
+        offload_batch_window = i;
+        pthread_mutex_unlock(&offload_lock);
+        return 1;
+    default:
+        break;
+    }
+    OFFLOADerr(OFFLOAD_F_OFFLOAD_CTRL, OFFLOAD_R_CTRL_COMMAND_NOT_IMPLEMENTED);
+    return 0;
+}
+
+/* Take the queued |op| out of the queue, with the lock held */
+static void offload_unqueue(OFFLOAD_OP *op)
+{
+    OFFLOAD_OP *prev = NULL, *cur;
+
+    for (cur = offload_head; cur != op; cur = cur->next)
+        prev = cur;
+    if (prev != NULL)
+        prev->next = op->next;
+    else
+        offload_head = op->next;
+    if (offload_tail == op)
+        offload_tail = prev;
+    offload_queued--;
+    op->queued = 0;
+    op->references--;
+}
+
+/*
+ * Perform |op|: in a worker thread if the current job can pause while it
+ * waits and there are workers, directly otherwise. Blocking a thread on
+ * another would gain nothing. Returns 0 if the job was abandoned before the
+ * operation was done.
+ */
+static int offload_submit(OFFLOAD_OP *op)
+{
+    ASYNC_JOB *job;
+    int done, paused;
+
+    pthread_mutex_lock(&offload_lock);
+    if (!ASYNC_can_pause() || offload_nworkers == 0) {
+        pthread_mutex_unlock(&offload_lock);
+        offload_run(op);
+        return 1;
+    }
+
+    job = ASYNC_get_current_job();
+    op->job = job;
+    op->references++;
+    op->queued = 1;
+    op->done = 0;
+    op->err = 0;
+    op->next = NULL;
+    if (offload_tail != NULL)
+        offload_tail->next = op;
+    else
+        offload_head = op;
+    offload_tail = op;
+    offload_queued++;
+    pthread_cond_signal(&offload_cond);
+    pthread_mutex_unlock(&offload_lock);
+
+    /*
+     * Every round pauses the job until the application resumes it, which
+     * it may do before the wait fd is readable, so check |done| each time.
+     */
+    for (;;) {
+        paused = ASYNC_pause_job();
+        pthread_mutex_lock(&offload_lock);
+        done = op->done;
+        if (done || paused) {
+            pthread_mutex_unlock(&offload_lock);
+            if (done)
+                break;
+            continue;
+        }
+
+        /*
+         * Pausing fails once the job is being abandoned. An operation
+         * still in the queue is taken out of it, one a worker already has
+         * is waited for: it ends with that worker's batch.
+         */
+        if (op->queued)
+            offload_unqueue(op);
+        op->job = NULL;
+        while (op->references > 1)
+            pthread_cond_wait(&offload_done_cond, &offload_lock);
+        pthread_mutex_unlock(&offload_lock);
+        OFFLOADerr(OFFLOAD_F_OFFLOAD_SUBMIT, OFFLOAD_R_OPERATION_ABANDONED);
+        return 0;
+    }
+    ASYNC_clear_wake(job);
+
+    if (op->err != 0)
+        ERR_put_error(ERR_GET_LIB(op->err), ERR_GET_FUNC(op->err),
+                      ERR_GET_REASON(op->err), __FILE__, __LINE__);
+    return 1;
+}
+
+/* Copy of |len| bytes at |p|, never of zero size */
+static unsigned char *offload_memdup(const unsigned char *p, int len)
+{
+    unsigned char *ret;
+
+    ret = OPENSSL_malloc(len > 0 ? len : 1);
+    if (ret != NULL && len > 0)
+        memcpy(ret, p, len);
+    return ret;
+}
+
+# ifndef OPENSSL_NO_RSA
+
+static int offload_rsa_op(int type, int flen, const unsigned char *from,
+                          unsigned char *to, RSA *rsa, int padding)
+{
+    OFFLOAD_OP *op;
+    int ret = -1;
+
+    if ((op = offload_op_new(type)) == NULL)
+        return -1;
+    op->flen = flen;
+    op->from = offload_memdup(from, flen);
+    op->tlen = RSA_size(rsa);
+    op->to = OPENSSL_malloc(op->tlen);
+    if (op->from == NULL || op->to == NULL) {
+        OFFLOADerr(OFFLOAD_F_OFFLOAD_OP_NEW, ERR_R_MALLOC_FAILURE);
+        goto end;
+    }
+    RSA_up_ref(rsa);
+    op->rsa = rsa;
+    op->padding = padding;
+
+    if (offload_submit(op)) {
+        ret = op->ret;
+        if (ret > 0)
+            memcpy(to, op->to, ret);
+    }
+ end:
+    offload_op_unref(op);
+    return ret;
+}
+
+static int offload_rsa_priv_enc(int flen, const unsigned char *from,
+                                unsigned char *to, RSA *rsa, int padding)
+{
+    return offload_rsa_op(OFFLOAD_OP_RSA_PRIV_ENC, flen, from, to, rsa,
+                          padding);
+}
+
+static int offload_rsa_priv_dec(int flen, const unsigned char *from,
+                                unsigned char *to, RSA *rsa, int padding)
+{
+    return offload_rsa_op(OFFLOAD_OP_RSA_PRIV_DEC, flen, from, to, rsa,
+                          padding);
+}
+
+# endif
+
+# ifndef OPENSSL_NO_ECDSA
+
+static ECDSA_SIG *offload_ecdsa_do_sign(const unsigned char *dgst, int dlen,
+                                        const BIGNUM *inv, const BIGNUM *rp,
+                                        EC_KEY *eckey)
+{
+    OFFLOAD_OP *op;
+    ECDSA_SIG *sig = NULL;
+
+    if ((op = offload_op_new(OFFLOAD_OP_ECDSA_SIGN)) == NULL)
+        return NULL;
+    op->dlen = dlen;
+    op->dgst = offload_memdup(dgst, dlen);
+    if (inv != NULL)
+        op->inv = BN_dup(inv);
+    if (rp != NULL)
+        op->rp = BN_dup(rp);
+    if (op->dgst == NULL || (inv != NULL && op->inv == NULL)
+        || (rp != NULL && op->rp == NULL)) {
+        OFFLOADerr(OFFLOAD_F_OFFLOAD_OP_NEW, ERR_R_MALLOC_FAILURE);
+        goto end;
+    }
+    EC_KEY_up_ref(eckey);
+    op->eckey = eckey;
+
+    if (offload_submit(op)) {
+        sig = op->sig;
+        op->sig = NULL;
+    }
+ end:
+    offload_op_unref(op);
+    return sig;
+}
+
+# endif
+
+#else                           /* !COMPILE_OFFLOAD */
+
+void ENGINE_load_offload(void)
+{
+}
+
+# ifndef OPENSSL_NO_DYNAMIC_ENGINE
+OPENSSL_EXPORT
+    int bind_engine(ENGINE *e, const char *id, const dynamic_fns *fns);
+OPENSSL_EXPORT
+    int bind_engine(ENGINE *e, const char *id, const dynamic_fns *fns)
+{
+    return 0;
+}
+
+IMPLEMENT_DYNAMIC_CHECK_FN()
+# endif
+
+#endif                          /* COMPILE_OFFLOAD */
@@ -277,6 +277,8 @@ void BIO_clear_flags(BIO *b, int flags);
 # define BIO_RR_CONNECT                  0x02
 /* Returned from the accept BIO when an accept would have blocked */
 # define BIO_RR_ACCEPT                   0x03
+/* Returned from the SSL bio when an ASYNC_JOB has paused */
+# define BIO_RR_ASYNC                    0x04
 
 /* These are passed by the BIO callback */
 # define BIO_CB_FREE     0x01
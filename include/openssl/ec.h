@@ -143,6 +143,12 @@ const EC_METHOD *EC_GFp_simple_method(void);
  */
 const EC_METHOD *EC_GFp_mont_method(void);
 
+/** Returns GFp methods using montgomery multiplication on fixed-width
+ *  field elements for fields of up to 512 bits.
+ *  \return  EC_METHOD object
+ */
+const EC_METHOD *EC_GFp_fixed_method(void);
+
 /** Returns GFp methods using optimized methods for NIST recommended curves
  *  \return  EC_METHOD object
  */
@@ -160,6 +166,11 @@ const EC_METHOD *EC_GFp_nistp224_method(void);
  */
 const EC_METHOD *EC_GFp_nistp256_method(void);
 
+/** Returns 64-bit optimized methods for nistp384
+ *  \return  EC_METHOD object
+ */
+const EC_METHOD *EC_GFp_nistp384_method(void);
+
 /** Returns 64-bit optimized methods for nistp521
  *  \return  EC_METHOD object
  */
@@ -700,6 +711,41 @@ int EC_GROUP_precompute_mult(EC_GROUP *group, BN_CTX *ctx);
  */
 int EC_GROUP_have_precompute_mult(const EC_GROUP *group);
 
+/** Serialises the generator precomputation of a group
+ *  \param  group  EC_GROUP object with precomputed multiples
+ *  \param  buf    buffer for the table, or NULL to query the length
+ *  \param  len    length of buf
+ *  \param  ctx    BN_CTX object (optional)
+ *  \return the length of the table or 0 if an error occurred
+ */
+size_t EC_GROUP_get_precompute_mult_data(const EC_GROUP *group,
+                                         unsigned char *buf, size_t len,
+                                         BN_CTX *ctx);
+
+/** Uses a table from EC_GROUP_get_precompute_mult_data() in place as the
+ *  generator precomputation of a group
+ *  \param  group  EC_GROUP object
+ *  \param  buf    the table, aligned for BN_ULONG access; it must outlive
+ *                 group and all copies made of it
+ *  \param  len    length of the table
+ *  \param  ctx    BN_CTX object (optional)
+ *  \return 1 on success and 0 if an error occurred
+ */
+int EC_GROUP_set_precompute_mult_data(EC_GROUP *group,
+                                      const unsigned char *buf, size_t len,
+                                      BN_CTX *ctx);
+
+/** Installs a table from EC_GROUP_get_precompute_mult_data() for all groups
+ *  later returned by EC_GROUP_new_by_curve_name(nid)
+ *  \param  nid    NID of the built-in curve
+ *  \param  buf    the table; it must remain valid until the process exits
+ *  \param  len    length of the table
+ *  \return 1 on success and 0 if an error occurred or the curve has been
+ *          used already
+ */
+int EC_curve_set_precompute_mult_data(int nid, const unsigned char *buf,
+                                      size_t len);
+
 /********************************************************************/
 /*                       ASN1 stuff                                 */
 /********************************************************************/
@@ -1106,6 +1152,7 @@ void ERR_load_EC_strings(void);
 # define EC_F_EC_ASN1_GROUP2PKPARAMETERS                  156
 # define EC_F_EC_ASN1_PARAMETERS2GROUP                    157
 # define EC_F_EC_ASN1_PKPARAMETERS2GROUP                  158
+# define EC_F_EC_CURVE_SET_PRECOMPUTE_MULT_DATA           251
 # define EC_F_EC_EX_DATA_SET_DATA                         211
 # define EC_F_EC_GF2M_MONTGOMERY_POINT_MULTIPLY           208
 # define EC_F_EC_GF2M_SIMPLE_GROUP_CHECK_DISCRIMINANT     159
@@ -1115,6 +1162,8 @@ void ERR_load_EC_strings(void);
 # define EC_F_EC_GF2M_SIMPLE_POINT_GET_AFFINE_COORDINATES 162
 # define EC_F_EC_GF2M_SIMPLE_POINT_SET_AFFINE_COORDINATES 163
 # define EC_F_EC_GF2M_SIMPLE_SET_COMPRESSED_COORDINATES   164
+# define EC_F_EC_GFP_FIXED_ADD                            249
+# define EC_F_EC_GFP_FIXED_DBL                            250
 # define EC_F_EC_GFP_MONT_FIELD_DECODE                    133
 # define EC_F_EC_GFP_MONT_FIELD_ENCODE                    134
 # define EC_F_EC_GFP_MONT_FIELD_MUL                       131
@@ -1128,6 +1177,9 @@ void ERR_load_EC_strings(void);
 # define EC_F_EC_GFP_NISTP256_GROUP_SET_CURVE             230
 # define EC_F_EC_GFP_NISTP256_POINTS_MUL                  231
 # define EC_F_EC_GFP_NISTP256_POINT_GET_AFFINE_COORDINATES 232
+# define EC_F_EC_GFP_NISTP384_GROUP_SET_CURVE             245
+# define EC_F_EC_GFP_NISTP384_POINTS_MUL                  246
+# define EC_F_EC_GFP_NISTP384_POINT_GET_AFFINE_COORDINATES 247
 # define EC_F_EC_GFP_NISTP521_GROUP_SET_CURVE             233
 # define EC_F_EC_GFP_NISTP521_POINTS_MUL                  234
 # define EC_F_EC_GFP_NISTP521_POINT_GET_AFFINE_COORDINATES 235
@@ -1158,6 +1210,7 @@ void ERR_load_EC_strings(void);
 # define EC_F_EC_GROUP_GET_DEGREE                         173
 # define EC_F_EC_GROUP_GET_ORDER                          141
 # define EC_F_EC_GROUP_GET_PENTANOMIAL_BASIS              193
+# define EC_F_EC_GROUP_GET_PRECOMPUTE_MULT_DATA           252
 # define EC_F_EC_GROUP_GET_TRINOMIAL_BASIS                194
 # define EC_F_EC_GROUP_NEW                                108
 # define EC_F_EC_GROUP_NEW_BY_CURVE_NAME                  174
@@ -1167,6 +1220,7 @@ void ERR_load_EC_strings(void);
 # define EC_F_EC_GROUP_SET_CURVE_GFP                      109
 # define EC_F_EC_GROUP_SET_EXTRA_DATA                     110
 # define EC_F_EC_GROUP_SET_GENERATOR                      111
+# define EC_F_EC_GROUP_SET_PRECOMPUTE_MULT_DATA           253
 # define EC_F_EC_KEY_CHECK_KEY                            177
 # define EC_F_EC_KEY_COPY                                 178
 # define EC_F_EC_KEY_GENERATE_KEY                         179
@@ -1198,20 +1252,27 @@ void ERR_load_EC_strings(void);
 # define EC_F_EC_POINT_SET_TO_INFINITY                    127
 # define EC_F_EC_PRE_COMP_DUP                             207
 # define EC_F_EC_PRE_COMP_NEW                             196
+# define EC_F_EC_PRE_COMP_PARAMS                          254
 # define EC_F_EC_WNAF_MUL                                 187
+# define EC_F_EC_WNAF_GET_PRECOMPUTE_DATA                 255
 # define EC_F_EC_WNAF_PRECOMPUTE_MULT                     188
+# define EC_F_EC_WNAF_SET_PRECOMPUTE_DATA                 256
 # define EC_F_I2D_ECPARAMETERS                            190
 # define EC_F_I2D_ECPKPARAMETERS                          191
 # define EC_F_I2D_ECPRIVATEKEY                            192
 # define EC_F_I2O_ECPUBLICKEY                             151
 # define EC_F_NISTP224_PRE_COMP_NEW                       227
 # define EC_F_NISTP256_PRE_COMP_NEW                       236
+# define EC_F_NISTP384_PRE_COMP_NEW                       248
 # define EC_F_NISTP521_PRE_COMP_NEW                       237
 # define EC_F_ECP_NISTZ256_GET_AFFINE                     240
 # define EC_F_ECP_NISTZ256_POINTS_MUL                     241
 # define EC_F_ECP_NISTZ256_WINDOWED_MUL                   242
 # define EC_F_ECP_NISTZ256_MULT_PRECOMPUTE                243
 # define EC_F_ECP_NISTZ256_PRE_COMP_NEW                   244
+# define EC_F_ECX_KEY_OP                                  257
+# define EC_F_ECX_PRIV_ENCODE                             258
+# define EC_F_ECX_PUB_ENCODE                              259
 # define EC_F_O2I_ECPUBLICKEY                             152
 # define EC_F_OLD_EC_PRIV_DECODE                          222
 # define EC_F_PKEY_EC_CTRL                                197
@@ -1220,6 +1281,9 @@ void ERR_load_EC_strings(void);
 # define EC_F_PKEY_EC_KEYGEN                              199
 # define EC_F_PKEY_EC_PARAMGEN                            219
 # define EC_F_PKEY_EC_SIGN                                218
+# define EC_F_PKEY_ECD_CTRL                               261
+# define EC_F_PKEY_ECD_SIGN                               262
+# define EC_F_PKEY_ECX_DERIVE                             260
 
 /* Reason codes. */
 # define EC_R_ASN1_ERROR                                  115
@@ -1246,6 +1310,8 @@ void ERR_load_EC_strings(void);
 # define EC_R_INVALID_FIELD                               103
 # define EC_R_INVALID_FORM                                104
 # define EC_R_INVALID_GROUP_ORDER                         122
+# define EC_R_INVALID_KEY                                 152
+# define EC_R_INVALID_PEER_KEY                            153
 # define EC_R_INVALID_PENTANOMIAL_BASIS                   132
 # define EC_R_INVALID_PRIVATE_KEY                         123
 # define EC_R_INVALID_TRINOMIAL_BASIS                     137
@@ -143,6 +143,21 @@ ECDSA_SIG *ECDSA_do_sign_ex(const unsigned char *dgst, int dgstlen,
 int ECDSA_do_verify(const unsigned char *dgst, int dgst_len,
                     const ECDSA_SIG *sig, EC_KEY *eckey);
 
+/** Verifies num signatures at once, sharing the modular inversions
+ *  between them where possible.
+ *  \param  num       number of signatures
+ *  \param  dgst      array of pointers to the hash values
+ *  \param  dgst_len  array of lengths of the hash values
+ *  \param  sig       array of ECDSA_SIG structures
+ *  \param  eckey     array of EC_KEY objects containing public EC keys
+ *  \param  ret       array that receives what ECDSA_do_verify() would
+ *                    return for each signature
+ *  \return 1 if all signatures are valid and 0 otherwise
+ */
+int ECDSA_do_verify_batch(int num, const unsigned char *const *dgst,
+                          const int *dgst_len, const ECDSA_SIG *const *sig,
+                          EC_KEY *const *eckey, int *ret);
+
 const ECDSA_METHOD *ECDSA_OpenSSL(void);
 
 /** Sets the default ECDSA method
@@ -266,6 +281,19 @@ void ECDSA_METHOD_set_sign(ECDSA_METHOD *ecdsa_method,
                                                         const BIGNUM *rp,
                                                         EC_KEY *eckey));
 
+/**  Get the ECDSA_do_sign function of an ECDSA_METHOD, for example to
+ *   call the builtin implementation from a method that wraps it
+ *   \param  ecdsa_method  pointer to existing ECDSA_METHOD
+ *   \param  pecdsa_do_sign  receives the ECDSA_do_sign function
+ */
+
+void ECDSA_METHOD_get_sign(const ECDSA_METHOD *ecdsa_method,
+                           ECDSA_SIG *(**pecdsa_do_sign) (const unsigned char
+                                                          *dgst, int dgst_len,
+                                                          const BIGNUM *inv,
+                                                          const BIGNUM *rp,
+                                                          EC_KEY *eckey));
+
 /**  Set the  ECDSA_sign_setup function in the ECDSA_METHOD
  *   \param  ecdsa_method  pointer to existing ECDSA_METHOD
  *   \param  ecdsa_sign_setup a funtion of type ECDSA_sign_setup
@@ -315,6 +343,7 @@ void ERR_load_ECDSA_strings(void);
 # define ECDSA_F_ECDSA_DATA_NEW_METHOD                    100
 # define ECDSA_F_ECDSA_DO_SIGN                            101
 # define ECDSA_F_ECDSA_DO_VERIFY                          102
+# define ECDSA_F_ECDSA_DO_VERIFY_BATCH                    106
 # define ECDSA_F_ECDSA_METHOD_NEW                         105
 # define ECDSA_F_ECDSA_SIGN_SETUP                         103
 
@@ -403,6 +403,8 @@ void ENGINE_load_sureware(void);
 void ENGINE_load_ubsec(void);
 void ENGINE_load_padlock(void);
 void ENGINE_load_capi(void);
+void ENGINE_load_dasync(void);
+void ENGINE_load_offload(void);
 #  ifndef OPENSSL_NO_GMP
 void ENGINE_load_gmp(void);
 #  endif
@@ -109,6 +109,8 @@
 # define EVP_PKEY_EC     NID_X9_62_id_ecPublicKey
 # define EVP_PKEY_HMAC   NID_hmac
 # define EVP_PKEY_CMAC   NID_cmac
+# define EVP_PKEY_X25519 NID_X25519
+# define EVP_PKEY_ED25519 NID_ED25519
 
 #ifdef  __cplusplus
 extern "C" {
@@ -170,6 +172,9 @@ struct env_md_st {
     int ctx_size;               /* how big does the ctx->md_data need to be */
     /* control function */
     int (*md_ctrl) (EVP_MD_CTX *ctx, int cmd, int p1, void *p2);
+    /* hash several messages at once, see EVP_Digest_batch() */
+    int (*digest_batch) (const unsigned char **data, const size_t *count,
+                         unsigned char **md, size_t num);
 } /* EVP_MD */ ;
 
 typedef int evp_sign_method(int type, const unsigned char *m,
@@ -303,6 +308,11 @@ struct env_md_ctx_st {
  * if the following flag is set.
  */
 # define EVP_MD_CTX_FLAG_FINALISE        0x0200
+/*
+ * Re-initialising with the EVP_MD already in use keeps the current
+ * implementation instead of looking for an ENGINE again.
+ */
+# define EVP_MD_CTX_FLAG_KEEP_IMPL       0x0400
 
 struct evp_cipher_st {
     int nid;
@@ -385,6 +395,11 @@ struct evp_cipher_st {
  */
 
 # define         EVP_CIPHER_CTX_FLAG_WRAP_ALLOW  0x1
+/*
+ * Re-initialising with the EVP_CIPHER already in use keeps the current
+ * implementation instead of looking for an ENGINE again.
+ */
+# define         EVP_CIPHER_CTX_FLAG_KEEP_IMPL   0x2
 
 /* ctrl() values */
 
@@ -425,6 +440,13 @@ struct evp_cipher_st {
 # define         EVP_CTRL_TLS1_1_MULTIBLOCK_ENCRYPT      0x1a
 # define         EVP_CTRL_TLS1_1_MULTIBLOCK_DECRYPT      0x1b
 # define         EVP_CTRL_TLS1_1_MULTIBLOCK_MAX_BUFSIZE  0x1c
+/* Split XTS input into data units of this many bytes, numbered from the IV */
+# define         EVP_CTRL_XTS_SET_UNIT_LEN       0x1d
+/* Spread the data units of one XTS call over up to this many threads */
+# define         EVP_CTRL_XTS_SET_THREADS        0x1e
+
+/* Length of the AAD passed with EVP_CTRL_AEAD_TLS1_AAD */
+# define         EVP_AEAD_TLS1_AAD_LEN           13
 
 typedef struct {
     unsigned char *out;
@@ -465,6 +487,16 @@ struct evp_cipher_ctx_st {
     unsigned char final[EVP_MAX_BLOCK_LENGTH]; /* possible final block */
 } /* EVP_CIPHER_CTX */ ;
 
+/* A key for sealing and opening whole messages with an AEAD */
+struct evp_aead_ctx_st {
+    const EVP_AEAD *aead;
+    size_t tag_len;             /* bytes of tag appended to each message */
+    void *aead_state;           /* per AEAD data */
+} /* EVP_AEAD_CTX */ ;
+
+/* Passed as the tag length to EVP_AEAD_CTX_init() to get the longest tag */
+# define EVP_AEAD_DEFAULT_TAG_LENGTH     0
+
 typedef struct evp_Encode_Ctx_st {
     /* number saved in a partial encode/decode */
     int num;
@@ -629,6 +661,10 @@ int EVP_MD_CTX_test_flags(const EVP_MD_CTX *ctx, int flags);
 /*__owur*/ int EVP_Digest(const void *data, size_t count,
                           unsigned char *md, unsigned int *size,
                           const EVP_MD *type, ENGINE *impl);
+/*__owur*/ int EVP_Digest_batch(const unsigned char **data,
+                                const size_t *count, unsigned char **md,
+                                size_t num, const EVP_MD *type,
+                                ENGINE *impl);
 
 /*__owur*/ int EVP_MD_CTX_copy(EVP_MD_CTX *out, const EVP_MD_CTX *in);
 /*__owur*/ int EVP_DigestInit(EVP_MD_CTX *ctx, const EVP_MD *type);
@@ -701,12 +737,18 @@ __owur int EVP_VerifyFinal(EVP_MD_CTX *ctx, const unsigned char *sigbuf,
                                   EVP_PKEY *pkey);
 __owur int EVP_DigestSignFinal(EVP_MD_CTX *ctx, unsigned char *sigret,
                                size_t *siglen);
+__owur int EVP_DigestSign(EVP_MD_CTX *ctx, unsigned char *sigret,
+                          size_t *siglen, const unsigned char *tbs,
+                          size_t tbslen);
 
 __owur int EVP_DigestVerifyInit(EVP_MD_CTX *ctx, EVP_PKEY_CTX **pctx,
                                 const EVP_MD *type, ENGINE *e,
                                 EVP_PKEY *pkey);
 __owur int EVP_DigestVerifyFinal(EVP_MD_CTX *ctx, const unsigned char *sig,
                                  size_t siglen);
+__owur int EVP_DigestVerify(EVP_MD_CTX *ctx, const unsigned char *sig,
+                            size_t siglen, const unsigned char *tbs,
+                            size_t tbslen);
 
 __owur int EVP_OpenInit(EVP_CIPHER_CTX *ctx, const EVP_CIPHER *type,
                         const unsigned char *ek, int ekl,
@@ -928,6 +970,41 @@ const EVP_CIPHER *EVP_camellia_256_ofb(void);
 const EVP_CIPHER *EVP_camellia_256_ctr(void);
 # endif
 
+# ifndef OPENSSL_NO_CHACHA
+const EVP_CIPHER *EVP_chacha20(void);
+#  ifndef OPENSSL_NO_POLY1305
+const EVP_CIPHER *EVP_chacha20_poly1305(void);
+#  endif
+# endif
+
+# ifndef OPENSSL_NO_AES
+const EVP_AEAD *EVP_aead_aes_128_gcm(void);
+const EVP_AEAD *EVP_aead_aes_192_gcm(void);
+const EVP_AEAD *EVP_aead_aes_256_gcm(void);
+const EVP_AEAD *EVP_aead_aes_128_ccm(void);
+const EVP_AEAD *EVP_aead_aes_192_ccm(void);
+const EVP_AEAD *EVP_aead_aes_256_ccm(void);
+# endif
+
+size_t EVP_AEAD_key_length(const EVP_AEAD *aead);
+size_t EVP_AEAD_nonce_length(const EVP_AEAD *aead);
+size_t EVP_AEAD_max_overhead(const EVP_AEAD *aead);
+
+int EVP_AEAD_CTX_init(EVP_AEAD_CTX *ctx, const EVP_AEAD *aead,
+                      const unsigned char *key, size_t key_len,
+                      size_t tag_len);
+void EVP_AEAD_CTX_cleanup(EVP_AEAD_CTX *ctx);
+int EVP_AEAD_CTX_seal(EVP_AEAD_CTX *ctx, unsigned char *out,
+                      size_t *out_len, size_t max_out_len,
+                      const unsigned char *nonce, size_t nonce_len,
+                      const unsigned char *in, size_t in_len,
+                      const unsigned char *ad, size_t ad_len);
+int EVP_AEAD_CTX_open(EVP_AEAD_CTX *ctx, unsigned char *out,
+                      size_t *out_len, size_t max_out_len,
+                      const unsigned char *nonce, size_t nonce_len,
+                      const unsigned char *in, size_t in_len,
+                      const unsigned char *ad, size_t ad_len);
+
 # ifndef OPENSSL_NO_SEED
 const EVP_CIPHER *EVP_seed_ecb(void);
 const EVP_CIPHER *EVP_seed_cbc(void);
@@ -1041,6 +1118,10 @@ int EVP_PKEY_print_params(BIO *out, const EVP_PKEY *pkey,
 
 int EVP_PKEY_get_default_digest_nid(EVP_PKEY *pkey, int *pnid);
 
+int EVP_PKEY_set1_tls_encodedpoint(EVP_PKEY *pkey,
+                                   const unsigned char *pt, size_t ptlen);
+size_t EVP_PKEY_get1_tls_encodedpoint(EVP_PKEY *pkey, unsigned char **ppt);
+
 int EVP_CIPHER_type(const EVP_CIPHER *ctx);
 
 /* calls methods */
@@ -1098,6 +1179,9 @@ void EVP_PBE_cleanup(void);
 # define ASN1_PKEY_CTRL_CMS_ENVELOPE     0x7
 # define ASN1_PKEY_CTRL_CMS_RI_TYPE      0x8
 
+# define ASN1_PKEY_CTRL_SET1_TLS_ENCPT   0x9
+# define ASN1_PKEY_CTRL_GET1_TLS_ENCPT   0xa
+
 int EVP_PKEY_asn1_get_count(void);
 const EVP_PKEY_ASN1_METHOD *EVP_PKEY_asn1_get0(int idx);
 const EVP_PKEY_ASN1_METHOD *EVP_PKEY_asn1_find(ENGINE **pe, int type);
@@ -1270,10 +1354,18 @@ int EVP_PKEY_sign_init(EVP_PKEY_CTX *ctx);
 int EVP_PKEY_sign(EVP_PKEY_CTX *ctx,
                   unsigned char *sig, size_t *siglen,
                   const unsigned char *tbs, size_t tbslen);
+int EVP_PKEY_sign_batch(EVP_PKEY_CTX **ctx,
+                        unsigned char **sig, size_t *siglen,
+                        const unsigned char **tbs, const size_t *tbslen,
+                        size_t num);
 int EVP_PKEY_verify_init(EVP_PKEY_CTX *ctx);
 int EVP_PKEY_verify(EVP_PKEY_CTX *ctx,
                     const unsigned char *sig, size_t siglen,
                     const unsigned char *tbs, size_t tbslen);
+int EVP_PKEY_verify_batch(EVP_PKEY_CTX **ctx,
+                          const unsigned char **sig, const size_t *siglen,
+                          const unsigned char **tbs, const size_t *tbslen,
+                          size_t num, int *ret);
 int EVP_PKEY_verify_recover_init(EVP_PKEY_CTX *ctx);
 int EVP_PKEY_verify_recover(EVP_PKEY_CTX *ctx,
                             unsigned char *rout, size_t *routlen,
@@ -1407,6 +1499,12 @@ void ERR_load_EVP_strings(void);
 /* Error codes for the EVP functions. */
 
 /* Function codes. */
+# define EVP_F_AEAD_AES_CCM_INIT                          185
+# define EVP_F_AEAD_AES_CCM_OPEN                          186
+# define EVP_F_AEAD_AES_CCM_SEAL                          187
+# define EVP_F_AEAD_AES_GCM_INIT                          188
+# define EVP_F_AEAD_AES_GCM_OPEN                          189
+# define EVP_F_AEAD_AES_GCM_SEAL                          190
 # define EVP_F_AESNI_INIT_KEY                             165
 # define EVP_F_AESNI_XTS_CIPHER                           176
 # define EVP_F_AES_INIT_KEY                               133
@@ -1423,12 +1521,17 @@ void ERR_load_EVP_strings(void);
 # define EVP_F_DSA_PKEY2PKCS8                             135
 # define EVP_F_ECDSA_PKEY2PKCS8                           129
 # define EVP_F_ECKEY_PKEY2PKCS8                           132
+# define EVP_F_EVP_AEAD_CTX_INIT                          191
+# define EVP_F_EVP_AEAD_CTX_OPEN                          192
+# define EVP_F_EVP_AEAD_CTX_SEAL                          193
 # define EVP_F_EVP_CIPHERINIT_EX                          123
 # define EVP_F_EVP_CIPHER_CTX_COPY                        163
 # define EVP_F_EVP_CIPHER_CTX_CTRL                        124
 # define EVP_F_EVP_CIPHER_CTX_SET_KEY_LENGTH              122
 # define EVP_F_EVP_DECRYPTFINAL_EX                        101
 # define EVP_F_EVP_DIGESTINIT_EX                          128
+# define EVP_F_EVP_DIGESTSIGNFINAL                        181
+# define EVP_F_EVP_DIGESTVERIFYFINAL                      182
 # define EVP_F_EVP_ENCRYPTFINAL_EX                        127
 # define EVP_F_EVP_MD_CTX_COPY_EX                         110
 # define EVP_F_EVP_MD_SIZE                                162
@@ -1463,8 +1566,10 @@ void ERR_load_EVP_strings(void);
 # define EVP_F_EVP_PKEY_PARAMGEN                          148
 # define EVP_F_EVP_PKEY_PARAMGEN_INIT                     149
 # define EVP_F_EVP_PKEY_SIGN                              140
+# define EVP_F_EVP_PKEY_SIGN_BATCH                        180
 # define EVP_F_EVP_PKEY_SIGN_INIT                         141
 # define EVP_F_EVP_PKEY_VERIFY                            142
+# define EVP_F_EVP_PKEY_VERIFY_BATCH                      183
 # define EVP_F_EVP_PKEY_VERIFY_INIT                       143
 # define EVP_F_EVP_PKEY_VERIFY_RECOVER                    144
 # define EVP_F_EVP_PKEY_VERIFY_RECOVER_INIT               145
@@ -1486,6 +1591,7 @@ void ERR_load_EVP_strings(void);
 # define EVP_F_PKEY_SET_TYPE                              158
 # define EVP_F_RC2_MAGIC_TO_METH                          109
 # define EVP_F_RC5_CTRL                                   125
+# define EVP_F_UPDATE                                     184
 
 /* Reason codes. */
 # define EVP_R_AES_IV_SETUP_FAILED                        162
@@ -1522,7 +1628,9 @@ void ERR_load_EVP_strings(void);
 # define EVP_R_INVALID_DIGEST                             152
 # define EVP_R_INVALID_FIPS_MODE                          168
 # define EVP_R_INVALID_KEY_LENGTH                         130
+# define EVP_R_INVALID_NONCE_LENGTH                       172
 # define EVP_R_INVALID_OPERATION                          148
+# define EVP_R_INVALID_TAG_LENGTH                         173
 # define EVP_R_IV_TOO_LARGE                               102
 # define EVP_R_KEYGEN_FAILURE                             120
 # define EVP_R_MESSAGE_DIGEST_IS_NULL                     159
@@ -1536,8 +1644,10 @@ void ERR_load_EVP_strings(void);
 # define EVP_R_NO_OPERATION_SET                           149
 # define EVP_R_NO_SIGN_FUNCTION_CONFIGURED                104
 # define EVP_R_NO_VERIFY_FUNCTION_CONFIGURED              105
+# define EVP_R_ONLY_ONESHOT_SUPPORTED                     171
 # define EVP_R_OPERATION_NOT_SUPPORTED_FOR_THIS_KEYTYPE   150
 # define EVP_R_OPERATON_NOT_INITIALIZED                   151
+# define EVP_R_OUTPUT_ALIASES_INPUT                       174
 # define EVP_R_PKCS8_UNKNOWN_BROKEN_TYPE                  117
 # define EVP_R_PRIVATE_KEY_DECODE_ERROR                   145
 # define EVP_R_PRIVATE_KEY_ENCODE_ERROR                   146
@@ -78,6 +78,19 @@ typedef struct hmac_ctx_st {
     int key_init;
 } HMAC_CTX;
 
+/*
+ * An HMAC key: the digest states after hashing the key XORed with the inner
+ * and outer pads. HMAC computations started from it with HMAC_Init_key()
+ * only copy these states instead of hashing the pads again.
+ */
+typedef struct hmac_key_st {
+    const EVP_MD *md;
+    EVP_MD_CTX i_ctx;
+    EVP_MD_CTX o_ctx;
+    unsigned int key_length;
+    unsigned char key[HMAC_MAX_MD_CBLOCK];
+} HMAC_KEY;
+
 # define HMAC_size(e)    (EVP_MD_size((e)->md))
 
 void HMAC_CTX_init(HMAC_CTX *ctx);
@@ -105,6 +118,12 @@ __owur int HMAC_CTX_copy(HMAC_CTX *dctx, HMAC_CTX *sctx);
 
 void HMAC_CTX_set_flags(HMAC_CTX *ctx, unsigned long flags);
 
+void HMAC_KEY_init(HMAC_KEY *hkey);
+void HMAC_KEY_cleanup(HMAC_KEY *hkey);
+/*__owur*/ int HMAC_KEY_set(HMAC_KEY *hkey, const void *key, int len,
+                            const EVP_MD *md, ENGINE *impl);
+/*__owur*/ int HMAC_Init_key(HMAC_CTX *ctx, const HMAC_KEY *hkey);
+
 #ifdef  __cplusplus
 }
 #endif
@@ -125,8 +125,35 @@ struct rsa_meth_st {
      * things as "builtin software" implementations.
      */
     int (*rsa_keygen) (RSA *rsa, int bits, BIGNUM *e, BN_GENCB *cb);
+    /*
+     * Perform several private key operations in one call, see
+     * RSA_private_encrypt_batch(). Can be null, in which case rsa_priv_enc
+     * and rsa_priv_dec are called for each operation in turn.
+     */
+    int (*rsa_priv_enc_batch) (int num, const int *flen,
+                               const unsigned char *const *from,
+                               unsigned char *const *to, RSA *const *rsa,
+                               const int *padding, int *ret);
+    int (*rsa_priv_dec_batch) (int num, const int *flen,
+                               const unsigned char *const *from,
+                               unsigned char *const *to, RSA *const *rsa,
+                               const int *padding, int *ret);
 };
 
+/*
+ * One of the primes beyond p and q of a multi-prime key, the OtherPrimeInfo
+ * of RFC 3447. For the i-th prime r_i, counting p and q as r_1 and r_2:
+ */
+typedef struct rsa_prime_info_st {
+    BIGNUM *r;
+    BIGNUM *d;                  /* d mod (r_i - 1) */
+    BIGNUM *t;                  /* (r_1 * ... * r_(i-1))^-1 mod r_i */
+    /* Used to cache montgomery values, not encoded */
+    BN_MONT_CTX *m;
+} RSA_PRIME_INFO;
+
+DECLARE_STACK_OF(RSA_PRIME_INFO)
+
 struct rsa_st {
     /*
      * The first parameter is used to pickup errors where this is passed
@@ -160,6 +187,10 @@ struct rsa_st {
     char *bignum_data;
     BN_BLINDING *blinding;
     BN_BLINDING *mt_blinding;
+    /* The additional primes of a multi-prime key, NULL for two primes */
+    STACK_OF(RSA_PRIME_INFO) *prime_infos;
+    /* The blindings of the threads using the key, see rsa_eay.c */
+    struct rsa_thread_blinding_st *thread_blindings;
 };
 
 # ifndef OPENSSL_RSA_MAX_MODULUS_BITS
@@ -177,6 +208,13 @@ struct rsa_st {
 #  define OPENSSL_RSA_MAX_PUBEXP_BITS    64
 # endif
 
+/* Version of RSAPrivateKey, 1 if there are more than two primes */
+# define RSA_ASN1_VERSION_DEFAULT        0
+# define RSA_ASN1_VERSION_MULTI          1
+
+# define RSA_DEFAULT_PRIME_NUM           2
+# define RSA_MAX_PRIME_NUM               5
+
 # define RSA_3   0x3L
 # define RSA_F4  0x10001L
 
@@ -232,6 +270,12 @@ struct rsa_st {
  */
 #  define RSA_FLAG_NO_EXP_CONSTTIME RSA_FLAG_NO_CONSTTIME
 # endif
+/*
+ * Set by RSA_precompute(): the Montgomery contexts and the table of
+ * per-thread blindings were set up before the key was shared between
+ * threads, so that the built-in method can use them without locking.
+ */
+# define RSA_FLAG_PRECOMPUTED            0x1000
 
 # define EVP_PKEY_CTX_set_rsa_padding(ctx, pad) \
         EVP_PKEY_CTX_ctrl(ctx, EVP_PKEY_RSA, -1, EVP_PKEY_CTRL_RSA_PADDING, \
@@ -261,6 +305,10 @@ struct rsa_st {
         EVP_PKEY_CTX_ctrl(ctx, EVP_PKEY_RSA, EVP_PKEY_OP_KEYGEN, \
                                 EVP_PKEY_CTRL_RSA_KEYGEN_PUBEXP, 0, pubexp)
 
+# define EVP_PKEY_CTX_set_rsa_keygen_primes(ctx, primes) \
+        EVP_PKEY_CTX_ctrl(ctx, EVP_PKEY_RSA, EVP_PKEY_OP_KEYGEN, \
+                                EVP_PKEY_CTRL_RSA_KEYGEN_PRIMES, primes, NULL)
+
 # define  EVP_PKEY_CTX_set_rsa_mgf1_md(ctx, md)  \
                 EVP_PKEY_CTX_ctrl(ctx, EVP_PKEY_RSA, \
                         EVP_PKEY_OP_TYPE_SIG | EVP_PKEY_OP_TYPE_CRYPT, \
@@ -304,6 +352,8 @@ struct rsa_st {
 # define EVP_PKEY_CTRL_GET_RSA_OAEP_MD   (EVP_PKEY_ALG_CTRL + 11)
 # define EVP_PKEY_CTRL_GET_RSA_OAEP_LABEL (EVP_PKEY_ALG_CTRL + 12)
 
+# define EVP_PKEY_CTRL_RSA_KEYGEN_PRIMES (EVP_PKEY_ALG_CTRL + 13)
+
 # define RSA_PKCS1_PADDING       1
 # define RSA_SSLV23_PADDING      2
 # define RSA_NO_PADDING          3
@@ -331,6 +381,10 @@ DECLARE_DEPRECATED(RSA *RSA_generate_key(int bits, unsigned long e, void
 
 /* New version */
 int RSA_generate_key_ex(RSA *rsa, int bits, BIGNUM *e, BN_GENCB *cb);
+int RSA_generate_multi_prime_key(RSA *rsa, int bits, int primes, BIGNUM *e,
+                                 BN_GENCB *cb);
+int RSA_multi_prime_cap(int bits);
+int RSA_get_multi_prime_extra_count(const RSA *r);
 
 int RSA_X931_derive_ex(RSA *rsa, BIGNUM *p1, BIGNUM *p2, BIGNUM *q1,
                        BIGNUM *q2, const BIGNUM *Xp1, const BIGNUM *Xp2,
@@ -350,6 +404,15 @@ int RSA_public_decrypt(int flen, const unsigned char *from,
                        unsigned char *to, RSA *rsa, int padding);
 int RSA_private_decrypt(int flen, const unsigned char *from,
                         unsigned char *to, RSA *rsa, int padding);
+/* return 1 if all num operations succeeded, results in ret */
+int RSA_private_encrypt_batch(int num, const int *flen,
+                              const unsigned char *const *from,
+                              unsigned char *const *to, RSA *const *rsa,
+                              const int *padding, int *ret);
+int RSA_private_decrypt_batch(int num, const int *flen,
+                              const unsigned char *const *from,
+                              unsigned char *const *to, RSA *const *rsa,
+                              const int *padding, int *ret);
 void RSA_free(RSA *r);
 /* "up" the RSA object's reference count */
 int RSA_up_ref(RSA *r);
@@ -372,6 +435,9 @@ const RSA_METHOD *RSA_null_method(void);
 DECLARE_ASN1_ENCODE_FUNCTIONS_const(RSA, RSAPublicKey)
 DECLARE_ASN1_ENCODE_FUNCTIONS_const(RSA, RSAPrivateKey)
 
+DECLARE_ASN1_ALLOC_FUNCTIONS(RSA_PRIME_INFO)
+DECLARE_ASN1_ITEM(RSA_PRIME_INFO)
+
 typedef struct rsa_pss_params_st {
     X509_ALGOR *hashAlgorithm;
     X509_ALGOR *maskGenAlgorithm;
@@ -435,6 +501,7 @@ int RSA_verify_ASN1_OCTET_STRING(int type, const unsigned char *m,
 int RSA_blinding_on(RSA *rsa, BN_CTX *ctx);
 void RSA_blinding_off(RSA *rsa);
 BN_BLINDING *RSA_setup_blinding(RSA *rsa, BN_CTX *ctx);
+int RSA_precompute(RSA *rsa, BN_CTX *ctx);
 
 int RSA_padding_add_PKCS1_type_1(unsigned char *to, int tlen,
                                  const unsigned char *f, int fl);
@@ -544,17 +611,21 @@ void ERR_load_RSA_strings(void);
 # define RSA_F_PKEY_RSA_CTRL                              143
 # define RSA_F_PKEY_RSA_CTRL_STR                          144
 # define RSA_F_PKEY_RSA_SIGN                              142
+# define RSA_F_PKEY_RSA_SIGN_BATCH                        162
+# define RSA_F_PKEY_RSA_SIGN_PAD                          163
 # define RSA_F_PKEY_RSA_VERIFYRECOVER                     141
 # define RSA_F_RSA_ALGOR_TO_MD                            156
 # define RSA_F_RSA_BUILTIN_KEYGEN                         129
 # define RSA_F_RSA_CHECK_KEY                              123
 # define RSA_F_RSA_CHECK_KEY_EX                           160
 # define RSA_F_RSA_CMS_DECRYPT                            159
+# define RSA_F_RSA_EAY_MOD_EXP_BATCH                      161
 # define RSA_F_RSA_EAY_PRIVATE_DECRYPT                    101
 # define RSA_F_RSA_EAY_PRIVATE_ENCRYPT                    102
 # define RSA_F_RSA_EAY_PUBLIC_DECRYPT                     103
 # define RSA_F_RSA_EAY_PUBLIC_ENCRYPT                     104
 # define RSA_F_RSA_GENERATE_KEY                           105
+# define RSA_F_RSA_GENERATE_MULTI_PRIME_KEY               164
 # define RSA_F_RSA_ITEM_VERIFY                            148
 # define RSA_F_RSA_MEMORY_LOCK                            130
 # define RSA_F_RSA_MGF1_TO_MD                             157
@@ -582,6 +653,7 @@ void ERR_load_RSA_strings(void);
 # define RSA_F_RSA_PADDING_CHECK_PKCS1_TYPE_2             113
 # define RSA_F_RSA_PADDING_CHECK_SSLV23                   114
 # define RSA_F_RSA_PADDING_CHECK_X931                     128
+# define RSA_F_RSA_PRECOMPUTE                             165
 # define RSA_F_RSA_PRINT                                  115
 # define RSA_F_RSA_PRINT_FP                               116
 # define RSA_F_RSA_PRIV_DECODE                            137
@@ -632,12 +704,17 @@ void ERR_load_RSA_strings(void);
 # define RSA_R_INVALID_TRAILER                            139
 # define RSA_R_INVALID_X931_DIGEST                        142
 # define RSA_R_IQMP_NOT_INVERSE_OF_Q                      126
+# define RSA_R_KEY_PRIME_NUM_INVALID                      167
 # define RSA_R_KEY_SIZE_TOO_SMALL                         120
 # define RSA_R_LAST_OCTET_INVALID                         134
+# define RSA_R_MP_COEFFICIENT_NOT_INVERSE_OF_R            168
+# define RSA_R_MP_EXPONENT_NOT_CONGRUENT_TO_D             169
+# define RSA_R_MP_R_NOT_PRIME                             170
 # define RSA_R_MODULUS_TOO_LARGE                          105
 # define RSA_R_NO_PUBLIC_EXPONENT                         140
 # define RSA_R_NULL_BEFORE_BLOCK_MISSING                  113
 # define RSA_R_N_DOES_NOT_EQUAL_P_Q                       127
+# define RSA_R_N_DOES_NOT_EQUAL_PRODUCT_OF_PRIMES         171
 # define RSA_R_OAEP_DECODING_ERROR                        121
 # define RSA_R_OPERATION_NOT_SUPPORTED_FOR_THIS_KEYTYPE   148
 # define RSA_R_PADDING_CHECK_FAILED                       114
@@ -1539,6 +1539,29 @@ DECLARE_SPECIAL_STACK_OF(OPENSSL_BLOCK, void)
 # define sk_POLICY_MAPPING_sort(st) SKM_sk_sort(POLICY_MAPPING, (st))
 # define sk_POLICY_MAPPING_is_sorted(st) SKM_sk_is_sorted(POLICY_MAPPING, (st))
 
+# define sk_RSA_PRIME_INFO_new(cmp) SKM_sk_new(RSA_PRIME_INFO, (cmp))
+# define sk_RSA_PRIME_INFO_new_null() SKM_sk_new_null(RSA_PRIME_INFO)
+# define sk_RSA_PRIME_INFO_free(st) SKM_sk_free(RSA_PRIME_INFO, (st))
+# define sk_RSA_PRIME_INFO_num(st) SKM_sk_num(RSA_PRIME_INFO, (st))
+# define sk_RSA_PRIME_INFO_value(st, i) SKM_sk_value(RSA_PRIME_INFO, (st), (i))
+# define sk_RSA_PRIME_INFO_set(st, i, val) SKM_sk_set(RSA_PRIME_INFO, (st), (i), (val))
+# define sk_RSA_PRIME_INFO_zero(st) SKM_sk_zero(RSA_PRIME_INFO, (st))
+# define sk_RSA_PRIME_INFO_push(st, val) SKM_sk_push(RSA_PRIME_INFO, (st), (val))
+# define sk_RSA_PRIME_INFO_unshift(st, val) SKM_sk_unshift(RSA_PRIME_INFO, (st), (val))
+# define sk_RSA_PRIME_INFO_find(st, val) SKM_sk_find(RSA_PRIME_INFO, (st), (val))
+# define sk_RSA_PRIME_INFO_find_ex(st, val) SKM_sk_find_ex(RSA_PRIME_INFO, (st), (val))
+# define sk_RSA_PRIME_INFO_delete(st, i) SKM_sk_delete(RSA_PRIME_INFO, (st), (i))
+# define sk_RSA_PRIME_INFO_delete_ptr(st, ptr) SKM_sk_delete_ptr(RSA_PRIME_INFO, (st), (ptr))
+# define sk_RSA_PRIME_INFO_insert(st, val, i) SKM_sk_insert(RSA_PRIME_INFO, (st), (val), (i))
+# define sk_RSA_PRIME_INFO_set_cmp_func(st, cmp) SKM_sk_set_cmp_func(RSA_PRIME_INFO, (st), (cmp))
+# define sk_RSA_PRIME_INFO_dup(st) SKM_sk_dup(RSA_PRIME_INFO, st)
+# define sk_RSA_PRIME_INFO_pop_free(st, free_func) SKM_sk_pop_free(RSA_PRIME_INFO, (st), (free_func))
+# define sk_RSA_PRIME_INFO_deep_copy(st, copy_func, free_func) SKM_sk_deep_copy(RSA_PRIME_INFO, (st), (copy_func), (free_func))
+# define sk_RSA_PRIME_INFO_shift(st) SKM_sk_shift(RSA_PRIME_INFO, (st))
+# define sk_RSA_PRIME_INFO_pop(st) SKM_sk_pop(RSA_PRIME_INFO, (st))
+# define sk_RSA_PRIME_INFO_sort(st) SKM_sk_sort(RSA_PRIME_INFO, (st))
+# define sk_RSA_PRIME_INFO_is_sorted(st) SKM_sk_is_sorted(RSA_PRIME_INFO, (st))
+
 # define sk_SCT_new(cmp) SKM_sk_new(SCT, (cmp))
 # define sk_SCT_new_null() SKM_sk_new_null(SCT)
 # define sk_SCT_free(st) SKM_sk_free(SCT, (st))
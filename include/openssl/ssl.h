@@ -278,6 +278,7 @@ extern "C" {
 # define SSL_TXT_CAMELLIA128     "CAMELLIA128"
 # define SSL_TXT_CAMELLIA256     "CAMELLIA256"
 # define SSL_TXT_CAMELLIA        "CAMELLIA"
+# define SSL_TXT_CHACHA20        "CHACHA20"
 
 # define SSL_TXT_MD5             "MD5"
 # define SSL_TXT_SHA1            "SHA1"
@@ -444,6 +445,12 @@ typedef int (*custom_ext_parse_cb) (SSL *s, unsigned int ext_type,
 # define SSL_OP_SINGLE_DH_USE                            0x00100000L
 /* Does nothing: retained for compatibiity */
 # define SSL_OP_EPHEMERAL_RSA                            0x0
+/*
+ * With SSL_OP_CIPHER_SERVER_PREFERENCE, prefer ChaCha20-Poly1305 suites
+ * when the client lists one as its top preference, i.e. it most likely
+ * lacks AES hardware support.
+ */
+# define SSL_OP_PRIORITIZE_CHACHA                        0x00200000L
 /*
  * Set on servers to choose the cipher according to the server's preferences
  */
@@ -530,6 +537,21 @@ typedef int (*custom_ext_parse_cb) (SSL *s, unsigned int ext_type,
  * draft-ietf-tls-downgrade-scsv-00.
  */
 # define SSL_MODE_SEND_FALLBACK_SCSV 0x00000080L
+/*
+ * Send application data in records that fit in a single TCP segment until
+ * the dynamic record threshold has been reached, then switch to
+ * max_send_fragment sized records. Fall back to small records again after
+ * the connection has been idle for the dynamic record timeout. This lets
+ * the peer start decrypting the first bytes of a response sooner.
+ */
+# define SSL_MODE_DYNAMIC_RECORD_SIZE 0x00000100L
+/*
+ * Run handshakes, reads and writes inside an ASYNC_JOB so that an ENGINE
+ * operation that is still outstanding can suspend them. The call then fails
+ * with SSL_ERROR_WANT_ASYNC and has to be repeated once the fd returned by
+ * SSL_get_async_wait_fd() becomes readable.
+ */
+# define SSL_MODE_ASYNC 0x00000200L
 
 /* Cert related flags */
 /*
@@ -927,12 +949,16 @@ __owur int SSL_extension_supported(unsigned int ext_type);
 # define SSL_WRITING     2
 # define SSL_READING     3
 # define SSL_X509_LOOKUP 4
+# define SSL_ASYNC_PAUSED 5
+# define SSL_ASYNC_NO_JOBS 6
 
 /* These will only be used when doing non-blocking IO */
 # define SSL_want_nothing(s)     (SSL_want(s) == SSL_NOTHING)
 # define SSL_want_read(s)        (SSL_want(s) == SSL_READING)
 # define SSL_want_write(s)       (SSL_want(s) == SSL_WRITING)
 # define SSL_want_x509_lookup(s) (SSL_want(s) == SSL_X509_LOOKUP)
+# define SSL_want_async(s)       (SSL_want(s) == SSL_ASYNC_PAUSED)
+# define SSL_want_async_job(s)   (SSL_want(s) == SSL_ASYNC_NO_JOBS)
 
 # define SSL_MAC_FLAG_READ_MAC_STREAM 1
 # define SSL_MAC_FLAG_WRITE_MAC_STREAM 2
@@ -1104,6 +1130,8 @@ DECLARE_PEM_rw(SSL_SESSION, SSL_SESSION)
 # define SSL_ERROR_ZERO_RETURN           6
 # define SSL_ERROR_WANT_CONNECT          7
 # define SSL_ERROR_WANT_ACCEPT           8
+# define SSL_ERROR_WANT_ASYNC            9
+# define SSL_ERROR_WANT_ASYNC_JOB        10
 # define SSL_CTRL_NEED_TMP_RSA                   1
 # define SSL_CTRL_SET_TMP_RSA                    2
 # define SSL_CTRL_SET_TMP_DH                     3
@@ -1220,6 +1248,12 @@ DECLARE_PEM_rw(SSL_SESSION, SSL_SESSION)
 # define DTLS_CTRL_SET_LINK_MTU                  120
 # define DTLS_CTRL_GET_LINK_MIN_MTU              121
 # define SSL_CTRL_GET_EXTMS_SUPPORT              122
+# define SSL_CTRL_SET_DYN_RECORD_THRESHOLD       123
+# define SSL_CTRL_SET_DYN_RECORD_TIMEOUT         124
+# define SSL_CTRL_PRECOMP_KEYS                   125
+# define SSL_CTRL_PRECOMP_NONCES                 126
+# define SSL_CTRL_PRECOMP_KEY_MISSES             127
+# define SSL_CTRL_PRECOMP_NONCE_MISSES           128
 # define SSL_CERT_SET_FIRST                      1
 # define SSL_CERT_SET_NEXT                       2
 # define SSL_CERT_SET_SERVER                     3
@@ -1391,6 +1425,7 @@ __owur unsigned long SSL_CIPHER_get_id(const SSL_CIPHER *c);
 
 __owur int SSL_get_fd(const SSL *s);
 __owur int SSL_get_rfd(const SSL *s);
+__owur int SSL_get_async_wait_fd(SSL *s);
 __owur int SSL_get_wfd(const SSL *s);
 __owur const char *SSL_get_cipher_list(const SSL *s, int n);
 __owur char *SSL_get_shared_ciphers(const SSL *s, char *buf, int len);
@@ -1744,6 +1779,33 @@ __owur int SSL_get_ex_data_X509_STORE_CTX_idx(void);
 # define SSL_set_max_send_fragment(ssl,m) \
         SSL_ctrl(ssl,SSL_CTRL_SET_MAX_SEND_FRAGMENT,m,NULL)
 
+# define SSL_CTX_set_dynamic_record_threshold(ctx,m) \
+        SSL_CTX_ctrl(ctx,SSL_CTRL_SET_DYN_RECORD_THRESHOLD,m,NULL)
+# define SSL_set_dynamic_record_threshold(ssl,m) \
+        SSL_ctrl(ssl,SSL_CTRL_SET_DYN_RECORD_THRESHOLD,m,NULL)
+# define SSL_CTX_set_dynamic_record_timeout(ctx,t) \
+        SSL_CTX_ctrl(ctx,SSL_CTRL_SET_DYN_RECORD_TIMEOUT,t,NULL)
+# define SSL_set_dynamic_record_timeout(ssl,t) \
+        SSL_ctrl(ssl,SSL_CTRL_SET_DYN_RECORD_TIMEOUT,t,NULL)
+
+/*
+ * Number of buckets returned by SSL_get_record_size_stats(). Bucket i counts
+ * application data records with a payload of at most (512 << i) bytes.
+ */
+# define SSL_RECORD_SIZE_BUCKETS 6
+
+int SSL_get_record_size_stats(const SSL *s, unsigned long *counts, int num);
+
+int SSL_CTX_set_precompute(SSL_CTX *ctx, int depth, int threads);
+# define SSL_CTX_precomp_keys(ctx) \
+        SSL_CTX_ctrl(ctx,SSL_CTRL_PRECOMP_KEYS,0,NULL)
+# define SSL_CTX_precomp_nonces(ctx) \
+        SSL_CTX_ctrl(ctx,SSL_CTRL_PRECOMP_NONCES,0,NULL)
+# define SSL_CTX_precomp_key_misses(ctx) \
+        SSL_CTX_ctrl(ctx,SSL_CTRL_PRECOMP_KEY_MISSES,0,NULL)
+# define SSL_CTX_precomp_nonce_misses(ctx) \
+        SSL_CTX_ctrl(ctx,SSL_CTRL_PRECOMP_NONCE_MISSES,0,NULL)
+
      /* NB: the keylength is only applicable when is_export is true */
 # ifndef OPENSSL_NO_RSA
 void SSL_CTX_set_tmp_rsa_callback(SSL_CTX *ctx,
@@ -2059,6 +2121,7 @@ void ERR_load_SSL_strings(void);
 # define SSL_F_SSL_CTX_NEW                                169
 # define SSL_F_SSL_CTX_SET_CIPHER_LIST                    269
 # define SSL_F_SSL_CTX_SET_CLIENT_CERT_ENGINE             290
+# define SSL_F_SSL_CTX_SET_PRECOMPUTE                     348
 # define SSL_F_SSL_CTX_SET_PURPOSE                        226
 # define SSL_F_SSL_CTX_SET_SESSION_ID_CONTEXT             219
 # define SSL_F_SSL_CTX_SET_SSL_VERSION                    170
@@ -2079,6 +2142,7 @@ void ERR_load_SSL_strings(void);
 # define SSL_F_SSL_DO_HANDSHAKE                           180
 # define SSL_F_SSL_GET_NEW_SESSION                        181
 # define SSL_F_SSL_GET_PREV_SESSION                       217
+# define SSL_F_SSL_GET_RECORD_SIZE_STATS                  349
 # define SSL_F_SSL_GET_SERVER_CERT_INDEX                  322
 # define SSL_F_SSL_GET_SERVER_SEND_CERT                   182
 # define SSL_F_SSL_GET_SERVER_SEND_PKEY                   317
@@ -2115,6 +2179,7 @@ void ERR_load_SSL_strings(void);
 # define SSL_F_SSL_SET_WFD                                196
 # define SSL_F_SSL_SHUTDOWN                               224
 # define SSL_F_SSL_SRP_CTX_INIT                           313
+# define SSL_F_SSL_START_ASYNC_JOB                        347
 # define SSL_F_SSL_UNDEFINED_CONST_FUNCTION               243
 # define SSL_F_SSL_UNDEFINED_FUNCTION                     197
 # define SSL_F_SSL_UNDEFINED_VOID_FUNCTION                244
@@ -2229,6 +2294,7 @@ void ERR_load_SSL_strings(void);
 # define SSL_R_ERROR_IN_RECEIVED_CIPHER_LIST              151
 # define SSL_R_EXCESSIVE_MESSAGE_SIZE                     152
 # define SSL_R_EXTRA_DATA_IN_MESSAGE                      153
+# define SSL_R_FAILED_TO_INIT_ASYNC                       400
 # define SSL_R_GOT_A_FIN_BEFORE_A_CCS                     154
 # define SSL_R_GOT_NEXT_PROTO_BEFORE_A_CCS                355
 # define SSL_R_GOT_NEXT_PROTO_WITHOUT_EXTENSION           356
@@ -2291,6 +2357,7 @@ void ERR_load_SSL_strings(void);
 # define SSL_R_NO_CLIENT_CERT_RECEIVED                    186
 # define SSL_R_NO_COMPRESSION_SPECIFIED                   187
 # define SSL_R_NO_GOST_CERTIFICATE_SENT_BY_PEER           330
+# define SSL_R_NO_LOCKING_CALLBACK                        401
 # define SSL_R_NO_METHOD_SPECIFIED                        188
 # define SSL_R_NO_PEM_EXTENSIONS                          389
 # define SSL_R_NO_PRIVATE_KEY_ASSIGNED                    190
@@ -2315,6 +2382,7 @@ void ERR_load_SSL_strings(void);
 # define SSL_R_PEER_DID_NOT_RETURN_A_CERTIFICATE          199
 # define SSL_R_PEM_NAME_BAD_PREFIX                        391
 # define SSL_R_PEM_NAME_TOO_SHORT                         392
+# define SSL_R_PRECOMPUTE_NOT_SUPPORTED                   402
 # define SSL_R_PRE_MAC_LENGTH_TOO_LONG                    205
 # define SSL_R_PROTOCOL_IS_SHUTDOWN                       207
 # define SSL_R_PSK_IDENTITY_NOT_FOUND                     223
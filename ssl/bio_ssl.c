@@ -187,6 +187,10 @@ static int ssl_read(BIO *b, char *out, int outl)
         BIO_set_retry_special(b);
         retry_reason = BIO_RR_SSL_X509_LOOKUP;
         break;
+    case SSL_ERROR_WANT_ASYNC:
+        BIO_set_retry_special(b);
+        retry_reason = BIO_RR_ASYNC;
+        break;
     case SSL_ERROR_WANT_ACCEPT:
         BIO_set_retry_special(b);
         retry_reason = BIO_RR_ACCEPT;
@@ -259,6 +263,10 @@ static int ssl_write(BIO *b, const char *out, int outl)
         BIO_set_retry_special(b);
         retry_reason = BIO_RR_SSL_X509_LOOKUP;
         break;
+    case SSL_ERROR_WANT_ASYNC:
+        BIO_set_retry_special(b);
+        retry_reason = BIO_RR_ASYNC;
+        break;
     case SSL_ERROR_WANT_CONNECT:
         BIO_set_retry_special(b);
         retry_reason = BIO_RR_CONNECT;
@@ -233,6 +233,21 @@ int RECORD_LAYER_setup_comp_buffer(RECORD_LAYER *rl)
     return SSL3_RECORD_setup(&(rl)->rrec);
 }
 
+int SSL_get_record_size_stats(const SSL *s, unsigned long *counts, int num)
+{
+    int i;
+
+    if (num < 0) {
+        SSLerr(SSL_F_SSL_GET_RECORD_SIZE_STATS, SSL_R_BAD_VALUE);
+        return -1;
+    }
+    if (num > SSL_RECORD_SIZE_BUCKETS)
+        num = SSL_RECORD_SIZE_BUCKETS;
+    for (i = 0; i < num; i++)
+        counts[i] = s->rlayer.record_sizes[i];
+    return num;
+}
+
 int ssl3_pending(const SSL *s)
 {
     if (s->rlayer.rstate == SSL_ST_READ_BODY)
@@ -434,6 +449,40 @@ int ssl3_read_n(SSL *s, int n, int max, int extend)
 }
 
 
+/*
+ * Account for |num| application data records carrying |len| bytes each.
+ */
+static void ssl3_record_app_data(SSL *s, unsigned int len, unsigned int num)
+{
+    RECORD_LAYER *rl = &s->rlayer;
+    unsigned int bucket = 0;
+
+    while (bucket < SSL_RECORD_SIZE_BUCKETS - 1 && len > (512U << bucket))
+        bucket++;
+    rl->record_sizes[bucket] += num;
+
+    if (s->mode & SSL_MODE_DYNAMIC_RECORD_SIZE) {
+        rl->dyn_written += (unsigned long)len * num;
+        rl->dyn_last_write = time(NULL);
+    }
+}
+
+/*
+ * Return the largest payload to put into the next record of type |type|.
+ * With SSL_MODE_DYNAMIC_RECORD_SIZE application data goes out in records
+ * that fit into one TCP segment until dyn_record_threshold bytes have been
+ * written since the connection was last idle.
+ */
+static unsigned int ssl3_send_fragment_size(SSL *s, int type)
+{
+    if (type != SSL3_RT_APPLICATION_DATA
+        || !(s->mode & SSL_MODE_DYNAMIC_RECORD_SIZE)
+        || s->rlayer.dyn_written >= s->dyn_record_threshold
+        || s->max_send_fragment <= SSL3_RT_DYN_RECORD_SIZE)
+        return s->max_send_fragment;
+    return SSL3_RT_DYN_RECORD_SIZE;
+}
+
 /*
  * Call this to write data in records of type 'type' It will return <= 0 if
  * not all data has been sent or non-blocking IO.
@@ -484,6 +533,14 @@ int ssl3_write_bytes(SSL *s, int type, const void *buf_, int len)
         return (-1);
     }
 
+    /* Start over with small records if the connection has been idle */
+    if (type == SSL3_RT_APPLICATION_DATA
+        && (s->mode & SSL_MODE_DYNAMIC_RECORD_SIZE)
+        && s->dyn_record_timeout != 0 && s->rlayer.dyn_last_write != 0
+        && time(NULL) - s->rlayer.dyn_last_write >=
+           (time_t)s->dyn_record_timeout)
+        s->rlayer.dyn_written = 0;
+
     /*
      * first check if there is a SSL3_BUFFER still being written out.  This
      * will happen with non blocking IO
@@ -505,6 +562,7 @@ int ssl3_write_bytes(SSL *s, int type, const void *buf_, int len)
      * compromise is considered worthy.
      */
     if (type == SSL3_RT_APPLICATION_DATA &&
+        ssl3_send_fragment_size(s, type) == s->max_send_fragment &&
         u_len >= 4 * (max_send_fragment = s->max_send_fragment) &&
         s->compress == NULL && s->msg_callback == NULL &&
         !SSL_USE_ETM(s) && SSL_USE_EXPLICIT_IV(s) &&
@@ -592,6 +650,8 @@ int ssl3_write_bytes(SSL *s, int type, const void *buf_, int len)
                                     sizeof(mb_param), &mb_param) <= 0)
                 return -1;
 
+            ssl3_record_app_data(s, max_send_fragment, mb_param.interleave);
+
             s->rlayer.write_sequence[7] += mb_param.interleave;
             if (s->rlayer.write_sequence[7] < mb_param.interleave) {
                 int j = 6;
@@ -634,9 +694,8 @@ int ssl3_write_bytes(SSL *s, int type, const void *buf_, int len)
 
     n = (len - tot);
     for (;;) {
-        if (n > s->max_send_fragment)
-            nw = s->max_send_fragment;
-        else
+        nw = ssl3_send_fragment_size(s, type);
+        if (n < nw)
             nw = n;
 
         i = do_ssl3_write(s, type, &(buf[tot]), nw, 0);
@@ -879,6 +938,9 @@ int do_ssl3_write(SSL *s, int type, const unsigned char *buf,
         return SSL3_RECORD_get_length(wr);
     }
 
+    if (type == SSL3_RT_APPLICATION_DATA)
+        ssl3_record_app_data(s, len, 1);
+
     /* now let's set up wb */
     SSL3_BUFFER_set_left(wb, prefix_len + SSL3_RECORD_get_length(wr));
 
@@ -129,6 +129,18 @@ typedef struct ssl3_buffer_st {
 
 #define SEQ_NUM_SIZE                            8
 
+/*
+ * Payload of a record sent while SSL_MODE_DYNAMIC_RECORD_SIZE is ramping up:
+ * a 1500 byte MTU less IPv6 and TCP headers with timestamps leaves 1428
+ * bytes per segment, enough for 1369 bytes of data plus the worst case
+ * header, explicit IV, MAC and padding of the common ciphersuites.
+ */
+#define SSL3_RT_DYN_RECORD_SIZE                 1369
+/* Default bytes to send in small records before switching to full ones */
+#define SSL3_DEFAULT_DYN_RECORD_THRESHOLD       (1024 * 1024)
+/* Default idle seconds after which small records are used again */
+#define SSL3_DEFAULT_DYN_RECORD_TIMEOUT         1
+
 typedef struct ssl3_record_st {
     /* type of record */
     /* r */
@@ -284,7 +296,16 @@ typedef struct record_layer_st {
 
     unsigned char read_sequence[8];
     unsigned char write_sequence[8];
-    
+
+    /*
+     * SSL_MODE_DYNAMIC_RECORD_SIZE state: application data bytes written
+     * since the connection was last idle and when that last write happened
+     */
+    unsigned long dyn_written;
+    time_t dyn_last_write;
+    /* number of application data records written, by payload size */
+    unsigned long record_sizes[SSL_RECORD_SIZE_BUCKETS];
+
     DTLS_RECORD_LAYER *d;
 } RECORD_LAYER;
 
@@ -685,6 +685,8 @@ int tls1_enc(SSL *s, int send)
             buf[11] = rec->length >> 8;
             buf[12] = rec->length & 0xff;
             pad = EVP_CIPHER_CTX_ctrl(ds, EVP_CTRL_AEAD_TLS1_AAD, 13, buf);
+            if (pad <= 0)
+                return -1;
             if (send) {
                 l += pad;
                 rec->length += pad;
@@ -864,7 +866,6 @@ int tls1_mac(SSL *ssl, unsigned char *md, int send)
     EVP_MD_CTX *hash;
     size_t md_size;
     int i;
-    EVP_MD_CTX hmac, *mac_ctx;
     unsigned char header[13];
     int stream_mac = (send ? (ssl->mac_flags & SSL_MAC_FLAG_WRITE_MAC_STREAM)
                       : (ssl->mac_flags & SSL_MAC_FLAG_READ_MAC_STREAM));
@@ -884,15 +885,6 @@ int tls1_mac(SSL *ssl, unsigned char *md, int send)
     OPENSSL_assert(t >= 0);
     md_size = t;
 
-    /* I should fix this up TLS TLS TLS TLS TLS XXXXXXXX */
-    if (stream_mac) {
-        mac_ctx = hash;
-    } else {
-        if (!EVP_MD_CTX_copy(&hmac, hash))
-            return -1;
-        mac_ctx = &hmac;
-    }
-
     if (SSL_IS_DTLS(ssl)) {
         unsigned char dtlsseq[8], *p = dtlsseq;
 
@@ -912,32 +904,39 @@ int tls1_mac(SSL *ssl, unsigned char *md, int send)
 
     if (!send && !SSL_USE_ETM(ssl) &&
         EVP_CIPHER_CTX_mode(ssl->enc_read_ctx) == EVP_CIPH_CBC_MODE &&
-        ssl3_cbc_record_digest_supported(mac_ctx)) {
+        ssl3_cbc_record_digest_supported(hash)) {
         /*
          * This is a CBC-encrypted record. We must avoid leaking any
          * timing-side channel information about how many blocks of data we
          * are hashing because that gives an attacker a timing-oracle.
          */
         /* Final param == not SSLv3 */
-        ssl3_cbc_digest_record(mac_ctx,
+        ssl3_cbc_digest_record(hash,
                                md, &md_size,
                                header, rec->input,
                                rec->length + md_size, rec->orig_len,
                                ssl->s3->read_mac_secret,
                                ssl->s3->read_mac_secret_size, 0);
     } else {
-        EVP_DigestSignUpdate(mac_ctx, header, sizeof(header));
-        EVP_DigestSignUpdate(mac_ctx, rec->input, rec->length);
-        t = EVP_DigestSignFinal(mac_ctx, md, &md_size);
+        if (!stream_mac) {
+            /*
+             * Restart the MAC in place rather than copying the context for
+             * every record: for HMAC this only copies the key's precomputed
+             * pad states. Finalising in place avoids a second copy.
+             */
+            if (!EVP_DigestInit_ex(hash, NULL, NULL))
+                return -1;
+            EVP_MD_CTX_set_flags(hash, EVP_MD_CTX_FLAG_FINALISE);
+        }
+        EVP_DigestSignUpdate(hash, header, sizeof(header));
+        EVP_DigestSignUpdate(hash, rec->input, rec->length);
+        t = EVP_DigestSignFinal(hash, md, &md_size);
         OPENSSL_assert(t > 0);
         if (!send && !SSL_USE_ETM(ssl) && FIPS_mode())
             tls_fips_digest_extra(ssl->enc_read_ctx,
-                                  mac_ctx, rec->input,
+                                  hash, rec->input,
                                   rec->length, rec->orig_len);
     }
-
-    if (!stream_mac)
-        EVP_MD_CTX_cleanup(&hmac);
 #ifdef TLS_DEBUG
     fprintf(stderr, "seq=");
     {
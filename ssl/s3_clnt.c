@@ -1426,6 +1426,8 @@ int ssl3_get_key_exchange(SSL *s)
 #ifndef OPENSSL_NO_EC
         EC_KEY_free(s->session->sess_cert->peer_ecdh_tmp);
         s->session->sess_cert->peer_ecdh_tmp = NULL;
+        EVP_PKEY_free(s->session->sess_cert->peer_pkey_tmp);
+        s->session->sess_cert->peer_pkey_tmp = NULL;
 #endif
     } else {
         s->session->sess_cert = ssl_sess_cert_new();
@@ -1760,11 +1762,6 @@ int ssl3_get_key_exchange(SSL *s)
         EC_GROUP *ngroup;
         const EC_GROUP *group;
 
-        if ((ecdh = EC_KEY_new()) == NULL) {
-            SSLerr(SSL_F_SSL3_GET_KEY_EXCHANGE, ERR_R_MALLOC_FAILURE);
-            goto err;
-        }
-
         /*
          * Extract elliptic curve parameters and the server's ephemeral ECDH
          * public key. Keep accumulating lengths of various components in
@@ -1797,44 +1794,80 @@ int ssl3_get_key_exchange(SSL *s)
             goto f_err;
         }
 
-        ngroup = EC_GROUP_new_by_curve_name(curve_nid);
-        if (ngroup == NULL) {
-            SSLerr(SSL_F_SSL3_GET_KEY_EXCHANGE, ERR_R_EC_LIB);
-            goto err;
-        }
-        if (EC_KEY_set_group(ecdh, ngroup) == 0) {
-            SSLerr(SSL_F_SSL3_GET_KEY_EXCHANGE, ERR_R_EC_LIB);
-            goto err;
+        p += 3;
+        encoded_pt_len = *p;    /* length of encoded point */
+        p += 1;
+        if (encoded_pt_len > n - param_len) {
+            SSLerr(SSL_F_SSL3_GET_KEY_EXCHANGE, SSL_R_BAD_ECPOINT);
+            goto f_err;
         }
-        EC_GROUP_free(ngroup);
 
-        group = EC_KEY_get0_group(ecdh);
+        if (curve_nid == NID_X25519) {
+            /*
+             * X25519 has no EC_GROUP: the ECPoint is the raw public value,
+             * kept as an EVP_PKEY until the ClientKeyExchange.
+             */
+            EVP_PKEY *peer_tmp = EVP_PKEY_new();
 
-        if (SSL_C_IS_EXPORT(s->s3->tmp.new_cipher) &&
-            (EC_GROUP_get_degree(group) > 163)) {
-            al = SSL_AD_EXPORT_RESTRICTION;
-            SSLerr(SSL_F_SSL3_GET_KEY_EXCHANGE,
-                   SSL_R_ECGROUP_TOO_LARGE_FOR_CIPHER);
-            goto f_err;
-        }
+            if (peer_tmp == NULL
+                || !EVP_PKEY_set_type(peer_tmp, EVP_PKEY_X25519)) {
+                EVP_PKEY_free(peer_tmp);
+                SSLerr(SSL_F_SSL3_GET_KEY_EXCHANGE, ERR_R_EVP_LIB);
+                goto err;
+            }
+            if (!EVP_PKEY_set1_tls_encodedpoint(peer_tmp, p,
+                                                encoded_pt_len)) {
+                EVP_PKEY_free(peer_tmp);
+                SSLerr(SSL_F_SSL3_GET_KEY_EXCHANGE, SSL_R_BAD_ECPOINT);
+                goto f_err;
+            }
+            s->session->sess_cert->peer_pkey_tmp = peer_tmp;
+        } else {
+            if ((ecdh = EC_KEY_new()) == NULL) {
+                SSLerr(SSL_F_SSL3_GET_KEY_EXCHANGE, ERR_R_MALLOC_FAILURE);
+                goto err;
+            }
 
-        p += 3;
+            ngroup = EC_GROUP_new_by_curve_name(curve_nid);
+            if (ngroup == NULL) {
+                SSLerr(SSL_F_SSL3_GET_KEY_EXCHANGE, ERR_R_EC_LIB);
+                goto err;
+            }
+            if (EC_KEY_set_group(ecdh, ngroup) == 0) {
+                SSLerr(SSL_F_SSL3_GET_KEY_EXCHANGE, ERR_R_EC_LIB);
+                goto err;
+            }
+            EC_GROUP_free(ngroup);
 
-        /* Next, get the encoded ECPoint */
-        if (((srvr_ecpoint = EC_POINT_new(group)) == NULL) ||
-            ((bn_ctx = BN_CTX_new()) == NULL)) {
-            SSLerr(SSL_F_SSL3_GET_KEY_EXCHANGE, ERR_R_MALLOC_FAILURE);
-            goto err;
-        }
+            group = EC_KEY_get0_group(ecdh);
 
-        encoded_pt_len = *p;    /* length of encoded point */
-        p += 1;
+            if (SSL_C_IS_EXPORT(s->s3->tmp.new_cipher) &&
+                (EC_GROUP_get_degree(group) > 163)) {
+                al = SSL_AD_EXPORT_RESTRICTION;
+                SSLerr(SSL_F_SSL3_GET_KEY_EXCHANGE,
+                       SSL_R_ECGROUP_TOO_LARGE_FOR_CIPHER);
+                goto f_err;
+            }
 
-        if ((encoded_pt_len > n - param_len) ||
-            (EC_POINT_oct2point(group, srvr_ecpoint,
-                                p, encoded_pt_len, bn_ctx) == 0)) {
-            SSLerr(SSL_F_SSL3_GET_KEY_EXCHANGE, SSL_R_BAD_ECPOINT);
-            goto f_err;
+            /* Next, get the encoded ECPoint */
+            if (((srvr_ecpoint = EC_POINT_new(group)) == NULL) ||
+                ((bn_ctx = BN_CTX_new()) == NULL)) {
+                SSLerr(SSL_F_SSL3_GET_KEY_EXCHANGE, ERR_R_MALLOC_FAILURE);
+                goto err;
+            }
+
+            if (EC_POINT_oct2point(group, srvr_ecpoint,
+                                   p, encoded_pt_len, bn_ctx) == 0) {
+                SSLerr(SSL_F_SSL3_GET_KEY_EXCHANGE, SSL_R_BAD_ECPOINT);
+                goto f_err;
+            }
+            EC_KEY_set_public_key(ecdh, srvr_ecpoint);
+            s->session->sess_cert->peer_ecdh_tmp = ecdh;
+            ecdh = NULL;
+            BN_CTX_free(bn_ctx);
+            bn_ctx = NULL;
+            EC_POINT_free(srvr_ecpoint);
+            srvr_ecpoint = NULL;
         }
         param_len += encoded_pt_len;
 
@@ -1860,13 +1893,6 @@ int ssl3_get_key_exchange(SSL *s)
                                 sess_cert->peer_pkeys[SSL_PKEY_ECC].x509);
 # endif
         /* else anonymous ECDH, so no certificate or pkey. */
-        EC_KEY_set_public_key(ecdh, srvr_ecpoint);
-        s->session->sess_cert->peer_ecdh_tmp = ecdh;
-        ecdh = NULL;
-        BN_CTX_free(bn_ctx);
-        bn_ctx = NULL;
-        EC_POINT_free(srvr_ecpoint);
-        srvr_ecpoint = NULL;
     } else if (alg_k) {
         al = SSL_AD_UNEXPECTED_MESSAGE;
         SSLerr(SSL_F_SSL3_GET_KEY_EXCHANGE, SSL_R_UNEXPECTED_MESSAGE);
@@ -2627,6 +2653,31 @@ int ssl3_send_client_key_exchange(SSL *s)
 #endif
 
 #ifndef OPENSSL_NO_EC
+        else if ((alg_k & SSL_kECDHE) && s->session->sess_cert != NULL
+                 && s->session->sess_cert->peer_pkey_tmp != NULL) {
+            /* X25519: a fresh key pair and a raw 32-byte public value */
+            EVP_PKEY *peer_tmp = s->session->sess_cert->peer_pkey_tmp;
+            EVP_PKEY *ckey = ssl_generate_pkey(EVP_PKEY_id(peer_tmp));
+
+            if (ckey == NULL || !ssl_derive(ckey, peer_tmp, &pms, &pmslen)) {
+                EVP_PKEY_free(ckey);
+                SSLerr(SSL_F_SSL3_SEND_CLIENT_KEY_EXCHANGE, ERR_R_EVP_LIB);
+                goto err;
+            }
+            encoded_pt_len = EVP_PKEY_get1_tls_encodedpoint(ckey,
+                                                            &encodedPoint);
+            EVP_PKEY_free(ckey);
+            if (encoded_pt_len == 0) {
+                SSLerr(SSL_F_SSL3_SEND_CLIENT_KEY_EXCHANGE, ERR_R_EC_LIB);
+                goto err;
+            }
+            *p = encoded_pt_len; /* length of encoded point */
+            p += 1;
+            memcpy(p, encodedPoint, encoded_pt_len);
+            n = encoded_pt_len + 1;
+            OPENSSL_free(encodedPoint);
+            encodedPoint = NULL;
+        }
         else if (alg_k & (SSL_kECDHE | SSL_kECDHr | SSL_kECDHe)) {
             const EC_GROUP *srvr_group = NULL;
             EC_KEY *tkey;
@@ -2975,6 +2975,77 @@ OPENSSL_GLOBAL const SSL_CIPHER ssl3_ciphers[] = {
 # endif                         /* OPENSSL_NO_CAMELLIA */
 #endif                          /* OPENSSL_NO_EC */
 
+#if !defined(OPENSSL_NO_CHACHA) && !defined(OPENSSL_NO_POLY1305)
+    /* ChaCha20-Poly1305 ciphersuites from RFC7905 */
+# ifndef OPENSSL_NO_EC
+    /* Cipher CCA8 */
+    {
+     1,
+     TLS1_TXT_ECDHE_RSA_WITH_CHACHA20_POLY1305,
+     TLS1_CK_ECDHE_RSA_WITH_CHACHA20_POLY1305,
+     SSL_kECDHE,
+     SSL_aRSA,
+     SSL_CHACHA20POLY1305,
+     SSL_AEAD,
+     SSL_TLSV1_2,
+     SSL_NOT_EXP | SSL_HIGH,
+     SSL_HANDSHAKE_MAC_SHA256 | TLS1_PRF_SHA256,
+     256,
+     256,
+     },
+
+    /* Cipher CCA9 */
+    {
+     1,
+     TLS1_TXT_ECDHE_ECDSA_WITH_CHACHA20_POLY1305,
+     TLS1_CK_ECDHE_ECDSA_WITH_CHACHA20_POLY1305,
+     SSL_kECDHE,
+     SSL_aECDSA,
+     SSL_CHACHA20POLY1305,
+     SSL_AEAD,
+     SSL_TLSV1_2,
+     SSL_NOT_EXP | SSL_HIGH,
+     SSL_HANDSHAKE_MAC_SHA256 | TLS1_PRF_SHA256,
+     256,
+     256,
+     },
+# endif                         /* OPENSSL_NO_EC */
+
+    /* Cipher CCAA */
+    {
+     1,
+     TLS1_TXT_DHE_RSA_WITH_CHACHA20_POLY1305,
+     TLS1_CK_DHE_RSA_WITH_CHACHA20_POLY1305,
+     SSL_kDHE,
+     SSL_aRSA,
+     SSL_CHACHA20POLY1305,
+     SSL_AEAD,
+     SSL_TLSV1_2,
+     SSL_NOT_EXP | SSL_HIGH,
+     SSL_HANDSHAKE_MAC_SHA256 | TLS1_PRF_SHA256,
+     256,
+     256,
+     },
+
+# ifndef OPENSSL_NO_PSK
+    /* Cipher CCAB */
+    {
+     1,
+     TLS1_TXT_PSK_WITH_CHACHA20_POLY1305,
+     TLS1_CK_PSK_WITH_CHACHA20_POLY1305,
+     SSL_kPSK,
+     SSL_aPSK,
+     SSL_CHACHA20POLY1305,
+     SSL_AEAD,
+     SSL_TLSV1_2,
+     SSL_NOT_EXP | SSL_HIGH,
+     SSL_HANDSHAKE_MAC_SHA256 | TLS1_PRF_SHA256,
+     256,
+     256,
+     },
+# endif                         /* OPENSSL_NO_PSK */
+#endif                          /* OPENSSL_NO_CHACHA, OPENSSL_NO_POLY1305 */
+
 #ifdef TEMP_GOST_TLS
 /* Cipher FF00 */
     {
@@ -3124,6 +3195,7 @@ void ssl3_free(SSL *s)
 #endif
 #ifndef OPENSSL_NO_EC
     EC_KEY_free(s->s3->tmp.ecdh);
+    EVP_PKEY_free(s->s3->tmp.pkey);
 #endif
 
     if (s->s3->tmp.ca_names != NULL)
@@ -3159,6 +3231,8 @@ void ssl3_clear(SSL *s)
 #ifndef OPENSSL_NO_EC
     EC_KEY_free(s->s3->tmp.ecdh);
     s->s3->tmp.ecdh = NULL;
+    EVP_PKEY_free(s->s3->tmp.pkey);
+    s->s3->tmp.pkey = NULL;
 #endif
 #ifndef OPENSSL_NO_TLSEXT
 # ifndef OPENSSL_NO_EC
@@ -3570,6 +3644,14 @@ long ssl3_ctrl(SSL *s, int cmd, long larg, void *parg)
             EVP_PKEY *ptmp;
             int rv = 0;
             sc = s->session->sess_cert;
+#ifndef OPENSSL_NO_EC
+            if (sc->peer_pkey_tmp != NULL) {
+                CRYPTO_add(&sc->peer_pkey_tmp->references, 1,
+                           CRYPTO_LOCK_EVP_PKEY);
+                *(EVP_PKEY **)parg = sc->peer_pkey_tmp;
+                return 1;
+            }
+#endif
 #if !defined(OPENSSL_NO_RSA) && !defined(OPENSSL_NO_DH) && !defined(OPENSSL_NO_EC)
             if (!sc->peer_rsa_tmp && !sc->peer_dh_tmp && !sc->peer_ecdh_tmp)
                 return 0;
@@ -4065,11 +4147,37 @@ int ssl3_put_cipher_by_char(const SSL_CIPHER *c, unsigned char *p)
     return (2);
 }
 
+/*
+ * Return a copy of |srvr| with the ChaCha20-Poly1305 suites moved to the
+ * front, or NULL on allocation failure.
+ */
+static STACK_OF(SSL_CIPHER) *ssl3_chacha_first(STACK_OF(SSL_CIPHER) *srvr)
+{
+    STACK_OF(SSL_CIPHER) *ret;
+    SSL_CIPHER *c;
+    int i, pass;
+
+    if ((ret = sk_SSL_CIPHER_new_null()) == NULL)
+        return NULL;
+    for (pass = 0; pass < 2; pass++) {
+        for (i = 0; i < sk_SSL_CIPHER_num(srvr); i++) {
+            c = sk_SSL_CIPHER_value(srvr, i);
+            if ((c->algorithm_enc == SSL_CHACHA20POLY1305) != (pass == 0))
+                continue;
+            if (!sk_SSL_CIPHER_push(ret, c)) {
+                sk_SSL_CIPHER_free(ret);
+                return NULL;
+            }
+        }
+    }
+    return ret;
+}
+
 SSL_CIPHER *ssl3_choose_cipher(SSL *s, STACK_OF(SSL_CIPHER) *clnt,
                                STACK_OF(SSL_CIPHER) *srvr)
 {
     SSL_CIPHER *c, *ret = NULL;
-    STACK_OF(SSL_CIPHER) *prio, *allow;
+    STACK_OF(SSL_CIPHER) *prio, *allow, *prio_chacha = NULL;
     int i, ii, ok;
     CERT *cert;
     unsigned long alg_k, alg_a, mask_k, mask_a, emask_k, emask_a;
@@ -4106,6 +4214,18 @@ SSL_CIPHER *ssl3_choose_cipher(SSL *s, STACK_OF(SSL_CIPHER) *clnt,
     if (s->options & SSL_OP_CIPHER_SERVER_PREFERENCE || tls1_suiteb(s)) {
         prio = srvr;
         allow = clnt;
+
+        /*
+         * A client putting ChaCha20-Poly1305 first most likely has no AES
+         * hardware: move the server's ChaCha20 suites to the front, keeping
+         * their relative order and that of everything else.
+         */
+        if ((s->options & SSL_OP_PRIORITIZE_CHACHA)
+            && sk_SSL_CIPHER_num(clnt) > 0
+            && sk_SSL_CIPHER_value(clnt, 0)->algorithm_enc
+               == SSL_CHACHA20POLY1305
+            && (prio_chacha = ssl3_chacha_first(srvr)) != NULL)
+            prio = prio_chacha;
     } else {
         prio = clnt;
         allow = srvr;
@@ -4201,6 +4321,7 @@ SSL_CIPHER *ssl3_choose_cipher(SSL *s, STACK_OF(SSL_CIPHER) *clnt,
             break;
         }
     }
+    sk_SSL_CIPHER_free(prio_chacha);
     return (ret);
 }
 
@@ -4479,6 +4600,62 @@ int ssl3_renegotiate_check(SSL *s)
     return (ret);
 }
 
+#ifndef OPENSSL_NO_EC
+/* Generate a fresh private key of type |id|, an EVP_PKEY_* value */
+EVP_PKEY *ssl_generate_pkey(int id)
+{
+    EVP_PKEY_CTX *pctx;
+    EVP_PKEY *pkey = NULL;
+
+    pctx = EVP_PKEY_CTX_new_id(id, NULL);
+    if (pctx == NULL)
+        return NULL;
+    if (EVP_PKEY_keygen_init(pctx) <= 0
+        || EVP_PKEY_keygen(pctx, &pkey) <= 0) {
+        EVP_PKEY_free(pkey);
+        pkey = NULL;
+    }
+    EVP_PKEY_CTX_free(pctx);
+    return pkey;
+}
+
+/*
+ * Derive the shared secret of |privkey| and the peer's |pubkey| into a newly
+ * allocated buffer, returned in |*ppms| and |*ppmslen|. The caller must
+ * cleanse and free it. Returns 1 on success and 0 on error.
+ */
+int ssl_derive(EVP_PKEY *privkey, EVP_PKEY *pubkey, unsigned char **ppms,
+               size_t *ppmslen)
+{
+    EVP_PKEY_CTX *pctx;
+    unsigned char *pms = NULL;
+    size_t pmslen = 0;
+    int rv = 0;
+
+    pctx = EVP_PKEY_CTX_new(privkey, NULL);
+    if (pctx == NULL)
+        return 0;
+    if (EVP_PKEY_derive_init(pctx) <= 0
+        || EVP_PKEY_derive_set_peer(pctx, pubkey) <= 0
+        || EVP_PKEY_derive(pctx, NULL, &pmslen) <= 0)
+        goto err;
+    pms = OPENSSL_malloc(pmslen);
+    if (pms == NULL)
+        goto err;
+    if (EVP_PKEY_derive(pctx, pms, &pmslen) <= 0) {
+        OPENSSL_cleanse(pms, pmslen);
+        OPENSSL_free(pms);
+        goto err;
+    }
+    *ppms = pms;
+    *ppmslen = pmslen;
+    rv = 1;
+ err:
+    EVP_PKEY_CTX_free(pctx);
+    return rv;
+}
+#endif
+
 /*
  * If we are using default SHA1+MD5 algorithms switch to new SHA256 PRF and
  * handshake macs if required.
@@ -1701,15 +1701,47 @@ int ssl3_send_server_key_exchange(SSL *s)
         } else
 #endif
 #ifndef OPENSSL_NO_EC
+        if ((type & SSL_kECDHE) && s->cert->ecdh_tmp_auto
+            && tls1_shared_curve(s, -2) == NID_X25519) {
+            if (s->s3->tmp.pkey != NULL) {
+                SSLerr(SSL_F_SSL3_SEND_SERVER_KEY_EXCHANGE,
+                       ERR_R_INTERNAL_ERROR);
+                goto err;
+            }
+            s->s3->tmp.pkey = ssl_generate_pkey(EVP_PKEY_X25519);
+            if (s->s3->tmp.pkey == NULL) {
+                SSLerr(SSL_F_SSL3_SEND_SERVER_KEY_EXCHANGE, ERR_R_EVP_LIB);
+                goto err;
+            }
+            curve_id = tls1_ec_nid2curve_id(NID_X25519);
+            encodedlen = EVP_PKEY_get1_tls_encodedpoint(s->s3->tmp.pkey,
+                                                        &encodedPoint);
+            if (encodedlen == 0) {
+                SSLerr(SSL_F_SSL3_SEND_SERVER_KEY_EXCHANGE, ERR_R_EC_LIB);
+                goto err;
+            }
+            /* Same ServerECDHParams layout as for the X9.62 curves */
+            n = 4 + encodedlen;
+            r[0] = NULL;
+            r[1] = NULL;
+            r[2] = NULL;
+            r[3] = NULL;
+        } else
         if (type & SSL_kECDHE) {
             const EC_GROUP *group;
+            int precomputed = 0;
 
             ecdhp = cert->ecdh_tmp;
             if (s->cert->ecdh_tmp_auto) {
                 /* Get NID of appropriate shared curve */
                 int nid = tls1_shared_curve(s, -2);
-                if (nid != NID_undef)
-                    ecdhp = EC_KEY_new_by_curve_name(nid);
+                if (nid != NID_undef) {
+                    ecdhp = ssl_precomp_get_ecdh(s->ctx, nid);
+                    if (ecdhp != NULL)
+                        precomputed = 1;
+                    else
+                        ecdhp = EC_KEY_new_by_curve_name(nid);
+                }
             } else if ((ecdhp == NULL) && s->cert->ecdh_tmp_cb) {
                 ecdhp = s->cert->ecdh_tmp_cb(s,
                                              SSL_C_IS_EXPORT(s->s3->
@@ -1735,9 +1767,15 @@ int ssl3_send_server_key_exchange(SSL *s)
                 SSLerr(SSL_F_SSL3_SEND_SERVER_KEY_EXCHANGE, ERR_R_ECDH_LIB);
                 goto err;
             }
-            if (s->cert->ecdh_tmp_auto)
+            if (s->cert->ecdh_tmp_auto) {
                 ecdh = ecdhp;
-            else if ((ecdh = EC_KEY_dup(ecdhp)) == NULL) {
+            } else if ((s->options & SSL_OP_SINGLE_ECDH_USE)
+                       && (group = EC_KEY_get0_group(ecdhp)) != NULL
+                       && (ecdh = ssl_precomp_get_ecdh(s->ctx,
+                                   EC_GROUP_get_curve_name(group))) != NULL) {
+                /* A new key would be generated anyway: take a ready one */
+                precomputed = 1;
+            } else if ((ecdh = EC_KEY_dup(ecdhp)) == NULL) {
                 SSLerr(SSL_F_SSL3_SEND_SERVER_KEY_EXCHANGE, ERR_R_ECDH_LIB);
                 goto err;
             }
@@ -1745,7 +1783,7 @@ int ssl3_send_server_key_exchange(SSL *s)
             s->s3->tmp.ecdh = ecdh;
             if ((EC_KEY_get0_public_key(ecdh) == NULL) ||
                 (EC_KEY_get0_private_key(ecdh) == NULL) ||
-                (s->options & SSL_OP_SINGLE_ECDH_USE)) {
+                ((s->options & SSL_OP_SINGLE_ECDH_USE) && !precomputed)) {
                 if (!EC_KEY_generate_key(ecdh)) {
                     SSLerr(SSL_F_SSL3_SEND_SERVER_KEY_EXCHANGE,
                            ERR_R_ECDH_LIB);
@@ -1987,8 +2025,15 @@ int ssl3_send_server_key_exchange(SSL *s)
                 EVP_SignUpdate(&md_ctx, &(s->s3->server_random[0]),
                                SSL3_RANDOM_SIZE);
                 EVP_SignUpdate(&md_ctx, d, n);
-                if (!EVP_SignFinal(&md_ctx, &(p[2]),
-                                   (unsigned int *)&i, pkey)) {
+#ifndef OPENSSL_NO_EC
+                j = ssl_precomp_ecdsa_sign(s->ctx, &md_ctx, &(p[2]),
+                                           (unsigned int *)&i, pkey);
+#else
+                j = 0;
+#endif
+                if (j < 0 || (j == 0 && !EVP_SignFinal(&md_ctx, &(p[2]),
+                                                       (unsigned int *)&i,
+                                                       pkey))) {
                     SSLerr(SSL_F_SSL3_SEND_SERVER_KEY_EXCHANGE, ERR_LIB_EVP);
                     goto err;
                 }
@@ -2568,6 +2613,52 @@ int ssl3_get_client_key_exchange(SSL *s)
 #endif                          /* OPENSSL_NO_KRB5 */
 
 #ifndef OPENSSL_NO_EC
+    if ((alg_k & SSL_kECDHE) && s->s3->tmp.pkey != NULL) {
+        /* X25519: the ECPoint is the client's raw public value */
+        unsigned char *pms = NULL;
+        size_t pmslen = 0;
+
+        if (n < 1 || n != 1 + *p) {
+            al = SSL_AD_DECODE_ERROR;
+            SSLerr(SSL_F_SSL3_GET_CLIENT_KEY_EXCHANGE, SSL_R_LENGTH_MISMATCH);
+            goto f_err;
+        }
+        if ((clnt_pub_pkey = EVP_PKEY_new()) == NULL
+            || !EVP_PKEY_set_type(clnt_pub_pkey,
+                                  EVP_PKEY_id(s->s3->tmp.pkey))) {
+            SSLerr(SSL_F_SSL3_GET_CLIENT_KEY_EXCHANGE, ERR_R_EVP_LIB);
+            goto err;
+        }
+        if (!EVP_PKEY_set1_tls_encodedpoint(clnt_pub_pkey, p + 1, n - 1)) {
+            al = SSL_AD_DECODE_ERROR;
+            SSLerr(SSL_F_SSL3_GET_CLIENT_KEY_EXCHANGE, SSL_R_BAD_ECPOINT);
+            goto f_err;
+        }
+        if (!ssl_derive(s->s3->tmp.pkey, clnt_pub_pkey, &pms, &pmslen)) {
+            al = SSL_AD_HANDSHAKE_FAILURE;
+            SSLerr(SSL_F_SSL3_GET_CLIENT_KEY_EXCHANGE, ERR_R_EVP_LIB);
+            goto f_err;
+        }
+        EVP_PKEY_free(clnt_pub_pkey);
+        clnt_pub_pkey = NULL;
+        EVP_PKEY_free(s->s3->tmp.pkey);
+        s->s3->tmp.pkey = NULL;
+
+        /* Compute the master secret */
+        s->session->master_key_length =
+            s->method->ssl3_enc->generate_master_secret(s,
+                                                        s->
+                                                        session->master_key,
+                                                        pms, pmslen);
+        OPENSSL_cleanse(pms, pmslen);
+        OPENSSL_free(pms);
+        if (s->session->master_key_length < 0) {
+            al = SSL_AD_INTERNAL_ERROR;
+            SSLerr(SSL_F_SSL3_GET_CLIENT_KEY_EXCHANGE, ERR_R_INTERNAL_ERROR);
+            goto f_err;
+        }
+        return 1;
+    } else
     if (alg_k & (SSL_kECDHE | SSL_kECDHr | SSL_kECDHe)) {
         int ret = 1;
         int field_size = 0;
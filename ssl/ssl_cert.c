@@ -653,6 +653,7 @@ void ssl_sess_cert_free(SESS_CERT *sc)
 #endif
 #ifndef OPENSSL_NO_EC
     EC_KEY_free(sc->peer_ecdh_tmp);
+    EVP_PKEY_free(sc->peer_pkey_tmp);
 #endif
 
     OPENSSL_free(sc);
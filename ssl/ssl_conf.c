@@ -204,6 +204,7 @@ static int ctrl_str_option(SSL_CONF_CTX *cctx, const char *cmd)
         SSL_FLAG_TBL("no_ticket", SSL_OP_NO_TICKET),
 #endif
         SSL_FLAG_TBL_SRV("serverpref", SSL_OP_CIPHER_SERVER_PREFERENCE),
+        SSL_FLAG_TBL_SRV("prioritize_chacha", SSL_OP_PRIORITIZE_CHACHA),
         SSL_FLAG_TBL("legacy_renegotiation",
                      SSL_OP_ALLOW_UNSAFE_LEGACY_RENEGOTIATION),
         SSL_FLAG_TBL_SRV("legacy_server_connect",
@@ -298,6 +299,16 @@ static int cmd_ECDHParameters(SSL_CONF_CTX *cctx, const char *value)
             nid = OBJ_sn2nid(value);
         if (nid == 0)
             return 0;
+        if (nid == NID_X25519) {
+            /* No EC_KEY form: use automatic selection limited to X25519 */
+            if (cctx->ctx)
+                rv = SSL_CTX_set1_curves(cctx->ctx, &nid, 1) > 0
+                    && SSL_CTX_set_ecdh_auto(cctx->ctx, 1) > 0;
+            else if (cctx->ssl)
+                rv = SSL_set1_curves(cctx->ssl, &nid, 1) > 0
+                    && SSL_set_ecdh_auto(cctx->ssl, 1) > 0;
+            return rv > 0;
+        }
         ecdh = EC_KEY_new_by_curve_name(nid);
         if (!ecdh)
             return 0;
@@ -347,6 +358,7 @@ static int cmd_Options(SSL_CONF_CTX *cctx, const char *value)
         SSL_FLAG_TBL("Bugs", SSL_OP_ALL),
         SSL_FLAG_TBL_INV("Compression", SSL_OP_NO_COMPRESSION),
         SSL_FLAG_TBL_SRV("ServerPreference", SSL_OP_CIPHER_SERVER_PREFERENCE),
+        SSL_FLAG_TBL_SRV("PrioritizeChaCha", SSL_OP_PRIORITIZE_CHACHA),
         SSL_FLAG_TBL_SRV("NoResumptionOnRenegotiation",
                          SSL_OP_NO_SESSION_RESUMPTION_ON_RENEGOTIATION),
         SSL_FLAG_TBL_SRV("DHSingle", SSL_OP_SINGLE_DH_USE),
@@ -199,6 +199,20 @@ int SSL_clear(SSL *s)
         s->session = NULL;
     }
 
+    /*
+     * A call paused in SSL_MODE_ASYNC can no longer be resumed once the
+     * connection has been reset, so abandon its job: the call runs to its
+     * end with the operation it was waiting for failing, and its errors are
+     * dropped. SSL_clear() is also called from within the handshake, i.e. by
+     * the job itself.
+     */
+    if (s->job != NULL && s->job != ASYNC_get_current_job()) {
+        ERR_set_mark();
+        ASYNC_free_job(s->job);
+        ERR_pop_to_mark();
+        s->job = NULL;
+    }
+
     s->error = 0;
     s->hit = 0;
     s->shutdown = 0;
@@ -321,6 +335,8 @@ SSL *SSL_new(SSL_CTX *ctx)
     X509_VERIFY_PARAM_inherit(s->param, ctx->param);
     s->quiet_shutdown = ctx->quiet_shutdown;
     s->max_send_fragment = ctx->max_send_fragment;
+    s->dyn_record_threshold = ctx->dyn_record_threshold;
+    s->dyn_record_timeout = ctx->dyn_record_timeout;
 
     CRYPTO_add(&ctx->references, 1, CRYPTO_LOCK_SSL_CTX);
     s->ctx = ctx;
@@ -532,6 +548,17 @@ void SSL_free(SSL *s)
     }
 #endif
 
+    /*
+     * Abandon a call that was paused in SSL_MODE_ASYNC, while the SSL is
+     * still intact for it to run to its end
+     */
+    if (s->job != NULL) {
+        ERR_set_mark();
+        ASYNC_free_job(s->job);
+        ERR_pop_to_mark();
+        s->job = NULL;
+    }
+
     if (s->param)
         X509_VERIFY_PARAM_free(s->param);
 
@@ -944,12 +971,110 @@ int SSL_check_private_key(const SSL *ssl)
                                    ssl->cert->key->privatekey));
 }
 
+/*
+ * Arguments of an SSL call run inside an ASYNC_JOB for SSL_MODE_ASYNC. They
+ * are copied when the job starts, so they must not point into the stack of
+ * the caller.
+ */
+struct ssl_async_args {
+    SSL *s;
+    void *buf;
+    int num;
+    enum { READFUNC, WRITEFUNC, OTHERFUNC } type;
+    union {
+        int (*func_read) (SSL *, void *, int);
+        int (*func_write) (SSL *, const void *, int);
+        int (*func_other) (SSL *);
+    } f;
+};
+
+static int ssl_io_intern(void *vargs)
+{
+    struct ssl_async_args *args = (struct ssl_async_args *)vargs;
+
+    switch (args->type) {
+    case READFUNC:
+        return args->f.func_read(args->s, args->buf, args->num);
+    case WRITEFUNC:
+        return args->f.func_write(args->s, args->buf, args->num);
+    case OTHERFUNC:
+        return args->f.func_other(args->s);
+    }
+    return -1;
+}
+
+/*
+ * Run (or resume) the call described by |args| in an ASYNC_JOB. If the job
+ * pauses, -1 is returned and SSL_get_error() reports SSL_ERROR_WANT_ASYNC.
+ */
+static int ssl_start_async_job(SSL *s, struct ssl_async_args *args)
+{
+    int ret;
+
+    /*
+     * A fresh call into the handshake clears the error queue before doing
+     * anything. Do the same when resuming, so that errors queued by the
+     * application while the job was paused are not taken for ours.
+     */
+    if (s->job != NULL)
+        ERR_clear_error();
+
+    switch (ASYNC_start_job(&s->job, &ret, ssl_io_intern, args,
+                            sizeof(*args))) {
+    case ASYNC_ERR:
+        s->rwstate = SSL_NOTHING;
+        SSLerr(SSL_F_SSL_START_ASYNC_JOB, SSL_R_FAILED_TO_INIT_ASYNC);
+        return -1;
+    case ASYNC_PAUSE:
+        s->rwstate = SSL_ASYNC_PAUSED;
+        return -1;
+    case ASYNC_NO_JOBS:
+        s->rwstate = SSL_ASYNC_NO_JOBS;
+        return -1;
+    case ASYNC_FINISH:
+        s->job = NULL;
+        return ret;
+    default:
+        s->rwstate = SSL_NOTHING;
+        SSLerr(SSL_F_SSL_START_ASYNC_JOB, ERR_R_INTERNAL_ERROR);
+        /* Shouldn't happen */
+        return -1;
+    }
+}
+
+static int ssl_use_async(SSL *s)
+{
+    return (s->mode & SSL_MODE_ASYNC) && ASYNC_get_current_job() == NULL;
+}
+
+static int ssl_async_other(SSL *s, int (*func) (SSL *))
+{
+    struct ssl_async_args args;
+
+    args.s = s;
+    args.buf = NULL;
+    args.num = 0;
+    args.type = OTHERFUNC;
+    args.f.func_other = func;
+    return ssl_start_async_job(s, &args);
+}
+
+int SSL_get_async_wait_fd(SSL *s)
+{
+    if (s->job == NULL)
+        return -1;
+    return ASYNC_get_wait_fd(s->job);
+}
+
 int SSL_accept(SSL *s)
 {
     if (s->handshake_func == 0)
         /* Not properly initialized yet */
         SSL_set_accept_state(s);
 
+    if (ssl_use_async(s))
+        return ssl_async_other(s, s->method->ssl_accept);
+
     return (s->method->ssl_accept(s));
 }
 
@@ -959,6 +1084,9 @@ int SSL_connect(SSL *s)
         /* Not properly initialized yet */
         SSL_set_connect_state(s);
 
+    if (ssl_use_async(s))
+        return ssl_async_other(s, s->method->ssl_connect);
+
     return (s->method->ssl_connect(s));
 }
 
@@ -978,6 +1106,18 @@ int SSL_read(SSL *s, void *buf, int num)
         s->rwstate = SSL_NOTHING;
         return (0);
     }
+
+    if (ssl_use_async(s)) {
+        struct ssl_async_args args;
+
+        args.s = s;
+        args.buf = buf;
+        args.num = num;
+        args.type = READFUNC;
+        args.f.func_read = s->method->ssl_read;
+        return ssl_start_async_job(s, &args);
+    }
+
     return (s->method->ssl_read(s, buf, num));
 }
 
@@ -991,6 +1131,18 @@ int SSL_peek(SSL *s, void *buf, int num)
     if (s->shutdown & SSL_RECEIVED_SHUTDOWN) {
         return (0);
     }
+
+    if (ssl_use_async(s)) {
+        struct ssl_async_args args;
+
+        args.s = s;
+        args.buf = buf;
+        args.num = num;
+        args.type = READFUNC;
+        args.f.func_read = s->method->ssl_peek;
+        return ssl_start_async_job(s, &args);
+    }
+
     return (s->method->ssl_peek(s, buf, num));
 }
 
@@ -1006,6 +1158,18 @@ int SSL_write(SSL *s, const void *buf, int num)
         SSLerr(SSL_F_SSL_WRITE, SSL_R_PROTOCOL_IS_SHUTDOWN);
         return (-1);
     }
+
+    if (ssl_use_async(s)) {
+        struct ssl_async_args args;
+
+        args.s = s;
+        args.buf = (void *)buf;
+        args.num = num;
+        args.type = WRITEFUNC;
+        args.f.func_write = s->method->ssl_write;
+        return ssl_start_async_job(s, &args);
+    }
+
     return (s->method->ssl_write(s, buf, num));
 }
 
@@ -1093,6 +1257,16 @@ long SSL_ctrl(SSL *s, int cmd, long larg, void *parg)
             return 0;
         s->max_send_fragment = larg;
         return 1;
+    case SSL_CTRL_SET_DYN_RECORD_THRESHOLD:
+        if (larg < 0)
+            return 0;
+        s->dyn_record_threshold = larg;
+        return 1;
+    case SSL_CTRL_SET_DYN_RECORD_TIMEOUT:
+        if (larg < 0)
+            return 0;
+        s->dyn_record_timeout = larg;
+        return 1;
     case SSL_CTRL_GET_RI_SUPPORT:
         if (s->s3)
             return s->s3->send_connection_binding;
@@ -1230,6 +1404,21 @@ long SSL_CTX_ctrl(SSL_CTX *ctx, int cmd, long larg, void *parg)
             return 0;
         ctx->max_send_fragment = larg;
         return 1;
+    case SSL_CTRL_SET_DYN_RECORD_THRESHOLD:
+        if (larg < 0)
+            return 0;
+        ctx->dyn_record_threshold = larg;
+        return 1;
+    case SSL_CTRL_SET_DYN_RECORD_TIMEOUT:
+        if (larg < 0)
+            return 0;
+        ctx->dyn_record_timeout = larg;
+        return 1;
+    case SSL_CTRL_PRECOMP_KEYS:
+    case SSL_CTRL_PRECOMP_NONCES:
+    case SSL_CTRL_PRECOMP_KEY_MISSES:
+    case SSL_CTRL_PRECOMP_NONCE_MISSES:
+        return ssl_precomp_stat(ctx->precomp, cmd);
     case SSL_CTRL_CERT_FLAGS:
         return (ctx->cert->cert_flags |= larg);
     case SSL_CTRL_CLEAR_CERT_FLAGS:
@@ -1952,6 +2141,8 @@ SSL_CTX *SSL_CTX_new(const SSL_METHOD *meth)
         ret->comp_methods = SSL_COMP_get_compression_methods();
 
     ret->max_send_fragment = SSL3_RT_MAX_PLAIN_LENGTH;
+    ret->dyn_record_threshold = SSL3_DEFAULT_DYN_RECORD_THRESHOLD;
+    ret->dyn_record_timeout = SSL3_DEFAULT_DYN_RECORD_TIMEOUT;
 
 #ifndef OPENSSL_NO_TLSEXT
     ret->tlsext_servername_callback = 0;
@@ -2047,6 +2238,9 @@ void SSL_CTX_free(SSL_CTX *a)
     if (a->sessions != NULL)
         SSL_CTX_flush_sessions(a, 0);
 
+    /* Stop the precompute threads before anything they might use goes */
+    ssl_precomp_free(a->precomp);
+
     CRYPTO_free_ex_data(CRYPTO_EX_INDEX_SSL_CTX, a, &a->ex_data);
 
     if (a->sessions != NULL)
@@ -2640,6 +2834,12 @@ int SSL_get_error(const SSL *s, int i)
     if ((i < 0) && SSL_want_x509_lookup(s)) {
         return (SSL_ERROR_WANT_X509_LOOKUP);
     }
+    if ((i < 0) && SSL_want_async(s)) {
+        return SSL_ERROR_WANT_ASYNC;
+    }
+    if ((i < 0) && SSL_want_async_job(s)) {
+        return SSL_ERROR_WANT_ASYNC_JOB;
+    }
 
     if (i == 0) {
         if ((s->shutdown & SSL_RECEIVED_SHUTDOWN) &&
@@ -2661,7 +2861,10 @@ int SSL_do_handshake(SSL *s)
     s->method->ssl_renegotiate_check(s);
 
     if (SSL_in_init(s) || SSL_in_before(s)) {
-        ret = s->handshake_func(s);
+        if (ssl_use_async(s))
+            ret = ssl_async_other(s, s->handshake_func);
+        else
+            ret = s->handshake_func(s);
     }
     return (ret);
 }
@@ -164,6 +164,7 @@
 # include <openssl/err.h>
 # include <openssl/ssl.h>
 # include <openssl/symhacks.h>
+# include <openssl/async.h>
 
 #include "record/record.h"
 
@@ -356,6 +357,7 @@
 # define SSL_SEED                0x00000800L
 # define SSL_AES128GCM           0x00001000L
 # define SSL_AES256GCM           0x00002000L
+# define SSL_CHACHA20POLY1305     0x00004000L
 
 # define SSL_AES                 (SSL_AES128|SSL_AES256|SSL_AES128GCM|SSL_AES256GCM)
 # define SSL_CAMELLIA            (SSL_CAMELLIA128|SSL_CAMELLIA256)
@@ -719,6 +721,9 @@ struct ssl_comp_st {
 DECLARE_STACK_OF(SSL_COMP)
 DECLARE_LHASH_OF(SSL_SESSION);
 
+/* Precomputed ECDHE keys and ECDSA nonces, see ssl_precomp.c */
+typedef struct ssl_precomp_st SSL_PRECOMP;
+
 struct ssl_ctx_st {
     const SSL_METHOD *method;
     STACK_OF(SSL_CIPHER) *cipher_list;
@@ -855,6 +860,16 @@ struct ssl_ctx_st {
      */
     unsigned int max_send_fragment;
 
+    /*
+     * SSL_MODE_DYNAMIC_RECORD_SIZE parameters: bytes of application data to
+     * send in small records, and idle seconds before starting over
+     */
+    unsigned long dyn_record_threshold;
+    unsigned int dyn_record_timeout;
+
+    /* Pool set up by SSL_CTX_set_precompute(), or NULL */
+    SSL_PRECOMP *precomp;
+
 #  ifndef OPENSSL_NO_ENGINE
     /*
      * Engine to pass requests for client certs to
@@ -998,6 +1013,8 @@ struct ssl_st {
     /* true when we are actually in SSL_accept() or SSL_connect() */
     int in_handshake;
     int (*handshake_func) (SSL *);
+    /* job the current operation is paused in with SSL_MODE_ASYNC */
+    ASYNC_JOB *job;
     /*
      * Imagine that here's a boolean member "init" that is switched as soon
      * as SSL_set_{accept/connect}_state is called for the first time, so
@@ -1120,6 +1137,8 @@ struct ssl_st {
     /* what was passed, used for SSLv3/TLS rollback check */
     int client_version;
     unsigned int max_send_fragment;
+    unsigned long dyn_record_threshold;
+    unsigned int dyn_record_timeout;
 #  ifndef OPENSSL_NO_TLSEXT
     /* TLS extension debug callback */
     void (*tlsext_debug_cb) (SSL *s, int client_server, int type,
@@ -1279,6 +1298,7 @@ typedef struct ssl3_state_st {
 #  endif
 #  ifndef OPENSSL_NO_EC
         EC_KEY *ecdh;           /* holds short lived ECDH key */
+        EVP_PKEY *pkey;         /* holds short lived X25519 key */
 #  endif
         /* used when SSL_ST_FLUSH_DATA is entered */
         int next_state;
@@ -1642,6 +1662,7 @@ typedef struct sess_cert_st {
 # endif
 # ifndef OPENSSL_NO_EC
     EC_KEY *peer_ecdh_tmp;
+    EVP_PKEY *peer_pkey_tmp;    /* peer's X25519 key */
 # endif
     int references;             /* actually always 1 at the moment */
 } SESS_CERT;
@@ -1959,6 +1980,17 @@ __owur STACK_OF(SSL_CIPHER) *ssl_create_cipher_list(const SSL_METHOD *meth,
                                              STACK_OF(SSL_CIPHER) **sorted,
                                              const char *rule_str, CERT *c);
 void ssl_update_cache(SSL *s, int mode);
+void ssl_precomp_free(SSL_PRECOMP *pool);
+long ssl_precomp_stat(SSL_PRECOMP *pool, int cmd);
+# ifndef OPENSSL_NO_EC
+EC_KEY *ssl_precomp_get_ecdh(SSL_CTX *ctx, int nid);
+__owur EVP_PKEY *ssl_generate_pkey(int id);
+__owur int ssl_derive(EVP_PKEY *privkey, EVP_PKEY *pubkey,
+                      unsigned char **ppms, size_t *ppmslen);
+__owur int ssl_precomp_ecdsa_sign(SSL_CTX *ctx, EVP_MD_CTX *md_ctx,
+                                  unsigned char *sig, unsigned int *siglen,
+                                  EVP_PKEY *pkey);
+# endif
 __owur int ssl_cipher_get_evp(const SSL_SESSION *s, const EVP_CIPHER **enc,
                        const EVP_MD **md, int *mac_pkey_type,
                        int *mac_secret_size, SSL_COMP **comp, int use_etm);
@@ -0,0 +1,496 @@
+/* ssl/ssl_precomp.c */
+/* ====================================================================
+ * Copyright (c) 2015 The OpenSSL Project.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. All advertising materials mentioning features or use of this
+ *    software must display the following acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit. (http://www.openssl.org/)"
+ *
+ * 4. The names "OpenSSL Toolkit" and "OpenSSL Project" must not be used to
+ *    endorse or promote products derived from this software without
+ *    prior written permission. For written permission, please contact
+ *    openssl-core@openssl.org.
+ *
+ * 5. Products derived from this software may not be called "OpenSSL"
+ *    nor may "OpenSSL" appear in their names without prior written
+ *    permission of the OpenSSL Project.
+ *
+ * 6. Redistributions of any form whatsoever must retain the following
+ *    acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit (http://www.openssl.org/)"
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE OpenSSL PROJECT ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE OpenSSL PROJECT OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ====================================================================
+ */
+
+/*
+ * A pool of values for ECDHE-ECDSA server handshakes that can be computed
+ * before they are needed: ephemeral ECDH key pairs and ECDSA (k^-1, r)
+ * pairs. Neither depends on anything but the curve, so background threads
+ * fill per-curve queues while the server is idle and a handshake takes a
+ * ready entry instead of doing the scalar multiplication itself. A curve
+ * gets a queue the first time a handshake asks for it. Each entry is
+ * removed from its queue when it is taken, so it is used at most once,
+ * and its secrets are cleared when it is freed.
+ */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE            /* make sure SCHED_IDLE is declared */
+#endif
+
+#include <stdio.h>
+#include "ssl_locl.h"
+
+#if !defined(OPENSSL_NO_EC) && !defined(OPENSSL_NO_ECDSA) \
+    && defined(OPENSSL_THREADS) && defined(OPENSSL_SYS_UNIX)
+# define PRECOMP_SUPPORTED
+#endif
+
+#ifdef PRECOMP_SUPPORTED
+
+# include <pthread.h>
+# include <sched.h>
+# include <sys/time.h>
+# include <openssl/bn.h>
+# include <openssl/ec.h>
+# include <openssl/ecdsa.h>
+
+# define PRECOMP_ECDH            0
+# define PRECOMP_ECDSA           1
+
+# define PRECOMP_MAX_QUEUES      16
+# define PRECOMP_MAX_DEPTH       1024
+# define PRECOMP_MAX_THREADS     64
+
+/* Milliseconds to wait before refilling a queue after an error, doubling */
+# define PRECOMP_MIN_BACKOFF     10
+# define PRECOMP_MAX_BACKOFF     10000
+
+typedef struct precomp_entry_st {
+    EC_KEY *ecdh;               /* PRECOMP_ECDH */
+    BIGNUM *kinv, *r;           /* PRECOMP_ECDSA */
+    struct precomp_entry_st *next;
+} PRECOMP_ENTRY;
+
+typedef struct {
+    int type;
+    int nid;
+    int num;                    /* entries ready */
+    int pending;                /* entries being computed */
+    int failed;                 /* curve unsupported, never refill */
+    int errors;                 /* consecutive errors since the last entry */
+    struct timeval retry;       /* don't refill before this after an error */
+    PRECOMP_ENTRY *head;
+} PRECOMP_QUEUE;
+
+struct ssl_precomp_st {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int depth;
+    int stop;
+    int nthreads;
+    pthread_t threads[PRECOMP_MAX_THREADS];
+    int nqueues;
+    PRECOMP_QUEUE queues[PRECOMP_MAX_QUEUES];
+    long misses[2];
+};
+
+static void precomp_entry_free(PRECOMP_ENTRY *e)
+{
+    if (e == NULL)
+        return;
+    EC_KEY_free(e->ecdh);
+    if (e->kinv != NULL)
+        BN_clear_free(e->kinv);
+    if (e->r != NULL)
+        BN_clear_free(e->r);
+    OPENSSL_free(e);
+}
+
+/*
+ * Compute an entry. On failure |*unsupported| is set if the curve can never
+ * be used, as opposed to an error such as running out of memory that may go
+ * away.
+ */
+static PRECOMP_ENTRY *precomp_entry_new(int type, int nid, int *unsupported)
+{
+    PRECOMP_ENTRY *e;
+    EC_KEY *eckey;
+    unsigned long err;
+
+    *unsupported = 0;
+    if ((e = OPENSSL_malloc(sizeof(*e))) == NULL)
+        return NULL;
+    memset(e, 0, sizeof(*e));
+    if ((eckey = EC_KEY_new_by_curve_name(nid)) == NULL) {
+        err = ERR_peek_last_error();
+        *unsupported = ERR_GET_LIB(err) == ERR_LIB_EC
+            && ERR_GET_REASON(err) == EC_R_UNKNOWN_GROUP;
+        OPENSSL_free(e);
+        return NULL;
+    }
+    if (type == PRECOMP_ECDH) {
+        e->ecdh = eckey;
+        if (EC_KEY_generate_key(eckey))
+            return e;
+    } else {
+        if (ECDSA_sign_setup(eckey, NULL, &e->kinv, &e->r)) {
+            EC_KEY_free(eckey);
+            return e;
+        }
+        EC_KEY_free(eckey);
+    }
+    precomp_entry_free(e);
+    return NULL;
+}
+
+/*
+ * A queue to refill at time |now|, or NULL if there is none. In that case
+ * |*wake| is set to the earliest time a queue that is waiting after an
+ * error can be retried, if there is one. Called locked.
+ */
+static PRECOMP_QUEUE *precomp_next_queue(SSL_PRECOMP *pool,
+                                         const struct timeval *now,
+                                         struct timeval *wake)
+{
+    int i;
+
+    timerclear(wake);
+    for (i = 0; i < pool->nqueues; i++) {
+        PRECOMP_QUEUE *q = &pool->queues[i];
+
+        if (q->failed || q->num + q->pending >= pool->depth)
+            continue;
+        if (q->errors > 0 && timercmp(now, &q->retry, <)) {
+            if (!timerisset(wake) || timercmp(&q->retry, wake, <))
+                *wake = q->retry;
+            continue;
+        }
+        return q;
+    }
+    return NULL;
+}
+
+/* Hold off refilling |q| after another error. Called locked */
+static void precomp_backoff(PRECOMP_QUEUE *q)
+{
+    long ms = PRECOMP_MAX_BACKOFF;
+
+    if (q->errors < 10 && (PRECOMP_MIN_BACKOFF << q->errors) < ms)
+        ms = PRECOMP_MIN_BACKOFF << q->errors;
+    q->errors++;
+    gettimeofday(&q->retry, NULL);
+    q->retry.tv_sec += ms / 1000;
+    q->retry.tv_usec += (ms % 1000) * 1000;
+    if (q->retry.tv_usec >= 1000000) {
+        q->retry.tv_sec++;
+        q->retry.tv_usec -= 1000000;
+    }
+}
+
+static void *precomp_worker(void *arg)
+{
+    SSL_PRECOMP *pool = arg;
+    PRECOMP_QUEUE *q;
+    PRECOMP_ENTRY *e;
+    struct timeval now, wake;
+    struct timespec ts;
+    int unsupported;
+# ifdef SCHED_IDLE
+    struct sched_param param;
+
+    /* Only run when the CPU has nothing better to do */
+    memset(&param, 0, sizeof(param));
+    pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+# endif
+
+    pthread_mutex_lock(&pool->lock);
+    while (!pool->stop) {
+        gettimeofday(&now, NULL);
+        if ((q = precomp_next_queue(pool, &now, &wake)) == NULL) {
+            if (timerisset(&wake)) {
+                ts.tv_sec = wake.tv_sec;
+                ts.tv_nsec = wake.tv_usec * 1000;
+                pthread_cond_timedwait(&pool->cond, &pool->lock, &ts);
+            } else {
+                pthread_cond_wait(&pool->cond, &pool->lock);
+            }
+            continue;
+        }
+        q->pending++;
+        pthread_mutex_unlock(&pool->lock);
+
+        e = precomp_entry_new(q->type, q->nid, &unsupported);
+        if (e == NULL)
+            ERR_clear_error();
+
+        pthread_mutex_lock(&pool->lock);
+        q->pending--;
+        if (e == NULL) {
+            if (unsupported)
+                q->failed = 1;
+            else
+                precomp_backoff(q);
+        } else {
+            q->errors = 0;
+            if (!pool->stop && q->num < pool->depth) {
+                e->next = q->head;
+                q->head = e;
+                q->num++;
+                e = NULL;
+            }
+        }
+        pthread_mutex_unlock(&pool->lock);
+        precomp_entry_free(e);
+        pthread_mutex_lock(&pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    ERR_remove_thread_state(NULL);
+    return NULL;
+}
+
+void ssl_precomp_free(SSL_PRECOMP *pool)
+{
+    PRECOMP_ENTRY *e;
+    int i;
+
+    if (pool == NULL)
+        return;
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->cond);
+    pthread_mutex_unlock(&pool->lock);
+    for (i = 0; i < pool->nthreads; i++)
+        pthread_join(pool->threads[i], NULL);
+
+    for (i = 0; i < pool->nqueues; i++) {
+        while ((e = pool->queues[i].head) != NULL) {
+            pool->queues[i].head = e->next;
+            precomp_entry_free(e);
+        }
+    }
+    pthread_cond_destroy(&pool->cond);
+    pthread_mutex_destroy(&pool->lock);
+    OPENSSL_free(pool);
+}
+
+static SSL_PRECOMP *precomp_new(int depth, int threads)
+{
+    SSL_PRECOMP *pool;
+
+    if ((pool = OPENSSL_malloc(sizeof(*pool))) == NULL)
+        return NULL;
+    memset(pool, 0, sizeof(*pool));
+    pool->depth = depth;
+    if (pthread_mutex_init(&pool->lock, NULL) != 0) {
+        OPENSSL_free(pool);
+        return NULL;
+    }
+    if (pthread_cond_init(&pool->cond, NULL) != 0) {
+        pthread_mutex_destroy(&pool->lock);
+        OPENSSL_free(pool);
+        return NULL;
+    }
+    for (pool->nthreads = 0; pool->nthreads < threads; pool->nthreads++) {
+        if (pthread_create(&pool->threads[pool->nthreads], NULL,
+                           precomp_worker, pool) != 0) {
+            ssl_precomp_free(pool);
+            return NULL;
+        }
+    }
+    return pool;
+}
+
+/*
+ * Take an entry of |type| for curve |nid|, or return NULL and count a miss.
+ * A miss on a curve without a queue creates one.
+ */
+static PRECOMP_ENTRY *precomp_get(SSL_PRECOMP *pool, int type, int nid)
+{
+    PRECOMP_QUEUE *q = NULL;
+    PRECOMP_ENTRY *e = NULL;
+    int i;
+
+    if (pool == NULL || nid == NID_undef)
+        return NULL;
+
+    pthread_mutex_lock(&pool->lock);
+    for (i = 0; i < pool->nqueues; i++) {
+        if (pool->queues[i].type == type && pool->queues[i].nid == nid) {
+            q = &pool->queues[i];
+            break;
+        }
+    }
+    if (q == NULL && pool->nqueues < PRECOMP_MAX_QUEUES) {
+        q = &pool->queues[pool->nqueues++];
+        q->type = type;
+        q->nid = nid;
+    }
+    if (q != NULL && (e = q->head) != NULL) {
+        q->head = e->next;
+        q->num--;
+    } else {
+        pool->misses[type]++;
+    }
+    if (q != NULL && !q->failed)
+        pthread_cond_signal(&pool->cond);
+    pthread_mutex_unlock(&pool->lock);
+    return e;
+}
+
+EC_KEY *ssl_precomp_get_ecdh(SSL_CTX *ctx, int nid)
+{
+    PRECOMP_ENTRY *e;
+    EC_KEY *ret;
+
+    if ((e = precomp_get(ctx->precomp, PRECOMP_ECDH, nid)) == NULL)
+        return NULL;
+    ret = e->ecdh;
+    e->ecdh = NULL;
+    precomp_entry_free(e);
+    return ret;
+}
+
+int ssl_precomp_ecdsa_sign(SSL_CTX *ctx, EVP_MD_CTX *md_ctx,
+                           unsigned char *sig, unsigned int *siglen,
+                           EVP_PKEY *pkey)
+{
+    PRECOMP_ENTRY *e;
+    EC_KEY *eckey;
+    unsigned char dgst[EVP_MAX_MD_SIZE];
+    unsigned int dgst_len;
+    int ret = -1;
+
+    /* Only for software keys: an ENGINE might not take precomputed values */
+    if (ctx->precomp == NULL || pkey->type != EVP_PKEY_EC
+        || pkey->engine != NULL)
+        return 0;
+    eckey = pkey->pkey.ec;
+    if (EC_KEY_get0_private_key(eckey) == NULL)
+        return 0;
+    e = precomp_get(ctx->precomp, PRECOMP_ECDSA,
+                    EC_GROUP_get_curve_name(EC_KEY_get0_group(eckey)));
+    if (e == NULL)
+        return 0;
+
+    if (EVP_DigestFinal_ex(md_ctx, dgst, &dgst_len)) {
+        if (ECDSA_sign_ex(0, dgst, dgst_len, sig, siglen, e->kinv, e->r,
+                          eckey)) {
+            ret = 1;
+        } else {
+            /* The rare k that gives s == 0: sign with a fresh one */
+            ERR_clear_error();
+            if (ECDSA_sign(0, dgst, dgst_len, sig, siglen, eckey))
+                ret = 1;
+        }
+    }
+    OPENSSL_cleanse(dgst, sizeof(dgst));
+    precomp_entry_free(e);
+    return ret;
+}
+
+long ssl_precomp_stat(SSL_PRECOMP *pool, int cmd)
+{
+    long ret = 0;
+    int i, type;
+
+    if (pool == NULL)
+        return 0;
+    type = (cmd == SSL_CTRL_PRECOMP_KEYS || cmd == SSL_CTRL_PRECOMP_KEY_MISSES)
+        ? PRECOMP_ECDH : PRECOMP_ECDSA;
+    pthread_mutex_lock(&pool->lock);
+    if (cmd == SSL_CTRL_PRECOMP_KEY_MISSES
+        || cmd == SSL_CTRL_PRECOMP_NONCE_MISSES) {
+        ret = pool->misses[type];
+    } else {
+        for (i = 0; i < pool->nqueues; i++)
+            if (pool->queues[i].type == type)
+                ret += pool->queues[i].num;
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return ret;
+}
+
+int SSL_CTX_set_precompute(SSL_CTX *ctx, int depth, int threads)
+{
+    SSL_PRECOMP *pool = NULL;
+
+    if (depth < 0 || depth > PRECOMP_MAX_DEPTH || threads < 0
+        || threads > PRECOMP_MAX_THREADS) {
+        SSLerr(SSL_F_SSL_CTX_SET_PRECOMPUTE, SSL_R_BAD_VALUE);
+        return 0;
+    }
+    /* The pool's threads use the library concurrently with the application */
+    if (depth > 0 && threads > 0 && CRYPTO_get_locking_callback() == NULL) {
+        SSLerr(SSL_F_SSL_CTX_SET_PRECOMPUTE, SSL_R_NO_LOCKING_CALLBACK);
+        return 0;
+    }
+    if (depth > 0 && threads > 0
+        && (pool = precomp_new(depth, threads)) == NULL) {
+        SSLerr(SSL_F_SSL_CTX_SET_PRECOMPUTE, ERR_R_MALLOC_FAILURE);
+        return 0;
+    }
+    ssl_precomp_free(ctx->precomp);
+    ctx->precomp = pool;
+    return 1;
+}
+
+#else
+
+void ssl_precomp_free(SSL_PRECOMP *pool)
+{
+}
+
+# ifndef OPENSSL_NO_EC
+EC_KEY *ssl_precomp_get_ecdh(SSL_CTX *ctx, int nid)
+{
+    return NULL;
+}
+
+int ssl_precomp_ecdsa_sign(SSL_CTX *ctx, EVP_MD_CTX *md_ctx,
+                           unsigned char *sig, unsigned int *siglen,
+                           EVP_PKEY *pkey)
+{
+    return 0;
+}
+# endif
+
+long ssl_precomp_stat(SSL_PRECOMP *pool, int cmd)
+{
+    return 0;
+}
+
+int SSL_CTX_set_precompute(SSL_CTX *ctx, int depth, int threads)
+{
+    if (depth == 0 || threads == 0)
+        return 1;
+    SSLerr(SSL_F_SSL_CTX_SET_PRECOMPUTE, SSL_R_PRECOMPUTE_NOT_SUPPORTED);
+    return 0;
+}
+
+#endif
@@ -232,6 +232,8 @@ typedef struct {
 
 # define TLS_CURVE_CHAR2         0x1
 # define TLS_CURVE_PRIME         0x0
+/* Not an X9.62 curve: no EC_GROUP, keys are handled as an EVP_PKEY */
+# define TLS_CURVE_CUSTOM        0x2
 
 static const tls_curve_info nid_list[] = {
     {NID_sect163k1, 80, TLS_CURVE_CHAR2}, /* sect163k1 (1) */
@@ -262,6 +264,8 @@ static const tls_curve_info nid_list[] = {
     {NID_brainpoolP256r1, 128, TLS_CURVE_PRIME}, /* brainpoolP256r1 (26) */
     {NID_brainpoolP384r1, 192, TLS_CURVE_PRIME}, /* brainpoolP384r1 (27) */
     {NID_brainpoolP512r1, 256, TLS_CURVE_PRIME}, /* brainpool512r1 (28) */
+    /* X25519 (29) */
+    {NID_X25519, 128, TLS_CURVE_CUSTOM},
 };
 
 static const unsigned char ecformats_default[] = {
@@ -271,6 +275,7 @@ static const unsigned char ecformats_default[] = {
 };
 
 static const unsigned char eccurves_default[] = {
+    0, 29,                      /* X25519 (29) */
     0, 14,                      /* sect571r1 (14) */
     0, 13,                      /* sect571k1 (13) */
     0, 25,                      /* secp521r1 (25) */
@@ -375,6 +380,8 @@ int tls1_ec_nid2curve_id(int nid)
         return 27;
     case NID_brainpoolP512r1:  /* brainpool512r1 (28) */
         return 28;
+    case NID_X25519:           /* X25519 (29) */
+        return 29;
     default:
         return 0;
     }
@@ -583,7 +590,7 @@ int tls1_set_curves(unsigned char **pext, size_t *pextlen,
     return 1;
 }
 
-# define MAX_CURVELIST   28
+# define MAX_CURVELIST   29
 
 typedef struct {
     size_t nidcnt;
@@ -0,0 +1,801 @@
+/* test/asynctest.c */
+/* ====================================================================
+ * Copyright (c) 2015 The OpenSSL Project.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. All advertising materials mentioning features or use of this
+ *    software must display the following acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit. (http://www.openssl.org/)"
+ *
+ * 4. The names "OpenSSL Toolkit" and "OpenSSL Project" must not be used to
+ *    endorse or promote products derived from this software without
+ *    prior written permission. For written permission, please contact
+ *    openssl-core@openssl.org.
+ *
+ * 5. Products derived from this software may not be called "OpenSSL"
+ *    nor may "OpenSSL" appear in their names without prior written
+ *    permission of the OpenSSL Project.
+ *
+ * 6. Redistributions of any form whatsoever must retain the following
+ *    acknowledgment:
+ *    "This product includes software developed by the OpenSSL Project
+ *    for use in the OpenSSL Toolkit (http://www.openssl.org/)"
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE OpenSSL PROJECT ``AS IS'' AND ANY
+ * EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE OpenSSL PROJECT OR
+ * ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ====================================================================
+ */
+
+/* Tests for the ASYNC job framework */
+
+#include <stdio.h>
+#include <string.h>
+#include <openssl/async.h>
+#include <openssl/crypto.h>
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#ifndef OPENSSL_NO_ENGINE
+# include <openssl/engine.h>
+#endif
+
+#if defined(OPENSSL_SYS_UNIX) && !defined(OPENSSL_NO_ASYNC)
+# include <sys/types.h>
+# include <sys/time.h>
+# include <unistd.h>
+# define ASYNC_TEST_FD
+#endif
+
+#if defined(ASYNC_TEST_FD) && defined(OPENSSL_THREADS) \
+    && !defined(OPENSSL_NO_ENGINE) && !defined(OPENSSL_NO_RSA) \
+    && !defined(OPENSSL_NO_ECDSA)
+# include <pthread.h>
+# include <openssl/pem.h>
+# include <openssl/rsa.h>
+# include <openssl/ecdsa.h>
+# include <openssl/objects.h>
+# define OFFLOAD_TEST
+#endif
+
+static int ctr = 0;
+static ASYNC_JOB *currjob = NULL;
+
+static int only_pause(void *args)
+{
+    ASYNC_pause_job();
+
+    return 1;
+}
+
+static int add_two(void *args)
+{
+    ctr++;
+    ASYNC_pause_job();
+    ctr++;
+
+    return 2;
+}
+
+static int save_current(void *args)
+{
+    currjob = ASYNC_get_current_job();
+    ASYNC_pause_job();
+
+    return 1;
+}
+
+static int blockpause(void *args)
+{
+    ASYNC_block_pause();
+    ASYNC_pause_job();
+    ASYNC_unblock_pause();
+    ASYNC_pause_job();
+
+    return 1;
+}
+
+/* Sets |ctr| to 1 if the job is abandoned while paused, and 0 otherwise */
+static int abandoned(void *args)
+{
+    ctr = ASYNC_pause_job() == 0 && !ASYNC_can_pause()
+        && ASYNC_pause_job() == 0;
+
+    return 1;
+}
+
+static int copy_args(void *args)
+{
+    int *val = (int *)args;
+
+    ASYNC_pause_job();
+    return *val;
+}
+
+#ifdef ASYNC_TEST_FD
+static int wake_self(void *args)
+{
+    ASYNC_JOB *job = ASYNC_get_current_job();
+
+    ASYNC_wake(job);
+    ASYNC_pause_job();
+    ASYNC_clear_wake(job);
+
+    return 1;
+}
+
+/* Returns 1 if |fd| is readable without blocking */
+static int fd_ready(int fd)
+{
+    fd_set fds;
+    struct timeval tv;
+
+    FD_ZERO(&fds);
+    FD_SET(fd, &fds);
+    tv.tv_sec = 0;
+    tv.tv_usec = 0;
+    return select(fd + 1, &fds, NULL, NULL, &tv) == 1;
+}
+
+/* Waits until |fd| is readable */
+static void fd_wait(int fd)
+{
+    fd_set fds;
+
+    FD_ZERO(&fds);
+    FD_SET(fd, &fds);
+    select(fd + 1, &fds, NULL, NULL, NULL);
+}
+#endif
+
+static int test_ASYNC_init_pool(void)
+{
+    ASYNC_JOB *job1 = NULL, *job2 = NULL, *job3 = NULL;
+    int funcret;
+
+    if (!ASYNC_init_pool(2, 0)
+        || ASYNC_start_job(&job1, &funcret, only_pause, NULL, 0)
+           != ASYNC_PAUSE
+        || ASYNC_start_job(&job2, &funcret, only_pause, NULL, 0)
+           != ASYNC_PAUSE
+        || ASYNC_start_job(&job3, &funcret, only_pause, NULL, 0)
+           != ASYNC_NO_JOBS
+        || ASYNC_start_job(&job1, &funcret, only_pause, NULL, 0)
+           != ASYNC_FINISH
+        || ASYNC_start_job(&job3, &funcret, only_pause, NULL, 0)
+           != ASYNC_PAUSE
+        || ASYNC_start_job(&job2, &funcret, only_pause, NULL, 0)
+           != ASYNC_FINISH
+        || ASYNC_start_job(&job3, &funcret, only_pause, NULL, 0)
+           != ASYNC_FINISH
+        || funcret != 1) {
+        fprintf(stderr, "test_ASYNC_init_pool() failed\n");
+        ASYNC_free_pool();
+        return 0;
+    }
+
+    /* A pool can only be set up once per thread */
+    if (ASYNC_init_pool(2, 0)) {
+        fprintf(stderr, "test_ASYNC_init_pool() allowed a second pool\n");
+        ASYNC_free_pool();
+        return 0;
+    }
+    ERR_clear_error();
+
+    ASYNC_free_pool();
+    return 1;
+}
+
+static int test_ASYNC_start_job(void)
+{
+    ASYNC_JOB *job = NULL;
+    int funcret;
+
+    ctr = 0;
+
+    if (!ASYNC_init_pool(1, 0)
+        || ASYNC_start_job(&job, &funcret, add_two, NULL, 0) != ASYNC_PAUSE
+        || ctr != 1
+        || ASYNC_start_job(&job, &funcret, add_two, NULL, 0) != ASYNC_FINISH
+        || ctr != 2 || funcret != 2 || job != NULL) {
+        fprintf(stderr, "test_ASYNC_start_job() failed\n");
+        ASYNC_free_pool();
+        return 0;
+    }
+
+    ASYNC_free_pool();
+    return 1;
+}
+
+static int test_ASYNC_args(void)
+{
+    ASYNC_JOB *job = NULL;
+    int funcret, val = 42;
+
+    if (!ASYNC_init_pool(1, 0)
+        || ASYNC_start_job(&job, &funcret, copy_args, &val, sizeof(val))
+           != ASYNC_PAUSE) {
+        fprintf(stderr, "test_ASYNC_args() failed\n");
+        ASYNC_free_pool();
+        return 0;
+    }
+
+    /* The job works on its own copy of the arguments */
+    val = 0;
+    if (ASYNC_start_job(&job, &funcret, copy_args, &val, sizeof(val))
+        != ASYNC_FINISH || funcret != 42) {
+        fprintf(stderr, "test_ASYNC_args() failed\n");
+        ASYNC_free_pool();
+        return 0;
+    }
+
+    ASYNC_free_pool();
+    return 1;
+}
+
+static int test_ASYNC_get_current_job(void)
+{
+    ASYNC_JOB *job = NULL;
+    int funcret;
+
+    currjob = NULL;
+
+    if (!ASYNC_init_pool(1, 0)
+        || ASYNC_start_job(&job, &funcret, save_current, NULL, 0)
+           != ASYNC_PAUSE
+        || currjob != job
+        || ASYNC_get_current_job() != NULL
+        || ASYNC_start_job(&job, &funcret, save_current, NULL, 0)
+           != ASYNC_FINISH
+        || funcret != 1) {
+        fprintf(stderr, "test_ASYNC_get_current_job() failed\n");
+        ASYNC_free_pool();
+        return 0;
+    }
+
+    ASYNC_free_pool();
+    return 1;
+}
+
+static int test_ASYNC_block_pause(void)
+{
+    ASYNC_JOB *job = NULL;
+    int funcret;
+
+    if (!ASYNC_init_pool(1, 0)
+        || ASYNC_start_job(&job, &funcret, blockpause, NULL, 0)
+           != ASYNC_PAUSE
+        || ASYNC_start_job(&job, &funcret, blockpause, NULL, 0)
+           != ASYNC_FINISH
+        || funcret != 1) {
+        fprintf(stderr, "test_ASYNC_block_pause() failed\n");
+        ASYNC_free_pool();
+        return 0;
+    }
+
+    ASYNC_free_pool();
+    return 1;
+}
+
+static int test_ASYNC_free_job(void)
+{
+    ASYNC_JOB *job = NULL;
+    int funcret;
+
+    ctr = 0;
+
+    if (!ASYNC_init_pool(1, 0)
+        || ASYNC_start_job(&job, &funcret, abandoned, NULL, 0)
+           != ASYNC_PAUSE) {
+        fprintf(stderr, "test_ASYNC_free_job() failed\n");
+        ASYNC_free_pool();
+        return 0;
+    }
+
+    /*
+     * The abandoned job runs to its end without pausing again, and goes
+     * back to the pool for the next one
+     */
+    ASYNC_free_job(job);
+    job = NULL;
+    if (ctr != 1
+        || ASYNC_start_job(&job, &funcret, add_two, NULL, 0) != ASYNC_PAUSE
+        || ASYNC_start_job(&job, &funcret, add_two, NULL, 0) != ASYNC_FINISH
+        || funcret != 2) {
+        fprintf(stderr, "test_ASYNC_free_job() failed\n");
+        ASYNC_free_pool();
+        return 0;
+    }
+
+    ASYNC_free_pool();
+    return 1;
+}
+
+#ifdef ASYNC_TEST_FD
+static int test_ASYNC_get_wait_fd(void)
+{
+    ASYNC_JOB *job = NULL;
+    int funcret, fd;
+
+    if (!ASYNC_init_pool(1, 0)
+        || ASYNC_start_job(&job, &funcret, wake_self, NULL, 0)
+           != ASYNC_PAUSE
+        || (fd = ASYNC_get_wait_fd(job)) < 0
+        || !fd_ready(fd)
+        || ASYNC_start_job(&job, &funcret, wake_self, NULL, 0)
+           != ASYNC_FINISH
+        || funcret != 1) {
+        fprintf(stderr, "test_ASYNC_get_wait_fd() failed\n");
+        ASYNC_free_pool();
+        return 0;
+    }
+
+    /* The fd is cleared before the job is reused */
+    if (ASYNC_start_job(&job, &funcret, only_pause, NULL, 0) != ASYNC_PAUSE
+        || fd_ready(ASYNC_get_wait_fd(job))
+        || ASYNC_start_job(&job, &funcret, only_pause, NULL, 0)
+           != ASYNC_FINISH) {
+        fprintf(stderr, "test_ASYNC_get_wait_fd() failed\n");
+        ASYNC_free_pool();
+        return 0;
+    }
+
+    ASYNC_free_pool();
+    return 1;
+}
+#endif
+
+#if !defined(OPENSSL_NO_ENGINE) && !defined(OPENSSL_NO_RSA)
+/* Connect a new client and server over a BIO pair. Returns 0 on error. */
+static int ssl_pair(SSL_CTX *sctx, SSL_CTX *cctx, SSL **s, SSL **c)
+{
+    BIO *sbio, *cbio;
+
+    *s = SSL_new(sctx);
+    *c = SSL_new(cctx);
+    if (*s == NULL || *c == NULL
+        || !BIO_new_bio_pair(&sbio, 0, &cbio, 0)) {
+        SSL_free(*s);
+        SSL_free(*c);
+        return 0;
+    }
+    SSL_set_bio(*s, sbio, sbio);
+    SSL_set_bio(*c, cbio, cbio);
+    SSL_set_accept_state(*s);
+    SSL_set_connect_state(*c);
+    return 1;
+}
+
+/*
+ * Run the handshake of |s| and |c|. If |stop| is set, return 2 as soon as
+ * the server is paused, otherwise resume it until the handshake is done,
+ * returning 1. Returns 0 on error.
+ */
+static int ssl_handshake(SSL *s, SSL *c, int stop)
+{
+    int i, r, sdone = 0, cdone = 0;
+
+    for (i = 0; i < 100 && !(sdone && cdone); i++) {
+        if (!cdone) {
+            r = SSL_do_handshake(c);
+            if (r == 1)
+                cdone = 1;
+            else if (SSL_get_error(c, r) != SSL_ERROR_WANT_READ)
+                return 0;
+        }
+        if (!sdone) {
+            r = SSL_do_handshake(s);
+            if (r == 1) {
+                sdone = 1;
+            } else {
+                switch (SSL_get_error(s, r)) {
+                case SSL_ERROR_WANT_ASYNC:
+                    if (stop)
+                        return 2;
+#ifdef ASYNC_TEST_FD
+                    fd_wait(SSL_get_async_wait_fd(s));
+#endif
+                    break;
+                case SSL_ERROR_WANT_READ:
+                    break;
+                default:
+                    return 0;
+                }
+            }
+        }
+    }
+    return sdone && cdone;
+}
+
+/*
+ * Free and clear connections while the server is paused in a job. Only one
+ * job is allowed, so a job leaked by SSL_free() or SSL_clear() makes the
+ * final handshake fail with SSL_ERROR_WANT_ASYNC_JOB.
+ */
+static int test_SSL_free_paused(const char *certfile)
+{
+    SSL_CTX *sctx = NULL, *cctx = NULL;
+    SSL *s = NULL, *c = NULL;
+    ENGINE *e;
+    int ret = 0;
+
+    SSL_library_init();
+    ENGINE_load_dasync();
+    if ((e = ENGINE_by_id("dasync")) == NULL) {
+        ERR_clear_error();
+        printf("dasync engine not available - skipping SSL test\n");
+        return 1;
+    }
+    if (!ENGINE_set_default_RSA(e))
+        goto err;
+
+    sctx = SSL_CTX_new(SSLv23_server_method());
+    cctx = SSL_CTX_new(SSLv23_client_method());
+    if (sctx == NULL || cctx == NULL
+        || !SSL_CTX_use_certificate_file(sctx, certfile, SSL_FILETYPE_PEM)
+        || !SSL_CTX_use_PrivateKey_file(sctx, certfile, SSL_FILETYPE_PEM)
+        || !ASYNC_init_pool(1, 0))
+        goto err;
+    SSL_CTX_set_mode(sctx, SSL_MODE_ASYNC);
+
+    if (!ssl_pair(sctx, cctx, &s, &c) || ssl_handshake(s, c, 1) != 2)
+        goto err;
+    SSL_free(s);
+    SSL_free(c);
+    s = c = NULL;
+
+    /*
+     * SSL_clear() refuses to reset a connection in the middle of the
+     * handshake, but gives up the paused job all the same.
+     */
+    if (!ssl_pair(sctx, cctx, &s, &c) || ssl_handshake(s, c, 1) != 2)
+        goto err;
+    SSL_clear(s);
+    ERR_clear_error();
+    if (SSL_get_async_wait_fd(s) != -1)
+        goto err;
+    SSL_free(s);
+    SSL_free(c);
+    s = c = NULL;
+
+    if (!ssl_pair(sctx, cctx, &s, &c) || ssl_handshake(s, c, 0) != 1)
+        goto err;
+
+    ret = 1;
+ err:
+    if (!ret) {
+        fprintf(stderr, "test_SSL_free_paused() failed\n");
+        ERR_print_errors_fp(stderr);
+    }
+    SSL_free(s);
+    SSL_free(c);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+    ASYNC_free_pool();
+    ENGINE_unregister_RSA(e);
+    ENGINE_free(e);
+    ENGINE_cleanup();
+    return ret;
+}
+#endif
+
+#ifdef OFFLOAD_TEST
+/* The offload engine's workers use the keys alongside the jobs */
+static pthread_mutex_t offload_locks[CRYPTO_NUM_LOCKS];
+
+static void offload_lock_cb(int mode, int type, const char *file, int line)
+{
+    if (mode & CRYPTO_LOCK)
+        pthread_mutex_lock(&offload_locks[type]);
+    else
+        pthread_mutex_unlock(&offload_locks[type]);
+}
+
+# define OFFLOAD_JOBS    8
+
+typedef struct {
+    RSA *rsa;
+    EC_KEY *eckey;
+    int n;
+    /* Ask for an RSA operation that fails */
+    int bad;
+    /* Sign with pausing blocked */
+    int block;
+} OFFLOAD_ARGS;
+
+/*
+ * Sign a digest depending on |n| with both keys and check the signatures.
+ * Returns 1 if they are good, or, for |bad|, if the error came through.
+ */
+static int offload_sign(void *vargs)
+{
+    OFFLOAD_ARGS *args = (OFFLOAD_ARGS *)vargs;
+    unsigned char dgst[SHA_DIGEST_LENGTH], sig[512];
+    unsigned int siglen;
+    ECDSA_SIG *ecsig = NULL;
+    int ok;
+
+    memset(dgst, args->n, sizeof(dgst));
+
+    if (args->bad) {
+        /* Too long for PKCS#1 padding */
+        memset(sig, 1, sizeof(sig));
+        return RSA_private_encrypt(RSA_size(args->rsa), sig, sig, args->rsa,
+                                   RSA_PKCS1_PADDING) == -1
+            && ERR_GET_REASON(ERR_peek_last_error())
+               == RSA_R_DATA_TOO_LARGE_FOR_KEY_SIZE;
+    }
+
+    if (args->block)
+        ASYNC_block_pause();
+    ok = RSA_sign(NID_sha1, dgst, sizeof(dgst), sig, &siglen, args->rsa)
+        && RSA_verify(NID_sha1, dgst, sizeof(dgst), sig, siglen, args->rsa)
+           == 1
+        && (ecsig = ECDSA_do_sign(dgst, sizeof(dgst), args->eckey)) != NULL
+        && ECDSA_do_verify(dgst, sizeof(dgst), ecsig, args->eckey) == 1;
+    if (args->block)
+        ASYNC_unblock_pause();
+    ECDSA_SIG_free(ecsig);
+    return ok;
+}
+
+/*
+ * Run a job for each of the |num| |args| at the same time, resuming them
+ * as their wait fds become readable. Returns 1 if all of them returned 1
+ * and they had to wait for the workers.
+ */
+static int offload_run_jobs(OFFLOAD_ARGS *args, int num)
+{
+    ASYNC_JOB *jobs[OFFLOAD_JOBS];
+    int i, fd, maxfd, funcret, left = num, ok = 1, paused = 0;
+    fd_set fds;
+
+    for (i = 0; i < num; i++)
+        jobs[i] = NULL;
+    while (left > 0) {
+        for (i = 0; i < num; i++) {
+            if (args[i].n < 0)
+                continue;
+            if (jobs[i] != NULL && !fd_ready(ASYNC_get_wait_fd(jobs[i])))
+                continue;
+            switch (ASYNC_start_job(&jobs[i], &funcret, offload_sign,
+                                    &args[i], sizeof(args[i]))) {
+            case ASYNC_PAUSE:
+                paused = 1;
+                break;
+            case ASYNC_FINISH:
+                ok &= funcret;
+                args[i].n = -1;
+                left--;
+                break;
+            default:
+                return 0;
+            }
+        }
+
+        FD_ZERO(&fds);
+        maxfd = -1;
+        for (i = 0; i < num; i++) {
+            if (jobs[i] == NULL)
+                continue;
+            fd = ASYNC_get_wait_fd(jobs[i]);
+            FD_SET(fd, &fds);
+            if (fd > maxfd)
+                maxfd = fd;
+        }
+        if (maxfd >= 0 && select(maxfd + 1, &fds, NULL, NULL, NULL) < 0)
+            return 0;
+    }
+    return ok && paused;
+}
+
+/*
+ * Free connections while the operation their server is paused for is in
+ * flight: first while it is still queued, the workers being made to wait
+ * 200ms for a batch, then once a worker may have taken it. Either way the
+ * job is back in the pool for the next connection.
+ */
+static int test_offload_SSL_free(ENGINE *e, const char *certfile)
+{
+    SSL_CTX *sctx = NULL, *cctx = NULL;
+    SSL *s = NULL, *c = NULL;
+    int ret = 0;
+
+    SSL_library_init();
+    if (!ENGINE_set_default_RSA(e)
+        || !ENGINE_ctrl_cmd_string(e, "BATCH_WINDOW", "200000", 0))
+        goto err;
+    sctx = SSL_CTX_new(SSLv23_server_method());
+    cctx = SSL_CTX_new(SSLv23_client_method());
+    if (sctx == NULL || cctx == NULL
+        || !SSL_CTX_use_certificate_file(sctx, certfile, SSL_FILETYPE_PEM)
+        || !SSL_CTX_use_PrivateKey_file(sctx, certfile, SSL_FILETYPE_PEM))
+        goto err;
+    SSL_CTX_set_mode(sctx, SSL_MODE_ASYNC);
+
+    if (!ssl_pair(sctx, cctx, &s, &c) || ssl_handshake(s, c, 1) != 2)
+        goto err;
+    SSL_free(s);
+    SSL_free(c);
+    s = c = NULL;
+
+    /* Again with a worker taking the operation straight away */
+    if (!ENGINE_ctrl_cmd_string(e, "BATCH_WINDOW", "0", 0)
+        || !ssl_pair(sctx, cctx, &s, &c) || ssl_handshake(s, c, 1) != 2)
+        goto err;
+    usleep(1000);
+    SSL_free(s);
+    SSL_free(c);
+    s = c = NULL;
+
+    if (!ssl_pair(sctx, cctx, &s, &c) || ssl_handshake(s, c, 0) != 1)
+        goto err;
+
+    ret = 1;
+ err:
+    if (!ret) {
+        fprintf(stderr, "test_offload_SSL_free() failed\n");
+        ERR_print_errors_fp(stderr);
+    }
+    SSL_free(s);
+    SSL_free(c);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+    ENGINE_unregister_RSA(e);
+    return ret;
+}
+
+/*
+ * Sign with RSA and ECDSA keys through the offload engine, from jobs that
+ * wait for the worker threads, with pausing blocked and outside of a job,
+ * and check that a failed operation raises its error in the job and that
+ * a connection can be freed while its operation is in flight.
+ */
+static int test_offload_engine(const char *keyfile)
+{
+    OFFLOAD_ARGS args[OFFLOAD_JOBS];
+    ENGINE *e = NULL;
+    BIO *in = NULL;
+    RSA *rsa = NULL;
+    EC_KEY *eckey = NULL;
+    ASYNC_JOB *job = NULL;
+    int i, funcret, init = 0, ret = 0;
+
+    for (i = 0; i < CRYPTO_NUM_LOCKS; i++)
+        pthread_mutex_init(&offload_locks[i], NULL);
+    CRYPTO_set_locking_callback(offload_lock_cb);
+
+    ENGINE_load_offload();
+    if ((e = ENGINE_by_id("offload")) == NULL) {
+        ERR_clear_error();
+        printf("offload engine not available - skipping offload test\n");
+        ret = 1;
+        goto err;
+    }
+    /* Two workers taking up to four operations, waiting 1ms for them */
+    if (!ENGINE_ctrl_cmd_string(e, "THREADS", "2", 0)
+        || !ENGINE_ctrl_cmd_string(e, "BATCH_SIZE", "4", 0)
+        || !ENGINE_ctrl_cmd_string(e, "BATCH_WINDOW", "1000", 0)
+        || !ENGINE_init(e))
+        goto err;
+    init = 1;
+
+    if ((in = BIO_new_file(keyfile, "r")) == NULL
+        || (rsa = PEM_read_bio_RSAPrivateKey(in, NULL, NULL, NULL)) == NULL
+        || !RSA_set_method(rsa, ENGINE_get_RSA(e))
+        || (eckey = EC_KEY_new_by_curve_name(NID_X9_62_prime256v1)) == NULL
+        || !EC_KEY_generate_key(eckey)
+        || !ECDSA_set_method(eckey, ENGINE_get_ECDSA(e))
+        || !ASYNC_init_pool(OFFLOAD_JOBS, 0))
+        goto err;
+
+    /* Outside of a job the caller does the work */
+    memset(args, 0, sizeof(args));
+    args[0].rsa = rsa;
+    args[0].eckey = eckey;
+    args[0].n = 1;
+    if (!offload_sign(&args[0]))
+        goto err;
+
+    /* With pausing blocked the job must not pause either */
+    args[0].block = 1;
+    if (ASYNC_start_job(&job, &funcret, offload_sign, &args[0],
+                        sizeof(args[0])) != ASYNC_FINISH
+        || !funcret)
+        goto err;
+
+    /* Enough jobs to fill batches, one of them with an operation failing */
+    for (i = 0; i < OFFLOAD_JOBS; i++) {
+        args[i].rsa = rsa;
+        args[i].eckey = eckey;
+        args[i].n = i;
+        args[i].bad = i == 3;
+        args[i].block = 0;
+    }
+    if (!offload_run_jobs(args, OFFLOAD_JOBS)
+        || !test_offload_SSL_free(e, keyfile))
+        goto err;
+
+    ret = 1;
+ err:
+    if (!ret) {
+        fprintf(stderr, "test_offload_engine() failed\n");
+        ERR_print_errors_fp(stderr);
+    }
+    ASYNC_free_pool();
+    RSA_free(rsa);
+    EC_KEY_free(eckey);
+    BIO_free(in);
+    if (init)
+        ENGINE_finish(e);
+    ENGINE_free(e);
+    ENGINE_cleanup();
+    CRYPTO_set_locking_callback(NULL);
+    return ret;
+}
+#endif
+
+int main(int argc, char **argv)
+{
+    int ret = 0;
+
+    CRYPTO_malloc_debug_init();
+    CRYPTO_set_mem_debug_options(V_CRYPTO_MDEBUG_ALL);
+    CRYPTO_mem_ctrl(CRYPTO_MEM_CHECK_ON);
+
+    if (!ASYNC_init_pool(0, 0)) {
+        /* Not supported on this platform */
+        ERR_clear_error();
+        printf("ASYNC not supported - skipping ASYNC tests\n");
+        return 0;
+    }
+    ASYNC_free_pool();
+
+    if (!test_ASYNC_init_pool()
+        || !test_ASYNC_start_job()
+        || !test_ASYNC_args()
+        || !test_ASYNC_get_current_job()
+#ifdef ASYNC_TEST_FD
+        || !test_ASYNC_get_wait_fd()
+#endif
+        || !test_ASYNC_block_pause()
+        || !test_ASYNC_free_job()
+#if !defined(OPENSSL_NO_ENGINE) && !defined(OPENSSL_NO_RSA)
+        || (argc > 1 && !test_SSL_free_paused(argv[1]))
+#endif
+#ifdef OFFLOAD_TEST
+        || (argc > 1 && !test_offload_engine(argv[1]))
+#endif
+        ) {
+        ret = 1;
+    } else {
+        printf("PASS\n");
+    }
+
+    ERR_remove_thread_state(NULL);
+    EVP_cleanup();
+    CRYPTO_cleanup_all_ex_data();
+    ERR_free_strings();
+    CRYPTO_mem_leaks_fp(stderr);
+    return ret;
+}
@@ -104,6 +104,7 @@ int test_mod_mul(BIO *bp, BN_CTX *ctx);
 int test_mod_exp(BIO *bp, BN_CTX *ctx);
 int test_mod_exp_mont_consttime(BIO *bp, BN_CTX *ctx);
 int test_mod_exp_mont5(BIO *bp, BN_CTX *ctx);
+int test_mod_inverse_fixed(BIO *bp, BN_CTX *ctx);
 int test_exp(BIO *bp, BN_CTX *ctx);
 int test_gf2m_add(BIO *bp);
 int test_gf2m_mod(BIO *bp);
@@ -118,6 +119,7 @@ int test_kron(BIO *bp, BN_CTX *ctx);
 int test_sqrt(BIO *bp, BN_CTX *ctx);
 int test_small_prime(BIO *bp, BN_CTX *ctx);
 int test_probable_prime_coprime(BIO *bp, BN_CTX *ctx);
+int test_prime_threads(BIO *bp, BN_CTX *ctx);
 int rand_neg(void);
 static int results = 0;
 
@@ -266,6 +268,11 @@ int main(int argc, char *argv[])
         goto err;
     (void)BIO_flush(out);
 
+    message(out, "bn_mod_inverse_fixed");
+    if (!test_mod_inverse_fixed(out, ctx))
+        goto err;
+    (void)BIO_flush(out);
+
     message(out, "BN_exp");
     if (!test_exp(out, ctx))
         goto err;
@@ -295,6 +302,11 @@ int main(int argc, char *argv[])
 #endif
     (void)BIO_flush(out);
 
+    message(out, "Prime generation on several threads");
+    if (!test_prime_threads(out, ctx))
+        goto err;
+    (void)BIO_flush(out);
+
 #ifndef OPENSSL_NO_EC2M
     message(out, "BN_GF2m_add");
     if (!test_gf2m_add(out))
@@ -1047,6 +1059,7 @@ int test_mod_exp_mont_consttime(BIO *bp, BN_CTX *ctx)
 int test_mod_exp_mont5(BIO *bp, BN_CTX *ctx)
 {
     BIGNUM *a, *p, *m, *d, *e;
+    int i, bits;
 
     BN_MONT_CTX *mont;
 
@@ -1104,6 +1117,33 @@ int test_mod_exp_mont5(BIO *bp, BN_CTX *ctx)
         fprintf(stderr, "Modular exponentiation test failed!\n");
         return 0;
     }
+    /*
+     * The RSA3072 and RSA4096 CRT sizes, with random, m-1 and unreduced
+     * 2^bits-1 bases
+     */
+    for (i = 0; i < 6; i++) {
+        bits = i < 3 ? 1536 : 2048;
+        BN_bntest_rand(m, bits, 0, 1);
+        BN_bntest_rand(p, bits, 0, 0);
+        if (i % 3 == 0) {
+            BN_bntest_rand(e, bits - 1, 0, 0);
+        } else if (i % 3 == 1) {
+            BN_copy(e, m);
+            BN_sub_word(e, 1);
+        } else {
+            BN_zero(e);
+            BN_set_bit(e, bits);
+            BN_sub_word(e, 1);
+        }
+        if (!BN_mod_exp_mont_consttime(d, e, p, m, ctx, NULL))
+            return 0;
+        if (!BN_mod_exp_simple(a, e, p, m, ctx))
+            return 0;
+        if (BN_cmp(a, d) != 0) {
+            fprintf(stderr, "Modular exponentiation test failed!\n");
+            return 0;
+        }
+    }
     BN_free(a);
     BN_free(p);
     BN_free(m);
@@ -1112,6 +1152,75 @@ int test_mod_exp_mont5(BIO *bp, BN_CTX *ctx)
     return (1);
 }
 
+/*
+ * Compare the constant-time inverse with BN_mod_inverse() for odd moduli of
+ * all sizes up to the limit, including inputs that have no inverse.
+ */
+int test_mod_inverse_fixed(BIO *bp, BN_CTX *ctx)
+{
+    BIGNUM *a, *m, *r, *s;
+    int i, bits, ok = 0;
+
+    a = BN_new();
+    m = BN_new();
+    r = BN_new();
+    s = BN_new();
+    if (a == NULL || m == NULL || r == NULL || s == NULL)
+        goto err;
+
+    for (i = 0; i < num0 + num1; i++) {
+        bits = 2 + (i * 67) % (BN_MOD_INVERSE_FIXED_MAX_BITS - 1);
+        if (!BN_bntest_rand(m, bits, 0, 1))
+            goto err;
+        switch (i % 4) {
+        case 0:
+            BN_zero(a);
+            break;
+        case 1:
+            if (!BN_sub(a, m, BN_value_one()))
+                goto err;
+            break;
+        default:
+            if (!BN_rand_range(a, m))
+                goto err;
+        }
+        if (i % 8 == 6 && !BN_mul_word(m, 3))
+            goto err;
+        if (i % 8 == 6 && !BN_mul_word(a, 3))
+            goto err;
+
+        if (BN_mod_inverse(s, a, m, ctx) == NULL) {
+            ERR_clear_error();
+            if (bn_mod_inverse_fixed(r, a, m)) {
+                fprintf(stderr, "bn_mod_inverse_fixed() inverted a"
+                        " non-invertible value!\n");
+                goto err;
+            }
+            ERR_clear_error();
+            continue;
+        }
+        if (!bn_mod_inverse_fixed(r, a, m) || BN_cmp(r, s) != 0) {
+            fprintf(stderr, "bn_mod_inverse_fixed() test failed!\n");
+            if (bp != NULL) {
+                BN_print(bp, a);
+                BIO_puts(bp, " ^ -1 % ");
+                BN_print(bp, m);
+                BIO_puts(bp, " - ");
+                BN_print(bp, r);
+                BIO_puts(bp, "\n");
+            }
+            goto err;
+        }
+    }
+    ok = 1;
+ err:
+    BN_free(a);
+    BN_free(m);
+    BN_free(r);
+    BN_free(s);
+    return ok;
+}
+
 int test_exp(BIO *bp, BN_CTX *ctx)
 {
     BIGNUM *a, *b, *d, *e, *one;
@@ -1826,6 +1935,101 @@ int test_probable_prime_coprime(BIO *bp, BN_CTX *ctx)
     return ret;
 }
 #endif
+
+#if defined(OPENSSL_THREADS) && defined(OPENSSL_SYS_UNIX)
+# include <pthread.h>
+
+static pthread_mutex_t *locks;
+
+static void lock_cb(int mode, int type, const char *file, int line)
+{
+    if (mode & CRYPTO_LOCK)
+        pthread_mutex_lock(&locks[type]);
+    else
+        pthread_mutex_unlock(&locks[type]);
+}
+
+/*
+ * Whichever thread finds it, the prime must have the requested size and
+ * form, and pass BN_is_prime_ex().
+ */
+int test_prime_threads(BIO *bp, BN_CTX *ctx)
+{
+    static const struct {
+        int bits, safe;
+        BN_ULONG add, rem;
+    } t[] = {
+        {512, 0, 0, 0}, {512, 0, 0, 0}, {512, 0, 0, 0}, {768, 0, 0, 0},
+        {1024, 0, 0, 0}, {768, 0, 12, 11}, {512, 1, 0, 0}
+    };
+    int i, n = CRYPTO_num_locks(), ret = 0;
+    BIGNUM *r = BN_new(), *q = BN_new(), *add = BN_new(), *rem = BN_new();
+
+    locks = OPENSSL_malloc(n * sizeof(*locks));
+    if (r == NULL || q == NULL || add == NULL || rem == NULL || locks == NULL)
+        goto err;
+    for (i = 0; i < n; i++)
+        pthread_mutex_init(&locks[i], NULL);
+    CRYPTO_set_locking_callback(lock_cb);
+    BN_set_prime_search_threads(4);
+
+    for (i = 0; i < (int)(sizeof(t) / sizeof(t[0])); i++) {
+        if (t[i].add != 0
+            && (!BN_set_word(add, t[i].add) || !BN_set_word(rem, t[i].rem)))
+            goto end;
+        if (!BN_generate_prime_ex(r, t[i].bits, t[i].safe,
+                                  t[i].add != 0 ? add : NULL,
+                                  t[i].add != 0 ? rem : NULL, NULL)) {
+            BIO_printf(bp, "Failed to generate a %d bit prime\n", t[i].bits);
+            goto end;
+        }
+        if (BN_num_bits(r) != t[i].bits) {
+            BIO_printf(bp, "Expected %d bit prime, got %d bit number\n",
+                       t[i].bits, BN_num_bits(r));
+            goto end;
+        }
+        if (t[i].add != 0 && BN_mod_word(r, t[i].add) != t[i].rem) {
+            BIO_printf(bp, "Prime is not %ld mod %ld\n", (long)t[i].rem,
+                       (long)t[i].add);
+            goto end;
+        }
+        if (BN_is_prime_ex(r, BN_prime_checks, ctx, NULL) != 1) {
+            BIO_printf(bp, "Number generated is not prime:\n");
+            BN_print(bp, r);
+            BIO_printf(bp, "\n");
+            goto end;
+        }
+        if (t[i].safe
+            && (!BN_rshift1(q, r)
+                || BN_is_prime_ex(q, BN_prime_checks, ctx, NULL) != 1)) {
+            BIO_printf(bp, "Number generated is not a safe prime:\n");
+            BN_print(bp, r);
+            BIO_printf(bp, "\n");
+            goto end;
+        }
+    }
+    ret = 1;
+
+ end:
+    BN_set_prime_search_threads(1);
+    CRYPTO_set_locking_callback(NULL);
+    for (i = 0; i < n; i++)
+        pthread_mutex_destroy(&locks[i]);
+ err:
+    OPENSSL_free(locks);
+    BN_free(r);
+    BN_free(q);
+    BN_free(add);
+    BN_free(rem);
+    return ret;
+}
+#else
+int test_prime_threads(BIO *bp, BN_CTX *ctx)
+{
+    return 1;
+}
+#endif
+
 int test_lshift(BIO *bp, BN_CTX *ctx, BIGNUM *a_)
 {
     BIGNUM *a, *b, *c, *d;
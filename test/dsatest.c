@@ -80,6 +80,7 @@ int main(int argc, char *argv[])
 # include <openssl/dsa.h>
 
 static int dsa_cb(int p, int n, BN_GENCB *arg);
+static int thread_test(BN_GENCB *cb, DSA *ref);
 
 /*
  * seed, out_p, out_q, out_g are taken from the updated Appendix 5 to FIPS
@@ -196,6 +197,9 @@ int main(int argc, char **argv)
         goto end;
     }
 
+    if (!thread_test(cb, dsa))
+        goto end;
+
     dsa->flags |= DSA_FLAG_NO_EXP_CONSTTIME;
     DSA_generate_key(dsa);
     DSA_sign(0, str1, 20, sig, &siglen, dsa);
@@ -227,6 +231,63 @@ int main(int argc, char **argv)
     EXIT(!ret);
 }
 
+# if defined(OPENSSL_THREADS) && defined(OPENSSL_SYS_UNIX)
+#  include <pthread.h>
+
+static pthread_mutex_t *locks;
+
+static void lock_cb(int mode, int type, const char *file, int line)
+{
+    if (mode & CRYPTO_LOCK)
+        pthread_mutex_lock(&locks[type]);
+    else
+        pthread_mutex_unlock(&locks[type]);
+}
+
+/*
+ * The parameters generated on several threads must be those generated on
+ * one, counter included.
+ */
+static int thread_test(BN_GENCB *cb, DSA *ref)
+{
+    DSA *dsa = NULL;
+    int i, n = CRYPTO_num_locks(), counter, ret = 0;
+    unsigned long h;
+
+    BIO_printf(bio_err, "test generation of DSA parameters on 4 threads\n");
+    locks = OPENSSL_malloc(n * sizeof(*locks));
+    if (locks == NULL)
+        return 0;
+    for (i = 0; i < n; i++)
+        pthread_mutex_init(&locks[i], NULL);
+    CRYPTO_set_locking_callback(lock_cb);
+    BN_set_prime_search_threads(4);
+
+    if ((dsa = DSA_new()) == NULL
+        || !DSA_generate_parameters_ex(dsa, 512, seed, 20, &counter, &h, cb))
+        goto end;
+    if (counter != 105 || h != 2 || BN_cmp(dsa->p, ref->p) != 0
+        || BN_cmp(dsa->q, ref->q) != 0 || BN_cmp(dsa->g, ref->g) != 0) {
+        BIO_printf(bio_err, "parameters differ from single thread\n");
+        goto end;
+    }
+    ret = 1;
+ end:
+    DSA_free(dsa);
+    BN_set_prime_search_threads(1);
+    CRYPTO_set_locking_callback(NULL);
+    for (i = 0; i < n; i++)
+        pthread_mutex_destroy(&locks[i]);
+    OPENSSL_free(locks);
+    return ret;
+}
+# else
+static int thread_test(BN_GENCB *cb, DSA *ref)
+{
+    return 1;
+}
+# endif
+
 static int dsa_cb(int p, int n, BN_GENCB *arg)
 {
     char c = '*';
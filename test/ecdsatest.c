@@ -101,6 +101,7 @@ static const char rnd_seed[] = "string to make the random number generator "
 int x9_62_tests(BIO *);
 int x9_62_test_internal(BIO *out, int nid, const char *r, const char *s);
 int test_builtin(BIO *);
+int test_batch(BIO *);
 
 /* functions to change the RAND_METHOD */
 int change_rand(void);
@@ -518,6 +519,89 @@ int test_builtin(BIO *out)
     return ret;
 }
 
+#define BATCH_NUM       12
+
+/*
+ * Verify signatures on a mix of curves with ECDSA_do_verify_batch() and
+ * check every result against ECDSA_do_verify().
+ */
+int test_batch(BIO *out)
+{
+    static const int nids[] = {
+        NID_X9_62_prime256v1, NID_secp384r1,
+# ifndef OPENSSL_NO_EC2M
+        NID_sect233k1,
+# endif
+    };
+    const int num_nids = sizeof(nids) / sizeof(nids[0]);
+    EC_KEY *eckey[BATCH_NUM];
+    ECDSA_SIG *sig[BATCH_NUM];
+    unsigned char digest[BATCH_NUM][20];
+    const unsigned char *dgst[BATCH_NUM];
+    int dgst_len[BATCH_NUM], res[BATCH_NUM];
+    int i, r, ret = 0;
+
+    BIO_printf(out, "\ntesting ECDSA_do_verify_batch(): ");
+    memset(eckey, 0, sizeof(eckey));
+    memset(sig, 0, sizeof(sig));
+    for (i = 0; i < BATCH_NUM; i++) {
+        eckey[i] = EC_KEY_new_by_curve_name(nids[i % num_nids]);
+        if (eckey[i] == NULL || !EC_KEY_generate_key(eckey[i])
+            || RAND_bytes(digest[i], 20) <= 0
+            || (sig[i] = ECDSA_do_sign(digest[i], 20, eckey[i])) == NULL)
+            goto err;
+        dgst[i] = digest[i];
+        dgst_len[i] = 20;
+    }
+
+    r = ECDSA_do_verify_batch(BATCH_NUM, dgst, dgst_len,
+                              (const ECDSA_SIG *const *)sig, eckey, res);
+    if (r != 1)
+        goto err;
+    for (i = 0; i < BATCH_NUM; i++)
+        if (res[i] != 1)
+            goto err;
+    BIO_printf(out, ".");
+    (void)BIO_flush(out);
+
+    /* wrong digest, wrong key, s out of range and a missing signature */
+    digest[1][0] ^= 1;
+    EC_KEY_free(eckey[3]);
+    eckey[3] = EC_KEY_new_by_curve_name(nids[3 % num_nids]);
+    if (eckey[3] == NULL || !EC_KEY_generate_key(eckey[3])
+        || !BN_set_word(sig[6]->s, 0))
+        goto err;
+    ECDSA_SIG_free(sig[8]);
+    sig[8] = NULL;
+
+    r = ECDSA_do_verify_batch(BATCH_NUM, dgst, dgst_len,
+                              (const ECDSA_SIG *const *)sig, eckey, res);
+    if (r != 0)
+        goto err;
+    for (i = 0; i < BATCH_NUM; i++) {
+        if (res[i] != (i == 8 ? -1 : (i == 1 || i == 3 || i == 6) ? 0 : 1))
+            goto err;
+        if (sig[i] != NULL
+            && res[i] != ECDSA_do_verify(dgst[i], dgst_len[i], sig[i],
+                                         eckey[i]))
+            goto err;
+    }
+    BIO_printf(out, ".");
+    BIO_printf(out, " ok\n");
+    ERR_clear_error();
+    ret = 1;
+
+ err:
+    if (!ret)
+        BIO_printf(out, " failed\n");
+    for (i = 0; i < BATCH_NUM; i++) {
+        EC_KEY_free(eckey[i]);
+        if (sig[i] != NULL)
+            ECDSA_SIG_free(sig[i]);
+    }
+    return ret;
+}
+
 int main(void)
 {
     int ret = 1;
@@ -546,6 +630,8 @@ int main(void)
         goto err;
     if (!test_builtin(out))
         goto err;
+    if (!test_batch(out))
+        goto err;
 
     ret = 0;
  err:
@@ -97,6 +97,15 @@ int main(int argc, char *argv[])
 # include <openssl/rand.h>
 # include <openssl/bn.h>
 # include <openssl/opensslconf.h>
+# ifndef OPENSSL_NO_ECDSA
+#  include <openssl/ecdsa.h>
+# endif
+# ifdef OPENSSL_SYS_UNIX
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+# endif
 
 # if defined(_MSC_VER) && defined(_MIPS_) && (_MSC_VER/100==12)
 /* suppress "too big too optimize" warning */
@@ -1354,6 +1363,38 @@ static void char2_field_tests(void)
 }
 # endif
 
+/*
+ * EC_GROUP_new_by_curve_name() hands out copies of a shared group: check
+ * that changing the generator of |group| does not change the next copy.
+ */
+static int curve_copy_test(EC_GROUP *group, int nid)
+{
+    EC_GROUP *other = NULL;
+    EC_POINT *G = NULL, *P = NULL;
+    BIGNUM *order = NULL, *cofactor = NULL;
+    int ok = 0;
+
+    if ((G = EC_POINT_dup(EC_GROUP_get0_generator(group), group)) == NULL
+        || (P = EC_POINT_new(group)) == NULL
+        || (order = BN_new()) == NULL || (cofactor = BN_new()) == NULL
+        || !EC_GROUP_get_order(group, order, NULL)
+        || !EC_GROUP_get_cofactor(group, cofactor, NULL)
+        || !EC_POINT_dbl(group, P, G, NULL)
+        || !EC_GROUP_set_generator(group, P, order, cofactor)
+        || (other = EC_GROUP_new_by_curve_name(nid)) == NULL)
+        goto err;
+    if (EC_POINT_cmp(other, EC_GROUP_get0_generator(other), G, NULL) == 0)
+        ok = 1;
+
+ err:
+    EC_GROUP_free(other);
+    EC_POINT_free(G);
+    EC_POINT_free(P);
+    BN_free(order);
+    BN_free(cofactor);
+    return ok;
+}
+
 static void internal_curve_test(void)
 {
     EC_builtin_curve *curves = NULL;
@@ -1392,6 +1433,13 @@ static void internal_curve_test(void)
             /* try the next curve */
             continue;
         }
+        if (!curve_copy_test(group, nid)) {
+            ok = 0;
+            fprintf(stdout, "\nEC_GROUP_new_by_curve_name() returned a"
+                    " modified group for curve %s\n", OBJ_nid2sn(nid));
+            EC_GROUP_free(group);
+            continue;
+        }
         fprintf(stdout, ".");
         fflush(stdout);
         EC_GROUP_free(group);
@@ -1406,6 +1454,97 @@ static void internal_curve_test(void)
     return;
 }
 
+/*
+ * Export the generator table of a named curve, install it in an explicit
+ * copy of the curve and check that scalar multiplication is unaffected;
+ * a table for another curve and a damaged table must be rejected.
+ */
+static void precompute_data_test(void)
+{
+    EC_GROUP *named = NULL, *group = NULL, *other = NULL;
+    EC_POINT *P = NULL, *Q = NULL;
+    BIGNUM *p = NULL, *a = NULL, *b = NULL, *order = NULL, *k = NULL;
+    unsigned char *buf = NULL, *bad = NULL;
+    size_t len;
+    int i;
+
+    fprintf(stdout, "testing precomputation tables ... ");
+    fflush(stdout);
+
+    if ((named = EC_GROUP_new_by_curve_name(NID_brainpoolP256r1)) == NULL
+        || (other = EC_GROUP_new_by_curve_name(NID_secp256k1)) == NULL)
+        ABORT;
+    if ((len = EC_GROUP_get_precompute_mult_data(named, NULL, 0,
+                                                 NULL)) == 0)
+        ABORT;
+    if ((buf = OPENSSL_malloc(len)) == NULL
+        || (bad = OPENSSL_malloc(len)) == NULL)
+        ABORT;
+    if (EC_GROUP_get_precompute_mult_data(named, buf, len - 1, NULL) != 0)
+        ABORT;
+    ERR_clear_error();
+    if (EC_GROUP_get_precompute_mult_data(named, buf, len, NULL) != len)
+        ABORT;
+
+    p = BN_new();
+    a = BN_new();
+    b = BN_new();
+    order = BN_new();
+    k = BN_new();
+    if (!p || !a || !b || !order || !k)
+        ABORT;
+    if (!EC_GROUP_get_curve_GFp(named, p, a, b, NULL)
+        || !EC_GROUP_get_order(named, order, NULL))
+        ABORT;
+    if ((group = EC_GROUP_new_curve_GFp(p, a, b, NULL)) == NULL
+        || !EC_GROUP_set_generator(group, EC_GROUP_get0_generator(named),
+                                   order, BN_value_one()))
+        ABORT;
+    if (EC_GROUP_have_precompute_mult(group))
+        ABORT;
+
+    if ((P = EC_POINT_new(group)) == NULL || (Q = EC_POINT_new(group)) == NULL)
+        ABORT;
+    for (i = 0; i < 10; i++) {
+        if (!BN_rand_range(k, order)
+            || !EC_POINT_mul(group, P, k, NULL, NULL, NULL))
+            ABORT;
+        if (i == 0) {
+            if (EC_GROUP_set_precompute_mult_data(other, buf, len, NULL))
+                ABORT;
+            memcpy(bad, buf, len);
+            bad[len - 1] ^= 1;
+            if (EC_GROUP_set_precompute_mult_data(group, bad, len, NULL))
+                ABORT;
+            if (EC_GROUP_set_precompute_mult_data(group, buf, len - 1,
+                                                  NULL))
+                ABORT;
+            ERR_clear_error();
+            if (!EC_GROUP_set_precompute_mult_data(group, buf, len, NULL)
+                || !EC_GROUP_have_precompute_mult(group))
+                ABORT;
+        }
+        if (!EC_POINT_mul(group, Q, k, NULL, NULL, NULL))
+            ABORT;
+        if (EC_POINT_cmp(group, P, Q, NULL) != 0)
+            ABORT;
+    }
+
+    EC_GROUP_clear_free(group);
+    EC_GROUP_free(named);
+    EC_GROUP_free(other);
+    EC_POINT_free(P);
+    EC_POINT_free(Q);
+    BN_free(p);
+    BN_free(a);
+    BN_free(b);
+    BN_free(order);
+    BN_free(k);
+    OPENSSL_free(buf);
+    OPENSSL_free(bad);
+    fprintf(stdout, "ok\n\n");
+}
+
 # ifndef OPENSSL_NO_EC_NISTP_64_GCC_128
 /*
  * nistp_test_params contains magic numbers for testing our optimized
@@ -1469,6 +1608,29 @@ static const struct nistp_test_params nistp_tests_params[] = {
      /* d */
      "c477f9f65c22cce20657faa5b2d1d8122336f851a508a1ed04e479c34985bf96",
      },
+    {
+     /* P-384 */
+     EC_GFp_nistp384_method,
+     384,
+     /* p */
+     "fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffeffffffff0000000000000000ffffffff",
+     /* a */
+     "fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffeffffffff0000000000000000fffffffc",
+     /* b */
+     "b3312fa7e23ee7e4988e056be3f82d19181d9c6efe8141120314088f5013875ac656398d8a2ed19d2a85c8edd3ec2aef",
+     /* Qx */
+     "1fbac8eebd0cbf35640b39efe0808dd774debff20a2a329e91713baf7d7f3c3e81546d883730bee7e48678f857b02ca0",
+     /* Qy */
+     "eb213103bd68ce343365a8a4c3d4555fa385f5330203bdd76ffad1f3affb95751c132007e1b240353cb0a4cf1693bdf9",
+     /* Gx */
+     "aa87ca22be8b05378eb1c71ef320ad746e1d3b628ba79b9859f741e082542a385502f25dbf55296c3a545e3872760ab7",
+     /* Gy */
+     "3617de4a96262c6f5d9e98bf9292dc29f8f41dbd289a147ce9da3113b5f0b8c00a60b1ce1d7e819d7a431d7c90ea0e5f",
+     /* order */
+     "ffffffffffffffffffffffffffffffffffffffffffffffffc7634d81f4372ddf581a0db248b0a77aecec196accc52973",
+     /* d */
+     "c838b85253ef8dc7394fa5808a5183981c7deef5a69ba8f4f2117ffea39cfcd90e95f6cbc854abacab701d50c1f3cf24",
+     },
     {
      /* P-521 */
      EC_GFp_nistp521_method,
@@ -1641,6 +1803,93 @@ static void nistp_tests()
 static const char rnd_seed[] =
     "string to make the random number generator think it has entropy";
 
+/*
+ * Install the table in |file|, written by "openssl ecparam -precompute" for
+ * brainpoolP384r1, for that curve with EC_curve_set_precompute_mult_data().
+ * This has to happen before anything else uses the curve. The table is
+ * mapped read-only where possible, as processes sharing it would do, and
+ * left in place until exit.
+ */
+static void curve_table_test(const char *file)
+{
+    EC_GROUP *group = NULL;
+    EC_KEY *key = NULL;
+    EC_POINT *P = NULL;
+    unsigned char *buf;
+    size_t len;
+# ifndef OPENSSL_NO_ECDSA
+    unsigned char dgst[48];
+    ECDSA_SIG *sig;
+# endif
+# ifdef OPENSSL_SYS_UNIX
+    struct stat st;
+    int fd;
+# else
+    FILE *fp;
+    long n;
+# endif
+
+    fprintf(stdout, "testing precomputation table %s ... ", file);
+    fflush(stdout);
+
+# ifdef OPENSSL_SYS_UNIX
+    if ((fd = open(file, O_RDONLY)) < 0 || fstat(fd, &st) != 0
+        || st.st_size == 0)
+        ABORT;
+    len = st.st_size;
+    buf = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (buf == MAP_FAILED)
+        ABORT;
+# else
+    if ((fp = fopen(file, "rb")) == NULL || fseek(fp, 0, SEEK_END) != 0
+        || (n = ftell(fp)) <= 0 || fseek(fp, 0, SEEK_SET) != 0
+        || (buf = malloc(n)) == NULL || fread(buf, 1, n, fp) != (size_t)n)
+        ABORT;
+    fclose(fp);
+    len = n;
+# endif
+
+    if (EC_curve_set_precompute_mult_data(NID_undef, buf, len))
+        ABORT;
+    ERR_clear_error();
+    if (!EC_curve_set_precompute_mult_data(NID_brainpoolP384r1, buf, len))
+        ABORT;
+    /* The curve has its table now, so a second one is refused */
+    if (EC_curve_set_precompute_mult_data(NID_brainpoolP384r1, buf, len)
+        || ERR_GET_REASON(ERR_peek_last_error()) != EC_R_SLOT_FULL)
+        ABORT;
+    ERR_clear_error();
+
+    if ((group = EC_GROUP_new_by_curve_name(NID_brainpoolP384r1)) == NULL
+        || !EC_GROUP_have_precompute_mult(group))
+        ABORT;
+    if ((key = EC_KEY_new_by_curve_name(NID_brainpoolP384r1)) == NULL
+        || !EC_GROUP_have_precompute_mult(EC_KEY_get0_group(key))
+        || !EC_KEY_generate_key(key))
+        ABORT;
+
+    /* The key made with the table must match d times G as an ordinary point */
+    if ((P = EC_POINT_new(group)) == NULL
+        || !EC_POINT_mul(group, P, NULL, EC_GROUP_get0_generator(group),
+                         EC_KEY_get0_private_key(key), NULL)
+        || EC_POINT_cmp(group, P, EC_KEY_get0_public_key(key), NULL) != 0)
+        ABORT;
+
+# ifndef OPENSSL_NO_ECDSA
+    memset(dgst, 0x5a, sizeof(dgst));
+    if ((sig = ECDSA_do_sign(dgst, sizeof(dgst), key)) == NULL
+        || ECDSA_do_verify(dgst, sizeof(dgst), sig, key) != 1)
+        ABORT;
+    ECDSA_SIG_free(sig);
+# endif
+
+    EC_POINT_free(P);
+    EC_KEY_free(key);
+    EC_GROUP_free(group);
+    fprintf(stdout, "ok\n\n");
+}
+
 int main(int argc, char *argv[])
 {
 
@@ -1658,6 +1907,9 @@ int main(int argc, char *argv[])
 
     RAND_seed(rnd_seed, sizeof rnd_seed); /* or BN_generate_prime may fail */
 
+    if (argc > 1)
+        curve_table_test(argv[1]);
+
     prime_field_tests();
     puts("");
 # ifndef OPENSSL_NO_EC2M
@@ -1669,6 +1921,8 @@ int main(int argc, char *argv[])
     /* test the internal curves */
     internal_curve_test();
 
+    precompute_data_test();
+
 # ifndef OPENSSL_NO_ENGINE
     ENGINE_cleanup();
 # endif
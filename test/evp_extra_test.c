@@ -68,6 +68,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <openssl/bio.h>
 #include <openssl/crypto.h>
 #include <openssl/err.h>
@@ -417,6 +418,97 @@ static int test_EVP_PKCS82PKEY(void)
 }
 #endif
 
+#ifndef OPENSSL_NO_AES
+# define XTS_UNIT_LEN    512
+# define XTS_UNITS       601
+
+/*
+ * Encrypts or decrypts |len| bytes of XTS data units from |in| to |out|,
+ * starting at unit number 0, with the given number of threads and split
+ * into updates of |first| bytes and the rest.
+ */
+static int xts_units(int enc, int threads, size_t first,
+                     const unsigned char *in, unsigned char *out, size_t len)
+{
+    static const unsigned char key[64] = {
+        0x27, 0x18, 0x28, 0x18, 0x28, 0x45, 0x90, 0x45,
+        0x23, 0x53, 0x60, 0x28, 0x74, 0x71, 0x35, 0x26,
+        0x31, 0x41, 0x59, 0x26, 0x53, 0x58, 0x97, 0x93,
+        0x23, 0x84, 0x62, 0x64, 0x33, 0x83, 0x27, 0x95
+    };
+    unsigned char iv[16];
+    EVP_CIPHER_CTX *ctx;
+    int outl, ret = 0;
+
+    memset(iv, 0, sizeof(iv));
+    ctx = EVP_CIPHER_CTX_new();
+    if (ctx == NULL
+        || !EVP_CipherInit_ex(ctx, EVP_aes_256_xts(), NULL, NULL, NULL, enc)
+        || !EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_XTS_SET_UNIT_LEN,
+                                XTS_UNIT_LEN, NULL)
+        || !EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_XTS_SET_THREADS, threads, NULL)
+        || !EVP_CipherInit_ex(ctx, NULL, NULL, key, iv, enc)
+        || !EVP_CipherUpdate(ctx, out, &outl, in, first)
+        || (first < len
+            && !EVP_CipherUpdate(ctx, out + first, &outl, in + first,
+                                 len - first)))
+        goto done;
+    ret = 1;
+
+ done:
+    EVP_CIPHER_CTX_free(ctx);
+    return ret;
+}
+
+/*
+ * Tests that the data units of an XTS update are spread over several
+ * threads without changing the result, including the unit number carried
+ * from one update to the next.
+ */
+static int test_XTS_threads(void)
+{
+    const size_t len = XTS_UNIT_LEN * XTS_UNITS;
+    const size_t first = XTS_UNIT_LEN * 256;
+    unsigned char *pt = NULL, *ct = NULL, *tmp = NULL;
+    size_t i;
+    int ret = 0;
+
+    pt = OPENSSL_malloc(len);
+    ct = OPENSSL_malloc(len);
+    tmp = OPENSSL_malloc(len);
+    if (pt == NULL || ct == NULL || tmp == NULL)
+        goto done;
+    for (i = 0; i < len; i++)
+        pt[i] = (unsigned char)(i * 7 + (i >> 9));
+
+    if (!xts_units(1, 1, len, pt, ct, len))
+        goto done;
+    if (!xts_units(1, 4, len, pt, tmp, len) || memcmp(tmp, ct, len) != 0) {
+        fprintf(stderr, "Threaded XTS encryption differs\n");
+        goto done;
+    }
+    if (!xts_units(1, 4, first, pt, tmp, len) || memcmp(tmp, ct, len) != 0) {
+        fprintf(stderr, "Threaded XTS encryption in two updates differs\n");
+        goto done;
+    }
+    memcpy(tmp, ct, len);
+    if (!xts_units(0, 4, len, tmp, tmp, len) || memcmp(tmp, pt, len) != 0) {
+        fprintf(stderr, "Threaded XTS decryption failed\n");
+        goto done;
+    }
+
+    ret = 1;
+
+ done:
+    if (!ret)
+        ERR_print_errors_fp(stderr);
+    OPENSSL_free(pt);
+    OPENSSL_free(ct);
+    OPENSSL_free(tmp);
+    return ret;
+}
+#endif
+
 int main(void)
 {
     CRYPTO_malloc_debug_init();
@@ -463,6 +555,13 @@ int main(void)
     }
 #endif
 
+#ifndef OPENSSL_NO_AES
+    if (!test_XTS_threads()) {
+        fprintf(stderr, "test_XTS_threads failed\n");
+        return 1;
+    }
+#endif
+
     EVP_cleanup();
     CRYPTO_cleanup_all_ex_data();
     ERR_remove_thread_state(NULL);
@@ -216,6 +216,9 @@ static const struct evp_test_method mac_test_method;
 static const struct evp_test_method psign_test_method, pverify_test_method;
 static const struct evp_test_method pdecrypt_test_method;
 static const struct evp_test_method pverify_recover_test_method;
+static const struct evp_test_method pderive_test_method;
+static const struct evp_test_method oneshot_sign_test_method;
+static const struct evp_test_method oneshot_verify_test_method;
 
 static const struct evp_test_method *evp_test_list[] = {
     &digest_test_method,
@@ -225,6 +228,9 @@ static const struct evp_test_method *evp_test_list[] = {
     &pverify_test_method,
     &pdecrypt_test_method,
     &pverify_recover_test_method,
+    &pderive_test_method,
+    &oneshot_sign_test_method,
+    &oneshot_verify_test_method,
     NULL
 };
 
@@ -600,6 +606,61 @@ static int digest_test_parse(struct evp_test *t,
     return 0;
 }
 
+/*
+ * A batch holds enough copies of the test vector to fill and refill all
+ * streams of a multi-block implementation, followed by messages of many
+ * different lengths, including every length around the padding boundaries.
+ */
+#define DIGEST_BATCH_COPIES     11
+#define DIGEST_BATCH_NUM        200
+#define DIGEST_BATCH_MAX_LEN    10000
+
+/*
+ * Hash a batch with EVP_Digest_batch() and check it against |md|, the
+ * digest of the |len| bytes at |in|, and EVP_Digest() of the other messages.
+ * Returns NULL on success or the error to report.
+ */
+static const char *digest_batch_check(const EVP_MD *type,
+                                      const unsigned char *in, size_t len,
+                                      const unsigned char *md)
+{
+    static unsigned char buf[DIGEST_BATCH_MAX_LEN];
+    const unsigned char *data[DIGEST_BATCH_NUM];
+    size_t count[DIGEST_BATCH_NUM];
+    unsigned char mds[DIGEST_BATCH_NUM][EVP_MAX_MD_SIZE];
+    unsigned char *pmd[DIGEST_BATCH_NUM], one[EVP_MAX_MD_SIZE];
+    int i, j, md_len = EVP_MD_size(type);
+
+    for (i = 0; i < DIGEST_BATCH_MAX_LEN; i++)
+        buf[i] = (unsigned char)(i * 7 + 1);
+    for (i = 0; i < DIGEST_BATCH_NUM; i++) {
+        if (i < DIGEST_BATCH_COPIES) {
+            data[i] = in;
+            count[i] = len;
+        } else {
+            j = i - DIGEST_BATCH_COPIES;
+            data[i] = buf + j;
+            if (j < 140)
+                count[i] = j;
+            else
+                count[i] = (size_t)(j * 97) % (DIGEST_BATCH_MAX_LEN - j);
+        }
+        pmd[i] = mds[i];
+    }
+    if (!EVP_Digest_batch(data, count, pmd, DIGEST_BATCH_NUM, type, NULL))
+        return "DIGEST_BATCH_ERROR";
+    for (i = 0; i < DIGEST_BATCH_NUM; i++) {
+        if (i >= DIGEST_BATCH_COPIES) {
+            if (!EVP_Digest(data[i], count[i], one, NULL, type, NULL))
+                return "DIGEST_BATCH_ERROR";
+            md = one;
+        }
+        if (memcmp(mds[i], md, md_len))
+            return "DIGEST_BATCH_MISMATCH";
+    }
+    return NULL;
+}
+
 static int digest_test_run(struct evp_test *t)
 {
     struct digest_data *mdata = t->data;
@@ -628,6 +689,10 @@ static int digest_test_run(struct evp_test *t)
     err = "DIGEST_MISMATCH";
     if (check_output(t, mdata->output, md, md_len))
         goto err;
+    if (mdata->nrpt == 1
+        && (err = digest_batch_check(mdata->digest, mdata->input,
+                                     mdata->input_len, md)) != NULL)
+        goto err;
     err = NULL;
  err:
     if (mctx)
@@ -663,6 +728,8 @@ struct cipher_data {
     size_t aad_len;
     unsigned char *tag;
     size_t tag_len;
+    /* XTS only: data unit length, 0 for a single unit */
+    size_t unit_len;
 };
 
 static int cipher_test_init(struct evp_test *t, const char *alg)
@@ -687,11 +754,14 @@ static int cipher_test_init(struct evp_test *t, const char *alg)
     cdat->plaintext = NULL;
     cdat->aad = NULL;
     cdat->tag = NULL;
+    cdat->unit_len = 0;
     t->data = cdat;
     if (EVP_CIPHER_mode(cipher) == EVP_CIPH_GCM_MODE
         || EVP_CIPHER_mode(cipher) == EVP_CIPH_OCB_MODE
         || EVP_CIPHER_mode(cipher) == EVP_CIPH_CCM_MODE)
         cdat->aead = EVP_CIPHER_mode(cipher);
+    else if (EVP_CIPHER_flags(cipher) & EVP_CIPH_FLAG_AEAD_CIPHER)
+        cdat->aead = -1;
     else
         cdat->aead = 0;
 
@@ -727,6 +797,11 @@ static int cipher_test_parse(struct evp_test *t, const char *keyword,
         if (!strcmp(keyword, "Tag"))
             return test_bin(value, &cdat->tag, &cdat->tag_len);
     }
+    if (EVP_CIPHER_mode(cdat->cipher) == EVP_CIPH_XTS_MODE
+        && !strcmp(keyword, "UnitLen")) {
+        cdat->unit_len = atoi(value);
+        return 1;
+    }
 
     if (!strcmp(keyword, "Operation")) {
         if (!strcmp(value, "ENCRYPT"))
@@ -740,12 +815,19 @@ static int cipher_test_parse(struct evp_test *t, const char *keyword,
     return 0;
 }
 
-static int cipher_test_enc(struct evp_test *t, int enc)
+/*
+ * Run the test in direction |enc|. With |frag| the input is passed in
+ * pieces: a partial block, the rest of that block and another one, and
+ * then the remainder. With |in_place| the output overwrites the input.
+ */
+static int cipher_test_enc(struct evp_test *t, int enc, int frag,
+                           int in_place)
 {
+    static const size_t frags[] = { 1, 31 };
     struct cipher_data *cdat = t->data;
     unsigned char *in, *out, *tmp = NULL;
-    size_t in_len, out_len;
-    int tmplen, tmpflen;
+    size_t in_len, out_len, off, n, i;
+    int tmplen, tmpflen, chunk;
     EVP_CIPHER_CTX *ctx = NULL;
     const char *err;
     err = "INTERNAL_ERROR";
@@ -768,6 +850,13 @@ static int cipher_test_enc(struct evp_test *t, int enc)
     if (!tmp)
         goto err;
     err = "CIPHERINIT_ERROR";
+    /*
+     * Key the context for the opposite direction first: the initialisation
+     * below then has to clear that state out of the storage it keeps.
+     */
+    if (cdat->key_len == (size_t)EVP_CIPHER_key_length(cdat->cipher)
+        && !EVP_CipherInit_ex(ctx, cdat->cipher, NULL, cdat->key, NULL, !enc))
+        goto err;
     if (!EVP_CipherInit_ex(ctx, cdat->cipher, NULL, NULL, NULL, enc))
         goto err;
     err = "INVALID_IV_LENGTH";
@@ -799,6 +888,13 @@ static int cipher_test_enc(struct evp_test *t, int enc)
         }
     }
 
+    if (cdat->unit_len) {
+        err = "UNIT_LENGTH_SET_ERROR";
+        if (!EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_XTS_SET_UNIT_LEN,
+                                 cdat->unit_len, NULL))
+            goto err;
+    }
+
     err = "INVALID_KEY_LENGTH";
     if (!EVP_CIPHER_CTX_set_key_length(ctx, cdat->key_len))
         goto err;
@@ -827,9 +923,24 @@ static int cipher_test_enc(struct evp_test *t, int enc)
         }
     }
     EVP_CIPHER_CTX_set_padding(ctx, 0);
+    if (in_place) {
+        memcpy(tmp, in, in_len);
+        in = tmp;
+    }
     err = "CIPHERUPDATE_ERROR";
-    if (!EVP_CipherUpdate(ctx, tmp, &tmplen, in, in_len))
+    if (frag) {
+        tmplen = 0;
+        for (off = 0, i = 0; off < in_len; off += n, i++) {
+            n = i < sizeof(frags) / sizeof(frags[0]) ? frags[i] : in_len;
+            if (n > in_len - off)
+                n = in_len - off;
+            if (!EVP_CipherUpdate(ctx, tmp + tmplen, &chunk, in + off, n))
+                goto err;
+            tmplen += chunk;
+        }
+    } else if (!EVP_CipherUpdate(ctx, tmp, &tmplen, in, in_len)) {
         goto err;
+    }
     if (cdat->aead == EVP_CIPH_CCM_MODE)
         tmpflen = 0;
     else {
@@ -868,10 +979,96 @@ static int cipher_test_enc(struct evp_test *t, int enc)
     return err ? 0 : 1;
 }
 
+/* The EVP_AEAD version of |cipher|, if there is one */
+static const EVP_AEAD *cipher_aead(const EVP_CIPHER *cipher)
+{
+    switch (EVP_CIPHER_nid(cipher)) {
+#ifndef OPENSSL_NO_AES
+    case NID_aes_128_gcm:
+        return EVP_aead_aes_128_gcm();
+    case NID_aes_192_gcm:
+        return EVP_aead_aes_192_gcm();
+    case NID_aes_256_gcm:
+        return EVP_aead_aes_256_gcm();
+    case NID_aes_128_ccm:
+        return EVP_aead_aes_128_ccm();
+    case NID_aes_192_ccm:
+        return EVP_aead_aes_192_ccm();
+    case NID_aes_256_ccm:
+        return EVP_aead_aes_256_ccm();
+#endif
+    }
+    return NULL;
+}
+
+/* Seal and open the test data, in place, through |aead| */
+static int cipher_test_aead(struct evp_test *t, const EVP_AEAD *aead)
+{
+    struct cipher_data *cdat = t->data;
+    EVP_AEAD_CTX ctx;
+    unsigned char *buf;
+    size_t len, sealed_len = cdat->ciphertext_len + cdat->tag_len;
+    const char *err = "INTERNAL_ERROR";
+
+    ctx.aead = NULL;
+    buf = OPENSSL_malloc(sealed_len + 1);
+    if (!buf)
+        goto err;
+    err = "AEAD_INIT_ERROR";
+    if (!EVP_AEAD_CTX_init(&ctx, aead, cdat->key, cdat->key_len,
+                           cdat->tag_len))
+        goto err;
+    if (cdat->enc) {
+        memcpy(buf, cdat->plaintext, cdat->plaintext_len);
+        err = "AEAD_SEAL_ERROR";
+        if (!EVP_AEAD_CTX_seal(&ctx, buf, &len, sealed_len, cdat->iv,
+                               cdat->iv_len, buf, cdat->plaintext_len,
+                               cdat->aad, cdat->aad_len))
+            goto err;
+        err = "AEAD_SEAL_MISMATCH";
+        if (len != sealed_len
+            || check_output(t, cdat->ciphertext, buf, cdat->ciphertext_len)
+            || check_output(t, cdat->tag, buf + cdat->ciphertext_len,
+                            cdat->tag_len))
+            goto err;
+    }
+    if (cdat->enc != 1) {
+        memcpy(buf, cdat->ciphertext, cdat->ciphertext_len);
+        memcpy(buf + cdat->ciphertext_len, cdat->tag, cdat->tag_len);
+        err = "AEAD_OPEN_ERROR";
+        if (!EVP_AEAD_CTX_open(&ctx, buf, &len, sealed_len, cdat->iv,
+                               cdat->iv_len, buf, sealed_len,
+                               cdat->aad, cdat->aad_len))
+            goto err;
+        err = "AEAD_OPEN_MISMATCH";
+        if (len != cdat->plaintext_len
+            || check_output(t, cdat->plaintext, buf, len))
+            goto err;
+        /* A corrupted tag must be rejected */
+        memcpy(buf, cdat->ciphertext, cdat->ciphertext_len);
+        memcpy(buf + cdat->ciphertext_len, cdat->tag, cdat->tag_len);
+        buf[sealed_len - 1] ^= 1;
+        err = "AEAD_FORGERY_ACCEPTED";
+        if (EVP_AEAD_CTX_open(&ctx, buf, &len, sealed_len, cdat->iv,
+                              cdat->iv_len, buf, sealed_len,
+                              cdat->aad, cdat->aad_len))
+            goto err;
+        ERR_clear_error();
+    }
+    err = NULL;
+ err:
+    EVP_AEAD_CTX_cleanup(&ctx);
+    if (buf)
+        OPENSSL_free(buf);
+    t->err = err;
+    return err ? 0 : 1;
+}
+
 static int cipher_test_run(struct evp_test *t)
 {
     struct cipher_data *cdat = t->data;
-    int rv;
+    int mode = EVP_CIPHER_mode(cdat->cipher);
+    int rv, i, frag, in_place;
     if (!cdat->key) {
         t->err = "NO_KEY";
         return 0;
@@ -887,24 +1084,36 @@ static int cipher_test_run(struct evp_test *t)
         t->err = "NO_TAG";
         return 0;
     }
-    if (cdat->enc) {
-        rv = cipher_test_enc(t, 1);
-        /* Not fatal errors: return */
-        if (rv != 1) {
-            if (rv < 0)
-                return 0;
-            return 1;
+    for (i = 0; i < 4; i++) {
+        frag = i & 1;
+        in_place = i >> 1;
+        /* These modes take all of their input in a single update */
+        if (frag && (mode == EVP_CIPH_CCM_MODE || mode == EVP_CIPH_XTS_MODE
+                     || mode == EVP_CIPH_WRAP_MODE))
+            continue;
+        if (in_place && mode == EVP_CIPH_WRAP_MODE)
+            continue;
+        if (cdat->enc) {
+            rv = cipher_test_enc(t, 1, frag, in_place);
+            /* Not fatal errors: return */
+            if (rv != 1) {
+                if (rv < 0)
+                    return 0;
+                return 1;
+            }
         }
-    }
-    if (cdat->enc != 1) {
-        rv = cipher_test_enc(t, 0);
-        /* Not fatal errors: return */
-        if (rv != 1) {
-            if (rv < 0)
-                return 0;
-            return 1;
+        if (cdat->enc != 1) {
+            rv = cipher_test_enc(t, 0, frag, in_place);
+            /* Not fatal errors: return */
+            if (rv != 1) {
+                if (rv < 0)
+                    return 0;
+                return 1;
+            }
         }
     }
+    if (cipher_aead(cdat->cipher) != NULL)
+        cipher_test_aead(t, cipher_aead(cdat->cipher));
     return 1;
 }
 
@@ -1237,12 +1446,105 @@ static int verify_test_init(struct evp_test *t, const char *name)
     return pkey_test_init(t, name, 1, EVP_PKEY_verify_init, 0);
 }
 
+#define VERIFY_BATCH_NUM 3
+#define VERIFY_MIXED_NUM 133
+
+/*
+ * Check a batch of valid signatures with a few corrupted entries spread
+ * over it: each entry must get the answer EVP_PKEY_verify() gives it on its
+ * own. The batch is long enough to be verified in parts, some of which are
+ * all valid.
+ */
+static const char *verify_mixed_batch(struct pkey_data *kdata)
+{
+    static const size_t bad_sig[] = { 0, 17, 130 }, bad_tbs = 63;
+    EVP_PKEY_CTX *ctx[VERIFY_MIXED_NUM];
+    const unsigned char *sig[VERIFY_MIXED_NUM], *tbs[VERIFY_MIXED_NUM];
+    size_t siglen[VERIFY_MIXED_NUM], tbslen[VERIFY_MIXED_NUM];
+    size_t len = kdata->output_len, nbad = sizeof(bad_sig) / sizeof(*bad_sig);
+    size_t i;
+    int ret[VERIFY_MIXED_NUM], one, all = 1, brv;
+    unsigned char *sigbuf, *tbsbuf;
+    const char *err = NULL;
+
+    sigbuf = OPENSSL_malloc(len * nbad);
+    tbsbuf = OPENSSL_malloc(kdata->input_len + 1);
+    if (sigbuf == NULL || tbsbuf == NULL) {
+        fprintf(stderr, "Error allocating batch buffers!\n");
+        exit(1);
+    }
+    for (i = 0; i < VERIFY_MIXED_NUM; i++) {
+        ctx[i] = kdata->ctx;
+        sig[i] = kdata->output;
+        siglen[i] = len;
+        tbs[i] = kdata->input;
+        tbslen[i] = kdata->input_len;
+    }
+    /* Flip a bit at the start, the end and the middle of the signature */
+    for (i = 0; i < nbad; i++) {
+        unsigned char *p = sigbuf + i * len;
+
+        memcpy(p, kdata->output, len);
+        p[i == 0 ? 0 : i == 1 ? len - 1 : len / 2] ^= 1;
+        sig[bad_sig[i]] = p;
+    }
+    /* and give one entry a message that differs from the signed one */
+    memcpy(tbsbuf, kdata->input, kdata->input_len);
+    if (kdata->input_len > 0) {
+        tbsbuf[0] ^= 1;
+    } else {
+        tbsbuf[0] = 0;
+        tbslen[bad_tbs] = 1;
+    }
+    tbs[bad_tbs] = tbsbuf;
+
+    brv = EVP_PKEY_verify_batch(ctx, sig, siglen, tbs, tbslen,
+                                VERIFY_MIXED_NUM, ret);
+    for (i = 0; i < VERIFY_MIXED_NUM; i++) {
+        one = EVP_PKEY_verify(ctx[i], sig[i], siglen[i], tbs[i], tbslen[i]);
+        if (one != 1)
+            all = 0;
+        if ((ret[i] == 1) != (one == 1))
+            err = "VERIFY_BATCH_MISMATCH";
+    }
+    /* The corrupted entries must fail, and so must the batch */
+    if (all || brv == 1)
+        err = "VERIFY_BATCH_MISMATCH";
+    OPENSSL_free(sigbuf);
+    OPENSSL_free(tbsbuf);
+    return err;
+}
+
 static int verify_test_run(struct evp_test *t)
 {
     struct pkey_data *kdata = t->data;
-    if (EVP_PKEY_verify(kdata->ctx, kdata->output, kdata->output_len,
-                        kdata->input, kdata->input_len) <= 0)
+    EVP_PKEY_CTX *ctx[VERIFY_BATCH_NUM];
+    const unsigned char *sig[VERIFY_BATCH_NUM], *tbs[VERIFY_BATCH_NUM];
+    size_t siglen[VERIFY_BATCH_NUM], tbslen[VERIFY_BATCH_NUM];
+    int ret[VERIFY_BATCH_NUM], rv, brv, i;
+
+    rv = EVP_PKEY_verify(kdata->ctx, kdata->output, kdata->output_len,
+                         kdata->input, kdata->input_len);
+    /* A batch of copies of the same signature must give the same answer */
+    for (i = 0; i < VERIFY_BATCH_NUM; i++) {
+        ctx[i] = kdata->ctx;
+        sig[i] = kdata->output;
+        siglen[i] = kdata->output_len;
+        tbs[i] = kdata->input;
+        tbslen[i] = kdata->input_len;
+    }
+    brv = EVP_PKEY_verify_batch(ctx, sig, siglen, tbs, tbslen,
+                                VERIFY_BATCH_NUM, ret);
+    for (i = 0; i < VERIFY_BATCH_NUM; i++) {
+        if ((ret[i] == 1) != (rv == 1))
+            brv = -1;
+    }
+    if ((brv == 1) != (rv == 1))
+        t->err = "VERIFY_BATCH_MISMATCH";
+    else if (rv <= 0)
         t->err = "VERIFY_ERROR";
+    else
+        t->err = verify_mixed_batch(kdata);
     return 1;
 }
 
@@ -1253,3 +1555,204 @@ static const struct evp_test_method pverify_test_method = {
     pkey_test_parse,
     verify_test_run
 };
+
+static int pderive_test_init(struct evp_test *t, const char *name)
+{
+    return pkey_test_init(t, name, 0, EVP_PKEY_derive_init, 0);
+}
+
+static int pderive_test_parse(struct evp_test *t,
+                              const char *keyword, const char *value)
+{
+    struct pkey_data *kdata = t->data;
+
+    if (!strcmp(keyword, "PeerKey")) {
+        EVP_PKEY *peer;
+        if (find_key(&peer, value, t->public) == 0)
+            return 0;
+        if (EVP_PKEY_derive_set_peer(kdata->ctx, peer) <= 0)
+            return 0;
+        return 1;
+    }
+    if (!strcmp(keyword, "SharedSecret"))
+        return test_bin(value, &kdata->output, &kdata->output_len);
+    return pkey_test_parse(t, keyword, value);
+}
+
+static int pderive_test_run(struct evp_test *t)
+{
+    struct pkey_data *kdata = t->data;
+    unsigned char *out = NULL;
+    size_t out_len;
+    const char *err = "DERIVE_LENGTH_ERROR";
+
+    if (EVP_PKEY_derive(kdata->ctx, NULL, &out_len) <= 0)
+        goto err;
+    out = OPENSSL_malloc(out_len);
+    if (!out) {
+        fprintf(stderr, "Error allocating output buffer!\n");
+        exit(1);
+    }
+    err = "DERIVE_ERROR";
+    if (EVP_PKEY_derive(kdata->ctx, out, &out_len) <= 0)
+        goto err;
+    err = "SHARED_SECRET_LENGTH_MISMATCH";
+    if (out_len != kdata->output_len)
+        goto err;
+    err = "SHARED_SECRET_MISMATCH";
+    if (check_output(t, kdata->output, out, out_len))
+        goto err;
+    err = NULL;
+ err:
+    if (out)
+        OPENSSL_free(out);
+    t->err = err;
+    return 1;
+}
+
+static const struct evp_test_method pderive_test_method = {
+    "Derive",
+    pderive_test_init,
+    pkey_test_cleanup,
+    pderive_test_parse,
+    pderive_test_run
+};
+
+/*
+ * One-shot EVP_DigestSign() and EVP_DigestVerify() tests: these take the
+ * whole message at once, as needed by schemes like Ed25519 that cannot sign
+ * a precomputed digest.
+ */
+
+struct oneshot_data {
+    /* Context for this operation */
+    EVP_MD_CTX *ctx;
+    /* Message to sign or verify */
+    unsigned char *input;
+    size_t input_len;
+    /* Expected signature */
+    unsigned char *output;
+    size_t output_len;
+};
+
+static int oneshot_test_init(struct evp_test *t, const char *name, int ver)
+{
+    struct oneshot_data *odata;
+    EVP_PKEY *pkey = NULL;
+    int rv = 0;
+    if (ver)
+        rv = find_key(&pkey, name, t->public);
+    if (!rv)
+        rv = find_key(&pkey, name, t->private);
+    if (!rv)
+        return 0;
+    if (!pkey) {
+        t->skip = 1;
+        return 1;
+    }
+
+    odata = OPENSSL_malloc(sizeof(struct oneshot_data));
+    if (!odata)
+        return 0;
+    odata->input = NULL;
+    odata->output = NULL;
+    t->data = odata;
+    odata->ctx = EVP_MD_CTX_create();
+    if (!odata->ctx)
+        return 0;
+    if (ver)
+        rv = EVP_DigestVerifyInit(odata->ctx, NULL, NULL, NULL, pkey);
+    else
+        rv = EVP_DigestSignInit(odata->ctx, NULL, NULL, NULL, pkey);
+    return rv > 0;
+}
+
+static int oneshot_sign_test_init(struct evp_test *t, const char *name)
+{
+    return oneshot_test_init(t, name, 0);
+}
+
+static int oneshot_verify_test_init(struct evp_test *t, const char *name)
+{
+    return oneshot_test_init(t, name, 1);
+}
+
+static void oneshot_test_cleanup(struct evp_test *t)
+{
+    struct oneshot_data *odata = t->data;
+    if (odata->input)
+        OPENSSL_free(odata->input);
+    if (odata->output)
+        OPENSSL_free(odata->output);
+    if (odata->ctx)
+        EVP_MD_CTX_destroy(odata->ctx);
+}
+
+static int oneshot_test_parse(struct evp_test *t,
+                              const char *keyword, const char *value)
+{
+    struct oneshot_data *odata = t->data;
+    if (!strcmp(keyword, "Input"))
+        return test_bin(value, &odata->input, &odata->input_len);
+    if (!strcmp(keyword, "Output"))
+        return test_bin(value, &odata->output, &odata->output_len);
+    return 0;
+}
+
+static int oneshot_sign_test_run(struct evp_test *t)
+{
+    struct oneshot_data *odata = t->data;
+    unsigned char *out = NULL;
+    size_t out_len;
+    const char *err = "SIGN_LENGTH_ERROR";
+
+    if (EVP_DigestSign(odata->ctx, NULL, &out_len, odata->input,
+                       odata->input_len) <= 0)
+        goto err;
+    out = OPENSSL_malloc(out_len);
+    if (!out) {
+        fprintf(stderr, "Error allocating output buffer!\n");
+        exit(1);
+    }
+    err = "SIGN_ERROR";
+    if (EVP_DigestSign(odata->ctx, out, &out_len, odata->input,
+                       odata->input_len) <= 0)
+        goto err;
+    err = "SIGNATURE_LENGTH_MISMATCH";
+    if (out_len != odata->output_len)
+        goto err;
+    err = "SIGNATURE_MISMATCH";
+    if (check_output(t, odata->output, out, out_len))
+        goto err;
+    err = NULL;
+ err:
+    if (out)
+        OPENSSL_free(out);
+    t->err = err;
+    return 1;
+}
+
+static int oneshot_verify_test_run(struct evp_test *t)
+{
+    struct oneshot_data *odata = t->data;
+    if (EVP_DigestVerify(odata->ctx, odata->output, odata->output_len,
+                         odata->input, odata->input_len) <= 0)
+        t->err = "VERIFY_ERROR";
+    return 1;
+}
+
+static const struct evp_test_method oneshot_sign_test_method = {
+    "OneShotDigestSign",
+    oneshot_sign_test_init,
+    oneshot_test_cleanup,
+    oneshot_test_parse,
+    oneshot_sign_test_run
+};
+
+static const struct evp_test_method oneshot_verify_test_method = {
+    "OneShotDigestVerify",
+    oneshot_verify_test_init,
+    oneshot_test_cleanup,
+    oneshot_test_parse,
+    oneshot_verify_test_run
+};
@@ -133,8 +133,9 @@ int main(int argc, char *argv[])
     int i;
     char *p;
 # endif
-    int err = 0;
+    int err = 0, j;
     HMAC_CTX ctx, ctx2;
+    HMAC_KEY hkey;
     unsigned char buf[EVP_MAX_MD_SIZE];
     unsigned int len;
 
@@ -276,22 +277,22 @@ test6:
     if (!HMAC_Init_ex(&ctx, test[7].key, test[7].key_len, EVP_sha1(), NULL)) {
         printf("Failed to initialise HMAC (test 6)\n");
         err++;
-        goto end;
+        goto test7;
     }
     if (!HMAC_Update(&ctx, test[7].data, test[7].data_len)) {
         printf("Error updating HMAC with data (test 6)\n");
         err++;
-        goto end;
+        goto test7;
     }
     if (!HMAC_CTX_copy(&ctx2, &ctx)) {
         printf("Failed to copy HMAC_CTX (test 6)\n");
         err++;
-        goto end;
+        goto test7;
     }
     if (!HMAC_Final(&ctx2, buf, &len)) {
         printf("Error finalising data (test 6)\n");
         err++;
-        goto end;
+        goto test7;
     }
     p = pt(buf, len);
     if (strcmp(p, (char *)test[7].digest) != 0) {
@@ -301,7 +302,67 @@ test6:
     } else {
         printf("test 6 ok\n");
     }
+test7:
+    HMAC_KEY_init(&hkey);
+    HMAC_CTX_init(&ctx);
+    if (HMAC_Init_key(&ctx, &hkey)) {
+        printf("Should fail to initialise HMAC with unset key (test 7)\n");
+        err++;
+        goto end;
+    }
+    if (!HMAC_KEY_set(&hkey, test[4].key, test[4].key_len, EVP_sha1(), NULL)
+        || !HMAC_Init_key(&ctx, &hkey)
+        || !HMAC_Update(&ctx, test[4].data, test[4].data_len)
+        || !HMAC_Final(&ctx, buf, &len)) {
+        printf("Error calculating HMAC with key (test 7)\n");
+        err++;
+        goto end;
+    }
+    p = pt(buf, len);
+    if (strcmp(p, (char *)test[4].digest) != 0) {
+        printf("Error calculating HMAC with key on test 7\n");
+        printf("got %s instead of %s\n", p, test[4].digest);
+        err++;
+        goto end;
+    }
+    if (!HMAC_KEY_set(&hkey, NULL, 0, EVP_sha256(), NULL)
+        || !HMAC_Init_key(&ctx, &hkey)
+        || !HMAC_Update(&ctx, test[5].data, test[5].data_len)
+        || !HMAC_Final(&ctx, buf, &len)) {
+        printf("Error calculating HMAC with key (sha256) (test 7)\n");
+        err++;
+        goto end;
+    }
+    p = pt(buf, len);
+    if (strcmp(p, (char *)test[5].digest) != 0) {
+        printf("Error calculating HMAC with key (sha256) on test 7\n");
+        printf("got %s instead of %s\n", p, test[5].digest);
+        err++;
+        goto end;
+    }
+    /* The second HMAC only copies the key states into the context */
+    for (j = 0; j < 2; j++) {
+        if ((j == 0 && !HMAC_KEY_set(&hkey, test[6].key, test[6].key_len,
+                                     NULL, NULL))
+            || !HMAC_Init_key(&ctx, &hkey)
+            || !HMAC_Update(&ctx, test[6].data, test[6].data_len)
+            || !HMAC_Final(&ctx, buf, &len)) {
+            printf("Error calculating HMAC with new key (test 7)\n");
+            err++;
+            goto end;
+        }
+        p = pt(buf, len);
+        if (strcmp(p, (char *)test[6].digest) != 0) {
+            printf("Error calculating HMAC with new key on test 7\n");
+            printf("got %s instead of %s\n", p, test[6].digest);
+            err++;
+            goto end;
+        }
+    }
+    printf("test 7 ok\n");
 end:
+    HMAC_CTX_cleanup(&ctx);
+    HMAC_KEY_cleanup(&hkey);
     EXIT(err);
 }
 
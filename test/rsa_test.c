@@ -17,6 +17,7 @@ int main(int argc, char *argv[])
 }
 #else
 # include <openssl/rsa.h>
+# include <openssl/evp.h>
 
 # define SetKey \
   key->n = BN_bin2bn(n, sizeof(n)-1, key->n); \
@@ -205,6 +206,483 @@ static int pad_unknown(void)
     return (0);
 }
 
+# define BATCH_NUM 11
+
+/*
+ * Sign with a mix of keys in one RSA_private_encrypt_batch() call and check
+ * that every result matches what RSA_private_encrypt() produces. The 2048
+ * bit key is used often enough to fill the multi-lane exponentiation, if
+ * the CPU has one.
+ */
+static int batch_test(void)
+{
+    RSA *keys[2], *rsa[BATCH_NUM];
+    BIGNUM *e = NULL;
+    unsigned char in[BATCH_NUM][32], out[BATCH_NUM][256], ref[256];
+    const unsigned char *from[BATCH_NUM];
+    unsigned char *to[BATCH_NUM];
+    int flen[BATCH_NUM], padding[BATCH_NUM], ret[BATCH_NUM];
+    int i, num, err = 0;
+
+    keys[0] = RSA_new();
+    keys[1] = RSA_new();
+    e = BN_new();
+    if (keys[0] == NULL || keys[1] == NULL || e == NULL
+        || !BN_set_word(e, RSA_F4)
+        || !RSA_generate_key_ex(keys[0], 2048, e, NULL)) {
+        printf("Batch key generation failed!\n");
+        err = 1;
+        goto end;
+    }
+    key2(keys[1], ref);
+
+    for (i = 0; i < BATCH_NUM; i++) {
+        rsa[i] = keys[i % 4 == 3];
+        memset(in[i], i, sizeof(in[i]));
+        from[i] = in[i];
+        to[i] = out[i];
+        flen[i] = sizeof(in[i]);
+        padding[i] = i % 2 ? RSA_X931_PADDING : RSA_PKCS1_PADDING;
+    }
+    /* This one must fail without affecting the others */
+    flen[5] = RSA_size(rsa[5]);
+
+    if (RSA_private_encrypt_batch(BATCH_NUM, flen, from, to, rsa, padding,
+                                  ret) != 0 || ret[5] != -1) {
+        printf("Batch signing did not fail!\n");
+        err = 1;
+    }
+    ERR_clear_error();
+    for (i = 0; i < BATCH_NUM; i++) {
+        if (i == 5)
+            continue;
+        num = RSA_private_encrypt(flen[i], from[i], ref, rsa[i], padding[i]);
+        if (num <= 0 || ret[i] != num || memcmp(ref, out[i], num) != 0) {
+            printf("Batch signature %d differs!\n", i);
+            err = 1;
+        }
+    }
+    if (!err)
+        printf("Batch signing ok\n");
+
+ end:
+    RSA_free(keys[0]);
+    RSA_free(keys[1]);
+    BN_free(e);
+    return err;
+}
+
+# define EVP_BATCH_NUM 9
+
+/*
+ * Sign with EVP_PKEY_sign_batch() using PKCS #1, PSS and X9.31 padding and
+ * two keys, one entry of which has a wrong digest length and must fail on
+ * its own, and check every other signature with EVP_PKEY_verify().
+ */
+static int evp_batch_test(void)
+{
+    static const int pad[] = {
+        RSA_PKCS1_PADDING, RSA_PKCS1_PSS_PADDING, RSA_X931_PADDING
+    };
+    RSA *rsa;
+    EVP_PKEY *pkey[2] = { NULL, NULL };
+    EVP_PKEY_CTX *ctx[EVP_BATCH_NUM], *vctx;
+    BIGNUM *e;
+    unsigned char tbs[EVP_BATCH_NUM][32], sig[EVP_BATCH_NUM][256], c[256];
+    unsigned char *sigs[EVP_BATCH_NUM];
+    const unsigned char *tbsp[EVP_BATCH_NUM];
+    size_t siglen[EVP_BATCH_NUM], tbslen[EVP_BATCH_NUM];
+    int i, err = 0;
+
+    memset(ctx, 0, sizeof(ctx));
+    e = BN_new();
+    pkey[0] = EVP_PKEY_new();
+    pkey[1] = EVP_PKEY_new();
+    if (e == NULL || pkey[0] == NULL || pkey[1] == NULL
+        || !BN_set_word(e, RSA_F4)
+        || (rsa = RSA_new()) == NULL || !EVP_PKEY_assign_RSA(pkey[0], rsa)
+        || !RSA_generate_key_ex(rsa, 2048, e, NULL)
+        || (rsa = RSA_new()) == NULL || !EVP_PKEY_assign_RSA(pkey[1], rsa)) {
+        printf("EVP batch key generation failed!\n");
+        err = 1;
+        goto end;
+    }
+    key3(rsa, c);
+
+    for (i = 0; i < EVP_BATCH_NUM; i++) {
+        if ((ctx[i] = EVP_PKEY_CTX_new(pkey[i % 4 == 3], NULL)) == NULL
+            || EVP_PKEY_sign_init(ctx[i]) <= 0
+            || EVP_PKEY_CTX_set_rsa_padding(ctx[i], pad[i % 3]) <= 0
+            || EVP_PKEY_CTX_set_signature_md(ctx[i], EVP_sha256()) <= 0) {
+            printf("EVP batch context setup failed!\n");
+            err = 1;
+            goto end;
+        }
+        memset(tbs[i], i, sizeof(tbs[i]));
+        tbsp[i] = tbs[i];
+        tbslen[i] = sizeof(tbs[i]);
+        sigs[i] = sig[i];
+        siglen[i] = sizeof(sig[i]);
+    }
+    /* This one must fail without affecting the others */
+    tbslen[4] = 20;
+
+    if (EVP_PKEY_sign_batch(ctx, sigs, siglen, tbsp, tbslen,
+                            EVP_BATCH_NUM) > 0 || siglen[4] != 0) {
+        printf("EVP batch signing did not fail!\n");
+        err = 1;
+    }
+    ERR_clear_error();
+    for (i = 0; i < EVP_BATCH_NUM; i++) {
+        if (i == 4)
+            continue;
+        vctx = EVP_PKEY_CTX_new(pkey[i % 4 == 3], NULL);
+        if (vctx == NULL || EVP_PKEY_verify_init(vctx) <= 0
+            || EVP_PKEY_CTX_set_rsa_padding(vctx, pad[i % 3]) <= 0
+            || EVP_PKEY_CTX_set_signature_md(vctx, EVP_sha256()) <= 0
+            || EVP_PKEY_verify(vctx, sig[i], siglen[i], tbs[i],
+                               tbslen[i]) != 1) {
+            printf("EVP batch signature %d does not verify!\n", i);
+            err = 1;
+        }
+        EVP_PKEY_CTX_free(vctx);
+    }
+    if (!err)
+        printf("EVP batch signing ok\n");
+
+ end:
+    for (i = 0; i < EVP_BATCH_NUM; i++)
+        EVP_PKEY_CTX_free(ctx[i]);
+    EVP_PKEY_free(pkey[0]);
+    EVP_PKEY_free(pkey[1]);
+    BN_free(e);
+    return err;
+}
+
+/*
+ * A DigestInfo that doesn't fit the key must be refused before anything is
+ * written: the buffers it goes into are only RSA_size() bytes long. A 256
+ * bit key has room for neither a bare MD5+SHA1 digest with PKCS #1 padding
+ * nor a SHA512 one with X9.31 padding.
+ */
+static int small_key_test(void)
+{
+    RSA *rsa;
+    EVP_PKEY *pkey = NULL;
+    EVP_PKEY_CTX *pctx[2] = { NULL, NULL };
+    BIGNUM *e;
+    unsigned char m[64], sig[2][32], *sigs[2];
+    const unsigned char *tbs[2];
+    size_t siglen[2], tbslen[2];
+    unsigned int len;
+    int i, err = 0;
+
+    memset(m, 0x55, sizeof(m));
+    rsa = RSA_new();
+    e = BN_new();
+    pkey = EVP_PKEY_new();
+    if (rsa == NULL || e == NULL || pkey == NULL || !BN_set_word(e, RSA_F4)
+        || !RSA_generate_key_ex(rsa, 256, e, NULL)
+        || !EVP_PKEY_set1_RSA(pkey, rsa)) {
+        printf("Small key generation failed!\n");
+        err = 1;
+        goto end;
+    }
+
+    if (RSA_sign(NID_md5_sha1, m, 36, sig[0], &len, rsa)
+        || ERR_GET_REASON(ERR_get_error()) != RSA_R_DIGEST_TOO_BIG_FOR_RSA_KEY) {
+        printf("MD5+SHA1 signature with a small key not refused!\n");
+        err = 1;
+    }
+    ERR_clear_error();
+
+    for (i = 0; i < 2; i++) {
+        if ((pctx[i] = EVP_PKEY_CTX_new(pkey, NULL)) == NULL
+            || EVP_PKEY_sign_init(pctx[i]) <= 0
+            || EVP_PKEY_CTX_set_rsa_padding(pctx[i], i ? RSA_X931_PADDING
+                                            : RSA_PKCS1_PADDING) <= 0
+            || EVP_PKEY_CTX_set_signature_md(pctx[i], EVP_sha512()) <= 0) {
+            printf("Small key context setup failed!\n");
+            err = 1;
+            goto end;
+        }
+        sigs[i] = sig[i];
+        siglen[i] = sizeof(sig[i]);
+        tbs[i] = m;
+        tbslen[i] = sizeof(m);
+        if (EVP_PKEY_sign(pctx[i], sig[i], &siglen[i], m, tbslen[i]) > 0) {
+            printf("Oversized signature %d with a small key not refused!\n",
+                   i);
+            err = 1;
+        }
+        siglen[i] = sizeof(sig[i]);
+    }
+    if (EVP_PKEY_sign_batch(pctx, sigs, siglen, tbs, tbslen, 2) > 0
+        || siglen[0] != 0 || siglen[1] != 0) {
+        printf("Oversized batch signature with a small key not refused!\n");
+        err = 1;
+    }
+    ERR_clear_error();
+    if (!err)
+        printf("Small key signing ok\n");
+
+ end:
+    EVP_PKEY_CTX_free(pctx[0]);
+    EVP_PKEY_CTX_free(pctx[1]);
+    EVP_PKEY_free(pkey);
+    RSA_free(rsa);
+    BN_free(e);
+    return err;
+}
+
+/*
+ * Generate keys with more than two primes and check that they survive DER
+ * encoding and that the private key operation gives c^d mod n, both one at a
+ * time and batched. The public exponent is removed for this, so that a
+ * wrong CRT result isn't caught and recomputed without the CRT.
+ */
+static int multi_prime_test(void)
+{
+    static const int bits[] = { 1024, 4096 }, primes[] = { 3, 4 };
+    RSA *key = NULL, *key2 = NULL, *rsa[2];
+    BIGNUM *e, *c, *m, *pub;
+    BN_CTX *ctx;
+    unsigned char in[512], out[2][512], *der = NULL;
+    const unsigned char *p, *from[2];
+    unsigned char *to[2];
+    int flen[2], padding[2], ret[2];
+    int i, j, len, num, err = 0;
+
+    e = BN_new();
+    c = BN_new();
+    m = BN_new();
+    ctx = BN_CTX_new();
+    if (e == NULL || c == NULL || m == NULL || ctx == NULL
+        || !BN_set_word(e, RSA_F4)) {
+        err = 1;
+        goto end;
+    }
+
+    for (i = 0; i < 2 && !err; i++) {
+        key = RSA_new();
+        if (key == NULL
+            || !RSA_generate_multi_prime_key(key, bits[i], primes[i], e, NULL)
+            || RSA_get_multi_prime_extra_count(key) != primes[i] - 2
+            || BN_num_bits(key->n) != bits[i] || RSA_check_key(key) != 1) {
+            printf("Multi-prime key generation failed!\n");
+            err = 1;
+            break;
+        }
+
+        len = i2d_RSAPrivateKey(key, &der);
+        p = der;
+        key2 = d2i_RSAPrivateKey(NULL, &p, len);
+        if (len <= 0 || key2 == NULL || key2->version != RSA_ASN1_VERSION_MULTI
+            || RSA_get_multi_prime_extra_count(key2) != primes[i] - 2
+            || BN_cmp(key->d, key2->d) != 0 || RSA_check_key(key2) != 1) {
+            printf("Multi-prime key encoding failed!\n");
+            err = 1;
+            break;
+        }
+
+        key2->flags |= RSA_FLAG_NO_BLINDING;
+        pub = key2->e;
+        key2->e = NULL;
+        num = RSA_size(key2);
+        for (j = 0; j < 4; j++) {
+            if (j == 2)
+                key2->flags |= RSA_FLAG_NO_CONSTTIME;
+            RAND_bytes(in, num);
+            in[0] = 0;
+            if (BN_bin2bn(in, num, c) == NULL
+                || !BN_mod_exp(m, c, key2->d, key2->n, ctx))
+                err = 1;
+            if (RSA_private_decrypt(num, in, out[0], key2,
+                                    RSA_NO_PADDING) != num
+                || BN_bin2bn(out[0], num, c) == NULL || BN_cmp(c, m) != 0)
+                err = 1;
+        }
+
+        key2->flags &= ~RSA_FLAG_NO_CONSTTIME;
+        for (j = 0; j < 2; j++) {
+            rsa[j] = key2;
+            from[j] = in;
+            to[j] = out[j];
+            flen[j] = num;
+            padding[j] = RSA_NO_PADDING;
+        }
+        if (RSA_private_decrypt_batch(2, flen, from, to, rsa, padding, ret)
+            != 1 || BN_bin2bn(out[1], num, c) == NULL || BN_cmp(c, m) != 0)
+            err = 1;
+        key2->e = pub;
+
+        if (err)
+            printf("Multi-prime private key operation failed!\n");
+        else
+            printf("%d prime RSA ok\n", primes[i]);
+        RSA_free(key2);
+        key2 = NULL;
+        RSA_free(key);
+        key = NULL;
+        OPENSSL_free(der);
+        der = NULL;
+    }
+
+ end:
+    RSA_free(key);
+    RSA_free(key2);
+    if (der != NULL)
+        OPENSSL_free(der);
+    BN_free(e);
+    BN_free(c);
+    BN_free(m);
+    BN_CTX_free(ctx);
+    return err;
+}
+
+/*
+ * Decoded private keys are precomputed, decoded public keys are left to be
+ * set up on first use.
+ */
+static int decode_test(void)
+{
+    RSA *key, *priv = NULL, *pub = NULL;
+    unsigned char c[256], *der = NULL, *p;
+    const unsigned char *q;
+    int len, err = 1;
+
+    if ((key = RSA_new()) == NULL)
+        goto end;
+    key2(key, c);
+
+    if ((len = i2d_RSAPrivateKey(key, NULL)) <= 0
+        || (der = OPENSSL_malloc(len)) == NULL)
+        goto end;
+    p = der;
+    i2d_RSAPrivateKey(key, &p);
+    q = der;
+    if ((priv = d2i_RSAPrivateKey(NULL, &q, len)) == NULL
+        || !(priv->flags & RSA_FLAG_PRECOMPUTED))
+        goto end;
+    OPENSSL_free(der);
+    der = NULL;
+
+    if ((len = i2d_RSAPublicKey(key, NULL)) <= 0
+        || (der = OPENSSL_malloc(len)) == NULL)
+        goto end;
+    p = der;
+    i2d_RSAPublicKey(key, &p);
+    q = der;
+    if ((pub = d2i_RSAPublicKey(NULL, &q, len)) == NULL
+        || (pub->flags & RSA_FLAG_PRECOMPUTED)
+        || pub->thread_blindings != NULL)
+        goto end;
+    err = 0;
+ end:
+    if (err)
+        printf("Precomputation of decoded keys failed!\n");
+    else
+        printf("Precomputation of decoded keys ok\n");
+    if (der != NULL)
+        OPENSSL_free(der);
+    RSA_free(key);
+    RSA_free(priv);
+    RSA_free(pub);
+    return err;
+}
+
+# if defined(OPENSSL_THREADS) && defined(OPENSSL_SYS_UNIX)
+#  include <pthread.h>
+
+#  define THREADS 4
+
+static pthread_mutex_t *locks;
+
+static void lock_cb(int mode, int type, const char *file, int line)
+{
+    if (mode & CRYPTO_LOCK)
+        pthread_mutex_lock(&locks[type]);
+    else
+        pthread_mutex_unlock(&locks[type]);
+}
+
+static void *thread_run(void *arg)
+{
+    static const unsigned char ptext_ex[] = "\x54\x85\x9b\x34\x2c\x49\xea\x2a";
+    RSA *key = arg;
+    unsigned char ctext[256], ptext[256];
+    int i, num;
+    void *ret = NULL;
+
+    for (i = 0; i < 32; i++) {
+        num = RSA_public_encrypt(sizeof(ptext_ex) - 1, ptext_ex, ctext, key,
+                                 RSA_PKCS1_PADDING);
+        if (num <= 0)
+            goto end;
+        num = RSA_private_decrypt(num, ctext, ptext, key, RSA_PKCS1_PADDING);
+        if (num != sizeof(ptext_ex) - 1 || memcmp(ptext, ptext_ex, num) != 0)
+            goto end;
+    }
+    ret = arg;
+ end:
+    ERR_remove_thread_state(NULL);
+    return ret;
+}
+
+/*
+ * Use a precomputed key on several threads at once, each of which gets a
+ * blinding of its own.
+ */
+static int thread_test(void)
+{
+    RSA *key;
+    pthread_t thread[THREADS];
+    unsigned char c[256];
+    void *res;
+    int i, n = CRYPTO_num_locks(), started = 0, err = 1;
+
+    locks = OPENSSL_malloc(n * sizeof(*locks));
+    if (locks == NULL)
+        return 1;
+    for (i = 0; i < n; i++)
+        pthread_mutex_init(&locks[i], NULL);
+    CRYPTO_set_locking_callback(lock_cb);
+
+    if ((key = RSA_new()) == NULL)
+        goto end;
+    key2(key, c);
+    if (!RSA_precompute(key, NULL)
+        || !(key->flags & RSA_FLAG_PRECOMPUTED))
+        goto end;
+
+    for (started = 0; started < THREADS; started++)
+        if (pthread_create(&thread[started], NULL, thread_run, key) != 0)
+            goto end;
+    err = 0;
+ end:
+    while (started-- > 0) {
+        pthread_join(thread[started], &res);
+        if (res == NULL)
+            err = 1;
+    }
+    if (err)
+        printf("RSA on %d threads failed!\n", THREADS);
+    else
+        printf("RSA on %d threads ok\n", THREADS);
+    RSA_free(key);
+    CRYPTO_set_locking_callback(NULL);
+    for (i = 0; i < n; i++)
+        pthread_mutex_destroy(&locks[i]);
+    OPENSSL_free(locks);
+    return err;
+}
+# else
+static int thread_test(void)
+{
+    return 0;
+}
+# endif
+
 static const char rnd_seed[] =
     "string to make the random number generator think it has entropy";
 
@@ -317,6 +795,24 @@ int main(int argc, char *argv[])
         RSA_free(key);
     }
 
+    if (batch_test())
+        err = 1;
+
+    if (evp_batch_test())
+        err = 1;
+
+    if (small_key_test())
+        err = 1;
+
+    if (multi_prime_test())
+        err = 1;
+
+    if (decode_test())
+        err = 1;
+
+    if (thread_test())
+        err = 1;
+
     CRYPTO_cleanup_all_ex_data();
     ERR_remove_thread_state(NULL);
 
@@ -169,6 +169,7 @@
 #include <openssl/x509.h>
 #include <openssl/x509v3.h>
 #include <openssl/ssl.h>
+#include <openssl/async.h>
 #ifndef OPENSSL_NO_ENGINE
 # include <openssl/engine.h>
 #endif
@@ -190,6 +191,12 @@
 
 #include "../ssl/ssl_locl.h"
 
+#if defined(OPENSSL_THREADS) && defined(OPENSSL_SYS_UNIX)
+# define PRECOMPUTE_TEST
+# include <pthread.h>
+# include <unistd.h>
+#endif
+
 /*
  * Or gethostname won't be declared properly
  * on Compaq platforms (at least with DEC C).
@@ -748,6 +755,9 @@ int doit_biopair(SSL *s_ssl, SSL *c_ssl, long bytes, clock_t *s_time,
 int doit(SSL *s_ssl, SSL *c_ssl, long bytes);
 static int do_test_cipherlist(void);
 
+/* -dyn_record: SSL_MODE_DYNAMIC_RECORD_SIZE threshold, or -1 */
+static long dyn_record = -1;
+
 static void sv_usage(void)
 {
     fprintf(stderr, "usage: ssltest [args ...]\n");
@@ -802,6 +812,15 @@ static void sv_usage(void)
             " -c_key arg    - Client key file (default: same as -c_cert)\n");
     fprintf(stderr, " -cipher arg   - The cipher list\n");
     fprintf(stderr, " -bio_pair     - Use BIO pairs\n");
+    fprintf(stderr,
+            " -async        - Use SSL_MODE_ASYNC, with the dasync engine if available\n");
+#ifdef PRECOMPUTE_TEST
+    fprintf(stderr,
+            " -precompute n - Precompute up to n ECDHE keys and ECDSA nonces per curve\n");
+#endif
+    fprintf(stderr,
+            " -dyn_record n - Use SSL_MODE_DYNAMIC_RECORD_SIZE with a threshold of n\n"
+            "                 bytes and check the record sizes (-bytes must exceed n)\n");
     fprintf(stderr, " -f            - Test even cases that can't work\n");
     fprintf(stderr,
             " -time         - measure processor time used by client and server\n");
@@ -956,6 +975,97 @@ static void lock_dbg_cb(int mode, int type, const char *file, int line)
     }
 }
 
+/* The application data records one side wrote, as seen by dyn_record_cb() */
+typedef struct {
+    long records;
+    long small;                 /* written before the first full one */
+    long full;                  /* too large to be a ramp-up record */
+} DYN_RECORD_ARG;
+
+static void dyn_record_cb(int write_p, int version, int content_type,
+                          const void *buf, size_t len, SSL *ssl, void *arg)
+{
+    DYN_RECORD_ARG *d = arg;
+    const unsigned char *p = buf;
+
+    if (!write_p || content_type != SSL3_RT_HEADER || len < 5
+        || p[0] != SSL3_RT_APPLICATION_DATA)
+        return;
+    d->records++;
+    if (((p[3] << 8) | p[4]) >
+        SSL3_RT_DYN_RECORD_SIZE + SSL3_RT_MAX_ENCRYPTED_OVERHEAD)
+        d->full++;
+    else if (d->full == 0)
+        d->small++;
+}
+
+/*
+ * Check that |s| sent at least dyn_record bytes in small records before the
+ * first full one, that full ones followed, and that its record size
+ * counters agree with what was seen.
+ */
+static int dyn_record_check(SSL *s, const char *name, const DYN_RECORD_ARG *d)
+{
+    unsigned long counts[SSL_RECORD_SIZE_BUCKETS], sum = 0, small = 0;
+    int i;
+
+    BIO_printf(bio_stdout, "%s: %ld small then %ld full records of %ld\n",
+               name, d->small, d->full, d->records);
+    if (d->small * SSL3_RT_DYN_RECORD_SIZE < dyn_record || d->full == 0) {
+        BIO_printf(bio_err, "%s: wrong record sizes\n", name);
+        return 0;
+    }
+    if (SSL_get_record_size_stats(s, counts, -1) != -1
+        || SSL_get_record_size_stats(s, counts, SSL_RECORD_SIZE_BUCKETS)
+           != SSL_RECORD_SIZE_BUCKETS) {
+        BIO_printf(bio_err, "%s: SSL_get_record_size_stats failed\n", name);
+        return 0;
+    }
+    ERR_clear_error();
+    for (i = 0; i < SSL_RECORD_SIZE_BUCKETS; i++) {
+        sum += counts[i];
+        if ((512U << i) >= SSL3_RT_DYN_RECORD_SIZE
+            && (512U << i) < 2 * SSL3_RT_DYN_RECORD_SIZE)
+            small = sum;
+    }
+    if (sum != (unsigned long)d->records || small < (unsigned long)d->small) {
+        BIO_printf(bio_err, "%s: record size counters are wrong\n", name);
+        return 0;
+    }
+    return 1;
+}
+
+#ifdef PRECOMPUTE_TEST
+/* Real locks: the precompute thread runs alongside the handshakes */
+static pthread_mutex_t precomp_locks[CRYPTO_NUM_LOCKS];
+
+static void precomp_lock_cb(int mode, int type, const char *file, int line)
+{
+    if (mode & CRYPTO_LOCK)
+        pthread_mutex_lock(&precomp_locks[type]);
+    else
+        pthread_mutex_unlock(&precomp_locks[type]);
+}
+
+/*
+ * Give the precompute thread up to a second to put something in the queues
+ * that handshakes have asked for, so that the next handshake uses them.
+ */
+static void precomp_wait(SSL_CTX *ctx)
+{
+    int i;
+
+    for (i = 0; i < 100; i++) {
+        if ((SSL_CTX_precomp_key_misses(ctx) == 0
+             || SSL_CTX_precomp_keys(ctx) > 0)
+            && (SSL_CTX_precomp_nonce_misses(ctx) == 0
+                || SSL_CTX_precomp_nonces(ctx) > 0))
+            return;
+        usleep(10000);
+    }
+}
+#endif
+
 int main(int argc, char *argv[])
 {
     char *CApath = NULL, *CAfile = NULL;
@@ -1008,6 +1118,11 @@ int main(int argc, char *argv[])
     int fips_mode = 0;
 #endif
     int no_protocol = 0;
+    int async = 0;
+#ifdef PRECOMPUTE_TEST
+    int precompute = 0;
+#endif
+    DYN_RECORD_ARG c_dyn, s_dyn;
     int n;
 
     SSL_CONF_CTX *s_cctx = NULL, *c_cctx = NULL;
@@ -1206,6 +1321,22 @@ int main(int argc, char *argv[])
             CAfile = *(++argv);
         } else if (strcmp(*argv, "-bio_pair") == 0) {
             bio_pair = 1;
+        } else if (strcmp(*argv, "-async") == 0) {
+            async = 1;
+        }
+#ifdef PRECOMPUTE_TEST
+        else if (strcmp(*argv, "-precompute") == 0) {
+            if (--argc < 1)
+                goto bad;
+            precompute = atoi(*(++argv));
+        }
+#endif
+        else if (strcmp(*argv, "-dyn_record") == 0) {
+            if (--argc < 1)
+                goto bad;
+            dyn_record = atol(*(++argv));
+            if (dyn_record < 0)
+                goto bad;
         } else if (strcmp(*argv, "-f") == 0) {
             force = 1;
         } else if (strcmp(*argv, "-time") == 0) {
@@ -1442,6 +1573,54 @@ int main(int argc, char *argv[])
     SSL_CTX_set_security_level(c_ctx, 0);
     SSL_CTX_set_security_level(s_ctx, 0);
 
+    if (async) {
+#ifndef OPENSSL_NO_ENGINE
+        ENGINE *e;
+
+        /*
+         * Route RSA through the dasync engine so that the handshake really
+         * pauses. Without it the jobs simply run to completion.
+         */
+        ENGINE_load_builtin_engines();
+        if ((e = ENGINE_by_id("dasync")) == NULL
+            || !ENGINE_set_default_RSA(e)) {
+            fprintf(stderr, "dasync engine not available\n");
+            ERR_clear_error();
+        }
+        ENGINE_free(e);
+#endif
+        SSL_CTX_set_mode(s_ctx, SSL_MODE_ASYNC);
+        SSL_CTX_set_mode(c_ctx, SSL_MODE_ASYNC);
+    }
+
+    if (dyn_record >= 0) {
+        SSL_CTX_set_mode(s_ctx, SSL_MODE_DYNAMIC_RECORD_SIZE);
+        SSL_CTX_set_mode(c_ctx, SSL_MODE_DYNAMIC_RECORD_SIZE);
+        /* The counters don't include empty fragments, so don't send any */
+        SSL_CTX_set_options(s_ctx, SSL_OP_DONT_INSERT_EMPTY_FRAGMENTS);
+        SSL_CTX_set_options(c_ctx, SSL_OP_DONT_INSERT_EMPTY_FRAGMENTS);
+        /* No return to small records however slowly the test runs */
+        if (!SSL_CTX_set_dynamic_record_threshold(s_ctx, dyn_record)
+            || !SSL_CTX_set_dynamic_record_threshold(c_ctx, dyn_record)
+            || !SSL_CTX_set_dynamic_record_timeout(s_ctx, 0)
+            || !SSL_CTX_set_dynamic_record_timeout(c_ctx, 0)) {
+            ERR_print_errors(bio_err);
+            goto end;
+        }
+    }
+
+#ifdef PRECOMPUTE_TEST
+    if (precompute > 0) {
+        for (i = 0; i < CRYPTO_NUM_LOCKS; i++)
+            pthread_mutex_init(&precomp_locks[i], NULL);
+        CRYPTO_set_locking_callback(precomp_lock_cb);
+        if (!SSL_CTX_set_precompute(s_ctx, precompute, 1)) {
+            ERR_print_errors(bio_err);
+            goto end;
+        }
+    }
+#endif
+
     if (cipher != NULL) {
         if (!SSL_CTX_set_cipher_list(c_ctx, cipher)
            || !SSL_CTX_set_cipher_list(s_ctx, cipher)) {
@@ -1511,15 +1690,24 @@ int main(int argc, char *argv[])
             nid = NID_sect163r2;
 # endif
 
-        ecdh = EC_KEY_new_by_curve_name(nid);
-        if (ecdh == NULL) {
-            BIO_printf(bio_err, "unable to create curve\n");
-            goto end;
-        }
+        if (nid == NID_X25519) {
+            /* Not an EC_KEY curve: select it automatically instead */
+            if (!SSL_CTX_set1_curves(s_ctx, &nid, 1)
+                || !SSL_CTX_set_ecdh_auto(s_ctx, 1)) {
+                BIO_printf(bio_err, "unable to set curve\n");
+                goto end;
+            }
+        } else {
+            ecdh = EC_KEY_new_by_curve_name(nid);
+            if (ecdh == NULL) {
+                BIO_printf(bio_err, "unable to create curve\n");
+                goto end;
+            }
 
-        SSL_CTX_set_tmp_ecdh(s_ctx, ecdh);
-        SSL_CTX_set_options(s_ctx, SSL_OP_SINGLE_ECDH_USE);
-        EC_KEY_free(ecdh);
+            SSL_CTX_set_tmp_ecdh(s_ctx, ecdh);
+            SSL_CTX_set_options(s_ctx, SSL_OP_SINGLE_ECDH_USE);
+            EC_KEY_free(ecdh);
+        }
     }
 #else
     (void)no_ecdhe;
@@ -1752,12 +1940,45 @@ int main(int argc, char *argv[])
                 goto end;
             }
         }
+        if (dyn_record >= 0) {
+            memset(&c_dyn, 0, sizeof(c_dyn));
+            memset(&s_dyn, 0, sizeof(s_dyn));
+            SSL_set_msg_callback(c_ssl, dyn_record_cb);
+            SSL_set_msg_callback_arg(c_ssl, &c_dyn);
+            SSL_set_msg_callback(s_ssl, dyn_record_cb);
+            SSL_set_msg_callback_arg(s_ssl, &s_dyn);
+        }
         if (bio_pair)
             ret = doit_biopair(s_ssl, c_ssl, bytes, &s_time, &c_time);
         else
             ret = doit(s_ssl, c_ssl, bytes);
 	if (ret)  break;
+        if (dyn_record >= 0
+            && (!dyn_record_check(c_ssl, "client", &c_dyn)
+                || !dyn_record_check(s_ssl, "server", &s_dyn))) {
+            ret = 1;
+            break;
+        }
+#ifdef PRECOMPUTE_TEST
+        if (precompute > 0 && i + 1 < number)
+            precomp_wait(s_ctx);
+#endif
+    }
+
+#ifdef PRECOMPUTE_TEST
+    if (precompute > 0) {
+        long key_misses = SSL_CTX_precomp_key_misses(s_ctx);
+        long nonce_misses = SSL_CTX_precomp_nonce_misses(s_ctx);
+
+        BIO_printf(bio_stdout, "Precompute misses: %ld ECDHE keys, "
+                   "%ld ECDSA nonces\n", key_misses, nonce_misses);
+        /* Only the first handshake has to do without */
+        if (ret == 0 && (key_misses >= number || nonce_misses >= number)) {
+            BIO_printf(bio_err, "Precomputed keys or nonces never used\n");
+            ret = 1;
+        }
     }
+#endif
 
     if (!verbose) {
         print_details(c_ssl, "");
@@ -1799,6 +2020,7 @@ int main(int argc, char *argv[])
 #ifndef OPENSSL_NO_ENGINE
     ENGINE_cleanup();
 #endif
+    ASYNC_free_pool();
     CRYPTO_cleanup_all_ex_data();
     ERR_free_strings();
     ERR_remove_thread_state(NULL);
@@ -2289,6 +2511,9 @@ int doit(SSL *s_ssl, SSL *c_ssl, long count)
                             c_r = 1;
                         if (BIO_should_write(c_bio))
                             c_w = 1;
+                        /* A paused job has to be resumed unconditionally */
+                        if (SSL_want_async(c_ssl))
+                            c_w = 1;
                     } else {
                         fprintf(stderr, "ERROR in CLIENT\n");
                         ERR_print_errors(bio_err);
@@ -2317,6 +2542,9 @@ int doit(SSL *s_ssl, SSL *c_ssl, long count)
                             c_r = 1;
                         if (BIO_should_write(c_bio))
                             c_w = 1;
+                        /* A paused job has to be resumed unconditionally */
+                        if (SSL_want_async(c_ssl))
+                            c_w = 1;
                     } else {
                         fprintf(stderr, "ERROR in CLIENT\n");
                         ERR_print_errors(bio_err);
@@ -2353,6 +2581,9 @@ int doit(SSL *s_ssl, SSL *c_ssl, long count)
                             s_r = 1;
                         if (BIO_should_write(s_bio))
                             s_w = 1;
+                        /* A paused job has to be resumed unconditionally */
+                        if (SSL_want_async(s_ssl))
+                            s_w = 1;
                     } else {
                         fprintf(stderr, "ERROR in SERVER\n");
                         ERR_print_errors(bio_err);
@@ -2388,6 +2619,9 @@ int doit(SSL *s_ssl, SSL *c_ssl, long count)
                             s_r = 1;
                         if (BIO_should_write(s_bio))
                             s_w = 1;
+                        /* A paused job has to be resumed unconditionally */
+                        if (SSL_want_async(s_ssl))
+                            s_w = 1;
                     } else {
                         fprintf(stderr, "ERROR in SERVER\n");
                         ERR_print_errors(bio_err);
@@ -26,6 +26,8 @@ my @dirs = (
 "crypto/aes",
 "crypto/camellia",
 "crypto/seed",
+"crypto/chacha",
+"crypto/poly1305",
 "crypto/modes",
 "crypto/cmac",
 "crypto/bn",
@@ -61,6 +63,7 @@ my @dirs = (
 "crypto/krb5",
 #"crypto/store",
 "crypto/pqueue",
+"crypto/async",
 "crypto/whrlpool",
 "crypto/ts",
 "crypto/srp",
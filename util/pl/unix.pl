@@ -73,6 +73,8 @@ $bf_enc_src="";
 	  'aesni-sha256-x86_64' => 'crypto/aes',
           'rsaz-x86_64' => 'crypto/bn',
           'rsaz-avx2' => 'crypto/bn',
+          'rsaz-avx512' => 'crypto/bn',
+          'rsaz-3k4k' => 'crypto/bn',
 	  'aesni-mb-x86_64' => 'crypto/aes',
 	  'sha1-mb-x86_64' => 'crypto/sha',
 	  'sha256-mb-x86_64' => 'crypto/sha',